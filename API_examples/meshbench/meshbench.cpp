@@ -0,0 +1,175 @@
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+
+#include <api.h>
+#include <foil.h>
+#include <fuse.h>
+#include <objects3d.h>
+#include <panel3.h>
+#include <panel4.h>
+#include <planexfl.h>
+#include <quadmesh.h>
+#include <threadpool.h>
+#include <trimesh.h>
+#include <wingsection.h>
+#include <wingxfl.h>
+
+
+// Times the construction of the quad and triangular meshes of sample planes
+// with the serial and the parallel meshing modes, and checks that both modes
+// build the same panels with the same indexes.
+// usage: MeshBench [thread count]
+
+
+struct MeshTimes
+{
+    double surfaces{0}, quads{0}, triangles{0}, connections{0};
+    double total() const {return surfaces+quads+triangles+connections;}
+};
+
+
+double elapsed(std::chrono::steady_clock::time_point &t0)
+{
+    auto t1 = std::chrono::steady_clock::now();
+    double dt = std::chrono::duration<double>(t1-t0).count();
+    t0 = t1;
+    return dt;
+}
+
+
+MeshTimes buildMeshes(PlaneXfl *pPlaneXfl, bool bParallel)
+{
+    PlaneXfl::setParallelMeshing(bParallel);
+    MeshTimes times;
+    auto t0 = std::chrono::steady_clock::now();
+
+    pPlaneXfl->createSurfaces();
+    times.surfaces = elapsed(t0);
+
+    pPlaneXfl->makeQuadMesh(true, false);
+    times.quads = elapsed(t0);
+
+    pPlaneXfl->makeTriMesh(true);
+    times.triangles = elapsed(t0);
+
+    pPlaneXfl->connectTriMesh(true, true, bParallel);
+    times.connections = elapsed(t0);
+
+    return times;
+}
+
+
+bool isIdentical(Vector3d const &V0, Vector3d const &V1)
+{
+    return V0.x==V1.x && V0.y==V1.y && V0.z==V1.z;
+}
+
+
+bool isSameMesh(QuadMesh const &q0, TriMesh const &t0, QuadMesh const &q1, TriMesh const &t1)
+{
+    if(q0.nPanels()!=q1.nPanels() || t0.nPanels()!=t1.nPanels() || t0.nNodes()!=t1.nNodes()) return false;
+
+    for(int i4=0; i4<q0.nPanels(); i4++)
+    {
+        Panel4 const &p0 = q0.panelAt(i4);
+        Panel4 const &p1 = q1.panelAt(i4);
+        if(p0.index()!=p1.index() || p0.iWakeColumn()!=p1.iWakeColumn()) return false;
+        if(p0.m_iPL!=p1.m_iPL || p0.m_iPR!=p1.m_iPR || p0.m_iPU!=p1.m_iPU || p0.m_iPD!=p1.m_iPD) return false;
+        if(!isIdentical(p0.CoG(), p1.CoG())) return false;
+    }
+
+    for(int i3=0; i3<t0.nPanels(); i3++)
+    {
+        Panel3 const &p0 = t0.panelAt(i3);
+        Panel3 const &p1 = t1.panelAt(i3);
+        if(p0.index()!=p1.index() || p0.oppositeIndex()!=p1.oppositeIndex()) return false;
+        for(int iv=0; iv<3; iv++)
+        {
+            if(p0.nodeIndex(iv)!=p1.nodeIndex(iv) || p0.neighbour(iv)!=p1.neighbour(iv)) return false;
+        }
+        if(!isIdentical(p0.CoG(), p1.CoG())) return false;
+    }
+
+    for(int in=0; in<t0.nNodes(); in++)
+    {
+        if(t0.nodeAt(in).nodeNeighbourIndexes()!=t1.nodeAt(in).nodeNeighbourIndexes()) return false;
+        if(t0.nodeAt(in).triangleIndexes()    !=t1.nodeAt(in).triangleIndexes())     return false;
+    }
+
+    return true;
+}
+
+
+void refinePlane(PlaneXfl *pPlaneXfl, int factor, std::string const &foilname)
+{
+    for(int iw=0; iw<pPlaneXfl->nWings(); iw++)
+    {
+        WingXfl *pWing = pPlaneXfl->wing(iw);
+        for(int isec=0; isec<pWing->nSections(); isec++)
+        {
+            WingSection &sec = pWing->section(isec);
+            sec.setLeftFoilName(foilname);
+            sec.setRightFoilName(foilname);
+            sec.setNX(sec.nXPanels()*factor);
+            sec.setNY(sec.nYPanels()*factor);
+        }
+        pWing->computeGeometry();
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    int nThreads = argc>1 ? atoi(argv[1]) : 0;
+    if(nThreads>0) ThreadPool::setThreadCount(nThreads);
+    printf("flow5 mesh benchmark - %d threads\n\n", ThreadPool::threadCount());
+
+    Foil *pFoil = foil::makeNacaFoil(2412, "NACA 2412");
+    if(!pFoil)
+    {
+        std::cout <<"Error creating the foil ...aborting" << std::endl;
+        return 0;
+    }
+
+    printf("plane            refinement    quads  triangles    serial (s)  parallel (s)  speedup  identical\n");
+
+    bool bAllSame = true;
+    for(int iPlane=0; iPlane<2; iPlane++)
+    {
+        for(int factor : {1, 2, 4})
+        {
+            // the default plane, with and without a fuse
+            PlaneXfl *pPlaneXfl = new PlaneXfl(true);
+            pPlaneXfl->setName(iPlane==0 ? "Default plane" : "Default plane with fuse");
+            Objects3d::insertPlane(pPlaneXfl);
+            if(iPlane==1) pPlaneXfl->setFuse(true, Fuse::NURBS);
+            refinePlane(pPlaneXfl, factor, pFoil->name());
+
+            MeshTimes serial = buildMeshes(pPlaneXfl, false);
+            QuadMesh quadmesh = pPlaneXfl->refQuadMesh();
+            TriMesh trimesh   = pPlaneXfl->refTriMesh();
+
+            MeshTimes parallel = buildMeshes(pPlaneXfl, true);
+            bool bSame = isSameMesh(quadmesh, trimesh, pPlaneXfl->refQuadMesh(), pPlaneXfl->refTriMesh());
+            bAllSame = bAllSame && bSame;
+
+            printf("%-24s  x%d  %8d  %9d  %12.3f  %12.3f  %7.2f  %s\n",
+                   pPlaneXfl->name().c_str(), factor, pPlaneXfl->refQuadMesh().nPanels(), pPlaneXfl->refTriMesh().nPanels(),
+                   serial.total(), parallel.total(), serial.total()/std::max(parallel.total(), 1.e-6), bSame ? "yes" : "NO");
+
+            printf("    surfaces %.3f/%.3f s   quads %.3f/%.3f s   triangles %.3f/%.3f s   connections %.3f/%.3f s\n",
+                   serial.surfaces, parallel.surfaces, serial.quads, parallel.quads,
+                   serial.triangles, parallel.triangles, serial.connections, parallel.connections);
+        }
+    }
+
+    PlaneXfl::setParallelMeshing(true);
+
+    // Must call! will delete the planes, foils and children objects
+    globals::deleteObjects();
+
+    std::cout << (bAllSame ? "done" : "the serial and parallel meshes differ") << std::endl;
+
+    return bAllSame ? 0 : 1;
+}
@@ -0,0 +1,91 @@
+#include <cstdlib>
+#include <iostream>
+
+#include <api.h>
+#include <foil.h>
+#include <fuse.h>
+#include <objects3d.h>
+#include <planexfl.h>
+#include <testtrimesh.h>
+#include <threadpool.h>
+#include <trimesh.h>
+#include <wingsection.h>
+#include <wingxfl.h>
+
+
+// Checks that the node arrays, the panel neighbours and the node connections built
+// by the TriMesh methods are identical to those of the reference O(n²) implementations,
+// on the triangular meshes of sample planes.
+// usage: MeshCheck [thread count]
+
+
+void refinePlane(PlaneXfl *pPlaneXfl, int factor, std::string const &foilname)
+{
+    for(int iw=0; iw<pPlaneXfl->nWings(); iw++)
+    {
+        WingXfl *pWing = pPlaneXfl->wing(iw);
+        for(int isec=0; isec<pWing->nSections(); isec++)
+        {
+            WingSection &sec = pWing->section(isec);
+            sec.setLeftFoilName(foilname);
+            sec.setRightFoilName(foilname);
+            sec.setNX(sec.nXPanels()*factor);
+            sec.setNY(sec.nYPanels()*factor);
+        }
+        pWing->computeGeometry();
+    }
+}
+
+
+int main(int argc, char *argv[])
+{
+    int nThreads = argc>1 ? atoi(argv[1]) : 0;
+    if(nThreads>0) ThreadPool::setThreadCount(nThreads);
+    printf("flow5 mesh connection check - %d threads\n\n", ThreadPool::threadCount());
+
+    Foil *pFoil = foil::makeNacaFoil(2412, "NACA 2412");
+    if(!pFoil)
+    {
+        std::cout <<"Error creating the foil ...aborting" << std::endl;
+        return 0;
+    }
+
+    printf("plane                     refinement  surfaces  triangles  nodes  identical\n");
+
+    bool bAllSame = true;
+    for(int iPlane=0; iPlane<2; iPlane++)
+    {
+        for(int factor : {1, 2})
+        {
+            for(bool bThick : {true, false})
+            {
+                // the default plane, with and without a fuse
+                PlaneXfl *pPlaneXfl = new PlaneXfl(true);
+                pPlaneXfl->setName(iPlane==0 ? "Default plane" : "Default plane with fuse");
+                Objects3d::insertPlane(pPlaneXfl);
+                if(iPlane==1) pPlaneXfl->setFuse(true, Fuse::NURBS);
+                refinePlane(pPlaneXfl, factor, pFoil->name());
+
+                pPlaneXfl->createSurfaces();
+                pPlaneXfl->makeTriMesh(bThick);
+
+                TriMesh const &trimesh = pPlaneXfl->refTriMesh();
+                std::string log;
+                bool bSame = testTriMeshConnections(trimesh, log);
+                bAllSame = bAllSame && bSame;
+
+                printf("%-24s  x%d          %-8s  %9d  %5d  %s\n",
+                       pPlaneXfl->name().c_str(), factor, bThick ? "thick" : "thin",
+                       trimesh.nPanels(), trimesh.nNodes(), bSame ? "yes" : "NO");
+                if(!bSame) std::cout << log;
+            }
+        }
+    }
+
+    // Must call! will delete the planes, foils and children objects
+    globals::deleteObjects();
+
+    std::cout << (bAllSame ? "done" : "the reference and the spatial hash connections differ") << std::endl;
+
+    return bAllSame ? 0 : 1;
+}
@@ -0,0 +1,213 @@
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include <frame.h>
+#include <nurbsevaluator.h>
+#include <nurbssurface.h>
+
+
+// Checks that the span-local NURBS evaluations, i.e. NURBSSurface::getPoint(), NURBSSurface::getNormal()
+// and the NURBSEvaluator methods, match the reference implementations which sum over all the
+// control points, NURBSSurface::getPoint_ref() and NURBSSurface::getNormal_ref().
+// The surfaces are fuselage NURBS with a range of degrees, of frame and point counts,
+// and therefore of knot layouts, including single span and degenerate knot vectors.
+// usage: NurbsCheck
+
+
+double const POINTTOLERANCE  = 1.e-12; // relative to the surface's length
+double const NORMALTOLERANCE = 1.e-10;
+
+
+struct NurbsCase
+{
+    std::string name;
+    NURBSSurface nurbs;
+};
+
+
+/** Builds a half fuselage with elliptic frames; the nose and the tail frames collapse to a point. */
+void makeFuselage(NURBSSurface &nurbs, int nFrames, int nPoints)
+{
+    double const length = 0.9;
+    double const radius = 0.045;
+
+    nurbs.clearFrames();
+    for(int ifr=0; ifr<nFrames; ifr++)
+    {
+        double x = length * double(ifr)/double(nFrames-1);
+        double r = radius * std::sqrt(std::sin(M_PI*x/length));
+        double zc = 0.01 * x/length;
+
+        Frame &frame = nurbs.appendNewFrame();
+        frame.clearCtrlPoints();
+        for(int ip=0; ip<nPoints; ip++)
+        {
+            double theta = M_PI * double(ip)/double(nPoints-1); // from top to bottom
+            frame.appendCtrlPoint(Vector3d(x, r*std::sin(theta), zc + 0.8*r*std::cos(theta)));
+        }
+        frame.setuPosition(0, x);
+    }
+}
+
+
+/** Sets the degrees, clamped as in the fuse editor unless bClamp is false, and rebuilds the knots. */
+void setDegrees(NURBSSurface &nurbs, int uDegree, int vDegree, bool bClamp)
+{
+    if(bClamp)
+    {
+        uDegree = std::min(uDegree, nurbs.frameCount()-1);
+        vDegree = std::min(vDegree, nurbs.framePointCount()-1);
+    }
+    nurbs.setuDegree(uDegree);
+    nurbs.setvDegree(vDegree);
+    nurbs.setKnots();
+}
+
+
+/** The parameters at which the surfaces are evaluated: a regular grid, the end points and the knots. */
+std::vector<double> parameters(std::vector<double> const &knots, int n)
+{
+    std::vector<double> params;
+    for(int i=0; i<=n; i++) params.push_back(double(i)/double(n));
+    params.push_back(1.e-5);
+    params.push_back(1.0-1.e-5);
+    for(double k : knots) if(k>0.0 && k<1.0) params.push_back(k);
+    return params;
+}
+
+
+/**
+ * Compares all the evaluations of the surface to the reference implementations.
+ * Returns the largest differences of the points and of the normals.
+ */
+void compare(NURBSSurface const &nurbs, double &maxPtDiff, double &maxNDiff)
+{
+    maxPtDiff = maxNDiff = 0.0;
+
+    std::vector<double> u = parameters(nurbs.uKnot(), 29);
+    std::vector<double> v = parameters(nurbs.vKnot(), 17);
+
+    NURBSEvaluator evaluator(nurbs);
+    std::vector<Vector3d> grid;
+    evaluator.getGrid(u, v, grid);
+
+    Vector3d Pref, Nref, Pt, N, Su, Sv;
+    for(uint i=0; i<u.size(); i++)
+    {
+        for(uint j=0; j<v.size(); j++)
+        {
+            nurbs.getPoint_ref(u.at(i), v.at(j), Pref);
+            nurbs.getNormal_ref(u.at(i), v.at(j), Nref);
+
+            nurbs.getPoint(u.at(i), v.at(j), Pt);
+            maxPtDiff = std::max(maxPtDiff, Pt.distanceTo(Pref));
+            evaluator.getPoint(u.at(i), v.at(j), Pt);
+            maxPtDiff = std::max(maxPtDiff, Pt.distanceTo(Pref));
+            evaluator.getDerivatives(u.at(i), v.at(j), Pt, Su, Sv);
+            maxPtDiff = std::max(maxPtDiff, Pt.distanceTo(Pref));
+            maxPtDiff = std::max(maxPtDiff, grid.at(i*v.size()+j).distanceTo(Pref));
+
+            nurbs.getNormal(u.at(i), v.at(j), N);
+            maxNDiff = std::max(maxNDiff, N.distanceTo(Nref));
+            evaluator.getNormal(u.at(i), v.at(j), N);
+            maxNDiff = std::max(maxNDiff, N.distanceTo(Nref));
+        }
+    }
+}
+
+
+int main()
+{
+    printf("flow5 NURBS evaluation check\n\n");
+
+    std::vector<NurbsCase> cases;
+
+    // the default fuse, at all the degrees which the fuse editor allows and beyond
+    for(int deg=1; deg<=6; deg++)
+    {
+        NurbsCase nc{"default fuse", NURBSSurface()};
+        nc.nurbs.makeDefaultNurbs();
+        setDegrees(nc.nurbs, deg, deg, true);
+        cases.push_back(nc);
+    }
+
+    // different degrees in each direction
+    for(int uDeg : {2, 5})
+    {
+        for(int vDeg : {1, 3})
+        {
+            NurbsCase nc{"default fuse", NURBSSurface()};
+            nc.nurbs.makeDefaultNurbs();
+            setDegrees(nc.nurbs, uDeg, vDeg, true);
+            cases.push_back(nc);
+        }
+    }
+
+    // rotated frames and edge weights
+    for(double weight : {1.0, 0.3, 2.5})
+    {
+        NurbsCase nc{"rotated frames", NURBSSurface()};
+        nc.nurbs.makeDefaultNurbs();
+        nc.nurbs.frame(1).setAngle(-7.0);
+        nc.nurbs.frame(3).setAngle(4.0);
+        nc.nurbs.frame(5).setAngle(12.0);
+        nc.nurbs.setuEdgeWeight(weight);
+        nc.nurbs.setvEdgeWeight(1.0/weight);
+        setDegrees(nc.nurbs, 3, 2, true);
+        cases.push_back(nc);
+    }
+
+    // fuselages with many frames and points, i.e. with many knot spans
+    for(int nFrames : {3, 8, 21, 40})
+    {
+        for(int nPoints : {3, 7, 30})
+        {
+            for(int deg : {1, 2, 3, 5})
+            {
+                NurbsCase nc{"fuselage", NURBSSurface()};
+                makeFuselage(nc.nurbs, nFrames, nPoints);
+                setDegrees(nc.nurbs, deg, deg, true);
+                cases.push_back(nc);
+            }
+        }
+    }
+
+    // degrees too high for the number of control points: degenerate knot vectors
+    for(int deg : {7, 12})
+    {
+        NurbsCase nc{"degenerate knots", NURBSSurface()};
+        nc.nurbs.makeDefaultNurbs();
+        setDegrees(nc.nurbs, deg, 4, false);
+        cases.push_back(nc);
+
+        NurbsCase nc2{"degenerate knots", NURBSSurface()};
+        makeFuselage(nc2.nurbs, 8, 5);
+        setDegrees(nc2.nurbs, 3, deg, false);
+        cases.push_back(nc2);
+    }
+
+    printf("surface            frames  points  degrees  point diff  normal diff  identical\n");
+
+    bool bAllSame = true;
+    for(NurbsCase const &nc : cases)
+    {
+        NURBSSurface const &nurbs = nc.nurbs;
+        double length = nurbs.lastFrame().position().x - nurbs.firstFrame().position().x;
+
+        double ptdiff=0, ndiff=0;
+        compare(nurbs, ptdiff, ndiff);
+        bool bSame = ptdiff<=POINTTOLERANCE*length && ndiff<=NORMALTOLERANCE;
+        bAllSame = bAllSame && bSame;
+
+        printf("%-17s  %6d  %6d   %2d/%-2d   %10.3g  %11.3g  %s\n",
+               nc.name.c_str(), nurbs.frameCount(), nurbs.framePointCount(), nurbs.uDegree(), nurbs.vDegree(),
+               ptdiff, ndiff, bSame ? "yes" : "NO");
+    }
+
+    std::cout << std::endl << (bAllSame ? "done" : "the span-local evaluations differ from the reference") << std::endl;
+
+    return bAllSame ? 0 : 1;
+}
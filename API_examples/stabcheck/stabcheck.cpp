@@ -0,0 +1,224 @@
+#include <cmath>
+#include <cstdlib>
+#include <iostream>
+
+#include <api.h>
+#include <anglecontrol.h>
+#include <foil.h>
+#include <objects3d.h>
+#include <panelanalysis.h>
+#include <planeopp.h>
+#include <planepolar.h>
+#include <planetask.h>
+#include <planexfl.h>
+#include <vortex.h>
+#include <wingsection.h>
+#include <wingxfl.h>
+
+
+// Checks the control derivatives of a T2 polar with active AVL controls.
+// The operating points are calculated concurrently in a single task,
+// then one at a time in separate tasks, and both sets of derivatives are
+// compared to each other and to the values recorded with the serial
+// implementation of the T123458 loop.
+// Also checks that the task's velocity field is that of the last operating point.
+// usage: StabCheck [thread count]
+
+
+struct CtrlDerivatives
+{
+    double alpha{0};
+    double Xde{0}, Yde{0}, Zde{0}, Lde{0}, Mde{0}, Nde{0};
+};
+
+
+// the reference values of the first control, for the operating points at 1°, 3° and 5°
+CtrlDerivatives const QuadRef[] = {
+    {1.0, -0.1730463327,  0.03234939352,  -0.7451288954, 1.262381389,  -0.4238264697, -0.07651314824},
+    {3.0, -0.1624842851,  0.01617630442,  -0.4323093448, 0.7411946633, -0.2494396327, -0.05704058033},
+    {5.0, -0.1571520091,  0.009723207091, -0.2983248032, 0.522129622,  -0.1761280165, -0.04869121223}};
+
+CtrlDerivatives const TriUniRef[] = {
+    {1.0, -0.01535970101, 0.03666841489,  -0.7485241511, 1.203448239,  -0.4119315695, -0.07204972164},
+    {3.0, -0.01454705238, 0.02282802751,  -0.4459537683, 0.715327907,  -0.2454800888, -0.05433570353},
+    {5.0, -0.01412220114, 0.01688224514,  -0.3166467635, 0.5065217754, -0.1742558466, -0.04658995088}};
+
+CtrlDerivatives const TriLinRef[] = {
+    {1.0,  0.04887190182, 0.04282930973,  -0.7861616065, 1.229302092,  -0.4237979484, -0.08397085205},
+    {3.0,  0.02280940413, 0.02716743843,  -0.4797734746, 0.7464721667, -0.2579636597, -0.06359881227},
+    {5.0,  0.01133485206, 0.02024819498,  -0.3446606921, 0.5334664341, -0.1847819567, -0.05442714501}};
+
+
+bool isClose(double d0, double d1, double reltol)
+{
+    return std::abs(d0-d1) <= reltol*std::max(1.0, std::max(std::abs(d0), std::abs(d1)));
+}
+
+
+bool isClose(CtrlDerivatives const &cd0, CtrlDerivatives const &cd1, double reltol)
+{
+    return isClose(cd0.Xde, cd1.Xde, reltol) && isClose(cd0.Yde, cd1.Yde, reltol) && isClose(cd0.Zde, cd1.Zde, reltol) &&
+           isClose(cd0.Lde, cd1.Lde, reltol) && isClose(cd0.Mde, cd1.Mde, reltol) && isClose(cd0.Nde, cd1.Nde, reltol);
+}
+
+
+/**
+ * Runs the T2 polar on the list of aoa and returns the derivatives w.r.t. the first control.
+ * Also checks that the velocities returned by the task are those of the last operating point.
+ */
+std::vector<CtrlDerivatives> runPolar(PlaneXfl *pPlaneXfl, PlanePolar *pPlPolar, std::vector<double> const &opplist, bool &bSameVelocity)
+{
+    std::vector<CtrlDerivatives> derivatives;
+
+    PlaneTask *pPlaneTask = new PlaneTask;
+    pPlaneTask->setKeepOpps(true);
+    pPlaneTask->setObjects(pPlaneXfl, pPlPolar);
+    pPlaneTask->setComputeDerivatives(true);
+    pPlaneTask->setOppList(opplist);
+    pPlaneTask->run();
+
+    for(PlaneOpp const *pPOpp : pPlaneTask->planeOppList())
+    {
+        StabDerivatives const &SD = pPOpp->m_SD;
+        if(SD.Xde.size()<1) continue;
+        derivatives.push_back({pPOpp->alpha(), SD.Xde.at(0), SD.Yde.at(0), SD.Zde.at(0), SD.Lde.at(0), SD.Mde.at(0), SD.Nde.at(0)});
+    }
+
+    bSameVelocity = pPlaneTask->planeOppList().size()>0;
+    if(bSameVelocity)
+    {
+        PlaneOpp const *pLastOpp = pPlaneTask->planeOppList().back();
+        for(Vector3d const &C : {Vector3d(0.05, 0.3, 0.05), Vector3d(0.2, -0.6, -0.04), Vector3d(0.8, 0.1, 0.15)})
+        {
+            Vector3d V0, V1;
+            pPlaneTask->getVelocityVector(C, Vortex::coreRadius(), false, V0);
+            pPlaneTask->panelAnalysis()->getVelocityVector(C, pLastOpp->gamma().data(), pLastOpp->sigma().data(), V1, Vortex::coreRadius(), false, false);
+            bSameVelocity = bSameVelocity && isClose(V0.x, V1.x, 1.e-12) && isClose(V0.y, V1.y, 1.e-12) && isClose(V0.z, V1.z, 1.e-12);
+        }
+    }
+
+    delete pPlaneTask;
+    return derivatives;
+}
+
+
+int main(int argc, char *argv[])
+{
+    int nThreads = argc>1 ? atoi(argv[1]) : 4;
+    PanelAnalysis::setMultiThread(nThreads>1);
+    PanelAnalysis::setMaxThreadCount(std::max(1, nThreads));
+    printf("flow5 control derivatives check - %d threads\n\n", std::max(1, nThreads));
+
+    Foil *pFoil = foil::makeNacaFoil(2412, "NACA 2412");
+    if(!pFoil)
+    {
+        std::cout <<"Error creating the foil ...aborting" << std::endl;
+        return 0;
+    }
+    pFoil->setTEFlapData(true, 0.75, 0.5, 0.0);
+
+    std::vector<double> const opplist = {1.0, 3.0, 5.0};
+
+    bool bAllSame = true;
+    for(xfl::enumAnalysisMethod method : {xfl::QUADS, xfl::TRIUNIFORM, xfl::TRILINEAR})
+    {
+        bool bTriangles = method!=xfl::QUADS;
+        std::string methodname = "quads";
+        if     (method==xfl::TRIUNIFORM) methodname = "uniform triangles";
+        else if(method==xfl::TRILINEAR)  methodname = "linear triangles";
+
+        // the default plane with the flapped foil
+        PlaneXfl *pPlaneXfl = new PlaneXfl(true);
+        pPlaneXfl->setName("Default plane - " + methodname);
+        Objects3d::insertPlane(pPlaneXfl);
+        for(int iw=0; iw<pPlaneXfl->nWings(); iw++)
+        {
+            WingXfl *pWing = pPlaneXfl->wing(iw);
+            for(int isec=0; isec<pWing->nSections(); isec++)
+            {
+                WingSection &sec = pWing->section(isec);
+                sec.setLeftFoilName(pFoil->name());
+                sec.setRightFoilName(pFoil->name());
+            }
+            pWing->computeGeometry();
+        }
+        pPlaneXfl->makePlane(true, false, bTriangles);
+
+        int nFlaps = 0;
+        for(int iw=0; iw<pPlaneXfl->nWings(); iw++) nFlaps += pPlaneXfl->wing(iw)->nFlaps();
+
+        PlanePolar *pPlPolar = new PlanePolar;
+        pPlPolar->setDefaultSpec(pPlaneXfl);
+        pPlPolar->setName("T2 - " + methodname);
+        pPlPolar->setPlaneName(pPlaneXfl->name());
+        Objects3d::insertPlPolar(pPlPolar);
+        pPlPolar->setType(xfl::T2POLAR);
+        pPlPolar->setAnalysisMethod(method);
+        pPlPolar->setReferenceChordLength(pPlaneXfl->mac());
+        pPlPolar->setThickSurfaces(true); // the source strengths are non-zero
+        pPlPolar->setViscous(false);
+        pPlPolar->setAutoInertia(false);
+        pPlPolar->setMass(1.5);
+        pPlPolar->setCoG(Vector3d(0.045, 0.0, 0.0));
+        pPlPolar->setInertiaTensor(0.2, 0.1, 0.3, 0.0);
+
+        // an asymmetric control to exercise the lateral derivatives, and an inactive one
+        std::vector<double> gains(nFlaps);
+        for(int i=0; i<nFlaps; i++) gains[i] = (i%2==0) ? 1.0 : -0.5;
+        pPlPolar->addAVLControl(AngleControl("aileron", gains));
+        pPlPolar->addAVLControl(AngleControl("inactive", std::vector<double>(nFlaps, 0.0)));
+
+        // the wake panels are built by the caller, as in the plane module
+        if(bTriangles)
+        {
+            pPlaneXfl->makeTriMesh(true);
+            pPlaneXfl->refTriMesh().makeWakePanels(pPlPolar->NXWakePanel4(), pPlPolar->wakePanelFactor(), pPlPolar->wakeLength(), Vector3d(1.0,0,0), true);
+        }
+        else
+        {
+            pPlaneXfl->makeQuadMesh(true, pPlPolar->bIgnoreBodyPanels());
+            pPlaneXfl->refQuadMesh().makeWakePanels(pPlPolar->NXWakePanel4(), pPlPolar->wakePanelFactor(), pPlPolar->wakeLength(), Vector3d(1.0,0,0), true);
+        }
+        pPlaneXfl->restoreMesh();
+
+        bool bSameVelocity = false;
+        std::vector<CtrlDerivatives> batch = runPolar(pPlaneXfl, pPlPolar, opplist, bSameVelocity);
+
+        std::vector<CtrlDerivatives> single;
+        for(double alpha : opplist)
+        {
+            bool bSingleVelocity = false;
+            std::vector<CtrlDerivatives> cd = runPolar(pPlaneXfl, pPlPolar, {alpha}, bSingleVelocity);
+            single.insert(single.end(), cd.begin(), cd.end());
+            bSameVelocity = bSameVelocity && bSingleVelocity;
+        }
+
+        CtrlDerivatives const *ref = QuadRef;
+        if     (method==xfl::TRIUNIFORM) ref = TriUniRef;
+        else if(method==xfl::TRILINEAR)  ref = TriLinRef;
+
+        printf("%s\n", pPlPolar->name().c_str());
+        bool bSame = batch.size()==opplist.size() && single.size()==opplist.size();
+        for(uint io=0; bSame && io<opplist.size(); io++)
+        {
+            CtrlDerivatives const &cd = batch.at(io);
+            // in a serial run, the round-off of the previous control deflections carries over to the next operating point
+            bool bBatch = isClose(cd, single.at(io), 1.e-8);
+            bool bRef   = isClose(cd, ref[io], 1.e-8);
+            printf("   alpha=%4.1f  Xde=%13.10g  Yde=%13.10g  Zde=%13.10g  Lde=%13.10g  Mde=%13.10g  Nde=%13.10g  %s\n",
+                   cd.alpha, cd.Xde, cd.Yde, cd.Zde, cd.Lde, cd.Mde, cd.Nde,
+                   bBatch&&bRef ? "ok" : (bBatch ? "differs from reference" : "differs from single point run"));
+            bSame = bSame && bBatch && bRef;
+        }
+        if(batch.size()!=opplist.size() || single.size()!=opplist.size()) printf("   missing operating points\n");
+        printf("   velocities of the last operating point: %s\n", bSameVelocity ? "ok" : "DIFFER");
+        bAllSame = bAllSame && bSame && bSameVelocity;
+    }
+
+    // Must call! will delete the planes, foils and children objects
+    globals::deleteObjects();
+
+    std::cout << (bAllSame ? "done" : "the control derivatives or the velocities differ") << std::endl;
+
+    return bAllSame ? 0 : 1;
+}
@@ -30,7 +30,7 @@
 
 bool XFoil::s_bCancel = false;
 bool XFoil::s_bFullReport = false;
-double XFoil::vaccel = 0.01;
+double XFoil::s_VAccel = 0.01;
 
 XFoil::XFoil()
 {
@@ -83,7 +83,12 @@ XFoil::XFoil()
     minf1 = 0.0;
 
     //---- drop tolerance for bl system solver
-    vaccel = 0.01;
+    vaccel = s_VAccel;
+    m_bFullReport = s_bFullReport;
+    m_bCancelled = false;
+
+    m_nqx = m_nzx = 0;
+
     //---- default viscous parameters
     retyp = 1;
     reinf1 = 0.0;
@@ -107,21 +112,32 @@ bool XFoil::initialize()
 
     n=0;// so that current airfoil is not initialized
 
+    // release the workspaces, they will be sized to the next airfoil
+    aij.clear();
+    bij.clear();
+    cij.clear();
+    dij.clear();
+    q.clear();
+    for(int k=0; k<4; k++)
+    {
+        va[k].clear();
+        vb[k].clear();
+        vdel[k].clear();
+        vm[k].clear();
+    }
+    m_nqx = m_nzx = 0;
+
     memset(Hk,     0, sizeof(Hk));
     memset(RTheta, 0, sizeof(RTheta));
 
-    memset(aij,    0, sizeof(aij));
     memset(aijpiv, 0, sizeof(aijpiv));
     memset(apanel, 0, sizeof(apanel));
-    memset(bij,    0, sizeof(bij));
     memset(blsav,  0, sizeof(blsav));
-    memset(cij,    0, sizeof(cij));
     memset(cpi,    0, sizeof(cpi));
     memset(cpv,    0, sizeof(cpv));
     memset(ctau,   0, sizeof(ctau));
     memset(ctq,    0, sizeof(ctq));
     memset(delt,   0, sizeof(delt));
-    memset(dij,    0, sizeof(dij));
     memset(dis,    0, sizeof(dis));
     memset(dq,     0, sizeof(dq));
     memset(dqdg,   0, sizeof(dqdg));
@@ -144,7 +160,6 @@ bool XFoil::initialize()
     memset(nbl,    0, sizeof(nbl));
     memset(nx,     0, sizeof(nx));
     memset(ny,     0, sizeof(ny));
-    memset(q,      0, sizeof(q));
     memset(qf0,    0, sizeof(qf0));
     memset(qf1,    0, sizeof(qf1));
     memset(qf2,    0, sizeof(qf2));
@@ -162,10 +177,6 @@ bool XFoil::initialize()
     memset(uedg,   0, sizeof(uedg));
     memset(uinv,   0, sizeof(uinv));
     memset(uslp,   0, sizeof(uslp));
-    memset(va,     0, sizeof(va));
-    memset(vb,     0, sizeof(vb));
-    memset(vdel,   0, sizeof(vdel));
-    memset(vm,     0, sizeof(vm));
     memset(vs1,    0, sizeof(vs1));
     memset(vs2,    0, sizeof(vs2));
     memset(vsm,    0, sizeof(vsm));
@@ -641,7 +652,8 @@ bool XFoil::initialize()
     xpref2 = 1.0;
 
     //---- drop tolerance for bl system solver
-    vaccel = 0.01;
+    vaccel = s_VAccel;
+    m_bFullReport = s_bFullReport;
 
 
 
@@ -1634,59 +1646,65 @@ bool XFoil::blsolve()
     int iv(0), kv(0), ivp(0), k(0), l(0), ivte1(0), ivz(0);
     double pivot(0), vtmp(0), vtmp1(0), vtmp2(0), vtmp3(0);
 
+    // the mass influence rows of each system line are contiguous, cf. setbl(),
+    // so that the row operations below run over contiguous memory
     ivte1 = isys[iblte[1]][1];
     //
     for (iv=1; iv<=nsys; iv++)
     {
         //
         ivp = iv + 1;
+        double *vm1 = vm[1][iv];
+        double *vm2 = vm[2][iv];
+        double *vm3 = vm[3][iv];
         //
         //====== invert va[iv] block
         //
         //------ normalize first row
         pivot = 1.0 / va[1][1][iv];
         va[1][2][iv] *= pivot;
-        for (l=iv;l<= nsys;l++) vm[1][l][iv] *= pivot;
+        for (l=iv;l<= nsys;l++) vm1[l] *= pivot;
         vdel[1][1][iv] *= pivot;
         vdel[1][2][iv] *= pivot;
         //
         //------ eliminate lower first column in va block
         for (k=2; k<=3; k++)
         {
+            double *vmk = vm[k][iv];
             vtmp = va[k][1][iv];
             va[k][2][iv] -= vtmp*va[1][2][iv];
-            for (int l=iv; l<=nsys; l++) vm[k][l][iv] -= vtmp*vm[1][l][iv];
+            for (l=iv; l<=nsys; l++) vmk[l] -= vtmp*vm1[l];
             vdel[k][1][iv] -= vtmp*vdel[1][1][iv];
             vdel[k][2][iv] -= vtmp*vdel[1][2][iv];
         }
         //
         //------ normalize second row
         pivot = 1.0 / va[2][2][iv];
-        for (l=iv; l<= nsys; l++) vm[2][l][iv] *=pivot;
+        for (l=iv; l<= nsys; l++) vm2[l] *=pivot;
         vdel[2][1][iv] *= pivot;
         vdel[2][2][iv] *= pivot;
         //
         //------ eliminate lower second column in va block
         k = 3;
         vtmp = va[k][2][iv];
-        for (l=iv; l<=nsys; l++) vm[k][l][iv] -= vtmp*vm[2][l][iv];
+        for (l=iv; l<=nsys; l++) vm3[l] -= vtmp*vm2[l];
         vdel[k][1][iv] -= vtmp*vdel[2][1][iv];
         vdel[k][2][iv] -= vtmp*vdel[2][2][iv];
 
         //------ normalize third row
-        pivot = 1.0/vm[3][iv][iv];
-        for (l=ivp; l<=nsys; l++) vm[3][l][iv] *= pivot;
+        pivot = 1.0/vm3[iv];
+        for (l=ivp; l<=nsys; l++) vm3[l] *= pivot;
         vdel[3][1][iv] *= pivot;
         vdel[3][2][iv] *= pivot;
         //
         //
         //------ eliminate upper third column in va block
-        vtmp1 = vm[1][iv][iv];
-        vtmp2 = vm[2][iv][iv];
+        vtmp1 = vm1[iv];
+        vtmp2 = vm2[iv];
         for(l=ivp;l<= nsys;l++)
         {
-            vm[1][l][iv] -= vtmp1*vm[3][l][iv];
-            vm[2][l][iv] -= vtmp2*vm[3][l][iv];
+            vm1[l] -= vtmp1*vm3[l];
+            vm2[l] -= vtmp2*vm3[l];
         }
         vdel[1][1][iv] -= vtmp1*vdel[3][1][iv];
         vdel[2][1][iv] -= vtmp2*vdel[3][1][iv];
@@ -1695,7 +1713,7 @@ bool XFoil::blsolve()
 
         //------ eliminate upper second column in va block
         vtmp = va[1][2][iv];
-        for (l=ivp; l<=nsys;l++) vm[1][l][iv] -= vtmp*vm[2][l][iv];
+        for (l=ivp; l<=nsys;l++) vm1[l] -= vtmp*vm2[l];
 
         vdel[1][1][iv] -= vtmp*vdel[2][1][iv];
         vdel[1][2][iv] -= vtmp*vdel[2][2][iv];
@@ -1706,10 +1724,11 @@ bool XFoil::blsolve()
             //====== eliminate vb(iv+1) block][ rows  1 -> 3
             for (k=1; k<= 3;k++)
             {
+                double *vmk = vm[k][ivp];
                 vtmp1 = vb[k][ 1][ivp];
                 vtmp2 = vb[k][ 2][ivp];
-                vtmp3 = vm[k][iv][ivp];
-                for(l=ivp; l<= nsys;l++) vm[k][l][ivp] -= (vtmp1*vm[1][l][iv]+ vtmp2*vm[2][l][iv]+vtmp3*vm[3][l][iv]);
+                vtmp3 = vmk[iv];
+                for(l=ivp; l<= nsys;l++) vmk[l] -= (vtmp1*vm1[l]+ vtmp2*vm2[l]+vtmp3*vm3[l]);
                 vdel[k][1][ivp] -= (vtmp1*vdel[1][1][iv]+vtmp2*vdel[2][1][iv]+ vtmp3*vdel[3][1][iv]);
                 vdel[k][2][ivp] -= (vtmp1*vdel[1][2][iv]+vtmp2*vdel[2][2][iv]+ vtmp3*vdel[3][2][iv]);
             }
@@ -1721,11 +1740,12 @@ bool XFoil::blsolve()
                 //
                 for(k=1;k<=3;k++)
                 {
+                    double *vmk = vm[k][ivz];
                     vtmp1 = vz[k][1];
                     vtmp2 = vz[k][2];
                     for (l=ivp;l<= nsys;l++)
                     {
-                        vm[k][l][ivz] -=(vtmp1*vm[1][l][iv]+ vtmp2*vm[2][l][iv]);
+                        vmk[l] -=(vtmp1*vm1[l]+ vtmp2*vm2[l]);
                     }
                     vdel[k][1][ivz] -= (vtmp1*vdel[1][1][iv]+ vtmp2*vdel[2][1][iv]);
                     vdel[k][2][ivz] -= (vtmp1*vdel[1][2][iv]+ vtmp2*vdel[2][2][iv]);
@@ -1737,53 +1757,40 @@ bool XFoil::blsolve()
                 //====== eliminate lower vm column
                 for(kv=iv+2; kv<= nsys;kv++)
                 {
-                    vtmp1 = vm[1][iv][kv];
-                    vtmp2 = vm[2][iv][kv];
-                    vtmp3 = vm[3][iv][kv];
-
-                    if(fabs(vtmp1)>vaccel)
+                    for(k=1; k<=3; k++)
                     {
-                        for(l=ivp;l<= nsys;l++) vm[1][l][kv] -= vtmp1*vm[3][l][iv];
-                        vdel[1][1][kv] -= vtmp1*vdel[3][1][iv];
-                        vdel[1][2][kv] -= vtmp1*vdel[3][2][iv];
-                    }
-
-                    if(fabs(vtmp2)>vaccel)
-                    {
-                        for (l=ivp;l<=nsys;l++) vm[2][l][kv] -= vtmp2*vm[3][l][iv];
-                        vdel[2][1][kv] -= vtmp2*vdel[3][1][iv];
-                        vdel[2][2][kv] -= vtmp2*vdel[3][2][iv];
-                    }
-
-                    if(fabs(vtmp3)>vaccel)
-                    {
-                        for(l=ivp;l<=nsys;l++) vm[3][l][kv] -= vtmp3*vm[3][l][iv];
-                        vdel[3][1][kv] -= vtmp3*vdel[3][1][iv];
-                        vdel[3][2][kv] -= vtmp3*vdel[3][2][iv];
+                        double *vmk = vm[k][kv];
+                        vtmp = vmk[iv];
+                        if(fabs(vtmp)>vaccel)
+                        {
+                            for(l=ivp;l<= nsys;l++) vmk[l] -= vtmp*vm3[l];
+                            vdel[k][1][kv] -= vtmp*vdel[3][1][iv];
+                            vdel[k][2][kv] -= vtmp*vdel[3][2][iv];
+                        }
                     }
-
                 }
             }
         }
     }//1000
 
 
-    for (iv=nsys; iv>=2; iv--)
+    //------ eliminate upper vm columns
+    // same subtraction order as the column sweep iv=nsys..2 of the original code,
+    // but each row of vm is read contiguously
+    for (kv=nsys-1; kv>=1; kv--)
     {
-        //------ eliminate upper vm columns
-        vtmp = vdel[3][1][iv];
-        for (kv=iv-1; kv>=1;kv--)
+        for(k=1; k<=3; k++)
         {
-            vdel[1][1][kv] -= vm[1][iv][kv]*vtmp;
-            vdel[2][1][kv] -= vm[2][iv][kv]*vtmp;
-            vdel[3][1][kv] -= vm[3][iv][kv]*vtmp;
-        }
-        vtmp = vdel[3][2][iv];
-        for (kv=iv-1; kv>=1;kv--)
-        {
-            vdel[1][2][kv] -= vm[1][iv][kv]*vtmp;
-            vdel[2][2][kv] -= vm[2][iv][kv]*vtmp;
-            vdel[3][2][kv] -= vm[3][iv][kv]*vtmp;
+            double const *vmk = vm[k][kv];
+            double d1 = vdel[k][1][kv];
+            double d2 = vdel[k][2][kv];
+            for (iv=nsys; iv>kv; iv--)
+            {
+                d1 -= vmk[iv]*vdel[3][1][iv];
+                d2 -= vmk[iv]*vdel[3][2][iv];
+            }
+            vdel[k][1][kv] = d1;
+            vdel[k][2][kv] = d2;
         }
     }
     return true;
@@ -2519,7 +2526,7 @@ bool XFoil::cpcalc(int n, double q[], double qinf, double minf, double cp[])
 
 void XFoil::writeString(const std::string &str, bool bFullReport)
 {
-    if(!bFullReport && !s_bFullReport) return;
+    if(!bFullReport && !m_bFullReport) return;
     m_Report.append(str);
 }
 
@@ -2940,7 +2947,7 @@ bool XFoil::Gauss(int nn, double z[][6], double r[5]){
   *                                                     *
   *                              mark drela  1984       *
   ****************************************************** */
-bool XFoil::Gauss(int nn, double z[IQX][IQX], double r[IQX]){
+bool XFoil::Gauss(int nn, XFoilArray &z, double r[]){
     // techwinder : only one rhs is enough ! nrhs = 1
     // dimension z(nsiz,nsiz), r(nsiz,nrhs)
 
@@ -3516,6 +3523,8 @@ bool XFoil::ggcalc()
     double bbb[IQX];
     //    double psiinf;
 
+    sizeWorkspace();
+
     cosa = cos(alfa);
     sina = sin(alfa);
 
@@ -3652,7 +3661,7 @@ bool XFoil::ggcalc()
 
 
 
-bool XFoil::baksub(int n, double a[IQX][IQX], int indx[], double b[])
+bool XFoil::baksub(int n, XFoilArray const &a, int indx[], double b[])
 {
     double sum(0);
     int i(0), ii(0), ll(0), j(0);
@@ -4239,7 +4248,7 @@ bool XFoil::lefind(double &sle, double x[], double xp[], double y[], double yp[]
  *    *******************************************************
 */
 
-bool XFoil::ludcmp(int n, double a[IQX][IQX], int indx[IQX])
+bool XFoil::ludcmp(int n, XFoilArray &a, int indx[])
 {
     //    bool bimaxok = false;
     int imax(0);//added techwinder
@@ -4752,7 +4761,7 @@ stop110:
             }
 
             tran = false;
-            if(s_bCancel) return false;
+            if(isInstanceCancelled()) return false;
         }//1000 continue
     }// 2000 continue
     return true;
@@ -6458,6 +6467,31 @@ bool XFoil::pswlin(int i, double xi, double yi, double nxi, double nyi, double &
 
 
 
+/**
+ * Calculates the airfoil part of the source influence matrix dij.
+ * Depends only on the panel geometry, not on the wake.
+ */
+void XFoil::calcAirfoilDij()
+{
+    std::vector<double> bbb(m_nqx, 0.0);
+
+    for (int j=1; j<=n; j++)
+    {
+        //------- multiply each dpsi/sig vector by inverse of factored dpsi/dgam matrix
+        for (int iu=0; iu<m_nqx; iu++) bbb[iu] = bij[iu][j];//techwinder : create a dummy array
+        baksub(n+1,aij,aijpiv,bbb.data());
+        for (int iu=0; iu<m_nqx; iu++) bij[iu][j] = bbb[iu];
+
+        //------- store resulting dgam/dsig = dqtan/dsig vector
+        for (int i=1; i<=n; i++)
+        {
+            dij[i][j] = bij[i][j];
+        }
+    }
+    ladij = true;
+}
+
+
 /** -----------------------------------------------------
  *        calculates source panel influence coefficient
  *        matrix for current airfoil and wake geometry.
@@ -6466,31 +6500,16 @@ bool XFoil::qdcalc()
 {
     int i(0), j(0), k(0), iu(0), iw(0);
     double psi(0), psi_n(0);
-    double bbb[IQX];
-    memset(bbb, 0, IQX*sizeof(double));
+
+    sizeWorkspace();
+    std::vector<double> bbb(m_nqx, 0.0);
 
     //TRACE("calculating source influence matrix ...\n");
     std::string str = "   Calculating source influence matrix ...\n";
     writeString(str);
 
-    if(!ladij)
-    {
-        //----- calculate source influence matrix for airfoil surface if it doesn't exist
-        for (j=1; j<=n; j++)
-        {
-            //------- multiply each dpsi/sig vector by inverse of factored dpsi/dgam matrix
-            for (iu=0; iu<IQX; iu++) bbb[iu] = bij[iu][j];//techwinder : create a dummy array
-            baksub(n+1,aij,aijpiv,bbb);
-            for (iu=0; iu<IQX; iu++) bij[iu][j] = bbb[iu];
-
-            //------- store resulting dgam/dsig = dqtan/dsig vector
-            for (i=1; i<=n; i++)
-            {
-                dij[i][j] = bij[i][j];
-            }
-        }
-        ladij = true;
-    }
+    //----- calculate source influence matrix for airfoil surface if it doesn't exist
+    if(!ladij) calcAirfoilDij();
 
     //---- set up coefficient matrix of dpsi/dm on wake
     for (i=1; i<=n; i++)
@@ -6528,10 +6547,10 @@ for(int i=1; i<=n; i++)
     for(j=n+1; j<=n+nw;j++)
     {
         //        baksub(iqx,n+1,aijpiv,j);
-        for (iu=0; iu<IQX; iu++) bbb[iu] = bij[iu][j];//techwinder: create a dummy array
+        for (iu=0; iu<m_nqx; iu++) bbb[iu] = bij[iu][j];//techwinder: create a dummy array
 
-        baksub(n+1,aij,aijpiv,bbb);
-        for (iu=0; iu<IQX; iu++) bij[iu][j] = bbb[iu];
+        baksub(n+1,aij,aijpiv,bbb.data());
+        for (iu=0; iu<m_nqx; iu++) bij[iu][j] = bbb[iu];
     }
 
     //---- set the source influence matrix for the wake sources
@@ -7068,6 +7087,206 @@ bool XFoil::segspld(double x[],double xs[],double s[],int n, double xs1, double
  *     The local BL system  coefficients are then incorporated into
  *     the global Newton system.
  * ------------------------------------------------- */
+/**
+ * Sizes the influence matrices and the arrays of the bl newton system to the current number of panels.
+ * The arrays are only reallocated when the number of panels changes,
+ * in which case the influence matrices are flagged for recalculation.
+ */
+void XFoil::sizeWorkspace()
+{
+    int nwx = std::min(n/8+2, IWX); // same number of wake nodes as in xyWake()
+    int nqx = n+7;     // the mixed-inverse system has n+5 unknowns, 1-based
+    int nzx = n+nwx+2; // airfoil and wake nodes, 1-based
+
+    if(nqx==m_nqx && nzx==m_nzx) return;
+
+    m_nqx = nqx;
+    m_nzx = nzx;
+
+    aij.resize(nqx, nqx);
+    bij.resize(nqx, nzx);
+    cij.resize(nwx+1, nqx);
+    dij.resize(nzx, nzx);
+    q.resize(nqx, nqx);
+    for(int k=1; k<4; k++) // 1-based
+    {
+        va[k].resize(3, nzx);
+        vb[k].resize(3, nzx);
+        vdel[k].resize(3, nzx);
+        vm[k].resize(nzx, nzx);
+    }
+
+    lqaij = false;
+    ladij = false;
+    lwdij = false;
+}
+
+/**
+ * Returns a FNV-1a hash of the current panel geometry.
+ * The instances with the same key have the same inviscid influence matrices.
+ */
+uint64_t XFoil::geometryKey() const
+{
+    uint64_t hash = 14695981039346656037ULL;
+    auto add = [&hash](void const *data, size_t nBytes)
+    {
+        unsigned char const *bytes = static_cast<unsigned char const*>(data);
+        for(size_t i=0; i<nBytes; i++)
+        {
+            hash ^= bytes[i];
+            hash *= 1099511628211ULL;
+        }
+    };
+    add(&n, sizeof(int));
+    add(x+1, n*sizeof(double));
+    add(y+1, n*sizeof(double));
+    return hash;
+}
+
+
+/**
+ * Builds the inviscid influence matrices which depend only on the panel geometry,
+ * so that they can be saved before the first operating point is calculated.
+ */
+bool XFoil::makeInviscidSystem()
+{
+    sizeWorkspace();
+    if(!lgamu || !lqaij)
+    {
+        if(!ggcalc()) return false;
+    }
+    if(!ladij) calcAirfoilDij();
+    return true;
+}
+
+
+void XFoil::saveInviscidSystem(XFoilInviscid &sys) const
+{
+    sys.m_Key = geometryKey();
+    sys.m_n = n;
+
+    int const na = n+2; // rows and columns 0 to n+1
+    sys.m_aij.resize(na*na);
+    sys.m_bij.resize(na*(n+1));
+    sys.m_dij.resize((n+1)*(n+1));
+    sys.m_gamu.resize(na*ISX);
+    sys.m_aijpiv.resize(na);
+
+    for(int i=0; i<na; i++)
+    {
+        std::copy(aij[i], aij[i]+na,  sys.m_aij.data()+i*na);
+        std::copy(bij[i], bij[i]+n+1, sys.m_bij.data()+i*(n+1));
+        for(int k=0; k<ISX; k++) sys.m_gamu[i*ISX+k] = gamu[i][k];
+        sys.m_aijpiv[i] = aijpiv[i];
+    }
+    for(int i=0; i<=n; i++)
+        std::copy(dij[i], dij[i]+n+1, sys.m_dij.data()+i*(n+1));
+}
+
+
+/**
+ * Restores the inviscid influence matrices saved by an instance with the same panel geometry.
+ * @return false if the geometry does not match.
+ */
+bool XFoil::restoreInviscidSystem(XFoilInviscid const &sys)
+{
+    if(sys.m_n!=n || sys.m_Key!=geometryKey()) return false;
+
+    sizeWorkspace();
+
+    int const na = n+2;
+    for(int i=0; i<na; i++)
+    {
+        std::copy(sys.m_aij.data()+i*na,    sys.m_aij.data()+(i+1)*na,    aij[i]);
+        std::copy(sys.m_bij.data()+i*(n+1), sys.m_bij.data()+(i+1)*(n+1), bij[i]);
+        for(int k=0; k<ISX; k++) gamu[i][k] = sys.m_gamu[i*ISX+k];
+        aijpiv[i] = sys.m_aijpiv[i];
+    }
+    for(int i=0; i<=n; i++)
+        std::copy(sys.m_dij.data()+i*(n+1), sys.m_dij.data()+(i+1)*(n+1), dij[i]);
+
+    //---- set inviscid alpha=0,90 surface speeds for this geometry, as in ggcalc
+    for (int i=1; i<=n+1; i++)
+    {
+        qinvu[i][1] = gamu[i][1];
+        qinvu[i][2] = gamu[i][2];
+    }
+
+    lqaij = true;
+    lgamu = true;
+    ladij = true;
+    lwdij = false;
+    return true;
+}
+
+
+void XFoil::saveBLState(XFoilBLState &state) const
+{
+    state.m_Key   = geometryKey();
+    state.m_Re    = reinf;
+    state.m_Alpha = alfa*180.0/PI;
+    state.m_Cl    = cl;
+
+    memcpy(state.thet, thet, sizeof(thet));
+    memcpy(state.dstr, dstr, sizeof(dstr));
+    memcpy(state.ctau, ctau, sizeof(ctau));
+    memcpy(state.uedg, uedg, sizeof(uedg));
+    memcpy(state.mass, mass, sizeof(mass));
+    memcpy(state.xssi, xssi, sizeof(xssi));
+    memcpy(state.vti,  vti,  sizeof(vti));
+    memcpy(state.ipan, ipan, sizeof(ipan));
+    memcpy(state.isys, isys, sizeof(isys));
+    memcpy(state.iblte,  iblte,  sizeof(iblte));
+    memcpy(state.nbl,    nbl,    sizeof(nbl));
+    memcpy(state.itran,  itran,  sizeof(itran));
+    memcpy(state.xssitr, xssitr, sizeof(xssitr));
+    memcpy(state.wgap,   wgap,   sizeof(wgap));
+    state.nsys   = nsys;
+    state.ist    = ist;
+    state.nw     = nw;
+    state.sst    = sst;
+    state.sst_go = sst_go;
+    state.sst_gp = sst_gp;
+}
+
+
+/**
+ * Restores the boundary layer of a converged operating point on the same panel geometry.
+ * The next viscous calculation starts from this state instead of marching a new boundary layer,
+ * in the same way as the next point of an aoa sequence.
+ * @return false if the geometry does not match.
+ */
+bool XFoil::restoreBLState(XFoilBLState const &state)
+{
+    if(state.m_Key!=geometryKey()) return false;
+
+    memcpy(thet, state.thet, sizeof(thet));
+    memcpy(dstr, state.dstr, sizeof(dstr));
+    memcpy(ctau, state.ctau, sizeof(ctau));
+    memcpy(uedg, state.uedg, sizeof(uedg));
+    memcpy(mass, state.mass, sizeof(mass));
+    memcpy(xssi, state.xssi, sizeof(xssi));
+    memcpy(vti,  state.vti,  sizeof(vti));
+    memcpy(ipan, state.ipan, sizeof(ipan));
+    memcpy(isys, state.isys, sizeof(isys));
+    memcpy(iblte,  state.iblte,  sizeof(iblte));
+    memcpy(nbl,    state.nbl,    sizeof(nbl));
+    memcpy(itran,  state.itran,  sizeof(itran));
+    memcpy(xssitr, state.xssitr, sizeof(xssitr));
+    memcpy(wgap,   state.wgap,   sizeof(wgap));
+    nsys   = state.nsys;
+    ist    = state.ist;
+    nw     = state.nw;
+    sst    = state.sst;
+    sst_go = state.sst_go;
+    sst_gp = state.sst_gp;
+
+    lblini = true;
+    lipan  = true;
+    return true;
+}
+
+
 bool XFoil::setbl()
 {
     int i(0), ibl(0), iv(0),iw(0), j(0), js(0), jv(0), jbl(0), is(0);
@@ -7101,6 +7320,7 @@ bool XFoil::setbl()
     double xi_ule1(0), xi_ule2(0);
     double ami(0), tte_tte1(0), tte_tte2(0), cte_tte1(0), cte_tte2(0), cte_cte1(0), cte_cte2(0);
 
+    sizeWorkspace();
 
     //---- set the cl used to define mach, reynolds numbers
     if(lalfa) clmr = cl;
@@ -7369,7 +7589,7 @@ bool XFoil::setbl()
             //---- stuff bl system coefficients into main jacobian matrix
 
             for( jv=1; jv<= nsys;jv++){
-                vm[1][jv][iv] = vs1[1][3]*d1_m[jv] + vs1[1][4]*u1_m[jv]
+                vm[1][iv][jv] = vs1[1][3]*d1_m[jv] + vs1[1][4]*u1_m[jv]
                         + vs2[1][3]*d2_m[jv] + vs2[1][4]*u2_m[jv]
                         + (vs1[1][5] + vs2[1][5] + vsx[1])
                         *(xi_ule1*ule1_m[jv] + xi_ule2*ule2_m[jv]);
@@ -7396,7 +7616,7 @@ bool XFoil::setbl()
                     *(xi_ule1*dule1 + xi_ule2*dule2);
 
             for(jv=1; jv<= nsys;jv++){
-                vm[2][jv][iv] = vs1[2][3]*d1_m[jv] + vs1[2][4]*u1_m[jv]
+                vm[2][iv][jv] = vs1[2][3]*d1_m[jv] + vs1[2][4]*u1_m[jv]
                         + vs2[2][3]*d2_m[jv] + vs2[2][4]*u2_m[jv]
                         + (vs1[2][5] + vs2[2][5] + vsx[2])
                         *(xi_ule1*ule1_m[jv] + xi_ule2*ule2_m[jv]);
@@ -7424,7 +7644,7 @@ bool XFoil::setbl()
 
             //memory overlap problem
             for(jv=1; jv<= nsys;jv++){
-                vm[3][jv][iv] = vs1[3][3]*d1_m[jv] + vs1[3][4]*u1_m[jv]
+                vm[3][iv][jv] = vs1[3][3]*d1_m[jv] + vs1[3][4]*u1_m[jv]
                         + vs2[3][3]*d2_m[jv] + vs2[3][4]*u2_m[jv]
                         + (vs1[3][5] + vs2[3][5] + vsx[3])
                         *(xi_ule1*ule1_m[jv] + xi_ule2*ule2_m[jv]);
@@ -7794,6 +8014,7 @@ bool XFoil::specal()
     int i(0), irlx(0), itcl(0);
 
     //---- calculate surface vorticity distributions for alpha = 0, 90 degrees
+    sizeWorkspace();
     if(!lgamu || !lqaij) ggcalc();
 
     cosa = cos(alfa);
@@ -7902,6 +8123,7 @@ bool XFoil::speccl()
     int i(0), ital(0);
 
     //---- calculate surface vorticity distributions for alpha = 0, 90 degrees
+    sizeWorkspace();
     if(!lgamu || !lqaij) ggcalc();
 
     //---- set freestream mach from specified cl -- mach will be held fixed
@@ -8846,7 +9068,7 @@ bool XFoil::trchek()
     //TRACE("trchek2 - n2 convergence failed\n");
     str = "trchek2 - n2 convergence failed\n";
     writeString(str, true);
-    if(s_bCancel) return false;
+    if(isInstanceCancelled()) return false;
 stop101:
 
     //---- test for free or forced transition
@@ -12110,6 +12332,8 @@ bool XFoil::mixed(int kqsp)
     double res=0;
     double dnmax=0, dgmax=0;
 
+    sizeWorkspace();
+
     //---- distance of internal control point ahead of sharp te
     //    (fraction of smaller panel length adjacent to te)
     bwt = 0.1;
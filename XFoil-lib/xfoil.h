@@ -39,8 +39,12 @@ See http://raphael.mit.edu/xfoil for more information.
 */
 
 
+#include <algorithm>
+#include <atomic>
 #include <string>
 #include <complex>
+#include <cstdint>
+#include <vector>
 
 
 #include <xfoil-lib_global.h>
@@ -68,6 +72,62 @@ struct blData
 
 
 
+/**
+ * A 2d array of doubles allocated on the heap, indexed as a[i][j] like the fixed size C arrays which it replaces.
+ * Used for the XFoil workspaces whose size depends on the number of panels.
+ */
+class XFoilArray
+{
+    public:
+        void resize(int nrows, int ncols) {m_nCols=ncols; m_Data.assign(size_t(nrows)*size_t(ncols), 0.0);}
+        void clear() {m_Data.clear(); m_Data.shrink_to_fit(); m_nCols=0;}
+        void zero() {std::fill(m_Data.begin(), m_Data.end(), 0.0);}
+        int rows() const {return m_nCols>0 ? int(m_Data.size()/size_t(m_nCols)) : 0;}
+        int cols() const {return m_nCols;}
+
+        double       *operator[](int i)       {return m_Data.data()+size_t(i)*size_t(m_nCols);}
+        double const *operator[](int i) const {return m_Data.data()+size_t(i)*size_t(m_nCols);}
+
+    private:
+        std::vector<double> m_Data;
+        int m_nCols=0;
+};
+
+
+/**
+ * The inviscid influence matrices which depend only on the panel geometry,
+ * i.e. the LU-factored vorticity matrix, the unit vorticity distributions and
+ * the airfoil part of the source influence matrix.
+ * Used to share the factorization between the instances which analyze the same geometry.
+ */
+struct XFoilInviscid
+{
+    uint64_t m_Key=0;                  /**< the hash of the panel geometry, cf. XFoil::geometryKey() */
+    int m_n=0;                         /**< the number of panels */
+    std::vector<double> m_aij, m_bij, m_dij, m_gamu;
+    std::vector<int> m_aijpiv;
+};
+
+
+/**
+ * The boundary layer variables and the panel pointers of a converged operating point.
+ * Used to warm start the boundary layer of an operating point on the same panel geometry.
+ */
+struct XFoilBLState
+{
+    uint64_t m_Key=0;                  /**< the hash of the panel geometry, cf. XFoil::geometryKey() */
+    double m_Re=0, m_Alpha=0, m_Cl=0;  /**< the operating point at which the state was saved, alpha in degrees */
+
+    double thet[IVX][ISX], dstr[IVX][ISX], ctau[IVX][ISX], uedg[IVX][ISX], mass[IVX][ISX];
+    double xssi[IVX][ISX], vti[IVX][ISX];
+    int ipan[IVX][ISX], isys[IVX][ISX];
+    int iblte[ISX], nbl[ISX], itran[ISX];
+    double xssitr[ISX], wgap[IWX];
+    int nsys=0, ist=0, nw=0;
+    double sst=0, sst_go=0, sst_gp=0;
+};
+
+
 class XFOILLIBSHARED_EXPORT XFoil
 {
     public:
@@ -137,12 +197,32 @@ class XFOILLIBSHARED_EXPORT XFoil
         void setClSpec(double cl) {clspec=cl;}
 
 
+        // the static cancel flag stops all the running instances
         static bool isCancelled() {return s_bCancel;}
         static void setCancel(bool bCancel) {s_bCancel=bCancel;}
+
+        // the static settings are the defaults of the new instances
         static void setFullReport(bool bFull) {s_bFullReport=bFull;}
         static bool bFullReport() {return s_bFullReport;}
-        static double VAccel() {return vaccel;}
-        static void setVAccel(double accel) {vaccel=accel;}
+        static double VAccel() {return s_VAccel;}
+        static void setVAccel(double accel) {s_VAccel=accel;}
+
+        // the instance's own settings, which do not interfere with the other instances running in parallel
+        bool isInstanceCancelled() const {return m_bCancelled || s_bCancel;}
+        void setInstanceCancel(bool bCancel) {m_bCancelled=bCancel;}
+        bool bInstanceFullReport() const {return m_bFullReport;}
+        void setInstanceFullReport(bool bFull) {m_bFullReport=bFull;}
+        double instanceVAccel() const {return vaccel;}
+        void setInstanceVAccel(double accel) {vaccel=accel;}
+
+        int workspaceSize() const {return m_nqx;}
+
+        uint64_t geometryKey() const;
+        bool makeInviscidSystem();
+        void saveInviscidSystem(XFoilInviscid &sys) const;
+        bool restoreInviscidSystem(XFoilInviscid const &sys);
+        void saveBLState(XFoilBLState &state) const;
+        bool restoreBLState(XFoilBLState const &state);
 
     private:
 
@@ -197,7 +277,7 @@ class XFOILLIBSHARED_EXPORT XFoil
                     double acrit, double &ax,
                     double &ax_hk1, double &ax_t1, double &ax_rt1, double &ax_a1,
                     double &ax_hk2, double &ax_t2, double &ax_rt2, double &ax_a2);
-        bool baksub(int n, double a[IQX][IQX],int indx[], double b[]);
+        bool baksub(int n, const XFoilArray &a, int indx[], double b[]);
         bool bldif(int ityp);
         bool blkin();
         bool blmid(int ityp);
@@ -218,7 +298,7 @@ class XFOILLIBSHARED_EXPORT XFoil
 
         bool gamqv();
         bool Gauss(int nn, double z[][6], double r[5]);
-        bool Gauss(int nn, double z[IQX][IQX], double r[IQX]);
+        bool Gauss(int nn, XFoilArray &z, double r[]);
         bool geopar(double x[], double xp[], double y[], double yp[], double s[],
                    int n, double t[], double &sle, double &chord,
                    double &area, double &radle, double &angte,
@@ -244,7 +324,7 @@ class XFOILLIBSHARED_EXPORT XFoil
         bool iblsys();
         bool lefind(double &sle, double x[], double xp[], double y[], double yp[], double s[], int n);
         void lerscl(double *x, double *xp, double* y, double *yp, double *s, int n, double doc, double rfac, double *xnew,double *ynew);
-        bool ludcmp(int n, double a[IQX][IQX],int indx[IQX]);
+        bool ludcmp(int n, XFoilArray &a, int indx[]);
         bool mhinge();
         bool mrchdu();
         bool mrchue();
@@ -259,6 +339,8 @@ class XFOILLIBSHARED_EXPORT XFoil
         bool segspl( double x[], double xs[], double s[], int n);
         bool segspld(double x[], double xs[], double s[], int n, double xs1, double xs2);
         bool setbl();
+        void sizeWorkspace();
+        void calcAirfoilDij();
         bool setexp(double s[],double ds1,double smax,int nn);
         bool sinvrt(double &si,double xi,double x[],double xs[],double s[],int n);
 
@@ -288,10 +370,14 @@ class XFOILLIBSHARED_EXPORT XFoil
 
 
     public:
-        static double vaccel;
+        static double s_VAccel;
         static bool s_bCancel;
         static bool s_bFullReport;
 
+        double vaccel;                      /**< the drop tolerance for the bl system solver */
+        bool m_bFullReport;
+        std::atomic<bool> m_bCancelled;
+
         std::string m_Report;
 
         double agte,ag0,qim0,qimold;
@@ -446,11 +532,12 @@ class XFOILLIBSHARED_EXPORT XFoil
     //    double sigte_a,gamte_a;
         double dste,aste;
         double qinv[IZX],qinvu[IZX][3], qinv_a[IZX];
-        double q[IQX][IQX],dq[IQX],dzdg[IQX],dzdn[IQX],dzdm[IZX],dqdg[IQX];
+        XFoilArray q;
+        double dq[IQX],dzdg[IQX],dzdn[IQX],dzdm[IZX],dqdg[IQX];
         double dqdm[IZX],qtan1,qtan2,z_qinf,z_alfa,z_qdof0,z_qdof1,z_qdof2,z_qdof3;
-        double aij[IQX][IQX];
-        double bij[IQX][IZX],dij[IZX][IZX];
-        double cij[IWX][IQX];
+        // the workspaces sized to the number of panels, cf. sizeWorkspace()
+        int m_nqx, m_nzx;
+        XFoilArray aij, bij, dij, cij;
         double hopi,qopi;
 
 
@@ -491,7 +578,9 @@ class XFOILLIBSHARED_EXPORT XFoil
         double cfm, cfm_ms, cfm_re, cfm_u1, cfm_t1, cfm_d1, cfm_u2, cfm_t2, cfm_d2;
         double xt, xt_a1, xt_ms, xt_re, xt_xf, xt_x1, xt_t1, xt_d1, xt_u1,
               xt_x2, xt_t2, xt_d2, xt_u2;
-        double va[4][3][IZX],vb[4][3][IZX],vdel[4][3][IZX],vm[4][IZX][IZX],vz[4][3];
+        XFoilArray va[4], vb[4], vdel[4];
+        XFoilArray vm[4];    /**< mass-influence blocks, vm[k][iv][jv] = coefficient of mass jv in equation k of system line iv; rows are contiguous */
+        double vz[4][3];
 
     //    int ncpref, napol[9], npol, ipact, nlref, icolp[9],icolr[9],imatyp[9],iretyp[9], nxypol[9],npolref, ndref[4][9];
     //    double c1sav[74], c2sav[74];
@@ -867,6 +956,7 @@ class XFOILLIBSHARED_EXPORT XFoil
     c   va,vb[...]  diagonal and off-diagonal blocks in bl newton system
     c   vz[..]      way-off-diagonal block at te station line
     c   vm[...]     mass-influence coefficient vectors in bl newton system
+    c               stored as vm[k][iv][jv], i.e. transposed w.r.t. the fortran vm(k,jv,iv)
     c   vdel[..]    residual and solution vectors in bl newton system
     c
     c   rmsbl       rms change from bl newton system solution
@@ -209,6 +209,7 @@
 #include <api/units.h>
 #include <api/utils.h>
 #include <api/wingxfl.h>
+#include <api/xfoilcache.h>
 #include <api/xfoiltask.h>
 
 
@@ -2538,6 +2539,12 @@ bool MainFrame::saveProject(const QString &filepath)
     m_FilePath = PathName;
     fpb.close();
 
+    if(XFoilCache::bStore())
+    {
+        QFileInfo fi(PathName);
+        XFoilCache::save((fi.path() + QDir::separator() + fi.completeBaseName() + ".otf").toStdString());
+    }
+
     saveSettings();
 
     setSavedState(true);
@@ -3204,6 +3211,10 @@ void MainFrame::setProjectName(const QString &PathName)
     QFileInfo fi(PathName);
     m_ProjectName = fi.completeBaseName();
 
+    // the XFoil OTF results are cached in a file next to the project file
+    if(PathName.length()) XFoilCache::setStoreFile((fi.path() + QDir::separator() + m_ProjectName + ".otf").toStdString());
+    else                  XFoilCache::setStoreFile(std::string());
+
     m_plabProjectName->setText(m_ProjectName);
 }
 
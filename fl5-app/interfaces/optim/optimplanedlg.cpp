@@ -356,6 +356,13 @@ void OptimPlaneDlg::makeCommonWt()
 
             m_pchMultiThread = new QCheckBox("Multi-threaded");
             m_pchMultiThread->setChecked(PSOTask::s_bMultiThreaded);
+            m_pchMultiThread->setToolTip("<p>Evaluate the particles of the swarm concurrently.</p>");
+
+            m_pchDeterministic = new QCheckBox("Fixed random seed:");
+            m_pchDeterministic->setChecked(PSOTask::s_bDeterministic);
+            m_pchDeterministic->setToolTip("<p>Use the same sequence of random numbers at each run, "
+                                           "so that a run can be reproduced in single or multi-threaded mode.</p>");
+            m_pieRandomSeed = new IntEdit(int(PSOTask::s_RandomSeed));
 
             QLabel *pFlow5Link = new QLabel;
             pFlow5Link->setText("<a href=https://flow5.tech/docs/flow5_doc/MOPSO/MOPSO.html>https://flow5.tech/docs/flow5_doc/MOPSO/MOPSO.html</a>");
@@ -388,10 +395,12 @@ void OptimPlaneDlg::makeCommonWt()
             pSwarmLayout->addWidget(m_ppbRestoreDefault,  8, 2);
 
             pSwarmLayout->addWidget(m_pchMultiThread,     9,1,1,3);
+            pSwarmLayout->addWidget(m_pchDeterministic,   10,1);
+            pSwarmLayout->addWidget(m_pieRandomSeed,      10,2);
 
-            pSwarmLayout->addWidget(pFlow5Link,           11,1,1,2);
+            pSwarmLayout->addWidget(pFlow5Link,           12,1,1,2);
 
-            pSwarmLayout->setRowStretch(10,1);
+            pSwarmLayout->setRowStretch(11,1);
         }
         m_pPSOFrame->setLayout(pSwarmLayout);
     }
@@ -643,6 +652,8 @@ void OptimPlaneDlg::loadSettings(QSettings &settings)
         PSOTask::s_PopSize         = settings.value("PopSize",         PSOTask::s_PopSize).toInt();
         PSOTask::s_MaxIter         = settings.value("MaxIter",         PSOTask::s_MaxIter).toInt();
         PSOTask::s_bMultiThreaded  = settings.value("Multithreaded",   PSOTask::s_bMultiThreaded).toBool();
+        PSOTask::s_bDeterministic  = settings.value("Deterministic",   PSOTask::s_bDeterministic).toBool();
+        PSOTask::s_RandomSeed      = settings.value("RandomSeed",      PSOTask::s_RandomSeed).toUInt();
 
         PSOTask::s_CognitiveWeight = settings.value("CognitiveWeight", PSOTask::s_CognitiveWeight).toDouble();
         PSOTask::s_SocialWeight    = settings.value("SocialWeight",    PSOTask::s_SocialWeight).toDouble();
@@ -664,6 +675,8 @@ void OptimPlaneDlg::saveSettings(QSettings &settings)
         settings.setValue("PopSize",         PSOTask::s_PopSize);
         settings.setValue("MaxIter",         PSOTask::s_MaxIter);
         settings.setValue("Multithreaded",   PSOTask::s_bMultiThreaded);
+        settings.setValue("Deterministic",   PSOTask::s_bDeterministic);
+        settings.setValue("RandomSeed",      PSOTask::s_RandomSeed);
 
         settings.setValue("InertiaWeight",   PSOTask::s_InertiaWeight);
         settings.setValue("CognitiveWeight", PSOTask::s_CognitiveWeight);
@@ -867,6 +880,8 @@ void OptimPlaneDlg::readData()
     PSOTask::s_MaxIter         = m_pieMaxIter->value();
     PSOTask::s_PopSize         = m_pieSwarmSize->value();
     PSOTask::setMultithreaded(m_pchMultiThread->isChecked());
+    PSOTask::setDeterministic(m_pchDeterministic->isChecked());
+    PSOTask::setRandomSeed(quint32(std::max(0, m_pieRandomSeed->value())));
 }
 
 
@@ -23,10 +23,12 @@
 *****************************************************************************/
 
 
-#include <QtConcurrent/QtConcurrent>
+#include <QCoreApplication>
+#include <QDebug>
 
 #include <interfaces/optim/psotask.h>
 #include <api/constants.h>
+#include <api/threadpool.h>
 
 int    PSOTask::s_ArchiveSize     = 10;
 double PSOTask::s_InertiaWeight   = 0.3;
@@ -36,7 +38,9 @@ double PSOTask::s_ProbRegenerate  = 0.07;
 
 int  PSOTask::s_PopSize           = 17;
 int  PSOTask::s_MaxIter           = 30;
-bool PSOTask::s_bMultiThreaded    = false; /** @todo change */
+bool PSOTask::s_bMultiThreaded    = true;
+bool PSOTask::s_bDeterministic    = false;
+quint32 PSOTask::s_RandomSeed     = 0;
 
 
 QVector<Vector3d> PSOTask::s_DebugPts;
@@ -48,6 +52,8 @@ PSOTask::PSOTask()
     m_bConverged = false;
     m_Iter = 0;
     m_Status = xfl::PENDING;
+
+    seedGenerator();
 }
 
 
@@ -143,8 +149,21 @@ void PSOTask::restoreDefaults()
 }
 
 
+/**
+ * Seeds the random generator of the task, either with the user-defined seed
+ * to reproduce a run, or with a random value.
+ */
+void PSOTask::seedGenerator()
+{
+    if(s_bDeterministic) m_Generator.seed(s_RandomSeed);
+    else                 m_Generator.seed(QRandomGenerator::global()->generate());
+}
+
+
 void PSOTask::onMakeParticleSwarm()
 {
+    seedGenerator();
+
     m_Swarm.resize(s_PopSize);
 
     // no need to multithread, no fitness calculation
@@ -154,33 +173,7 @@ void PSOTask::onMakeParticleSwarm()
         makeRandomParticle(&particle);
     }
 
-    if(s_bMultiThreaded)
-    {
-//        QThreadPool::globalInstance()->setMaxThreadCount(4);
-         QFutureSynchronizer<void> futureSync;
-        for (int isw=0; isw<m_Swarm.size(); ++isw)
-        {
-           Particle &particle = m_Swarm[isw];
-#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
-           futureSync.addFuture(QtConcurrent::run(QThreadPool::globalInstance(), this, &PSOTask::calcFitness, &particle, false, true));
-#else
-           futureSync.addFuture(QtConcurrent::run(&PSOTask::calcFitness, this, &particle, false, true));
-#endif
-        }
-        futureSync.waitForFinished();
-    }
-    else
-    {
-        for(int i=0; i<m_Swarm.size(); i++)
-        {
-            calcFitness(&m_Swarm[i], false, true);
-            if(isCancelled()) break;
-        }
-    }
-
-    for(int i=0; i<m_Swarm.size(); i++)
-        for(int iobj=0; iobj<m_Objective.size(); iobj++)
-            m_Swarm[i].setError(iobj, error(&m_Swarm.at(i), iobj));
+    updateFitnesses(true);
 
     outputMsg(QString::asprintf("Made %d random particles\n", int(m_Swarm.size())));
 
@@ -220,34 +213,18 @@ void PSOTask::onStartIterations()
 
 void PSOTask::onIteration()
 {
-    if(s_bMultiThreaded)
+    // move the particles sequentially so that the random draws do not depend on the threads,
+    // then evaluate the swarm concurrently
+    for (int isw=0; isw<m_Swarm.size(); ++isw)
     {
-        //m_Swarm.detach(); //kill detach issues altogether
-        Particle *particles = new Particle[m_Swarm.size()];
-        for(int ip=0; ip<m_Swarm.size(); ip++)   particles[ip] = m_Swarm.at(ip);
-
-        QFutureSynchronizer<void> futureSync;
-        for (int isw=0; isw<m_Swarm.size(); ++isw)
-        {
-#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
-            futureSync.addFuture(QtConcurrent::run(this, &PSOTask::moveParticle, particles+isw));
-#else
-            futureSync.addFuture(QtConcurrent::run(&PSOTask::moveParticle, this, particles+isw));
-#endif
-        }
-        futureSync.waitForFinished();
-
-        for(int ip=0; ip<m_Swarm.size(); ip++)  m_Swarm[ip] = particles[ip];
-        delete [] particles;
+        moveParticle(&m_Swarm[isw]);
     }
-    else
+
+    if(m_Status!=xfl::CANCELLED)
     {
+        updateFitnesses();
         for (int isw=0; isw<m_Swarm.size(); ++isw)
-        {
-            Particle &particle = m_Swarm[isw];
-            moveParticle(&particle);
-            if(m_Status==xfl::CANCELLED) break;
-        }
+            m_Swarm[isw].updateBest();
     }
 
     m_Iter++;
@@ -310,7 +287,7 @@ void PSOTask::onIteration()
         for (int isw=0; isw<m_Swarm.size(); ++isw)
         {
             Particle &particle = m_Swarm[isw];
-            double regen = QRandomGenerator::global()->bounded(1.0);
+            double regen = m_Generator.bounded(1.0);
             if (regen<s_ProbRegenerate)
             {
                 bool bIsParetoParticle = false;
@@ -332,7 +309,8 @@ void PSOTask::onIteration()
 }
 
 
-void PSOTask::moveParticle(Particle *pParticle) const
+/** Updates the velocity and the position of the particle; the fitness is calculated afterwards for the whole swarm */
+void PSOTask::moveParticle(Particle *pParticle)
 {
     double newpos=0, vel=0, deltap=0;
     double r1=0, r2=0;
@@ -340,11 +318,11 @@ void PSOTask::moveParticle(Particle *pParticle) const
     int igbest=0, ipbest=0;
 
     // select a random best in the pareto frontier
-    igbest = QRandomGenerator::global()->bounded(m_Pareto.size());
+    igbest = m_Generator.bounded(m_Pareto.size());
     Particle const &globalbest = m_Pareto.at(igbest);
 
     // select a random best in the personal bests
-    ipbest = QRandomGenerator::global()->bounded(pParticle->nBest());
+    ipbest = m_Generator.bounded(pParticle->nBest());
 
     // update the velocity
     for(int j=0; j<pParticle->dimension(); j++)
@@ -354,12 +332,12 @@ void PSOTask::moveParticle(Particle *pParticle) const
         {
             // this variable is newly activated, so give it a random velocity
             deltap *= 0.5; // start slowly
-            vel = -deltap/2.0 + QRandomGenerator::global()->bounded(deltap);
+            vel = -deltap/2.0 + m_Generator.bounded(deltap);
             pParticle->setVel(j, vel);
         }
 
-        r1 = QRandomGenerator::global()->bounded(1.0);
-        r2 = QRandomGenerator::global()->bounded(1.0);
+        r1 = m_Generator.bounded(1.0);
+        r2 = m_Generator.bounded(1.0);
 
         vel = s_InertiaWeight * pParticle->vel(j) +
               s_CognitiveWeight * r1 * (pParticle->bestPos(ipbest, j) - pParticle->pos(j)) +
@@ -377,13 +355,6 @@ void PSOTask::moveParticle(Particle *pParticle) const
     }
 
     checkBounds(*pParticle);
-
-    if(m_Status==xfl::CANCELLED) return;
-
-    calcFitness(pParticle); // note: do not parallelize in derived class
-    for(int i=0; i<m_Objective.size(); i++)  pParticle->setError(i, error(pParticle, i));
-
-    pParticle->updateBest();
 }
 
 
@@ -407,7 +378,7 @@ void PSOTask::postPSOEvent(int iBest)
 
 
 #define PARTICLEBESTSIZE 3
-void PSOTask::makeRandomParticle(Particle *pParticle) const
+void PSOTask::makeRandomParticle(Particle *pParticle)
 {
     int nBest = std::min(int(m_Objective.size()), PARTICLEBESTSIZE);
     pParticle->resizeArrays(int(m_Variable.size()), int(m_Objective.size()), nBest);
@@ -418,13 +389,13 @@ void PSOTask::makeRandomParticle(Particle *pParticle) const
     for(int i=0; i<pParticle->dimension(); i++)
     {
         deltap = m_Variable.at(i).m_Max - m_Variable.at(i).m_Min;
-        pos = m_Variable.at(i).m_Min + QRandomGenerator::global()->bounded(deltap);
+        pos = m_Variable.at(i).m_Min + m_Generator.bounded(deltap);
 
         pParticle->setPos(i, pos);
         pParticle->initializeBest();
 
         deltav = deltap/2.0; // start slowly
-        vel = -deltav/2.0 + QRandomGenerator::global()->bounded(deltav);
+        vel = -deltav/2.0 + m_Generator.bounded(deltav);
         pParticle->setVel(i, vel);
     }
 }
@@ -511,7 +482,7 @@ void PSOTask::makeParetoFrontier()
     {
         while(m_Pareto.size()>s_ArchiveSize)
         {
-            m_Pareto.removeAt(QRandomGenerator::global()->bounded(m_Pareto.size()));
+            m_Pareto.removeAt(m_Generator.bounded(m_Pareto.size()));
         }
     }
 }
@@ -552,27 +523,20 @@ void listOptVariables(QVector<OptVariable> const &variables)
 }
 
 
-void PSOTask::updateFitnesses()
+/**
+ * Calculates the fitness and the errors of all the particles of the swarm.
+ * In multi-threaded mode, the particles are distributed one by one over the threads of the library's pool,
+ * so that the analyses share the same thread budget; the fitness of a particle depends only on its position
+ * so that the results do not depend on the order of execution.
+ */
+void PSOTask::updateFitnesses(bool bTrace)
 {
-    if(s_bMultiThreaded)
-    {
-        QFutureSynchronizer<void> futureSync;
-        for (int isw=0; isw<m_Swarm.size(); ++isw)
-        {
-           Particle &particle = m_Swarm[isw];
-#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
-           futureSync.addFuture(QtConcurrent::run(QThreadPool::globalInstance(), this, &PSOTask::calcFitness, &particle, false, true));
-#else
-           futureSync.addFuture(QtConcurrent::run(&PSOTask::calcFitness, this, &particle, false, true));
-#endif
-        }
-        futureSync.waitForFinished();
-    }
-    else
+    Particle *particles = m_Swarm.data(); // detach once, before the threads access the swarm
+    ThreadPool::parallelFor(0, int(m_Swarm.size()), [this, particles, bTrace](int i0, int i1)
     {
-        for(int i=0; i<m_Swarm.size(); i++)
-            calcFitness(&m_Swarm[i]);
-    }
+        for(int i=i0; i<i1; i++)
+            calcFitness(particles+i, false, bTrace);
+    }, s_bMultiThreaded, 1, [this]() {return isCancelled();});
 
     for(int i=0; i<m_Swarm.size(); i++)
     {
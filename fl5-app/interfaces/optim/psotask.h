@@ -25,6 +25,7 @@
 #pragma once
 
 #include <QObject>
+#include <QRandomGenerator>
 
 
 
@@ -102,6 +103,8 @@ class PSOTask : public QObject
         virtual void calcFitness(Particle *pParticle, bool bLong=false, bool bTrace=false) const = 0;
 
         static void setMultithreaded(bool b) {s_bMultiThreaded=b;}
+        static void setDeterministic(bool b) {s_bDeterministic=b;}
+        static void setRandomSeed(quint32 seed) {s_RandomSeed=seed;}
 
         void makeParetoFrontier();
 
@@ -112,7 +115,7 @@ class PSOTask : public QObject
         void setObjective(int iobj, const OptObjective &obj) {m_Objective[iobj] = obj;}
         void updateErrors();
 
-        void updateFitnesses();
+        void updateFitnesses(bool bTrace=false);
 
         QVector<Particle> const &thePareto() const {return m_Pareto;}
         int paretoSize() const {return m_Pareto.size();}
@@ -128,8 +131,9 @@ class PSOTask : public QObject
         void outputMsg(QString const &msg);
 
     private:
-        virtual void makeRandomParticle(Particle *pParticle) const;
-        void moveParticle(Particle *pParticle) const;
+        virtual void makeRandomParticle(Particle *pParticle);
+        void moveParticle(Particle *pParticle);
+        void seedGenerator();
 
         void postIterEvent(int iBest);
         void postPSOEvent(int iBest);
@@ -167,11 +171,15 @@ class PSOTask : public QObject
         // size = dim
         std::vector<OptVariable> m_Variable;
 
+        QRandomGenerator m_Generator; /**< the source of all the random draws of the task; the draws are made sequentially so that the sequence does not depend on the thread scheduling */
+
 
     public:
         static int  s_PopSize;
         static int  s_MaxIter;
         static bool s_bMultiThreaded;
+        static bool s_bDeterministic;   /**< if true, the generator is seeded with s_RandomSeed so that the runs can be reproduced */
+        static quint32 s_RandomSeed;
         static int    s_ArchiveSize;
         static double s_InertiaWeight;
         static double s_CognitiveWeight;
@@ -38,6 +38,9 @@ PlanePolar PSOTaskPlane::s_WPolar;
 
 PSOTaskPlane::PSOTaskPlane() : PSOTask()
 {
+    m_pPlaneXfl = nullptr;
+    m_bConnectedMesh = false;
+    m_bConnectedThick = false;
 }
 
 
@@ -149,6 +152,8 @@ void PSOTaskPlane::calcFitness(Particle *pParticle, bool bLong, bool bTrace) con
     wpolar.setReferenceSpanLength(pPlaneXfl->projectedSpan());
 
     pPlaneXfl->makePlane(wpolar.bThickSurfaces(), true, wpolar.isTriangleMethod());
+    if(wpolar.isTriangleMethod())
+        pTask->setMeshConnected(copyMeshConnections(pPlaneXfl, wpolar.bThickSurfaces()));
     pTask->setObjects(pPlaneXfl, &wpolar);
 
     std::vector<double> opplist{pParticle->pos(0)}; // first coordinate is the aoa
@@ -156,9 +161,11 @@ void PSOTaskPlane::calcFitness(Particle *pParticle, bool bLong, bool bTrace) con
 
 
     pTask->run();
-    if(pTask->planeOppList().size()!=0)
+
+    // read the results from the polar rather than from the operating point, which the task does not keep
+    if(wpolar.dataSize()>0)
     {
-        PlaneOpp *pPOpp = pTask->planeOppList().front();
+        AeroForces const &af = wpolar.aeroForce(0);
         for(int iobj=0; iobj<pParticle->nObjectives(); iobj++)
         {
             OptObjective const &obj = m_Objective.at(iobj);
@@ -166,36 +173,35 @@ void PSOTaskPlane::calcFitness(Particle *pParticle, bool bLong, bool bTrace) con
             {
                 default:
                 case 0: //Cl
-                    pParticle->setFitness(iobj, pPOpp->aeroForces().CL());
+                    pParticle->setFitness(iobj, af.CL());
                     break;
                 case 1: //Cd
-                    pParticle->setFitness(iobj, pPOpp->aeroForces().CD());
+                    pParticle->setFitness(iobj, af.CD());
                     break;
                 case 2: //Cl/Cd
-                    pParticle->setFitness(iobj, pPOpp->aeroForces().CL()/pPOpp->aeroForces().CD());
+                    pParticle->setFitness(iobj, af.CL()/af.CD());
                     break;
                 case 3: //Cl(3/2)/Cd
                 {
-                    double Cl = pPOpp->aeroForces().CL();
-                    double Cd = pPOpp->aeroForces().CD();
+                    double Cl = af.CL();
+                    double Cd = af.CD();
                     pParticle->setFitness(iobj, sqrt(Cl*Cl*Cl/(Cd*Cd)));
                     break;
                 }
                 case 4: //Cm
-                    pParticle->setFitness(iobj, pPOpp->aeroForces().Cm());
+                    pParticle->setFitness(iobj, af.Cm());
                     break;
                 case 5: //m.g.Vz
-                    pParticle->setFitness(iobj, pPOpp->aeroForces().Cm());
+                    pParticle->setFitness(iobj, af.Cm());
                     break;
                 case 6: //bending moment
-                    if(pPOpp->hasWOpp())
-                        pParticle->setFitness(iobj, pPOpp->WOpp(0).m_MaxBending);
+                    if(pPlaneXfl->nWings()>0)
+                        pParticle->setFitness(iobj, wpolar.maxBending(0));
                     else
                         pParticle->setFitness(iobj, LARGEVALUE);
                     break;
             }
         }
-        delete pPOpp;
     }
 
     delete pPlaneXfl;
@@ -205,5 +211,31 @@ void PSOTaskPlane::calcFitness(Particle *pParticle, bool bLong, bool bTrace) con
 }
 
 
+/**
+ * Copies the connections of the base plane's triangular mesh into the meshes of the particle's plane
+ * if both meshes have the same panels and node indexes.
+ * The base plane's mesh is connected once on first use; concurrent calls wait until it is available.
+ * @return true if the connections have been copied, false if the plane's mesh needs to be connected.
+ */
+bool PSOTaskPlane::copyMeshConnections(PlaneXfl *pPlaneXfl, bool bThickSurfaces) const
+{
+    if(!m_pPlaneXfl) return false;
+
+    std::lock_guard<std::mutex> lock(m_MeshMutex);
+    if(!m_bConnectedMesh || m_bConnectedThick!=bThickSurfaces)
+    {
+        PlaneXfl baseplane;
+        baseplane.duplicate(m_pPlaneXfl);
+        baseplane.makePlane(bThickSurfaces, true, true);
+        if(!baseplane.connectTriMesh(true, false, true)) return false;
+        m_ConnectedMesh = baseplane.refTriMesh();
+        m_bConnectedThick = bThickSurfaces;
+        m_bConnectedMesh = true;
+    }
 
+    if(!pPlaneXfl->refTriMesh().hasSameTopology(m_ConnectedMesh)) return false;
 
+    pPlaneXfl->refTriMesh().copyConnections(m_ConnectedMesh);
+    pPlaneXfl->triMesh().copyConnections(m_ConnectedMesh);
+    return true;
+}
@@ -24,7 +24,10 @@
 
 #pragma once
 
+#include <mutex>
+
 #include <interfaces/optim/psotask.h>
+#include <api/trimesh.h>
 
 
 class PlaneXfl;
@@ -42,17 +45,25 @@ class PSOTaskPlane : public PSOTask
 
     public:
         PSOTaskPlane();
-        void setPlane(PlaneXfl const*pPlaneXfl) {m_pPlaneXfl=pPlaneXfl;}
+        void setPlane(PlaneXfl const*pPlaneXfl) {m_pPlaneXfl=pPlaneXfl; m_bConnectedMesh=false;}
 
         static PlanePolar &staticPolar() {return s_WPolar;}
         static void setStaticPolar(PlanePolar const &wpolar);
 
     private:
         void calcFitness(Particle *pParticle, bool bLong=false, bool bTrace=false) const override;
+        bool copyMeshConnections(PlaneXfl *pPlaneXfl, bool bThickSurfaces) const;
 
         static PlanePolar s_WPolar;
         PlaneXfl const *m_pPlaneXfl;
 
+        /** The connected triangular mesh of the base plane, built on first use. The particles only change
+         *  the positions of the nodes, so their connections are copied from this mesh if the topology is unchanged. */
+        mutable TriMesh m_ConnectedMesh;
+        mutable bool m_bConnectedMesh;
+        mutable bool m_bConnectedThick;   /**< the type of surfaces of the connected mesh */
+        mutable std::mutex m_MeshMutex;
+
 };
 
 
@@ -29,18 +29,28 @@
 //#define _DISABLE_CONSTEXPR_MUTEX_CONSTRUCTOR
 
 #include <QCoreApplication>
+#include <QElapsedTimer>
 #include <QFileInfo>
 #include <QDir>
 
+#include <atomic>
+#include <chrono>
+#include <list>
+#include <memory>
+#include <thread>
+
 #include <core/xflcore.h>
 #include <interfaces/script/xflexecutor.h>
 
 #include <api/flow5events.h>
 #include <api/llttask.h>
+#include <api/lucache.h>
 #include <api/objects3d.h>
+#include <api/panelanalysis.h>
 #include <api/planeopp.h>
 #include <api/planetask.h>
 #include <api/planexfl.h>
+#include <api/quadmesh.h>
 #include <api/task3d.h>
 #include <api/trimesh.h>
 #include <api/planepolar.h>
@@ -49,6 +59,10 @@
 #include <api/xmlplanepolarreader.h>
 
 
+int XflExecutor::s_MaxConcurrentTasks = 4;
+double XflExecutor::s_MemoryBudget = 4096.0;
+
+
 XflExecutor::XflExecutor(QObject *pParent) : QObject()
 {
     m_pEventDest = pParent;
@@ -701,12 +715,27 @@ void XflExecutor::onRunExecutor()
 
 void XflExecutor::runPlaneAnalyses()
 {
-    QString strong;
     m_AnalysisStatus = xfl::RUNNING;
 
-    // since each task makes use of all allowed threads,
-    // no point in parallelizing the tasks;
-    // each task is run in sequence asynchronously
+    // the tasks run their parallel loops in the library's shared thread pool,
+    // so that running several tasks at the same time does not increase the number of
+    // worker threads; the serial parts of a task, i.e. the meshing, the loop on the operating points,
+    // the viscous interpolations and the stability analysis, then overlap with the parallel parts of the others
+    int nThreads = PanelAnalysis::isMultiThreaded() ? std::max(1, PanelAnalysis::maxThreadCount()) : 1;
+    if(s_MaxConcurrentTasks>1 && nThreads>1 && m_PlaneExecList.size()>1)
+        runTasksConcurrently();
+    else
+        runTasksInSequence();
+
+    m_AnalysisStatus = xfl::FINISHED;
+
+//    qApp->postEvent(m_pEventDest, new QEvent(TASK3D_END_EVENT));
+}
+
+
+void XflExecutor::runTasksInSequence()
+{
+    QElapsedTimer t;
 
     for(int ia=0; ia<m_PlaneExecList.size(); ia++)
     {
@@ -716,39 +745,271 @@ void XflExecutor::runPlaneAnalyses()
 //        connect(pTask, &Task3d::outputMessage, this, &XflExecutor::traceLog);
 //        connect(this, SIGNAL(cancelTask()), pTask, SLOT(onCancel()));
 
-        if(pTask)
-        {
-            pTask->setKeepOpps(m_bMakePlaneOpps);
-        }
+        if(!pTask) continue;
+
+        pTask->setKeepOpps(m_bMakePlaneOpps);
 
         PlaneTask *pPlaneTask = dynamic_cast<PlaneTask*>(pTask);
         LLTTask *pLLTTask = dynamic_cast<LLTTask*>(pTask);
 
+        traceLog("Launching plane analysis: " + taskName(pTask) + "\n");
+        t.start();
+
         if(pPlaneTask)
         {
-            strong = "Launching plane analysis: " + QString::fromStdString(pPlaneTask->plane()->name()) + " / " + QString::fromStdString(pPlaneTask->wPolar()->name()) + "\n";
-            traceLog(strong);
-
             emit taskStarted(ia);
             runPanelTask(pPlaneTask);
             cleanUpPlaneTask(pPlaneTask);
         }
         else if(pLLTTask)
         {
-            strong = "Launching plane analysis: " + QString::fromStdString(pLLTTask->plane()->name()) + " / " + QString::fromStdString(pLLTTask->wPolar()->name()) + "\n";
-            traceLog(strong);
-
             emit taskStarted(ia);
             runLLTTask(pLLTTask);
-
             cleanUpLLTTask(pLLTTask);
         }
+
+        traceLog(QString::asprintf("Analysis time: %.3f s\n\n", double(t.elapsed())/1000.0));
+
         if(isCancelled()) break;
     }
+}
 
-    m_AnalysisStatus = xfl::FINISHED;
 
-//    qApp->postEvent(m_pEventDest, new QEvent(TASK3D_END_EVENT));
+/**
+ * Runs the tasks of the batch with several tasks in progress at the same time.
+ *
+ * A pending task is started when:
+ *   - fewer than s_MaxConcurrentTasks tasks are running,
+ *   - no running task uses the same plane, since the tasks rotate and modify the plane's mesh,
+ *   - the estimated size of its influence matrix fits in what remains of the memory budget;
+ *     a task is always started if no other task is running, whatever its size.
+ * The tasks are considered in the order of the list, so that the small analyses
+ * which follow a large one in the list fill the remaining budget while it runs.
+ * The messages of the tasks are forwarded to the log from this thread only.
+ */
+void XflExecutor::runTasksConcurrently()
+{
+    struct RunningTask
+    {
+        int m_iTask=-1;
+        Task3d *m_pTask=nullptr;
+        Plane const *m_pPlane=nullptr;
+        double m_Memory=0.0;
+        QElapsedTimer m_Timer;
+        std::thread m_Thread;
+        std::shared_ptr<std::atomic<bool>> m_pbDone;
+    };
+
+    int nSlots = std::min(s_MaxConcurrentTasks, std::max(1, PanelAnalysis::maxThreadCount()));
+    traceLog(QString::asprintf("Running up to %d analyses at a time, with a memory budget of %.0f MB\n\n", nSlots, s_MemoryBudget));
+
+    std::vector<int> pending;
+    for(int ia=0; ia<m_PlaneExecList.size(); ia++)
+        if(m_PlaneExecList.at(ia)) pending.push_back(ia);
+
+    std::vector<double> memory(m_PlaneExecList.size(), -1.0); // the estimated memory of each task, once its mesh has been built
+    std::list<RunningTask> running;
+    double usedmemory = 0.0;
+
+    while(pending.size() || running.size())
+    {
+        if(isCancelled()) pending.clear();
+
+        // start the pending tasks which fit
+        for(auto it=pending.begin(); it!=pending.end() && int(running.size())<nSlots;)
+        {
+            int iTask = *it;
+            Task3d *pTask = m_PlaneExecList.at(iTask);
+            PlaneTask *pPlaneTask = dynamic_cast<PlaneTask*>(pTask);
+            LLTTask *pLLTTask = dynamic_cast<LLTTask*>(pTask);
+            Plane const *pPlane = pPlaneTask ? pPlaneTask->plane() : (pLLTTask ? pLLTTask->plane() : nullptr);
+
+            bool bBusy = false;
+            for(RunningTask const &rt : running)
+                if(rt.m_pPlane==pPlane) {bBusy=true; break;}
+            if(bBusy) {++it; continue;}
+
+            bool bMeshed = false;
+            if(memory[iTask]<0.0)
+            {
+                if(pPlaneTask)
+                {
+                    makeTaskMesh(pPlaneTask);
+                    bMeshed = true;
+                }
+                memory[iTask] = estimatedMemory(pTask);
+            }
+
+            if(running.size() && usedmemory+memory[iTask]>s_MemoryBudget) {++it; continue;}
+
+            if(pPlaneTask && !bMeshed) makeTaskMesh(pPlaneTask);
+            if(isCancelled()) break;
+
+            pTask->setKeepOpps(m_bMakePlaneOpps);
+
+            traceLog("Launching plane analysis: " + taskName(pTask) +
+                     QString::asprintf(" (%.0f MB)\n", memory[iTask]));
+            emit taskStarted(iTask);
+
+            running.emplace_back();
+            RunningTask &rt = running.back();
+            rt.m_iTask   = iTask;
+            rt.m_pTask   = pTask;
+            rt.m_pPlane  = pPlane;
+            rt.m_Memory  = memory[iTask];
+            rt.m_pbDone  = std::make_shared<std::atomic<bool>>(false);
+            rt.m_Timer.start();
+            std::shared_ptr<std::atomic<bool>> pbDone = rt.m_pbDone;
+            if(pPlaneTask)
+            {
+                rt.m_Thread = std::thread([pPlaneTask, pbDone]() {pPlaneTask->run(); *pbDone=true;});
+            }
+            else if(pLLTTask)
+            {
+                rt.m_Thread = std::thread([pLLTTask, pbDone]() {pLLTTask->initializeAnalysis(); pLLTTask->run(); *pbDone=true;});
+            }
+            else
+                *pbDone = true;
+
+            usedmemory += rt.m_Memory;
+            it = pending.erase(it);
+        }
+
+        // forward the messages and collect the tasks which have finished
+        bool bFinished = false;
+        for(auto it=running.begin(); it!=running.end();)
+        {
+            flushTaskMessages(it->m_pTask);
+            if(*it->m_pbDone)
+            {
+                if(it->m_Thread.joinable()) it->m_Thread.join();
+                flushTaskMessages(it->m_pTask);
+                cleanUpTask(it->m_pTask);
+                traceLog("Analysis time for " + taskName(it->m_pTask) +
+                         QString::asprintf(": %.3f s\n\n", double(it->m_Timer.elapsed())/1000.0));
+                usedmemory -= it->m_Memory;
+                it = running.erase(it);
+                bFinished = true;
+            }
+            else ++it;
+        }
+
+        if(!bFinished && running.size())
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+    }
+}
+
+
+/**
+ * Returns the estimated memory in MB of the influence matrix of the task, from the size of its mesh.
+ * With a dense solver, includes the copies of the matrix which the task may keep:
+ * the factorization stored in the LUCache, the matrix of the last fill in the control polars
+ * with the incremental fill, and the double precision wake coefficients of the mixed precision solver.
+ */
+double XflExecutor::estimatedMemory(Task3d const *pTask)
+{
+    PlaneTask const *pPlaneTask = dynamic_cast<PlaneTask const*>(pTask);
+    if(!pPlaneTask) return 0.0; // LLT
+
+    PlanePolar const *pWPolar = pPlaneTask->wPolar();
+    Plane const *pPlane = pPlaneTask->plane();
+
+    double N = 0;
+    int nTrailing = 0; // the number of wake coefficients in each row
+    if(pWPolar->isQuadMethod())
+    {
+        PlaneXfl const *pPlaneXfl = dynamic_cast<PlaneXfl const*>(pPlane);
+        if(pPlaneXfl)
+        {
+            QuadMesh const &quadmesh = pPlaneXfl->quadMesh();
+            N = quadmesh.nPanels();
+            for(int p=0; p<quadmesh.nPanels(); p++)
+                if(quadmesh.panelAt(p).isTrailing()) nTrailing++;
+        }
+    }
+    else
+    {
+        TriMesh const &trimesh = pPlane->triMesh();
+        N = trimesh.nPanels();
+        for(int p=0; p<trimesh.nPanels(); p++)
+            if(trimesh.panelAt(p).isTrailing()) nTrailing++;
+        if(pWPolar->isTriLinearMethod())
+        {
+            N *= 3;
+            nTrailing *= 3;
+        }
+    }
+    double wordsize = PanelAnalysis::bDoublePrecision() ? sizeof(double) : sizeof(float);
+    double matrixMB = N*N*wordsize/1024.0/1024.0;
+    double MB = matrixMB;
+
+    xfl::enumMatrixSolver solver = PanelAnalysis::matrixSolver();
+    bool bDense = solver!=xfl::HMATRIX && solver!=xfl::OUTOFCORE && !(solver==xfl::BARNESHUT && pWPolar->isTriangleMethod());
+    if(!bDense) return MB;
+
+    if(solver==xfl::DENSELU && LUCache::isEnabled())
+    {
+        bool bSpill = LUCache::spillDirectory().length() && matrixMB>LUCache::spillSize();
+        if(!bSpill && matrixMB<=LUCache::maxMemory()) MB += matrixMB;
+    }
+
+    if(PanelAnalysis::bIncrementalMatrix() && pWPolar->isControlPolar())
+        MB += matrixMB;
+
+    if(PanelAnalysis::bRefineSolution() && !pWPolar->isVLM())
+        MB += N*double(nTrailing)*sizeof(std::pair<int, double>)/1024.0/1024.0;
+
+    return MB;
+}
+
+
+/** Forwards the messages posted by a running task to the log. */
+void XflExecutor::flushTaskMessages(Task3d *pTask)
+{
+    std::vector<std::string> msgs;
+
+    LLTTask *pLLTTask = dynamic_cast<LLTTask*>(pTask);
+    if(pLLTTask)
+    {
+        std::unique_lock<std::mutex> lck(pLLTTask->m_mtx);
+        while(!pLLTTask->m_theOppQueue.empty())
+        {
+            msgs.push_back(pLLTTask->m_theOppQueue.front().message());
+            pLLTTask->m_theOppQueue.pop();
+        }
+    }
+    else
+    {
+        std::unique_lock<std::mutex> lck(pTask->m_mtx);
+        while(!pTask->m_theMsgQueue.empty())
+        {
+            msgs.push_back(pTask->m_theMsgQueue.front().message());
+            pTask->m_theMsgQueue.pop();
+        }
+    }
+
+    for(std::string const &msg : msgs) traceStdLog(msg);
+}
+
+
+void XflExecutor::cleanUpTask(Task3d *pTask)
+{
+    PlaneTask *pPlaneTask = dynamic_cast<PlaneTask*>(pTask);
+    LLTTask *pLLTTask = dynamic_cast<LLTTask*>(pTask);
+    if     (pPlaneTask) cleanUpPlaneTask(pPlaneTask);
+    else if(pLLTTask)   cleanUpLLTTask(pLLTTask);
+}
+
+
+QString XflExecutor::taskName(Task3d *pTask) const
+{
+    PlaneTask *pPlaneTask = dynamic_cast<PlaneTask*>(pTask);
+    LLTTask *pLLTTask = dynamic_cast<LLTTask*>(pTask);
+    if(pPlaneTask)
+        return QString::fromStdString(pPlaneTask->plane()->name()) + " / " + QString::fromStdString(pPlaneTask->wPolar()->name());
+    else if(pLLTTask)
+        return QString::fromStdString(pLLTTask->plane()->name()) + " / " + QString::fromStdString(pLLTTask->wPolar()->name());
+    return QString();
 }
 
 
@@ -769,7 +1030,8 @@ void XflExecutor::runLLTTask(LLTTask *pLLTTask)
 }
 
 
-void XflExecutor::runPanelTask(PlaneTask *pPlaneTask)
+/** Builds the plane's mesh for the task and makes it the active mesh */
+void XflExecutor::makeTaskMesh(PlaneTask *pPlaneTask)
 {
     // set the appropriate mesh for this task
     bool bThickSurfaces = true;
@@ -797,7 +1059,6 @@ void XflExecutor::runPanelTask(PlaneTask *pPlaneTask)
             pPlaneXfl->refQuadMesh().makeWakePanels(3, 1, pWPolar->bufferWakeLength(), Vector3d(1.0,0,0), false);
         }
     }
-    if(isCancelled()) return;
 
     if(pPlane->isXflType() && pWPolar->isTriangleMethod())
     {
@@ -808,6 +1069,12 @@ void XflExecutor::runPanelTask(PlaneTask *pPlaneTask)
 
     // set the active mesh
     pPlane->restoreMesh();
+}
+
+
+void XflExecutor::runPanelTask(PlaneTask *pPlaneTask)
+{
+    makeTaskMesh(pPlaneTask);
     if(isCancelled()) return;
 
     std::thread p(&PlaneTask::run, pPlaneTask);
@@ -80,6 +80,11 @@ class XflExecutor : public QObject
 
         void runPlaneAnalyses();
 
+        static void setMaxConcurrentTasks(int n) {s_MaxConcurrentTasks=std::max(1,n);}
+        static int maxConcurrentTasks() {return s_MaxConcurrentTasks;}
+        static void setMemoryBudget(double MB) {s_MemoryBudget=MB;}
+        static double memoryBudget() {return s_MemoryBudget;}
+
         void setMakePOpps(bool b) {m_bMakePlaneOpps=b;}
         void setStabDerivatives(bool b) {m_bCompStabDerivatives=b;}
 
@@ -106,6 +111,16 @@ class XflExecutor : public QObject
         void onRunExecutor();
         void onCancel();
 
+    protected:
+        void runTasksInSequence();
+        void runTasksConcurrently();
+        void makeTaskMesh(PlaneTask *pPlaneTask);
+        void flushTaskMessages(Task3d *pTask);
+        void cleanUpTask(Task3d *pTask);
+        QString taskName(Task3d *pTask) const;
+
+        static double estimatedMemory(Task3d const *pTask);
+
     protected:
 
         QObject *m_pEventDest;
@@ -135,5 +150,7 @@ class XflExecutor : public QObject
         QVector<AnalysisRange> m_T7Range;
         std::vector<T8Opp>     m_T8Range;
 
+        static int s_MaxConcurrentTasks;   /**< the max. number of plane analyses run at the same time in a batch */
+        static double s_MemoryBudget;      /**< the memory in MB available to the influence matrices of the analyses run at the same time */
 };
 
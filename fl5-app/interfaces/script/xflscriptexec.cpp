@@ -917,6 +917,7 @@ void XflScriptExec::runFoilAnalyses()
         //initiate the task
         if(pAnalysis->m_pPolar->isType12())
             pXFoilTask->setAnalysisRanges(pAnalysis->range);
+        pXFoilTask->setBatchMode(true);
         pXFoilTask->initialize(pAnalysis, false);
 
         m_nTaskStarted++;
@@ -948,6 +949,7 @@ void XflScriptExec::runFoilAnalyses()
 void XflScriptExec::cleanUpFoilAnalyses()
 {
     XFoil::s_bCancel = false;
+    XFoilTask::clearBatchData();
 
     for(int ia=m_FoilExecList.count()-1; ia>=0; ia--)
     {
@@ -166,7 +166,7 @@ void Analysis2dSettings::onButton(QAbstractButton *pButton)
     {
         XDirect::setKeepOpenOnErrors(true);
         XFoil::setFullReport(false);
-        XFoil::vaccel = 0.01;
+        XFoil::setVAccel(0.01);
         XFoilTask::setCdError(1.0e-3);
         XFoilTask::setMaxIterations(100);
         initWidget();
@@ -190,7 +190,7 @@ void Analysis2dSettings::readData()
     XDirect::setKeepOpenOnErrors(m_pchKeepErrorsOpen->isChecked());
 
     XFoil::setFullReport(m_pchFullReport->isChecked());
-    XFoil::vaccel = m_pdeVAccel->value();
+    XFoil::setVAccel(m_pdeVAccel->value());
     XFoilTask::setCdError(m_pfeCdError->value());
     XFoilTask::setMaxIterations(m_pieIterLimit->value());
 }
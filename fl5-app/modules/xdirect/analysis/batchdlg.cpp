@@ -212,6 +212,7 @@ void BatchDlg::cleanUp()
         delete m_Tasks.at(it);
 
     m_Tasks.clear();
+    XFoilTask::clearBatchData();
 
     if(m_pXFile->isOpen())
     {
@@ -493,6 +494,7 @@ void BatchDlg::batchLaunch()
         analysis.m_pPolar->setVisible(true);
 
         pXFoilTask->setAoAAnalysis(s_bAlpha);
+        pXFoilTask->setBatchMode(true);
 
         pXFoilTask->clearRanges();
 
@@ -146,6 +146,7 @@ void XFoilAnalysisDlg::initializeAnalysis(Foil *pFoil, Polar* pPolar, QVector<An
         m_pXFoilTask->appendRange(rg);
     }
 
+    XFoilTask::setCancelled(false);
     m_pXFoilTask->initialize(*m_pFoil, m_pPolar, XDirect::bStoreOpps());
 
     m_ppto->clear();
@@ -156,7 +157,6 @@ void XFoilAnalysisDlg::initializeAnalysis(Foil *pFoil, Polar* pPolar, QVector<An
 
 void XFoilAnalysisDlg::onCancelClose()
 {
-    XFoil::s_bCancel= true;
     XFoilTask::setCancelled(true);
     if(m_pXFoilTask) m_pXFoilTask->setAnalysisStatus(xfl::CANCELLED);
     else
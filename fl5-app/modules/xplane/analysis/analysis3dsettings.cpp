@@ -26,6 +26,7 @@
 #define _MATH_DEFINES_DEFINED
 
 
+#include <QButtonGroup>
 #include <QFontMetrics>
 #include <QFont>
 #include <QLabel>
@@ -50,16 +51,21 @@
 #include <interfaces/graphs/containers/graphwt.h>
 #include <interfaces/graphs/controls/graphoptions.h>
 #include <interfaces/graphs/graph/graph.h>
+#include <interfaces/script/xflexecutor.h>
 #include <api/boattask.h>
 #include <api/llttask.h>
 #include <api/panelanalysis.h>
+#include <api/lucache.h>
+#include <api/tiledmatrix.h>
 #include <api/planetask.h>
 #include <api/task3d.h>
+#include <api/xfoilcache.h>
 #include <api/planeopp.h>
 #include <api/wingxfl.h>
 #include <api/panel3.h>
 #include <api/panel4.h>
 #include <api/vortex.h>
+#include <api/vortontree.h>
 #include <interfaces/widgets/customwts/floatedit.h>
 #include <interfaces/widgets/customwts/intedit.h>
 
@@ -90,12 +96,24 @@ void Analysis3dSettings::onResetDefaults()
 {
     Task3d::setMaxNRHS(100);
 
+    XflExecutor::setMaxConcurrentTasks(4);
+    XflExecutor::setMemoryBudget(4096.0);
+
     PlaneTask::setViscInitVTwist(false);
     PlaneTask::setViscRelaxFactor(0.5);
     PlaneTask::setMaxViscError(.01);
     PlaneTask::setMaxViscIter(35);
 
+    XFoilCache::setEnabled(false);
+    XFoilCache::setStoreEnabled(false);
+    XFoilCache::setReTolerance(0.01);
+    XFoilCache::setClTolerance(0.02);
+
     PanelAnalysis::setDoublePrecision(true);
+    PanelAnalysis::setMixedPrecision(false);
+    PanelAnalysis::setMatrixSolver(xfl::DENSELU);
+    PanelAnalysis::setIncrementalMatrix(false);
+    LUCache::setEnabled(false);
 
     Vortex::setCoreRadius(0.000001);
     Vortex::setVortexModel(Vortex::POTENTIAL);
@@ -107,6 +125,8 @@ void Analysis3dSettings::onResetDefaults()
     Panel3::setQuadratureOrder(5);
     Panel::setRFF(10);
 
+    VortonTree::setEnabled(true);
+
     setData();
 }
 
@@ -150,9 +170,28 @@ void Analysis3dSettings::setupLayout()
                 pGeomLayout->addWidget(plabWingPanels,       5,1, Qt::AlignRight);
                 pGeomLayout->addWidget(m_pfeMinPanelSize,    5,2);
                 pGeomLayout->addWidget(plabLength1,          5,3);
+                QLabel *plabBatchTasks = new QLabel("Max. concurrent batch analyses=");
+                m_pieBatchTasks = new IntEdit;
+                m_pieBatchTasks->setToolTip("<p>The max. number of plane analyses run at the same time in batch mode.<br>"
+                                            "The analyses share the same threads, so that the small analyses can use "
+                                            "the threads which are idle during the serial parts of the larger ones.<br>"
+                                            "Set to 1 to run the analyses one after the other.</p>");
+                QLabel *plabBatchMemory = new QLabel("Batch memory budget=");
+                QLabel *plabMB = new QLabel("MB");
+                m_pfeBatchMemory = new FloatEdit;
+                m_pfeBatchMemory->setToolTip("<p>The memory available to the influence matrices of the analyses "
+                                             "run at the same time in batch mode.<br>"
+                                             "An analysis is not started if its estimated matrix size exceeds "
+                                             "the remaining budget, unless no other analysis is running.</p>");
+
                 pGeomLayout->addWidget(plabRFF,              6,1, Qt::AlignRight);
                 pGeomLayout->addWidget(m_pfeRFF,             6,2);
-                pGeomLayout->setRowStretch(                  7,1);
+                pGeomLayout->addWidget(plabBatchTasks,       7,1, Qt::AlignRight);
+                pGeomLayout->addWidget(m_pieBatchTasks,      7,2);
+                pGeomLayout->addWidget(plabBatchMemory,      8,1, Qt::AlignRight);
+                pGeomLayout->addWidget(m_pfeBatchMemory,     8,2);
+                pGeomLayout->addWidget(plabMB,               8,3);
+                pGeomLayout->setRowStretch(                  9,1);
                 pGeomLayout->setColumnStretch(               4,1);
             }
             pCommonFrame->setLayout(pGeomLayout);
@@ -253,19 +292,97 @@ void Analysis3dSettings::setupLayout()
                 QLabel *pLabPrecision = new QLabel("Matrix float precision:");
                 m_prbSinglePrecision = new QRadioButton("Single precision, 4 bytes/value");
                 m_prbDoublePrecision = new QRadioButton("Double precision, 8 bytes/value (recommended)");
+                m_prbMixedPrecision  = new QRadioButton("Single precision with iterative refinement, 4 bytes/value");
                 QString precisiontip = "<p>This defines with what precision the influence matrix will be stored. "
                                        "Single precision will use half the memory required for double precision. "
                                        "Accuracy of the results may also be reduced by a few percent.<br>"
                                        "Use single precision only for large calculations where memory allocation "
-                                       "may be an issue.</p>";
+                                       "may be an issue.<br>"
+                                       "With iterative refinement, the matrix is stored and factorized in single precision "
+                                       "and the solutions are corrected to double precision accuracy using residuals "
+                                       "computed in double precision. Each correction requires a new evaluation of the "
+                                       "influence coefficients, so that this option is efficient for the large matrices "
+                                       "where the factorization dominates. Applies to the dense LU solver only.</p>";
                 pLabPrecision->setToolTip(precisiontip);
                 m_prbSinglePrecision->setToolTip(precisiontip);
                 m_prbDoublePrecision->setToolTip(precisiontip);
+                m_prbMixedPrecision->setToolTip(precisiontip);
+                QButtonGroup *pPrecisionGroup = new QButtonGroup(pSolverFrame);
+                pPrecisionGroup->addButton(m_prbSinglePrecision);
+                pPrecisionGroup->addButton(m_prbDoublePrecision);
+                pPrecisionGroup->addButton(m_prbMixedPrecision);
                 pPrecisionLayout->addWidget(pLabPrecision,1,1,1,2);
                 pPrecisionLayout->addWidget(m_prbSinglePrecision,2,2);
                 pPrecisionLayout->addWidget(m_prbDoublePrecision,3,2);
+                pPrecisionLayout->addWidget(m_prbMixedPrecision,4,2);
+
+                QLabel *pLabSolver = new QLabel("Linear solver:");
+                m_prbDenseLU     = new QRadioButton("Dense matrix, LU factorization (recommended)");
+                m_prbTreeSolver  = new QRadioButton("Matrix-free Barnes-Hut tree and GMRES, triangular panels only");
+                m_prbGMRES       = new QRadioButton("Dense matrix, GMRES iterations");
+                m_prbBiCGStab    = new QRadioButton("Dense matrix, BiCGStab iterations");
+                m_prbHMatrix     = new QRadioButton("Hierarchical matrix with ACA compression and GMRES");
+                m_prbOutOfCore   = new QRadioButton("Dense matrix stored on disk, tiled LU factorization");
+                QString solvertip = "<p>The dense solver builds the full influence matrix and uses LAPACK's LU factorization. "
+                                    "Memory grows as N<sup>2</sup> and the factorization time as N<sup>3</sup>.<br>"
+                                    "The tree solver computes the near-field influences exactly and approximates "
+                                    "the far-field influences using an octree of the panels. The system is solved iteratively. "
+                                    "Memory and time grow as N.log(N), at the cost of a small loss of accuracy.<br>"
+                                    "Use the tree solver only for large triangular meshes which cannot be handled by the dense solver. "
+                                    "The tree solver is only available for the triangle methods; the quad and VLM methods use the dense LU solver in its place.<br>"
+                                    "The GMRES and BiCGStab solvers build the full matrix but replace the LU factorization "
+                                    "with iterations preconditioned by the blocks of neighbour panels. "
+                                    "Each solution is used as the initial guess of the next operating point, "
+                                    "which is efficient for the T6 and T7 polars where the matrix is rebuilt at each step.<br>"
+                                    "The hierarchical matrix stores the interactions of distant groups of panels "
+                                    "in compressed low-rank form and solves the system with preconditioned GMRES iterations. "
+                                    "Memory and build time grow as N.log(N) for all panel methods.<br>"
+                                    "The out-of-core solver stores the dense matrix in a scratch file in the temporary directory "
+                                    "and factorizes it by tiles which fit in the memory budget. "
+                                    "Use it only for the meshes whose matrix exceeds the available memory.</p>";
+                pLabSolver->setToolTip(solvertip);
+                m_prbDenseLU->setToolTip(solvertip);
+                m_prbTreeSolver->setToolTip(solvertip);
+                m_prbGMRES->setToolTip(solvertip);
+                m_prbBiCGStab->setToolTip(solvertip);
+                m_prbHMatrix->setToolTip(solvertip);
+                m_prbOutOfCore->setToolTip(solvertip);
+                QButtonGroup *pSolverGroup = new QButtonGroup(pSolverFrame);
+                pSolverGroup->addButton(m_prbDenseLU);
+                pSolverGroup->addButton(m_prbTreeSolver);
+                pSolverGroup->addButton(m_prbGMRES);
+                pSolverGroup->addButton(m_prbBiCGStab);
+                pSolverGroup->addButton(m_prbHMatrix);
+                pSolverGroup->addButton(m_prbOutOfCore);
+                pPrecisionLayout->addWidget(pLabSolver,5,1,1,2);
+                pPrecisionLayout->addWidget(m_prbDenseLU,6,2);
+                pPrecisionLayout->addWidget(m_prbTreeSolver,7,2);
+                pPrecisionLayout->addWidget(m_prbGMRES,8,2);
+                pPrecisionLayout->addWidget(m_prbBiCGStab,9,2);
+                pPrecisionLayout->addWidget(m_prbHMatrix,10,2);
+                pPrecisionLayout->addWidget(m_prbOutOfCore,11,2);
+
+                m_pchIncrementalMatrix = new QCheckBox("Refill only the moved panels in the control polars");
+                m_pchIncrementalMatrix->setToolTip("<p>In the T6 and boat polars, keeps a copy of the influence matrix "
+                                                   "and recomputes only the coefficients of the panels which have moved "
+                                                   "since the previous operating point.<br>"
+                                                   "The copy doubles the memory used by the dense matrix. "
+                                                   "If it cannot be allocated, the matrix is filled in full.<br>"
+                                                   "Applies to the dense matrix solvers only.</p>");
+                pPrecisionLayout->addWidget(m_pchIncrementalMatrix,12,1,1,2);
+
+                m_pchLUCache = new QCheckBox("Keep the LU factorizations for the analyses of the same geometry");
+                m_pchLUCache->setToolTip("<p>Keeps a copy of the factorized influence matrices in memory, "
+                                         "so that they are reused by the next operating points and polars "
+                                         "with the same panels, wake and solver settings, "
+                                         "e.g. by the T6 polars which only change the speed or the inertia.<br>"
+                                         "Each copy uses as much memory as the dense matrix and is of no use "
+                                         "for a geometry which is analysed only once.<br>"
+                                         "Applies to the dense LU solver only.</p>");
+                pPrecisionLayout->addWidget(m_pchLUCache,13,1,1,2);
+
                 pPrecisionLayout->setColumnStretch(3,2);
-                pPrecisionLayout->setRowStretch(4,1);
+                pPrecisionLayout->setRowStretch(14,1);
             }
 
             pSolverFrame->setLayout(pPrecisionLayout);
@@ -310,6 +427,33 @@ void Analysis3dSettings::setupLayout()
                                 "Recommendation: do not activate</p>");
                 m_pchViscInitVTwist->setToolTip(TipInit);
 
+                m_pchOTFCache = new QCheckBox("Cache the XFoil on-the-fly results");
+                tip = "<p>If activated, the results of the on-the-fly XFoil calculations are kept in memory "
+                      "and reused for the wing sections with the same foil, flap angle and transition settings. "
+                      "The Cd and the transition locations are interpolated from the cached points "
+                      "if the section's Re and Cl are within the tolerances.<br>"
+                      "The results are interpolated in Cl but not in Re: a cached point is used as is "
+                      "for any section within the Re tolerance, so that the viscous drag may differ slightly "
+                      "from a direct XFoil calculation.<br>"
+                      "Recommendation: activate for design iterations where speed matters more than accuracy</p>";
+                m_pchOTFCache->setToolTip(tip);
+
+                m_pchOTFCacheStore = new QCheckBox("Save the cache next to the project file");
+                tip = "<p>If activated, the cache is saved in a .otf file next to the project file "
+                      "and is reloaded with the project.</p>";
+                m_pchOTFCacheStore->setToolTip(tip);
+
+                QLabel *pLabReTol = new QLabel("Re tolerance=");
+                QLabel *pLabPercent = new QLabel("%");
+                m_pfeOTFReTolerance = new FloatEdit;
+                m_pfeOTFReTolerance->setToolTip("<p>The max. relative difference of Re between a cached point and a wing section. "
+                                                "The cached results are not corrected for this difference of Re.<br>"
+                                                "Recommendation: 1%</p>");
+                QLabel *pLabClTol = new QLabel("Cl tolerance=");
+                m_pfeOTFClTolerance = new FloatEdit;
+                m_pfeOTFClTolerance->setToolTip("<p>The max. difference of Cl between the cached points and a wing section.<br>"
+                                                "Recommendation: 0.02</p>");
+
                 pViscIterLayout->addWidget(pLabRelax,                 1,1, Qt::AlignRight | Qt::AlignVCenter);
                 pViscIterLayout->addWidget(m_pfeViscPanelRelax,       1,2);
                 pViscIterLayout->addWidget(pLabAlphaCv,               2,1, Qt::AlignRight | Qt::AlignVCenter);
@@ -318,7 +462,14 @@ void Analysis3dSettings::setupLayout()
                 pViscIterLayout->addWidget(pLabIter,                  3,1, Qt::AlignRight | Qt::AlignVCenter);
                 pViscIterLayout->addWidget(m_pieViscPanelIterMax,     3,2);
                 pViscIterLayout->addWidget(m_pchViscInitVTwist,       4,1,1,3);
-                pViscIterLayout->setRowStretch(5,1);
+                pViscIterLayout->addWidget(m_pchOTFCache,             5,1,1,3);
+                pViscIterLayout->addWidget(m_pchOTFCacheStore,        6,1,1,3);
+                pViscIterLayout->addWidget(pLabReTol,                 7,1, Qt::AlignRight | Qt::AlignVCenter);
+                pViscIterLayout->addWidget(m_pfeOTFReTolerance,       7,2);
+                pViscIterLayout->addWidget(pLabPercent,               7,3, Qt::AlignLeft | Qt::AlignVCenter);
+                pViscIterLayout->addWidget(pLabClTol,                 8,1, Qt::AlignRight | Qt::AlignVCenter);
+                pViscIterLayout->addWidget(m_pfeOTFClTolerance,       8,2);
+                pViscIterLayout->setRowStretch(9,1);
                 pViscIterLayout->setColumnStretch(4,1);
             }
             pViscLoopFrame->setLayout(pViscIterLayout);
@@ -416,11 +567,19 @@ void Analysis3dSettings::setupLayout()
                 m_pchVortonRedist = new QCheckBox("Vorton redistribution");
                 m_pchVortonRedist->setToolTip(tip);
 
+                tip = "<p>Evaluates the velocities induced by the vortons using a Barnes-Hut octree "
+                      "which is rebuilt at each advection step. The distant groups of vortons are represented "
+                      "by their aggregated vorticity moments, at the cost of a small loss of accuracy.<br>"
+                      "Recommendation: activate</p>";
+                m_pchVortonTree = new QCheckBox("Vorton tree code");
+                m_pchVortonTree->setToolTip(tip);
+
                 QLabel *pLabCoreSize = new QLabel("The vorton core size and VPW length have been moved to the analysis definition.");
 
                 pVPWBoxLayout->addWidget(m_pchVortonStrengthEx, 1, 1, 1, 2);
                 pVPWBoxLayout->addWidget(m_pchVortonRedist,     2, 1, 1, 2);
-                pVPWBoxLayout->addWidget(pLabCoreSize,          3, 1, 1, 3);
+                pVPWBoxLayout->addWidget(m_pchVortonTree,       3, 1, 1, 2);
+                pVPWBoxLayout->addWidget(pLabCoreSize,          4, 1, 1, 3);
                 pVPWBoxLayout->setRowStretch(5,1);
                 pVPWBoxLayout->setColumnStretch(4,1);
             }
@@ -467,15 +626,40 @@ void Analysis3dSettings::loadSettings(QSettings &settings)
         s_bStabDerivatives  = settings.value("StabDerivatives",   s_bStabDerivatives).toBool();
 
         PanelAnalysis::setDoublePrecision(settings.value("DoublePrecision", true).toBool());
+        PanelAnalysis::setMixedPrecision(settings.value("MixedPrecision", false).toBool());
+        switch(settings.value("MatrixSolver", 0).toInt())
+        {
+            default:
+            case 0: PanelAnalysis::setMatrixSolver(xfl::DENSELU);     break;
+            case 1: PanelAnalysis::setMatrixSolver(xfl::BARNESHUT);   break;
+            case 2: PanelAnalysis::setMatrixSolver(xfl::GMRES);       break;
+            case 3: PanelAnalysis::setMatrixSolver(xfl::BICGSTAB);    break;
+            case 4: PanelAnalysis::setMatrixSolver(xfl::HMATRIX);     break;
+            case 5: PanelAnalysis::setMatrixSolver(xfl::OUTOFCORE);   break;
+        }
+        PanelAnalysis::setIncrementalMatrix(settings.value("IncrementalMatrix", PanelAnalysis::bIncrementalMatrix()).toBool());
+        LUCache::setEnabled(          settings.value("LUCache",            LUCache::isEnabled()).toBool());
+        LUCache::setMaxMemory(        settings.value("LUCacheMaxMemory",   LUCache::maxMemory()).toDouble());
+        LUCache::setSpillDirectory(   settings.value("LUCacheSpillDir",    QString::fromStdString(LUCache::spillDirectory())).toString().toStdString());
+        TiledMatrix::setMaxMemory(    settings.value("OutOfCoreMemory",    TiledMatrix::maxMemory()).toDouble());
+        TiledMatrix::setDirectory(    settings.value("OutOfCoreDir",       QString::fromStdString(TiledMatrix::directory())).toString().toStdString());
 
         Task3d::setMaxNRHS(           settings.value("MaxNRHS",            Task3d::maxNRHS()).toInt());
+        XflExecutor::setMaxConcurrentTasks(settings.value("BatchTasks",    XflExecutor::maxConcurrentTasks()).toInt());
+        XflExecutor::setMemoryBudget( settings.value("BatchMemory",        XflExecutor::memoryBudget()).toDouble());
 
         PlaneTask::setViscInitVTwist(    settings.value("ViscInitVTwist",     PlaneTask::bViscInitVTwist()).toBool());
         PlaneTask::setMaxViscIter(       settings.value("MaxViscIter",        PlaneTask::maxViscIter()).toInt());
         PlaneTask::setMaxViscError(      settings.value("MaxViscError",       PlaneTask::maxViscError()).toDouble());
 
+        XFoilCache::setEnabled(          settings.value("OTFCache",           XFoilCache::isEnabled()).toBool());
+        XFoilCache::setStoreEnabled(     settings.value("OTFCacheStore",      XFoilCache::bStore()).toBool());
+        XFoilCache::setReTolerance(      settings.value("OTFCacheReTol",      XFoilCache::ReTolerance()).toDouble());
+        XFoilCache::setClTolerance(      settings.value("OTFCacheClTol",      XFoilCache::ClTolerance()).toDouble());
+
         Task3d::setVortonStretch(    settings.value("VortonSE",       Task3d::bVortonStretch()).toBool());
         Task3d::setVortonRedist(settings.value("VortonRedist",   Task3d::bVortonRedist()).toBool());
+        VortonTree::setEnabled(settings.value("VortonTree",      VortonTree::isEnabled()).toBool());
 
         switch (settings.value("VortexModel", Vortex::vortexModel()).toInt())
         {
@@ -504,16 +688,31 @@ void Analysis3dSettings::saveSettings(QSettings &settings)
         settings.setValue("StabDerivatives",    s_bStabDerivatives);
 
         settings.setValue("DoublePrecision",    PanelAnalysis::bDoublePrecision());
+        settings.setValue("MixedPrecision",     PanelAnalysis::bMixedPrecision());
+        settings.setValue("MatrixSolver",       PanelAnalysis::matrixSolver());
+        settings.setValue("IncrementalMatrix",  PanelAnalysis::bIncrementalMatrix());
+        settings.setValue("LUCache",            LUCache::isEnabled());
+        settings.setValue("LUCacheMaxMemory",   LUCache::maxMemory());
+        settings.setValue("LUCacheSpillDir",    QString::fromStdString(LUCache::spillDirectory()));
+        settings.setValue("OutOfCoreMemory",    TiledMatrix::maxMemory());
+        settings.setValue("OutOfCoreDir",       QString::fromStdString(TiledMatrix::directory()));
 
         settings.setValue("ViscInitVTwist",     PlaneTask::bViscInitVTwist());
         settings.setValue("ViscRelaxFactor",    PlaneTask::viscRelaxFactor());
         settings.setValue("MaxViscIter",        PlaneTask::maxViscIter());
         settings.setValue("MaxViscError",       PlaneTask::maxViscError());
+        settings.setValue("OTFCache",           XFoilCache::isEnabled());
+        settings.setValue("OTFCacheStore",      XFoilCache::bStore());
+        settings.setValue("OTFCacheReTol",      XFoilCache::ReTolerance());
+        settings.setValue("OTFCacheClTol",      XFoilCache::ClTolerance());
 
         settings.setValue("VortonSE",           Task3d::bVortonStretch());
         settings.setValue("VortonRedist",       Task3d::bVortonRedist());
+        settings.setValue("VortonTree",         VortonTree::isEnabled());
 
         settings.setValue("MaxNRHS",            Task3d::maxNRHS());
+        settings.setValue("BatchTasks",         XflExecutor::maxConcurrentTasks());
+        settings.setValue("BatchMemory",        XflExecutor::memoryBudget());
 
 
         settings.setValue("VortexModel",        Vortex::vortexModel());
@@ -602,6 +801,8 @@ void Analysis3dSettings::setData()
     m_pchKeepOpenOnErrors->setChecked(s_bKeepOpenOnErrors);
 
     m_pieMaxRHS->setValue(Task3d::maxNRHS());
+    m_pieBatchTasks->setValue(XflExecutor::maxConcurrentTasks());
+    m_pfeBatchMemory->setValue(XflExecutor::memoryBudget());
 
     m_pcbVortexModel->setCurrentIndex(Vortex::vortexModel());
     m_pfeCoreRadius->setValue(Vortex::coreRadius()* Units::mtoUnit());
@@ -615,11 +816,24 @@ void Analysis3dSettings::setData()
 
     m_pieQuadPoints->setValue(Panel3::quadratureOrder());
 
-    m_prbSinglePrecision->setChecked(!PanelAnalysis::bDoublePrecision());
+    m_prbSinglePrecision->setChecked(!PanelAnalysis::bDoublePrecision() && !PanelAnalysis::bMixedPrecision());
     m_prbDoublePrecision->setChecked(PanelAnalysis::bDoublePrecision());
+    m_prbMixedPrecision->setChecked(!PanelAnalysis::bDoublePrecision() && PanelAnalysis::bMixedPrecision());
+    m_prbDenseLU->setChecked(PanelAnalysis::matrixSolver()==xfl::DENSELU);
+    m_prbTreeSolver->setChecked(PanelAnalysis::matrixSolver()==xfl::BARNESHUT);
+    m_prbGMRES->setChecked(PanelAnalysis::matrixSolver()==xfl::GMRES);
+    m_prbBiCGStab->setChecked(PanelAnalysis::matrixSolver()==xfl::BICGSTAB);
+    m_prbHMatrix->setChecked(PanelAnalysis::matrixSolver()==xfl::HMATRIX);
+    m_prbOutOfCore->setChecked(PanelAnalysis::matrixSolver()==xfl::OUTOFCORE);
+    m_pchIncrementalMatrix->setChecked(PanelAnalysis::bIncrementalMatrix());
+    m_pchLUCache->setChecked(LUCache::isEnabled());
 
     //Viscous loop
     m_pchViscInitVTwist->setChecked(PlaneTask::bViscInitVTwist());
+    m_pchOTFCache->setChecked(XFoilCache::isEnabled());
+    m_pchOTFCacheStore->setChecked(XFoilCache::bStore());
+    m_pfeOTFReTolerance->setValue(XFoilCache::ReTolerance()*100.0);
+    m_pfeOTFClTolerance->setValue(XFoilCache::ClTolerance());
     m_pfeViscPanelRelax->setValue(PlaneTask::viscRelaxFactor());
     m_pfeViscPanelTwistPrec->setValue(PlaneTask::maxViscError());
     m_pieViscPanelIterMax->setValue(PlaneTask::maxViscIter());
@@ -631,6 +845,7 @@ void Analysis3dSettings::setData()
     m_pchVortonRedist->setChecked(false);
     m_pchVortonStrengthEx->setEnabled(false);
     m_pchVortonRedist->setEnabled(false);
+    m_pchVortonTree->setChecked(VortonTree::isEnabled());
 }
 
 
@@ -646,12 +861,23 @@ void Analysis3dSettings::readData()
     s_bKeepOpenOnErrors = m_pchKeepOpenOnErrors->isChecked();
 
     PanelAnalysis::setDoublePrecision(m_prbDoublePrecision->isChecked());
+    PanelAnalysis::setMixedPrecision(m_prbMixedPrecision->isChecked());
+    if     (m_prbTreeSolver->isChecked()) PanelAnalysis::setMatrixSolver(xfl::BARNESHUT);
+    else if(m_prbGMRES->isChecked())      PanelAnalysis::setMatrixSolver(xfl::GMRES);
+    else if(m_prbBiCGStab->isChecked())   PanelAnalysis::setMatrixSolver(xfl::BICGSTAB);
+    else if(m_prbHMatrix->isChecked())    PanelAnalysis::setMatrixSolver(xfl::HMATRIX);
+    else if(m_prbOutOfCore->isChecked())  PanelAnalysis::setMatrixSolver(xfl::OUTOFCORE);
+    else                                  PanelAnalysis::setMatrixSolver(xfl::DENSELU);
+    PanelAnalysis::setIncrementalMatrix(m_pchIncrementalMatrix->isChecked());
+    LUCache::setEnabled(m_pchLUCache->isChecked());
 
     Panel3::setQuadratureOrder(m_pieQuadPoints->value());
 
     WingXfl::setMinSurfaceLength(m_pfeMinPanelSize->value() / Units::mtoUnit());
 
     Task3d::setMaxNRHS(m_pieMaxRHS->value());
+    XflExecutor::setMaxConcurrentTasks(m_pieBatchTasks->value());
+    XflExecutor::setMemoryBudget(m_pfeBatchMemory->value());
 
     Panel::setRFF(m_pfeRFF->value());
 
@@ -676,10 +902,15 @@ void Analysis3dSettings::readData()
     PlaneTask::setViscRelaxFactor(m_pfeViscPanelRelax->value());
     PlaneTask::setMaxViscError(m_pfeViscPanelTwistPrec->value());
     PlaneTask::setMaxViscIter(m_pieViscPanelIterMax->value());
+    XFoilCache::setEnabled(m_pchOTFCache->isChecked());
+    XFoilCache::setStoreEnabled(m_pchOTFCacheStore->isChecked());
+    XFoilCache::setReTolerance(m_pfeOTFReTolerance->value()/100.0);
+    XFoilCache::setClTolerance(m_pfeOTFClTolerance->value());
 
     // VPW
     Task3d::setVortonStretch(m_pchVortonStrengthEx->isChecked());
     Task3d::setVortonRedist(m_pchVortonRedist->isChecked());
+    VortonTree::setEnabled(m_pchVortonTree->isChecked());
 }
 
 
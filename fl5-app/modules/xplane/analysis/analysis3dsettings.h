@@ -97,8 +97,12 @@ class Analysis3dSettings : public QDialog
         FloatEdit *m_pfeViscPanelRelax;
         FloatEdit *m_pfeViscPanelTwistPrec;
         IntEdit *m_pieViscPanelIterMax;
+        QCheckBox *m_pchOTFCache, *m_pchOTFCacheStore;
+        FloatEdit *m_pfeOTFReTolerance, *m_pfeOTFClTolerance;
 
         IntEdit *m_pieMaxRHS;
+        IntEdit *m_pieBatchTasks;
+        FloatEdit *m_pfeBatchMemory;
 
         QCheckBox *m_pchKeepOpenOnErrors;
 
@@ -109,10 +113,12 @@ class Analysis3dSettings : public QDialog
         FloatEdit *m_pfeVortexPos;
         FloatEdit *m_pfeControlPos;
 
-        QRadioButton *m_prbSinglePrecision, *m_prbDoublePrecision;
+        QRadioButton *m_prbSinglePrecision, *m_prbDoublePrecision, *m_prbMixedPrecision;
+        QRadioButton *m_prbDenseLU, *m_prbTreeSolver, *m_prbGMRES, *m_prbBiCGStab, *m_prbHMatrix, *m_prbOutOfCore;
+        QCheckBox *m_pchIncrementalMatrix, *m_pchLUCache;
 
         //Vortex particle wake
-        QCheckBox *m_pchVortonRedist, *m_pchVortonStrengthEx;
+        QCheckBox *m_pchVortonRedist, *m_pchVortonStrengthEx, *m_pchVortonTree;
 
         static bool s_bKeepOpenOnErrors;
         static bool s_bStabDerivatives;
@@ -30,7 +30,6 @@
 #include <QPainter>
 #include <QOpenGLPaintDevice>
 #include <QtConcurrent/QtConcurrent>
-#include <QThreadPool>
 #include <QKeyEvent>
 #include <QMouseEvent>
 #include <QContextMenuEvent>
@@ -119,8 +118,6 @@ gl3dXPlaneView::gl3dXPlaneView(QWidget *parent) : gl3dXflView(parent)
     s_bResetglStream     = true;
     s_bResetglVortons    = true;
 
-    m_nBlocks = 20;
-
     m_PickedVal = 76.54321;
 
     m_PixLegend = QPixmap(107, 97);
@@ -1340,33 +1337,10 @@ void gl3dXPlaneView::computeP4VelocityVectors(Opp3d const *pPOpp, QVector<Vector
     }
     m_pP4Analysis->setVortons(pPOpp->m_Vorton);
 
+    m_pP4Analysis->getVelocityVectors(points.size(), points.constData(), pPOpp->gamma().data(), pPOpp->sigma().data(), velvectors.data(),
+                                      Vortex::coreRadius(), false, bMultithread);
 
-    if(bMultithread)
-    {
-        m_nBlocks = QThreadPool::globalInstance()->maxThreadCount();
-        QFutureSynchronizer<void> futureSync;
-
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
-            futureSync.addFuture(QtConcurrent::run(this, &gl3dXPlaneView::makeQuadVelocityBlock,
-                                                   iBlock, points, pPOpp->gamma().constData(), pPOpp->sigma().constData(), velvectors.data()));
-#else
-            futureSync.addFuture(QtConcurrent::run(&gl3dXPlaneView::makeQuadVelocityBlock, this,
-                                                   iBlock, points, pPOpp->gamma().data(), pPOpp->sigma().data(), velvectors.data()));
-#endif
-        }
-        futureSync.waitForFinished();
-    }
-    else
-    {
-        m_nBlocks = 1;
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            makeQuadVelocityBlock(iBlock, points, pPOpp->gamma().data(), pPOpp->sigma().data(), velvectors.data());
-        }
-        update();
-    }
+    if(!bMultithread) update();
 }
 
 
@@ -1376,83 +1350,27 @@ void gl3dXPlaneView::computeP3VelocityVectors(Opp3d const *pPOpp, QVector<Vector
     velvectors.resize(nPoints);
 
     Plane *pPlane = s_pXPlane->curPlane();
+    P3Analysis *pP3A(nullptr);
     if(s_pXPlane->curPlPolar()->isTriUniformMethod())
     {
         m_pP3UniAnalysis->setTriMesh(pPlane->triMesh());
         m_pP3UniAnalysis->initializeAnalysis(s_pXPlane->curPlPolar(),0);
         m_pP3UniAnalysis->setVortons(pPOpp->m_Vorton);
+        pP3A = m_pP3UniAnalysis;
     }
     else if(s_pXPlane->curPlPolar()->isTriLinearMethod())
     {
         m_pP3LinAnalysis->setTriMesh(pPlane->triMesh());
         m_pP3LinAnalysis->initializeAnalysis(s_pXPlane->curPlPolar(),0);
         m_pP3LinAnalysis->setVortons(pPOpp->m_Vorton);
+        pP3A = m_pP3LinAnalysis;
     }
+    if(!pP3A) return;
 
-    if(bMultithread)
-    {
-        m_nBlocks = QThreadPool::globalInstance()->maxThreadCount();
-        QFutureSynchronizer<void> futureSync;
+    pP3A->getVelocityVectors(nPoints, points.constData(), pPOpp->gamma().data(), pPOpp->sigma().data(), velvectors.data(),
+                             Vortex::coreRadius(), false, bMultithread);
 
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
-            futureSync.addFuture(QtConcurrent::run(this, &gl3dXPlaneView::makeTriVelocityBlock,
-                                                   iBlock, points, pPOpp->gamma().data(), pPOpp->sigma().data(), velvectors.data()));
-#else
-            futureSync.addFuture(QtConcurrent::run(&gl3dXPlaneView::makeTriVelocityBlock, this,
-                                                   iBlock, points, pPOpp->gamma().data(), pPOpp->sigma().data(), velvectors.data()));
-#endif
-        }
-        futureSync.waitForFinished();
-    }
-    else
-    {
-        m_nBlocks = 1;
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            makeTriVelocityBlock(iBlock, points, pPOpp->gamma().data(), pPOpp->sigma().data(), velvectors.data());
-        }
-        update();
-    }
-}
-
-
-void gl3dXPlaneView::makeQuadVelocityBlock(int iBlock, QVector<Vector3d> const &C, double const *mu, double const*sigma, Vector3d *VField) const
-{
-    int blockSize = int(C.size()/m_nBlocks) +1;
-    int iStart = iBlock*blockSize;
-    int maxRows = C.size();
-    int iMax = std::min(iStart+blockSize, maxRows);
-
-    Vector3d V;
-
-    for (int ip=iStart; ip<iMax; ip++)
-    {
-        m_pP4Analysis->getVelocityVector(C.at(ip), mu, sigma, V, Vortex::coreRadius(), false, false);
-        VField[ip] = V;
-    }
-}
-
-
-void gl3dXPlaneView::makeTriVelocityBlock(int iBlock, QVector<Vector3d> const &C, double const *mu, double const *sigma, Vector3d *VField) const
-{
-    int blockSize = int(C.size()/m_nBlocks) +1;
-    int iStart = iBlock*blockSize;
-    int maxRows = C.size();
-    int iMax = std::min(iStart+blockSize, maxRows);
-
-    Vector3d V;
-
-    for (int ip=iStart; ip<iMax; ip++)
-    {
-        if (s_pXPlane->curPlPolar()->isTriUniformMethod())
-            m_pP3UniAnalysis->getVelocityVector(C.at(ip), mu, sigma, V, Vortex::coreRadius(), false, false);
-        else if(s_pXPlane->curPlPolar()->isTriLinearMethod())
-            m_pP3LinAnalysis->getVelocityVector(C.at(ip), mu, sigma, V, Vortex::coreRadius(), false, false);
-
-        VField[ip] = V;
-    }
+    if(!bMultithread) update();
 }
 
 
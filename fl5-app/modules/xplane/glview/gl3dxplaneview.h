@@ -129,9 +129,6 @@ class gl3dXPlaneView : public gl3dXflView
         bool glMakeStreamLines(const std::vector<Panel4> &panel4list, const PlaneOpp *pPOpp);
         bool glMakeStreamLines(const std::vector<Panel3> &panel3list, const std::vector<Node> &nodelist, const PlaneOpp *pPOpp);
 
-        void makeQuadVelocityBlock(int iBlock, const QVector<Vector3d> &C, const double *mu, const double *sigma, Vector3d *VField) const;
-        void makeTriVelocityBlock( int iBlock, const QVector<Vector3d> &C, const double *mu, const double *sigma, Vector3d *VField) const;
-
         void makeLLTDownwash(const PlaneXfl *pPlane, const PlanePolar *pWPolar, const PlaneOpp *pPOpp,
                              QVector<Vector3d> &points,QVector<Vector3d> &arrows) const;
         void makeDownwash(const PlaneXfl *pPlane, const PlanePolar *pWPolar, const PlaneOpp *pPOpp,
@@ -171,8 +168,6 @@ class gl3dXPlaneView : public gl3dXflView
 
         QVector<QColor> m_StreamLineColours;
 
-        int m_nBlocks;
-
         QOpenGLBuffer m_vboPickedQuad;
         QOpenGLBuffer m_vboHPlane;
 
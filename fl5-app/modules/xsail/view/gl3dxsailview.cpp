@@ -31,7 +31,6 @@
 #include <QContextMenuEvent>
 #include <QOpenGLPaintDevice>
 #include <QtConcurrent/QtConcurrent>
-#include <QThreadPool>
 
 #include "gl3dxsailview.h"
 
@@ -108,7 +107,6 @@ gl3dXSailView::gl3dXSailView() : gl3dXflView()
 
     m_bWindFront =  m_bWindBack = false;
 
-    m_nBlocks = 1;
 
     m_FlowYPos = 0.0;
     m_bResetFlowPanels = m_bResetBoids = true;
@@ -1894,66 +1892,27 @@ void gl3dXSailView::computeP3VelocityVectors(Opp3d const *pBtOpp, QVector<Vector
     int nPoints = points.size();
     velvectors.resize(nPoints);
 
+    P3Analysis *pP3A(nullptr);
     if(s_pXSail->curBtPolar()->isTriUniformMethod())
     {
         m_pP3UniAnalysis->setTriMesh(s_pXSail->curBoat()->triMesh());
         m_pP3UniAnalysis->initializeAnalysis(s_pXSail->curBtPolar(), 0);
         m_pP3UniAnalysis->setVortons(pBtOpp->m_Vorton);
+        pP3A = m_pP3UniAnalysis;
     }
     else if(s_pXSail->curBtPolar()->isTriLinearMethod())
     {
         m_pP3LinAnalysis->setTriMesh(s_pXSail->curBoat()->triMesh());
         m_pP3LinAnalysis->initializeAnalysis(s_pXSail->curBtPolar(), 0);
         m_pP3LinAnalysis->setVortons(pBtOpp->m_Vorton);
+        pP3A = m_pP3LinAnalysis;
     }
+    if(!pP3A) return;
 
-    if(xfl::isMultiThreaded())
-    {
-        m_nBlocks = QThreadPool::globalInstance()->maxThreadCount();
-        QFutureSynchronizer<void> futureSync;
-
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-#if (QT_VERSION < QT_VERSION_CHECK(6, 0, 0))
-            futureSync.addFuture(QtConcurrent::run(this, &gl3dXSailView::makeTriVelocityBlock,
-                                                       iBlock, points, pBtOpp->gamma().data(), pBtOpp->sigma().data(), velvectors.data()));
-#else
-            futureSync.addFuture(QtConcurrent::run(&gl3dXSailView::makeTriVelocityBlock, this,
-                                                       iBlock, points, pBtOpp->gamma().data(), pBtOpp->sigma().data(), velvectors.data()));
-#endif
-         }
-        futureSync.waitForFinished();
-    }
-    else
-    {
-        m_nBlocks = 1;
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            makeTriVelocityBlock(iBlock, points, pBtOpp->gamma().data(), pBtOpp->sigma().data(), velvectors.data());
-        }
-        update();
-    }
-}
-
-
-void gl3dXSailView::makeTriVelocityBlock(int iBlock, QVector<Vector3d> const &C, double const *mu, double const *sigma, Vector3d *VField) const
-{
-    int blockSize = int(C.size()/m_nBlocks) +1;
-    int iStart = iBlock*blockSize;
-    int maxRows = C.size();
-    int iMax = std::min(iStart+blockSize, maxRows);
-
-    Vector3d V;
-
-    for (int ip=iStart; ip<iMax; ip++)
-    {
-        if (s_pXSail->curBtPolar()->isTriUniformMethod())
-            m_pP3UniAnalysis->getVelocityVector(C.at(ip), mu, sigma, V, Vortex::coreRadius(), false, false);
-        else if(s_pXSail->curBtPolar()->isTriLinearMethod())
-            m_pP3LinAnalysis->getVelocityVector(C.at(ip), mu, sigma, V, Vortex::coreRadius(), false, false);
-
-        VField[ip] = V;
-    }
+    bool bMultithread = xfl::isMultiThreaded();
+    pP3A->getVelocityVectors(nPoints, points.constData(), pBtOpp->gamma().data(), pBtOpp->sigma().data(), velvectors.data(),
+                             Vortex::coreRadius(), false, bMultithread);
+    if(!bMultithread) update();
 }
 
 
@@ -131,8 +131,6 @@ class gl3dXSailView : public gl3dXflView
         bool glMakeStreamLines(const std::vector<Panel3> &panel3list, const Boat *pBoat, BoatOpp const *pBtOpp);
         void computeP3VelocityVectors(const Opp3d *pPOpp, QVector<Vector3d> const &points, QVector<Vector3d> &velvectors);
 
-        void makeTriVelocityBlock( int iBlock, QVector<Vector3d> const &C, double const *mu, double const *sigma, Vector3d *VField) const;
-
         void makeBoids();
         void moveBoids();
         void glMakeFlowBuffers();
@@ -150,8 +148,6 @@ class gl3dXSailView : public gl3dXflView
         double m_LiveCtrlParam;
         std::vector<std::vector<Vorton>> m_LiveVortons;
 
-        int m_nBlocks;
-
         double m_PickedVal;
 
         QVector<QOpenGLBuffer> m_vboSailSurface;
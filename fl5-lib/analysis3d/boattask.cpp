@@ -84,6 +84,7 @@ void BoatTask::setObjects(Boat *pBoat, BoatPolar *pBtPolar)
             m_pPA = m_pP3A;
         }
     }
+    if(m_pPA) m_pPA->setLogFunction([this](std::string const &msg) {traceStdLog(msg);});
 }
 
 
@@ -198,7 +199,10 @@ void BoatTask::loop()
 
         if(m_pP3A)
         {
-            m_pBoat->rotateMesh(m_pBtPolar, phi, Ry, m_Ctrl, m_pP3A->m_Panel3);
+            // only the coefficients of the panels which have moved since the last fill need to be refilled
+            m_pBoat->rotateSails(m_pBtPolar, m_Ctrl, m_pP3A->m_Panel3);
+            m_pPA->markMovedPanels(Vector3d(phi, Ry, 0.0));
+            m_pBoat->rotateBody(m_pBtPolar, phi, Ry, m_pP3A->m_Panel3);
         }
 
         std::string OutString;
@@ -219,7 +223,7 @@ void BoatTask::loop()
 
         if(!m_pPolar3d->isVLM())
         {
-            m_pPA->makeSourceStrengths(VFree);
+            m_pPA->makeSourceStrengths(VFree, m_pPA->m_Sigma.data());
             //compute wake contribution
             m_pPA->addWakeContribution();
         }
@@ -310,7 +314,7 @@ void BoatTask::loop()
         traceStdLog("      Computing on body Cp...");
         if(!m_pPolar3d->isVLM())
         {
-            m_pPA->computeOnBodyCp(VField, m_pPA->m_uVLocal, m_pPA->m_Cp);
+            m_pPA->computeOnBodyCp(VField, m_pPA->m_uVLocal, m_pPA->m_Cp.data());
         }
         if (isCancelled()) return;
         traceStdLog(" done\n");
@@ -347,7 +351,7 @@ void BoatTask::scaleResultsToSpeed(int qrhs)
         }
     }
 
-    m_pPA->scaleResultsToSpeed(qinf);
+    m_pPA->scaleResultsToSpeed(qinf, m_pPA->m_Mu.data(), m_pPA->m_Sigma.data());
 }
 
 
@@ -697,7 +701,7 @@ void BoatTask::makeVortonRow(int qrhs)
         newvortons.pop_back();
 
     // save the new vortons
-    m_pPA->m_Vorton = newvortons;
+    m_pPA->setVortons(newvortons);
 }
 
 
@@ -716,9 +720,9 @@ void BoatTask::computeInducedForces(double alpha, double beta, double QInf)
 
         Vector3d forcebodyaxes;
         if(m_pBtPolar->isQuadMethod() && m_pP4A)
-            m_pP4A->inducedForce(pSail->nPanel4(), QInf, alpha, beta, pos, forcebodyaxes, pSail->spanDistFF());
+            m_pP4A->inducedForce(pSail->nPanel4(), QInf, alpha, beta, pos, m_pP4A->m_Mu.data(), forcebodyaxes, pSail->spanDistFF());
         else if(m_pBtPolar->isTriangleMethod() && m_pP3A)
-            m_pP3A->inducedForce(pSail->nPanel3(), QInf, alpha, beta, pos, forcebodyaxes, pSail->spanDistFF());
+            m_pP3A->inducedForce(pSail->nPanel3(), QInf, alpha, beta, pos, m_pP3A->m_Mu.data(), forcebodyaxes, pSail->spanDistFF());
 
         //save the results... will save another FF calculation when computing the operating points
         m_SailForceFF[iw] += forcebodyaxes;     // N/q, body axes
@@ -757,9 +761,9 @@ void BoatTask::computeInducedDrag(double alpha, double beta, double QInf, int qr
         else
         {
             if(m_pBtPolar->isQuadMethod() && m_pP4A)
-                m_pP4A->trefftzDrag(pSail->nPanel4(), QInf, alpha, beta, pos, Drag, pSail->spanDistFF());
+                m_pP4A->trefftzDrag(pSail->nPanel4(), QInf, alpha, beta, pos, m_pP4A->m_Mu.data(), m_pP4A->m_Sigma.data(), Drag, pSail->spanDistFF());
             else if(m_pBtPolar->isTriangleMethod() && m_pP3A)
-                m_pP3A->trefftzDrag(pSail->nPanel3(), QInf, alpha, beta, pos, Drag, pSail->spanDistFF());
+                m_pP3A->trefftzDrag(pSail->nPanel3(), QInf, alpha, beta, pos, m_pP3A->m_Mu.data(), m_pP3A->m_Sigma.data(), Drag, pSail->spanDistFF());
         }
         SailForce[qrhs*nSails+iw] += Drag;     // N/q, body axes
         SpanDist[qrhs*nSails+iw].m_ICd = pSail->spanDistFF().m_ICd;
@@ -136,7 +136,7 @@ void LLTTask::initializeVelocity(double alpha, double &QInf)
             {
                 double yob   = cos(k*PI/s_NLLTStations);
                 m_pWing->getFoils(&pFoil0, &pFoil1, yob*m_pWing->planformSpan()/2.0, tau);
-                double alpha0 = Objects2d::getZeroLiftAngle(pFoil0, pFoil1, LARGEVALUE, tau);
+                double alpha0 = m_PolarMesh.getZeroLiftAngle(pFoil0, pFoil1, LARGEVALUE, tau);
                 double Cl = 2.0*PI*(alpha-alpha0+m_Twist.at(k))*PI/180.0;
                 Lift += Eta(k) * Cl * m_Chord.at(k) /m_pWing->planformSpan();
             }
@@ -217,34 +217,34 @@ void LLTTask::computeWing(double QInf, double Alpha, std::string &ErrMessage)
         yob   = cos(double(m)*PI/double(s_NLLTStations));
         m_pWing->getFoils(&pFoil0, &pFoil1, yob*m_pWing->planformSpan()/2.0, tau);
 
-        m_Cl[m]     = Objects2d::getPlrPointFromAlpha(Polar::CL, pFoil0, pFoil1, m_Re[m], Alpha+m_Ai[m]+m_Twist[m], tau, bOutRe, bError);
+        m_Cl[m]     = m_PolarMesh.getPlrPointFromAlpha(Polar::CL, pFoil0, pFoil1, m_Re[m], Alpha+m_Ai[m]+m_Twist[m], tau, bOutRe, bError);
         if(bOutRe) bPointOutRe = true;
         if(bError) bPointOutAlpha = true;
 
-        m_PCd[m]    = Objects2d::getPlrPointFromAlpha(Polar::CD, pFoil0, pFoil1, m_Re[m], Alpha+m_Ai[m]+m_Twist[m], tau, bOutRe, bError);
+        m_PCd[m]    = m_PolarMesh.getPlrPointFromAlpha(Polar::CD, pFoil0, pFoil1, m_Re[m], Alpha+m_Ai[m]+m_Twist[m], tau, bOutRe, bError);
         if(bOutRe) bPointOutRe = true;
         if(bError) bPointOutAlpha = true;
 
         m_ICd[m]    = -m_Cl[m] * (m_Ai[m]* PI/180.0);
 
-        m_XTrTop[m] = Objects2d::getPlrPointFromAlpha(Polar::XTRTOP, pFoil0, pFoil1, m_Re[m], Alpha+m_Ai[m] + m_Twist[m], tau, bOutRe, bError);
+        m_XTrTop[m] = m_PolarMesh.getPlrPointFromAlpha(Polar::XTRTOP, pFoil0, pFoil1, m_Re[m], Alpha+m_Ai[m] + m_Twist[m], tau, bOutRe, bError);
         if(bOutRe) bPointOutRe = true;
         if(bError) bPointOutAlpha = true;
 
-        m_XTrBot[m] = Objects2d::getPlrPointFromAlpha(Polar::XTRBOT, pFoil0, pFoil1, m_Re[m], Alpha+m_Ai[m]+m_Twist[m], tau, bOutRe, bError);
+        m_XTrBot[m] = m_PolarMesh.getPlrPointFromAlpha(Polar::XTRBOT, pFoil0, pFoil1, m_Re[m], Alpha+m_Ai[m]+m_Twist[m], tau, bOutRe, bError);
         if(bOutRe) bPointOutRe = true;
         if(bError) bPointOutAlpha = true;
 
-        m_CmAirf[m] = Objects2d::getPlrPointFromAlpha(Polar::CM, pFoil0, pFoil1, m_Re[m], Alpha+m_Ai[m]+m_Twist[m], tau, bOutRe, bError);
+        m_CmAirf[m] = m_PolarMesh.getPlrPointFromAlpha(Polar::CM, pFoil0, pFoil1, m_Re[m], Alpha+m_Ai[m]+m_Twist[m], tau, bOutRe, bError);
         if(bOutRe) bPointOutRe = true;
         if(bError) bPointOutAlpha = true;
 
-        m_XCPSpanRel[m] = Objects2d::getPlrPointFromAlpha(Polar::XCP, pFoil0, pFoil1, m_Re[m], Alpha+m_Ai[m]+m_Twist[m], tau, bOutRe, bError);
+        m_XCPSpanRel[m] = m_PolarMesh.getPlrPointFromAlpha(Polar::XCP, pFoil0, pFoil1, m_Re[m], Alpha+m_Ai[m]+m_Twist[m], tau, bOutRe, bError);
 
         if(fabs(m_XCPSpanRel[m])<0.000001)
         {
             //plr mesh was generated prior to v3.15, i.e., without XCp calculations
-            Cm0 = Objects2d::getCm0(pFoil0, pFoil1, m_Re[m],tau, bOutRe, bError);
+            Cm0 = m_PolarMesh.getCm0(pFoil0, pFoil1, m_Re[m],tau, bOutRe, bError);
             if(m_Cl[m]!=0.0) m_XCPSpanRel[m] = 0.25 - Cm0/m_Cl[m];
             else             m_XCPSpanRel[m] = 0.25;
         }
@@ -429,7 +429,7 @@ bool LLTTask::setLinearSolution(double Alpha)
         }
 
         m_pWing->getFoils(&pFoil0, &pFoil1, yob*b/2.0, tau);
-        a0 = Objects2d::getZeroLiftAngle(pFoil0, pFoil1, m_Re[i], tau);
+        a0 = m_PolarMesh.getZeroLiftAngle(pFoil0, pFoil1, m_Re[i], tau);
         rhs[i] = ch/cs * (Alpha-a0+twist)/180.0*PI;
     }
 
@@ -454,7 +454,7 @@ bool LLTTask::setLinearSolution(double Alpha)
         }
         m_pWing->getFoils(&pFoil0, &pFoil1, yob*b/2.0, tau);
         Objects2d::getLinearizedPolar(pFoil0, pFoil1, m_Re[i], tau, a0, slope);
-        a0 = Objects2d::getZeroLiftAngle(pFoil0, pFoil1, m_Re[i], tau); //better approximation ?
+        a0 = m_PolarMesh.getZeroLiftAngle(pFoil0, pFoil1, m_Re[i], tau); //better approximation ?
 
         m_Cl[i] *= slope*cs/m_pWing->getChord(yob);
         m_Ai[i]  = -(Alpha-a0+m_pWing->getTwist(yob)) + m_Cl[i]/slope*180.0/PI;
@@ -467,53 +467,138 @@ bool LLTTask::setLinearSolution(double Alpha)
 
 double LLTTask::alphaInduced(int k) const
 {
+    int size = s_NLLTStations-1;
+    double const *coef = m_InfluenceCoef.data() + (k-1)*size;
     double ai = 0.0;
     for (int m=1; m<s_NLLTStations; m++)
     {
-        double b =  Beta(m,k);
-        ai += b * m_Cl.at(m) * m_Chord.at(m)/m_pWing->planformSpan();
+        ai += coef[m-1] * m_Cl[m];
     }
     return ai;
 }
 
 
-int LLTTask::iterate(double &QInf, double Alpha)
+/**
+ * Builds the matrix of the induced angle coefficients, such that alphaInduced(k) = sum_m coef(k,m).Cl(m)
+ * Also caches the foils and the interpolation factor of each station, which depend only on the geometry.
+ */
+void LLTTask::makeInfluenceCoefs()
 {
-    Foil* pFoil0(nullptr);
-    Foil* pFoil1(nullptr);
+    int size = s_NLLTStations-1;
+    double tau(0);
+    m_InfluenceCoef.resize(size*size);
+    m_StationFoil0.assign(s_NLLTStations+1, nullptr);
+    m_StationFoil1.assign(s_NLLTStations+1, nullptr);
+    m_StationTau.assign(s_NLLTStations+1, 0.0);
+
+    for (int k=1; k<s_NLLTStations; k++)
+    {
+        for (int m=1; m<s_NLLTStations; m++)
+            m_InfluenceCoef[(k-1)*size+(m-1)] = Beta(m,k) * m_Chord.at(m)/m_pWing->planformSpan();
+
+        double yob = cos(double(k)*PI/double(s_NLLTStations));
+        m_pWing->getFoils(&m_StationFoil0[k], &m_StationFoil1[k], yob*m_pWing->planformSpan()/2.0, tau);
+        m_StationTau[k] = tau;
+    }
+}
 
+
+/** Returns the lift coefficient of station k interpolated on the polar mesh at the local angle Alpha+ai+twist */
+double LLTTask::stationCl(int k, double Alpha, double ai) const
+{
     bool bOutRe(false), bError(false);
-    double tau (0);
+    return m_PolarMesh.getPlrPointFromAlpha(Polar::CL, m_StationFoil0.at(k), m_StationFoil1.at(k), m_Re.at(k), Alpha + ai + m_Twist.at(k),
+                                            m_StationTau.at(k), bOutRe, bError);
+}
+
+
+/**
+ * Makes a Newton step on the induced angles for the residuals R(k) = ai(k) + alphaInduced(k).
+ * The jacobian is built with the local lift slopes interpolated on the polar mesh.
+ * The step is halved until the max. residual decreases; if it does not, the method
+ * reverts to the relaxed fixed point step.
+ * @param Alpha the angle of attack, in degrees
+ * @param maxa the max. residual of the current state
+ */
+void LLTTask::newtonStep(double Alpha, double maxa)
+{
+    int size = s_NLLTStations-1;
+    double const dalpha = 0.5; // degrees, to estimate the lift slopes
+
+    std::vector<double> jac(m_InfluenceCoef);
+    std::vector<double> dai(size);
+    for (int m=1; m<s_NLLTStations; m++)
+    {
+        double dCl = (stationCl(m, Alpha, m_Ai[m]+dalpha) - stationCl(m, Alpha, m_Ai[m]-dalpha))/2.0/dalpha;
+        for (int k=0; k<size; k++) jac[k*size+(m-1)] *= dCl;
+        jac[(m-1)*size+(m-1)] += 1.0;
+        dai[m-1] = -(m_Ai[m] + alphaInduced(m));
+    }
+
+    std::vector<double> ai0(m_Ai), cl0(m_Cl);
+    bool bCancel(false);
+    if(matrix::Gauss(jac.data(), size, dai.data(), 1, bCancel))
+    {
+        double lambda = 1.0;
+        for(int itry=0; itry<4; itry++)
+        {
+            for (int k=1; k<s_NLLTStations; k++)
+            {
+                m_Ai[k] = ai0[k] + lambda*dai[k-1];
+                m_Cl[k] = stationCl(k, Alpha, m_Ai[k]);
+            }
+            double res = 0.0;
+            for (int k=1; k<s_NLLTStations; k++) res = std::max(res, fabs(m_Ai[k] + alphaInduced(k)));
+            if(res<maxa) return;
+            lambda *= 0.5;
+        }
+    }
 
+    // no decrease of the residual: make the relaxed fixed point step from the initial state
+    m_Cl = cl0;
+    for (int k=1; k<s_NLLTStations; k++)
+    {
+        double anext = -alphaInduced(k);
+        m_Ai[k] = ai0[k] + (anext-ai0[k])/s_RelaxMax;
+    }
+    for (int k=1; k<s_NLLTStations; k++) m_Cl[k] = stationCl(k, Alpha, m_Ai[k]);
+}
+
+
+/**
+ * Solves the non-linear LLT equations for the induced angles, starting from the current state.
+ * The iterations are Newton steps on the residuals ai(k) + alphaInduced(k), safeguarded by
+ * the relaxed fixed point iteration when the Newton step does not reduce the residual.
+ * @return the number of iterations, or -1 if the lift is negative in the case of a T2 polar.
+ */
+int LLTTask::iterate(double &QInf, double Alpha)
+{
     double maxa(0);
 
     int iter = 0;
     while(iter<s_IterLim)
     {
         maxa = 0.0;
-
         for (int k=1; k<s_NLLTStations; k++)
         {
-            double a        = m_Ai[k];
-            double anext    = -alphaInduced(k);
-            m_Ai[k]  = a +(anext-a)/s_RelaxMax;
-            maxa   = qMax(maxa, qAbs(a-anext));
+            maxa = std::max(maxa, fabs(m_Ai[k] + alphaInduced(k)));
         }
 
-        double Lift=0.0;// required for Type 2
-        for (int k=1; k<s_NLLTStations; k++)
+        if (maxa<s_CvPrec)
         {
-            double yob = cos(double(k)*PI/double(s_NLLTStations));
-            m_pWing->getFoils(&pFoil0, &pFoil1, yob*m_pWing->planformSpan()/2.0, tau);
-            m_Cl[k] = Objects2d::getPlrPointFromAlpha(Polar::CL, pFoil0, pFoil1, m_Re.at(k), Alpha + m_Ai.at(k)+ m_Twist.at(k), tau, bOutRe, bError);
-            if (m_pPlPolar->isFixedLiftPolar())
-            {
-                Lift += Eta(k) * m_Cl.at(k) * m_Chord.at(k);
-            }
+            m_bConverged = true;
+            break;
         }
 
+        newtonStep(Alpha, maxa);
+
         if(m_pPlPolar->isFixedLiftPolar())
         {
+            double Lift=0.0;
+            for (int k=1; k<s_NLLTStations; k++)
+            {
+                Lift += Eta(k) * m_Cl.at(k) * m_Chord.at(k);
+            }
             Lift *= m_pWing->aspectRatio() / m_pWing->planformSpan();
             if(Lift<=0.0)  return -1;
 
@@ -522,19 +607,10 @@ int LLTTask::iterate(double &QInf, double Alpha)
             for (int k=1; k<s_NLLTStations; k++)
             {
                 m_Re[k] = m_Chord.at(k) * QInf /m_pPlPolar->viscosity();
-
-                double yob = cos(double(k)*PI/double(s_NLLTStations));
-                m_pWing->getFoils(&pFoil0, &pFoil1, yob*m_pWing->planformSpan()/2.0, tau);
-                m_Cl[k] = Objects2d::getPlrPointFromAlpha(Polar::CL, pFoil0, pFoil1, m_Re.at(k), Alpha + m_Ai.at(k)+ m_Twist.at(k), tau, bOutRe, bError);
+                m_Cl[k] = stationCl(k, Alpha, m_Ai.at(k));
             }
         }
 
-        if (maxa<s_CvPrec)
-        {
-            m_bConverged = true;
-            break;
-        }
-
         m_iter.push_back(iter);
         m_Max_a.push_back(maxa);
 
@@ -571,11 +647,15 @@ void LLTTask::initializeGeom()
 
         m_StripArea[j] = m_Chord[j]*dy;//m2
     }
+
+    makeInfluenceCoefs();
 }
 
 
 void LLTTask::run()
 {
+    m_PolarMesh.makeMesh(Objects2d::foils(), Objects2d::polars());
+
     if (!m_pPlPolar->isFixedaoaPolar())
     {
         alphaLoop();
@@ -628,7 +708,7 @@ bool LLTTask::alphaLoop()
         {
             yob   = cos(k*PI/s_NLLTStations);
             m_pWing->getFoils(&pFoil0, &pFoil1, yob*m_pWing->planformSpan()/2.0, tau);
-            m_Cl[k] = Objects2d::getPlrPointFromAlpha(Polar::CL, pFoil0, pFoil1, m_Re[k], alpha + m_Ai[k] + m_Twist[k], tau, bOutRe, bError);
+            m_Cl[k] = m_PolarMesh.getPlrPointFromAlpha(Polar::CL, pFoil0, pFoil1, m_Re[k], alpha + m_Ai[k] + m_Twist[k], tau, bOutRe, bError);
         }
 
 
@@ -0,0 +1,224 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <cstdio>
+#include <fstream>
+
+#include <lucache.h>
+
+
+std::list<LUCache::Entry> LUCache::s_Entry;
+std::mutex LUCache::s_Mutex;
+
+bool LUCache::s_bEnabled(false);
+int LUCache::s_MaxEntries(8);
+double LUCache::s_MaxMemory(1024.0);
+std::string LUCache::s_SpillDir;
+double LUCache::s_SpillSize(256.0);
+
+
+void LUCache::Key::add(void const *data, size_t nBytes)
+{
+    unsigned char const *bytes = static_cast<unsigned char const*>(data);
+    for(size_t i=0; i<nBytes; i++)
+    {
+        m_Hash ^= bytes[i];
+        m_Hash *= 1099511628211ULL;
+    }
+}
+
+
+/**
+ * Copies the factorization identified by the key in the arrays.
+ * @return true if the factorization was found, false otherwise.
+ */
+bool LUCache::fetch(uint64_t key, std::vector<double> &aijd, std::vector<float> &aijf, std::vector<int> &ipiv)
+{
+    if(!s_bEnabled) return false;
+
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    for(auto it=s_Entry.begin(); it!=s_Entry.end(); ++it)
+    {
+        if(it->m_Key!=key) continue;
+
+        if(it->m_FileName.length())
+        {
+            if(!readSpillFile(*it, aijd, aijf))
+            {
+                discard(it);
+                return false;
+            }
+        }
+        else
+        {
+            aijd = it->m_aijd;
+            aijf = it->m_aijf;
+        }
+        ipiv = it->m_ipiv;
+
+        // move to front
+        s_Entry.splice(s_Entry.begin(), s_Entry, it);
+        return true;
+    }
+    return false;
+}
+
+
+/**
+ * Stores a copy of the factorization.
+ * The matrix is spilled to disk if it is larger than the spill size and if a spill directory is set,
+ * and is not stored if it exceeds the memory budget on its own.
+ */
+void LUCache::store(uint64_t key, std::vector<double> const &aijd, std::vector<float> const &aijf, std::vector<int> const &ipiv)
+{
+    if(!s_bEnabled || s_MaxEntries<=0) return;
+
+    double MB = double(aijd.size()*sizeof(double) + aijf.size()*sizeof(float))/1024.0/1024.0;
+    bool bSpill = s_SpillDir.length() && MB>s_SpillSize;
+    if(!bSpill && MB>s_MaxMemory) return;
+
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    for(auto it=s_Entry.begin(); it!=s_Entry.end(); ++it)
+    {
+        if(it->m_Key==key)
+        {
+            discard(it);
+            break;
+        }
+    }
+
+    Entry entry;
+    entry.m_Key = key;
+    entry.m_ipiv = ipiv;
+    try
+    {
+        if(bSpill)
+        {
+            if(!writeSpillFile(entry, aijd, aijf)) return;
+        }
+        else
+        {
+            entry.m_aijd = aijd;
+            entry.m_aijf = aijf;
+        }
+    }
+    catch(std::bad_alloc &)
+    {
+        return;
+    }
+
+    s_Entry.push_front(std::move(entry));
+    trim();
+}
+
+
+void LUCache::clear()
+{
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    while(s_Entry.size()) discard(s_Entry.begin());
+}
+
+
+/** Returns the memory used by the entry, in MB */
+double LUCache::memorySize(Entry const &entry)
+{
+    return double(entry.m_aijd.size()*sizeof(double) + entry.m_aijf.size()*sizeof(float))/1024.0/1024.0;
+}
+
+
+/** Discards the least recently used entries until the count and the memory are within the limits */
+void LUCache::trim()
+{
+    double MB = 0.0;
+    for(Entry const &entry : s_Entry) MB += memorySize(entry);
+
+    while(s_Entry.size() && (int(s_Entry.size())>s_MaxEntries || MB>s_MaxMemory))
+    {
+        auto last = std::prev(s_Entry.end());
+        MB -= memorySize(*last);
+        discard(last);
+    }
+}
+
+
+/** Removes the entry and its spill file, if any */
+void LUCache::discard(std::list<Entry>::iterator it)
+{
+    if(it->m_FileName.length()) std::remove(it->m_FileName.c_str());
+    s_Entry.erase(it);
+}
+
+
+bool LUCache::writeSpillFile(Entry &entry, std::vector<double> const &aijd, std::vector<float> const &aijf)
+{
+    char name[64];
+    snprintf(name, sizeof(name), "/flow5_lu_%016llx.bin", static_cast<unsigned long long>(entry.m_Key));
+    std::string filename = s_SpillDir + name;
+
+    std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+    if(!out.is_open()) return false;
+
+    uint64_t nd = aijd.size();
+    uint64_t nf = aijf.size();
+    out.write(reinterpret_cast<char const*>(&nd), sizeof(uint64_t));
+    out.write(reinterpret_cast<char const*>(&nf), sizeof(uint64_t));
+    out.write(reinterpret_cast<char const*>(aijd.data()), std::streamsize(nd*sizeof(double)));
+    out.write(reinterpret_cast<char const*>(aijf.data()), std::streamsize(nf*sizeof(float)));
+    out.close();
+    if(out.fail())
+    {
+        std::remove(filename.c_str());
+        return false;
+    }
+
+    entry.m_FileName = filename;
+    return true;
+}
+
+
+bool LUCache::readSpillFile(Entry const &entry, std::vector<double> &aijd, std::vector<float> &aijf)
+{
+    std::ifstream in(entry.m_FileName, std::ios::binary);
+    if(!in.is_open()) return false;
+
+    uint64_t nd=0, nf=0;
+    in.read(reinterpret_cast<char*>(&nd), sizeof(uint64_t));
+    in.read(reinterpret_cast<char*>(&nf), sizeof(uint64_t));
+    if(in.fail()) return false;
+
+    try
+    {
+        aijd.resize(nd);
+        aijf.resize(nf);
+    }
+    catch(std::bad_alloc &)
+    {
+        return false;
+    }
+    in.read(reinterpret_cast<char*>(aijd.data()), std::streamsize(nd*sizeof(double)));
+    in.read(reinterpret_cast<char*>(aijf.data()), std::streamsize(nf*sizeof(float)));
+    return !in.fail();
+}
+
@@ -26,7 +26,6 @@
 
 #include <QString>
 
-#include <thread>
 
 
 #include <p3analysis.h>
@@ -37,6 +36,7 @@
 #include <polar3d.h>
 #include <objects2d.h>
 #include <stabderivatives.h>
+#include <threadpool.h>
 #include <vortex.h>
 #include <vorton.h>
 
@@ -64,6 +64,9 @@ void P3Analysis::releasePanelArrays()
     m_rRHSVertex.clear();
     m_Panel3.clear();
     m_WakePanel3.clear();
+    m_TreeSolver.clear();
+    m_KernelView.clear();
+    m_MirrorKernelView.clear();
 }
 
 
@@ -74,6 +77,32 @@ void P3Analysis::setTriMesh(TriMesh const &trimesh)
 
     m_Panel3 = trimesh.panels();
     m_WakePanel3 = trimesh.wakePanels();
+    makeKernelView();
+}
+
+
+/**
+ * Rebuilds the structure-of-arrays copy of the panels used by the vectorized influence loops.
+ * Must be called each time the panels have been moved.
+ */
+void P3Analysis::makeKernelView()
+{
+    m_KernelView.make(m_Panel3);
+
+    m_MirrorKernelView.clear();
+    if(m_pPolar3d && m_pPolar3d->isTriLinearMethod() && m_pPolar3d->bHPlane())
+    {
+        // the symmetric panels with reversed orientation, as built in P3LinAnalysis::influenceBlock
+        std::vector<Panel3> mirror(m_Panel3.size());
+        for(uint i3=0; i3<m_Panel3.size(); i3++)
+        {
+            Panel3 const &p3 = m_Panel3.at(i3);
+            Vector3d S[3];
+            for(int in=0; in<3; in++)  S[in].set(p3.node(in).x, p3.node(in).y, -p3.node(in).z-2.0*m_pPolar3d->groundHeight());
+            mirror[i3] = Panel3(S[0], S[2], S[1]);
+        }
+        m_MirrorKernelView.make(mirror);
+    }
 }
 
 
@@ -87,7 +116,13 @@ bool P3Analysis::initializeAnalysis(Polar3d const *pPolar3d, int nRHS)
 
     if(nRHS>0)
     {
-        if(!allocateMatrix(N)) return false;
+        if(!bDenseMatrix())
+        {
+            // the dense matrix is never built
+            m_aijd.clear();
+            m_aijf.clear();
+        }
+        else if(!allocateMatrix(N)) return false;
 
         int memsize =     allocateRHS3(nRHS);
         QString strange = QString::asprintf("Allocating %2f Mb for %d RHS vectors", double(memsize)/1024.0/1024.0, nRHS);
@@ -220,81 +255,38 @@ void P3Analysis::getDebugPotential(Vector3d const &C, bool bSelf, double const *
 }
 
 
-void P3Analysis::getVelocityVector(Vector3d const &C,
-                                   double const *Mu, double const *Sigma,
-                                   Vector3d &VT, double coreradius, bool bWakeOnly, bool bMultiThread) const
-{
-    tmp_coreradius = coreradius;
-    tmp_bWakeOnly = bWakeOnly;
-    tmp_Mu = Mu;
-    tmp_Sigma = Sigma;
-
-    std::vector<Vector3d> VBlock(m_nBlocks);
-
-    if(bMultiThread)
-    {
-        std::vector<std::thread> threads;
-
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            threads.push_back(std::thread(&P3Analysis::velocityVectorBlock, this, iBlock, C, &VBlock[iBlock]));
-        }
-
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            threads[iBlock].join();
-        }
-//        std::cout << "P3Analysis::getVelocityVector joined all " << m_nBlocks << " threads" <<std::endl;
-    }
-    else
-    {
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            velocityVectorBlock(iBlock, C, &VBlock[iBlock]);
-        }
-    }
-
-    VT.reset(); // total induced velocity
-    for(int ib=0; ib<m_nBlocks; ib++) VT += VBlock[ib];
-
-    if(m_pPolar3d->bVortonWake())
-    {
-        double vtncorelength = m_pPolar3d->vortonCoreSize()*m_pPolar3d->referenceChordLength();
-
-        Vector3d VVtn;
-        getVortonVelocity(C, vtncorelength, VVtn, bMultiThread);
-        VT += VVtn;
-    }
-}
-
-
-void P3Analysis::velocityVectorBlock(int iBlock, Vector3d const &C, Vector3d *VT) const
+/**
+ * Adds the velocity, and the potential if phi is not null, induced at point C by the panels in the range [iStart, iEnd[.
+ * The kernel view is used for the surface panels if it has been built, unless the potential is requested.
+ */
+void P3Analysis::velocityVectorRange(Vector3d const &C, int iStart, int iEnd, double const *Mu, double const *Sigma,
+                                     double coreradius, bool bWakeOnly, Vector3d &VT, double *phi) const
 {
-    int blockSize = int(nPanels()/m_nBlocks) +1;
-    int iStart = iBlock*blockSize;
-    int maxRows = nPanels();
-    int iMax = std::min(iStart+blockSize, maxRows);
-
     Vector3d Vd[3], Vs;
+    double phiD[]{0,0,0}, phiS(0);
     double sign=0;
 
-    for (int i3=iStart; i3<iMax; i3++)
+    bool bKernelView = !bWakeOnly && !phi && m_KernelView.size()==nPanels();
+    if(bKernelView) surfaceVelocity(C, iStart, iEnd, Mu, Sigma, coreradius, VT);
+
+    for (int i3=iStart; i3<iEnd; i3++)
     {
         Panel3 const &p3 = m_Panel3.at(i3);
 
-        if(!tmp_bWakeOnly)
+        if(!bWakeOnly && !bKernelView)
         {
-            if(tmp_Sigma && fabs(tmp_Sigma[i3])>0.0)
+            if(Sigma && fabs(Sigma[i3])>0.0)
             {
-                getSourceInfluence(m_pPolar3d, C, p3, C.isSame(p3.CoG()), &Vs, nullptr);
-                *VT += Vs * tmp_Sigma[i3];
+                getSourceInfluence(m_pPolar3d, C, p3, C.isSame(p3.CoG()), &Vs, phi ? &phiS : nullptr);
+                VT += Vs * Sigma[i3];
+                if(phi) *phi += phiS * Sigma[i3];
             }
 
-            getDoubletInfluence(C, p3, Vd, nullptr, tmp_coreradius, true);
-            VT->x += Vd[0].x*tmp_Mu[3*i3+0] + Vd[1].x*tmp_Mu[3*i3+1] + Vd[2].x*tmp_Mu[3*i3+2];
-            VT->y += Vd[0].y*tmp_Mu[3*i3+0] + Vd[1].y*tmp_Mu[3*i3+1] + Vd[2].y*tmp_Mu[3*i3+2];
-            VT->z += Vd[0].z*tmp_Mu[3*i3+0] + Vd[1].z*tmp_Mu[3*i3+1] + Vd[2].z*tmp_Mu[3*i3+2];
-
+            getDoubletInfluence(C, p3, Vd, phi ? phiD : nullptr, coreradius, true);
+            VT.x += Vd[0].x*Mu[3*i3+0] + Vd[1].x*Mu[3*i3+1] + Vd[2].x*Mu[3*i3+2];
+            VT.y += Vd[0].y*Mu[3*i3+0] + Vd[1].y*Mu[3*i3+1] + Vd[2].y*Mu[3*i3+2];
+            VT.z += Vd[0].z*Mu[3*i3+0] + Vd[1].z*Mu[3*i3+1] + Vd[2].z*Mu[3*i3+2];
+            if(phi) *phi += phiD[0]*Mu[3*i3+0] + phiD[1]*Mu[3*i3+1] + phiD[2]*Mu[3*i3+2];
         }
 
         // Is the panel shedding a wake?
@@ -304,39 +296,37 @@ void P3Analysis::velocityVectorBlock(int iBlock, Vector3d const &C, Vector3d *VT
             if(p3.isBotPanel()) sign=-1.0; else sign=1.0;
             if(p3.iWake()<0) continue; // requesting the velocity before the wake has been set - usually the consequence of a repaint signal for streamlines
 
-            //in the case of wake roll-up, only the panels upstream of row nWakeRow
-//            int iRow=0;
             Panel3 const *p3w = &m_WakePanel3[p3.iWake()];
 
             // whether p3 is on the left or right wing, node 1 is its left trailing node and node 2 is its right trailing node
             //Mu3[3*i3+1] is the doublet density at the wing's panel left trailing node, and Mu3[3*i3+3] at the right trailing node
-            double mu3left  = tmp_Mu[3*i3+1];
-            double mu3right = tmp_Mu[3*i3+2];
+            double mu3left  = Mu[3*i3+1];
+            double mu3right = Mu[3*i3+2];
 
             while(p3w)
             {
                 // do not use RFF approximation for wake panels?
-                getDoubletInfluence(C, *p3w, Vd, nullptr, tmp_coreradius, false);
+                getDoubletInfluence(C, *p3w, Vd, phi ? phiD : nullptr, coreradius, false);
 
                 if(p3w->isLeftSidePanel())
                 {
-                    VT->x += ((Vd[0].x+Vd[2].x)*mu3left +  Vd[1].x       *mu3right) *sign;
-                    VT->y += ((Vd[0].y+Vd[2].y)*mu3left +  Vd[1].y       *mu3right) *sign;
-                    VT->z += ((Vd[0].z+Vd[2].z)*mu3left +  Vd[1].z       *mu3right) *sign;
+                    VT.x += ((Vd[0].x+Vd[2].x)*mu3left +  Vd[1].x       *mu3right) *sign;
+                    VT.y += ((Vd[0].y+Vd[2].y)*mu3left +  Vd[1].y       *mu3right) *sign;
+                    VT.z += ((Vd[0].z+Vd[2].z)*mu3left +  Vd[1].z       *mu3right) *sign;
+                    if(phi) *phi += ((phiD[0]+phiD[2])*mu3left + phiD[1]*mu3right) *sign;
                     // if p3w is a left wake panel, node 0 and 2 are left side and node 1 is right side - cf. TriMesh::makeWakePanels()
                 }
                 else
                 {
                     // if p3w is a right wake panel, node 2 is left side and node 0 and 1 are right side
-                    VT->x += ( Vd[2].x       *mu3left + (Vd[0].x+Vd[1].x)*mu3right) *sign;
-                    VT->y += ( Vd[2].y       *mu3left + (Vd[0].y+Vd[1].y)*mu3right) *sign;
-                    VT->z += ( Vd[2].z       *mu3left + (Vd[0].z+Vd[1].z)*mu3right) *sign;
+                    VT.x += ( Vd[2].x       *mu3left + (Vd[0].x+Vd[1].x)*mu3right) *sign;
+                    VT.y += ( Vd[2].y       *mu3left + (Vd[0].y+Vd[1].y)*mu3right) *sign;
+                    VT.z += ( Vd[2].z       *mu3left + (Vd[0].z+Vd[1].z)*mu3right) *sign;
+                    if(phi) *phi += (phiD[2]*mu3left + (phiD[0]+phiD[1])*mu3right) *sign;
                 }
                 // is there another wake panel downstream?
                 if(p3w->m_iPD>=0) p3w = m_WakePanel3.data() + p3w->m_iPD;
                 else              p3w = nullptr;
-
-//                iRow++;
             }
         }
         if(isCancelled()) return;
@@ -348,6 +338,48 @@ void P3Analysis::velocityVectorBlock(int iBlock, Vector3d const &C, Vector3d *VT
  * Returns the perturbation velocity vector far downstream using a line vortex model for the wake
  * irrespective of the analysis method.
  */
+/**
+ * Adds the velocity induced at point C by the source and doublet densities of the panels in the range [iStart, iEnd[.
+ * The panels are processed in packets by the kernel view; the influence of the panels
+ * in the near field is calculated with the exact integrals.
+ */
+void P3Analysis::surfaceVelocity(Vector3d const &C, int iStart, int iEnd, double const *Mu, double const *Sigma, double coreradius,
+                                 Vector3d &VT) const
+{
+    Vector3d CG(C.x, C.y, -C.z-2.0*m_pPolar3d->groundHeight());
+    Vector3d const *pCG = m_pPolar3d->bHPlane() ? &CG : nullptr;
+    double gcoef = m_pPolar3d->bGroundEffect() ? 1.0 : -1.0;
+
+    std::vector<int> nearpanels;
+    Vector3d Vd[3], Vs;
+
+    if(Sigma)
+    {
+        m_KernelView.sourceVelocity(C, pCG, gcoef, iStart, iEnd, Sigma, VT, nearpanels);
+        for(int i3 : nearpanels)
+        {
+            Panel3 const &p3 = m_Panel3.at(i3);
+            getSourceInfluence(m_pPolar3d, C, p3, C.isSame(p3.CoG()), &Vs, nullptr);
+            VT += Vs * Sigma[i3];
+        }
+        nearpanels.clear();
+    }
+
+    if(m_pPolar3d->isTriLinearMethod())
+        m_KernelView.doubletLinVelocity(C, pCG, gcoef, iStart, iEnd, Mu, VT, nearpanels);
+    else
+        m_KernelView.doubletUniVelocity(C, pCG, gcoef, iStart, iEnd, Mu, Vortex::coreRadius(), VT, nearpanels);
+
+    for(int i3 : nearpanels)
+    {
+        getDoubletInfluence(C, m_Panel3.at(i3), Vd, nullptr, coreradius, true);
+        VT.x += Vd[0].x*Mu[3*i3+0] + Vd[1].x*Mu[3*i3+1] + Vd[2].x*Mu[3*i3+2];
+        VT.y += Vd[0].y*Mu[3*i3+0] + Vd[1].y*Mu[3*i3+1] + Vd[2].y*Mu[3*i3+2];
+        VT.z += Vd[0].z*Mu[3*i3+0] + Vd[1].z*Mu[3*i3+1] + Vd[2].z*Mu[3*i3+2];
+    }
+}
+
+
 void P3Analysis::getFarFieldVelocity(const Vector3d &C, const std::vector<Panel3> &panel3, const double *Mu,
                                      Vector3d &VT, double coreradius) const
 {
@@ -668,6 +700,9 @@ int P3Analysis::makeWakePanels(const Vector3d &WindDirection, bool bVortonWake)
                                 WindDirection, m_WakePanel3, m_nStations, false);
     }
 
+    // the panels may have been moved since the last call
+    makeKernelView();
+
     return nWakePanels();
 }
 
@@ -692,20 +727,21 @@ void P3Analysis::restorePanels()
 {
     m_Panel3     = m_refPanel3;
     m_WakePanel3 = m_refWakePanel3;
+    makeKernelView();
 }
 
 
-void P3Analysis::scaleResultsToSpeed(double ratio)
+void P3Analysis::scaleResultsToSpeed(double ratio, double *Mu, double *Sigma) const
 {
     //______________________________________________________________________________________
     // Scale RHS and Sigma i.a.w. speeds (so far we have unit doublet and source strengths)
     for(int pp=0; pp<3*nPanels(); pp++)
     {
-        m_Mu[pp] *= ratio;
+        Mu[pp] *= ratio;
     }
     for(int pp=0; pp<nPanels(); pp++)
     {
-        m_Sigma[pp] *= ratio;
+        Sigma[pp] *= ratio;
     }
 }
 
@@ -716,7 +752,7 @@ void P3Analysis::scaleResultsToSpeed(double ratio)
  * The induced drag is evaluated separately in the Trefftz plane or in the vorton wake
  * */
 void P3Analysis::inducedForce(int nPanel3, double QInf, double alpha, double beta,
-                              int pos3, Vector3d &ForceBodyAxes, SpanDistribs &SpanResFF) const
+                              int pos3, double const *Mu, Vector3d &ForceBodyAxes, SpanDistribs &SpanResFF) const
 {
     Vector3d VInf;
     double gLeft=0, gRight=0, gMid=0;
@@ -729,7 +765,7 @@ void P3Analysis::inducedForce(int nPanel3, double QInf, double alpha, double bet
     double q = 0.5 * m_pPolar3d->density() * QInf * QInf;
     Vector3d StripForce; // body axes
 
-    double const *mu3    = m_Mu.data();
+    double const *mu3    = Mu;
     int m=0;
     for(int i3=0; i3<nPanel3; i3++)
     {
@@ -777,7 +813,7 @@ void P3Analysis::inducedForce(int nPanel3, double QInf, double alpha, double bet
 }
 
 
-void P3Analysis::trefftzDrag(int nPanel3, double QInf, double alpha, double beta, int pos3,
+void P3Analysis::trefftzDrag(int nPanel3, double QInf, double alpha, double beta, int pos3, double const *Mu, double const *Sigma,
                              Vector3d &Drag, SpanDistribs &SpanResFF) const
 {
     Vector3d left, right;
@@ -797,8 +833,8 @@ void P3Analysis::trefftzDrag(int nPanel3, double QInf, double alpha, double beta
 
     //dynamic pressure, kg/m³
 
-    double const *mu3    = m_Mu.data();
-    double const *sigma3 = m_Sigma.data();
+    double const *mu3    = Mu;
+    double const *sigma3 = Sigma;
 
 //    clearDebugPts();
 
@@ -891,18 +927,61 @@ void P3Analysis::trefftzDrag(int nPanel3, double QInf, double alpha, double beta
 
 
 /**
-* Calculates the forces using a far-field method.
+ * Returns the perturbation velocities induced by the wake at the mid-point of the last wake panel of each trailing strip,
+ * in the order in which the strips are visited in forcesFromDownwash().
+ * The points are independent and are evaluated concurrently.
+ */
+void P3Analysis::trefftzDownwash(double const *Mu3, std::vector<Vector3d> &Wg) const
+{
+    Vector3d left, right;
+    std::vector<Vector3d> pts;
+    std::vector<double> coreradius;
+
+    for(int i3=0; i3<nPanels(); i3++)
+    {
+        Panel3 const &p3 = m_Panel3.at(i3);
+        if(p3.isMidPanel())
+        {
+            if(p3.isTrailing())
+            {
+                // get the last triangle of the wake column
+                assert(p3.iWake()>=0 && p3.iWake()<nWakePanels());
+                trailingWakePoint(m_WakePanel3.data() + p3.iWake(), left, right);
+                pts.push_back((left + right)/2.0);
+                coreradius.push_back(0.00001);
+            }
+        }
+        else if(p3.isTrailing() && p3.isBotPanel())
+        {
+            trailingWakePoint(m_WakePanel3.data() + p3.iWake(), left, right);
+            pts.push_back((left + right)/2.0);
+            /** @todo used to be bWakeOnly=false up to beta07 */
+            coreradius.push_back(Vortex::coreRadius());
+        }
+    }
+
+    Wg.resize(pts.size());
+    ThreadPool::parallelFor(0, int(pts.size()), [&](int m0, int m1)
+                            {
+                                for(int m=m0; m<m1; m++)
+                                    getVelocityVector(pts.at(m), Mu3, nullptr, Wg[m], coreradius.at(m), true, false);
+                            },
+                            s_bMultiThread, 1);
+}
+
+
+/**
+* Calculates the forces using a far-field method, with the downwash precalculated by trefftzDownwash().
 * Calculates the moments by a near field method, i.e. direct summation on the panels.
 * The downwash is evaluated far downstream (i.e. where the inluence of the bounded vortices is negligible)
 */
-void P3Analysis::forces(double const *Mu3, double const *Sigma3, double alpha, double beta, Vector3d const &CoG, bool bFuseMi,
-                        std::vector<Vector3d> const &VInf, Vector3d &Force, Vector3d &Moment)
+void P3Analysis::forcesFromDownwash(double const *Mu3, double const *, double alpha, double beta, Vector3d const &CoG, bool bFuseMi,
+                                    std::vector<Vector3d> const &VInf, std::vector<Vector3d> const &WDownwash, Vector3d &Force, Vector3d &Moment)
 {
     if(!m_pPolar3d) return;
 
     double Cp=0.0, viscousDrag=0.0;
     double QInf=1.0;
-    Vector3d left, mid, right;
     Vector3d WindDirection, WindNormal, PanelLeverArm, Wg;
     Vector3d Velocity, stripforce, viscousMoment, PanelForce;
 
@@ -915,7 +994,7 @@ void P3Analysis::forces(double const *Mu3, double const *Sigma3, double alpha, d
     viscousDrag = 0.0;
     viscousMoment.set(0.0,0.0,0.0);
 
-//    int m=0;
+    int m=0;
 
     for(int i3=0; i3<nPanels(); i3++)
     {
@@ -925,14 +1004,7 @@ void P3Analysis::forces(double const *Mu3, double const *Sigma3, double alpha, d
         {
             if(p3.isTrailing())
             {
-                // get the last triangle of the wake column
-                assert(p3.iWake()>=0 && p3.iWake()<nWakePanels());
-                Panel3 *p3W = m_WakePanel3.data() + p3.iWake();
-                trailingWakePoint(p3W, left, right);
-                mid = (left + right)/2.0;
-
-                //    s_PointDbg.push_back(C);
-                getVelocityVector(mid, Mu3, Sigma3, Wg, 0.00001, true, true);
+                Wg = WDownwash.at(m);
 
                 int idxM = p3.index();
                 double GammaStrip = -(Mu3[3*idxM+1] + Mu3[3*idxM+2])/2.0 *4.0*PI;
@@ -945,7 +1017,7 @@ void P3Analysis::forces(double const *Mu3, double const *Sigma3, double alpha, d
                 stripforce *= GammaStrip * m_pPolar3d->density();     // N
                 Force += stripforce;
 
- //               m++;
+                m++;
             }
         }
         else if(p3.isTrailing() && p3.isBotPanel())
@@ -955,15 +1027,7 @@ void P3Analysis::forces(double const *Mu3, double const *Sigma3, double alpha, d
             assert(idxU>=0);
 
             //Get the strip's lifting force
-
-            // get the last triangle of the wake column
-            Panel3 *p3W = m_WakePanel3.data() + p3.iWake();
-            trailingWakePoint(p3W, left, right);
-            mid = (left + right)/2.0;
-
-            /** @todo used to be bWakeOnly=false up to beta07 */
-            getVelocityVector(mid, Mu3, Sigma3, Wg, Vortex::coreRadius(), true, true);
-
+            Wg = WDownwash.at(m);
             Wg += VInf.at(i3);
 
             // the trailing nodes have indexes 1 & 2
@@ -976,7 +1040,7 @@ void P3Analysis::forces(double const *Mu3, double const *Sigma3, double alpha, d
             stripforce *= GammaStrip * m_pPolar3d->density();     // N
 
             Force += stripforce;
-//            m++;
+            m++;
         }
     }
 
@@ -1102,8 +1166,8 @@ double P3Analysis::computeCm(Vector3d const &CoG, double Alpha, bool bFuseMi)
 
     std::vector<Vector3d> VLocal(nPanels()*3);
     std::vector<Vector3d> VInf(nPanels(), WindDirection);
-    combineLocalVelocities(Alpha, beta, VLocal);
-    computeOnBodyCp(VInf, VLocal, m_Cp);
+    combineLocalVelocities(Alpha, beta, m_uVLocal, m_vVLocal, m_wVLocal, VLocal);
+    computeOnBodyCp(VInf, VLocal, m_Cp.data());
 
     bool bTrace = false;
     double Cm = 0.0;
@@ -1252,11 +1316,11 @@ bool P3Analysis::computeTrimmedConditions(double mass, Vector3d const &CoG, doub
     }
 
 
-    makeSourceStrengths(objects::windDirection(alphaeq, 0.0));
+    makeSourceStrengths(objects::windDirection(alphaeq, 0.0), m_Sigma.data());
     if (isCancelled()) return true;
 
     //reconstruct doublet strengths from unit cosine and sine vectors
-    makeUnitDoubletStrengths(alphaeq, 0.0);
+    makeUnitDoubletStrengths(alphaeq, 0.0, m_Mu.data());
     if(isCancelled()) return false;
 
     //______________________________________________________________________________________
@@ -1311,29 +1375,35 @@ void P3Analysis::makeInfluenceMatrix()
 
     m_bMatrixError = false;
 
-    if(s_bMultiThread)
+    if(s_MatrixSolver==xfl::BARNESHUT)
     {
-        std::vector<std::thread> threads;
-
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
+        int nBasis = isTriLinMethod() ? 3 : 1;
+        if(!m_TreeSolver.build(this, nBasis, m_nBlocks, s_bMultiThread))
         {
-            threads.push_back(std::thread(&P3Analysis::makeMatrixBlock, this, iBlock));
+            if(!isCancelled()) m_bMatrixError = true;
         }
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
+    }
+    else if(s_MatrixSolver==xfl::HMATRIX)
+    {
+        if(!makeHMatrix())
         {
-            threads[iBlock].join();
+            if(!isCancelled()) m_bMatrixError = true;
         }
-//        std::cout << "P3Analysis::makeInfluenceMatrix joined all " << m_nBlocks << " threads" <<std::endl;
-
     }
-    else
+    else if(s_MatrixSolver==xfl::OUTOFCORE)
     {
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
+        if(!makeTiledMatrix())
         {
-            if(m_bMatrixError) break; // no point to continue
-            makeMatrixBlock(iBlock);
+            if(!isCancelled()) m_bMatrixError = true;
         }
     }
+    else
+    {
+        makeKernelView();
+        if(!refillMovedPanels())
+            runBlocks([this](int iBlock) {if(!m_bMatrixError) makeMatrixBlock(iBlock);});
+        storeBodyMatrix();
+    }
 
 
     if(m_bMatrixError)
@@ -1343,6 +1413,150 @@ void P3Analysis::makeInfluenceMatrix()
 }
 
 
+/**
+ * In the case of the tree solver, builds the preconditioner in place of the LU factorization.
+ */
+bool P3Analysis::LUfactorize()
+{
+    if(s_MatrixSolver==xfl::BARNESHUT)
+    {
+        if(!m_TreeSolver.makePreconditioner())
+        {
+            traceStdLog("         Error making the preconditioner.... Aborting calculation...\n");
+            return false;
+        }
+        return true;
+    }
+    return PanelAnalysis::LUfactorize();
+}
+
+
+void P3Analysis::backSubUnitRHS(double *uRHS, double *vRHS, double *wRHS, double *pRHS, double *qRHS, double *rRHS)
+{
+    if(s_MatrixSolver==xfl::BARNESHUT)
+    {
+        if(uRHS) m_TreeSolver.solve(uRHS);
+        if(vRHS) m_TreeSolver.solve(vRHS);
+        if(wRHS) m_TreeSolver.solve(wRHS);
+        if(pRHS) m_TreeSolver.solve(pRHS);
+        if(qRHS) m_TreeSolver.solve(qRHS);
+        if(rRHS) m_TreeSolver.solve(rRHS);
+        return;
+    }
+    PanelAnalysis::backSubUnitRHS(uRHS, vRHS, wRHS, pRHS, qRHS, rRHS);
+}
+
+
+bool P3Analysis::backSubRHS(std::vector<double> &RHS)
+{
+    if(s_MatrixSolver==xfl::BARNESHUT)
+    {
+        if(!m_TreeSolver.solve(RHS.data()))
+        {
+            traceStdLog("      Error back-solving the RHS\n");
+            return false;
+        }
+        return true;
+    }
+    return PanelAnalysis::backSubRHS(RHS);
+}
+
+
+bool P3Analysis::backSubRHSBatch(double *RHS, int nRHS)
+{
+    if(s_MatrixSolver==xfl::BARNESHUT)
+    {
+        for(int k=0; k<nRHS; k++)
+        {
+            if(!m_TreeSolver.solve(RHS+k*matSize()))
+            {
+                traceStdLog("      Error back-solving the RHS\n");
+                return false;
+            }
+        }
+        return true;
+    }
+    return PanelAnalysis::backSubRHSBatch(RHS, nRHS);
+}
+
+
+void P3Analysis::panelNeighbours(int p, std::vector<int> &neighbours) const
+{
+    neighbours.clear();
+    if(p<0 || p>=nPanels()) return;
+    Panel3 const &p3 = m_Panel3.at(p);
+    for(int in=0; in<3; in++)
+    {
+        if(p3.neighbour(in)>=0 && p3.neighbour(in)<nPanels()) neighbours.push_back(p3.neighbour(in));
+    }
+}
+
+
+double P3Analysis::panelRadius(int p) const
+{
+    Panel3 const &p3 = m_Panel3.at(p);
+    double r = 0.0;
+    for(int in=0; in<3; in++) r = std::max(r, p3.CoG().distanceTo(p3.node(in)));
+    return r;
+}
+
+
+/**
+ * The wake columns are attached to the bottom or mid trailing panels,
+ * and their contribution is also transferred to the opposite top panels.
+ */
+void P3Analysis::wakeColumnPanels(std::vector<int> &panels) const
+{
+    panels.clear();
+    for(int k3=0; k3<nPanels(); k3++)
+    {
+        Panel3 const &p3k = m_Panel3.at(k3);
+        if(p3k.isTrailing() && (p3k.isBotPanel() || p3k.isMidPanel()))
+        {
+            panels.push_back(k3);
+            if(p3k.isBotPanel() && p3k.oppositeIndex()>=0) panels.push_back(p3k.oppositeIndex());
+        }
+    }
+}
+
+
+void P3Analysis::hashPanels(LUCache::Key &key) const
+{
+    key.add(Panel3::quadratureOrder());
+    key.add(Panel3::usingNintcheuFataMethod());
+    for(std::vector<Panel3> const *pPanels : {&m_Panel3, &m_WakePanel3})
+    {
+        key.add(int(pPanels->size()));
+        for(Panel3 const &p3 : *pPanels)
+        {
+            for(int in=0; in<3; in++)
+            {
+                Node const &nd = p3.node(in);
+                key.add(nd.x);
+                key.add(nd.y);
+                key.add(nd.z);
+                key.add(nd.index());
+            }
+            key.add(int(p3.surfacePosition()));
+            key.add(p3.isTrailing());
+            key.add(p3.iWake());
+            key.add(p3.iWakeColumn());
+            key.add(p3.oppositeIndex());
+        }
+    }
+}
+
+
+void P3Analysis::panelVertices(std::vector<Vector3d> &vertices) const
+{
+    vertices.resize(3*m_Panel3.size());
+    for(uint i3=0; i3<m_Panel3.size(); i3++)
+    {
+        for(int in=0; in<3; in++) vertices[3*i3+in] = m_Panel3.at(i3).node(in);
+    }
+}
+
+
 /**
  * UNUSED
  * Makes the array of negating vortices at the downstream end of the wake panels.
@@ -1425,7 +1639,9 @@ void P3Analysis::getDoubletInfluence(Vector3d const &C, Panel3 const &p3, Vector
 }
 
 
-void P3Analysis::combineLocalVelocities(double alpha, double beta, std::vector<Vector3d> &VLocal) const
+void P3Analysis::combineLocalVelocities(double alpha, double beta,
+                                        std::vector<Vector3d> const &uVLocal, std::vector<Vector3d> const &vVLocal, std::vector<Vector3d> const &wVLocal,
+                                        std::vector<Vector3d> &VLocal) const
 {
     VLocal.resize(nPanels()*3);
     double cosa = cos(alpha*PI/180.0);
@@ -1434,9 +1650,9 @@ void P3Analysis::combineLocalVelocities(double alpha, double beta, std::vector<V
     double sinb = sin(-beta*PI/180.0); //change of beta sign introduced in v7.24 to be consistent with AVL
     for(int i=0; i<int(VLocal.size()); i++)
     {
-        VLocal[i].x = cosa*cosb* m_uVLocal.at(i).x + sinb*m_vVLocal.at(i).x + sina*cosb* m_wVLocal.at(i).x;
-        VLocal[i].y = cosa*cosb* m_uVLocal.at(i).y + sinb*m_vVLocal.at(i).y + sina*cosb* m_wVLocal.at(i).y;
-        VLocal[i].z = cosa*cosb* m_uVLocal.at(i).z + sinb*m_vVLocal.at(i).z + sina*cosb* m_wVLocal.at(i).z;
+        VLocal[i].x = cosa*cosb* uVLocal.at(i).x + sinb*vVLocal.at(i).x + sina*cosb* wVLocal.at(i).x;
+        VLocal[i].y = cosa*cosb* uVLocal.at(i).y + sinb*vVLocal.at(i).y + sina*cosb* wVLocal.at(i).y;
+        VLocal[i].z = cosa*cosb* uVLocal.at(i).z + sinb*vVLocal.at(i).z + sina*cosb* wVLocal.at(i).z;
     }
 
 //    for(int i=0; i<VLocal.size(); i++)        qDebug("  %11g  %11g  %11g", VLocal.at(i).x, VLocal.at(i).y, VLocal.at(i).z);
@@ -0,0 +1,681 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <algorithm>
+#include <cmath>
+
+#include <p3kernelview.h>
+
+#include <gqtriangle.h>
+#include <panel3.h>
+#include <panelprecision.h>
+
+
+P3KernelView::P3KernelView()
+{
+    m_nPanels = 0;
+    m_nPadded = 0;
+}
+
+
+void P3KernelView::clear()
+{
+    m_nPanels = m_nPadded = 0;
+    for(std::vector<double> *pv : {&m_cx, &m_cy, &m_cz, &m_lx, &m_ly, &m_lz, &m_mx, &m_my, &m_mz, &m_nx, &m_ny, &m_nz,
+                                   &m_Area, &m_MaxSize, &m_bxSum, &m_bySum, &m_bValid})
+        pv->clear();
+    for(int i=0; i<3; i++)
+    {
+        m_bx[i].clear();  m_by[i].clear();
+        m_sx[i].clear();  m_sy[i].clear();  m_sz[i].clear();
+        m_bEdge[i].clear();
+    }
+}
+
+
+/**
+ * Copies the panels' data in the arrays.
+ * The arrays are padded with one extra packet of invalid panels, so that a packet
+ * may start at any index without reading past the end of the arrays.
+ */
+void P3KernelView::make(std::vector<Panel3> const &panel3)
+{
+    m_nPanels = int(panel3.size());
+    m_nPadded = ((m_nPanels+LANES-1)/LANES + 1) * LANES;
+
+    for(std::vector<double> *pv : {&m_cx, &m_cy, &m_cz, &m_lx, &m_ly, &m_lz, &m_mx, &m_my, &m_mz, &m_nx, &m_ny, &m_nz,
+                                   &m_Area, &m_MaxSize, &m_bxSum, &m_bySum, &m_bValid})
+        pv->assign(m_nPadded, 0.0);
+    for(int i=0; i<3; i++)
+    {
+        m_bx[i].assign(m_nPadded, 0.0);  m_by[i].assign(m_nPadded, 0.0);
+        m_sx[i].assign(m_nPadded, 0.0);  m_sy[i].assign(m_nPadded, 0.0);  m_sz[i].assign(m_nPadded, 0.0);
+        m_bEdge[i].assign(m_nPadded, 0.0);
+    }
+
+    for(int k=0; k<m_nPanels; k++)
+    {
+        Panel3 const &p3 = panel3.at(k);
+        m_cx[k] = p3.m_CoG_g.x;     m_cy[k] = p3.m_CoG_g.y;     m_cz[k] = p3.m_CoG_g.z;
+        m_lx[k] = p3.m_l.x;         m_ly[k] = p3.m_l.y;         m_lz[k] = p3.m_l.z;
+        m_mx[k] = p3.m_m.x;         m_my[k] = p3.m_m.y;         m_mz[k] = p3.m_m.z;
+        m_nx[k] = p3.m_Normal.x;    m_ny[k] = p3.m_Normal.y;    m_nz[k] = p3.m_Normal.z;
+        m_Area[k]    = p3.m_Area;
+        m_MaxSize[k] = p3.m_MaxSize;
+        m_bValid[k]  = p3.isNullTriangle() ? 0.0 : 1.0;
+
+        for(int i=0; i<3; i++)
+        {
+            m_bx[i][k] = p3.bx[i];
+            m_by[i][k] = p3.by[i];
+            m_sx[i][k] = p3.m_S[i].x;
+            m_sy[i][k] = p3.m_S[i].y;
+            m_sz[i][k] = p3.m_S[i].z;
+            m_bEdge[i][k] = p3.m_S[i].isSame(p3.m_S[(i+1)%3]) ? 0.0 : 1.0;
+        }
+        m_bxSum[k] = p3.bx[0]+p3.bx[1]+p3.bx[2];
+        m_bySum[k] = p3.by[0]+p3.by[1]+p3.by[2];
+    }
+}
+
+
+/**
+ * Makes the quadrature points and weights of a receiving panel, as used in Panel3::scalarProductDoubletVelocity
+ * and Panel3::scalarProductDoubletPotential.
+ */
+void P3KernelView::makeReceiver(Panel3 const &p3, Receiver &receiver)
+{
+    std::vector<Vector2d> const &gqpt = Panel3::s_gq.points();
+    std::vector<double> const &gqw = Panel3::s_gq.weights();
+    int nq = int(gqpt.size());
+
+    receiver.m_Pt.resize(nq);
+    receiver.m_bw.resize(3*nq);
+    receiver.m_CoG = p3.CoG();
+    receiver.m_Normal = p3.normal();
+    receiver.m_Radius = 0.0;
+
+    for(int iq=0; iq<nq; iq++)
+    {
+        double x = p3.m_Sl[0].x*(1.0-gqpt.at(iq).x-gqpt.at(iq).y) + p3.m_Sl[1].x*gqpt.at(iq).x + p3.m_Sl[2].x*gqpt.at(iq).y;
+        double y = p3.m_Sl[0].y*(1.0-gqpt.at(iq).x-gqpt.at(iq).y) + p3.m_Sl[1].y*gqpt.at(iq).x + p3.m_Sl[2].y*gqpt.at(iq).y;
+
+        Vector3d &pt = receiver.m_Pt[iq];
+        p3.localToGlobalPosition(x, y, 0.0, pt.x, pt.y, pt.z);
+        receiver.m_Radius = std::max(receiver.m_Radius, pt.distanceTo(p3.CoG()));
+
+        for(int k=0; k<3; k++)
+            receiver.m_bw[3*iq+k] = p3.basis(x,y,k) * gqw.at(iq) * p3.area();
+    }
+}
+
+
+/**
+ * Sets far[l] to 1 if the point C is in the far field of the panel k0+l, i.e. at a distance greater
+ * than RFF x the panel's size + margin, and 0 otherwise or if the panel is outside the range.
+ */
+void P3KernelView::farMask(Vector3d const &C, int k0, int iEnd, double margin, double *far) const
+{
+    double const rff = Panel::RFF();
+    double const *cx = m_cx.data()+k0, *cy = m_cy.data()+k0, *cz = m_cz.data()+k0;
+    double const *maxsize = m_MaxSize.data()+k0, *valid = m_bValid.data()+k0;
+    int nLanes = iEnd-k0;
+    // local copies, which cannot alias the arrays
+    double const Cx=C.x, Cy=C.y, Cz=C.z;
+
+    double f[LANES]; // local array, cf. uniVelocityPacket
+    for(int l=0; l<LANES; l++)
+    {
+        double dx = Cx-cx[l];
+        double dy = Cy-cy[l];
+        double dz = Cz-cz[l];
+        double pjk = sqrt(dx*dx+dy*dy+dz*dz);
+        // non short-circuit operators, to keep the loop free of branches
+        f[l] = ((l<nLanes) & (valid[l]>0.0) & (pjk>rff*maxsize[l]+margin)) ? 1.0 : 0.0;
+    }
+    std::copy(f, f+LANES, far);
+}
+
+
+/**
+ * Calculates the velocities induced at point C by the uniform unit doublet densities of the packet's panels.
+ * Same as Panel3::doubletN4023Velocity with bUseRFF=true.
+ */
+void P3KernelView::uniVelocityPacket(Vector3d const &C, int k0, double coreradius, double *vx, double *vy, double *vz) const
+{
+    double const rff = Panel::RFF();
+    double const *cx = m_cx.data()+k0, *cy = m_cy.data()+k0, *cz = m_cz.data()+k0;
+    double const *nx = m_nx.data()+k0, *ny = m_ny.data()+k0, *nz = m_nz.data()+k0;
+    double const *area = m_Area.data()+k0, *maxsize = m_MaxSize.data()+k0;
+    double const Cx=C.x, Cy=C.y, Cz=C.z;
+
+    // the results are first stored in local arrays, which the compiler knows do not alias the view's arrays
+    double far[LANES], fx[LANES], fy[LANES], fz[LANES];
+    double nNear = 0.0;
+    for(int l=0; l<LANES; l++)
+    {
+        double PJKx = Cx - cx[l];
+        double PJKy = Cy - cy[l];
+        double PJKz = Cz - cz[l];
+        double PN  = PJKx*nx[l] + PJKy*ny[l] + PJKz*nz[l];
+        double pjk2 = PJKx*PJKx + PJKy*PJKy + PJKz*PJKz;
+        double pjk = sqrt(pjk2);
+        double pjk5 = pjk*pjk*pjk*pjk2;
+        far[l] = pjk>rff*maxsize[l] ? 1.0 : 0.0;
+        nNear += 1.0-far[l];
+        fx[l] = (PJKx*3.0*PN - nx[l]*pjk2) * area[l]/pjk5;
+        fy[l] = (PJKy*3.0*PN - ny[l]*pjk2) * area[l]/pjk5;
+        fz[l] = (PJKz*3.0*PN - nz[l]*pjk2) * area[l]/pjk5;
+    }
+
+    // near field, the sum of the contributions of the three sides
+    double wx[LANES], wy[LANES], wz[LANES];
+    std::fill(wx, wx+LANES, 0.0);
+    std::fill(wy, wy+LANES, 0.0);
+    std::fill(wz, wz+LANES, 0.0);
+
+    for(int i=0; i<3 && nNear>0.0; i++)
+    {
+        int j = (i+1)%3;
+        double const *six = m_sx[i].data()+k0, *siy = m_sy[i].data()+k0, *siz = m_sz[i].data()+k0;
+        double const *sjx = m_sx[j].data()+k0, *sjy = m_sy[j].data()+k0, *sjz = m_sz[j].data()+k0;
+        double const *edge = m_bEdge[i].data()+k0;
+
+        for(int l=0; l<LANES; l++)
+        {
+            double ax = Cx - six[l];
+            double ay = Cy - siy[l];
+            double az = Cz - siz[l];
+            double bx = Cx - sjx[l];
+            double by = Cy - sjy[l];
+            double bz = Cz - sjz[l];
+            double sx = sjx[l] - six[l];
+            double sy = sjy[l] - siy[l];
+            double sz = sjz[l] - siz[l];
+            double A = sqrt(ax*ax + ay*ay + az*az);
+            double B = sqrt(bx*bx + by*by + bz*bz);
+
+            //the distance of the field point to the panel's side
+            double hx =  ay*sz - az*sy;
+            double hy = -ax*sz + az*sx;
+            double hz =  ax*sy - ay*sx;
+            // non short-circuit operators, to keep the loop free of branches
+            bool bOnSide = (sqrt(hx*hx+hy*hy+hz*hz)<=coreradius) & (ax*sx+ay*sy+az*sz>=0.0) & (bx*sx+by*sy+bz*sz<=0.0);
+            bool bContrib = (edge[l]>0.0) & (A>=coreradius) & (B>=coreradius) & !bOnSide;
+
+            double GL = ((A+B) /A/B/ (A*B + ax*bx+ay*by+az*bz));
+            double vx = ( ay*bz - az*by) * GL;
+            double vy = (-ax*bz + az*bx) * GL;
+            double vz = ( ax*by - ay*bx) * GL;
+            wx[l] += bContrib ? vx : 0.0;
+            wy[l] += bContrib ? vy : 0.0;
+            wz[l] += bContrib ? vz : 0.0;
+        }
+    }
+
+    for(int l=0; l<LANES; l++)
+    {
+        vx[l] = far[l]>0.0 ? fx[l] : wx[l];
+        vy[l] = far[l]>0.0 ? fy[l] : wy[l];
+        vz[l] = far[l]>0.0 ? fz[l] : wz[l];
+    }
+}
+
+
+/**
+ * Calculates the far field velocities induced at point C by the linear doublet densities of the packet's panels.
+ * Same as the far field branch of Panel3::doubletBasisVelocity, weighted by the densities at the vertices.
+ */
+void P3KernelView::linVelocityPacket(Vector3d const &C, int k0, double const mu[3][LANES], double *vx, double *vy, double *vz) const
+{
+    double const *cx = m_cx.data()+k0, *cy = m_cy.data()+k0, *cz = m_cz.data()+k0;
+    double const *lx = m_lx.data()+k0, *ly = m_ly.data()+k0, *lz = m_lz.data()+k0;
+    double const *mx = m_mx.data()+k0, *my = m_my.data()+k0, *mz = m_mz.data()+k0;
+    double const *nx = m_nx.data()+k0, *ny = m_ny.data()+k0, *nz = m_nz.data()+k0;
+    double const *area = m_Area.data()+k0;
+    double const *bx0 = m_bx[0].data()+k0, *bx1 = m_bx[1].data()+k0, *bx2 = m_bx[2].data()+k0;
+    double const *by0 = m_by[0].data()+k0, *by1 = m_by[1].data()+k0, *by2 = m_by[2].data()+k0;
+    double const Cx=C.x, Cy=C.y, Cz=C.z;
+
+    double tx[LANES], ty[LANES], tz[LANES]; // local arrays, cf. uniVelocityPacket
+    for(int l=0; l<LANES; l++)
+    {
+        double dx = Cx-cx[l],  dy = Cy-cy[l],  dz = Cz-cz[l];
+        double x = dx*lx[l] + dy*ly[l] + dz*lz[l];
+        double y = dx*mx[l] + dy*my[l] + dz*mz[l];
+        double z = dx*nx[l] + dy*ny[l] + dz*nz[l];
+        double r = sqrt(x*x+y*y+z*z);
+        double invr3 = 1.0/r/r/r;
+        double invr5 = invr3/r/r;
+
+        double musum = mu[0][l] + mu[1][l] + mu[2][l];
+        double Vlx = z*invr5*(x*area[l]*musum - (bx0[l]*mu[0][l] + bx1[l]*mu[1][l] + bx2[l]*mu[2][l]));
+        double Vly = z*invr5*(y*area[l]*musum - (by0[l]*mu[0][l] + by1[l]*mu[1][l] + by2[l]*mu[2][l]));
+        double Vlz = (-invr3+ 3.0*z*z*invr5) *area[l]/3.0 * musum;
+
+        tx[l] = Vlx*lx[l] + Vly*mx[l] + Vlz*nx[l];
+        ty[l] = Vlx*ly[l] + Vly*my[l] + Vlz*ny[l];
+        tz[l] = Vlx*lz[l] + Vly*mz[l] + Vlz*nz[l];
+    }
+    std::copy(tx, tx+LANES, vx);
+    std::copy(ty, ty+LANES, vy);
+    std::copy(tz, tz+LANES, vz);
+}
+
+
+/**
+ * Adds the velocity induced at point C by the uniform doublet densities of the panels in the range [iStart, iEnd[.
+ * The densities are the three vertex values Mu[3*k+i], averaged as in P3Analysis::getDoubletInfluence.
+ * @param CG if not null, the symmetric point of C used to model the ground or free surface effect
+ * @param gcoef the sign of the symmetric panels' contribution
+ * @param nearpanels the null triangles, the influence of which must be calculated by the caller
+ */
+void P3KernelView::doubletUniVelocity(Vector3d const &C, Vector3d const *CG, double gcoef, int iStart, int iEnd, double const *Mu,
+                                      double coreradius, Vector3d &V, std::vector<int> &nearpanels) const
+{
+    double sx[LANES], sy[LANES], sz[LANES];
+    std::fill(sx, sx+LANES, 0.0);
+    std::fill(sy, sy+LANES, 0.0);
+    std::fill(sz, sz+LANES, 0.0);
+
+    double vx[LANES], vy[LANES], vz[LANES];
+    double w[LANES];
+
+    for(int k0=iStart; k0<iEnd; k0+=LANES)
+    {
+        int nLanes = std::min(LANES, iEnd-k0);
+        for(int l=0; l<LANES; l++)
+        {
+            int k = k0+l;
+            bool bIn = l<nLanes && m_bValid[k]>0.0;
+            w[l] = bIn ? (Mu[3*k]+Mu[3*k+1]+Mu[3*k+2])/3.0 : 0.0;
+        }
+        for(int l=0; l<nLanes; l++)
+            if(m_bValid[k0+l]<=0.0) nearpanels.push_back(k0+l);
+
+        uniVelocityPacket(C, k0, coreradius, vx, vy, vz);
+        for(int l=0; l<LANES; l++)
+        {
+            sx[l] += w[l]!=0.0 ? vx[l]*w[l] : 0.0;
+            sy[l] += w[l]!=0.0 ? vy[l]*w[l] : 0.0;
+            sz[l] += w[l]!=0.0 ? vz[l]*w[l] : 0.0;
+        }
+
+        if(CG)
+        {
+            // the symmetric panel's contribution is the z-opposite of this panel's contribution at the symmetric point
+            uniVelocityPacket(*CG, k0, coreradius, vx, vy, vz);
+            for(int l=0; l<LANES; l++)
+            {
+                sx[l] += w[l]!=0.0 ?  vx[l]*w[l]*gcoef : 0.0;
+                sy[l] += w[l]!=0.0 ?  vy[l]*w[l]*gcoef : 0.0;
+                sz[l] += w[l]!=0.0 ? -vz[l]*w[l]*gcoef : 0.0;
+            }
+        }
+    }
+
+    for(int l=0; l<LANES; l++)
+    {
+        V.x += sx[l];
+        V.y += sy[l];
+        V.z += sz[l];
+    }
+}
+
+
+/**
+ * Adds the velocity induced at point C by the linear doublet densities Mu of the panels in the range [iStart, iEnd[
+ * which are in the far field of C and of its symmetric point CG if not null.
+ * @param nearpanels the other panels, the influence of which must be calculated by the caller
+ */
+void P3KernelView::doubletLinVelocity(Vector3d const &C, Vector3d const *CG, double gcoef, int iStart, int iEnd, double const *Mu,
+                                      Vector3d &V, std::vector<int> &nearpanels) const
+{
+    double sx[LANES], sy[LANES], sz[LANES];
+    std::fill(sx, sx+LANES, 0.0);
+    std::fill(sy, sy+LANES, 0.0);
+    std::fill(sz, sz+LANES, 0.0);
+
+    double far[LANES], farG[LANES];
+    double vx[LANES], vy[LANES], vz[LANES];
+    double mu[3][LANES];
+
+    for(int k0=iStart; k0<iEnd; k0+=LANES)
+    {
+        int nLanes = std::min(LANES, iEnd-k0);
+        farMask(C, k0, iEnd, 0.0, far);
+        if(CG)
+        {
+            farMask(*CG, k0, iEnd, 0.0, farG);
+            for(int l=0; l<LANES; l++) far[l] = far[l]*farG[l];
+        }
+
+        for(int l=0; l<LANES; l++)
+        {
+            int k = k0+l;
+            for(int i=0; i<3; i++) mu[i][l] = far[l]>0.0 ? Mu[3*k+i] : 0.0;
+        }
+        for(int l=0; l<nLanes; l++)
+            if(far[l]<=0.0) nearpanels.push_back(k0+l);
+
+        linVelocityPacket(C, k0, mu, vx, vy, vz);
+        for(int l=0; l<LANES; l++)
+        {
+            sx[l] += far[l]>0.0 ? vx[l] : 0.0;
+            sy[l] += far[l]>0.0 ? vy[l] : 0.0;
+            sz[l] += far[l]>0.0 ? vz[l] : 0.0;
+        }
+
+        if(CG)
+        {
+            linVelocityPacket(*CG, k0, mu, vx, vy, vz);
+            for(int l=0; l<LANES; l++)
+            {
+                sx[l] += far[l]>0.0 ?  vx[l]*gcoef : 0.0;
+                sy[l] += far[l]>0.0 ?  vy[l]*gcoef : 0.0;
+                sz[l] += far[l]>0.0 ? -vz[l]*gcoef : 0.0;
+            }
+        }
+    }
+
+    for(int l=0; l<LANES; l++)
+    {
+        V.x += sx[l];
+        V.y += sy[l];
+        V.z += sz[l];
+    }
+}
+
+
+/**
+ * Adds the velocity induced at point C by the uniform source densities Sigma of the panels in the range [iStart, iEnd[
+ * which are in the far field of C and of its symmetric point CG if not null.
+ * Same as the far field branches of Panel3::sourceN4023Velocity and Panel3::sourceVelocity.
+ * @param nearpanels the other panels with non-zero source density, the influence of which must be calculated by the caller
+ */
+void P3KernelView::sourceVelocity(Vector3d const &C, Vector3d const *CG, double gcoef, int iStart, int iEnd, double const *Sigma,
+                                  Vector3d &V, std::vector<int> &nearpanels) const
+{
+    double sx[LANES], sy[LANES], sz[LANES];
+    std::fill(sx, sx+LANES, 0.0);
+    std::fill(sy, sy+LANES, 0.0);
+    std::fill(sz, sz+LANES, 0.0);
+
+    double far[LANES], farG[LANES], sigma[LANES];
+
+    for(int k0=iStart; k0<iEnd; k0+=LANES)
+    {
+        int nLanes = std::min(LANES, iEnd-k0);
+        farMask(C, k0, iEnd, 0.0, far);
+        if(CG)
+        {
+            farMask(*CG, k0, iEnd, 0.0, farG);
+            for(int l=0; l<LANES; l++) far[l] = far[l]*farG[l];
+        }
+
+        for(int l=0; l<LANES; l++) sigma[l] = far[l]>0.0 ? Sigma[k0+l] : 0.0;
+        for(int l=0; l<nLanes; l++)
+            if(far[l]<=0.0 && fabs(Sigma[k0+l])>0.0) nearpanels.push_back(k0+l);
+
+        double const *cx = m_cx.data()+k0, *cy = m_cy.data()+k0, *cz = m_cz.data()+k0;
+        double const *area = m_Area.data()+k0;
+        double const Cx=C.x, Cy=C.y, Cz=C.z;
+
+        for(int l=0; l<LANES; l++)
+        {
+            double PJKx = Cx - cx[l];
+            double PJKy = Cy - cy[l];
+            double PJKz = Cz - cz[l];
+            double pjk = sqrt(PJKx*PJKx + PJKy*PJKy + PJKz*PJKz);
+            double coef = area[l]/pjk/pjk/pjk * sigma[l];
+            sx[l] += far[l]>0.0 ? PJKx * coef : 0.0;
+            sy[l] += far[l]>0.0 ? PJKy * coef : 0.0;
+            sz[l] += far[l]>0.0 ? PJKz * coef : 0.0;
+        }
+
+        if(CG)
+        {
+            double const CGx=CG->x, CGy=CG->y, CGz=CG->z;
+            for(int l=0; l<LANES; l++)
+            {
+                double PJKx = CGx - cx[l];
+                double PJKy = CGy - cy[l];
+                double PJKz = CGz - cz[l];
+                double pjk = sqrt(PJKx*PJKx + PJKy*PJKy + PJKz*PJKz);
+                double coef = area[l]/pjk/pjk/pjk * sigma[l] * gcoef;
+                sx[l] += far[l]>0.0 ?  PJKx * coef : 0.0;
+                sy[l] += far[l]>0.0 ?  PJKy * coef : 0.0;
+                sz[l] += far[l]>0.0 ? -PJKz * coef : 0.0;
+            }
+        }
+    }
+
+    for(int l=0; l<LANES; l++)
+    {
+        V.x += sx[l];
+        V.y += sy[l];
+        V.z += sz[l];
+    }
+}
+
+
+/**
+ * Calculates the row of influence coefficients of the uniform unit doublet densities at point C,
+ * for the panels in the far field of C and of its symmetric point CG if not null.
+ * Same as the far field branches of Panel3::doubletBasisVelocity and Panel3::doubletBasisPotential
+ * summed over the three basis functions.
+ * @param bVelocity if true, the coefficients are the normal velocities, otherwise the potentials
+ * @param coef the array of size() coefficients, set only for the far field panels
+ * @param bFar the array of size() flags, set to 1 for the far field panels and to 0 for the others
+ */
+void P3KernelView::doubletUniRow(Vector3d const &C, Vector3d const *CG, double gcoef, Vector3d const &normal, bool bVelocity,
+                                 double *coef, char *bFar) const
+{
+    double far[LANES], farG[LANES], val[LANES];
+
+    for(int k0=0; k0<m_nPanels; k0+=LANES)
+    {
+        int nLanes = std::min(LANES, m_nPanels-k0);
+        farMask(C, k0, m_nPanels, 0.0, far);
+        if(CG)
+        {
+            farMask(*CG, k0, m_nPanels, 0.0, farG);
+            for(int l=0; l<LANES; l++) far[l] = far[l]*farG[l];
+        }
+
+        double const *cx = m_cx.data()+k0, *cy = m_cy.data()+k0, *cz = m_cz.data()+k0;
+        double const *lx = m_lx.data()+k0, *ly = m_ly.data()+k0, *lz = m_lz.data()+k0;
+        double const *mx = m_mx.data()+k0, *my = m_my.data()+k0, *mz = m_mz.data()+k0;
+        double const *nx = m_nx.data()+k0, *ny = m_ny.data()+k0, *nz = m_nz.data()+k0;
+        double const *area = m_Area.data()+k0;
+        double const *bxsum = m_bxSum.data()+k0, *bysum = m_bySum.data()+k0;
+
+        for(int ip=0; ip<(CG?2:1); ip++)
+        {
+            Vector3d const &P = ip==0 ? C : *CG;
+            double const Px=P.x, Py=P.y, Pz=P.z;
+            double sign = ip==0 ? 1.0 : gcoef;
+            if(bVelocity)
+            {
+                // the symmetric contribution is the z-opposite of the velocity at the symmetric point
+                double nz_P = ip==0 ? normal.z : -normal.z;
+                for(int l=0; l<LANES; l++)
+                {
+                    double dx = Px-cx[l],  dy = Py-cy[l],  dz = Pz-cz[l];
+                    double x = dx*lx[l] + dy*ly[l] + dz*lz[l];
+                    double y = dx*mx[l] + dy*my[l] + dz*mz[l];
+                    double z = dx*nx[l] + dy*ny[l] + dz*nz[l];
+                    double r = sqrt(x*x+y*y+z*z);
+                    double invr3 = 1.0/r/r/r;
+                    double invr5 = invr3/r/r;
+                    double Vlx = z*invr5*(3.0*x*area[l]-bxsum[l]);
+                    double Vly = z*invr5*(3.0*y*area[l]-bysum[l]);
+                    double Vlz = (-invr3+ 3.0*z*z*invr5) *area[l];
+                    // the projections of the receiving panel's normal on the source panel's frame
+                    double nl = normal.x*lx[l] + normal.y*ly[l] + nz_P*lz[l];
+                    double nm = normal.x*mx[l] + normal.y*my[l] + nz_P*mz[l];
+                    double nn = normal.x*nx[l] + normal.y*ny[l] + nz_P*nz[l];
+                    double v = (Vlx*nl + Vly*nm + Vlz*nn) * sign;
+                    val[l] = ip==0 ? v : val[l]+v;
+                }
+            }
+            else
+            {
+                for(int l=0; l<LANES; l++)
+                {
+                    double dx = Px-cx[l],  dy = Py-cy[l],  dz = Pz-cz[l];
+                    double z = dx*nx[l] + dy*ny[l] + dz*nz[l];
+                    double r = sqrt(dx*dx+dy*dy+dz*dz);
+                    // the doublet potential is zero in the panel's plane outside the panel
+                    double v = fabs(z)<INPLANEPRECISION ? 0.0 : -z/r/r/r*area[l] * sign;
+                    val[l] = ip==0 ? v : val[l]+v;
+                }
+            }
+        }
+
+        for(int l=0; l<nLanes; l++)
+        {
+            coef[k0+l] = far[l]>0.0 ? val[l] : 0.0;
+            bFar[k0+l] = far[l]>0.0 ? 1 : 0;
+        }
+    }
+}
+
+
+/**
+ * Calculates the integrals over the receiving panel of the far field velocities or potentials
+ * of the linear basis functions of the packet's panels, with the same quadrature as Panel3::scalarProductDoubletVelocity
+ * and Panel3::scalarProductDoubletPotential.
+ */
+void P3KernelView::linRowPacket(Receiver const &receiver, int k0, bool bVelocity, double sum[9][LANES]) const
+{
+    double const *cx = m_cx.data()+k0, *cy = m_cy.data()+k0, *cz = m_cz.data()+k0;
+    double const *lx = m_lx.data()+k0, *ly = m_ly.data()+k0, *lz = m_lz.data()+k0;
+    double const *mx = m_mx.data()+k0, *my = m_my.data()+k0, *mz = m_mz.data()+k0;
+    double const *nx = m_nx.data()+k0, *ny = m_ny.data()+k0, *nz = m_nz.data()+k0;
+    double const *area = m_Area.data()+k0;
+    double const *bx0 = m_bx[0].data()+k0, *bx1 = m_bx[1].data()+k0, *bx2 = m_bx[2].data()+k0;
+    double const *by0 = m_by[0].data()+k0, *by1 = m_by[1].data()+k0, *by2 = m_by[2].data()+k0;
+
+    double s[9][LANES]; // local arrays, cf. uniVelocityPacket
+    for(int j=0; j<9; j++) std::fill(s[j], s[j]+LANES, 0.0);
+
+    // projections of the receiving panel's normal on the source panels' frames
+    Vector3d const &N = receiver.m_Normal;
+    double nl[LANES], nm[LANES], nn[LANES];
+    for(int l=0; l<LANES; l++)
+    {
+        nl[l] = N.x*lx[l] + N.y*ly[l] + N.z*lz[l];
+        nm[l] = N.x*mx[l] + N.y*my[l] + N.z*mz[l];
+        nn[l] = N.x*nx[l] + N.y*ny[l] + N.z*nz[l];
+    }
+
+    for(int iq=0; iq<int(receiver.m_Pt.size()); iq++)
+    {
+        Vector3d const &P = receiver.m_Pt.at(iq);
+        double const Px=P.x, Py=P.y, Pz=P.z;
+        double const *bw = receiver.m_bw.data()+3*iq;
+
+        if(bVelocity)
+        {
+            for(int l=0; l<LANES; l++)
+            {
+                double dx = Px-cx[l],  dy = Py-cy[l],  dz = Pz-cz[l];
+                double x = dx*lx[l] + dy*ly[l] + dz*lz[l];
+                double y = dx*mx[l] + dy*my[l] + dz*mz[l];
+                double z = dx*nx[l] + dy*ny[l] + dz*nz[l];
+                double r = sqrt(x*x+y*y+z*z);
+                double invr3 = 1.0/r/r/r;
+                double invr5 = invr3/r/r;
+                double zn = (-invr3+ 3.0*z*z*invr5) *area[l]/3.0 * nn[l];
+                double v0 = z*invr5*((x*area[l]-bx0[l])*nl[l] + (y*area[l]-by0[l])*nm[l]) + zn;
+                double v1 = z*invr5*((x*area[l]-bx1[l])*nl[l] + (y*area[l]-by1[l])*nm[l]) + zn;
+                double v2 = z*invr5*((x*area[l]-bx2[l])*nl[l] + (y*area[l]-by2[l])*nm[l]) + zn;
+                for(int kb=0; kb<3; kb++)
+                {
+                    s[3*kb+0][l] += v0*bw[kb];
+                    s[3*kb+1][l] += v1*bw[kb];
+                    s[3*kb+2][l] += v2*bw[kb];
+                }
+            }
+        }
+        else
+        {
+            for(int l=0; l<LANES; l++)
+            {
+                double dx = Px-cx[l],  dy = Py-cy[l],  dz = Pz-cz[l];
+                double z = dx*nx[l] + dy*ny[l] + dz*nz[l];
+                double r = sqrt(dx*dx+dy*dy+dz*dz);
+                // the doublet potential is zero in the panel's plane outside the panel
+                double v = fabs(z)<INPLANEPRECISION ? 0.0 : -z/r/r/r*area[l]/3.0;
+                for(int kb=0; kb<3; kb++)
+                {
+                    s[3*kb+0][l] += v*bw[kb];
+                    s[3*kb+1][l] += v*bw[kb];
+                    s[3*kb+2][l] += v*bw[kb];
+                }
+            }
+        }
+    }
+
+    for(int j=0; j<9; j++) std::copy(s[j], s[j]+LANES, sum[j]);
+}
+
+
+/**
+ * Calculates the row of 3x3 influence blocks of the linear doublet basis functions on the receiving panel,
+ * for the panels which are in the far field of all the receiving panel's quadrature points.
+ * @param pMirror if not null, the view of the symmetric panels used to model the ground or free surface effect
+ * @param gcoef the sign of the symmetric panels' contribution
+ * @param coef the array of 9 x size() coefficients, the row-major blocks set only for the far field panels
+ * @param bFar the array of size() flags, set to 1 for the far field panels and to 0 for the others
+ */
+void P3KernelView::doubletLinRow(Receiver const &receiver, P3KernelView const *pMirror, double gcoef, bool bVelocity,
+                                 double *coef, char *bFar) const
+{
+    double far[LANES], farG[LANES];
+    double sum[9][LANES], sumG[9][LANES];
+
+    for(int k0=0; k0<m_nPanels; k0+=LANES)
+    {
+        int nLanes = std::min(LANES, m_nPanels-k0);
+        farMask(receiver.m_CoG, k0, m_nPanels, receiver.m_Radius, far);
+        linRowPacket(receiver, k0, bVelocity, sum);
+        if(pMirror)
+        {
+            pMirror->farMask(receiver.m_CoG, k0, m_nPanels, receiver.m_Radius, farG);
+            for(int l=0; l<LANES; l++) far[l] = far[l]*farG[l];
+            pMirror->linRowPacket(receiver, k0, bVelocity, sumG);
+            for(int j=0; j<9; j++)
+                for(int l=0; l<LANES; l++) sum[j][l] += sumG[j][l]*gcoef;
+        }
+
+        for(int l=0; l<nLanes; l++)
+        {
+            bFar[k0+l] = far[l]>0.0 ? 1 : 0;
+            for(int j=0; j<9; j++) coef[9*(k0+l)+j] = far[l]>0.0 ? sum[j][l] : 0.0;
+        }
+    }
+}
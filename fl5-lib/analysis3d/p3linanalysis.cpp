@@ -62,20 +62,31 @@ void P3LinAnalysis::makeMatrixBlock(int iBlock)
     int maxRows = nPanels();
     int iMax = std::min(iStart+blockSize, maxRows);
 
+    // the far field blocks of each row are evaluated in packets by the kernel view
+    bool bHPlane = m_pPolar3d->bGroundEffect() || m_pPolar3d->bFreeSurfaceEffect();
+    bool bKernelView = m_KernelView.size()==nPanels() && (!bHPlane || m_MirrorKernelView.size()==nPanels());
+    double gcoef = m_pPolar3d->bGroundEffect() ? 1.0 : -1.0;
+    P3KernelView::Receiver receiver;
+    std::vector<double> farcoef(bKernelView ? 9*nPanels() : 0);
+    std::vector<char> bFar(bKernelView ? nPanels() : 0);
+
     for(int i3=iStart; i3<iMax; i3++)
     {
-        Panel3 const &p3i = m_Panel3.at(i3);
+        if(bKernelView)
+        {
+            Panel3 const &p3i = m_Panel3.at(i3);
+            P3KernelView::makeReceiver(p3i, receiver);
+            m_KernelView.doubletLinRow(receiver, bHPlane ? &m_MirrorKernelView : nullptr, gcoef,
+                                       m_pPolar3d->bNeumann() || p3i.isMidPanel(), farcoef.data(), bFar.data());
+        }
 
         for(int k3=0; k3<nPanels(); k3++)
         {
-            Panel3 const &p3k = m_Panel3.at(k3);
-
-            if(m_pPolar3d->bNeumann() || p3i.isMidPanel())
-                p3i.scalarProductDoubletVelocity(p3k, sp);
-            else
-                p3i.scalarProductDoubletPotential(p3k, i3==k3, sp);
-
-            if(std::isnan(sp[0]) || std::isnan(sp[1]) || std::isnan(sp[2]))
+            if(bKernelView && bFar[k3])
+            {
+                memcpy(sp, farcoef.data()+9*k3, 9*sizeof(double));
+            }
+            else if(!influenceBlock(i3, k3, sp))
             {
                 QString strange;
                 strange = QString::asprintf("      *** numerical error when calculating the influence of panel %d on panel %d ***\n", k3, i3);
@@ -96,31 +107,6 @@ void P3LinAnalysis::makeMatrixBlock(int iBlock)
                         m_aijf[uint(row*N+col)] = float(sp[3*iBasis+kBasis]);// * p3i->orientationSign();
                 }
             }
-
-            if(m_pPolar3d->bGroundEffect() || m_pPolar3d->bFreeSurfaceEffect())
-            {
-                double coef = m_pPolar3d->bGroundEffect() ? 1.0 : -1.0;
-                // add the contribution of the symmetric panel below the water's surface
-                // This is done slightly differently than for the uniform methods:
-                // make the symmetric panel and reverse its orientation
-                Vector3d S[3];
-                for(int in=0; in<3; in++)  S[in].set(p3k.node(in).x, p3k.node(in).y, -p3k.node(in).z-2.0*m_pPolar3d->groundHeight());
-                Panel3 p3kG(S[0], S[2], S[1]);
-
-                if(m_pPolar3d->bNeumann() || p3i.isMidPanel()) p3i.scalarProductDoubletVelocity(p3kG, sp);
-                else                                           p3i.scalarProductDoubletPotential(p3kG, false, sp);
-
-                for(int iBasis=0; iBasis<3; iBasis++)
-                {
-                    int row = 3*i3 + iBasis;
-                    for(int kBasis=0; kBasis<3; kBasis++)
-                    {
-                        int col = 3*k3+kBasis;
-                        if(s_bDoublePrecision) m_aijd[uint(row*N+col)] += sp[3*iBasis+kBasis]*coef;
-                        else                   m_aijf[uint(row*N+col)] += float(sp[3*iBasis+kBasis]*coef);
-                    }
-                }
-            }
             if(isCancelled() || m_bMatrixError) break;
         }
         if(isCancelled() || m_bMatrixError) break;
@@ -128,6 +114,44 @@ void P3LinAnalysis::makeMatrixBlock(int iBlock)
 }
 
 
+/**
+ * Calculates the 3x3 block of scalar products of the basis functions of panel k3 with the basis functions
+ * of panel i3, including the contribution of the symmetric panel in the case of ground or free surface effect.
+ * @param coef the row-major 3x3 block of influence coefficients
+ * @return false in case of numerical error
+ */
+bool P3LinAnalysis::influenceBlock(int i3, int k3, double *coef) const
+{
+    double sp[]={0,0,0,0,0,0,0,0,0};
+    Panel3 const &p3i = m_Panel3.at(i3);
+    Panel3 const &p3k = m_Panel3.at(k3);
+
+    if(m_pPolar3d->bNeumann() || p3i.isMidPanel())
+        p3i.scalarProductDoubletVelocity(p3k, coef);
+    else
+        p3i.scalarProductDoubletPotential(p3k, i3==k3, coef);
+
+    if(std::isnan(coef[0]) || std::isnan(coef[1]) || std::isnan(coef[2])) return false;
+
+    if(m_pPolar3d->bGroundEffect() || m_pPolar3d->bFreeSurfaceEffect())
+    {
+        double gcoef = m_pPolar3d->bGroundEffect() ? 1.0 : -1.0;
+        // add the contribution of the symmetric panel below the water's surface
+        // This is done slightly differently than for the uniform methods:
+        // make the symmetric panel and reverse its orientation
+        Vector3d S[3];
+        for(int in=0; in<3; in++)  S[in].set(p3k.node(in).x, p3k.node(in).y, -p3k.node(in).z-2.0*m_pPolar3d->groundHeight());
+        Panel3 p3kG(S[0], S[2], S[1]);
+
+        if(m_pPolar3d->bNeumann() || p3i.isMidPanel()) p3i.scalarProductDoubletVelocity(p3kG, sp);
+        else                                           p3i.scalarProductDoubletPotential(p3kG, false, sp);
+
+        for(int i=0; i<9; i++) coef[i] += sp[i]*gcoef;
+    }
+    return true;
+}
+
+
 void P3LinAnalysis::makeWakeMatrixBlock(int iBlock)
 {
     int N = nPanels()*3;
@@ -184,22 +208,11 @@ void P3LinAnalysis::makeWakeMatrixBlock(int iBlock)
     //                    col0 = 3*k3;
                         col1 = 3*k3+1;
                         col2 = 3*k3+2;
-                        if(s_bDoublePrecision)
-                        {
-                            // add the wake's left contribution to basis function 1
-                            m_aijd[uint(row*N + col1)] += sign * LeftContrib[ib];
-
-                            // add the wake's right contribution to basis function 2
-                            m_aijd[uint(row*N + col2)] += sign * RightContrib[ib];
-                        }
-                        else
-                        {
-                            // add the wake's left contribution to basis function 1
-                            m_aijf[uint(row*N + col1)] += float(sign * LeftContrib[ib]);
-
-                            // add the wake's right contribution to basis function 2
-                            m_aijf[uint(row*N + col2)] += float(sign * RightContrib[ib]);
-                        }
+                        // add the wake's left contribution to basis function 1
+                        addWakeCoef(row, col1, N, sign * LeftContrib[ib]);
+
+                        // add the wake's right contribution to basis function 2
+                        addWakeCoef(row, col2, N, sign * RightContrib[ib]);
                     }
                 }
                 else if(p3k.isBotPanel())
@@ -212,22 +225,11 @@ void P3LinAnalysis::makeWakeMatrixBlock(int iBlock)
     //                    col0 = 3*k3;
                         col1 = 3*k3+1;
                         col2 = 3*k3+2;
-                        if(s_bDoublePrecision)
-                        {
-                            // add the wake's left contribution to basis function 1
-                            m_aijd[uint(row*N + col1)] += sign * LeftContrib[ib];
-
-                            // add the wake's right contribution to basis function 2
-                            m_aijd[uint(row*N + col2)] += sign * RightContrib[ib];
-                        }
-                        else
-                        {
-                            // add the wake's left contribution to basis function 1
-                            m_aijf[uint(row*N + col1)] += float(sign * LeftContrib[ib]);
-
-                            // add the wake's right contribution to basis function 2
-                            m_aijf[uint(row*N + col2)] += float(sign * RightContrib[ib]);
-                        }
+                        // add the wake's left contribution to basis function 1
+                        addWakeCoef(row, col1, N, sign * LeftContrib[ib]);
+
+                        // add the wake's right contribution to basis function 2
+                        addWakeCoef(row, col2, N, sign * RightContrib[ib]);
                     }
 
                     // add opposite wake contribution to opposite top TE panel's contribution
@@ -239,22 +241,11 @@ void P3LinAnalysis::makeWakeMatrixBlock(int iBlock)
     //                    col0 = 3*k3;
                         col1 = 3*k3t+1;
                         col2 = 3*k3t+2;
-                        if(s_bDoublePrecision)
-                        {
-                            // add the wake's left contribution to basis function 1
-                            m_aijd[uint(row*N + col1)] += sign * LeftContrib[ib];
-
-                            // add the wake's right contribution to basis function 2
-                            m_aijd[uint(row*N + col2)] += sign * RightContrib[ib];
-                        }
-                        else
-                        {
-                            // add the wake's left contribution to basis function 1
-                            m_aijf[uint(row*N + col1)] += float(sign * LeftContrib[ib]);
-
-                            // add the wake's right contribution to basis function 2
-                            m_aijf[uint(row*N + col2)] += float(sign * RightContrib[ib]);
-                        }
+                        // add the wake's left contribution to basis function 1
+                        addWakeCoef(row, col1, N, sign * LeftContrib[ib]);
+
+                        // add the wake's right contribution to basis function 2
+                        addWakeCoef(row, col2, N, sign * RightContrib[ib]);
                     }
                 }
             }
@@ -391,7 +382,7 @@ bool P3LinAnalysis::scalarProductWake(Panel3 const &panel0, int iWake, double *s
 
 void P3LinAnalysis::backSubUnitRHS(double *uRHS, double *vRHS, double*wRHS, double *pRHS, double *qRHS, double *rRHS)
 {
-    PanelAnalysis::backSubUnitRHS(uRHS, vRHS, wRHS, pRHS, qRHS, rRHS);
+    P3Analysis::backSubUnitRHS(uRHS, vRHS, wRHS, pRHS, qRHS, rRHS);
 
     int size = nPanels()*3 * sizeof(double);
 
@@ -737,7 +728,7 @@ void P3LinAnalysis::makeNodeDoubletSurfaceVelocity(int iNode, std::vector<double
  * UNLIKE IN UNIFORM METHODS, CALCULATIONS ARE MADE IN GLOBAL COORDINATES
  * VLOCAL IS IN GLOBAL COORDINATES
  */
-void P3LinAnalysis::computeOnBodyCp(const std::vector<Vector3d> &VInf, std::vector<Vector3d> const &VGLOBAL, std::vector<double>&Cp) const
+void P3LinAnalysis::computeOnBodyCp(const std::vector<Vector3d> &VInf, std::vector<Vector3d> const &VGLOBAL, double *Cp) const
 {
     double QInf(0), Speed2(0), CpSup(0), CpInf(0);
     Vector3d VPanel;
@@ -904,30 +895,7 @@ void P3LinAnalysis::makeSourceInfluenceMatrix()
     m_bijf.resize(ncols*nrows);
     memset(m_bijf.data(), 0, m_bijf.size()*sizeof(float));
 
-    if(s_bMultiThread)
-    {
-
-        std::vector<std::thread> threads;
-
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-//            futureSync.addFuture(QtConcurrent::run(&P3LinAnalysis::makeSourceMatrixBlock, this, iBlock));
-            threads.push_back(std::thread(&P3LinAnalysis::makeSourceMatrixBlock, this, iBlock));
-        }
-
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            threads[iBlock].join();
-        }
-        std::cout << "P3LinAnalysis::makeSourceInfluenceMatrix joined all " << m_nBlocks << " threads" <<std::endl;
-    }
-    else
-    {
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            makeWakeMatrixBlock(iBlock);
-        }
-    }
+    runBlocks([this](int iBlock) {makeSourceMatrixBlock(iBlock);});
 }
 
 
@@ -972,7 +940,7 @@ void P3LinAnalysis::makeSourceMatrixBlock(int iBlock)
 }
 
 
-void P3LinAnalysis::makeUnitDoubletStrengths(double alpha, double beta)
+void P3LinAnalysis::makeUnitDoubletStrengths(double alpha, double beta, double *Mu) const
 {
     int N = 3*nPanels();
     double cosa = cos(alpha*PI/180.0);
@@ -982,7 +950,7 @@ void P3LinAnalysis::makeUnitDoubletStrengths(double alpha, double beta)
 
     for(int p=0; p<N; p++)
     {
-        m_Mu[p] = cosa*cosb*m_uRHSVertex.at(p) + sinb*m_vRHSVertex.at(p) + sina*cosb* m_wRHSVertex.at(p);
+        Mu[p] = cosa*cosb*m_uRHSVertex.at(p) + sinb*m_vRHSVertex.at(p) + sina*cosb* m_wRHSVertex.at(p);
     }
 }
 
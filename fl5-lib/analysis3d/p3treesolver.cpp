@@ -0,0 +1,594 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#define _MATH_DEFINES_DEFINED
+
+#include <algorithm>
+#include <cstring>
+
+#include <QString>
+
+#include <p3treesolver.h>
+
+#include <constants.h>
+#include <matrix.h>
+#include <p3analysis.h>
+#include <panel3.h>
+#include <polar3d.h>
+#include <threadpool.h>
+
+
+double P3TreeSolver::s_Theta(0.5);
+int P3TreeSolver::s_LeafSize(32);
+double P3TreeSolver::s_Tolerance(1.e-6);
+int P3TreeSolver::s_MaxIter(300);
+int P3TreeSolver::s_Restart(50);
+
+
+P3TreeSolver::P3TreeSolver()
+{
+    m_pP3A = nullptr;
+    m_nBasis = 1;
+    m_nRows = 0;
+    m_nBlocks = 1;
+    m_bMultiThread = false;
+    m_bError = false;
+}
+
+
+void P3TreeSolver::clear()
+{
+    m_nRows = 0;
+    m_Node.clear();
+    m_Index.clear();
+    m_PanelSize.clear();
+    m_NearPanel.clear();
+    m_NearCoef.clear();
+    m_FarNode.clear();
+    m_WakeSlot.clear();
+    m_WakePanel.clear();
+    m_WakeCoef.clear();
+    m_Precond.clear();
+}
+
+
+/**
+ * Builds the octree, the interaction lists and the near-field influence blocks.
+ * @param pP3A a pointer to the analysis which owns the panels and which provides the exact influences
+ * @param nBasis the number of unknowns per panel
+ * @param nBlocks the number of row blocks for multithreading
+ * @return true if the solver could be built, false in case of numerical or memory allocation error
+ */
+bool P3TreeSolver::build(P3Analysis const *pP3A, int nBasis, int nBlocks, bool bMultiThread)
+{
+    clear();
+    m_pP3A = pP3A;
+    m_nBasis = nBasis;
+    m_nBlocks = std::max(1, nBlocks);
+    m_bMultiThread = bMultiThread;
+    m_bError = false;
+
+    std::vector<Panel3> const &panel3 = m_pP3A->m_Panel3;
+    int nPanels = int(panel3.size());
+    if(nPanels==0) return false;
+
+    m_Index.resize(nPanels);
+    m_PanelSize.resize(nPanels);
+    for(int i3=0; i3<nPanels; i3++)
+    {
+        Panel3 const &p3 = panel3.at(i3);
+        m_Index[i3] = i3;
+        m_PanelSize[i3] = 0.0;
+        for(int in=0; in<3; in++)
+            m_PanelSize[i3] = std::max(m_PanelSize[i3], p3.CoG().distanceTo(p3.node(in)));
+    }
+
+    makeNode(0, nPanels, 0);
+
+    // list the panels which receive the wake's contribution
+    m_WakeSlot.assign(nPanels, -1);
+    for(int k3=0; k3<nPanels; k3++)
+    {
+        Panel3 const &p3k = panel3.at(k3);
+        if(p3k.isTrailing() && (p3k.isBotPanel() || p3k.isMidPanel()))
+        {
+            if(m_WakeSlot[k3]<0)
+            {
+                m_WakeSlot[k3] = int(m_WakePanel.size());
+                m_WakePanel.push_back(k3);
+            }
+            int k3t = p3k.oppositeIndex();
+            if(p3k.isBotPanel() && k3t>=0 && k3t<nPanels && m_WakeSlot[k3t]<0)
+            {
+                m_WakeSlot[k3t] = int(m_WakePanel.size());
+                m_WakePanel.push_back(k3t);
+            }
+        }
+    }
+
+    m_nRows = nPanels*m_nBasis;
+
+    try
+    {
+        m_WakeCoef.assign(size_t(m_nRows)*m_WakePanel.size()*m_nBasis, 0.0);
+        m_NearPanel.resize(nPanels);
+        m_NearCoef.resize(nPanels);
+        m_FarNode.resize(nPanels);
+    }
+    catch(std::bad_alloc &exception)
+    {
+        QString strong(exception.what());
+        strong += ": error allocating memory for the tree solver\n";
+        m_pP3A->traceLog(strong);
+        clear();
+        return false;
+    }
+
+    ThreadPool::parallelFor(0, m_nBlocks, [this](int iBlock0, int iBlock1)
+                            {
+                                for(int iBlock=iBlock0; iBlock<iBlock1 && !m_bError; iBlock++) makeInteractionBlock(iBlock);
+                            },
+                            m_bMultiThread, 1);
+
+    if(m_bError || m_pP3A->isCancelled())
+    {
+        clear();
+        return false;
+    }
+
+    size_t nNear=0, nFar=0;
+    for(int i3=0; i3<nPanels; i3++)
+    {
+        nNear += m_NearPanel.at(i3).size();
+        nFar  += m_FarNode.at(i3).size();
+    }
+    QString strange = QString::asprintf("      Tree: %d nodes, %.1f near-field panels and %.1f far-field nodes per panel, %.1f Mb\n",
+                                        int(m_Node.size()), double(nNear)/double(nPanels), double(nFar)/double(nPanels), memorySize());
+    m_pP3A->traceLog(strange);
+
+    return true;
+}
+
+
+/**
+ * Recursively builds the octree node spanning the permutation array's range [iStart, iEnd[.
+ * @return the index of the new node
+ */
+int P3TreeSolver::makeNode(int iStart, int iEnd, int depth)
+{
+    std::vector<Panel3> const &panel3 = m_pP3A->m_Panel3;
+
+    TreeNode node;
+    node.m_iStart = iStart;
+    node.m_iEnd   = iEnd;
+
+    Vector3d bmin( 1.e10,  1.e10,  1.e10);
+    Vector3d bmax(-1.e10, -1.e10, -1.e10);
+    double area = 0.0;
+    Vector3d C;
+    for(int i=iStart; i<iEnd; i++)
+    {
+        Panel3 const &p3 = panel3.at(m_Index.at(i));
+        C += p3.CoG()*p3.area();
+        area += p3.area();
+        bmin.x = std::min(bmin.x, p3.CoG().x);   bmax.x = std::max(bmax.x, p3.CoG().x);
+        bmin.y = std::min(bmin.y, p3.CoG().y);   bmax.y = std::max(bmax.y, p3.CoG().y);
+        bmin.z = std::min(bmin.z, p3.CoG().z);   bmax.z = std::max(bmax.z, p3.CoG().z);
+    }
+    if(area>PRECISION) node.m_Center = C/area;
+    else               node.m_Center = (bmin+bmax)*0.5;
+
+    node.m_Radius = 0.0;
+    for(int i=iStart; i<iEnd; i++)
+    {
+        int i3 = m_Index.at(i);
+        node.m_Radius = std::max(node.m_Radius, node.m_Center.distanceTo(panel3.at(i3).CoG()) + m_PanelSize.at(i3));
+    }
+
+    int iNode = int(m_Node.size());
+    m_Node.push_back(node);
+
+    if(iEnd-iStart<=s_LeafSize || depth>=32) return iNode;
+
+    // sort the panels in octants around the center of the bounding box
+    Vector3d mid = (bmin+bmax)*0.5;
+    auto octant = [&](int i3)
+    {
+        Vector3d const &pt = panel3.at(i3).CoG();
+        return (pt.x>mid.x ? 1 : 0) + (pt.y>mid.y ? 2 : 0) + (pt.z>mid.z ? 4 : 0);
+    };
+    std::stable_sort(m_Index.begin()+iStart, m_Index.begin()+iEnd, [&](int a, int b){return octant(a)<octant(b);});
+
+    int first = iStart;
+    int nChildren = 0;
+    int child[8]{-1,-1,-1,-1,-1,-1,-1,-1};
+    int childStart[8]{0}, childEnd[8]{0};
+    while(first<iEnd)
+    {
+        int oct = octant(m_Index.at(first));
+        int last = first;
+        while(last<iEnd && octant(m_Index.at(last))==oct) last++;
+        childStart[nChildren] = first;
+        childEnd[nChildren]   = last;
+        nChildren++;
+        first = last;
+    }
+
+    // all the centroids are in the same octant, i.e. they are coincident
+    if(nChildren<=1) return iNode;
+
+    for(int ic=0; ic<nChildren; ic++)
+    {
+        // the node array may be reallocated, so do not keep a reference to the parent node
+        child[ic] = makeNode(childStart[ic], childEnd[ic], depth+1);
+    }
+    for(int ic=0; ic<nChildren; ic++) m_Node[iNode].m_iChild[ic] = child[ic];
+
+    return iNode;
+}
+
+
+/**
+ * Builds the interaction lists of the target panels in the given block,
+ * and calculates the exact influence of the near field panels.
+ */
+void P3TreeSolver::makeInteractionBlock(int iBlock)
+{
+    std::vector<Panel3> const &panel3 = m_pP3A->m_Panel3;
+    int nPanels = int(panel3.size());
+    int nb2 = m_nBasis*m_nBasis;
+
+    int blockSize = int(nPanels/m_nBlocks)+1; // add one to compensate for rounding errors
+    int iStart = iBlock*blockSize;
+    int iMax = std::min(iStart+blockSize, nPanels);
+
+    std::vector<int> stack;
+
+    for(int i3=iStart; i3<iMax; i3++)
+    {
+        Panel3 const &p3i = panel3.at(i3);
+        std::vector<int> &nearpanel = m_NearPanel[i3];
+        std::vector<int> &farnode   = m_FarNode[i3];
+
+        stack.clear();
+        stack.push_back(0);
+        while(stack.size())
+        {
+            int iNode = stack.back();
+            stack.pop_back();
+            TreeNode const &node = m_Node.at(iNode);
+
+            double dist = p3i.CoG().distanceTo(node.m_Center);
+            if(dist*s_Theta > node.m_Radius + m_PanelSize.at(i3))
+            {
+                farnode.push_back(iNode);
+            }
+            else if(node.isLeaf())
+            {
+                for(int i=node.m_iStart; i<node.m_iEnd; i++) nearpanel.push_back(m_Index.at(i));
+            }
+            else
+            {
+                for(int ic=0; ic<8 && node.m_iChild[ic]>=0; ic++) stack.push_back(node.m_iChild[ic]);
+            }
+        }
+        std::sort(nearpanel.begin(), nearpanel.end());
+
+        std::vector<double> &nearcoef = m_NearCoef[i3];
+        nearcoef.resize(nearpanel.size()*nb2);
+        for(uint j=0; j<nearpanel.size(); j++)
+        {
+            int k3 = nearpanel.at(j);
+            if(!m_pP3A->influenceBlock(i3, k3, nearcoef.data()+j*nb2))
+            {
+                QString strange;
+                strange = QString::asprintf("      *** numerical error when calculating the influence of panel %d on panel %d ***\n", k3, i3);
+                m_pP3A->traceLog(strange);
+                m_bError = true;
+                return;
+            }
+        }
+
+        if(m_bError || m_pP3A->isCancelled()) return;
+    }
+}
+
+
+/**
+ * Adds a wake coefficient to the matrix. Only the columns of the trailing edge panels can receive wake contributions.
+ * Each row is processed by a single thread, so that no synchronization is required.
+ */
+void P3TreeSolver::addWakeCoef(int row, int col, double value)
+{
+    int k3 = col/m_nBasis;
+    int slot = m_WakeSlot.at(k3);
+    if(slot<0) return;
+    size_t nWakeCols = m_WakePanel.size()*m_nBasis;
+    m_WakeCoef[size_t(row)*nWakeCols + slot*m_nBasis + col%m_nBasis] += value;
+}
+
+
+/**
+ * Builds the block-Jacobi preconditioner by inverting each panel's self-influence block,
+ * including the wake's contribution.
+ */
+bool P3TreeSolver::makePreconditioner()
+{
+    if(!isBuilt()) return false;
+
+    int nPanels = int(m_NearPanel.size());
+    int nb2 = m_nBasis*m_nBasis;
+    size_t nWakeCols = m_WakePanel.size()*m_nBasis;
+    m_Precond.assign(nPanels*nb2, 0.0);
+
+    int nSingular = 0;
+    for(int i3=0; i3<nPanels; i3++)
+    {
+        double *D = m_Precond.data()+i3*nb2;
+        std::vector<int> const &nearpanel = m_NearPanel.at(i3);
+        auto it = std::lower_bound(nearpanel.begin(), nearpanel.end(), i3);
+        if(it!=nearpanel.end() && *it==i3)
+        {
+            int j = int(it-nearpanel.begin());
+            memcpy(D, m_NearCoef.at(i3).data()+j*nb2, nb2*sizeof(double));
+        }
+
+        int slot = m_WakeSlot.at(i3);
+        if(slot>=0)
+        {
+            for(int ib=0; ib<m_nBasis; ib++)
+            {
+                size_t row = size_t(i3*m_nBasis+ib);
+                for(int kb=0; kb<m_nBasis; kb++)
+                    D[ib*m_nBasis+kb] += m_WakeCoef.at(row*nWakeCols + slot*m_nBasis+kb);
+            }
+        }
+
+        bool bInverted = false;
+        if(m_nBasis==3)
+        {
+            bInverted = matrix::invert33(D);
+        }
+        else if(fabs(D[0])>PRECISION)
+        {
+            D[0] = 1.0/D[0];
+            bInverted = true;
+        }
+
+        if(!bInverted)
+        {
+            matrix::setIdentityMatrix(D, m_nBasis);
+            nSingular++;
+        }
+    }
+
+    if(nSingular>0)
+    {
+        m_pP3A->traceLog(QString::asprintf("      %d singular diagonal blocks have been ignored in the preconditioner\n", nSingular));
+    }
+
+    return true;
+}
+
+
+void P3TreeSolver::preconditioner(double const *x, double *y) const
+{
+    int nPanels = int(m_NearPanel.size());
+    int nb2 = m_nBasis*m_nBasis;
+    for(int i3=0; i3<nPanels; i3++)
+    {
+        double const *D = m_Precond.data()+i3*nb2;
+        for(int ib=0; ib<m_nBasis; ib++)
+        {
+            double sum = 0.0;
+            for(int kb=0; kb<m_nBasis; kb++) sum += D[ib*m_nBasis+kb] * x[i3*m_nBasis+kb];
+            y[i3*m_nBasis+ib] = sum;
+        }
+    }
+}
+
+
+/**
+ * Performs the product y=A.x without building the matrix.
+ * The doublet moments are first aggregated in the tree's nodes, then the rows are evaluated independently.
+ */
+void P3TreeSolver::matVec(double const *x, double *y) const
+{
+    std::vector<Panel3> const &panel3 = m_pP3A->m_Panel3;
+
+    // upward pass; children are stored after their parent so process the nodes in reverse order
+    std::vector<Vector3d> moment(m_Node.size());
+    for(int iNode=int(m_Node.size())-1; iNode>=0; iNode--)
+    {
+        TreeNode const &node = m_Node.at(iNode);
+        if(node.isLeaf())
+        {
+            for(int i=node.m_iStart; i<node.m_iEnd; i++)
+            {
+                int k3 = m_Index.at(i);
+                Panel3 const &p3k = panel3.at(k3);
+                double mu = 0.0;
+                for(int kb=0; kb<m_nBasis; kb++) mu += x[k3*m_nBasis+kb];
+                if(m_nBasis==3) mu /= 3.0;   // the integral of each basis function is 1/3 of the area
+                moment[iNode] += p3k.normal() * (p3k.area()*mu);
+            }
+        }
+        else
+        {
+            for(int ic=0; ic<8 && node.m_iChild[ic]>=0; ic++) moment[iNode] += moment.at(node.m_iChild[ic]);
+        }
+    }
+
+    ThreadPool::parallelFor(0, m_nBlocks, [&](int iBlock0, int iBlock1)
+                            {
+                                for(int iBlock=iBlock0; iBlock<iBlock1; iBlock++) matVecBlock(iBlock, x, moment.data(), y);
+                            },
+                            m_bMultiThread, 1);
+}
+
+
+void P3TreeSolver::matVecBlock(int iBlock, double const *x, Vector3d const *moment, double *y) const
+{
+    std::vector<Panel3> const &panel3 = m_pP3A->m_Panel3;
+    Polar3d const *pPolar3d = m_pP3A->polar3d();
+    int nPanels = int(panel3.size());
+    int nb2 = m_nBasis*m_nBasis;
+    int nWakePanels = int(m_WakePanel.size());
+    size_t nWakeCols = m_WakePanel.size()*m_nBasis;
+
+    int blockSize = int(nPanels/m_nBlocks)+1;
+    int iStart = iBlock*blockSize;
+    int iMax = std::min(iStart+blockSize, nPanels);
+
+    for(int i3=iStart; i3<iMax; i3++)
+    {
+        Panel3 const &p3i = panel3.at(i3);
+        double *yi = y + i3*m_nBasis;
+        for(int ib=0; ib<m_nBasis; ib++) yi[ib] = 0.0;
+
+        // near field
+        std::vector<int> const &nearpanel = m_NearPanel.at(i3);
+        double const *coef = m_NearCoef.at(i3).data();
+        for(uint j=0; j<nearpanel.size(); j++)
+        {
+            double const *xk = x + nearpanel.at(j)*m_nBasis;
+            double const *c = coef + j*nb2;
+            for(int ib=0; ib<m_nBasis; ib++)
+                for(int kb=0; kb<m_nBasis; kb++)
+                    yi[ib] += c[ib*m_nBasis+kb] * xk[kb];
+        }
+
+        // far field
+        bool bVelocity = pPolar3d->bNeumann() || p3i.isMidPanel();
+        double f = farField(i3, bVelocity, moment);
+        if(m_nBasis==3)
+        {
+            // the scalar product with the basis functions of a uniform field is 1/3 of the target panel's area
+            for(int ib=0; ib<3; ib++) yi[ib] += f * p3i.area()/3.0;
+        }
+        else yi[0] += f;
+
+        // wake
+        for(int ib=0; ib<m_nBasis; ib++)
+        {
+            double const *w = m_WakeCoef.data() + size_t(i3*m_nBasis+ib)*nWakeCols;
+            for(int iw=0; iw<nWakePanels; iw++)
+            {
+                double const *xk = x + m_WakePanel.at(iw)*m_nBasis;
+                for(int kb=0; kb<m_nBasis; kb++) yi[ib] += w[iw*m_nBasis+kb] * xk[kb];
+            }
+        }
+    }
+}
+
+
+/**
+ * Returns the far field influence at the target panel's CoG of the nodes in its interaction list.
+ * Each node is represented by a point doublet with the node's aggregated moment.
+ * @param bVelocity if true, returns the normal velocity, otherwise returns the potential
+ */
+double P3TreeSolver::farField(int i3, bool bVelocity, Vector3d const *moment) const
+{
+    Panel3 const &p3i = m_pP3A->m_Panel3.at(i3);
+    Polar3d const *pPolar3d = m_pP3A->polar3d();
+    Vector3d const &C = p3i.CoG();
+    Vector3d const &N = p3i.normal();
+
+    bool bMirror = pPolar3d->bGroundEffect() || pPolar3d->bFreeSurfaceEffect();
+    double coef = pPolar3d->bGroundEffect() ? 1.0 : -1.0;
+    double h = pPolar3d->groundHeight();
+
+    auto dipole = [bVelocity, &N](Vector3d const &P, Vector3d const &M)
+    {
+        double r2 = P.dot(P);
+        double r  = sqrt(r2);
+        if(bVelocity) return (3.0*P.dot(M)*P.dot(N) - M.dot(N)*r2) / (r2*r2*r);
+        else          return -P.dot(M) / (r2*r);
+    };
+
+    double f = 0.0;
+    for(int iNode : m_FarNode.at(i3))
+    {
+        TreeNode const &node = m_Node.at(iNode);
+        Vector3d const &M = moment[iNode];
+        f += dipole(C-node.m_Center, M);
+
+        if(bMirror)
+        {
+            // the image of the node below the ground or the free surface
+            Vector3d CG(node.m_Center.x, node.m_Center.y, -node.m_Center.z-2.0*h);
+            Vector3d MG(M.x*coef, M.y*coef, -M.z*coef);
+            f += dipole(C-CG, MG);
+        }
+    }
+    return f;
+}
+
+
+/**
+ * Solves the linear system in place.
+ * @return true if GMRES has converged, false otherwise.
+ */
+bool P3TreeSolver::solve(double *RHS) const
+{
+    if(!isBuilt()) return false;
+
+    std::vector<double> b(RHS, RHS+m_nRows);
+    std::vector<double> x(m_nRows, 0.0);
+
+    // use the block-diagonal solution as the initial guess
+    preconditioner(b.data(), x.data());
+
+    matrix::linearOperator A = [this](double const *xin, double *yout) {matVec(xin, yout);};
+    matrix::linearOperator M = [this](double const *xin, double *yout) {preconditioner(xin, yout);};
+
+    int iter = 0;
+    double residual = 0.0;
+    bool bConverged = matrix::GMRES(m_nRows, A, M, b.data(), x.data(), s_Restart, s_MaxIter, s_Tolerance, iter, residual);
+
+    memcpy(RHS, x.data(), m_nRows*sizeof(double));
+
+    QString strange;
+    if(bConverged) strange = QString::asprintf("      GMRES converged in %d iterations, residual=%g\n", iter, residual);
+    else           strange = QString::asprintf("      *** GMRES not converged after %d iterations, residual=%g ***\n", iter, residual);
+    m_pP3A->traceLog(strange);
+
+    return bConverged;
+}
+
+
+/** @return the memory used by the solver's arrays, in Mb */
+double P3TreeSolver::memorySize() const
+{
+    double size = 0.0;
+    for(uint i=0; i<m_NearPanel.size(); i++)
+    {
+        size += double(m_NearPanel.at(i).size()) * sizeof(int);
+        size += double(m_NearCoef.at(i).size())  * sizeof(double);
+        size += double(m_FarNode.at(i).size())   * sizeof(int);
+    }
+    size += double(m_WakeCoef.size()) * sizeof(double);
+    size += double(m_Node.size())     * sizeof(TreeNode);
+    return size/1024.0/1024.0;
+}
@@ -63,69 +63,36 @@ void P3UniAnalysis::makeMatrixBlock(int iBlock)
     int maxRows = nPanels();
     int iMax = std::min(iStart+blocksize, maxRows);
 
-    Vector3d Vb[3];
-    double phiNasa(0);
-    Vector3d vel, velG;
+    // the far field coefficients of each row are evaluated in packets by the kernel view
+    Vector3d CG;
+    double gcoef = m_pPolar3d->bGroundEffect() ? 1.0 : -1.0;
+    bool bKernelView = m_KernelView.size()==N && (m_pPolar3d->bNeumann() || m_pPolar3d->bDirichlet());
+    std::vector<double> farcoef(bKernelView ? N : 0);
+    std::vector<char> bFar(bKernelView ? N : 0);
+
+    double coef(0);
     // for each panel
     for(int i3=iStart; i3<iMax; i3++)
     {
-        Panel3 const &p3i = m_Panel3.at(i3);
+        if(bKernelView)
+        {
+            Panel3 const &p3i = m_Panel3.at(i3);
+            CG.set(p3i.CoG().x, p3i.CoG().y, -p3i.CoG().z-2.0*m_pPolar3d->groundHeight());
+            m_KernelView.doubletUniRow(p3i.CoG(), m_pPolar3d->bHPlane() ? &CG : nullptr, gcoef, p3i.normal(),
+                                       m_pPolar3d->bNeumann() || p3i.isMidPanel(), farcoef.data(), bFar.data());
+        }
 
         for(int k3=0; k3<nPanels(); k3++)
         {
-            Panel3 const &p3k = m_Panel3.at(k3);
-
-            if(m_pPolar3d->bNeumann() || p3i.isMidPanel())
-            {
-                p3k.doubletBasisVelocity(p3i.CoG(), Vb);
-
-                vel = Vb[0]+Vb[1]+Vb[2];
-                if(s_bDoublePrecision) m_aijd[uint(i3*N+k3)] = vel.dot(p3i.normal()); // change sign to be consistent with VLM
-                else                   m_aijf[uint(i3*N+k3)] = float(vel.dot(p3i.normal()));
-
-                if(m_pPolar3d->bGroundEffect() || m_pPolar3d->bFreeSurfaceEffect())
-                {
-                    double coef = m_pPolar3d->bGroundEffect() ? 1.0 : -1.0;
-
-                    // add the contribution of the symmetric panel below the water's surface,
-                    // which is the opposite of the contribution of this panel to the symmetric point
-                    Vector3d  CG(p3i.CoG().x, p3i.CoG().y, -p3i.CoG().z-2.0*m_pPolar3d->groundHeight());
-                    p3k.doubletBasisVelocity(CG, Vb);
-                    velG = Vb[0]+Vb[1]+Vb[2];
-                    velG.z = -velG.z;
-                    if(s_bDoublePrecision) m_aijd[uint(i3*N+k3)] += velG.dot(p3i.normal()) * coef;
-                    else                   m_aijf[uint(i3*N+k3)] += float(velG.dot(p3i.normal()))  * coef;
-                }
-            }
-            else if(m_pPolar3d->bDirichlet())
-            {
-                // Dirichlet B.C.
-                double phib[]{0,0,0};
-                p3k.doubletBasisPotential(p3i.CoG(), i3==k3, phib, true);
-                phiNasa = phib[0]+phib[1]+phib[2];
-
-                if(s_bDoublePrecision) m_aijd[uint(i3*N+k3)] = phiNasa;
-                else                   m_aijf[uint(i3*N+k3)] = float(phiNasa);
-
-                if(m_pPolar3d->bGroundEffect() || m_pPolar3d->bFreeSurfaceEffect())
-                {
-                    double coef = m_pPolar3d->bGroundEffect() ? 1.0 : -1.0;
-
-                    // add the contribution of the symmetric panel below the water's surface,
-                    // which is the opposite of the contribution of this panel to the symmetric point
-                    Vector3d CG(p3i.CoG().x, p3i.CoG().y, -p3i.CoG().z-2.0*m_pPolar3d->groundHeight());
-
-                    p3k.doubletBasisPotential(CG, false, phib, true);
-                    phiNasa = phib[0]+phib[1]+phib[2];
+            bool bError = false;
+            if(bKernelView && bFar[k3]) coef = farcoef[k3];
+            else                        bError = !influenceBlock(i3, k3, &coef);
 
-                    if(s_bDoublePrecision) m_aijd[uint(i3*N+k3)] += phiNasa * coef;
-                    else                   m_aijf[uint(i3*N+k3)] += float(phiNasa) *coef;
-                }
-            }
+            if(s_bDoublePrecision) m_aijd[uint(i3*N+k3)] = coef;
+            else                   m_aijf[uint(i3*N+k3)] = float(coef);
 
-            bool bError = false;
-            if(s_bDoublePrecision)  bError = std::isnan(m_aijd[uint(i3*N+k3)]);
-            else                    bError = std::isnan(m_aijf[uint(i3*N+k3)]);
+            if(s_bDoublePrecision)  bError = bError || std::isnan(m_aijd[uint(i3*N+k3)]);
+            else                    bError = bError || std::isnan(m_aijf[uint(i3*N+k3)]);
             if(bError)
             {
                 QString strange;
@@ -142,6 +109,66 @@ void P3UniAnalysis::makeMatrixBlock(int iBlock)
 }
 
 
+/**
+ * Calculates the influence of the uniform doublet density on panel k3 at the CoG of panel i3,
+ * including the contribution of the symmetric panel in the case of ground or free surface effect.
+ * @param coef a pointer to the single influence coefficient
+ * @return false in case of numerical error
+ */
+bool P3UniAnalysis::influenceBlock(int i3, int k3, double *coef) const
+{
+    Vector3d Vb[3];
+    Vector3d vel, velG;
+
+    Panel3 const &p3i = m_Panel3.at(i3);
+    Panel3 const &p3k = m_Panel3.at(k3);
+
+    *coef = 0.0;
+
+    if(m_pPolar3d->bNeumann() || p3i.isMidPanel())
+    {
+        p3k.doubletBasisVelocity(p3i.CoG(), Vb);
+
+        vel = Vb[0]+Vb[1]+Vb[2];
+        *coef = vel.dot(p3i.normal()); // change sign to be consistent with VLM
+
+        if(m_pPolar3d->bGroundEffect() || m_pPolar3d->bFreeSurfaceEffect())
+        {
+            double gcoef = m_pPolar3d->bGroundEffect() ? 1.0 : -1.0;
+
+            // add the contribution of the symmetric panel below the water's surface,
+            // which is the opposite of the contribution of this panel to the symmetric point
+            Vector3d  CG(p3i.CoG().x, p3i.CoG().y, -p3i.CoG().z-2.0*m_pPolar3d->groundHeight());
+            p3k.doubletBasisVelocity(CG, Vb);
+            velG = Vb[0]+Vb[1]+Vb[2];
+            velG.z = -velG.z;
+            *coef += velG.dot(p3i.normal()) * gcoef;
+        }
+    }
+    else if(m_pPolar3d->bDirichlet())
+    {
+        // Dirichlet B.C.
+        double phib[]{0,0,0};
+        p3k.doubletBasisPotential(p3i.CoG(), i3==k3, phib, true);
+        *coef = phib[0]+phib[1]+phib[2];
+
+        if(m_pPolar3d->bGroundEffect() || m_pPolar3d->bFreeSurfaceEffect())
+        {
+            double gcoef = m_pPolar3d->bGroundEffect() ? 1.0 : -1.0;
+
+            // add the contribution of the symmetric panel below the water's surface,
+            // which is the opposite of the contribution of this panel to the symmetric point
+            Vector3d CG(p3i.CoG().x, p3i.CoG().y, -p3i.CoG().z-2.0*m_pPolar3d->groundHeight());
+
+            p3k.doubletBasisPotential(CG, false, phib, true);
+            *coef += (phib[0]+phib[1]+phib[2]) * gcoef;
+        }
+    }
+
+    return !std::isnan(*coef);
+}
+
+
 void P3UniAnalysis::makeWakeMatrixBlock(int iBlock)
 {
     int N = nPanels();
@@ -199,20 +226,17 @@ void P3UniAnalysis::makeWakeMatrixBlock(int iBlock)
                 if(p3k.isMidPanel())
                 {
                     // add contribution to bot panel
-                    if(s_bDoublePrecision) m_aijd[uint(i3*N+k3)] += MatWakeContrib;
-                    else                   m_aijf[uint(i3*N+k3)] += float(MatWakeContrib);
+                    addWakeCoef(i3, k3, N, MatWakeContrib);
                 }
                 else if(p3k.isBotPanel())
                 {
                     // add contribution to bot panel
-                    if(s_bDoublePrecision) m_aijd[uint(i3*N+k3)] += MatWakeContrib * (-1);
-                    else                   m_aijf[uint(i3*N+k3)] += float(MatWakeContrib) * (-1.0f);
+                    addWakeCoef(i3, k3, N, MatWakeContrib * (-1));
 
                     // add opposite contribution to opposite top TE panel's contribution
                     int k3t = p3k.oppositeIndex();
                     assert(k3t>=0 && k3t<nPanels());
-                    if(s_bDoublePrecision) m_aijd[uint(i3*N+k3t)] += MatWakeContrib;
-                    else                   m_aijf[uint(i3*N+k3t)] += float(MatWakeContrib);
+                    addWakeCoef(i3, k3t, N, MatWakeContrib);
                 }
             }
         }
@@ -546,7 +570,7 @@ void P3UniAnalysis::makeUnitRHSBlock(int iBlock)
 }
 
 
-void P3UniAnalysis::makeUnitDoubletStrengths(double alpha, double beta)
+void P3UniAnalysis::makeUnitDoubletStrengths(double alpha, double beta, double *Mu) const
 {
     //______________________________________________________________________________________
     //    reconstruct all results from cosine and sine unit vectors
@@ -559,9 +583,9 @@ void P3UniAnalysis::makeUnitDoubletStrengths(double alpha, double beta)
 
     for(int i3=0; i3<N; i3++)
     {
-        m_Mu[3*i3]   = cosa*cosb*m_uRHS.at(i3) + sinb*m_vRHS.at(i3) + sina*cosb*m_wRHS.at(i3);
-        m_Mu[3*i3+1] = cosa*cosb*m_uRHS.at(i3) + sinb*m_vRHS.at(i3) + sina*cosb*m_wRHS.at(i3);
-        m_Mu[3*i3+2] = cosa*cosb*m_uRHS.at(i3) + sinb*m_vRHS.at(i3) + sina*cosb*m_wRHS.at(i3);
+        Mu[3*i3]   = cosa*cosb*m_uRHS.at(i3) + sinb*m_vRHS.at(i3) + sina*cosb*m_wRHS.at(i3);
+        Mu[3*i3+1] = cosa*cosb*m_uRHS.at(i3) + sinb*m_vRHS.at(i3) + sina*cosb*m_wRHS.at(i3);
+        Mu[3*i3+2] = cosa*cosb*m_uRHS.at(i3) + sinb*m_vRHS.at(i3) + sina*cosb*m_wRHS.at(i3);
     }
 }
 
@@ -679,7 +703,7 @@ void P3UniAnalysis::checkThinSurfaceSolution()
  * the previous stage.
  */
 void P3UniAnalysis::computeOnBodyCp(std::vector<Vector3d> const &VInf,
-                                    std::vector<Vector3d> const &VLocal, std::vector<double>&Cp) const
+                                    std::vector<Vector3d> const &VLocal, double *Cp) const
 {
     double QInf(0), Speed2(0), CpSup(0), CpInf(0);
     Vector3d VStream, VPanel0, VPanel1, VPanel2;
@@ -28,7 +28,6 @@
 #include <QString>
 #include <QDebug>
 
-#include <thread>
 #include <iostream>
 
 
@@ -39,6 +38,7 @@
 #include <panel4.h>
 #include <polar3d.h>
 #include <stabderivatives.h>
+#include <threadpool.h>
 #include <vortex.h>
 
 
@@ -60,7 +60,16 @@ bool P4Analysis::initializeAnalysis(Polar3d const *pPolar3d, int nRHS)
 
     if(nRHS>0)
     {
-        if(!allocateMatrix(N)) return false;
+        if(s_MatrixSolver==xfl::BARNESHUT)
+            traceStdLog("      The tree solver is only available for the triangle methods, using the dense matrix\n\n");
+
+        if(!bDenseMatrix())
+        {
+            // the dense matrix is never built
+            m_aijd.clear();
+            m_aijf.clear();
+        }
+        else if(!allocateMatrix(N)) return false;
 
         memsize += allocateRHS4(nRHS);
     }
@@ -124,7 +133,9 @@ void P4Analysis::makeLocalVelocities(std::vector<double> const &uRHS, const std:
 }
 
 
-void P4Analysis::combineLocalVelocities(double alpha, double beta, std::vector<Vector3d> &VLocal) const
+void P4Analysis::combineLocalVelocities(double alpha, double beta,
+                                        std::vector<Vector3d> const &uVLocal, std::vector<Vector3d> const &vVLocal, std::vector<Vector3d> const &wVLocal,
+                                        std::vector<Vector3d> &VLocal) const
 {
     VLocal.resize(nPanels());
     double cosa = cos(alpha*PI/180.0);
@@ -133,9 +144,9 @@ void P4Analysis::combineLocalVelocities(double alpha, double beta, std::vector<V
     double sinb = sin(-beta*PI/180.0); //change of beta sign introduced in v7.24 to be consistent with AVL
     for(uint i=0; i<VLocal.size(); i++)
     {
-        VLocal[i].x = cosa*cosb* m_uVLocal.at(i).x + sinb*m_vVLocal.at(i).x + sina*cosb* m_wVLocal.at(i).x;
-        VLocal[i].y = cosa*cosb* m_uVLocal.at(i).y + sinb*m_vVLocal.at(i).y + sina*cosb* m_wVLocal.at(i).y;
-        VLocal[i].z = cosa*cosb* m_uVLocal.at(i).z + sinb*m_vVLocal.at(i).z + sina*cosb* m_wVLocal.at(i).z;
+        VLocal[i].x = cosa*cosb* uVLocal.at(i).x + sinb*vVLocal.at(i).x + sina*cosb* wVLocal.at(i).x;
+        VLocal[i].y = cosa*cosb* uVLocal.at(i).y + sinb*vVLocal.at(i).y + sina*cosb* wVLocal.at(i).y;
+        VLocal[i].z = cosa*cosb* uVLocal.at(i).z + sinb*vVLocal.at(i).z + sina*cosb* wVLocal.at(i).z;
     }
 }
 
@@ -205,27 +216,25 @@ void P4Analysis::makeInfluenceMatrix()
     s_DebugPts.clear();
     s_DebugVecs.clear();
 
-    if(s_bMultiThread)
+    if(s_MatrixSolver==xfl::HMATRIX)
     {
-        std::vector<std::thread> threads;
-
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
+        if(!makeHMatrix())
         {
-            threads.push_back(std::thread(&P4Analysis::makeMatrixBlock, this, iBlock));
+            if(!isCancelled()) m_bMatrixError = true;
         }
-
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
+    }
+    else if(s_MatrixSolver==xfl::OUTOFCORE)
+    {
+        if(!makeTiledMatrix())
         {
-            threads[iBlock].join();
+            if(!isCancelled()) m_bMatrixError = true;
         }
     }
     else
     {
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            if(m_bMatrixError) break; // no point to continue
-            makeMatrixBlock(iBlock);
-        }
+        if(!refillMovedPanels())
+            runBlocks([this](int iBlock) {if(!m_bMatrixError) makeMatrixBlock(iBlock);});
+        storeBodyMatrix();
     }
 
     if(m_bMatrixError)
@@ -238,11 +247,8 @@ void P4Analysis::makeInfluenceMatrix()
 void P4Analysis::makeMatrixBlock(int iBlock)
 {
     int N = nPanels();
-    Vector3d C, V;
+    double coef = 0.0;
 
-    double phi=0.0;
-
-    // for each panel
     int blocksize = int(double(nPanels())/double(m_nBlocks))+1; // add one to compensate for rounding errors
     int iStart = iBlock*blocksize;
     int maxRows = nPanels();
@@ -251,64 +257,112 @@ void P4Analysis::makeMatrixBlock(int iBlock)
     // for each panel
     for(int i4=iStart; i4<iMax; i4++)
     {
-        Panel4 const &p4i = m_Panel4.at(i4);
-        //for each Boundary Condition point
-
-        if(p4i.isMidPanel() && m_pPolar3d->isVLM())
-            C = p4i.m_CtrlPt;
-        else
-            C = p4i.m_CollPt;
-
         for(int k4=0; k4<nPanels(); k4++)
         {
-            Panel4 const &p4k = m_Panel4.at(k4);
-            //for each panel, get the unit doublet or vortex influence at the boundary condition pt
-            if(m_pPolar3d->bNeumann() || p4i.isMidPanel())
+            if(!influenceBlock(i4, k4, &coef))
             {
-                getDoubletVelocity(C, p4k, V, 0.000, true, true);
+                QString strange;
+                strange = QString::asprintf("      *** numerical error when calculating the influence of panel %d on panel %d ***\n", k4, i4);
+                traceLog(strange);
+                m_bMatrixError = true;
+                return;
+            }
 
-                if(std::isnan(V.x) || std::isnan(V.y) || std::isnan(V.z))
-                {
-                    QString strange;
-                    strange = QString::asprintf("      *** numerical error when calculating the influence of panel %d on panel %d ***\n", k4, i4);
-                    traceLog(strange);
-                    m_bMatrixError = true;
-                    return;
-                }
+            if(s_bDoublePrecision) m_aijd[uint(i4*N+k4)] = coef;
+            else                   m_aijf[uint(i4*N+k4)] = float(coef);
 
-                double d =  V.dot(p4i.normal());
+            if(isCancelled()) break;
+        }
+        if(isCancelled()) break;
+    }
+//    display_mat(m_aijf.data(), nPanels(), nPanels());
+}
 
-                if(s_bDoublePrecision) m_aijd[uint(i4*N+k4)] = d;
-                else                   m_aijf[uint(i4*N+k4)] = float(d);
+
+/**
+ * Calculates the unit doublet or vortex influence of panel k4 at the boundary condition point of panel i4.
+ * @param coef a pointer to the single influence coefficient
+ * @return false in case of numerical error
+ */
+bool P4Analysis::influenceBlock(int i4, int k4, double *coef) const
+{
+    Panel4 const &p4i = m_Panel4.at(i4);
+    Panel4 const &p4k = m_Panel4.at(k4);
+    Vector3d C, V;
+    double phi=0.0;
+
+    *coef = 0.0;
+
+    if(p4i.isMidPanel() && m_pPolar3d->isVLM())
+        C = p4i.m_CtrlPt;
+    else
+        C = p4i.m_CollPt;
+
+    if(m_pPolar3d->bNeumann() || p4i.isMidPanel())
+    {
+        getDoubletVelocity(C, p4k, V, 0.000, true, true);
+        if(std::isnan(V.x) || std::isnan(V.y) || std::isnan(V.z)) return false;
+        *coef = V.dot(p4i.normal());
 
 /*                if(!p4i.isMidPanel())
-                {
-                    // thick body with Neumann BC - should always be a T6 polar and a single Opp, no linear combinations
-                    m_uRHS[i4] -=  d*freeStreamPotential(p4k.CoG(), alpha, beta, 1.0);
-                }*/
-            }
-            else if(m_pPolar3d->bDirichlet())
-            {
-                getDoubletPotential(C, i4==k4, p4k, phi, 0.0, true, true);
+        {
+            // thick body with Neumann BC - should always be a T6 polar and a single Opp, no linear combinations
+            m_uRHS[i4] -=  d*freeStreamPotential(p4k.CoG(), alpha, beta, 1.0);
+        }*/
+    }
+    else if(m_pPolar3d->bDirichlet())
+    {
+        getDoubletPotential(C, i4==k4, p4k, phi, 0.0, true, true);
+        if(std::isnan(phi)) return false;
+        *coef = phi;
+    }
+    return true;
+}
 
-                if(std::isnan(phi))
-                {
-                    QString strange;
-                    strange = QString::asprintf("      *** numerical error when calculating the influence of panel %d on panel %d ***\n", k4, i4);
-                    traceLog(strange);
-                    m_bMatrixError = true;
-                    return;
-                }
 
-                if(s_bDoublePrecision)  m_aijd[uint(i4*N+k4)] = phi;
-                else                    m_aijf[uint(i4*N+k4)] = float(phi);
-            }
+double P4Analysis::panelRadius(int p) const
+{
+    Panel4 const &p4 = m_Panel4.at(p);
+    double r = p4.CoG().distanceTo(p4.LA());
+    r = std::max(r, p4.CoG().distanceTo(p4.LB()));
+    r = std::max(r, p4.CoG().distanceTo(p4.TA()));
+    r = std::max(r, p4.CoG().distanceTo(p4.TB()));
+    return r;
+}
 
-            if(isCancelled()) break;
+
+void P4Analysis::hashPanels(LUCache::Key &key) const
+{
+    key.add(Panel4::vortexFracPos());
+    key.add(Panel4::ctrlPtFracPos());
+    for(std::vector<Panel4> const *pPanels : {&m_Panel4, &m_WakePanel4})
+    {
+        key.add(int(pPanels->size()));
+        for(Panel4 const &p4 : *pPanels)
+        {
+            for(int in=0; in<4; in++)
+            {
+                Node const &nd = p4.vertex(in);
+                key.add(nd.x);
+                key.add(nd.y);
+                key.add(nd.z);
+            }
+            key.add(int(p4.surfacePosition()));
+            key.add(p4.isTrailing());
+            key.add(p4.iWake());
+            key.add(p4.iWakeColumn());
         }
-        if(isCancelled()) break;
     }
-//    display_mat(m_aijf.data(), nPanels(), nPanels());
+}
+
+
+void P4Analysis::panelVertices(std::vector<Vector3d> &vertices) const
+{
+    vertices.resize(4*m_Panel4.size());
+    for(uint i4=0; i4<m_Panel4.size(); i4++)
+    {
+        for(int in=0; in<4; in++) vertices[4*i4+in] = m_Panel4.at(i4).vertex(in);
+    }
 }
 
 
@@ -562,8 +616,7 @@ void P4Analysis::makeWakeMatrixBlock(int iBlock)
                     //we do not add the term Phi_inf_KWPUM - Phi_inf_KWPLM (eq. 44) since it is 0, thin edge
                 }
 
-                if(s_bDoublePrecision) m_aijd[uint(i4*Size+k4)] += MatWakeContrib;
-                else                   m_aijf[uint(i4*Size+k4)] += float(MatWakeContrib);
+                addWakeCoef(i4, k4, Size, MatWakeContrib);
             }
             if(isCancelled()) return;
         }
@@ -683,94 +736,53 @@ void P4Analysis::getSourceVelocity(Vector3d const &C, bool bSelf, Panel4 const &
 }
 
 
-void P4Analysis::getVelocityVector(Vector3d const &C,
-                                   double const *Mu, double const *Sigma, Vector3d &VT, double coreradius,
-                                   bool bWakeOnly, bool bMultiThread) const
-{
-    if(isCancelled()) return;
-    // only 5 parameters max are allowed in the sub call to the parallized process, so make the others global
-    tmp_coreradius = coreradius;
-    tmp_bWakeOnly = bWakeOnly;
-    tmp_Mu = Mu;
-    tmp_Sigma = Sigma;
-
-    std::vector<Vector3d> VBlock(m_nBlocks);
-
-    if(bMultiThread)
-    {
-        std::vector<std::thread> threads;
-
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-//            futureSync.addFuture(QtConcurrent::run(&P4Analysis::velocityVectorBlock, this, iBlock, C, &VBlock[iBlock]));
-            threads.push_back(std::thread(&P4Analysis::velocityVectorBlock, this, iBlock, C, &VBlock[iBlock]));
-        }
-
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            threads[iBlock].join();
-        }
-    }
-    else
-    {
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            velocityVectorBlock(iBlock, C, &VBlock[iBlock]);
-        }
-    }
-
-    VT.set(0.0,0.0,0.0); // total induced velocity
-    for(int ib=0; ib<m_nBlocks; ib++) VT += VBlock[ib];
-
-    if(m_pPolar3d->bVortonWake())
-    {
-        double vtncorelength = m_pPolar3d->vortonCoreSize()*m_pPolar3d->referenceChordLength();
-
-        Vector3d VVtn;
-        getVortonVelocity(C, vtncorelength, VVtn, bMultiThread);
-        VT += VVtn;
-    }
-}
-
-
-void P4Analysis::velocityVectorBlock(int iBlock, Vector3d const &C, Vector3d *VT) const
+/**
+ * Adds the velocity, and the potential if phi is not null, induced at point C by the panels in the range [iStart, iEnd[.
+ * The potential is not defined for VLM analyses.
+ */
+void P4Analysis::velocityVectorRange(Vector3d const &C, int iStart, int iEnd, double const *Mu, double const *Sigma,
+                                     double coreradius, bool bWakeOnly, Vector3d &VT, double *phi) const
 {
-    // for each panel
-    int blocksize = int(double(nPanels())/double(m_nBlocks))+1; // add one to compensate for rounding errors
-    int iStart = iBlock*blocksize;
-    int maxRows = nPanels();
-    int iMax = std::min(iStart+blocksize, maxRows);
-
-    Vector3d V, Vs, VV;
-    double sign = 0;
+    Vector3d V;
+    double phiP(0), sign(0);
 
-    for (int i4=iStart; i4<iMax; i4++)
+    for (int i4=iStart; i4<iEnd; i4++)
     {
         if(isCancelled()) return;
         Panel4 const &p4 = m_Panel4.at(i4);
 
         if(m_pPolar3d->isVLM())
         {
-            getDoubletVelocity(C, p4, V, tmp_coreradius, true, !tmp_bWakeOnly);
-            VT->x += V.x * tmp_Mu[i4];
-            VT->y += V.y * tmp_Mu[i4];
-            VT->z += V.z * tmp_Mu[i4];
+            getDoubletVelocity(C, p4, V, coreradius, true, !bWakeOnly);
+            VT.x += V.x * Mu[i4];
+            VT.y += V.y * Mu[i4];
+            VT.z += V.z * Mu[i4];
         }
         else
         {
-            if(!tmp_bWakeOnly)
+            if(!bWakeOnly)
             {
                 if(!p4.isMidPanel()) //otherwise Sigma[pp] =0.0, so contribution is zero also
                 {
                     getSourceVelocity(C, false, p4, V);
-                    VT->x += V.x * tmp_Sigma[i4];
-                    VT->y += V.y * tmp_Sigma[i4];
-                    VT->z += V.z * tmp_Sigma[i4];
+                    VT.x += V.x * Sigma[i4];
+                    VT.y += V.y * Sigma[i4];
+                    VT.z += V.z * Sigma[i4];
+                    if(phi)
+                    {
+                        getSourcePotential(C, p4, phiP);
+                        *phi += phiP * Sigma[i4];
+                    }
+                }
+                getDoubletVelocity(C, p4, V, coreradius, true, true);
+                VT.x += V.x * Mu[i4];
+                VT.y += V.y * Mu[i4];
+                VT.z += V.z * Mu[i4];
+                if(phi)
+                {
+                    getDoubletPotential(C, false, p4, phiP, 0.0, true, true);
+                    *phi += phiP * Mu[i4];
                 }
-                getDoubletVelocity(C, p4, V, tmp_coreradius, true, true);
-                VT->x += V.x * tmp_Mu[i4];
-                VT->y += V.y * tmp_Mu[i4];
-                VT->z += V.z * tmp_Mu[i4];
             }
 
             // Is the panel pp shedding a wake?
@@ -779,20 +791,23 @@ void P4Analysis::velocityVectorBlock(int iBlock, Vector3d const &C, Vector3d *VT
                 //If so, add the contribution of the wake column shedded by this panel
                 if(p4.isBotPanel()) sign=-1.0; else sign=1.0;
                 int iw4 = p4.iWake();
-//                int irow=0;
-                while(iw4>=0 /* && iw4<wakepanel4.size() */)
+                while(iw4>=0)
                 {
                     assert(iw4<nWakePanels());
                     Panel4 const &p4w = m_WakePanel4.at(iw4);
                     // do not use RFF approximation for wake panels
-                    getDoubletVelocity(C, p4w, V, tmp_coreradius, false, true);
+                    getDoubletVelocity(C, p4w, V, coreradius, false, true);
 
-                    VT->x += V.x * tmp_Mu[i4]*sign;
-                    VT->y += V.y * tmp_Mu[i4]*sign;
-                    VT->z += V.z * tmp_Mu[i4]*sign;
+                    VT.x += V.x * Mu[i4]*sign;
+                    VT.y += V.y * Mu[i4]*sign;
+                    VT.z += V.z * Mu[i4]*sign;
+                    if(phi)
+                    {
+                        getDoubletPotential(C, false, p4w, phiP, 0.0, false, true);
+                        *phi += phiP * Mu[i4]*sign;
+                    }
 
                     iw4 = p4w.m_iPD;
-//                    irow++;
                 }
             }
         }
@@ -999,22 +1014,70 @@ void P4Analysis::VLMGetVortexInfluence(Panel4 const &p4, Vector3d const &C, doub
 
 
 /**
-* Calculates the forces using a far-field method.
+ * Returns the perturbation velocities induced at the far-field point of each trailing strip,
+ * in the order in which the strips are visited in forcesFromDownwash().
+ * The panel method uses the line vortex model of the far wake, the VLM uses the wake vortices.
+ * The points are independent and are evaluated concurrently.
+ */
+void P4Analysis::trefftzDownwash(double const *Mu4, std::vector<Vector3d> &Wg) const
+{
+    Vector3d C;
+    std::vector<Vector3d> pts;
+
+    for(int i4=0; i4<nPanels(); i4++)
+    {
+        Panel4 const &p4 = m_Panel4.at(i4);
+
+        if(!m_pPolar3d->isVLM())
+        {
+            if(p4.isTrailing() && (p4.isBotPanel()||p4.isMidPanel()))
+            {
+                // modified in 7.01 beta09 to use vortex lines rather than wake panels
+                C = (p4.TA() + p4.TB())/2.0;
+                C.x = m_pPolar3d->TrefftzDistance()/2.0;
+                pts.push_back(C);
+            }
+        }
+        else if(p4.isTrailing())
+        {
+            // evaluate at half the ff distance, so that we get influence of upstream and downstream parts of the vortices
+            C = p4.m_CtrlPt;
+            C.x = m_pPolar3d->TrefftzDistance()/2.0;
+            pts.push_back(C);
+        }
+    }
+
+    Wg.resize(pts.size());
+    ThreadPool::parallelFor(0, int(pts.size()), [&](int m0, int m1)
+                            {
+                                for(int m=m0; m<m1; m++)
+                                {
+                                    if(m_pPolar3d->isVLM()) getVelocityVector(pts.at(m), Mu4, nullptr, Wg[m], Vortex::coreRadius(), true, false);
+                                    else                    getFarFieldVelocity(pts.at(m), m_Panel4, Mu4, Wg[m], Vortex::coreRadius());
+                                }
+                            },
+                            s_bMultiThread, 1);
+}
+
+
+/**
+* Calculates the forces using a far-field method, with the downwash precalculated by trefftzDownwash().
 * Calculates the moments by a near field method, i.e. direct summation on the panels.
 * @param Mu a pointer to the array of doublet strengths or vortex circulations
 * @param Sigma a pointer to the array of source strengths
 * @param VInf a reference to the array of the velocity vectors on the panels
+* @param WDownwash the array of far-field perturbation velocities of the trailing strips
 * @param Force the resulting force vector
 * @param Moment the resulting moment vector
 */
-void P4Analysis::forces(double const *Mu4, double const *Sigma4, double alpha, double beta, Vector3d const &CoG, bool ,
-                        std::vector<Vector3d> const &VInf, Vector3d &Force, Vector3d &Moment)
+void P4Analysis::forcesFromDownwash(double const *Mu4, double const *, double alpha, double beta, Vector3d const &CoG, bool ,
+                                    std::vector<Vector3d> const &VInf, std::vector<Vector3d> const &WDownwash, Vector3d &Force, Vector3d &Moment)
 {
     if(!m_pPolar3d) return;
 
     double Cp(0.0), viscousDrag(0.0);
     double QInf(0.0);
-    Vector3d  C, WindDirection, WindNormal, PanelLeverArm, Wg, vortex;
+    Vector3d  WindDirection, WindNormal, PanelLeverArm, Wg, vortex;
     Vector3d Velocity, viscousMoment, PanelForce;
 
     //   Define the wind axis
@@ -1027,7 +1090,7 @@ void P4Analysis::forces(double const *Mu4, double const *Sigma4, double alpha, d
     viscousDrag = 0.0;
     viscousMoment.set(0.0,0.0,0.0);
 
-//    int m=0;
+    int m=0;
     for(int i4=0; i4<nPanels(); i4++)
     {
         Panel4 &p4 = m_Panel4[i4];
@@ -1036,15 +1099,7 @@ void P4Analysis::forces(double const *Mu4, double const *Sigma4, double alpha, d
         {
             if(p4.isTrailing() && (p4.isBotPanel()||p4.isMidPanel()))
             {
-                // get the last quad of the wake column
-//                assert(p4.m_iWake>=0 && p4.m_iWake<m_WakePanel4.size());
-//                Panel4 const *p4W = m_WakePanel4.data() + p4.m_iWake;
-//                C = trailingWakePoint(p4W);
-                // modified in 7.01 beta09 to use vortex lines rather than wake panels
-                C = (p4.TA() + p4.TB())/2.0;
-                C.x = m_pPolar3d->TrefftzDistance()/2.0;
-//                getVelocityVector(C, m_Panel4, m_WakePanel4, Mu4, Sigma4, Wg, 0.00001, true);
-                getFarFieldVelocity(C, m_Panel4, Mu4, Wg, Vortex::coreRadius());
+                Wg = WDownwash.at(m);
                 Wg *=  4.0*PI;
                 Wg *= 1.0/2.0;
 
@@ -1073,7 +1128,7 @@ void P4Analysis::forces(double const *Mu4, double const *Sigma4, double alpha, d
 
                 Force += stripforce;
 
-//                m++;
+                m++;
             }
         }
         else if (m_pPolar3d->isVLM())
@@ -1083,25 +1138,17 @@ void P4Analysis::forces(double const *Mu4, double const *Sigma4, double alpha, d
                 assert(p4.isMidPanel());
                 int pp = i4;
 
+                // The trailing point sees both the upstream and downstream parts of the trailing vortices
+                // Hence it sees twice the downwash.
+                // So divide by 2 to account for this.
+                Wg = WDownwash.at(m) * (1.0/2.0);
+                Wg += VInf.at(i4);
+
                 do
                 {
                     Panel4 const &pp4 = m_Panel4.at(pp);
                     if(m_pPolar3d->isVLM1() || pp4.isTrailing())
                     {
-                        C = p4.m_CtrlPt;
-                        // evaluate at half the ff distance, so that we get influence of upstream and downstream parts of the vortices
-                        // then divide the influence by 2.0
-                        C.x = m_pPolar3d->TrefftzDistance()/2.0;
-
-                        getVelocityVector(C, Mu4, Sigma4, Wg, Vortex::coreRadius(), true, s_bMultiThread);
-
-                        // The trailing point sees both the upstream and downstream parts of the trailing vortices
-                        // Hence it sees twice the downwash.
-                        // So divide by 2 to account for this.
-                        Wg *= 1.0/2.0;
-
-                        Wg += VInf.at(i4);
-
                         //induced force
                         Vector3d vortex = p4.trailingVortex();
                         Vector3d dF = Wg * vortex;
@@ -1113,7 +1160,7 @@ void P4Analysis::forces(double const *Mu4, double const *Sigma4, double alpha, d
                     if(pp>=nPanels()) break; // safety break
                 }while(true);
 
-//                m++;
+                m++;
             }
         }
     }
@@ -1351,7 +1398,7 @@ void P4Analysis::getDoubletDerivative(int p, double const *Mu, double &Cp, Vecto
  * Drela § 5.7.
  * The induced drag is evaluated separately in the Trefftz plane or in the vorton wake
  * */
-void P4Analysis::inducedForce(int nPanels, double QInf, double alpha, double beta, int pos,
+void P4Analysis::inducedForce(int nPanels, double QInf, double alpha, double beta, int pos, double const *Mu,
                                Vector3d &ForceBodyAxes, SpanDistribs &SpanResFF) const
 {
     if(!m_pPolar3d) return;
@@ -1366,7 +1413,7 @@ void P4Analysis::inducedForce(int nPanels, double QInf, double alpha, double bet
 
     //dynamic pressure, kg/m³
     double qDyn = 0.5 * m_pPolar3d->density() * QInf * QInf;
-    double const *Mu4 = m_Mu.data();
+    double const *Mu4 = Mu;
 
     int m=0;
     for(int i4=0; i4<nPanels; i4++)
@@ -1456,7 +1503,7 @@ void P4Analysis::inducedForce(int nPanels, double QInf, double alpha, double bet
 /** Calculates the induced drag in the Trefftz plane
  * The Trefttz plane is half-way down the wake panels to avoid end-effects
  */
-void P4Analysis::trefftzDrag(int nPanels, double QInf, double alpha, double beta, int pos,
+void P4Analysis::trefftzDrag(int nPanels, double QInf, double alpha, double beta, int pos, double const *Mu, double const *Sigma,
                                Vector3d &FFForce, SpanDistribs &SpanResFF) const
 {
     double inducedAngle(0);
@@ -1470,8 +1517,8 @@ void P4Analysis::trefftzDrag(int nPanels, double QInf, double alpha, double beta
     //dynamic pressure, kg/m³
     double qDyn = 0.5 * m_pPolar3d->density() * QInf * QInf;
 
-    double const *Mu4    = m_Mu.data();
-    double const *Sigma4 = m_Sigma.data();
+    double const *Mu4    = Mu;
+    double const *Sigma4 = Sigma;
 
     int m=0;
     for(int i4=0; i4<nPanels; i4++)
@@ -1600,7 +1647,7 @@ void P4Analysis::trefftzDrag(int nPanels, double QInf, double alpha, double beta
 * @param nval the number of values in the sequence
 */
 void P4Analysis::computeOnBodyCp(const std::vector<Vector3d> &VInf,
-                                 std::vector<Vector3d> const &VLocal, std::vector<double>&Cp) const
+                                 std::vector<Vector3d> const &VLocal, double *Cp) const
 {
     double QInf(0), Speed2(0), CpSup(0), CpInf(0);
     Vector3d Vl, Vtot, Vtotsup, Vtotinf;
@@ -1645,7 +1692,7 @@ void P4Analysis::computeOnBodyCp(const std::vector<Vector3d> &VInf,
 }
 
 
-void P4Analysis::makeUnitDoubletStrengths(double alpha, double beta)
+void P4Analysis::makeUnitDoubletStrengths(double alpha, double beta, double *Mu) const
 {
     double cosa = cos(alpha*PI/180.0);
     double sina = sin(alpha*PI/180.0);
@@ -1654,7 +1701,7 @@ void P4Analysis::makeUnitDoubletStrengths(double alpha, double beta)
 
     for(int p=0; p<nPanels(); p++)
     {
-        m_Mu[p] = cosa*cosb*m_uRHS.at(p) + sinb*m_vRHS.at(p) + sina*cosb* m_wRHS.at(p);
+        Mu[p] = cosa*cosb*m_uRHS.at(p) + sinb*m_vRHS.at(p) + sina*cosb* m_wRHS.at(p);
     }
 }
 
@@ -1876,14 +1923,14 @@ int P4Analysis::nextTopTrailingPanelIndex(Panel4 const &p4) const
 }
 
 
-void P4Analysis::scaleResultsToSpeed(double ratio)
+void P4Analysis::scaleResultsToSpeed(double ratio, double *Mu, double *Sigma) const
 {
     //______________________________________________________________________________________
     // Scale RHS and Sigma i.a.w. speeds (so far we have unit doublet and source strengths)
     for(int i4=0; i4<nPanels(); i4++)
     {
-        m_Mu[i4]    *= ratio;
-        m_Sigma[i4] *= ratio;
+        Mu[i4]    *= ratio;
+        Sigma[i4] *= ratio;
     }
 }
 
@@ -1908,11 +1955,11 @@ bool P4Analysis::computeTrimmedConditions(double mass, Vector3d const &CoG, doub
     Vector3d WindNormal = objects::windNormal(alphaeq, beta);
     std::vector<Vector3d> tmpVField(nPanels(), VInf);
 
-    makeSourceStrengths(objects::windDirection(alphaeq, 0.0));
+    makeSourceStrengths(objects::windDirection(alphaeq, 0.0), m_Sigma.data());
     if (isCancelled()) return true;
 
     //reconstruct doublet strengths from unit cosine and sine vectors
-    makeUnitDoubletStrengths(alphaeq, 0.0);
+    makeUnitDoubletStrengths(alphaeq, 0.0, m_Mu.data());
     if(isCancelled()) return false;
 
     //______________________________________________________________________________________
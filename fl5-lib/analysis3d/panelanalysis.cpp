@@ -24,14 +24,19 @@
 
 #define _MATH_DEFINES_DEFINED
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
 #include <iostream>
-#include <thread>
+#include <limits>
+#include <new>
 #include <QString>
 
 
 #include <panelanalysis.h>
 
 #include <gaussquadrature.h>
+#include <matrix.h>
 #include <objects_global.h>
 #include <panel.h>
 #include <panel3.h>
@@ -56,6 +61,12 @@
 #endif*/
 
 bool PanelAnalysis::s_bDoublePrecision(true);
+bool PanelAnalysis::s_bMixedPrecision(false);
+int PanelAnalysis::s_MaxRefinements(10);
+xfl::enumMatrixSolver PanelAnalysis::s_MatrixSolver(xfl::DENSELU);
+double PanelAnalysis::s_IterTolerance(1.e-8);
+int PanelAnalysis::s_IterMaxIter(500);
+bool PanelAnalysis::s_bIncrementalMatrix(false);
 bool PanelAnalysis::s_bMultiThread(true);
 int PanelAnalysis::s_MaxThreads(1);
 
@@ -72,16 +83,15 @@ PanelAnalysis::PanelAnalysis()
     m_bSequence    = false;
     m_bWarning     = false;
 
-    m_nBlocks     = s_MaxThreads;
+    m_bBodyMatrix      = false;
+    m_bPendingVertices = false;
+
+    m_nBlocks     = 4*s_MaxThreads; // several blocks per thread, so that the thread pool can balance the load
 
     m_nStations = 0;
 
     m_pPolar3d = nullptr;
 
-    tmp_coreradius=0.0;
-    tmp_bWakeOnly=false;
-    tmp_Mu=nullptr;
-    tmp_Sigma=nullptr;
 
 }
 
@@ -145,6 +155,7 @@ void PanelAnalysis::traceLog(QString const &str) const
 void PanelAnalysis::traceStdLog(std::string const &str) const
 {
     m_ErrorLog.append(str);
+    if(m_LogFunction) m_LogFunction(str);
 }
 
 
@@ -152,30 +163,34 @@ bool PanelAnalysis::initializeAnalysis(Polar3d const *pPolar3d, int )
 {
     if(!pPolar3d) return false;
     m_pPolar3d = pPolar3d;
+    for(int i=0; i<7; i++) m_WarmStart[i].clear();
+    m_bBodyMatrix = m_bPendingVertices = false;
+    m_BodyAijd.clear();
+    m_BodyAijf.clear();
     return true;
 }
 
 
-void PanelAnalysis::makeSourceStrengths(Vector3d const &VInf)
+void PanelAnalysis::makeSourceStrengths(Vector3d const &VInf, double *Sigma) const
 {
     for (int i3=0; i3<nPanels(); i3++)
     {
         Panel const *panel = panelAt(i3);
         if(isCancelled()) return;
-        if(panel->isMidPanel()) m_Sigma[i3] =  0.0;
-        else                    m_Sigma[i3] = sourceStrength(panel->normal(), VInf);
+        if(panel->isMidPanel()) Sigma[i3] =  0.0;
+        else                    Sigma[i3] = sourceStrength(panel->normal(), VInf);
     }
 }
 
 
-void PanelAnalysis::makeSourceStrengths(std::vector<Vector3d> const &VInf)
+void PanelAnalysis::makeSourceStrengths(std::vector<Vector3d> const &VInf, double *Sigma) const
 {
     for (int i3=0; i3<nPanels(); i3++)
     {
         Panel const *panel = panelAt(i3);
         if(isCancelled()) return;
-        if(panel->isMidPanel()) m_Sigma[i3] =  0.0;
-        else                    m_Sigma[i3] = sourceStrength(panel->normal(), VInf.at(i3));
+        if(panel->isMidPanel()) Sigma[i3] =  0.0;
+        else                    Sigma[i3] = sourceStrength(panel->normal(), VInf.at(i3));
     }
 }
 
@@ -184,6 +199,8 @@ void PanelAnalysis::releasePanelArrays()
 {
     m_uRHS.clear();
     m_wRHS.clear();
+    m_HMatrix.clear();
+    m_TiledMatrix.clear();
 }
 
 
@@ -192,6 +209,31 @@ void PanelAnalysis::releasePanelArrays()
  */
 bool PanelAnalysis::LUfactorize()
 {
+    if(s_MatrixSolver==xfl::OUTOFCORE)
+    {
+        return m_TiledMatrix.factorize([this](std::string const &msg) {traceStdLog(msg);},
+                                       [this]() {return isCancelled();});
+    }
+    else if(s_MatrixSolver==xfl::HMATRIX)
+    {
+        if(!m_HMatrix.makePreconditioner())
+        {
+            traceStdLog("         Error making the preconditioner.... Aborting calculation...\n");
+            return false;
+        }
+        return true;
+    }
+    else if(bIterativeSolver())
+    {
+        // the matrix is kept as is for the matrix-vector products
+        if(!makeBlockPreconditioner())
+        {
+            traceStdLog("         Error making the preconditioner.... Aborting calculation...\n");
+            return false;
+        }
+        return true;
+    }
+
 #ifdef INTEL_MKL
     if(s_bMultiThread)
         MKL_Set_Num_Threads_Local(s_MaxThreads);
@@ -210,6 +252,9 @@ bool PanelAnalysis::LUfactorize()
     }
     else
     {
+        // in mixed precision mode, the wake coefficients have been kept aside for the residuals
+        if(bRefineSolution()) addRecordedWakeCoefs();
+
         //solve single precision
         sgetrf_(&n, &n, m_aijf.data(), &lda, m_ipiv.data(), &info);
     }
@@ -225,160 +270,123 @@ bool PanelAnalysis::LUfactorize()
 
 
 /**
-* Solves the linear system for the unit RHS, using LU decomposition
+* Solves the linear system for the unit RHS, using LU decomposition.
+* The non-null vectors are stacked and back-substituted in a single call.
 */
 void PanelAnalysis::backSubUnitRHS(double *uRHS, double *vRHS, double *wRHS, double *pRHS, double *qRHS, double *rRHS)
 {
-#ifdef INTEL_MKL
-    if(s_bMultiThread)
-        mkl_set_num_threads(s_MaxThreads);
-    else
-        mkl_set_num_threads(1);
-#endif
-    char trans = 'T';
-    lapack_int n = matSize();
-    lapack_int lda = matSize();
+    if(bIterativeSolver())
+    {
+        if(uRHS) iterativeSolve(uRHS, m_WarmStart[0]);
+        if(vRHS) iterativeSolve(vRHS, m_WarmStart[1]);
+        if(wRHS) iterativeSolve(wRHS, m_WarmStart[2]);
+        if(pRHS) iterativeSolve(pRHS, m_WarmStart[3]);
+        if(qRHS) iterativeSolve(qRHS, m_WarmStart[4]);
+        if(rRHS) iterativeSolve(rRHS, m_WarmStart[5]);
+        return;
+    }
 
-    //LU solve
-    lapack_int nrhs = 1;
-    lapack_int ldb = n;
-    lapack_int info = 0;
+    std::vector<double*> rhs;
+    for(double *pRHSk : {uRHS, vRHS, wRHS, pRHS, qRHS, rRHS})
+        if(pRHSk) rhs.push_back(pRHSk);
 
-    if(s_bDoublePrecision)
+    if(rhs.size()==1)
     {
-#ifdef OPENBLAS
-        if(uRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), uRHS, &ldb, &info, 1);
-        if(vRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), vRHS, &ldb, &info, 1);
-        if(wRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), wRHS, &ldb, &info, 1);
-        if(pRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), pRHS, &ldb, &info, 1);
-        if(qRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), qRHS, &ldb, &info, 1);
-        if(rRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), rRHS, &ldb, &info, 1);
-#elif defined INTEL_MKL
-        if(uRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), uRHS, &ldb, &info);
-        if(vRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), vRHS, &ldb, &info);
-        if(wRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), wRHS, &ldb, &info);
-        if(pRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), pRHS, &ldb, &info);
-        if(qRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), qRHS, &ldb, &info);
-        if(rRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), rRHS, &ldb, &info);
-#elif defined ACCELERATE
-        if(uRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), uRHS, &ldb, &info);
-        if(vRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), vRHS, &ldb, &info);
-        if(wRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), wRHS, &ldb, &info);
-        if(pRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), pRHS, &ldb, &info);
-        if(qRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), qRHS, &ldb, &info);
-        if(rRHS) dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), rRHS, &ldb, &info);
-#endif
-        if(info!=0)
-        {
-            traceStdLog("Error back-substituting\n");
-        }
+        backSubRHSBatch(rhs.front(), 1);
+        return;
     }
-    else
+
+    int n = matSize();
+    std::vector<double> block(rhs.size()*n);
+    for(uint k=0; k<rhs.size(); k++)
+        memcpy(block.data()+k*n, rhs.at(k), n*sizeof(double));
+
+    backSubRHSBatch(block.data(), int(rhs.size()));
+
+    for(uint k=0; k<rhs.size(); k++)
+        memcpy(rhs.at(k), block.data()+k*n, n*sizeof(double));
+}
+
+
+bool PanelAnalysis::backSubRHS(std::vector<double> &RHS)
+{
+    if(bIterativeSolver())
     {
-        //solve single precision
-        std::vector<float> srhs(n);
-        if(uRHS)
-        {
-            for(int i=0; i<n; i++) srhs[i] = float(uRHS[i]);
-#ifdef OPENBLAS
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info, 1);
-#elif defined INTEL_MKL
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
-#elif defined ACCELERATE
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
-#endif
-            for(int i=0; i<n; i++) uRHS[i] = double(srhs.at(i));
-        }
-        if(vRHS)
-        {
-            for(int i=0; i<n; i++) srhs[i] = float(vRHS[i]);
-#ifdef OPENBLAS
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info, 1);
-#elif defined INTEL_MKL
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
-#elif ACCELERATE
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
-#endif
-            for(int i=0; i<n; i++) vRHS[i] = double(srhs.at(i));
-        }
-        if(wRHS)
-        {
-            for(int i=0; i<n; i++) srhs[i] = float(wRHS[i]);
-#ifdef OPENBLAS
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info, 1);
-#elif defined INTEL_MKL
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
-#elif defined ACCELERATE
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
-#endif
-            for(int i=0; i<n; i++) wRHS[i] = double(srhs.at(i));
-        }
-        if(pRHS)
-        {
-            for(int i=0; i<n; i++) srhs[i] = float(pRHS[i]);
-#ifdef OPENBLAS
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info, 1);
-#elif defined INTEL_MKL
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
-#elif defined ACCELERATE
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
-#endif
-            for(int i=0; i<n; i++) pRHS[i] = double(srhs.at(i));
-        }
-        if(qRHS)
-        {
-            for(int i=0; i<n; i++) srhs[i] = float(qRHS[i]);
-#ifdef OPENBLAS
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info, 1);
-#elif defined INTEL_MKL
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
-#elif defined ACCELERATE
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
-#endif
-            for(int i=0; i<n; i++) qRHS[i] = double(srhs.at(i));
-        }
-        if(rRHS)
+        if(!iterativeSolve(RHS.data(), m_WarmStart[6]))
         {
-            for(int i=0; i<n; i++) srhs[i] = float(rRHS[i]);
-#ifdef OPENBLAS
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info, 1);
-#elif defined INTEL_MKL
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
-#elif defined ACCELERATE
-            sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), srhs.data(), &ldb, &info);
-#endif
-            for(int i=0; i<n; i++) rRHS[i] = double(srhs.at(i));
+            traceStdLog("      Error back-solving the RHS\n");
+            return false;
         }
+        return true;
     }
+
+    return backSubRHSBatch(RHS.data(), 1);
 }
 
 
-bool PanelAnalysis::backSubRHS(std::vector<double> &RHS)
+/**
+ * Solves the linear system for a batch of right hand sides in a single LAPACK call,
+ * so that the back-substitution uses level-3 BLAS.
+ * @param RHS the nRHS vectors of size matSize(), stored contiguously; overwritten with the solutions.
+ * @param nRHS the number of vectors
+ * @return false in case of error
+ */
+bool PanelAnalysis::backSubRHSBatch(double *RHS, int nRHS)
 {
-    int matsize = int(RHS.size());
+    if(nRHS<=0) return true;
 
-    char trans = 'T';
-    lapack_int lda=matsize, n=matsize, nrhs=1, ldb=n;
-    lapack_int info = 0;
-    if(s_bDoublePrecision)
+    int matsize = matSize();
+
+    if(s_MatrixSolver==xfl::OUTOFCORE)
     {
-#ifdef OPENBLAS
-        dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), RHS.data(), &ldb, &info, 1);
-#elif INTEL_MKL
-        dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), RHS.data(), &ldb, &info);
-#endif
+        if(!m_TiledMatrix.solve(RHS, nRHS))
+        {
+            traceStdLog("      Error back-solving the RHS\n");
+            return false;
+        }
+        return true;
+    }
+
+    if(bIterativeSolver())
+    {
+        // no warm start, the vectors are unrelated
+        std::vector<double> warmstart;
+        for(int k=0; k<nRHS; k++)
+        {
+            warmstart.clear();
+            if(!iterativeSolve(RHS+k*matsize, warmstart))
+            {
+                traceStdLog("      Error back-solving the RHS\n");
+                return false;
+            }
+        }
+        return true;
     }
+
+#ifdef INTEL_MKL
+    if(s_bMultiThread)
+        mkl_set_num_threads(s_MaxThreads);
     else
+        mkl_set_num_threads(1);
+#endif
+
+    if(!s_bDoublePrecision)
     {
-        std::vector<float> cf(matsize,0);
-        for(int i=0; i<n; i++)  cf[i] = float(RHS.at(i));
+        bool bSuccess = bRefineSolution() ? refineSolution(RHS, nRHS) : backSubSingle(RHS, nRHS);
+        if(!bSuccess) traceStdLog("      Error back-solving the RHS\n");
+        return bSuccess;
+    }
+
+    char trans = 'T';
+    lapack_int lda=matsize, n=matsize, nrhs=nRHS, ldb=n;
+    lapack_int info = 0;
 #ifdef OPENBLAS
-        sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), cf.data(), &n, &info, 1);
-#elif INTEL_MKL
-        sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), cf.data(), &n, &info);
+    dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), RHS, &ldb, &info, 1);
+#elif defined INTEL_MKL
+    dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), RHS, &ldb, &info);
+#elif defined ACCELERATE
+    dgetrs_(&trans, &n, &nrhs, m_aijd.data(), &lda, m_ipiv.data(), RHS, &ldb, &info);
 #endif
-        for(int i=0; i<n; i++) RHS[i] = double(cf.at(i));
-    }
     if(info!=0)
     {
         traceStdLog("      Error back-solving the RHS\n");
@@ -388,683 +396,1172 @@ bool PanelAnalysis::backSubRHS(std::vector<double> &RHS)
 }
 
 
-/** Combines the unit RHS or unit solution vector to make respectively a unit RHS or solution vector */
-void PanelAnalysis::combineUnitRHS(std::vector<double> &RHS, Vector3d const &VInf, Vector3d const &Omega)
+/** Back-substitutes the RHS vectors with the single precision LU factorization */
+bool PanelAnalysis::backSubSingle(double *RHS, int nRHS) const
 {
-    for(uint i=0; i<RHS.size(); i++)
-    {
-        RHS[i]  = VInf.x  * m_uRHS[i] + VInf.y *m_vRHS[i] + VInf.z *m_wRHS[i];
-        RHS[i] += Omega.x * m_pRHS[i] + Omega.y*m_qRHS[i] + Omega.z*m_rRHS[i];
-    }
+    int matsize = matSize();
+    char trans = 'T';
+    lapack_int lda=matsize, n=matsize, nrhs=nRHS, ldb=n;
+    lapack_int info = 0;
+
+    std::vector<float> cf(size_t(matsize)*size_t(nRHS));
+    for(uint i=0; i<cf.size(); i++) cf[i] = float(RHS[i]);
+#ifdef OPENBLAS
+    sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), cf.data(), &ldb, &info, 1);
+#elif defined INTEL_MKL
+    sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), cf.data(), &ldb, &info);
+#elif defined ACCELERATE
+    sgetrs_(&trans, &n, &nrhs, m_aijf.data(), &lda, m_ipiv.data(), cf.data(), &ldb, &info);
+#endif
+    for(uint i=0; i<cf.size(); i++) RHS[i] = double(cf.at(i));
+
+    return info==0;
 }
 
 
-void PanelAnalysis::makeUnitRHSVectors()
+/**
+ * Solves the linear system with the single precision LU factorization, and refines the solutions
+ * to double precision accuracy, as in LAPACK's dsgesv.
+ * The residuals r=b-A.x are evaluated in double precision with the influence coefficients
+ * recomputed on the fly, so that no double precision copy of the matrix is held in memory.
+ * The iterations stop when the residual is at the level of the double precision round-off errors,
+ * or when the refinement stagnates, which happens if the matrix is too ill-conditioned for single precision.
+ * @param RHS the nRHS vectors of size matSize(), stored contiguously; overwritten with the solutions.
+ * @param nRHS the number of vectors
+ * @return false in case of error
+ */
+bool PanelAnalysis::refineSolution(double *RHS, int nRHS) const
 {
-    if(s_bMultiThread)
+    int N = matSize();
+    size_t size = size_t(N)*size_t(nRHS);
+
+    std::vector<double> B(RHS, RHS+size);
+    std::vector<double> R(size), D;
+
+    if(!backSubSingle(RHS, nRHS)) return false;
+
+    double anorm = 0.0;
+    double ratio = 0.0, prevratio = 0.0;
+    double threshold = sqrt(double(N)) * std::numeric_limits<double>::epsilon();
+    bool bConverged = false;
+    int iter = 0;
+    for(iter=0; iter<=s_MaxRefinements; iter++)
     {
-        std::vector<std::thread> threads;
+        if(!streamedMatVec(RHS, nRHS, R.data(), iter==0 ? &anorm : nullptr)) return false;
 
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
+        // the convergence criterion is the largest of the scaled residuals of the RHS vectors
+        ratio = 0.0;
+        for(int k=0; k<nRHS; k++)
         {
-//            futureSync.addFuture(QtConcurrent::run(&PanelAnalysis::makeUnitRHSBlock, this, iBlock));
-            threads.push_back(std::thread(&PanelAnalysis::makeUnitRHSBlock, this, iBlock));
+            double rmax = 0.0, xmax = 0.0;
+            for(size_t i=size_t(k)*size_t(N); i<size_t(k+1)*size_t(N); i++)
+            {
+                R[i] = B.at(i) - R.at(i);
+                rmax = std::max(rmax, fabs(R.at(i)));
+                xmax = std::max(xmax, fabs(RHS[i]));
+            }
+            if(xmax*anorm>0.0) ratio = std::max(ratio, rmax/(xmax*anorm));
         }
 
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
+        if(ratio<=threshold)
         {
-            threads[iBlock].join();
+            bConverged = true;
+            break;
         }
-//        std::cout << "PanelAnalysis::makeUnitRHSVectors joined all " << m_nBlocks << " threads" <<std::endl;
-    }
-    else
-    {
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
+        if(iter>0 && ratio>prevratio)
         {
-            makeUnitRHSBlock(iBlock);
+            // the last correction has increased the residual, revert it
+            for(size_t i=0; i<size; i++) RHS[i] -= D.at(i);
+            ratio = prevratio;
+            break;
         }
+        if(iter>0 && ratio>0.5*prevratio) break; // stagnation
+        if(iter==s_MaxRefinements) break;
+
+        D = R;
+        if(!backSubSingle(D.data(), nRHS)) return false;
+        for(size_t i=0; i<size; i++) RHS[i] += D.at(i);
+        prevratio = ratio;
     }
+
+    QString strange = QString::asprintf("         mixed precision: %d refinement iterations, scaled residual=%g\n", iter, ratio);
+    if(!bConverged) strange += "         the refinement has not reached double precision accuracy\n";
+    traceLog(strange);
+
+    return true;
 }
 
 
-/** Case where the velocity field is not a solid body movement, e.g. in the case of
- * control polars, virtual twist and vorton wake */
-void PanelAnalysis::makeRHS(const std::vector<Vector3d> &VField, std::vector<double> &RHS, Vector3d const*normals)
+/**
+ * Performs the products AX=A.X in double precision without a stored matrix.
+ * The influence coefficients are recomputed for each row of panels, in the threads of the pool,
+ * and the wake coefficients are read from the array recorded during the assembly.
+ * @param X the nRHS vectors of size matSize(), stored contiguously
+ * @param AX the nRHS products
+ * @param anorm if not null, returns the infinity norm of the matrix
+ * @return false in case of numerical error or if the analysis has been cancelled
+ */
+bool PanelAnalysis::streamedMatVec(double const *X, int nRHS, double *AX, double *anorm) const
 {
-    if(s_bMultiThread)
-    {
-        std::vector<std::thread> threads;
+    int N = matSize();
+    int nPanel = nPanels();
+    if(nPanel<=0) return false;
+    int nBasis = N/nPanel;
+    int nb2 = nBasis*nBasis;
+    bool bWake = int(m_WakeCoef.size())==N;
 
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-//            futureSync.addFuture(QtConcurrent::run(&PanelAnalysis::makeRHSBlock, this, iBlock, RHS.data(), VField, normals));
-            threads.push_back(std::thread(&PanelAnalysis::makeRHSBlock, this, iBlock, RHS.data(), VField, normals));
-        }
+    std::atomic<bool> bError(false);
+    std::vector<double> rownorm(N, 0.0);
 
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
+    bool bDone = ThreadPool::parallelFor(0, nPanel, [&](int p0, int p1)
+    {
+        std::vector<double> coef(nb2);
+        std::vector<double> absrow(nBasis);
+        for(int i=p0; i<p1; i++)
         {
-            threads[iBlock].join();
+            for(int ib=0; ib<nBasis; ib++)
+            {
+                absrow[ib] = 0.0;
+                for(int k=0; k<nRHS; k++) AX[size_t(k)*size_t(N) + size_t(i*nBasis+ib)] = 0.0;
+            }
+
+            for(int j=0; j<nPanel; j++)
+            {
+                if(!influenceBlock(i, j, coef.data()))
+                {
+                    bError = true;
+                    return;
+                }
+                for(int ib=0; ib<nBasis; ib++)
+                {
+                    int row = i*nBasis+ib;
+                    for(int jb=0; jb<nBasis; jb++)
+                    {
+                        double a = coef.at(ib*nBasis+jb);
+                        absrow[ib] += fabs(a);
+                        int col = j*nBasis+jb;
+                        for(int k=0; k<nRHS; k++)
+                            AX[size_t(k)*size_t(N)+size_t(row)] += a * X[size_t(k)*size_t(N)+size_t(col)];
+                    }
+                }
+            }
+
+            for(int ib=0; ib<nBasis; ib++)
+            {
+                int row = i*nBasis+ib;
+                if(bWake)
+                {
+                    for(std::pair<int, double> const &wc : m_WakeCoef.at(row))
+                    {
+                        absrow[ib] += fabs(wc.second);
+                        for(int k=0; k<nRHS; k++)
+                            AX[size_t(k)*size_t(N)+size_t(row)] += wc.second * X[size_t(k)*size_t(N)+size_t(wc.first)];
+                    }
+                }
+                rownorm[row] = absrow.at(ib);
+            }
         }
-//        std::cout << "PanelAnalysis::makeRHS joined all " << m_nBlocks << " threads" <<std::endl;
+    }, s_bMultiThread, 0, [this]{return isCancelled();});
+
+    if(bError)
+    {
+        traceStdLog("      *** numerical error when calculating the residual of the linear system ***\n");
+        return false;
     }
-    else
+    if(!bDone) return false;
+
+    if(anorm) *anorm = *std::max_element(rownorm.begin(), rownorm.end());
+    return true;
+}
+
+
+/** Adds the wake coefficients recorded in double precision to the single precision matrix */
+void PanelAnalysis::addRecordedWakeCoefs()
+{
+    int N = matSize();
+    if(int(m_WakeCoef.size())!=N) return;
+    for(int row=0; row<N; row++)
     {
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            makeRHSBlock(iBlock, RHS.data(), VField, normals);
-        }
+        for(std::pair<int, double> const &wc : m_WakeCoef.at(row))
+            m_aijf[size_t(row)*size_t(N)+size_t(wc.first)] += float(wc.second);
     }
 }
 
 
 /**
- * Adds the contribution of the wake columns to the coefficients of the influence matrix
- * Method:
- *     - follow the method described in NASA 4023 eq. (44)
- *    - add the wake's doublet contribution to the matrix
- *    - add the difference in potential at the trailing edge panels to the RHS
- * Only a flat wake is considered. Wake roll-up has been tested but did not prove robust enough for implementation.
+ * Returns the indexes of the panels which share an edge with panel p.
+ * Default implementation based on the left, right, upstream and downstream links of the quad panels.
  */
-void PanelAnalysis::addWakeContribution()
+void PanelAnalysis::panelNeighbours(int p, std::vector<int> &neighbours) const
 {
-    makeWakeContribution();
+    neighbours.clear();
+    Panel const *pPanel = panelAt(p);
+    if(!pPanel) return;
+    int idx[] = {pPanel->iPL(), pPanel->iPR(), pPanel->iPU(), pPanel->iPD()};
+    for(int i=0; i<4; i++)
+    {
+        if(idx[i]>=0 && idx[i]<nPanels()) neighbours.push_back(idx[i]);
+    }
 }
 
 
-/**
-* In the case of a panel analysis, adds the contribution of the wake columns to the coefficients of the influence matrix
-* Method :
-*     - follow the method described in NASA 4023 eq. (44)
-*    - add the wake's doublet contribution to the matrix
-*    - add the potential difference at the trailing edge panels to the RHS ; the potential's origin
-*     is set arbitrarily to the geometrical orgin so that phi = V.dot(WindDirection) x point_position
-*/
-void PanelAnalysis::makeWakeContribution()
+/** Returns the radius of the sphere centered on the panel's CoG which encloses the panel */
+double PanelAnalysis::panelRadius(int p) const
 {
-    if(s_bMultiThread)
-    {
-        std::vector<std::thread> threads;
+    Panel const *pPanel = panelAt(p);
+    if(!pPanel) return 0.0;
+    return sqrt(pPanel->area());
+}
 
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-//            futureSync.addFuture(QtConcurrent::run(&PanelAnalysis::makeWakeMatrixBlock, this, iBlock));
-            threads.push_back(std::thread(&PanelAnalysis::makeWakeMatrixBlock, this, iBlock));
 
-        }
+/** Returns the indexes of the panels which receive the contribution of a wake column in the influence matrix */
+void PanelAnalysis::wakeColumnPanels(std::vector<int> &panels) const
+{
+    panels.clear();
+    for(int p=0; p<nPanels(); p++)
+    {
+        if(panelAt(p)->isTrailing()) panels.push_back(p);
+    }
+}
 
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
-        {
-            threads[iBlock].join();
-        }
-//        std::cout << "PanelAnalysis::makeWakeContribution joined all " << m_nBlocks << " threads" <<std::endl;
 
+/**
+ * Builds the hierarchical matrix in place of the dense influence matrix.
+ * @return false in case of error or if the analysis has been cancelled
+ */
+bool PanelAnalysis::makeHMatrix()
+{
+    int nPanel = nPanels();
+    if(nPanel<=0) return false;
+    int nBasis = matSize()/nPanel;
+
+    std::vector<Vector3d> pts(nPanel);
+    std::vector<double> radius(nPanel);
+    for(int p=0; p<nPanel; p++)
+    {
+        pts[p] = panelAt(p)->CoG();
+        radius[p] = panelRadius(p);
     }
-    else
+
+    std::vector<int> wakepanels;
+    if(!m_pPolar3d->isVLM()) wakeColumnPanels(wakepanels);
+
+    HMatrix::blockGenerator generator = [this](int i, int k, double *coef)
     {
-        for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
+        if(isCancelled()) return false;
+        if(!influenceBlock(i, k, coef))
         {
-            makeWakeMatrixBlock(iBlock);
+            QString strange;
+            strange = QString::asprintf("      *** numerical error when calculating the influence of panel %d on panel %d ***\n", k, i);
+            traceLog(strange);
+            return false;
         }
-    }
+        return true;
+    };
+
+    auto start = std::chrono::system_clock::now();
+
+    int nThreads = s_bMultiThread ? m_nBlocks : 1;
+    if(!m_HMatrix.build(pts, radius, nBasis, generator, wakepanels, nThreads)) return false;
+
+    auto end = std::chrono::system_clock::now();
+    int duration = int(std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count());
+
+    double densesize = double(matSize())*double(matSize())*(s_bDoublePrecision ? sizeof(double) : sizeof(float))/1024.0/1024.0;
+    QString strange = QString::asprintf("\n      H-matrix: %d low rank blocks with average rank %.1f, %d dense blocks\n",
+                                        m_HMatrix.nLowRankBlocks(), m_HMatrix.averageRank(), m_HMatrix.nDenseBlocks());
+    strange += QString::asprintf("      %.1f Mb instead of %.1f Mb for the dense matrix, built in %.3f s\n",
+                                 m_HMatrix.memorySize(), densesize, double(duration)/1000.0);
+    traceLog(strange);
+
+    return true;
 }
 
 
 /**
- * Make the velocity field induced by the Vorton Wake
+ * Builds the out-of-core matrix in place of the dense influence matrix.
+ * @return false in case of error or if the analysis has been cancelled
  */
-void PanelAnalysis::makeRHSVWVelocities(std::vector<Vector3d> &VPW, bool bVLM)
+bool PanelAnalysis::makeTiledMatrix()
 {
-    Vector3d C;
-    if(s_bMultiThread)
+    int nPanel = nPanels();
+    if(nPanel<=0) return false;
+    int nBasis = matSize()/nPanel;
+
+    TiledMatrix::blockGenerator generator = [this](int i, int k, double *coef)
     {
-        int nThreads=std::thread::hardware_concurrency();
+        if(!influenceBlock(i, k, coef))
+        {
+            QString strange;
+            strange = QString::asprintf("      *** numerical error when calculating the influence of panel %d on panel %d ***\n", k, i);
+            traceLog(strange);
+            return false;
+        }
+        return true;
+    };
+
+    return m_TiledMatrix.build(nPanel, nBasis, generator, s_bMultiThread,
+                               [this](std::string const &msg) {traceStdLog(msg);},
+                               [this]() {return isCancelled();});
+}
 
-        std::vector<std::thread> threads;
 
-        for(int iblock=0; iblock<nThreads; iblock++)
-        {
-            int ifirst = (nPanels()/nThreads) *  iblock;
-            int ilast  = (nPanels()/nThreads) * (iblock+1);
+/**
+ * Builds the block-Jacobi preconditioner of the iterative solvers.
+ * The panels are grouped with their unassigned neighbours, and the diagonal block
+ * of the influence matrix associated to each group is inverted.
+ * @return false if the matrix has not been built
+ */
+bool PanelAnalysis::makeBlockPreconditioner()
+{
+    int N = matSize();
+    int nPanel = nPanels();
+    if(N<=0 || nPanel<=0) return false;
+    if(s_bDoublePrecision && m_aijd.size()<size_t(N)*size_t(N)) return false;
+    if(!s_bDoublePrecision && m_aijf.size()<size_t(N)*size_t(N)) return false;
 
-            if(iblock==nThreads-1) ilast=nPanels();
+    int nBasis = N/nPanel; // 3 for the linear triangular method, 1 otherwise
 
-//            futureSync.addFuture(QtConcurrent::run(&PanelAnalysis::makeRHSVWVelocitiesBlock, this, ifirst, ilast, bVLM, VPW.data()));
-            threads.push_back(std::thread(&PanelAnalysis::makeRHSVWVelocitiesBlock, this, ifirst, ilast, bVLM, VPW.data()));
-        }
+    m_PrecondRows.clear();
+    m_PrecondInv.clear();
 
-        for(int iBlock=0; iBlock<nThreads; iBlock++)
+    std::vector<bool> bAssigned(nPanel, false);
+    std::vector<int> neighbours;
+    std::vector<int> group;
+    for(int p=0; p<nPanel; p++)
+    {
+        if(bAssigned[p]) continue;
+        group.clear();
+        group.push_back(p);
+        bAssigned[p] = true;
+        panelNeighbours(p, neighbours);
+        for(int pn : neighbours)
         {
-            threads[iBlock].join();
+            if(!bAssigned[pn])
+            {
+                group.push_back(pn);
+                bAssigned[pn] = true;
+            }
         }
-//        std::cout << "PanelAnalysis::makeRHSVWVelocities joined all " << m_nBlocks << " threads" <<std::endl;
 
+        std::vector<int> rows;
+        for(int pg : group)
+            for(int ib=0; ib<nBasis; ib++) rows.push_back(pg*nBasis+ib);
+        m_PrecondRows.push_back(rows);
     }
-    else
-    {
-        double vtncorelength = m_pPolar3d->vortonCoreSize()*m_pPolar3d->referenceChordLength();
 
-        for(int p=0; p<nPanels(); p++)
+    int nSingular = 0;
+    m_PrecondInv.resize(m_PrecondRows.size());
+    for(uint ig=0; ig<m_PrecondRows.size(); ig++)
+    {
+        std::vector<int> const &rows = m_PrecondRows.at(ig);
+        int nr = int(rows.size());
+        std::vector<double> &block = m_PrecondInv[ig];
+        block.resize(nr*nr);
+        for(int i=0; i<nr; i++)
+        {
+            for(int j=0; j<nr; j++)
+            {
+                size_t ij = size_t(rows.at(i))*size_t(N) + size_t(rows.at(j));
+                block[i*nr+j] = s_bDoublePrecision ? m_aijd.at(ij) : double(m_aijf.at(ij));
+            }
+        }
+        if(!matrix::invertMatrix(block, nr))
         {
-            Panel const *pPanel = panelAt(p);
-            C.set(pPanel->ctrlPt(bVLM));
-            getVortonVelocity(C, vtncorelength, VPW[p], false);
+            matrix::setIdentityMatrix(block.data(), nr);
+            nSingular++;
         }
     }
+
+    QString strange = QString::asprintf("         preconditioner made of %d diagonal blocks", int(m_PrecondRows.size()));
+    if(nSingular>0) strange += QString::asprintf(", %d singular blocks ignored", nSingular);
+    traceLog(strange + "\n");
+
+    return true;
 }
 
 
-void PanelAnalysis::makeRHSVWVelocitiesBlock(int iFirst, int iLast, bool bVLM, Vector3d *Vpanel)
+void PanelAnalysis::applyBlockPreconditioner(double const *x, double *y) const
 {
-    Vector3d C;
-    double vtncorelength = m_pPolar3d->vortonCoreSize()*m_pPolar3d->referenceChordLength();
-
-    for(int p=iFirst; p<iLast; p++)
+    for(uint ig=0; ig<m_PrecondRows.size(); ig++)
     {
-        Panel const *pPanel = panelAt(p);
-        C.set(pPanel->ctrlPt(bVLM));
-        getVortonVelocity(C, vtncorelength, *(Vpanel+p), false);
+        std::vector<int> const &rows = m_PrecondRows.at(ig);
+        std::vector<double> const &block = m_PrecondInv.at(ig);
+        int nr = int(rows.size());
+        for(int i=0; i<nr; i++)
+        {
+            double sum = 0.0;
+            for(int j=0; j<nr; j++) sum += block.at(i*nr+j) * x[rows.at(j)];
+            y[rows.at(i)] = sum;
+        }
     }
 }
 
 
-void PanelAnalysis::computeStabilityDerivatives(double alphaeq, double u0, Vector3d const &CoG, bool bFuseMi,
-                                                StabDerivatives &SD, Vector3d &Force0, Vector3d &Moment0)
+/** Performs the product y=A.x with the dense influence matrix */
+void PanelAnalysis::denseMatVec(double const *x, double *y) const
 {
-    SD.reset();
-    computeTranslationDerivatives(alphaeq, u0, CoG, bFuseMi, SD, Force0, Moment0);
-    computeAngularDerivatives(alphaeq, u0, CoG, bFuseMi, SD);
-}
-
-
-void PanelAnalysis::computeTranslationDerivatives(double alphaeq, double u0, Vector3d const &CoG, bool bFuseMi,
-                                                  StabDerivatives &SD, Vector3d &Force0, Vector3d &Moment0)
-{
-#ifdef INTEL_MKL
-    if(s_bMultiThread)
-        mkl_set_num_threads(s_MaxThreads);
+    int N = matSize();
+    int nThreads = s_bMultiThread ? s_MaxThreads : 1;
+    if(s_bDoublePrecision)
+    {
+        matrix::matVecMultLapack(m_aijd.data(), x, y, N, N, nThreads);
+    }
     else
-        mkl_set_num_threads(1);
-#endif
+    {
+        std::vector<float> xf(N), yf(N);
+        for(int i=0; i<N; i++) xf[i] = float(x[i]);
+        matrix::matVecMultLapack(m_aijf.data(), xf.data(), yf.data(), N, N, nThreads);
+        for(int i=0; i<N; i++) y[i] = double(yf.at(i));
+    }
+}
 
-    Vector3d Forcem, Momentm;
-    Vector3d Forcep, Momentp;
-    Vector3d V0, is, js, ks, WindDirection, WindNormal;
 
-    Vector3d Vim, Vjm, Vkm, Vip, Vjp, Vkp;
+/**
+ * Solves the linear system using GMRES or BiCGStab with the block-Jacobi preconditioner.
+ * @param RHS in input the right hand side, in output the solution
+ * @param warmstart the solution of the previous call used as the initial guess, updated on output
+ * @return true if the solver has converged
+ */
+bool PanelAnalysis::iterativeSolve(double *RHS, std::vector<double> &warmstart) const
+{
+    int N = matSize();
 
-    double beta(0.0);
-    int N = nPanels();
-    int rhssize = 0;
-    if(m_pPolar3d->isQuadMethod())
-        rhssize = nPanels();
+    matrix::linearOperator A, M;
+    if(s_MatrixSolver==xfl::HMATRIX)
+    {
+        A = [this](double const *x, double *y) {m_HMatrix.matVec(x, y);};
+        M = [this](double const *x, double *y) {m_HMatrix.preconditioner(x, y);};
+    }
     else
-        rhssize = m_pPolar3d->isTriUniformMethod() ? nPanels() : nPanels()*3;
-
-    std::vector<double> m_UmRHS(rhssize), m_VmRHS(rhssize), m_WmRHS(rhssize);
-    std::vector<double> m_UpRHS(rhssize), m_VpRHS(rhssize), m_WpRHS(rhssize);
-    std::vector<double> notanrhs(rhssize);
-
-    std::vector<double> Sigma(7*N, 0);
-    std::vector<std::vector<Vector3d>> VField(7);
-    for(uint i=0; i<VField.size(); i++)
     {
-        VField[i].resize(N); // uses the default constructor
+        A = [this](double const *x, double *y) {denseMatVec(x, y);};
+        M = [this](double const *x, double *y) {applyBlockPreconditioner(x, y);};
     }
 
-    double deltaspeed    = 0.001;         //  m/s   for forward difference estimation
+    std::vector<double> x(N);
+    if(int(warmstart.size())==N) x = warmstart;
+    else                         M(RHS, x.data());
 
-    // Define the stability axes
-    double cosa = cos(alphaeq*PI/180.0);
-    double sina = sin(alphaeq*PI/180.0);
-    WindDirection = objects::windDirection(alphaeq, 0.0);
-    WindNormal = objects::windNormal(alphaeq, 0.0);
+    int iter = 0;
+    double residual = 0.0;
+    bool bConverged = false;
+    QString strange;
+    if(s_MatrixSolver==xfl::BICGSTAB)
+    {
+        bConverged = matrix::BiCGStab(N, A, M, RHS, x.data(), s_IterMaxIter, s_IterTolerance, iter, residual);
+        strange = QString::asprintf("         BiCGStab: %d iterations, residual=%g\n", iter, residual);
+    }
+    else
+    {
+        bConverged = matrix::GMRES(N, A, M, RHS, x.data(), 50, s_IterMaxIter, s_IterTolerance, iter, residual);
+        strange = QString::asprintf("         GMRES: %d iterations, residual=%g\n", iter, residual);
+    }
+    traceLog(strange);
 
-    is.set(-cosa, 0.0, -sina);
-    js.set(  0.0, 1.0,   0.0);
-    ks.set( sina, 0.0, -cosa);
+    if(!bConverged)
+    {
+        traceStdLog("         The iterative solver has not converged\n");
+        warmstart.clear();
+        memcpy(RHS, x.data(), N*sizeof(double));
+        return false;
+    }
 
-    V0 = is * (-u0); //is the steady state velocity vector, if no sideslip
+    warmstart = x;
+    memcpy(RHS, x.data(), N*sizeof(double));
+    return true;
+}
 
-    //______________________________________________________________________________
-    // RHS for unit speed vectors
-    // The change in wind velocity is opposite to the change in plane velocity
-    Vim = V0 - is * deltaspeed; //a positive increase in axial speed is a positive increase in wind speed
-    Vjm = V0 - js * deltaspeed; //a plane movement to the right is a wind flow to the left, i.e. negative y
-    Vkm = V0 - ks * deltaspeed; //a plane movement downwards (Z_stability>0) is a positive increase of V in geometry axes
-    Vip = V0 + is * deltaspeed; //a positive increase in axial speed is a positive increase in wind speed
-    Vjp = V0 + js * deltaspeed; //a plane movement to the right is a wind flow to the left, i.e. negative y
-    Vkp = V0 + ks * deltaspeed; //a plane movement downwards (Z_stability>0) is a positive increase of V in geometry axes
 
-    for (int p=0; p<N; p++)
+/** Combines the unit RHS or unit solution vector to make respectively a unit RHS or solution vector */
+void PanelAnalysis::combineUnitRHS(std::vector<double> &RHS, Vector3d const &VInf, Vector3d const &Omega)
+{
+    for(uint i=0; i<RHS.size(); i++)
     {
-        Panel const *pPanel = panelAt(p);
+        RHS[i]  = VInf.x  * m_uRHS[i] + VInf.y *m_vRHS[i] + VInf.z *m_wRHS[i];
+        RHS[i] += Omega.x * m_pRHS[i] + Omega.y*m_qRHS[i] + Omega.z*m_rRHS[i];
+    }
+}
 
-        VField[0][p] = Vip;
-        VField[1][p] = Vjp;
-        VField[2][p] = Vkp;
 
-        VField[3][p] = Vim;
-        VField[4][p] = Vjm;
-        VField[5][p] = Vkm;
-        VField[6][p] = V0;
+/**
+ * Runs the block function for each of the m_nBlocks blocks of panels, in the threads of the pool if multithreaded.
+ * The blocks are smaller than a thread's share, so that the pool can balance the load.
+ */
+void PanelAnalysis::runBlocks(std::function<void(int)> const &blockfunc) const
+{
+    ThreadPool::parallelFor(0, m_nBlocks, [&blockfunc](int iBlock0, int iBlock1)
+                            {
+                                for(int iBlock=iBlock0; iBlock<iBlock1; iBlock++) blockfunc(iBlock);
+                            },
+                            s_bMultiThread, 1, [this]{return isCancelled();});
+}
 
-        if(!pPanel->isMidPanel())
-        {
-            Sigma[p]     = -1.0/4.0/PI * VField.at(0).at(p).dot(pPanel->normal());
-            Sigma[p+  N] = -1.0/4.0/PI * VField.at(1).at(p).dot(pPanel->normal());
-            Sigma[p+2*N] = -1.0/4.0/PI * VField.at(2).at(p).dot(pPanel->normal());
-            Sigma[p+3*N] = -1.0/4.0/PI * VField.at(3).at(p).dot(pPanel->normal());
-            Sigma[p+4*N] = -1.0/4.0/PI * VField.at(4).at(p).dot(pPanel->normal());
-            Sigma[p+5*N] = -1.0/4.0/PI * VField.at(5).at(p).dot(pPanel->normal());
-            Sigma[p+6*N] = -1.0/4.0/PI * VField.at(6).at(p).dot(pPanel->normal());
-        }
-    }
 
-    Vector3d Omega;
+void PanelAnalysis::makeUnitRHSVectors()
+{
+    runBlocks([this](int iBlock) {makeUnitRHSBlock(iBlock);});
+}
 
-    combineUnitRHS(m_UpRHS, Vip, Omega);
-    combineUnitRHS(m_VpRHS, Vjp, Omega);
-    combineUnitRHS(m_WpRHS, Vkp, Omega);
-    combineUnitRHS(m_UmRHS, Vim, Omega);
-    combineUnitRHS(m_VmRHS, Vjm, Omega);
-    combineUnitRHS(m_WmRHS, Vkm, Omega);
 
-    // cRHS used to calculate force0 and moment0 used later as the reference for control derivatives
-    combineUnitRHS(m_cRHS, V0, Omega);
+/** Case where the velocity field is not a solid body movement, e.g. in the case of
+ * control polars, virtual twist and vorton wake */
+void PanelAnalysis::makeRHS(const std::vector<Vector3d> &VField, std::vector<double> &RHS, Vector3d const*normals)
+{
+    runBlocks([&](int iBlock) {makeRHSBlock(iBlock, RHS.data(), VField, normals);});
+}
 
-    //________________________________________________
-    // reference force and moment
 
-    double alpha = alphaeq;
-    std::vector<Vector3d> VInf(nPanels(), objects::windDirection(alphaeq, 0.0) * u0);
+/**
+ * Adds the contribution of the wake columns to the coefficients of the influence matrix
+ * Method:
+ *     - follow the method described in NASA 4023 eq. (44)
+ *    - add the wake's doublet contribution to the matrix
+ *    - add the difference in potential at the trailing edge panels to the RHS
+ * Only a flat wake is considered. Wake roll-up has been tested but did not prove robust enough for implementation.
+ */
+void PanelAnalysis::addWakeContribution()
+{
+    // in mixed precision mode, the coefficients are recorded and added to the matrix before the factorization
+    if(bRefineSolution()) m_WakeCoef.assign(matSize(), {});
+    makeWakeContribution();
+}
 
-    // make node vertex array
-    // only needed for triuniform method to align with TriLinAnalysis
-    std::vector<double> uRHSVertex, pRHSVertex;
-    double *mup = nullptr, *mum=nullptr;
-    if(m_pPolar3d->isTriUniformMethod())
+
+/**
+ * Returns the key which identifies the factorized influence matrix in the LUCache.
+ * The key depends on the geometry of the panels and of the wake panels,
+ * on the analysis settings of the polar, including the length of the trailing vortices, and on the solver settings,
+ * but not on the inertia, the speed or the freestream direction.
+ */
+uint64_t PanelAnalysis::matrixKey() const
+{
+    LUCache::Key key;
+    key.add(int(s_MatrixSolver));
+    key.add(s_bDoublePrecision);
+    key.add(matSize());
+    key.add(Panel::RFF());
+    key.add(Vortex::coreRadius());
+    key.add(int(Vortex::vortexModel()));
+    if(m_pPolar3d)
     {
-        uRHSVertex.resize(3*N);
-        pRHSVertex.resize(3*N);
+        key.add(int(m_pPolar3d->analysisMethod()));
+        key.add(int(m_pPolar3d->boundaryCondition()));
+        key.add(m_pPolar3d->bGroundEffect());
+        key.add(m_pPolar3d->bFreeSurfaceEffect());
+        key.add(m_pPolar3d->groundHeight());
+        key.add(m_pPolar3d->bVortonWake());
+        key.add(m_pPolar3d->TrefftzDistance()); // the length of the trailing vortex legs of the VLM and thin panels
     }
+    hashPanels(key);
+    return key.value();
+}
+
+
+/**
+ * Copies the LU factorization of the influence matrix from the cache, if the key matches.
+ * Only applies to the dense LU solver.
+ * @return true if the factorization is ready for the back-substitutions, false if it must be built.
+ */
+bool PanelAnalysis::fetchFactorization(uint64_t key)
+{
+    if(s_MatrixSolver!=xfl::DENSELU) return false;
+    if(!LUCache::fetch(key, m_aijd, m_aijf, m_ipiv)) return false;
 
-    if(m_pPolar3d->isQuadMethod())
+    int N = matSize();
+    size_t size2 = size_t(N)*size_t(N);
+    bool bMatch = int(m_ipiv.size())==N && (s_bDoublePrecision ? m_aijd.size()==size2 : m_aijf.size()==size2);
+    if(!bMatch)
     {
-        mup = m_cRHS.data();
-        forces(mup, Sigma.data()+6*N, alpha, beta, CoG, bFuseMi, VField.at(6), Force0, Moment0);
+        // not expected since the size is part of the key; restore the arrays for the assembly
+        allocateMatrix(N);
+        return false;
     }
-    else if(m_pPolar3d->isTriangleMethod())
-    {
-//        displayArray(m_cRHS);
-        // Make the Cp coefficients necessary to calculate the moments
-        // Re-use the methods implemented for unit calculations,
-        // but this time for the delta+ and delta- solutions
-        makeLocalVelocities(m_cRHS, notanrhs, notanrhs, m_uVLocal, m_vVLocal, m_wVLocal, objects::windDirection(alphaeq, 0.0));
 
-        if(m_pPolar3d->isTriUniformMethod())
-        {
-            makeVertexDoubletDensities(m_cRHS, uRHSVertex);
-            mup = uRHSVertex.data();
-        }
-        else if(m_pPolar3d->isTriLinearMethod())
-        {
-            mup = m_cRHS.data();
-        }
+    // the wake coefficients are not cached, record them again for the residuals
+    m_WakeCoef.clear();
+    if(bRefineSolution() && m_pPolar3d && !m_pPolar3d->isVLM()) addWakeContribution();
 
-        computeOnBodyCp(VInf, m_uVLocal, m_Cp);
-        forces(mup, Sigma.data()+6*N, alpha, beta, CoG, bFuseMi, VField.at(6), Force0, Moment0);
-    }
+    return true;
+}
 
-    //________________________________________________
-    // 1st ORDER STABILITY DERIVATIVES
-    // x-derivatives________________________
 
-//    alpha = atan2(Vim.z, Vim.x) * 180.0/PI;// =alphaeq....
-    alpha = alphaeq;
+/** Stores a copy of the LU factorization in the cache; must be called after LUfactorize() */
+void PanelAnalysis::storeFactorization(uint64_t key) const
+{
+    if(s_MatrixSolver!=xfl::DENSELU) return;
+    LUCache::store(key, m_aijd, m_aijf, m_ipiv);
+}
 
-    if(m_pPolar3d->isTriUniformMethod())
+
+/**
+ * Records the geometry of the panels for the next fill of the influence matrix and lists the panels
+ * which have moved since the last fill, e.g. the flaps of a control polar or the sails of a boat polar.
+ * Must be called before the rotation of the whole mesh, with the angles of this rotation.
+ * The coefficients only depend on the relative positions of the panels, so that those of the panels
+ * which have not moved are reused whatever the rotation of the whole mesh, except in the case of
+ * the VLM and with ground and free surface effects.
+ * Only applies to the dense matrix solvers.
+ */
+void PanelAnalysis::markMovedPanels(Vector3d const &bodyangles)
+{
+    m_MovedPanels.clear();
+    m_bPendingVertices = false;
+    if(!s_bIncrementalMatrix || !bDenseMatrix() || nPanels()==0) return;
+
+    panelVertices(m_PendingVertices);
+    m_PendingAngles = bodyangles;
+    m_bPendingVertices = true;
+
+    if(!m_bBodyMatrix || m_BodyVertices.size()!=m_PendingVertices.size()) return;
+
+    int nv = int(m_PendingVertices.size())/nPanels();
+    for(int p=0; p<nPanels(); p++)
     {
-        uRHSVertex.resize(3*N);
-        pRHSVertex.resize(3*N);
+        for(int iv=0; iv<nv; iv++)
+        {
+            Vector3d const &V0 = m_BodyVertices.at(p*nv+iv);
+            Vector3d const &V1 = m_PendingVertices.at(p*nv+iv);
+            if(V0.x!=V1.x || V0.y!=V1.y || V0.z!=V1.z)
+            {
+                m_MovedPanels.push_back(p);
+                break;
+            }
+        }
     }
+}
 
-    if(m_pPolar3d->isQuadMethod())
+
+/**
+ * Rebuilds the influence matrix from the matrix of the last fill, refilling only the rows
+ * and the columns of the panels which have moved. The wake contribution is not included.
+ * @return true if the matrix has been updated, false if it must be filled entirely.
+ */
+bool PanelAnalysis::refillMovedPanels()
+{
+    if(!m_bPendingVertices || !m_bBodyMatrix || !m_pPolar3d) return false;
+    if(m_BodyVertices.size()!=m_PendingVertices.size()) return false;
+
+    int N = matSize();
+    size_t size2 = size_t(N)*size_t(N);
+    if(s_bDoublePrecision)
     {
-        mup = m_UpRHS.data();
-        forces(mup, Sigma.data()+0*N, alpha, beta, CoG, bFuseMi, VField.at(0), Forcep, Momentp);
-        mum = m_UmRHS.data();
-        forces(mum, Sigma.data()+3*N, alpha, beta, CoG, bFuseMi, VField.at(3), Forcem, Momentm);
+        if(m_BodyAijd.size()!=size2 || m_aijd.size()!=size2) return false;
     }
-    else if(m_pPolar3d->isTriangleMethod())
+    else
     {
-        // Make the Cp coefficients necessary to calculate the moments
-        // Re-use the methods implemented for unit calculations,
-        // but this time for the delta+ and delta- solutions
-        makeLocalVelocities(m_UpRHS, notanrhs, m_UmRHS, m_uVLocal, m_vVLocal, m_wVLocal, objects::windDirection(alphaeq, 0.0)); // two at a time
+        if(m_BodyAijf.size()!=size2 || m_aijf.size()!=size2) return false;
+    }
 
-        if(m_pPolar3d->isTriUniformMethod())
-        {
-            makeVertexDoubletDensities(m_UpRHS, uRHSVertex);
-            makeVertexDoubletDensities(m_UmRHS, pRHSVertex);
-            mup = uRHSVertex.data();
-            mum = pRHSVertex.data();
-        }
-        else if(m_pPolar3d->isTriLinearMethod())
+    // the image panels and the trailing legs of the VLM vortices do not rotate with the whole mesh,
+    // so that all the coefficients change with its rotation
+    bool bFixedAxes = m_pPolar3d->isVLM() || m_pPolar3d->bGroundEffect() || m_pPolar3d->bFreeSurfaceEffect();
+    if(!bFixedAxes && m_pPolar3d->isQuadMethod() && m_pPolar3d->bDirichlet())
+    {
+        // the potential of the thin surfaces' panels is that of their VLM vortices, cf. P4Analysis::getDoubletPotential()
+        for(int p=0; p<nPanels(); p++)
         {
-            mup = m_UpRHS.data();
-            mum = m_UmRHS.data();
+            if(panelAt(p)->isMidPanel())
+            {
+                bFixedAxes = true;
+                break;
+            }
         }
+    }
+    if(bFixedAxes)
+    {
+        if(m_PendingAngles.x!=m_BodyAngles.x || m_PendingAngles.y!=m_BodyAngles.y || m_PendingAngles.z!=m_BodyAngles.z)
+            return false;
+    }
 
-        computeOnBodyCp(VField.at(0), m_uVLocal, m_Cp);
-        forces(mup, Sigma.data()+0*N, alpha, beta, CoG, bFuseMi, VField.at(0), Forcep, Momentp);
+    // the refill evaluates the influence coefficients of two rows per moved panel
+    int nMoved = int(m_MovedPanels.size());
+    if(2*nMoved>=nPanels()) return false;
 
-        computeOnBodyCp(VField.at(3), m_wVLocal, m_Cp);
-        forces(mum, Sigma.data()+3*N, alpha, beta, CoG, bFuseMi, VField.at(3), Forcem, Momentm);
-    }
+    traceStdLog(QString::asprintf(" refilling %d moved panels...", nMoved).toStdString());
 
-    SD.Xu = (Forcem - Forcep ).dot(is) /deltaspeed/2.0;
-    SD.Zu = (Forcem - Forcep ).dot(ks) /deltaspeed/2.0;
-    SD.Mu = (Momentm- Momentp).dot(js) /deltaspeed/2.0;
+    if(s_bDoublePrecision) std::copy(m_BodyAijd.begin(), m_BodyAijd.end(), m_aijd.begin());
+    else                   std::copy(m_BodyAijf.begin(), m_BodyAijf.end(), m_aijf.begin());
 
+    int nBasis = N/nPanels(); // 3 in the case of the linear triangular method, 1 otherwise
+    std::vector<char> bMoved(nPanels(), 0);
+    for(int p : m_MovedPanels) bMoved[p] = 1;
 
-    // y-derivatives________________________
-//    alpha = atan2(Vjm.z, Vjm.x)*180.0/PI;// =alphaeq....
-    alpha = alphaeq;
-    if(m_pPolar3d->isQuadMethod())
-    {
-        mup = m_VpRHS.data();
-        forces(mup, Sigma.data()+1*N, alpha, beta, CoG, bFuseMi, VField.at(1), Forcep, Momentp);
-        mum = m_VmRHS.data();
-        forces(mum, Sigma.data()+4*N, alpha, beta, CoG, bFuseMi, VField.at(4), Forcem, Momentm);
-    }
-    else if(m_pPolar3d->isTriangleMethod())
+    auto refillBlock = [this, N, nBasis](int i, int k)
     {
-        makeLocalVelocities(m_VpRHS, notanrhs, m_VmRHS, m_uVLocal, m_vVLocal, m_wVLocal, objects::windDirection(alphaeq, 0.0));
-
-        if(m_pPolar3d->isTriUniformMethod())
+        double coef[9]{};
+        if(!influenceBlock(i, k, coef))
         {
-            makeVertexDoubletDensities(m_VpRHS, uRHSVertex);
-            makeVertexDoubletDensities(m_VmRHS, pRHSVertex);
-            mup = uRHSVertex.data();
-            mum = pRHSVertex.data();
+            traceLog(QString::asprintf("      *** numerical error when calculating the influence of panel %d on panel %d ***\n", k, i));
+            m_bMatrixError = true;
+            return false;
         }
-        else if(m_pPolar3d->isTriLinearMethod())
+        for(int ib=0; ib<nBasis; ib++)
         {
-            mup = m_VpRHS.data();
-            mum = m_VmRHS.data();
+            int row = nBasis*i + ib;
+            for(int kb=0; kb<nBasis; kb++)
+            {
+                int col = nBasis*k + kb;
+                if(s_bDoublePrecision) m_aijd[size_t(row)*N+col] = coef[nBasis*ib+kb];
+                else                   m_aijf[size_t(row)*N+col] = float(coef[nBasis*ib+kb]);
+            }
         }
+        return true;
+    };
+
+    // the rows of the moved panels
+    ThreadPool::parallelFor(0, nMoved, [&](int im0, int im1)
+                            {
+                                for(int im=im0; im<im1; im++)
+                                {
+                                    int i = m_MovedPanels.at(im);
+                                    for(int k=0; k<nPanels(); k++)
+                                        if(m_bMatrixError || !refillBlock(i, k)) return;
+                                }
+                            },
+                            s_bMultiThread, 0, [this]{return isCancelled();});
+
+    // the columns of the moved panels in the other rows
+    ThreadPool::parallelFor(0, nPanels(), [&](int i0, int i1)
+                            {
+                                for(int i=i0; i<i1; i++)
+                                {
+                                    if(bMoved.at(i)) continue;
+                                    for(int k : m_MovedPanels)
+                                        if(m_bMatrixError || !refillBlock(i, k)) return;
+                                }
+                            },
+                            s_bMultiThread, 0, [this]{return isCancelled();});
 
-        computeOnBodyCp(VField.at(1), m_uVLocal, m_Cp);
-        forces(mup, Sigma.data()+1*N, alpha, beta, CoG, bFuseMi, VField.at(1), Forcep, Momentp);
+    return true;
+}
 
-        computeOnBodyCp(VField.at(4), m_wVLocal, m_Cp);
-        forces(mum, Sigma.data()+4*N, alpha, beta, CoG, bFuseMi, VField.at(4), Forcem, Momentm);
-    }
-    SD.Yv = (Forcem - Forcep).dot(js)   /deltaspeed/2.0;
-    SD.Lv = (Momentm - Momentp).dot(is) /deltaspeed/2.0;
-    SD.Nv = (Momentm - Momentp).dot(ks) /deltaspeed/2.0;
 
-    // z-derivatives________________________
-//    alpha = atan2(Vkm.z, Vkm.x)* 180.0/PI;
-    alpha = alphaeq;
-    if(m_pPolar3d->isQuadMethod())
+/**
+ * Keeps a copy of the influence matrix before the wake contribution, if the geometry has been recorded by markMovedPanels().
+ * The copy doubles the memory used by the dense matrix; if it cannot be allocated, the matrix is filled in full at the next operating point.
+ */
+void PanelAnalysis::storeBodyMatrix()
+{
+    if(!m_bPendingVertices) return;
+    m_bPendingVertices = false;
+
+    if(m_bMatrixError || isCancelled())
     {
-        mup = m_WpRHS.data();
-        forces(mup, Sigma.data()+2*N, alpha, beta, CoG, bFuseMi, VField.at(2), Forcep, Momentp);
-        mum = m_WmRHS.data();
-        forces(mum, Sigma.data()+5*N, alpha, beta, CoG, bFuseMi, VField.at(5), Forcem, Momentm);
+        m_bBodyMatrix = false;
+        return;
     }
-    else if(m_pPolar3d->isTriangleMethod())
+
+    try
     {
-        makeLocalVelocities(m_WpRHS, notanrhs, m_WmRHS, m_uVLocal, m_vVLocal, m_wVLocal, objects::windDirection(alphaeq, 0.0));
-        if(m_pPolar3d->isTriUniformMethod())
+        if(s_bDoublePrecision)
         {
-            makeVertexDoubletDensities(m_WpRHS, uRHSVertex);
-            makeVertexDoubletDensities(m_WmRHS, pRHSVertex);
-            mup = uRHSVertex.data();
-            mum = pRHSVertex.data();
+            m_BodyAijf.clear();
+            m_BodyAijd = m_aijd;
         }
-        else if(m_pPolar3d->isTriLinearMethod())
+        else
         {
-            mup = m_WpRHS.data();
-            mum = m_WmRHS.data();
+            m_BodyAijd.clear();
+            m_BodyAijf = m_aijf;
         }
-
-        computeOnBodyCp(VField.at(2), m_uVLocal, m_Cp);
-        forces(mup, Sigma.data()+2*N, alpha, beta, CoG, bFuseMi, VField.at(2), Forcep, Momentp);
-
-        computeOnBodyCp(VField.at(5), m_wVLocal, m_Cp);
-        forces(mum, Sigma.data()+5*N, alpha, beta, CoG, bFuseMi, VField.at(5), Forcem, Momentm);
     }
-    SD.Xw = (Forcem - Forcep).dot(is)   /deltaspeed/2.0;
-    SD.Zw = (Forcem - Forcep).dot(ks)   /deltaspeed/2.0;
-    SD.Mw = (Momentm - Momentp).dot(js) /deltaspeed/2.0;
+    catch(std::bad_alloc const &)
+    {
+        // not enough memory for the second matrix, the next operating points will be filled in full
+        m_BodyAijd.clear();
+        m_BodyAijd.shrink_to_fit();
+        m_BodyAijf.clear();
+        m_BodyAijf.shrink_to_fit();
+        m_bBodyMatrix = false;
+        traceStdLog("      Not enough memory to keep a copy of the influence matrix, the matrix will be filled in full\n");
+        return;
+    }
+    m_BodyVertices.swap(m_PendingVertices);
+    m_BodyAngles = m_PendingAngles;
+    m_bBodyMatrix = true;
 }
 
 
-
-void PanelAnalysis::computeAngularDerivatives(double alphaeq, double u0, Vector3d const &CoG, bool bFuseMi, StabDerivatives &SD)
+/**
+* In the case of a panel analysis, adds the contribution of the wake columns to the coefficients of the influence matrix
+* Method :
+*     - follow the method described in NASA 4023 eq. (44)
+*    - add the wake's doublet contribution to the matrix
+*    - add the potential difference at the trailing edge panels to the RHS ; the potential's origin
+*     is set arbitrarily to the geometrical orgin so that phi = V.dot(WindDirection) x point_position
+*/
+void PanelAnalysis::makeWakeContribution()
 {
-#ifdef INTEL_MKL
-    if(s_bMultiThread)
-        mkl_set_num_threads(s_MaxThreads);
-    else
-        mkl_set_num_threads(1);
-#endif
+    runBlocks([this](int iBlock) {makeWakeMatrixBlock(iBlock);});
+}
 
-    Vector3d Forcem, Momentm, Rism, Rjsm, Rksm;
-    Vector3d Forcep, Momentp, Risp, Rjsp, Rksp;
-    Vector3d V0, is, js, ks, CGM, WindDirection, WindNormal;
 
-    double beta(0.0);
-    int N = nPanels();
-    int rhssize = 0;
-    if(m_pPolar3d->isQuadMethod())
-        rhssize = nPanels();
-    else
-        rhssize = m_pPolar3d->isTriUniformMethod() ? nPanels() : nPanels()*3;
+/**
+ * Make the velocity field induced by the Vorton Wake
+ */
+void PanelAnalysis::makeRHSVWVelocities(std::vector<Vector3d> &VPW, bool bVLM) const
+{
+    std::vector<Vector3d> C(nPanels());
+    for(int p=0; p<nPanels(); p++) C[p] = panelAt(p)->ctrlPt(bVLM);
+
+    VPW.resize(nPanels());
+    getVortonVelocities(nPanels(), C.data(), VPW.data(), nullptr, s_bMultiThread);
+}
 
-    std::vector<double> m_UmRHS(rhssize), m_VmRHS(rhssize), m_WmRHS(rhssize);
-    std::vector<double> m_UpRHS(rhssize), m_VpRHS(rhssize), m_WpRHS(rhssize);
-    std::vector<double> notanrhs(rhssize);
 
-    std::vector<double> Sigma(6*N);
-    std::vector<std::vector<Vector3d>> VField(6);
-    for(uint i=0; i<VField.size(); i++)
+/**
+ * Returns the perturbation velocity induced at point C by the panels, their wake and the vortons.
+ * The panels are split in blocks which are evaluated concurrently if bMultiThread is true;
+ * use getVelocityVectors to evaluate more than one point.
+ */
+void PanelAnalysis::getVelocityVector(Vector3d const &C, double const *Mu, double const *Sigma, Vector3d &VT,
+                                      double coreradius, bool bWakeOnly, bool bMultiThread) const
+{
+    VT.reset(); // total induced velocity
+    if(isCancelled()) return;
+
+    int blocksize = nPanels()/m_nBlocks + 1; // add one to compensate for rounding errors
+    std::vector<Vector3d> VBlock(m_nBlocks);
+
+    ThreadPool::parallelFor(0, m_nBlocks, [&](int iBlock0, int iBlock1)
+                            {
+                                for(int iBlock=iBlock0; iBlock<iBlock1; iBlock++)
+                                {
+                                    int iStart = iBlock*blocksize;
+                                    int iEnd = std::min(iStart+blocksize, nPanels());
+                                    velocityVectorRange(C, iStart, iEnd, Mu, Sigma, coreradius, bWakeOnly, VBlock[iBlock], nullptr);
+                                }
+                            },
+                            bMultiThread, 1);
+
+    for(int ib=0; ib<m_nBlocks; ib++) VT += VBlock[ib];
+
+    if(m_pPolar3d->bVortonWake())
     {
-        VField[i].resize(N);
-        std::fill(VField[i].begin(), VField[i].end(), Vector3d());
+        double vtncorelength = m_pPolar3d->vortonCoreSize()*m_pPolar3d->referenceChordLength();
+
+        Vector3d VVtn;
+        getVortonVelocity(C, vtncorelength, VVtn, bMultiThread);
+        VT += VVtn;
     }
+}
 
-    double rotationrate = 0.01;         //  rad/s for difference estimation
 
-    // Define the stability axes
-    double cosa = cos(alphaeq*PI/180);
-    double sina = sin(alphaeq*PI/180);
-    WindDirection = objects::windDirection(alphaeq, 0.0);
-    WindNormal = objects::windNormal(alphaeq, 0.0);
+/**
+ * Returns the perturbation velocities induced at a set of points by the panels, their wake and the vortons.
+ * The points are split in packets which are evaluated concurrently if bMultiThread is true.
+ * In each packet, the panels are processed in tiles and each tile is applied to all the points of the packet
+ * before moving to the next, so that the panel data is read from the cache rather than from memory.
+ * The method is const and does not use any scratch member, so that it may be called concurrently.
+ * @param nPts the number of points
+ * @param C the array of points
+ * @param V the array of nPts velocities
+ * @param Phi if not null, the array of nPts perturbation potentials
+ * @param G if not null, the array of 9*nPts components of the velocity gradients induced by the vortons, cf. getVortonVelocityGradient()
+ */
+void PanelAnalysis::getVelocityVectors(int nPts, Vector3d const *C, double const *Mu, double const *Sigma, Vector3d *V,
+                                       double coreradius, bool bWakeOnly, bool bMultiThread, double *Phi, double *G) const
+{
+    const int PANELTILE = 64; // panels per tile
+
+    for(int ip=0; ip<nPts; ip++) V[ip].reset();
+    if(Phi) memset(Phi, 0, size_t(nPts)*sizeof(double));
+    if(G)   memset(G,   0, size_t(9*nPts)*sizeof(double));
+
+    ThreadPool::parallelFor(0, nPts, [&](int ip0, int ip1)
+                            {
+                                for(int i0=0; i0<nPanels(); i0+=PANELTILE)
+                                {
+                                    int i1 = std::min(i0+PANELTILE, nPanels());
+                                    for(int ip=ip0; ip<ip1; ip++)
+                                        velocityVectorRange(C[ip], i0, i1, Mu, Sigma, coreradius, bWakeOnly, V[ip], Phi ? Phi+ip : nullptr);
+                                    if(isCancelled()) return;
+                                }
+                            },
+                            bMultiThread && nPts>1, 0, [this]{return isCancelled();});
+
+    if(m_pPolar3d->bVortonWake())
+    {
+        std::vector<Vector3d> VVtn(nPts);
+        getVortonVelocities(nPts, C, VVtn.data(), G, bMultiThread);
+        for(int ip=0; ip<nPts; ip++) V[ip] += VVtn[ip];
+    }
+}
 
-    is.set(-cosa, 0.0, -sina);
-    js.set(  0.0, 1.0,   0.0);
-    ks.set( sina, 0.0, -cosa);
 
-    V0 = is * (-u0); //is the steady state velocity vector, if no sideslip
+/**
+ * Calculates the forces and moments with the far-field method.
+ * The downwash of the trailing strips is evaluated first, then the strip forces and the on-body moments.
+ */
+void PanelAnalysis::forces(double const *Mu, double const *Sigma, double alpha, double beta, Vector3d const &CoG, bool bFuseMi,
+                           std::vector<Vector3d> const &VInf, Vector3d &Force, Vector3d &Moment)
+{
+    std::vector<Vector3d> Wg;
+    trefftzDownwash(Mu, Wg);
+    forcesFromDownwash(Mu, Sigma, alpha, beta, CoG, bFuseMi, VInf, Wg, Force, Moment);
+}
 
-    //______________________________________________________________________________
-    // RHS for unit rotation vectors around Stability axis
-    // stability axis origin is CoG
 
+/**
+ * Calculates the stability derivatives by central differences around the equilibrium state.
+ * The perturbed states are linear combinations of the unit solutions, and so are their surface velocities
+ * and their far-field downwash. These are built once from the unit solutions in makeUnitStabilityFields(),
+ * so that each of the perturbed states only requires linear combinations and the summation of the forces.
+ */
+void PanelAnalysis::computeStabilityDerivatives(double alphaeq, double u0, Vector3d const &CoG, bool bFuseMi,
+                                                StabDerivatives &SD, Vector3d &Force0, Vector3d &Moment0)
+{
+#ifdef INTEL_MKL
+    if(s_bMultiThread)
+        mkl_set_num_threads(s_MaxThreads);
+    else
+        mkl_set_num_threads(1);
+#endif
 
-    for (int p=0; p<N; p++)
-    {
-        Panel const* pPanel = panelAt(p);
-//        if(p3->m_Pos==MIDSURFACE) CGM = p3->VortexPos - m_CoG;
-//        else
-        CGM = pPanel->CoG() - CoG;
+    SD.reset();
+    makeUnitStabilityFields();
+    computeTranslationDerivatives(alphaeq, u0, CoG, bFuseMi, SD, Force0, Moment0);
+    computeAngularDerivatives(alphaeq, u0, CoG, bFuseMi, SD);
+}
 
-        // a rotation of the plane about a vector is the opposite of a rotation of the freestream about this vector
-        Risp = is*CGM * (+rotationrate) + V0;
-        Rjsp = js*CGM * (+rotationrate) + V0;
-        Rksp = ks*CGM * (+rotationrate) + V0;
 
-        Rism = is*CGM * (-rotationrate) + V0;
-        Rjsm = js*CGM * (-rotationrate) + V0;
-        Rksm = ks*CGM * (-rotationrate) + V0;
+/**
+ * Makes the surface velocities and the far-field downwash of the six unit solutions u, v, w, p, q, r.
+ * With a vorton wake the downwash is not linear in the doublet densities,
+ * and is evaluated directly for each perturbed state.
+ */
+void PanelAnalysis::makeUnitStabilityFields()
+{
+    int N = nPanels();
+    std::vector<double> const *unitRHS[]{&m_uRHS, &m_vRHS, &m_wRHS, &m_pRHS, &m_qRHS, &m_rRHS};
 
-        VField[0][p] = Risp;
-        VField[1][p] = Rjsp;
-        VField[2][p] = Rksp;
+    if(m_pPolar3d->isTriangleMethod())
+    {
+        for(int k=0; k<6; k++) m_StabUnitVLocal[k].resize(m_uVLocal.size());
+        makeLocalVelocities(m_uRHS, m_vRHS, m_wRHS, m_StabUnitVLocal[0], m_StabUnitVLocal[1], m_StabUnitVLocal[2], objects::windDirection(0.0, 0.0));
+        makeLocalVelocities(m_pRHS, m_qRHS, m_rRHS, m_StabUnitVLocal[3], m_StabUnitVLocal[4], m_StabUnitVLocal[5], objects::windDirection(0.0, 0.0));
+    }
 
-        VField[3][p] = Rism;
-        VField[4][p] = Rjsm;
-        VField[5][p] = Rksm;
+    if(m_pPolar3d->bVortonWake()) return;
 
-        if(!pPanel->isMidPanel())
+    for(int k=0; k<6; k++)
+    {
+        if(m_pPolar3d->isTriUniformMethod())
         {
-            Sigma[p+0*N] = -1.0/4.0/PI * Risp.dot(pPanel->normal());
-            Sigma[p+1*N] = -1.0/4.0/PI * Rjsp.dot(pPanel->normal());
-            Sigma[p+2*N] = -1.0/4.0/PI * Rjsp.dot(pPanel->normal());
-
-            Sigma[p+3*N] = -1.0/4.0/PI * Rism.dot(pPanel->normal());
-            Sigma[p+4*N] = -1.0/4.0/PI * Rjsm.dot(pPanel->normal());
-            Sigma[p+5*N] = -1.0/4.0/PI * Rksm.dot(pPanel->normal());
+            m_StabMu.resize(3*N);
+            makeVertexDoubletDensities(*unitRHS[k], m_StabMu);
+            trefftzDownwash(m_StabMu.data(), m_StabUnitDownwash[k]);
         }
+        else
+            trefftzDownwash(unitRHS[k]->data(), m_StabUnitDownwash[k]);
     }
+}
 
-    combineUnitRHS(m_UpRHS, V0, is*rotationrate);
-    combineUnitRHS(m_VpRHS, V0, js*rotationrate);
-    combineUnitRHS(m_WpRHS, V0, ks*rotationrate);
-    combineUnitRHS(m_UmRHS, V0, is*(-rotationrate));
-    combineUnitRHS(m_VmRHS, V0, js*(-rotationrate));
-    combineUnitRHS(m_WmRHS, V0, ks*(-rotationrate));
 
-    //________________________________________________
-    // 1st ORDER STABILITY DERIVATIVES
-    double const *mup = nullptr;
-    double const *mum = nullptr;
-    std::vector<double> uRHSVertex, pRHSVertex;
+/**
+ * Calculates the forces and moments of the state defined by the freestream velocity VInf and the rotation Omega,
+ * using the unit fields built in makeUnitStabilityFields().
+ * @param VField the freestream velocity on each panel, including the rotation
+ */
+void PanelAnalysis::perturbedForces(Vector3d const &VInf, Vector3d const &Omega, double alpha, Vector3d const &CoG, bool bFuseMi,
+                                    std::vector<Vector3d> const &VField, Vector3d &Force, Vector3d &Moment)
+{
+    int N = nPanels();
+    double const coef[]{VInf.x, VInf.y, VInf.z, Omega.x, Omega.y, Omega.z};
+
+    m_StabRHS.resize(m_uRHS.size());
+    combineUnitRHS(m_StabRHS, VInf, Omega);
+
+    double const *mu = m_StabRHS.data();
     if(m_pPolar3d->isTriUniformMethod())
     {
-        uRHSVertex.resize(3*N);
-        pRHSVertex.resize(3*N);
+        m_StabMu.resize(3*N);
+        makeVertexDoubletDensities(m_StabRHS, m_StabMu);
+        mu = m_StabMu.data();
     }
 
-//    std::vector<Vector3d> VInf(nPanels(), windDirection(alphaeq, 0.0) * u0);
-
-    // p-derivatives
-    if(m_pPolar3d->isQuadMethod())
+    m_StabSigma.assign(N, 0.0);
+    for(int p=0; p<N; p++)
     {
-        mup = m_UpRHS.data();
-        forces(mup, Sigma.data()+0*N, alphaeq, beta, CoG, bFuseMi, VField.at(0), Forcep, Momentp);
-        mum = m_UmRHS.data();
-        forces(mum, Sigma.data()+3*N, alphaeq, beta, CoG, bFuseMi, VField.at(3), Forcem, Momentm);
+        Panel const *pPanel = panelAt(p);
+        if(!pPanel->isMidPanel()) m_StabSigma[p] = sourceStrength(pPanel->normal(), VField.at(p));
     }
-    else if(m_pPolar3d->isTriangleMethod())
-    {
-        // Make the Cp coefficients necessary to calculate the moments
-        // Re-use the methods implemented for unit calculations,
-        // but this time for the delta+ and delta- solutions
-        makeLocalVelocities(m_UpRHS, notanrhs, m_UmRHS, m_uVLocal, m_vVLocal, m_wVLocal, objects::windDirection(alphaeq, 0.0));
 
-        if(m_pPolar3d->isTriUniformMethod())
-        {
-            makeVertexDoubletDensities(m_UpRHS, uRHSVertex);
-            makeVertexDoubletDensities(m_UmRHS, pRHSVertex);
-            mup = uRHSVertex.data();
-            mum = pRHSVertex.data();
-        }
-        else if(m_pPolar3d->isTriLinearMethod())
+    if(m_pPolar3d->isTriangleMethod())
+    {
+        // the Cp coefficients are needed to calculate the moments
+        m_StabVLocal.assign(m_StabUnitVLocal[0].size(), Vector3d());
+        for(int k=0; k<6; k++)
         {
-            mup = m_UpRHS.data();
-            mum = m_UmRHS.data();
+            if(fabs(coef[k])<=0.0) continue;
+            std::vector<Vector3d> const &unitVLocal = m_StabUnitVLocal[k];
+            for(uint i=0; i<m_StabVLocal.size(); i++) m_StabVLocal[i] += unitVLocal.at(i)*coef[k];
         }
-        computeOnBodyCp(VField.at(0), m_uVLocal, m_Cp);
-        forces(mup, Sigma.data()+0*N, alphaeq, beta, CoG, bFuseMi, VField.at(0), Forcep, Momentp);
-        computeOnBodyCp(VField.at(3), m_wVLocal, m_Cp);
-        forces(mum, Sigma.data()+3*N, alphaeq, beta, CoG, bFuseMi, VField.at(3), Forcem, Momentm);
+        computeOnBodyCp(VField, m_StabVLocal, m_Cp.data());
     }
-    SD.Yp = (Forcep -Forcem ).dot(js) /rotationrate/2.0;
-    SD.Lp = (Momentp-Momentm).dot(is) /rotationrate/2.0;
-    SD.Np = (Momentp-Momentm).dot(ks) /rotationrate/2.0;
 
-    // q-derivatives
-    if(m_pPolar3d->isQuadMethod())
+    if(m_pPolar3d->bVortonWake())
     {
-        mup = m_VpRHS.data();
-        forces(mup, Sigma.data()+1*N, alphaeq, beta, CoG, bFuseMi, VField.at(1), Forcep, Momentp);
-        mum = m_VmRHS.data();
-        forces(mum, Sigma.data()+4*N, alphaeq, beta, CoG, bFuseMi, VField.at(4), Forcem, Momentm);
+        trefftzDownwash(mu, m_StabDownwash);
     }
-    else if(m_pPolar3d->isTriangleMethod())
+    else
     {
-        makeLocalVelocities(m_VpRHS, notanrhs, m_VmRHS, m_uVLocal, m_vVLocal, m_wVLocal, objects::windDirection(alphaeq, 0.0));
-
-        if(m_pPolar3d->isTriUniformMethod())
+        m_StabDownwash.assign(m_StabUnitDownwash[0].size(), Vector3d());
+        for(int k=0; k<6; k++)
         {
-            makeVertexDoubletDensities(m_VpRHS, uRHSVertex);
-            makeVertexDoubletDensities(m_VmRHS, pRHSVertex);
-            mup = uRHSVertex.data();
-            mum = pRHSVertex.data();
+            if(fabs(coef[k])<=0.0) continue;
+            std::vector<Vector3d> const &unitDownwash = m_StabUnitDownwash[k];
+            for(uint m=0; m<m_StabDownwash.size(); m++) m_StabDownwash[m] += unitDownwash.at(m)*coef[k];
         }
-        else if(m_pPolar3d->isTriLinearMethod())
-        {
-            mup = m_VpRHS.data();
-            mum = m_VmRHS.data();
-        }
-        computeOnBodyCp(VField.at(1), m_uVLocal, m_Cp);
-        forces(mup, Sigma.data()+1*N, alphaeq, beta, CoG, bFuseMi, VField.at(1), Forcep, Momentp);
-        computeOnBodyCp(VField.at(4), m_wVLocal, m_Cp);
-        forces(mum, Sigma.data()+4*N, alphaeq, beta, CoG, bFuseMi, VField.at(4), Forcem, Momentm);
     }
-    SD.Xq = (Forcep -Forcem ).dot(is) /rotationrate/2.0;
-    SD.Zq = (Forcep -Forcem ).dot(ks) /rotationrate/2.0;
-    SD.Mq = (Momentp-Momentm).dot(js) /rotationrate/2.0;
 
-    // r-derivatives
-    if(m_pPolar3d->isQuadMethod())
+    forcesFromDownwash(mu, m_StabSigma.data(), alpha, 0.0, CoG, bFuseMi, VField, m_StabDownwash, Force, Moment);
+}
+
+
+void PanelAnalysis::computeTranslationDerivatives(double alphaeq, double u0, Vector3d const &CoG, bool bFuseMi,
+                                                  StabDerivatives &SD, Vector3d &Force0, Vector3d &Moment0)
+{
+    Vector3d Forcem, Momentm;
+    Vector3d Forcep, Momentp;
+    Vector3d V0, is, js, ks, Vp, Vm, Omega;
+
+    int N = nPanels();
+
+    double deltaspeed    = 0.001;         //  m/s   for forward difference estimation
+
+    // Define the stability axes
+    double cosa = cos(alphaeq*PI/180.0);
+    double sina = sin(alphaeq*PI/180.0);
+
+    is.set(-cosa, 0.0, -sina);
+    js.set(  0.0, 1.0,   0.0);
+    ks.set( sina, 0.0, -cosa);
+
+    V0 = is * (-u0); //is the steady state velocity vector, if no sideslip
+
+    // cRHS used to calculate force0 and moment0 used later as the reference for control derivatives
+    combineUnitRHS(m_cRHS, V0, Omega);
+
+    //________________________________________________
+    // reference force and moment
+    m_StabVField[0].assign(N, V0);
+    perturbedForces(V0, Omega, alphaeq, CoG, bFuseMi, m_StabVField[0], Force0, Moment0);
+
+    //________________________________________________
+    // 1st ORDER STABILITY DERIVATIVES
+    // The change in wind velocity is opposite to the change in plane velocity
+    //   - a positive increase in axial speed is a positive increase in wind speed
+    //   - a plane movement to the right is a wind flow to the left, i.e. negative y
+    //   - a plane movement downwards (Z_stability>0) is a positive increase of V in geometry axes
+    Vector3d const axis[]{is, js, ks};
+    for(int iAxis=0; iAxis<3; iAxis++)
     {
-        mup = m_WpRHS.data();
-        forces(mup, Sigma.data()+2*N, alphaeq, beta, CoG, bFuseMi, VField.at(2), Forcep, Momentp);
-        mum = m_WmRHS.data();
-        forces(mum, Sigma.data()+5*N, alphaeq, beta, CoG, bFuseMi, VField.at(5), Forcem, Momentm);
+        Vp = V0 + axis[iAxis] * deltaspeed;
+        Vm = V0 - axis[iAxis] * deltaspeed;
+        m_StabVField[0].assign(N, Vp);
+        m_StabVField[1].assign(N, Vm);
+
+        perturbedForces(Vp, Omega, alphaeq, CoG, bFuseMi, m_StabVField[0], Forcep, Momentp);
+        perturbedForces(Vm, Omega, alphaeq, CoG, bFuseMi, m_StabVField[1], Forcem, Momentm);
+
+        switch(iAxis)
+        {
+            case 0: // x-derivatives
+                SD.Xu = (Forcem - Forcep ).dot(is) /deltaspeed/2.0;
+                SD.Zu = (Forcem - Forcep ).dot(ks) /deltaspeed/2.0;
+                SD.Mu = (Momentm- Momentp).dot(js) /deltaspeed/2.0;
+                break;
+            case 1: // y-derivatives
+                SD.Yv = (Forcem - Forcep).dot(js)   /deltaspeed/2.0;
+                SD.Lv = (Momentm - Momentp).dot(is) /deltaspeed/2.0;
+                SD.Nv = (Momentm - Momentp).dot(ks) /deltaspeed/2.0;
+                break;
+            default: // z-derivatives
+                SD.Xw = (Forcem - Forcep).dot(is)   /deltaspeed/2.0;
+                SD.Zw = (Forcem - Forcep).dot(ks)   /deltaspeed/2.0;
+                SD.Mw = (Momentm - Momentp).dot(js) /deltaspeed/2.0;
+                break;
+        }
     }
-    else if(m_pPolar3d->isTriangleMethod())
-    {
-        makeLocalVelocities(m_WpRHS, notanrhs, m_WmRHS, m_uVLocal, m_vVLocal, m_wVLocal, objects::windDirection(alphaeq, 0.0));
+}
 
-        if(m_pPolar3d->isTriUniformMethod())
+
+void PanelAnalysis::computeAngularDerivatives(double alphaeq, double u0, Vector3d const &CoG, bool bFuseMi, StabDerivatives &SD)
+{
+    Vector3d Forcem, Momentm;
+    Vector3d Forcep, Momentp;
+    Vector3d V0, is, js, ks, CGM;
+
+    int N = nPanels();
+
+    double rotationrate = 0.01;         //  rad/s for difference estimation
+
+    // Define the stability axes
+    double cosa = cos(alphaeq*PI/180);
+    double sina = sin(alphaeq*PI/180);
+
+    is.set(-cosa, 0.0, -sina);
+    js.set(  0.0, 1.0,   0.0);
+    ks.set( sina, 0.0, -cosa);
+
+    V0 = is * (-u0); //is the steady state velocity vector, if no sideslip
+
+    m_StabVField[0].resize(N);
+    m_StabVField[1].resize(N);
+
+    //________________________________________________
+    // 1st ORDER STABILITY DERIVATIVES
+    // unit rotation vectors around the stability axes; the stability axis origin is the CoG
+    Vector3d const axis[]{is, js, ks};
+    for(int iAxis=0; iAxis<3; iAxis++)
+    {
+        for (int p=0; p<N; p++)
         {
-            makeVertexDoubletDensities(m_WpRHS, uRHSVertex);
-            makeVertexDoubletDensities(m_WmRHS, pRHSVertex);
-            mup = uRHSVertex.data();
-            mum = pRHSVertex.data();
+            CGM = panelAt(p)->CoG() - CoG;
+
+            // a rotation of the plane about a vector is the opposite of a rotation of the freestream about this vector
+            m_StabVField[0][p] = axis[iAxis]*CGM * (+rotationrate) + V0;
+            m_StabVField[1][p] = axis[iAxis]*CGM * (-rotationrate) + V0;
         }
-        else if(m_pPolar3d->isTriLinearMethod())
+
+        perturbedForces(V0, axis[iAxis]*rotationrate,    alphaeq, CoG, bFuseMi, m_StabVField[0], Forcep, Momentp);
+        perturbedForces(V0, axis[iAxis]*(-rotationrate), alphaeq, CoG, bFuseMi, m_StabVField[1], Forcem, Momentm);
+
+        switch(iAxis)
         {
-            mup = m_WpRHS.data();
-            mum = m_WmRHS.data();
+            case 0: // p-derivatives
+                SD.Yp = (Forcep -Forcem ).dot(js) /rotationrate/2.0;
+                SD.Lp = (Momentp-Momentm).dot(is) /rotationrate/2.0;
+                SD.Np = (Momentp-Momentm).dot(ks) /rotationrate/2.0;
+                break;
+            case 1: // q-derivatives
+                SD.Xq = (Forcep -Forcem ).dot(is) /rotationrate/2.0;
+                SD.Zq = (Forcep -Forcem ).dot(ks) /rotationrate/2.0;
+                SD.Mq = (Momentp-Momentm).dot(js) /rotationrate/2.0;
+                break;
+            default: // r-derivatives
+                SD.Yr = (Forcep -Forcem ).dot(js) /rotationrate/2.0;
+                SD.Lr = (Momentp-Momentm).dot(is) /rotationrate/2.0;
+                SD.Nr = (Momentp-Momentm).dot(ks) /rotationrate/2.0;
+                break;
         }
-        computeOnBodyCp(VField.at(2), m_uVLocal, m_Cp);
-        forces(mup, Sigma.data()+2*N, alphaeq, beta, CoG, bFuseMi, VField.at(2), Forcep, Momentp);
-        computeOnBodyCp(VField.at(5), m_wVLocal, m_Cp);
-        forces(mum, Sigma.data()+5*N, alphaeq, beta, CoG, bFuseMi, VField.at(5), Forcem, Momentm);
     }
-
-    SD.Yr = (Forcep -Forcem ).dot(js) /rotationrate/2.0;
-    SD.Lr = (Momentp-Momentm).dot(is) /rotationrate/2.0;
-    SD.Nr = (Momentp-Momentm).dot(ks) /rotationrate/2.0;
 }
 
-/** Sets the vortons from a pre-calculated PlaneOpp.
- * Used when calculating streamlines and surface velocities */
+/** Sets the vortons, either from a pre-calculated PlaneOpp when calculating streamlines and surface velocities,
+ * or after the creation of a new row or the advection of the vortons.
+ * The vortons' octree is rebuilt. */
 void PanelAnalysis::setVortons(std::vector<std::vector<Vorton>> const &vortons)
 {
     m_Vorton = vortons;
+    m_VortonTree.build(m_Vorton);
 }
 
 
 /**
  * Returns the velocity vector induced by the array of vortons
+ * The vortons' octree is used if it has been built, otherwise the vortons are evaluated one by one.
  * Very fast, multithreading slows the calculation
 */
 void PanelAnalysis::getVortonVelocity(Vector3d const &C, double vtncorelength, Vector3d &VelVtn, bool bMultiThread) const
@@ -1072,26 +1569,29 @@ void PanelAnalysis::getVortonVelocity(Vector3d const &C, double vtncorelength, V
     VelVtn.reset();
     Vector3d VG, CG;
     bMultiThread = false;
-    if(bMultiThread)
+    if(m_VortonTree.isBuilt())
     {
-        // slower than single thread?
-
-        std::vector<std::thread> threads;
-        std::vector<Vector3d> VRow(nVortonRows());
-        for(int iRow=0; iRow<nVortonRows(); iRow++)
+        m_VortonTree.velocity(C, vtncorelength, VelVtn);
+        if(m_pPolar3d->bHPlane())
         {
-//            futureSync.addFuture(QtConcurrent::run(&PanelAnalysis::getVortonRowVelocity, this, iRow, C, vtncorelength, &VRow[iRow]));
-            threads.push_back(std::thread(&PanelAnalysis::getVortonRowVelocity, this, iRow, C, vtncorelength, &VRow[iRow]));
+            // the mirror images, evaluated at the symmetric point
+            double coef = m_pPolar3d->bGroundEffect() ? 1.0 : -1.0;
+            CG.set(C.x, C.y, -C.z-2.0*m_pPolar3d->groundHeight());
+            m_VortonTree.velocity(CG, vtncorelength, VG);
+            VelVtn.x += VG.x* coef;
+            VelVtn.y += VG.y* coef;
+            VelVtn.z -= VG.z* coef;
         }
-
-        for(int iBlock=0; iBlock<nVortonRows(); iBlock++)
+    }
+    else if(bMultiThread)
+    {
+        // slower than single thread?
+        VelVtn = ThreadPool::parallelReduce<Vector3d>(0, nVortonRows(), Vector3d(), [&](int iRow0, int iRow1)
         {
-            threads[iBlock].join();
-        }
-        std::cout << "PanelAnalysis::getVortonVelocity joined all " << m_nBlocks << " threads" <<std::endl;
-
-        for(uint iRow=0; iRow<VRow.size(); iRow++)
-            VelVtn += VRow.at(iRow);
+            Vector3d VRows;
+            for(int irow=iRow0; irow<iRow1; irow++) getVortonRowVelocity(irow, C, vtncorelength, &VRows);
+            return VRows;
+        });
     }
     else
     {
@@ -1121,6 +1621,26 @@ void PanelAnalysis::getVortonVelocity(Vector3d const &C, double vtncorelength, V
 }
 
 
+/**
+ * Returns the velocities, and optionally the velocity gradients, induced by the vortons at a set of points.
+ * @param G if not null, the array of 9*nPts gradient components
+ */
+void PanelAnalysis::getVortonVelocities(int nPts, Vector3d const *C, Vector3d *V, double *G, bool bMultiThread) const
+{
+    double vtncorelength = m_pPolar3d->vortonCoreSize()*m_pPolar3d->referenceChordLength();
+
+    ThreadPool::parallelFor(0, nPts, [&](int ip0, int ip1)
+                            {
+                                for(int ip=ip0; ip<ip1; ip++)
+                                {
+                                    getVortonVelocity(C[ip], vtncorelength, V[ip], false);
+                                    if(G) getVortonVelocityGradient(C[ip], G+9*ip);
+                                }
+                            },
+                            bMultiThread && nPts>1, 0, [this]{return isCancelled();});
+}
+
+
 void PanelAnalysis::getVortonRowVelocity(int iRow, Vector3d const &C, double vtncorelength, Vector3d *VelVtn) const
 {
     Vector3d VVtn, VG, CG;
@@ -1166,6 +1686,12 @@ void PanelAnalysis::getVortonVelocityGradient(Vector3d const &C, double *G) cons
 //    bool bTrace = false;
     double vtncoresize = m_pPolar3d->vortonCoreSize()*m_pPolar3d->referenceChordLength();
 
+    if(m_VortonTree.isBuilt())
+    {
+        m_VortonTree.velocityGradient(C, vtncoresize, G);
+        return;
+    }
+
     for(int ic=0; ic<nVortonRows(); ic++)
     {
         std::vector<Vorton> const &vtnrow = m_Vorton.at(ic);
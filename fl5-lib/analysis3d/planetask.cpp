@@ -25,6 +25,7 @@
 
 #define _MATH_DEFINES_DEFINED
 
+#include <algorithm>
 #include <chrono>
 #include <string>
 #include <thread>
@@ -61,9 +62,11 @@
 #include <planexfl.h>
 #include <polar.h>
 #include <stabderivatives.h>
+#include <threadpool.h>
 #include <units.h>
 #include <utils.h>
 #include <wingxfl.h>
+#include <xfoilcache.h>
 #include <xfoiltask.h>
 
 
@@ -82,8 +85,9 @@ PlaneTask::PlaneTask() : Task3d()
     m_QInf = m_Beta = m_Phi = 0.0;
 
     m_bDerivatives = true;
+    m_bMeshConnected = false;
 
-    m_AF.resetAll();
+    m_Opp.m_AF.resetAll();
 }
 
 
@@ -161,6 +165,11 @@ bool PlaneTask::initializeTask()
         return false;
     }
 
+    // index the foil polars once for all the operating points
+    m_PolarMesh.clear();
+    if(m_pPlPolar->isViscous() && !m_pPlPolar->isViscOnTheFly())
+        m_PolarMesh.makeMesh(Objects2d::foils(), Objects2d::polars());
+
     // check flaps and ViscOTF
     if(m_pPlPolar->hasActiveFlap())
     {
@@ -205,8 +214,9 @@ bool PlaneTask::initializeTask()
     if(PanelAnalysis::s_bMultiThread) traceStdLog("Running in multi-threaded mode\n\n");
     else                              traceStdLog("Running in single-threaded mode\n\n");
 
-    if(PanelAnalysis::s_bDoublePrecision) traceStdLog("Linear system calculations in floating point double precision\n\n");
-    else                                  traceStdLog("Linear system calculations in floating point single precision\n\n");
+    if(PanelAnalysis::s_bDoublePrecision)     traceStdLog("Linear system calculations in floating point double precision\n\n");
+    else if(PanelAnalysis::bRefineSolution()) traceStdLog("Linear system calculations in floating point single precision with iterative refinement\n\n");
+    else                                      traceStdLog("Linear system calculations in floating point single precision\n\n");
 
     if(Panel3::usingNintcheuFataMethod())
         traceStdLog("Using S. Nintcheu-Fata's method for off-plane integrals\n\n");
@@ -268,6 +278,9 @@ bool PlaneTask::initializeTask()
         }
     }
 
+    // the long operations of the analysis report their progress in the task's log
+    if(m_pPA) m_pPA->setLogFunction([this](std::string const &msg) {traceStdLog(msg);});
+
     switch(m_pPlPolar->type())
     {
         case xfl::BOATPOLAR:
@@ -294,23 +307,30 @@ bool PlaneTask::initializeTask()
             if(pPlaneXfl) pPlaneXfl->setFlaps(m_pPlPolar, outstring);
             traceStdLog(outstring);
 
-            auto start = std::chrono::system_clock::now();
+            if(m_bMeshConnected)
+            {
+                traceStdLog("Using the existing connections of the triangular panels\n");
+            }
+            else
+            {
+                auto start = std::chrono::system_clock::now();
 
-            traceStdLog("Connecting triangular panels...");
+                traceStdLog("Connecting triangular panels...");
 
-            if(!m_pPlane->connectTriMesh(true, false, true))
-            {
-                strange = "\n   Error making trailing edge connections -- aborting.\n\n";
+                if(!m_pPlane->connectTriMesh(true, false, true))
+                {
+                    strange = "\n   Error making trailing edge connections -- aborting.\n\n";
+                    traceLog(strange);
+                    m_bError = true;
+                    return false;
+                }
+
+                auto end = std::chrono::system_clock::now();
+                int duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+                strange = QString::asprintf("   done in %.3f s\n", double(duration)/1000.0);
                 traceLog(strange);
-                m_bError = true;
-                return false;
             }
 
-            auto end = std::chrono::system_clock::now();
-            int duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-            strange = QString::asprintf("   done in %.3f s\n", double(duration)/1000.0);
-            traceLog(strange);
-
 
             if(fabs(m_pPlPolar->phi())>AOAPRECISION)
             {
@@ -336,23 +356,30 @@ bool PlaneTask::initializeTask()
         }
         case xfl::T6POLAR:
         {
-            auto start = std::chrono::system_clock::now();
+            if(m_bMeshConnected)
+            {
+                traceStdLog("Using the existing connections of the triangular panels\n");
+            }
+            else
+            {
+                auto start = std::chrono::system_clock::now();
 
-            traceStdLog("Connecting triangular panels...");
+                traceStdLog("Connecting triangular panels...");
 
-            if(!m_pPlane->connectTriMesh(true, false, true))
-            {
-                strange = "\n   Error making trailing edge connections -- aborting.\n\n";
+                if(!m_pPlane->connectTriMesh(true, false, true))
+                {
+                    strange = "\n   Error making trailing edge connections -- aborting.\n\n";
+                    traceLog(strange);
+                    m_bError = true;
+                    return false;
+                }
+
+                auto end = std::chrono::system_clock::now();
+                int duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+                strange = QString::asprintf("   done in %.3f s\n", double(duration)/1000.0);
                 traceLog(strange);
-                m_bError = true;
-                return false;
             }
 
-            auto end = std::chrono::system_clock::now();
-            int duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-            strange = QString::asprintf("   done in %.3f s\n", double(duration)/1000.0);
-            traceLog(strange);
-
             if(pPlaneXfl && m_pPlPolar->isQuadMethod())
             {
                 m_pP4A->setQuadMesh(pPlaneXfl->refQuadMesh());
@@ -413,24 +440,25 @@ void PlaneTask::allocatePlaneResultArrays()
 
     if(pPlaneXfl)
     {
-        m_WingForce.resize(pPlaneXfl->nWings());
+        m_Opp.m_WingForce.resize(pPlaneXfl->nWings());
+        m_Opp.m_FlapMoment.resize(pPlaneXfl->nWings());
 
-        m_SpanDistFF.resize(pPlaneXfl->nWings());
+        m_Opp.m_SpanDistFF.resize(pPlaneXfl->nWings());
         for(int iw=0; iw<pPlaneXfl->nWings(); iw++)
         {
             WingXfl const *pWing = pPlaneXfl->wingAt(iw);
-            m_SpanDistFF[iw].resizeResults(pWing->nStations());
-            m_SpanDistFF[iw].setGeometry(pWing);
+            m_Opp.m_SpanDistFF[iw].resizeResults(pWing->nStations());
+            m_Opp.m_SpanDistFF[iw].setGeometry(pWing);
         }
     }
     else
     {
-        m_WingForce.resize(1); // 1 thing
+        m_Opp.m_WingForce.resize(1); // 1 thing
 
-        m_SpanDistFF.resize(1);
+        m_Opp.m_SpanDistFF.resize(1);
 
-        m_SpanDistFF[0].resizeGeometry(m_pPlane->nStations());
-        m_SpanDistFF[0].resizeResults(m_pPlane->nStations());
+        m_Opp.m_SpanDistFF[0].resizeGeometry(m_pPlane->nStations());
+        m_Opp.m_SpanDistFF[0].resizeResults(m_pPlane->nStations());
 
     }
  }
@@ -442,24 +470,24 @@ void PlaneTask::setObjects(Plane *pPlane, PlanePolar *pWPolar)
     m_pPlPolar = pWPolar;
     m_pPolar3d = m_pPlPolar;
 
-    m_AF.resetAll();
-    m_AF.setReferenceDims(pWPolar->referenceArea(), pWPolar->referenceChordLength(), pWPolar->referenceSpanLength());
+    m_Opp.m_AF.resetAll();
+    m_Opp.m_AF.setReferenceDims(pWPolar->referenceArea(), pWPolar->referenceChordLength(), pWPolar->referenceSpanLength());
 
     PlaneXfl *pPlaneXfl = dynamic_cast<PlaneXfl*>(m_pPlane);
     if(pPlaneXfl)
     {
-        m_SpanDistFF.resize(pPlaneXfl->nWings());
-        m_PartAF.resize(m_pPlane->nParts());
+        m_Opp.m_SpanDistFF.resize(pPlaneXfl->nWings());
+        m_Opp.m_PartAF.resize(m_pPlane->nParts());
 
         for(int iw=0; iw<pPlaneXfl->nWings(); iw++)
         {
             WingXfl *pWing = pPlaneXfl->wing(iw);
             if(m_pPlPolar->bProjectedDim())
-                m_PartAF[iw].setReferenceDims(pWing->projectedArea(), pWing->MAC(), pWing->projectedSpan());
+                m_Opp.m_PartAF[iw].setReferenceDims(pWing->projectedArea(), pWing->MAC(), pWing->projectedSpan());
             else
-                m_PartAF[iw].setReferenceDims(pWing->planformArea(),  pWing->MAC(), pWing->planformSpan());
+                m_Opp.m_PartAF[iw].setReferenceDims(pWing->planformArea(),  pWing->MAC(), pWing->planformSpan());
 
-            m_SpanDistFF[iw].resizeResults(pWing->nStations());
+            m_Opp.m_SpanDistFF[iw].resizeResults(pWing->nStations());
             pWing->resizeSpanDistribs();
         }
     }
@@ -647,6 +675,10 @@ bool PlaneTask::T6Loop()
 
     double AlphaStab(0.0), BetaStab(0.0), QInfStab(1.0);
 
+    m_Opp.m_Mu    = m_pPA->m_Mu.data();
+    m_Opp.m_Sigma = m_pPA->m_Sigma.data();
+    m_Opp.m_Cp    = m_pPA->m_Cp.data();
+
     for (m_qRHS=0; m_qRHS<m_nRHS; m_qRHS++)
     {
         if(s_bCancel)
@@ -729,6 +761,9 @@ bool PlaneTask::T6Loop()
             log += QString::fromStdString(str);
         }
 
+        // only the coefficients of the panels which have moved since the last fill need to be refilled
+        m_pPA->markMovedPanels(Vector3d(m_Alpha, m_Beta, m_Phi));
+
         if(m_pP4A && m_pPlane->isXflType())
         {
             pPlaneXfl->quadMesh().rotate(m_Alpha, m_Beta, m_Phi);
@@ -757,46 +792,57 @@ bool PlaneTask::T6Loop()
 
 
 
-        auto start = std::chrono::system_clock::now();
+        // the factorization is unchanged if only the inertia or the speed has changed
+        uint64_t matrixkey = m_pPA->matrixKey();
+        if(m_pPA->fetchFactorization(matrixkey))
+        {
+            traceStdLog("      Reusing the LU factorization of a previous operating point\n");
+        }
+        else
+        {
+            auto start = std::chrono::system_clock::now();
 
-        traceStdLog("      Making the influence matrix...");
-        m_pPA->makeInfluenceMatrix();
+            traceStdLog("      Making the influence matrix...");
+            m_pPA->makeInfluenceMatrix();
 
-        auto end = std::chrono::system_clock::now();
-        int duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-        start = end;
-        strange = QString::asprintf("     done in %.3f s\n", double(duration)/1000.0);
-
-        traceLog(strange);
+            auto end = std::chrono::system_clock::now();
+            int duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+            start = end;
+            strange = QString::asprintf("     done in %.3f s\n", double(duration)/1000.0);
 
-        if(m_pPA->m_bMatrixError) return false;
-        if (isCancelled()) return true;
+            traceLog(strange);
 
-        if(!m_pPlPolar->isVLM())
-        {
-            m_pPA->addWakeContribution();
             if(m_pPA->m_bMatrixError) return false;
-        }
-        if (isCancelled()) return true;
+            if (isCancelled()) return true;
 
-        traceStdLog("      LAPACK - LU factorization...");
+            if(!m_pPlPolar->isVLM())
+            {
+                m_pPA->addWakeContribution();
+                if(m_pPA->m_bMatrixError) return false;
+            }
+            if (isCancelled()) return true;
 
-        if (!m_pPA->LUfactorize())
-        {
-            traceStdLog(" singular matrix, aborting\n");
-            m_bError = true;
-            return true;
-        }
+            traceStdLog("      LAPACK - LU factorization...");
 
-        end = std::chrono::system_clock::now();
-        duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-        start = end;
-        strange = QString::asprintf("       done in %.3f s\n", double(duration)/1000.0);
+            if (!m_pPA->LUfactorize())
+            {
+                traceStdLog(" singular matrix, aborting\n");
+                m_bError = true;
+                return true;
+            }
 
-        traceLog(strange);
+            end = std::chrono::system_clock::now();
+            duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+            start = end;
+            strange = QString::asprintf("       done in %.3f s\n", double(duration)/1000.0);
+
+            traceLog(strange);
+
+            m_pPA->storeFactorization(matrixkey);
+        }
 
         traceStdLog("      Making source strengths...");
-        m_pPA->makeSourceStrengths(objects::windDirection(m_Alpha, 0.0)); // unit source strengths
+        m_pPA->makeSourceStrengths(objects::windDirection(m_Alpha, 0.0), m_pPA->m_Sigma.data()); // unit source strengths
         traceStdLog("         done\n");
 
         // go through the loop at least once
@@ -856,12 +902,12 @@ bool PlaneTask::T6Loop()
                         m_pPA->makeVertexDoubletDensities(m_pP3A->m_uRHS, m_pP3A->m_Mu);
                 }
 
-                computeInducedForces(0, 0, m_QInf); //  the mesh has been rotated, use the x-aligned wind direction
+                computeInducedForces(m_Opp, 0, 0, m_QInf); //  the mesh has been rotated, use the x-aligned wind direction
 
                 if(m_pPlPolar->isAdjustedVelocity())
                 {
                     std::string str;
-                    double v = computeBalanceSpeeds(0, mass, m_bError, "      ", str);
+                    double v = computeBalanceSpeeds(m_Opp, 0, m_Beta, mass, m_bError, "      ", str);
 
                     if(v<=0.0)
                     {
@@ -876,7 +922,7 @@ bool PlaneTask::T6Loop()
                     strange = "\n";
                 }
 
-                scaleResultsToSpeed(m_QInf, QInfStab);
+                scaleResultsToSpeed(m_Opp, m_QInf, QInfStab);
 
                 // scale the calculated densities - required for Cp calc.
                 for(uint i=0; i<m_pPA->m_uRHS.size(); i++) m_pPA->m_uRHS[i] *= QInfStab/m_QInf;
@@ -887,12 +933,12 @@ bool PlaneTask::T6Loop()
                 {
                     for(int iw=0; iw<m_pPlane->nWings(); iw++)
                     {
-                        F += m_WingForce.at(iw);
+                        F += m_Opp.m_WingForce.at(iw);
                     }
                 }
                 else
                 {
-                    F = m_WingForce.front();
+                    F = m_Opp.m_WingForce.front();
                 }
 //                CL = F.dot(windNormal(AlphaStab, BetaStab))/m_pWPolar->referenceArea();
                 CL = F.dot(objects::windNormal(0, 0))/m_pPlPolar->referenceArea();
@@ -976,19 +1022,21 @@ bool PlaneTask::T6Loop()
 
         if(bViscLoopError) continue; // move on to the next operating point calculation
 
-        computeInducedDrag(0, 0, QInfStab);
+        PanelAnalysis::clearDebugPts();
+        computeInducedDrag(m_Opp, 0, 0, QInfStab);
 
 
         m_pPA->makeLocalVelocities(m_pPA->m_uRHS, m_pPA->m_vRHS, m_pPA->m_wRHS,
                                    m_pPA->m_uVLocal, m_pPA->m_vVLocal, m_pPA->m_wVLocal, objects::windDirection(0, 0)*m_QInf); // only using first
 
         std::fill(VField.begin(), VField.end(), objects::windDirection(0, 0)*QInfStab);
-        m_pPA->computeOnBodyCp(VField, m_pPA->m_uVLocal, m_pPA->m_Cp);
+        m_pPA->computeOnBodyCp(VField, m_pPA->m_uVLocal, m_pPA->m_Cp.data());
 
         strange = QString::asprintf("      Calculating plane for control parameter=%.3f\n", m_Ctrl);
         traceLog(strange);
 
-        PlaneOpp *pPOpp = computePlane(m_Ctrl, m_Alpha, BetaStab, m_Phi, QInfStab, mass, CoG, true);
+        PlaneOpp *pPOpp = computePlane(m_Opp, m_Ctrl, m_Alpha, BetaStab, m_Phi, QInfStab, mass, CoG, true);
+        flushOppContext(m_Opp);
         traceStdLog(EOLstr);
 
         storePOpp(pPOpp);
@@ -1112,15 +1160,15 @@ bool PlaneTask::updateVirtualTwist(double QInf, double &error, std::string &logm
         // compute the lift coefficient on strips
         if(m_pPlPolar->isTriangleMethod())
         {
-            pWing->panel3ComputeStrips(m_pP3A->m_Panel3, m_pPlPolar, CoG, m_Alpha, m_Beta, QInf, Cp3Vtx, m_SpanDistFF[iw]);
+            pWing->panel3ComputeStrips(m_pP3A->m_Panel3, m_pPlPolar, CoG, m_Alpha, m_Beta, QInf, Cp3Vtx, m_Opp.m_SpanDistFF[iw], m_Opp.m_FlapMoment[iw]);
         }
         else if(m_pPlPolar->isQuadMethod())
         {
             // Compute aero data on strips
-            pWing->panel4ComputeStrips(m_pP4A->m_Panel4, m_pPlPolar, CoG, m_Alpha, m_Beta, QInf, cp4, mu4, m_SpanDistFF[iw]);
+            pWing->panel4ComputeStrips(m_pP4A->m_Panel4, m_pPlPolar, CoG, m_Alpha, m_Beta, QInf, cp4, mu4, m_Opp.m_SpanDistFF[iw], m_Opp.m_FlapMoment[iw]);
         }
 
-        SpanDistribs const&sd = m_SpanDistFF.at(iw);
+        SpanDistribs const&sd = m_Opp.m_SpanDistFF.at(iw);
 
         int m=0;
         for(int jSurf=0; jSurf<pWing->nSurfaces(); jSurf++)
@@ -1134,11 +1182,11 @@ bool PlaneTask::updateVirtualTwist(double QInf, double &error, std::string &logm
 
                 double tau=0;
                 pWing->getFoils(&pFoil0, &pFoil1, sd.m_StripPos.at(m), tau);
-                double alpha_0 = Objects2d::getZeroLiftAngle(pFoil0, pFoil1, Re, tau);
+                double alpha_0 = m_PolarMesh.getZeroLiftAngle(pFoil0, pFoil1, Re, tau);
 
                 double aoa_effective = alpha_0 + (Cl_vlm/2.0/PI) *180.0/PI - m_gamma[iStation];
                 bool bOutRe=false, bOutAlpha = false;
-                double Cl_visc = Objects2d::getPlrPointFromAlpha(Polar::CL, pFoil0, pFoil1, Re, aoa_effective, tau, bOutRe, bOutAlpha);
+                double Cl_visc = m_PolarMesh.getPlrPointFromAlpha(Polar::CL, pFoil0, pFoil1, Re, aoa_effective, tau, bOutRe, bOutAlpha);
 
                 if(bOutRe || bOutAlpha)
                 {
@@ -1233,8 +1281,8 @@ void PlaneTask::outputStateMatrices(PlaneOpp const *pPOpp)
 }
 
 
-PlaneOpp* PlaneTask::computePlane(double ctrl, double alpha, double beta, double phi, double QInf, double mass,
-                                  Vector3d const &CoG, bool bInGeomAxes)
+PlaneOpp* PlaneTask::computePlane(PlaneOppContext &ctx, double ctrl, double alpha, double beta, double phi, double QInf, double mass,
+                                  Vector3d const &CoG, bool bInGeomAxes) const
 {
     if(QInf<PRECISION)
     {
@@ -1243,7 +1291,6 @@ PlaneOpp* PlaneTask::computePlane(double ctrl, double alpha, double beta, double
 
     PlaneXfl *pPlaneXfl = dynamic_cast<PlaneXfl *>(m_pPlane);
 
-    m_QInf = QInf;
     Vector3d windD,windN;
     if(bInGeomAxes)
     {
@@ -1259,32 +1306,32 @@ PlaneOpp* PlaneTask::computePlane(double ctrl, double alpha, double beta, double
     double const *mu3=(nullptr), *sigma3(nullptr), *Cp3Vtx(nullptr);
     if(m_pP3A && m_pPlPolar->isTriangleMethod())
     {
-        mu3    = m_pP3A->m_Mu.data();
-        sigma3 = m_pP3A->m_Sigma.data();
-        Cp3Vtx = m_pP3A->m_Cp.data();
+        mu3    = ctx.m_Mu;
+        sigma3 = ctx.m_Sigma;
+        Cp3Vtx = ctx.m_Cp;
     }
     double const *mu4(nullptr), *sigma4(nullptr);
     double *cp4(nullptr);
 
     if(m_pPlPolar->isQuadMethod())
     {
-        mu4    = m_pP4A->m_Mu.data();
-        sigma4 = m_pP4A->m_Sigma.data();
-        cp4    = m_pP4A->m_Cp.data();
+        mu4    = ctx.m_Mu;
+        sigma4 = ctx.m_Sigma;
+        cp4    = ctx.m_Cp;
     }
 
-    m_AF.resetResults();
-//    m_PartAF.resize(m_pPlane->nParts());
+    ctx.m_AF.resetResults();
+//    ctx.m_PartAF.resize(m_pPlane->nParts());
 
     if(m_pPlPolar->isType6())
     {
-        m_AF.setOpp(alpha, m_Beta, m_Phi, QInf);
-        for(int i=0; i<int(m_PartAF.size()); i++)  m_PartAF[i].setOpp(alpha, beta, m_Phi, QInf);
+        ctx.m_AF.setOpp(alpha, m_Beta, m_Phi, QInf);
+        for(int i=0; i<int(ctx.m_PartAF.size()); i++)  ctx.m_PartAF[i].setOpp(alpha, beta, m_Phi, QInf);
     }
     else
     {
-        m_AF.setOpp(alpha, beta, m_pPlPolar->phi(), QInf);
-        for(int i=0; i<int(m_PartAF.size()); i++)  m_PartAF[i].setOpp(alpha, beta, m_pPlPolar->phi(), QInf);
+        ctx.m_AF.setOpp(alpha, beta, m_pPlPolar->phi(), QInf);
+        for(int i=0; i<int(ctx.m_PartAF.size()); i++)  ctx.m_PartAF[i].setOpp(alpha, beta, m_pPlPolar->phi(), QInf);
     }
 
     Vector3d Force, PlaneCP, Mi;
@@ -1296,13 +1343,13 @@ PlaneOpp* PlaneTask::computePlane(double ctrl, double alpha, double beta, double
         for(int iw=0; iw<nWings; iw++)
         {
 
-            if(bInGeomAxes) partforce = objects::windToGeomAxes(m_WingForce.at(iw), alpha, beta);
-            else            partforce = m_WingForce[iw];
+            if(bInGeomAxes) partforce = objects::windToGeomAxes(ctx.m_WingForce.at(iw), alpha, beta);
+            else            partforce = ctx.m_WingForce[iw];
 
 //            if(m_pWPolar->isT6Polar()) partforce.y *= -1.0; // removed in v7.24 to be consistent with AVL
 
             Force += partforce;                           // (N/q), body axes
-            m_PartAF[iw].setFff(partforce);
+            ctx.m_PartAF[iw].setFff(partforce);
         }
     }
 
@@ -1319,36 +1366,36 @@ PlaneOpp* PlaneTask::computePlane(double ctrl, double alpha, double beta, double
             //Compute aero forces and span distributions
             if(m_pPlPolar->isQuadMethod())
             {
-                pWing->panel4ComputeInviscidForces(m_pP4A->m_Panel4, m_pPlPolar, CoG, alpha, beta, QInf, cp4, mu4, m_PartAF[iw]);
-                pWing->panel4ComputeStrips(m_pP4A->m_Panel4, m_pPlPolar, CoG, alpha, beta, QInf, cp4, mu4, m_SpanDistFF[iw]);
+                pWing->panel4ComputeInviscidForces(m_pP4A->m_Panel4, m_pPlPolar, CoG, alpha, beta, QInf, cp4, mu4, ctx.m_PartAF[iw]);
+                pWing->panel4ComputeStrips(m_pP4A->m_Panel4, m_pPlPolar, CoG, alpha, beta, QInf, cp4, mu4, ctx.m_SpanDistFF[iw], ctx.m_FlapMoment[iw]);
             }
             else if(m_pPlPolar->isTriangleMethod())
             {
-                pWing->panel3ComputeInviscidForces(m_pP3A->m_Panel3, m_pPlPolar, CoG, alpha, beta, Cp3Vtx, m_PartAF[iw]);
-                pWing->panel3ComputeStrips(m_pP3A->m_Panel3, m_pPlPolar, CoG, alpha, beta, QInf, Cp3Vtx, m_SpanDistFF[iw]);
+                pWing->panel3ComputeInviscidForces(m_pP3A->m_Panel3, m_pPlPolar, CoG, alpha, beta, Cp3Vtx, ctx.m_PartAF[iw]);
+                pWing->panel3ComputeStrips(m_pP3A->m_Panel3, m_pPlPolar, CoG, alpha, beta, QInf, Cp3Vtx, ctx.m_SpanDistFF[iw], ctx.m_FlapMoment[iw]);
             }
 
             if(bInGeomAxes)
             {
-                partforce = objects::windToGeomAxes(m_PartAF.at(iw).Fsum(), alpha, beta);
-                partmi    = objects::windToGeomAxes(m_PartAF.at(iw).Mi(), alpha, beta);
+                partforce = objects::windToGeomAxes(ctx.m_PartAF.at(iw).Fsum(), alpha, beta);
+                partmi    = objects::windToGeomAxes(ctx.m_PartAF.at(iw).Mi(), alpha, beta);
             }
             else
             {
-                partforce = m_PartAF.at(iw).Fsum();
-                partmi    = m_PartAF.at(iw).Mi();
+                partforce = ctx.m_PartAF.at(iw).Fsum();
+                partmi    = ctx.m_PartAF.at(iw).Mi();
             }
 
             if(m_pPlPolar->isType6()) partforce.y *= -1.0;
 
-            m_AF.addFsum(partforce);
+            ctx.m_AF.addFsum(partforce);
             Mi += partmi;           //N.m/q
-            m_PartAF[iw].setFsum(partforce);
-            m_PartAF[iw].setMi(partmi);           //N.m/q
+            ctx.m_PartAF[iw].setFsum(partforce);
+            ctx.m_PartAF[iw].setMi(partmi);           //N.m/q
 
 
-            if     (m_pPlPolar->isQuadMethod())     pWing->panelComputeBending(m_pP4A->m_Panel4, m_pPlPolar->bThinSurfaces(), m_SpanDistFF[iw]);
-            else if(m_pPlPolar->isTriangleMethod()) pWing->panelComputeBending(m_pP3A->m_Panel3, m_pPlPolar->bThinSurfaces(), m_SpanDistFF[iw]);
+            if     (m_pPlPolar->isQuadMethod())     pWing->panelComputeBending(m_pP4A->m_Panel4, m_pPlPolar->bThinSurfaces(), ctx.m_SpanDistFF[iw]);
+            else if(m_pPlPolar->isTriangleMethod()) pWing->panelComputeBending(m_pP3A->m_Panel3, m_pPlPolar->bThinSurfaces(), ctx.m_SpanDistFF[iw]);
 
             iStation += pWing->nStations();
             if(s_bCancel) return nullptr;
@@ -1357,9 +1404,9 @@ PlaneOpp* PlaneTask::computePlane(double ctrl, double alpha, double beta, double
         if(s_bCancel) return nullptr;
 
         if(m_pPlPolar->isViscInterpolated())
-            traceStdLog("          Adding interpolated viscous drag...\n");
+            ctx.m_Log += "          Adding interpolated viscous drag...\n";
         else
-            traceStdLog("          Calculating XFoil viscous drag on the fly...\n");
+            ctx.m_Log += "          Calculating XFoil viscous drag on the fly...\n";
 
         iStation = 0;
 
@@ -1374,42 +1421,36 @@ PlaneOpp* PlaneTask::computePlane(double ctrl, double alpha, double beta, double
 
                 if(m_pPlPolar->isViscInterpolated())
                 {
-                    traceStdLog("             Processing "+ pWing->name() + EOLstr);
-                    bViscOK = computeViscousDrag(pWing, alpha, beta, QInf, m_pPlPolar, CoG, iStation, m_SpanDistFF[iw], logmsg);
+                    ctx.m_Log += "             Processing "+ pWing->name() + EOLstr;
+                    bViscOK = computeViscousDrag(pWing, alpha, beta, QInf, m_pPlPolar, CoG, iStation, ctx.m_SpanDistFF[iw], logmsg);
                     if(logmsg.length()!=0)
                     {
-                        traceStdLog("                ...Viscous interpolation failures:\n");
-                        traceStdLog(logmsg);
+                        ctx.m_Log += "                ...Viscous interpolation failures:\n";
+                        ctx.m_Log += logmsg;
                     }
                 }
                 else
                 {
-                    traceLog("             Processing "+
-                             QString::fromStdString(pWing->name()) +": " +
-                             QString::asprintf("%d surfaces", pWing->nSurfaces()) +
-                             EOLch);
-                    bViscOK = computeViscousDragOTF(pWing, alpha, beta, QInf, m_pPlPolar, CoG, m_pPlPolar->flapCtrls(iw), m_SpanDistFF[iw], logmsg);
-                    if(logmsg.length()!=0)
-                    {
-                        traceStdLog("                ...XFoil OTF failures:\n");
-                        traceStdLog(logmsg);
-                    }
+                    ctx.m_Log += "             Processing " + pWing->name() + ": " +
+                                 QString::asprintf("%d surfaces", pWing->nSurfaces()).toStdString() + EOLstr;
+                    bViscOK = computeViscousDragOTF(pWing, alpha, beta, QInf, m_pPlPolar, CoG, m_pPlPolar->flapCtrls(iw), ctx.m_SpanDistFF[iw], logmsg);
+                    ctx.m_Log += logmsg; // the surface reports, including the XFoil OTF failures
                 }
 
                 if(!bViscOK)
                 {
-                    m_bError = true;
+                    ctx.m_bError = true;
                     return nullptr; // no point in calculating the rest
                 }
-                pWing->computeViscousForces(m_pPlPolar, alpha, beta, m_SpanDistFF[iw], m_PartAF[iw]);
-                m_AF.addProfileDrag(m_PartAF.at(iw).profileDrag());           //N/q
-                m_AF.addMv(m_PartAF.at(iw).Mv());                             //N.m/q
+                pWing->computeViscousForces(m_pPlPolar, alpha, beta, ctx.m_SpanDistFF[iw], ctx.m_PartAF[iw]);
+                ctx.m_AF.addProfileDrag(ctx.m_PartAF.at(iw).profileDrag());           //N/q
+                ctx.m_AF.addMv(ctx.m_PartAF.at(iw).Mv());                             //N.m/q
 
-//                m_PartAF[iw].setProfileDrag(pWing->AF().profileDrag());           //N/q
-//                m_PartAF[iw].setMv(pWing->AF().Mv());                             //N.m/q
+//                ctx.m_PartAF[iw].setProfileDrag(pWing->AF().profileDrag());           //N/q
+//                ctx.m_PartAF[iw].setMv(pWing->AF().Mv());                             //N.m/q
             }
         }
-        traceStdLog("             ...done.\n");
+        ctx.m_Log += "             ...done.\n";
         if(s_bCancel) return nullptr;
 
         // add fuse contribution to Centre of Pressure position, to pressure moments and to viscous properties
@@ -1436,12 +1477,12 @@ PlaneOpp* PlaneTask::computePlane(double ctrl, double alpha, double beta, double
                     partmi    = Moment;
                 }
 
-                m_AF.addFsum(partforce);           // N/q
+                ctx.m_AF.addFsum(partforce);           // N/q
                 if(m_pPlPolar->bFuseMi())
                 {
                     Mi += partmi;               // N.m/q
-                    m_PartAF[ipart].setFsum(partforce);                             // N/q
-                    m_PartAF[ipart].setMi(partmi);                                 // N.m/q
+                    ctx.m_PartAF[ipart].setFsum(partforce);                             // N/q
+                    ctx.m_PartAF[ipart].setMi(partmi);                                 // N.m/q
                 }
             }
 
@@ -1449,14 +1490,14 @@ PlaneOpp* PlaneTask::computePlane(double ctrl, double alpha, double beta, double
             {
                 Vector3d Force, Moment;
                 pFuse->computeViscousForces(m_pPlPolar, alpha, QInf, Force, Moment);
-                m_AF.addFuseDrag(Force.dot(windD));
-                m_PartAF[ipart].setFuseDrag(Force.dot(windD));
+                ctx.m_AF.addFuseDrag(Force.dot(windD));
+                ctx.m_PartAF[ipart].setFuseDrag(Force.dot(windD));
 
 //                Vector3d drag(windD*pFuse->AF().viscousDrag());
 
                 Vector3d leverarm = (pPlaneXfl->fusePos(0)+pFuse->inertia().CoG_t())-CoG;
-                m_AF.addMv(leverarm * Force);
-                m_PartAF[ipart].setMv(leverarm * Force);
+                ctx.m_AF.addMv(leverarm * Force);
+                ctx.m_PartAF[ipart].setMv(leverarm * Force);
             }
         }
     }
@@ -1466,32 +1507,32 @@ PlaneOpp* PlaneTask::computePlane(double ctrl, double alpha, double beta, double
     {
         //PlaneSTL
         if(bInGeomAxes)
-            Force += objects::windToGeomAxes(m_WingForce.at(0), alpha, beta);
+            Force += objects::windToGeomAxes(ctx.m_WingForce.at(0), alpha, beta);
         else
-            Force += m_WingForce.at(0);                           // (N/q), body axes
+            Force += ctx.m_WingForce.at(0);                           // (N/q), body axes
 
         AeroForces AF;
         if(m_pPlPolar && Cp3Vtx)
             computeInviscidAero(m_pP3A->m_Panel3, Cp3Vtx, m_pPlPolar, alpha, AF);
-        m_AF.addFsum(AF.Fsum());
+        ctx.m_AF.addFsum(AF.Fsum());
         Mi = AF.Mi();
     }
 
-    m_AF.setFff(Force);          // N/q, body axes
-    m_AF.setMi(Mi);
+    ctx.m_AF.setFff(Force);          // N/q, body axes
+    ctx.m_AF.setMi(Mi);
 
     // add all extra drag
     if(m_pPlPolar && m_pPlPolar->hasExtraDrag())
     {
-        m_AF.setExtraDrag(m_pPlPolar->extraDragTotal(m_AF.CL()));
+        ctx.m_AF.setExtraDrag(m_pPlPolar->extraDragTotal(ctx.m_AF.CL()));
     }
 
     Vector3d M0;
-    for(int iw=0; iw<int(m_PartAF.size()); iw++) // only one if STL
+    for(int iw=0; iw<int(ctx.m_PartAF.size()); iw++) // only one if STL
     {
-        M0 += m_PartAF.at(iw).M0();
+        M0 += ctx.m_PartAF.at(iw).M0();
     }
-    m_AF.setM0(M0);
+    ctx.m_AF.setM0(M0);
 
     if(s_bCancel) return nullptr;
 
@@ -1502,11 +1543,11 @@ PlaneOpp* PlaneTask::computePlane(double ctrl, double alpha, double beta, double
 
         if(m_pPlPolar->isTriangleMethod())
         {
-            pPOpp = createPlaneOpp(ctrl, alpha, beta, phi, QInf, mass, CoG, Cp3Vtx, mu3, sigma3);
+            pPOpp = createPlaneOpp(ctx, ctrl, alpha, beta, phi, QInf, mass, CoG, Cp3Vtx, mu3, sigma3);
         }
         else if (m_pPlPolar->isQuadMethod())
         {
-            pPOpp = createPlaneOpp(ctrl, alpha, beta, phi, QInf, mass, CoG, cp4, mu4, sigma4);
+            pPOpp = createPlaneOpp(ctx, ctrl, alpha, beta, phi, QInf, mass, CoG, cp4, mu4, sigma4);
         }
     }
     return pPOpp;
@@ -1551,7 +1592,7 @@ void PlaneTask::computeInviscidAero(std::vector<Panel3> const &panel3, const dou
 }
 
 
-void PlaneTask::scaleResultsToSpeed(double vOld, double vNew)
+void PlaneTask::scaleResultsToSpeed(PlaneOppContext &ctx, double vOld, double vNew) const
 {
     //scale the circulation, strip force and downwash fields
     double ratio = vNew/vOld;
@@ -1565,75 +1606,76 @@ void PlaneTask::scaleResultsToSpeed(double vOld, double vNew)
 
             for(int m=0; m<pWing->nStations(); m++)
             {
-                m_SpanDistFF[iw].m_F[m]     *= ratio*ratio;
-                m_SpanDistFF[iw].m_Vd[m]    *= ratio;
-                m_SpanDistFF[iw].m_Gamma[m] *= ratio;
+                ctx.m_SpanDistFF[iw].m_F[m]     *= ratio*ratio;
+                ctx.m_SpanDistFF[iw].m_Vd[m]    *= ratio;
+                ctx.m_SpanDistFF[iw].m_Gamma[m] *= ratio;
             }
         }
     }
 
-    m_pPA->scaleResultsToSpeed(ratio);
+    m_pPA->scaleResultsToSpeed(ratio, ctx.m_Mu, ctx.m_Sigma);
 }
 
 
-double PlaneTask::computeBalanceSpeeds(double Alpha, double mass, bool &bWarning, std::string const &prefix, std::string &log)
+double PlaneTask::computeBalanceSpeeds(PlaneOppContext const &ctx, double Alpha, double Beta, double mass, bool &bWarning,
+                                       std::string const &prefix, std::string &log) const
 {
     Vector3d Force, WindN;
-    WindN = objects::windNormal(Alpha, m_Beta);
+    WindN = objects::windNormal(Alpha, Beta);
     Force.set(0.0,0.0,0.0);
 
     if(m_pPlane->isXflType())
     {
         for(int iw=0; iw<m_pPlane->nWings(); iw++)
         {
-            Force += m_WingForce.at(iw);
+            Force += ctx.m_WingForce.at(iw);
         }
     }
     else
     {
-        Force = m_WingForce.front();
+        Force = ctx.m_WingForce.front();
     }
 
-    if(mass<1.e-6) traceStdLog(prefix + "Warning: zero mass - not possible to set a balance speed\n");
+    if(mass<1.e-6) log += prefix + "Warning: zero mass - not possible to set a balance speed\n";
 
     double Lift =  Force.dot(WindN) ;      //N/q, for 1/ms
     if(Lift<=0.0)
     {
-        log = prefix + "negative lift .... skipping the angle\n";
+        log += prefix + "negative lift .... skipping the angle\n";
 
         bWarning  = true;
         return -100.0;
     }
     double v = sqrt(2.0* 9.81 * mass/m_pPlPolar->density()/Lift);
-    log = prefix + "V" + INFstr + QString::asprintf("=%7.3f ", v*Units::mstoUnit()).toStdString();
+    log += prefix + "V" + INFstr + QString::asprintf("=%7.3f ", v*Units::mstoUnit()).toStdString();
     log += Units::speedUnitLabel();
     return v;
 }
 
 
-double PlaneTask::computeGlideSpeed(double Alpha, double mass, std::string &log)
+double PlaneTask::computeGlideSpeed(PlaneOppContext &ctx, double Alpha, double Beta, double mass, std::string &log) const
 {
     std::string strange;
     Vector3d Force, WindNormal;
 
-    WindNormal = objects::windNormal(Alpha, m_Beta);
+    WindNormal = objects::windNormal(Alpha, Beta);
     Force.set(0.0,0.0,0.0);
 
     for(int iw=0; iw<m_pPlane->nWings(); iw++)
     {
-        Force += m_WingForce.at(iw);
+        Force += ctx.m_WingForce.at(iw);
     }
     double Lift =  Force.dot(WindNormal) ;      //N/q, for 1/ms
     if(Lift<=0.0)
     {
         log = ": negative lift, skipping the angle\n";
 
-        m_bError  = true;
+        ctx.m_bError  = true;
         return -100.0;
     }
 
     double CL = Lift/m_pPlPolar->referenceArea();
-    double CDi = Force.dot(objects::windDirection(Alpha, m_Beta))/m_pPlPolar->referenceArea();
+    double CDi = Force.dot(objects::windDirection(Alpha, Beta))/m_pPlPolar->referenceArea();
     double v0=0.1;    // m/s
     double v1=1000.0; // m/s
     double CDv1=0.0;
@@ -1648,17 +1690,20 @@ double PlaneTask::computeGlideSpeed(double Alpha, double mass, std::string &log)
         {
             WingXfl *pWing = m_pPlane->wing(iw);
             //restore the saved results
-//            pWing->setSpanDistFF(m_SpanDistFF.at(iw));
+//            pWing->setSpanDistFF(ctx.m_SpanDistFF.at(iw));
 /*            computeViscousDrag(pWing, Alpha, 0.0, v0, m_pWPolar, Vector3d(), iStation);
-            pWing->computeViscousForces(m_pWPolar, Alpha, m_Beta);
+            pWing->computeViscousForces(m_pWPolar, Alpha, Beta);
             CDv0 += pWing->AF().profileDrag();*/
 
             if(m_pPlPolar->isViscOnTheFly())
-                computeViscousDragOTF(pWing, Alpha, 0.0, v1, m_pPlPolar, Vector3d(), m_pPlPolar->flapCtrls(iw), m_SpanDistFF[iw], strange);
+            {
+                computeViscousDragOTF(pWing, Alpha, 0.0, v1, m_pPlPolar, Vector3d(), m_pPlPolar->flapCtrls(iw), ctx.m_SpanDistFF[iw], strange);
+                ctx.m_Log += strange;
+            }
             else
-                computeViscousDrag(pWing, Alpha, 0.0, v1, m_pPlPolar, Vector3d(), iStation, m_SpanDistFF[iw], strange);
-            pWing->computeViscousForces(m_pPlPolar, Alpha, m_Beta, m_SpanDistFF[iw], m_PartAF[iw]);
-            CDv1 += m_PartAF.at(iw).profileDrag(); // N/q
+                computeViscousDrag(pWing, Alpha, 0.0, v1, m_pPlPolar, Vector3d(), iStation, ctx.m_SpanDistFF[iw], strange);
+            pWing->computeViscousForces(m_pPlPolar, Alpha, Beta, ctx.m_SpanDistFF[iw], ctx.m_PartAF[iw]);
+            CDv1 += ctx.m_PartAF.at(iw).profileDrag(); // N/q
 
             iStation += pWing->nStations();
         }
@@ -1676,7 +1721,7 @@ double PlaneTask::computeGlideSpeed(double Alpha, double mass, std::string &log)
     {
         log = ": could not find a stabilized velocity, skipping the angle";
 
-        m_bError  = true;
+        ctx.m_bError  = true;
         return -100.0;
      }
     else
@@ -1689,7 +1734,7 @@ double PlaneTask::computeGlideSpeed(double Alpha, double mass, std::string &log)
 }
 
 
-void PlaneTask::computeInducedForces(double alpha, double beta, double QInf)
+void PlaneTask::computeInducedForces(PlaneOppContext &ctx, double alpha, double beta, double QInf) const
 {
     if(m_pPlane->isXflType())
     {
@@ -1700,13 +1745,13 @@ void PlaneTask::computeInducedForces(double alpha, double beta, double QInf)
             WingXfl *pWing = m_pPlane->wing(iw);
             Vector3d forcebodyaxes;
             if(m_pPlPolar->isQuadMethod())
-                m_pP4A->inducedForce(pWing->nPanel4(), QInf, alpha, beta, pos, forcebodyaxes, m_SpanDistFF[iw]);
+                m_pP4A->inducedForce(pWing->nPanel4(), QInf, alpha, beta, pos, ctx.m_Mu, forcebodyaxes, ctx.m_SpanDistFF[iw]);
             else if(m_pP3A && m_pPlPolar->isTriangleMethod())
-                m_pP3A->inducedForce(pWing->nPanel3(), QInf, alpha, beta, pos, forcebodyaxes, m_SpanDistFF[iw]);
+                m_pP3A->inducedForce(pWing->nPanel3(), QInf, alpha, beta, pos, ctx.m_Mu, forcebodyaxes, ctx.m_SpanDistFF[iw]);
 
             //save the results... will save another FF calculation when computing the operating points
-            m_WingForce[iw] = forcebodyaxes;     // N/q, body axes
-//            m_SpanDistFF[iw] = pWing->spanDistFF();
+            ctx.m_WingForce[iw] = forcebodyaxes;     // N/q, body axes
+//            ctx.m_SpanDistFF[iw] = pWing->spanDistFF();
 
             if      (m_pPlPolar->isTriangleMethod()) pos += pWing->nPanel3();
             else if (m_pPlPolar->isQuadMethod())     pos += pWing->nPanel4();
@@ -1716,18 +1761,16 @@ void PlaneTask::computeInducedForces(double alpha, double beta, double QInf)
     }
     else
     {
-        m_WingForce[0].reset();
-        m_pP3A->inducedForce(m_pPlane->nPanel3(), QInf, alpha, beta, 0, m_WingForce[0], m_SpanDistFF[0]);
+        ctx.m_WingForce[0].reset();
+        m_pP3A->inducedForce(m_pPlane->nPanel3(), QInf, alpha, beta, 0, ctx.m_Mu, ctx.m_WingForce[0], ctx.m_SpanDistFF[0]);
     }
 }
 
 
-void PlaneTask::computeInducedDrag(double alpha, double beta, double QInf)
+void PlaneTask::computeInducedDrag(PlaneOppContext &ctx, double alpha, double beta, double QInf) const
 {
     Vector3d FFForceBodyAxes;
 
-    PanelAnalysis::clearDebugPts();
-
     if(m_pPlane->isXflType())
     {
         int nWings = m_pPlane->nWings();
@@ -1739,17 +1782,17 @@ void PlaneTask::computeInducedDrag(double alpha, double beta, double QInf)
             WingXfl *pWing = m_pPlane->wing(iw);
             if(m_pPolar3d->bVortonWake())
             {
-                m_pPA->vortonDrag(alpha, beta, QInf, m0, pWing->nStations(), FFForceBodyAxes, m_SpanDistFF[iw]);
+                m_pPA->vortonDrag(alpha, beta, QInf, m0, pWing->nStations(), FFForceBodyAxes, ctx.m_SpanDistFF[iw]);
                 m0 += pWing->nStations();
             }
             else
             {
                 if(m_pPlPolar->isQuadMethod())
-                    m_pP4A->trefftzDrag(pWing->nPanel4(), QInf, alpha, beta, pos, FFForceBodyAxes, m_SpanDistFF[iw]);
+                    m_pP4A->trefftzDrag(pWing->nPanel4(), QInf, alpha, beta, pos, ctx.m_Mu, ctx.m_Sigma, FFForceBodyAxes, ctx.m_SpanDistFF[iw]);
                 else if(m_pPlPolar->isTriangleMethod())
-                    m_pP3A->trefftzDrag(pWing->nPanel3(), QInf, alpha, beta, pos, FFForceBodyAxes, m_SpanDistFF[iw]);
+                    m_pP3A->trefftzDrag(pWing->nPanel3(), QInf, alpha, beta, pos, ctx.m_Mu, ctx.m_Sigma, FFForceBodyAxes, ctx.m_SpanDistFF[iw]);
             }
-            m_WingForce[iw] += FFForceBodyAxes;     // N/q, body axes
+            ctx.m_WingForce[iw] += FFForceBodyAxes;     // N/q, body axes
 
             if      (m_pPlPolar->isTriangleMethod()) pos += pWing->nPanel3();
             else if (m_pPlPolar->isQuadMethod())     pos += pWing->nPanel4();
@@ -1761,15 +1804,15 @@ void PlaneTask::computeInducedDrag(double alpha, double beta, double QInf)
     {
         // STL case
         if(m_pPolar3d->bVortonWake())
-            m_pPA->vortonDrag(alpha, beta, QInf, 0, m_pPlane->nStations(), FFForceBodyAxes, m_SpanDistFF[0]);
+            m_pPA->vortonDrag(alpha, beta, QInf, 0, m_pPlane->nStations(), FFForceBodyAxes, ctx.m_SpanDistFF[0]);
         else
-            m_pP3A->trefftzDrag(m_pPlane->nPanel3(), QInf, alpha, beta, 0, FFForceBodyAxes, m_SpanDistFF[0]);
-        m_WingForce[0] += FFForceBodyAxes;     // N/q, body axes
+            m_pP3A->trefftzDrag(m_pPlane->nPanel3(), QInf, alpha, beta, 0, ctx.m_Mu, ctx.m_Sigma, FFForceBodyAxes, ctx.m_SpanDistFF[0]);
+        ctx.m_WingForce[0] += FFForceBodyAxes;     // N/q, body axes
     }
 }
 
 
-PlaneOpp *PlaneTask::createPlaneOpp(double ctrl, double alpha, double beta, double phi, double QInf, double mass, Vector3d const &CoG,
+PlaneOpp *PlaneTask::createPlaneOpp(PlaneOppContext const &ctx, double ctrl, double alpha, double beta, double phi, double QInf, double mass, Vector3d const &CoG,
                                     double const *Cp, double const *Gamma, double const *Sigma, bool bCpOnly) const
 {
     PlaneXfl const *pPlaneXfl = nullptr;
@@ -1785,10 +1828,6 @@ PlaneOpp *PlaneTask::createPlaneOpp(double ctrl, double alpha, double beta, doub
     pPOpp->setTheStyle(m_pPlPolar->theStyle());
     pPOpp->setVisible(true);
 
-    PlaneOpp *pLastPOpp(nullptr);
-    if(m_PlaneOppList.size()) pLastPOpp = m_PlaneOppList.back();
-    if(pLastPOpp) pPOpp->setLineColor(pLastPOpp->lineColor().darker(100));
-
     int iStation = 0;
     if(pPlaneXfl)
     {
@@ -1797,7 +1836,7 @@ PlaneOpp *PlaneTask::createPlaneOpp(double ctrl, double alpha, double beta, doub
             WingXfl const*pWing = pPlaneXfl->wingAt(iw);
 
             pPOpp->addWingOpp(pWing->nPanel4());
-            pPOpp->m_WingOpp[iw].createWOpp(pWing, m_pPlPolar, m_SpanDistFF.at(iw), m_PartAF.at(iw));
+            pPOpp->m_WingOpp[iw].createWOpp(pWing, m_pPlPolar, ctx.m_SpanDistFF.at(iw), ctx.m_PartAF.at(iw));
 
             if(m_pPlPolar->isViscous() && m_pPlPolar->bViscousLoop())
             {
@@ -1853,7 +1892,7 @@ PlaneOpp *PlaneTask::createPlaneOpp(double ctrl, double alpha, double beta, doub
     pPOpp->m_bFreeSurface = m_pPolar3d->bFreeSurfaceEffect();
     pPOpp->m_GroundHeight = m_pPolar3d->groundHeight();
 
-    pPOpp->m_AF = m_AF;
+    pPOpp->m_AF = ctx.m_AF;
 
     if(bCpOnly) return pPOpp;
 
@@ -1866,12 +1905,13 @@ PlaneOpp *PlaneTask::createPlaneOpp(double ctrl, double alpha, double beta, doub
             WingXfl const*pWing = pPlaneXfl->wingAt(iw);
             if(pWing && pPOpp->nWOpps()>iw)
             {
-                pPOpp->m_WingOpp[iw].m_AF = m_PartAF.at(iw);
+                pPOpp->m_WingOpp[iw].m_AF = ctx.m_PartAF.at(iw);
 
                 pPOpp->m_WingOpp[iw].m_FlapMoment.clear();
-                for (int i=0; i<pWing->nFlaps(); i++)
+                std::vector<double> const &flapmoment = ctx.m_FlapMoment.at(iw);
+                for (int i=0; i<pWing->nFlaps() && i<int(flapmoment.size()); i++)
                 {
-                    pPOpp->m_WingOpp[iw].m_FlapMoment.push_back(pWing->flapMomentAt(i));
+                    pPOpp->m_WingOpp[iw].m_FlapMoment.push_back(flapmoment.at(i));
                 }
 
                 pPOpp->m_WingOpp[iw].m_dCp    = pPOpp->m_Cp.data()    + pos;
@@ -1889,7 +1929,7 @@ PlaneOpp *PlaneTask::createPlaneOpp(double ctrl, double alpha, double beta, doub
             double Cb = 0.0;
             for (int l=0; l<pPlaneXfl->wingAt(0)->nStations(); l++)
             {
-                if(fabs(m_SpanDistFF[0].m_BendingMoment[l])>fabs(Cb)) Cb = m_SpanDistFF[0].m_BendingMoment[l];
+                if(fabs(ctx.m_SpanDistFF[0].m_BendingMoment[l])>fabs(Cb)) Cb = ctx.m_SpanDistFF[0].m_BendingMoment[l];
             }
             if(pWOpp) pWOpp->m_MaxBending = Cb;
         }
@@ -1901,7 +1941,7 @@ PlaneOpp *PlaneTask::createPlaneOpp(double ctrl, double alpha, double beta, doub
         for(int ifuse=0; ifuse<pPlaneXfl->nFuse(); ifuse++)
         {
     //        pPOpp->m_FuseAF.push_back(m_pPlane->fuse(ifuse)->AF());
-            pPOpp->m_FuseAF.push_back(m_PartAF.at(m_pPlane->nWings()+ifuse));
+            pPOpp->m_FuseAF.push_back(ctx.m_PartAF.at(m_pPlane->nWings()+ifuse));
         }
     }
 
@@ -1962,16 +2002,22 @@ bool PlaneTask::T7Loop()
     {
         m_QInf = u0;
 
+        m_Opp.m_Mu    = m_pPA->m_Mu.data();
+        m_Opp.m_Sigma = m_pPA->m_Sigma.data();
+        m_Opp.m_Cp    = m_pPA->m_Cp.data();
+
         traceStdLog("      Calculating far field forces...\n");
-        computeInducedForces(AlphaEq, m_Beta, 1.0);
-        computeInducedDrag(AlphaEq, m_Beta, 1.0);
-        scaleResultsToSpeed(1.0, u0);
+        PanelAnalysis::clearDebugPts();
+        computeInducedForces(m_Opp, AlphaEq, m_Beta, 1.0);
+        computeInducedDrag(m_Opp, AlphaEq, m_Beta, 1.0);
+        scaleResultsToSpeed(m_Opp, 1.0, u0);
 
         if (isCancelled()) return true;
 
         str = "      Calculating Plane for "+ALPHAch + QString::asprintf("=%.2f", AlphaEq) + DEGch + EOLch;
         traceLog(str);
-        PlaneOpp *pPOpp = computePlane(m_Ctrl, AlphaEq, m_Beta, m_Phi, u0, mass, CoG, false);
+        PlaneOpp *pPOpp = computePlane(m_Opp, m_Ctrl, AlphaEq, m_Beta, m_Phi, u0, mass, CoG, false);
+        flushOppContext(m_Opp);
         if(!pPOpp)
         {
             traceStdLog("           Error generating the operating point... discarding\n\n");
@@ -1980,7 +2026,7 @@ bool PlaneTask::T7Loop()
 
         if (isCancelled()) return true;
 
-        if(computeStability(pPOpp, true))
+        if(computeStability(pPOpp, m_Opp, true))
         {          
             storePOpp(pPOpp);
         }
@@ -1991,7 +2037,11 @@ bool PlaneTask::T7Loop()
 }
 
 
-bool PlaneTask::computeStability(PlaneOpp *pPOpp, bool bOutput)
+/**
+ * Calculates the stability and control derivatives and the eigenthings of the operating point.
+ * @param ctx the context of the operating point, which holds its source strengths
+ */
+bool PlaneTask::computeStability(PlaneOpp *pPOpp, PlaneOppContext const &ctx, bool bOutput)
 {
     std::string str;
     // Compute stability and control derivatives in stability axes
@@ -2003,7 +2053,7 @@ bool PlaneTask::computeStability(PlaneOpp *pPOpp, bool bOutput)
 
     if(m_pPlPolar->hasActiveAVLControl())
     {
-        computeControlDerivatives(m_Ctrl, pPOpp->alpha(), pPOpp->QInf(), pPOpp->m_SD); //single derivative, w.r.t. the polar's control variable
+        computeControlDerivatives(m_Ctrl, pPOpp->alpha(), pPOpp->QInf(), ctx.m_Sigma, pPOpp->m_SD); //single derivative, w.r.t. the polar's control variable
     }
     if(isCancelled()) return true;
 
@@ -2055,7 +2105,7 @@ bool PlaneTask::computeStability(PlaneOpp *pPOpp, bool bOutput)
 
 bool PlaneTask::T123458Loop()
 {
-    QString strange, str, outstring;
+    QString strange;
 
     traceStdLog("\nSolving the problem... \n\n");
 
@@ -2083,7 +2133,35 @@ bool PlaneTask::T123458Loop()
     if(m_nRHS>1) strange +="s";
     traceLog(EOLch+strange+EOLch);
 
+    std::vector<int> activeopps;
     for(uint io=0; io<m_T8Opps.size(); io++)
+        if(m_T8Opps.at(io).isActive()) activeopps.push_back(int(io));
+
+    // The operating points only differ by their RHS once the influence matrix has been factorized.
+    // They are calculated in batches, one context per thread, then stored in sequence
+    // so that the polar, the log and the stability analyses keep the order of the input list.
+    int nSlots = PanelAnalysis::isMultiThreaded() ? std::max(1, PanelAnalysis::maxThreadCount()) : 1;
+    nSlots = std::min(nSlots, std::max(1, int(activeopps.size())));
+
+    const int nMu    = int(m_pPA->m_Mu.size());
+    const int nSigma = int(m_pPA->m_Sigma.size());
+    const int nCp    = int(m_pPA->m_Cp.size());
+    const int nSlotSize = nMu+nSigma+nCp;
+    std::vector<double> slotbuffer(size_t(nSlots)*size_t(nSlotSize));
+
+    std::vector<PlaneOppContext> contexts(nSlots, m_Opp);
+    for(int is=0; is<nSlots; is++)
+    {
+        double *pSlot = slotbuffer.data() + size_t(is)*size_t(nSlotSize);
+        contexts[is].m_Mu    = pSlot;
+        contexts[is].m_Sigma = pSlot + nMu;
+        contexts[is].m_Cp    = pSlot + nMu + nSigma;
+    }
+    std::vector<PlaneOpp*> batchopps(nSlots, nullptr);
+
+    PanelAnalysis::clearDebugPts();
+
+    for(int i0=0; i0<int(activeopps.size()); i0+=nSlots)
     {
         if(s_bCancel)
         {
@@ -2091,114 +2169,158 @@ bool PlaneTask::T123458Loop()
             return false;
         }
 
-        T8Opp const &t8opp = m_T8Opps.at(io);
+        const int nOpps = std::min(nSlots, int(activeopps.size())-i0);
 
-        if(!t8opp.isActive()) continue;
-        m_qRHS = io;
-        m_Alpha = t8opp.alpha();
-        m_Beta  = t8opp.beta();
-        m_Phi   = m_pPlPolar->phi();
-        m_QInf  = t8opp.Vinf();
-        m_Ctrl  = 0.0;
+        ThreadPool::parallelFor(0, nOpps, [&](int ib0, int ib1)
+        {
+            for(int ib=ib0; ib<ib1; ib++)
+            {
+                T8Opp const &t8opp = m_T8Opps.at(activeopps.at(i0+ib));
+                batchopps[ib] = computeT123458Opp(t8opp, contexts[ib], mass, CoG, uVLocal, vVLocal, wVLocal);
+            }
+        }, nOpps>1, 1);
 
-        outstring = "     ";
-        outstring += ALPHAch + QString::asprintf("=%g", m_Alpha) + DEGch + ", ";
-        outstring += BETAch  + QString::asprintf("=%g", m_Beta)  + DEGch + ", ";
-        outstring += PHIch   + QString::asprintf("=%g", m_Phi)   + DEGch + ", ";
+        for(int ib=0; ib<nOpps; ib++)
+        {
+            PlaneOpp *pPOpp = batchopps[ib];
+            batchopps[ib] = nullptr;
+            flushOppContext(contexts[ib]);
 
-        if(m_pPlPolar->isType1() || m_pPlPolar->isType4() || m_pPlPolar->isType5() || m_pPlPolar->isType8())
-            outstring += "V" + INFch + QString::asprintf("=%g ", m_QInf*Units::mstoUnit()) + Units::speedUnitQLabel() + EOLch;
-        else
-            outstring += "V" + INFch + ": adjusted" + EOLch;
+            if(!pPOpp) continue;
 
-        traceLog(outstring);
+            if (isCancelled())
+            {
+                delete pPOpp;
+                continue;
+            }
 
-        traceStdLog("       Creating source strengths...\n");
-        m_pPA->makeSourceStrengths(objects::windDirection(m_Alpha, m_Beta));
+            // keep the densities of the last operating point in the analysis, cf. getVelocityVector()
+            std::copy(contexts[ib].m_Mu,    contexts[ib].m_Mu+nMu,       m_pPA->m_Mu.begin());
+            std::copy(contexts[ib].m_Sigma, contexts[ib].m_Sigma+nSigma, m_pPA->m_Sigma.begin());
 
-        traceStdLog("       Calculating doublet strengths...\n");
-        m_pPA->makeUnitDoubletStrengths(m_Alpha, m_Beta);
+            T8Opp const &t8opp = m_T8Opps.at(activeopps.at(i0+ib));
+            m_qRHS  = activeopps.at(i0+ib);
+            m_Alpha = t8opp.alpha();
+            m_Beta  = t8opp.beta();
+            m_Phi   = m_pPlPolar->phi();
+            m_QInf  = pPOpp->QInf();
+            m_Ctrl  = 0.0;
 
-        traceStdLog("       Calculating far field forces...\n");
+            if(m_bDerivatives)
+            {
+                traceStdLog("          Calculating derivatives and eigenthings\n");
+                computeStability(pPOpp, contexts[ib], true);
+            }
+            else
+            {
+                traceStdLog("          Skipping derivatives and eigenthings\n");
+            }
 
-        computeInducedForces(m_Alpha, m_Beta, 1.0);
-        computeInducedDrag(  m_Alpha, m_Beta, 1.0);
+            storePOpp(pPOpp);
 
-        if(m_pPlPolar->isType1() || m_pPlPolar->isType5())
-        {
-            m_QInf = m_pPlPolar->velocity();
-        }
-        else if(m_pPlPolar->isType2() || m_pPlPolar->isType3())
-        {
-            std::string str;
-            traceStdLog("       Calculating balance speeds...\n");
-            if (m_pPlPolar->isFixedLiftPolar())
-                m_QInf = computeBalanceSpeeds(m_Alpha, m_pPlPolar->mass(), m_bError, "", str);
-            else if(m_pPlPolar->isGlidePolar())
-                m_QInf = computeGlideSpeed(m_Alpha, m_pPlPolar->mass(), str);
-            strange = "             " + QString::fromStdString(str) + EOLch;
-            traceLog(strange);
-        }
-        else if(m_pPlPolar->isType4())
-        {
-            m_QInf = t8opp.m_Vinf;
-        }
-        else if(m_pPlPolar->isType8())
-        {
-            m_QInf = t8opp.m_Vinf;
-        }
-        else
-        {
-            assert(false);
+            traceStdLog("          Done operating point\n\n");
         }
 
-        if(m_QInf<0) continue;
+        if (isCancelled()) return true;
+    }
 
-        scaleResultsToSpeed(1.0, m_QInf);
+    return true;
+}
 
-        if (isCancelled()) return true;
 
-        traceStdLog("       Calculating on-body pressure coefficients...\n");
-        std::vector<Vector3d> VLocal;
-        std::vector<Vector3d> VInf(m_pPA->nPanels());
-        std::fill(VInf.begin(), VInf.end(), objects::windDirection(m_Alpha, m_Beta));
+/**
+ * Calculates one operating point of a T123458 polar from the unit solutions.
+ * Only writes to the context, so that the operating points can be calculated concurrently.
+ * @return a pointer to the new PlaneOpp, or nullptr if the operating point has been discarded.
+ */
+PlaneOpp *PlaneTask::computeT123458Opp(T8Opp const &t8opp, PlaneOppContext &ctx, double mass, Vector3d const &CoG,
+                                       std::vector<Vector3d> const &uVLocal, std::vector<Vector3d> const &vVLocal, std::vector<Vector3d> const &wVLocal) const
+{
+    double alpha = t8opp.alpha();
+    double beta  = t8opp.beta();
+    double phi   = m_pPlPolar->phi();
+    double QInf  = t8opp.Vinf();
+
+    QString outstring = "     ";
+    outstring += ALPHAch + QString::asprintf("=%g", alpha) + DEGch + ", ";
+    outstring += BETAch  + QString::asprintf("=%g", beta)  + DEGch + ", ";
+    outstring += PHIch   + QString::asprintf("=%g", phi)   + DEGch + ", ";
+
+    if(m_pPlPolar->isType1() || m_pPlPolar->isType4() || m_pPlPolar->isType5() || m_pPlPolar->isType8())
+        outstring += "V" + INFch + QString::asprintf("=%g ", QInf*Units::mstoUnit()) + Units::speedUnitQLabel() + EOLch;
+    else
+        outstring += "V" + INFch + ": adjusted" + EOLch;
 
-        // Save a little time by restoring the unit velocty fields instead of recalculating them
-        m_pPA->m_uVLocal = uVLocal;
-        m_pPA->m_vVLocal = vVLocal;
-        m_pPA->m_wVLocal = wVLocal;
+    ctx.m_Log += outstring.toStdString();
 
-        m_pPA->combineLocalVelocities(m_Alpha, m_Beta, VLocal);
-        m_pPA->computeOnBodyCp(VInf, VLocal, m_pPA->m_Cp);
-        if (isCancelled()) return true;
+    ctx.m_Log += "       Creating source strengths...\n";
+    m_pPA->makeSourceStrengths(objects::windDirection(alpha, beta), ctx.m_Sigma);
 
-        str = "       Calculating plane\n";
-        traceLog(str);
-        PlaneOpp *pPOpp = computePlane(m_Ctrl, m_Alpha, m_Beta, m_pPlPolar->phi(), m_QInf, mass, CoG, false);
-        if(!pPOpp)
-        {
-            traceStdLog("\n          Error generating the operating point... discarding\n\n");
-            continue;
-        }
+    ctx.m_Log += "       Calculating doublet strengths...\n";
+    m_pPA->makeUnitDoubletStrengths(alpha, beta, ctx.m_Mu);
 
-        if (isCancelled()) return true;
+    ctx.m_Log += "       Calculating far field forces...\n";
 
-        if(m_bDerivatives)
-        {
-            traceStdLog("          Calculating derivatives and eigenthings\n");
-            computeStability(pPOpp, true);
-        }
-        else
-        {
-            traceStdLog("          Skipping derivatives and eigenthings\n");
-        }
+    computeInducedForces(ctx, alpha, beta, 1.0);
+    computeInducedDrag(  ctx, alpha, beta, 1.0);
 
-        storePOpp(pPOpp);
+    if(m_pPlPolar->isType1() || m_pPlPolar->isType5())
+    {
+        QInf = m_pPlPolar->velocity();
+    }
+    else if(m_pPlPolar->isType2() || m_pPlPolar->isType3())
+    {
+        std::string str;
+        ctx.m_Log += "       Calculating balance speeds...\n";
+        if (m_pPlPolar->isFixedLiftPolar())
+            QInf = computeBalanceSpeeds(ctx, alpha, beta, m_pPlPolar->mass(), ctx.m_bError, "", str);
+        else if(m_pPlPolar->isGlidePolar())
+            QInf = computeGlideSpeed(ctx, alpha, beta, m_pPlPolar->mass(), str);
+        ctx.m_Log += "             " + str + EOLstr;
+    }
+    else if(m_pPlPolar->isType4() || m_pPlPolar->isType8())
+    {
+        QInf = t8opp.m_Vinf;
+    }
+    else
+    {
+        assert(false);
+    }
 
-        traceStdLog("          Done operating point\n\n");
+    if(QInf<0) return nullptr;
+
+    scaleResultsToSpeed(ctx, 1.0, QInf);
+
+    if (isCancelled()) return nullptr;
+
+    ctx.m_Log += "       Calculating on-body pressure coefficients...\n";
+    std::vector<Vector3d> VLocal;
+    std::vector<Vector3d> VInf(m_pPA->nPanels());
+    std::fill(VInf.begin(), VInf.end(), objects::windDirection(alpha, beta));
+
+    // Save a little time by combining the unit velocity fields instead of recalculating them
+    m_pPA->combineLocalVelocities(alpha, beta, uVLocal, vVLocal, wVLocal, VLocal);
+    m_pPA->computeOnBodyCp(VInf, VLocal, ctx.m_Cp);
+    if (isCancelled()) return nullptr;
+
+    ctx.m_Log += "       Calculating plane\n";
+    PlaneOpp *pPOpp = computePlane(ctx, 0.0, alpha, beta, phi, QInf, mass, CoG, false);
+    if(!pPOpp)
+    {
+        if(!isCancelled()) ctx.m_Log += "\n          Error generating the operating point... discarding\n\n";
+        return nullptr;
     }
 
-    return true;
+    return pPOpp;
+}
+
+
+void PlaneTask::flushOppContext(PlaneOppContext &ctx)
+{
+    if(ctx.m_Log.length()) traceStdLog(ctx.m_Log);
+    ctx.m_Log.clear();
+    if(ctx.m_bError) m_bError = true;
+    ctx.m_bError = false;
 }
 
 
@@ -2206,6 +2328,8 @@ void PlaneTask::storePOpp(PlaneOpp *pPOpp)
 {
     if(!pPOpp) return;
 
+    if(m_PlaneOppList.size()) pPOpp->setLineColor(m_PlaneOppList.back()->lineColor().darker(100));
+
     if(!pPOpp->isOut()) // discard failed visc interpolated opps
         m_pPlPolar->addPlaneOpPointData(pPOpp);
 
@@ -2307,7 +2431,11 @@ void PlaneTask::outputNDStabDerivatives(double u0, StabDerivatives const &SD)
 }
 
 
-void PlaneTask::computeControlDerivatives(double t7ctrl, double alphaeq, double u0, StabDerivatives &SD)
+/**
+ * Calculates the control derivatives by forward difference of the forces in the deflected positions.
+ * @param sigma the source strengths of the operating point
+ */
+void PlaneTask::computeControlDerivatives(double t7ctrl, double alphaeq, double u0, double const *sigma, StabDerivatives &SD)
 {
     Vector3d WindDirection, Force, Moment, V0, is, js, ks;
 
@@ -2315,10 +2443,6 @@ void PlaneTask::computeControlDerivatives(double t7ctrl, double alphaeq, double
     if      (m_pPlPolar->isQuadMethod())     N = m_pP4A->nPanels();
     else if (m_pPlPolar->isTriangleMethod()) N = m_pP3A->nPanels();
 
-    double const *sigma = nullptr;
-    if      (m_pPlPolar->isQuadMethod())     sigma = m_pP4A->m_Sigma.data();
-    else if (m_pPlPolar->isTriangleMethod()) sigma = m_pP3A->m_Sigma.data();
-
     // Define the stability axes and the freestream velocity field
     double cosa = cos(alphaeq*PI/180.0);
     double sina = sin(alphaeq*PI/180.0);
@@ -2330,48 +2454,47 @@ void PlaneTask::computeControlDerivatives(double t7ctrl, double alphaeq, double
 
     double DeltaCtrl = 0.001;
 
+    // First pass: make the RHS of each active control set, then solve them all in one back-substitution
+    int matsize = m_pPA->matSize();
+    std::vector<int> activectrl;
     for(int ie=0; ie<m_pPlPolar->nAVLCtrls(); ie++)
     {
-        traceStdLog("             Processing control set " + m_pPlPolar->AVLCtrl(ie).name() + EOLstr);
         SD.ControlNames[ie] = m_pPlPolar->AVLCtrl(ie).name();
         if(!m_pPlPolar->AVLCtrl(ie).hasActiveAngle())
         {
             SD.Xde[ie] = SD.Yde[ie] = SD.Zde[ie] = SD.Lde[ie] = SD.Mde[ie] = SD.Nde[ie] = 0.0;
-            traceStdLog("        No active gain... skipping\n\n");
             continue;
         }
+        activectrl.push_back(ie);
+    }
 
-        std::string outstring;
-        m_pPA->restorePanels();
-        if(m_pPlane->isXflType())
-        {
-            PlaneXfl *pPlaneXfl = dynamic_cast<PlaneXfl*>(m_pPlane);
-            if(m_pP4A)
-            {
-                setControlPositions(pPlaneXfl, m_pPlPolar, m_pP4A->m_Panel4, DeltaCtrl, ie, outstring);
-            }
-            else if(m_pP3A)
-            {
-                setControlPositions(pPlaneXfl, m_pPlPolar, m_pP3A->m_Panel3,
-                                    m_pP3A->m_pRefTriMesh->nodes(), DeltaCtrl, ie, outstring);
-            }
-        }
-        m_pPA->makeWakePanels(objects::windDirection(0,0), false);
-
-        //create the RHS
-//        traceStdLog("         Making the unit RHS vectors...\n");
-        std::vector<Vector3d> VField(N, V0);
-//        Vector3d Omega;
-//        m_pPA->makeUnitRHSVectors(); // could also use one RHS
-//        m_pPA->combineUnitRHS(m_pPA->m_cRHS, V0, Omega);
-
+    std::vector<double> ctrlRHS(activectrl.size()*matsize);
+    std::vector<Vector3d> VField(N, V0);
+    for(uint ic=0; ic<activectrl.size(); ic++)
+    {
+        setControlDeflection(activectrl.at(ic), DeltaCtrl);
         m_pPA->makeRHS(VField, m_pPA->m_cRHS, nullptr);
+        memcpy(ctrlRHS.data()+ic*matsize, m_pPA->m_cRHS.data(), matsize*sizeof(double));
+    }
 
-/*        std::string strong = "         Calculating the control derivatives\n\n";
-        traceStdLog(strong);*/
+    //LU solve
+    m_pPA->backSubRHSBatch(ctrlRHS.data(), int(activectrl.size()));
+
+    // Second pass: calculate the forces in the deflected positions
+    int ic=0;
+    for(int ie=0; ie<m_pPlPolar->nAVLCtrls(); ie++)
+    {
+        traceStdLog("             Processing control set " + m_pPlPolar->AVLCtrl(ie).name() + EOLstr);
+        if(!m_pPlPolar->AVLCtrl(ie).hasActiveAngle())
+        {
+            traceStdLog("        No active gain... skipping\n\n");
+            continue;
+        }
 
-        //LU solve
-        m_pPA->backSubRHS(m_pPA->m_cRHS);
+        setControlDeflection(ie, DeltaCtrl);
+        memcpy(m_pPA->m_cRHS.data(), ctrlRHS.data()+ic*matsize, matsize*sizeof(double));
+        ic++;
+        std::fill(VField.begin(), VField.end(), V0);
 
         // make node vertex array
         // only needed for triuniform method to align with TriLinAnalysis
@@ -2401,7 +2524,7 @@ void PlaneTask::computeControlDerivatives(double t7ctrl, double alphaeq, double
             }
 
             std::fill(VField.begin(), VField.end(), VInf);
-            m_pPA->computeOnBodyCp(VField, m_pPA->m_uVLocal, m_pPA->m_Cp);
+            m_pPA->computeOnBodyCp(VField, m_pPA->m_uVLocal, m_pPA->m_Cp.data());
             m_pPA->forces(muc, sigma, alphaeq, 0.0, CoG, m_pPlPolar->bFuseMi(), VField, Force, Moment);
         }
 
@@ -2419,6 +2542,28 @@ void PlaneTask::computeControlDerivatives(double t7ctrl, double alphaeq, double
 }
 
 
+/** Restores the panels and rotates the flaps and wings of the AVL-type control set iCtrl by deltactrl x gain */
+void PlaneTask::setControlDeflection(int iCtrl, double deltactrl)
+{
+    std::string outstring;
+    m_pPA->restorePanels();
+    if(m_pPlane->isXflType())
+    {
+        PlaneXfl *pPlaneXfl = dynamic_cast<PlaneXfl*>(m_pPlane);
+        if(m_pP4A)
+        {
+            setControlPositions(pPlaneXfl, m_pPlPolar, m_pP4A->m_Panel4, deltactrl, iCtrl, outstring);
+        }
+        else if(m_pP3A)
+        {
+            setControlPositions(pPlaneXfl, m_pPlPolar, m_pP3A->m_Panel3,
+                                m_pP3A->m_pRefTriMesh->nodes(), deltactrl, iCtrl, outstring);
+        }
+    }
+    m_pPA->makeWakePanels(objects::windDirection(0,0), false);
+}
+
+
 /** Sets the angle positions of wings and flap for a stability analysis */
 void PlaneTask::setControlPositions(PlaneXfl const*pPlaneXfl, PlanePolar const*pWPolar,
                                     std::vector<Panel4> &panel4, double deltactrl,
@@ -2599,20 +2744,20 @@ bool PlaneTask::computeViscousDrag(WingXfl *pWing, double alpha, double beta, do
             if (tau<0.0) tau = 0.0; // redundant
             if (tau>1.0) tau = 1.0; // redundant
 
-            sd.m_Alpha_0[m] = Objects2d::getZeroLiftAngle(surf.foilA(), surf.foilB(), sd.m_Re[m], tau);
+            sd.m_Alpha_0[m] = m_PolarMesh.getZeroLiftAngle(surf.foilA(), surf.foilB(), sd.m_Re[m], tau);
 
             double CdA(0), CdB(0), XTrTopA(0), XTrTopB(0), XTrBotA(0), XTrBotB(0);
 
             if(pWPolar->isViscFromCl())
             {
-                CdA = Objects2d::getPlrPointFromCl(surf.foilA(), sd.m_Re.at(m), sd.m_Cl.at(m), Polar::CD, bOutRe, bOutVar);
-                CdB = Objects2d::getPlrPointFromCl(surf.foilB(), sd.m_Re.at(m), sd.m_Cl.at(m), Polar::CD, bOutRe, bOutVar);
+                CdA = m_PolarMesh.getPlrPointFromCl(surf.foilA(), sd.m_Re.at(m), sd.m_Cl.at(m), Polar::CD, bOutRe, bOutVar);
+                CdB = m_PolarMesh.getPlrPointFromCl(surf.foilB(), sd.m_Re.at(m), sd.m_Cl.at(m), Polar::CD, bOutRe, bOutVar);
 
-                XTrTopA = Objects2d::getPlrPointFromCl(surf.foilA(), sd.m_Re.at(m), sd.m_Cl.at(m), Polar::XTRTOP, bOutRe, bOutVar);
-                XTrTopB = Objects2d::getPlrPointFromCl(surf.foilB(), sd.m_Re.at(m), sd.m_Cl.at(m), Polar::XTRTOP, bOutRe, bOutVar);
+                XTrTopA = m_PolarMesh.getPlrPointFromCl(surf.foilA(), sd.m_Re.at(m), sd.m_Cl.at(m), Polar::XTRTOP, bOutRe, bOutVar);
+                XTrTopB = m_PolarMesh.getPlrPointFromCl(surf.foilB(), sd.m_Re.at(m), sd.m_Cl.at(m), Polar::XTRTOP, bOutRe, bOutVar);
 
-                XTrBotA = Objects2d::getPlrPointFromCl(surf.foilA(), sd.m_Re.at(m), sd.m_Cl.at(m), Polar::XTRBOT, bOutRe, bOutVar);
-                XTrBotB = Objects2d::getPlrPointFromCl(surf.foilB(), sd.m_Re.at(m), sd.m_Cl.at(m), Polar::XTRBOT, bOutRe, bOutVar);
+                XTrBotA = m_PolarMesh.getPlrPointFromCl(surf.foilA(), sd.m_Re.at(m), sd.m_Cl.at(m), Polar::XTRBOT, bOutRe, bOutVar);
+                XTrBotB = m_PolarMesh.getPlrPointFromCl(surf.foilB(), sd.m_Re.at(m), sd.m_Cl.at(m), Polar::XTRBOT, bOutRe, bOutVar);
 
                 if(bOutVar)
                 {
@@ -2624,14 +2769,14 @@ bool PlaneTask::computeViscousDrag(WingXfl *pWing, double alpha, double beta, do
             {
                 double aoa_effective = sd.m_Alpha_0.at(m) + (sd.m_Cl.at(m)/2.0/PI) *180.0/PI - m_gamma.at(iStation0+m);
 
-                CdA = Objects2d::getPlrPointFromAlpha(surf.foilA(), sd.m_Re.at(m), aoa_effective, Polar::CD, bOutRe, bOutVar);
-                CdB = Objects2d::getPlrPointFromAlpha(surf.foilB(), sd.m_Re.at(m), aoa_effective, Polar::CD, bOutRe, bOutVar);
+                CdA = m_PolarMesh.getPlrPointFromAlpha(surf.foilA(), sd.m_Re.at(m), aoa_effective, Polar::CD, bOutRe, bOutVar);
+                CdB = m_PolarMesh.getPlrPointFromAlpha(surf.foilB(), sd.m_Re.at(m), aoa_effective, Polar::CD, bOutRe, bOutVar);
 
-                XTrTopA = Objects2d::getPlrPointFromAlpha(surf.foilA(), sd.m_Re.at(m), aoa_effective, Polar::XTRTOP, bOutRe, bOutVar);
-                XTrTopB = Objects2d::getPlrPointFromAlpha(surf.foilB(), sd.m_Re.at(m), aoa_effective, Polar::XTRTOP, bOutRe, bOutVar);
+                XTrTopA = m_PolarMesh.getPlrPointFromAlpha(surf.foilA(), sd.m_Re.at(m), aoa_effective, Polar::XTRTOP, bOutRe, bOutVar);
+                XTrTopB = m_PolarMesh.getPlrPointFromAlpha(surf.foilB(), sd.m_Re.at(m), aoa_effective, Polar::XTRTOP, bOutRe, bOutVar);
 
-                XTrBotA = Objects2d::getPlrPointFromAlpha(surf.foilA(), sd.m_Re.at(m), aoa_effective, Polar::XTRBOT, bOutRe, bOutVar);
-                XTrBotB = Objects2d::getPlrPointFromAlpha(surf.foilB(), sd.m_Re.at(m), aoa_effective, Polar::XTRBOT, bOutRe, bOutVar);
+                XTrBotA = m_PolarMesh.getPlrPointFromAlpha(surf.foilA(), sd.m_Re.at(m), aoa_effective, Polar::XTRBOT, bOutRe, bOutVar);
+                XTrBotB = m_PolarMesh.getPlrPointFromAlpha(surf.foilB(), sd.m_Re.at(m), aoa_effective, Polar::XTRBOT, bOutRe, bOutVar);
 
                 if(bOutVar)
                 {
@@ -2684,7 +2829,7 @@ bool PlaneTask::computeViscousDrag(WingXfl *pWing, double alpha, double beta, do
 }
 
 
-bool PlaneTask::computeSurfaceDragOTF(Surface const &surf, int iStartStation, double theta, SpanDistribs &spandist)
+bool PlaneTask::computeSurfaceDragOTF(Surface const &surf, int iStartStation, double theta, SpanDistribs &spandist, std::string &report) const
 {
     Foil foilA, foilB;
     foilA.copy(surf.foilA(), true);
@@ -2731,8 +2876,6 @@ bool PlaneTask::computeSurfaceDragOTF(Surface const &surf, int iStartStation, do
     LeftSidePolar.setXTripTop(XTrTop);
     LeftSidePolar.setXTripBot(XTrBot);
 
-    XFoilTask *pLeftTask = new XFoilTask();
-    pLeftTask->initialize(foilA, &LeftSidePolar, false);
 
     // Process right side foil
     Polar RightSidePolar;
@@ -2760,20 +2903,34 @@ bool PlaneTask::computeSurfaceDragOTF(Surface const &surf, int iStartStation, do
     RightSidePolar.setXTripBot(XTrBot);
 
 
+    // fill the points already calculated from the cache, and run XFoil on the others only
+    Polar LeftOTFPolar, RightOTFPolar;
+    std::vector<int> LeftIndex, RightIndex;
+    int nHits = XFoilCache::fetch(foilA, LeftSidePolar,  LeftOTFPolar,  LeftIndex);
+    nHits    += XFoilCache::fetch(foilB, RightSidePolar, RightOTFPolar, RightIndex);
+    int nMisses = LeftOTFPolar.dataSize() + RightOTFPolar.dataSize();
+
+    XFoilTask *pLeftTask = new XFoilTask();
+    pLeftTask->initialize(foilA, &LeftOTFPolar, false);
+
     XFoilTask *pRightTask = new XFoilTask();
-    pRightTask->initialize(foilB, &RightSidePolar, false);
+    pRightTask->initialize(foilB, &RightOTFPolar, false);
 
 //    computeSectionDragOTF(pLeftTask);
 //    computeSectionDragOTF(pRightTask);
 
-    std::thread leftthread  = std::thread(&PlaneTask::computeSectionDragOTF, this, pLeftTask);
-    std::thread rightthread = std::thread(&PlaneTask::computeSectionDragOTF, this, pRightTask);
-    leftthread.join();
-    rightthread.join();
+    std::thread leftthread, rightthread;
+    if(LeftOTFPolar.dataSize())  leftthread  = std::thread(&PlaneTask::computeSectionDragOTF, this, pLeftTask);
+    if(RightOTFPolar.dataSize()) rightthread = std::thread(&PlaneTask::computeSectionDragOTF, this, pRightTask);
+    if(leftthread.joinable())  leftthread.join();
+    if(rightthread.joinable()) rightthread.join();
 
     delete pLeftTask;
     delete pRightTask;
 
+    XFoilCache::store(foilA, LeftOTFPolar,  LeftIndex,  LeftSidePolar);
+    XFoilCache::store(foilB, RightOTFPolar, RightIndex, RightSidePolar);
+
 
     bool bCv = true;
     QString logg;
@@ -2787,7 +2944,7 @@ bool PlaneTask::computeSurfaceDragOTF(Surface const &surf, int iStartStation, do
         if (tau>1.0) tau = 1.0; // redundant
 
         /** @todo what's the use + wrong if flap*/
-        spandist.m_Alpha_0[iStation] = Objects2d::getZeroLiftAngle(surf.foilA(), surf.foilB(), spandist.m_Re.at(iStation), tau);
+        spandist.m_Alpha_0[iStation] = m_PolarMesh.getZeroLiftAngle(surf.foilA(), surf.foilB(), spandist.m_Re.at(iStation), tau);
 
         // interpolate
 
@@ -2814,17 +2971,19 @@ bool PlaneTask::computeSurfaceDragOTF(Surface const &surf, int iStartStation, do
         if(s_bCancel) break;
     }
 
-    QString report = QString::asprintf("                 ...done surface %d", surf.index());
+    QString strange = QString::asprintf("                 ...done surface %d", surf.index());
+    if(XFoilCache::isEnabled())
+        strange += QString::asprintf(" - OTF cache hits/misses: %d/%d", nHits, nMisses);
     if(bCv)
     {
-        report += EOLch;
+        strange += EOLch;
     }
     else
     {
-        report += " - OTF failures:" + EOLch + logg;
+        strange += " - OTF failures:" + EOLch + logg;
     }
 
-    traceLog(report);
+    report = strange.toStdString();
 
     return bCv;
 }
@@ -2861,7 +3020,7 @@ bool PlaneTask::computeSectionDragOTF(XFoilTask *pTask) const
 
 bool PlaneTask::computeViscousDragOTF(WingXfl *pWing, double alpha, double beta, double QInf,
                                       PlanePolar const *pWPolar, Vector3d const &cog, AngleControl const &TEFlapAngles, SpanDistribs &SpanResFF,
-                                      std::string &logmsg)
+                                      std::string &logmsg) const
 {
     // on the fly viscous drag calculation
     // for each surface, calulate the drag at each end foil for each lift and reynolds at each span station
@@ -2885,7 +3044,7 @@ bool PlaneTask::computeViscousDragOTF(WingXfl *pWing, double alpha, double beta,
     int m=0;// wing station counter
 
     std::vector<std::thread> threads;
-
+    std::vector<std::string> reports(pWing->nSurfaces()); // one per surface, output in order once all threads have joined
 
     for (int jsurf=0; jsurf<pWing->nSurfaces(); jsurf++)
     {
@@ -2893,13 +3052,14 @@ bool PlaneTask::computeViscousDragOTF(WingXfl *pWing, double alpha, double beta,
         if(surf.hasTEFlap()) theta = TEFlapAngles.value(iCtrl++);
         else                 theta = 0.0;
 
-        threads.push_back(std::thread(&PlaneTask::computeSurfaceDragOTF, this, surf, m, theta, std::ref(SpanResFF)));
-        //computeSurfaceDragOTF(surf, m, theta, std::ref(SpanResFF));
+        threads.push_back(std::thread(&PlaneTask::computeSurfaceDragOTF, this, std::cref(surf), m, theta, std::ref(SpanResFF), std::ref(reports[jsurf])));
         m += surf.NYPanels();
     }
 
     for(int isurf=0; isurf<pWing->nSurfaces(); isurf++)        threads[isurf].join();
 
+    for(std::string const &report : reports) logg += QString::fromStdString(report);
+
 
     SpanDistribs &sd = SpanResFF;
     bool bCv = true;
@@ -3056,10 +3216,11 @@ void PlaneTask::makeVortonRow(int qrhs)
     }
 
     // save the new vortons
-    m_pPA->m_Vorton = newvortons;
+    m_pPA->setVortons(newvortons);
 }
 
 
+/** Returns the velocity induced at point C by the doublet and source densities of the last calculated operating point */
 void PlaneTask::getVelocityVector(Vector3d const &C, double coreradius, bool bMultiThread, Vector3d &velocity) const
 {
     bool bWakeOnly=false;
@@ -3085,53 +3246,63 @@ bool PlaneTask::setLinearSolution()
 
     if (isCancelled()) return true;
 
-    traceStdLog("   Making the influence matrix...");
-    m_pPA->makeInfluenceMatrix();
-
-    end = std::chrono::system_clock::now();
-    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-    start = end;
-    strange = QString::asprintf("       done in %.3f s\n", double(duration)/1000.0);
-
-    traceLog(strange);
-
-    if(m_pPA->m_bMatrixError)
+    uint64_t matrixkey = m_pPA->matrixKey();
+    if(m_pPA->fetchFactorization(matrixkey))
     {
-        m_bError = true;
-        return false;
+        traceStdLog("   Reusing the LU factorization of a previous analysis\n");
     }
-    if (isCancelled()) return true;
-
-    if(!m_pPlPolar->isVLM())
+    else
     {
-        traceStdLog("   Adding the wake's contribution...");
-        m_pPA->addWakeContribution();
-
+        traceStdLog("   Making the influence matrix...");
+        m_pPA->makeInfluenceMatrix();
 
         end = std::chrono::system_clock::now();
         duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
         start = end;
-        strange = QString::asprintf("    done in %.3f s\n", double(duration)/1000.0);
+        strange = QString::asprintf("       done in %.3f s\n", double(duration)/1000.0);
+
         traceLog(strange);
 
-        if(m_pPA->m_bMatrixError) return false;
-    }
-    if (isCancelled()) return true;
+        if(m_pPA->m_bMatrixError)
+        {
+            m_bError = true;
+            return false;
+        }
+        if (isCancelled()) return true;
 
-    traceStdLog("   LAPACK - LU factorization...");
-    if (!m_pPA->LUfactorize())
-    {
-        traceStdLog(" singular matrix, aborting\n");
+        if(!m_pPlPolar->isVLM())
+        {
+            traceStdLog("   Adding the wake's contribution...");
+            m_pPA->addWakeContribution();
 
-        m_bError = true;
-        return false;
-    }
 
-    end = std::chrono::system_clock::now();
-    duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
-    start = end;
-    strange = QString::asprintf("         done in %.3f s\n", double(duration)/1000.0);
-    traceLog(strange);
+            end = std::chrono::system_clock::now();
+            duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+            start = end;
+            strange = QString::asprintf("    done in %.3f s\n", double(duration)/1000.0);
+            traceLog(strange);
+
+            if(m_pPA->m_bMatrixError) return false;
+        }
+        if (isCancelled()) return true;
+
+        traceStdLog("   LAPACK - LU factorization...");
+        if (!m_pPA->LUfactorize())
+        {
+            traceStdLog(" singular matrix, aborting\n");
+
+            m_bError = true;
+            return false;
+        }
+
+        end = std::chrono::system_clock::now();
+        duration = std::chrono::duration_cast<std::chrono::milliseconds>(end - start).count();
+        start = end;
+        strange = QString::asprintf("         done in %.3f s\n", double(duration)/1000.0);
+        traceLog(strange);
+
+        m_pPA->storeFactorization(matrixkey);
+    }
     if (isCancelled()) return true;
 
     traceStdLog("   Back-substituting RHS...");
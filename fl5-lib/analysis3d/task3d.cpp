@@ -31,7 +31,6 @@
 //#define _DISABLE_CONSTEXPR_MUTEX_CONSTRUCTOR
 
 #include <iostream>
-#include <thread>
 
 #include <task3d.h>
 
@@ -150,19 +149,24 @@ void Task3d::setAnalysisStatus(xfl::enumAnalysisStatus status)
 }
 
 
+/**
+ * Advects the vortons with the local velocity using a RK2 scheme.
+ * The velocities of all the vortons are evaluated at once at each stage of the scheme.
+ */
 void Task3d::advectVortons(double alpha, double beta, double QInf, int qrhs)
 {
     if(!m_pPolar3d->bVortonWake()) return;
 
+    double const *Mu(nullptr), *Sigma(nullptr);
     if(m_pP4A)
     {
-        tmp_Mu    = m_pP4A->m_Mu.data()    + qrhs*m_pP4A->nPanels();
-        tmp_Sigma = m_pP4A->m_Sigma.data() + qrhs*m_pP4A->nPanels();
+        Mu    = m_pP4A->m_Mu.data()    + qrhs*m_pP4A->nPanels();
+        Sigma = m_pP4A->m_Sigma.data() + qrhs*m_pP4A->nPanels();
     }
     else if(m_pP3A)
     {
-        tmp_Mu    = m_pP3A->m_Mu.data()    + qrhs*3*m_pP3A->nPanels();
-        tmp_Sigma = m_pP3A->m_Sigma.data() + qrhs  *m_pP3A->nPanels();
+        Mu    = m_pP3A->m_Mu.data()    + qrhs*3*m_pP3A->nPanels();
+        Sigma = m_pP3A->m_Sigma.data() + qrhs  *m_pP3A->nPanels();
     }
     else return;
 
@@ -170,88 +174,35 @@ void Task3d::advectVortons(double alpha, double beta, double QInf, int qrhs)
     // duplicate the existing vortons which will be replaced all at once at the end of the procedure
     std::vector<std::vector<Vorton>> newvortons = m_pPA->m_Vorton;
     double dl = m_pPolar3d->vortonL0() * m_pPolar3d->referenceChordLength(); //m
-    tmp_dt = dl/QInf;
-    tmp_VInf = objects::windDirection(alpha, beta)*QInf;
-    tmp_vortonwakelength = m_pPolar3d->VPWMaxLength()*m_pPolar3d->referenceChordLength();
+    double dt = dl/QInf;
+    Vector3d VInf = objects::windDirection(alpha, beta)*QInf;
+    double vortonwakelength = m_pPolar3d->VPWMaxLength()*m_pPolar3d->referenceChordLength();
 
+    std::vector<Vorton*> active;
+    for(std::vector<Vorton> &row : newvortons)
+        for(Vorton &vtn : row)
+            if(vtn.isActive()) active.push_back(&vtn);
 
-    if(PanelAnalysis::s_bMultiThread)
-    {
-        std::vector<std::thread> threads;
-
-        for(uint irow=0; irow<newvortons.size(); irow++)
-        {
-            threads.push_back(std::thread(&Task3d::advectVortonRow, this, &newvortons[irow]));
-        }
+    int nVtn = int(active.size());
+    std::vector<Vector3d> P(nVtn), VT(nVtn);
+    for(int iv=0; iv<nVtn; iv++) P[iv] = active[iv]->position();
 
-        for(uint irow=0; irow<newvortons.size(); irow++)
-        {
-            threads[irow].join();
-        }
-//        std::cout << "Task3d::advectVortons joined all " << newvortons.size() << " threads" <<std::endl;
+    //RK2
+    m_pPA->getVelocityVectors(nVtn, P.data(), Mu, Sigma, VT.data(), Vortex::coreRadius(), false, PanelAnalysis::isMultiThreaded());
+    for(int iv=0; iv<nVtn; iv++) P[iv] += (VInf + VT[iv])*dt*dt/2.0;
 
-    }
-    else
+    m_pPA->getVelocityVectors(nVtn, P.data(), Mu, Sigma, VT.data(), Vortex::coreRadius(), false, PanelAnalysis::isMultiThreaded());
+    for(int iv=0; iv<nVtn; iv++)
     {
-        for(uint irow=0; irow<newvortons.size(); irow++)
-        {
-            advectVortonRow(&newvortons[irow]);
-        }
+        Vorton &vtn = *active[iv];
+        vtn.translate((VInf+VT[iv])*dt);
+
+        if(vtn.position().norm()>vortonwakelength)
+            vtn.setActive(false);
     }
 
     // save the new vortons
-    m_pPA->m_Vorton = newvortons;
-
-//    qDebug("Vorton advect %2d elapsed: %9.3f s", m_pPA->m_Vorton.size(), double(t.elapsed())/1000.0);
-}
-
-
-void Task3d::advectVortonRow(std::vector<Vorton> *thisrow)
-{
-    Vector3d VT1, VT2, translation, P1;
-
-    for(uint iv=0; iv<thisrow->size(); iv++)
-    {
-        // convect-translate the vorton
-        Vorton &vtn = (*thisrow)[iv];
-        if(vtn.isActive())
-        {
-            Vector3d const &P0 = vtn.position();
-
-            //RK2
-            if(m_pPA)  m_pPA->getVelocityVector(P0, tmp_Mu, tmp_Sigma, VT1, Vortex::coreRadius(), false, false);
-            translation.set((tmp_VInf + VT1)*tmp_dt);
-            P1.set(P0 + translation*tmp_dt/2.0);
-
-            if(m_pPA)  m_pPA->getVelocityVector(P1, tmp_Mu, tmp_Sigma, VT2, Vortex::coreRadius(), false, false);
-            translation.set((tmp_VInf+VT2)*tmp_dt);
-            vtn.translate(translation);
-
-            if(vtn.position().norm()>tmp_vortonwakelength)
-                vtn.setActive(false);
-
-/*                if(s_bVortonStretch)
-            {
-                //update the vorton's vorticity
-                // Youjiang Wang eq.13
-                // d(omega)/dt = grad(U).omega + nu.Laplace(w)
-                // second term of the equation is not present in the Willis paper;
-                // use the straightforward Euler
-                // include the velocity gradient induced by the bound vortices?
-                m_pPA->getVortonVelocityGradient(P0, G);
-
-                omega.set(vtn.vortex());
-
-                domx = (G[0]*omega.x + G[1]*omega.y + G[2]*omega.z)*dt;
-                domy = (G[3]*omega.x + G[4]*omega.y + G[5]*omega.z)*dt;
-                domz = (G[6]*omega.x + G[7]*omega.y + G[8]*omega.z)*dt;
-                omega.x += domx;
-                omega.y += domy;
-                omega.z += domz;
-                vtn.setVortex(omega);
-            }*/
-        }
-    }
+    m_pPA->setVortons(newvortons);
 }
 
 
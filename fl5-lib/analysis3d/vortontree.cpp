@@ -0,0 +1,309 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#define _MATH_DEFINES_DEFINED
+
+#include <algorithm>
+
+#include <vortontree.h>
+
+#include <constants.h>
+
+
+bool VortonTree::s_bEnabled(true);
+double VortonTree::s_Theta(0.4);
+int VortonTree::s_LeafSize(16);
+int VortonTree::s_MinVortons(256);
+
+
+VortonTree::VortonTree()
+{
+}
+
+
+void VortonTree::clear()
+{
+    m_Node.clear();
+    m_Vorton.clear();
+}
+
+
+/**
+ * Builds the octree on the active vortons of all the rows.
+ * The tree is left empty if it is disabled or if the number of vortons is too small
+ * for the tree to be faster than the direct evaluation.
+ */
+void VortonTree::build(std::vector<std::vector<Vorton>> const &vortons)
+{
+    clear();
+    if(!s_bEnabled) return;
+
+    size_t nVortons = 0;
+    for(std::vector<Vorton> const &row : vortons) nVortons += row.size();
+    if(int(nVortons)<s_MinVortons) return;
+
+    m_Vorton.reserve(nVortons);
+    for(std::vector<Vorton> const &row : vortons)
+    {
+        for(Vorton const &vtn : row)
+            if(vtn.isActive()) m_Vorton.push_back(vtn);
+    }
+    if(int(m_Vorton.size())<s_MinVortons)
+    {
+        m_Vorton.clear();
+        return;
+    }
+
+    makeNode(0, int(m_Vorton.size()), 0);
+}
+
+
+int VortonTree::makeNode(int iStart, int iEnd, int depth)
+{
+    TreeNode node;
+    node.m_iStart = iStart;
+    node.m_iEnd   = iEnd;
+
+    Vector3d bmin( 1.e10,  1.e10,  1.e10);
+    Vector3d bmax(-1.e10, -1.e10, -1.e10);
+    double weight = 0.0;
+    Vector3d C;
+    for(int i=iStart; i<iEnd; i++)
+    {
+        Vorton const &vtn = m_Vorton.at(i);
+        Vector3d const &pt = vtn.position();
+        double w = vtn.circulation();
+        C += pt*w;
+        weight += w;
+        node.m_Omega += vtn.vortex();
+        bmin.x = std::min(bmin.x, pt.x);   bmax.x = std::max(bmax.x, pt.x);
+        bmin.y = std::min(bmin.y, pt.y);   bmax.y = std::max(bmax.y, pt.y);
+        bmin.z = std::min(bmin.z, pt.z);   bmax.z = std::max(bmax.z, pt.z);
+    }
+    if(weight>PRECISION) node.m_Center = C/weight;
+    else                 node.m_Center = (bmin+bmax)*0.5;
+
+    node.m_Radius = 0.0;
+    for(int i=iStart; i<iEnd; i++)
+    {
+        Vorton const &vtn = m_Vorton.at(i);
+        Vector3d e = vtn.position()-node.m_Center;
+        Vector3d const &omega = vtn.vortex();
+        double ev[]{e.x, e.y, e.z};
+        double ov[]{omega.x, omega.y, omega.z};
+        for(int a=0; a<3; a++)
+        {
+            for(int b=0; b<3; b++)
+            {
+                node.m_Moment[3*a+b] += ev[a]*ov[b];
+                for(int k=0; k<3; k++) node.m_Quadrupole[9*a+3*b+k] += ev[a]*ev[b]*ov[k];
+            }
+        }
+        node.m_Radius = std::max(node.m_Radius, e.norm());
+    }
+
+    int iNode = int(m_Node.size());
+    m_Node.push_back(node);
+
+    if(iEnd-iStart<=s_LeafSize || depth>=32) return iNode;
+
+    // sort the vortons in octants around the center of the bounding box
+    Vector3d mid = (bmin+bmax)*0.5;
+    auto octant = [&mid](Vorton const &vtn)
+    {
+        Vector3d const &pt = vtn.position();
+        return (pt.x>mid.x ? 1 : 0) + (pt.y>mid.y ? 2 : 0) + (pt.z>mid.z ? 4 : 0);
+    };
+    std::stable_sort(m_Vorton.begin()+iStart, m_Vorton.begin()+iEnd, [&](Vorton const &a, Vorton const &b){return octant(a)<octant(b);});
+
+    int first = iStart;
+    int nChildren = 0;
+    int child[8]{-1,-1,-1,-1,-1,-1,-1,-1};
+    int childStart[8]{0}, childEnd[8]{0};
+    while(first<iEnd)
+    {
+        int oct = octant(m_Vorton.at(first));
+        int last = first;
+        while(last<iEnd && octant(m_Vorton.at(last))==oct) last++;
+        childStart[nChildren] = first;
+        childEnd[nChildren]   = last;
+        nChildren++;
+        first = last;
+    }
+
+    // all the vortons are in the same octant, i.e. they are coincident
+    if(nChildren<=1) return iNode;
+
+    for(int ic=0; ic<nChildren; ic++)
+    {
+        // the node array may be reallocated, so do not keep a reference to the parent node
+        child[ic] = makeNode(childStart[ic], childEnd[ic], depth+1);
+    }
+    for(int ic=0; ic<nChildren; ic++) m_Node[iNode].m_iChild[ic] = child[ic];
+
+    return iNode;
+}
+
+
+/**
+ * A node is in the far field if it is seen under a small angle and if all its vortons are out of the
+ * mollification core, where the kernel varies too much to be represented by the node's moments.
+ */
+bool VortonTree::isFarField(TreeNode const &node, Vector3d const &C, double coresize) const
+{
+    double dist = node.m_Center.distanceTo(C);
+    return node.m_Radius < s_Theta*dist && dist-node.m_Radius > 4.0*coresize;
+}
+
+
+/**
+ * Adds the velocity induced by the vortons at point C to V.
+ * The far field nodes are evaluated with their monopole, dipole and quadrupole terms;
+ * the mollification factor is evaluated at the distance of the node's center.
+ */
+void VortonTree::velocity(Vector3d const &C, double coresize, Vector3d &V) const
+{
+    if(m_Node.empty()) return;
+
+    Vector3d VV;
+    int stack[8*34];
+    int nStack = 0;
+    stack[nStack++] = 0;
+    while(nStack>0)
+    {
+        TreeNode const &node = m_Node.at(stack[--nStack]);
+        if(isFarField(node, C, coresize))
+        {
+            double sx = C.x-node.m_Center.x;
+            double sy = C.y-node.m_Center.y;
+            double sz = C.z-node.m_Center.z;
+            double r2 = sx*sx + sy*sy + sz*sz;
+            double r = sqrt(r2);
+            if(r<1.e-6) continue;
+            double r3 = r2*r;
+            double r5 = r3*r2;
+
+            // monopole: K x Omega, with K=-s/r^3
+            double Kx = -sx/r3, Ky = -sy/r3, Kz = -sz/r3;
+            Vector3d const &O = node.m_Omega;
+            double vx = Ky*O.z - Kz*O.y;
+            double vy = Kz*O.x - Kx*O.z;
+            double vz = Kx*O.y - Ky*O.x;
+
+            // dipole: -sum (J.e_i) x omega_i, with J_ab = dK_a/ds_b, using A = J.M
+            double s[]{sx, sy, sz};
+            double J[9], A[9];
+            for(int a=0; a<3; a++)
+                for(int b=0; b<3; b++) J[3*a+b] = (a==b ? -1.0/r3 : 0.0) + 3.0*s[a]*s[b]/r5;
+            for(int a=0; a<3; a++)
+                for(int k=0; k<3; k++)
+                    A[3*a+k] = J[3*a]*node.m_Moment[k] + J[3*a+1]*node.m_Moment[3+k] + J[3*a+2]*node.m_Moment[6+k];
+            vx -= A[5]-A[7];
+            vy -= A[6]-A[2];
+            vz -= A[1]-A[3];
+
+            // quadrupole: 1/2 sum (H:e_i.e_i) x omega_i, with H_abc = d2K_a/ds_b.ds_c, using B = H:Q/2
+            double r7 = r5*r2;
+            double B[9]{0,0,0,0,0,0,0,0,0};
+            for(int a=0; a<3; a++)
+            {
+                for(int b=0; b<3; b++)
+                {
+                    for(int c=0; c<3; c++)
+                    {
+                        double h = 3.0*((a==b ? s[c] : 0.0) + (a==c ? s[b] : 0.0) + (b==c ? s[a] : 0.0))/r5 - 15.0*s[a]*s[b]*s[c]/r7;
+                        double const *q = node.m_Quadrupole + 9*b + 3*c;
+                        B[3*a]   += 0.5*h*q[0];
+                        B[3*a+1] += 0.5*h*q[1];
+                        B[3*a+2] += 0.5*h*q[2];
+                    }
+                }
+            }
+            vx += B[5]-B[7];
+            vy += B[6]-B[2];
+            vz += B[1]-B[3];
+
+            double f = 1.0/4.0/PI;
+            if(coresize>0.0) f *= m_Vorton.front().mollifiedInt(r/coresize);
+            V.x += vx*f;
+            V.y += vy*f;
+            V.z += vz*f;
+        }
+        else if(node.isLeaf())
+        {
+            for(int i=node.m_iStart; i<node.m_iEnd; i++)
+            {
+                m_Vorton.at(i).inducedVelocity(C, coresize, VV);
+                V.x += VV.x;
+                V.y += VV.y;
+                V.z += VV.z;
+            }
+        }
+        else
+        {
+            for(int ic=0; ic<8 && node.m_iChild[ic]>=0; ic++) stack[nStack++] = node.m_iChild[ic];
+        }
+    }
+}
+
+
+/**
+ * Adds the velocity gradient induced by the vortons at point C to G.
+ * G is a 3x3 tensor such that g_ij = dV_j/dx_i.
+ * The far field nodes are evaluated with their monopole term only.
+ */
+void VortonTree::velocityGradient(Vector3d const &C, double coresize, double *G) const
+{
+    if(m_Node.empty()) return;
+
+    double g[9];
+    Vorton monopole;
+    int stack[8*34];
+    int nStack = 0;
+    stack[nStack++] = 0;
+    while(nStack>0)
+    {
+        TreeNode const &node = m_Node.at(stack[--nStack]);
+        if(isFarField(node, C, coresize))
+        {
+            monopole.setPosition(node.m_Center);
+            monopole.setVortex(node.m_Omega);
+            monopole.velocityGradient(C, coresize, g);
+            for(int k=0; k<9; k++) G[k] += g[k];
+        }
+        else if(node.isLeaf())
+        {
+            for(int i=node.m_iStart; i<node.m_iEnd; i++)
+            {
+                m_Vorton.at(i).velocityGradient(C, coresize, g);
+                for(int k=0; k<9; k++) G[k] += g[k];
+            }
+        }
+        else
+        {
+            for(int ic=0; ic<8 && node.m_iChild[ic]>=0; ic++) stack[nStack++] = node.m_iChild[ic];
+        }
+    }
+}
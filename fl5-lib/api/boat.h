@@ -118,6 +118,8 @@ class FL5LIB_EXPORT Boat : public fl5Object
 
 
         void rotateMesh(const BoatPolar *pBtPolar, double phi, double Ry, double ctrl, std::vector<Panel3> &panels) const;
+        void rotateSails(const BoatPolar *pBtPolar, double ctrl, std::vector<Panel3> &panels) const;
+        void rotateBody(const BoatPolar *pBtPolar, double phi, double Ry, std::vector<Panel3> &panels) const;
 
 
     private:
@@ -33,6 +33,9 @@ namespace xfl
     enum enumBC {DIRICHLET, NEUMANN};
     enum enumRefDimension {PLANFORM, PROJECTED, CUSTOM, AUTODIMS}; // AUTO is for sails
 
+    /** @enum The methods available to solve the linear system of the panel analyses. */
+    enum enumMatrixSolver {DENSELU, BARNESHUT, GMRES, BICGSTAB, HMATRIX, OUTOFCORE};
+
     /** @enum The different types of wings available for a PlaneXfl. */
     enum enumType {Main, Elevator, Fin, OtherWing};
 }
@@ -76,6 +76,9 @@ namespace geom
 
     FL5LIB_EXPORT double basis(int i, int deg, double t, const double *knots);
     FL5LIB_EXPORT double basisDerivative(int i, int deg, double t, const double *knots);
+    FL5LIB_EXPORT int findKnotSpan(int nCtrl, int deg, double t, double const *knots);
+    FL5LIB_EXPORT void basisFunctions(int span, int deg, double t, double const *knots, double *N, double *dN=nullptr);
+    FL5LIB_EXPORT void spanBasis(int nCtrl, int deg, double t, double const *knots, int &first, int &count, double *N, double *dN=nullptr);
 
     FL5LIB_EXPORT void makeNurbsTriangulation(NURBSSurface const &nurbs, int nx, int nh, std::vector<Triangle3d> &triangles);
 
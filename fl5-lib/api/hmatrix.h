@@ -0,0 +1,139 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#pragma once
+
+#include <functional>
+#include <vector>
+
+#include <fl5lib_global.h>
+#include <vector3d.h>
+
+
+/**
+ * @brief The HMatrix class is a hierarchical storage of the influence matrix of the panel methods.
+ *
+ * The panels are organized in a binary cluster tree built on their centroids.
+ * The matrix is partitioned in blocks of pairs of clusters:
+ *   - the admissible blocks, i.e. the pairs of clusters which are far from each other,
+ *     are numerically low rank and are stored as the product U.V of two thin matrices
+ *     built by adaptive cross approximation (ACA) with partial pivoting;
+ *   - the other blocks are stored as dense matrices.
+ * Only a few rows and columns of each admissible block are calculated, so that
+ * memory and build time grow as N.log(N) instead of N².
+ *
+ * The wake's contribution to the trailing edge panels spans the full columns of these panels,
+ * and is stored separately as a dense block of columns.
+ *
+ * The linear system is solved using GMRES preconditioned with the inverted diagonal leaf blocks.
+ */
+class FL5LIB_EXPORT HMatrix
+{
+    public:
+        /** The function which returns the nBasis x nBasis block of influences of panel k on panel i, row-major; returns false in case of error */
+        typedef std::function<bool(int i, int k, double *block)> blockGenerator;
+
+    private:
+        struct Cluster
+        {
+            int m_iStart=0;        /**< the index of the cluster's first panel in the permutation array */
+            int m_iEnd=0;          /**< the index past the cluster's last panel in the permutation array */
+            Vector3d m_Min;        /**< the lower corner of the cluster's bounding box */
+            Vector3d m_Max;        /**< the upper corner of the cluster's bounding box */
+            int m_iChild[2]{-1,-1};
+            bool isLeaf() const {return m_iChild[0]<0;}
+            int nPanels() const {return m_iEnd-m_iStart;}
+            double diameter() const {return m_Min.distanceTo(m_Max);}
+        };
+
+        struct Block
+        {
+            int m_iRowCluster=-1;
+            int m_iColCluster=-1;
+            bool m_bLowRank=false;
+            int m_Rank=0;
+            std::vector<double> m_U;  /**< low rank blocks: the nRows x rank matrix, column-major; dense blocks: the nRows x nCols matrix, row-major */
+            std::vector<double> m_V;  /**< low rank blocks: the rank x nCols matrix, row-major */
+        };
+
+    public:
+        HMatrix();
+
+        void clear();
+        bool isBuilt() const {return m_nRows>0;}
+        int size() const {return m_nRows;}
+
+        bool build(std::vector<Vector3d> const &pts, std::vector<double> const &radius, int nBasis,
+                   blockGenerator const &generator, std::vector<int> const &wakepanels, int nThreads);
+        void addWakeCoef(int row, int col, double value);
+        bool makePreconditioner();
+
+        void matVec(double const *x, double *y) const;
+        void preconditioner(double const *x, double *y) const;
+
+        double memorySize() const;
+        int nLowRankBlocks() const;
+        int nDenseBlocks() const;
+        double averageRank() const;
+
+        static void setEta(double eta) {s_Eta=eta;}
+        static double eta() {return s_Eta;}
+        static void setLeafSize(int n) {s_LeafSize=n;}
+        static int leafSize() {return s_LeafSize;}
+        static void setACATolerance(double tol) {s_ACATolerance=tol;}
+        static double ACATolerance() {return s_ACATolerance;}
+
+    private:
+        int makeCluster(std::vector<Vector3d> const &pts, std::vector<double> const &radius, int iStart, int iEnd, int depth);
+        void makeBlocks(int iRow, int iCol);
+        bool isAdmissible(Cluster const &rc, Cluster const &cc) const;
+        void fillBlocks(int iBlock0, int iBlock1, blockGenerator const &generator);
+        bool fillDenseBlock(Block &block, blockGenerator const &generator) const;
+        bool fillLowRankBlock(Block &block, blockGenerator const &generator) const;
+        bool blockRow(Block const &block, int r, blockGenerator const &generator, double *row) const;
+        bool blockColumn(Block const &block, int c, blockGenerator const &generator, double *col) const;
+        void matVecThread(int iThread, int nThreads, double const *x, double *y) const;
+
+    private:
+        int m_nBasis;          /**< the number of unknowns per panel: 3 for the linear triangular method, 1 otherwise */
+        int m_nRows;           /**< the size of the linear system */
+        int m_nThreads;
+        mutable bool m_bError;
+
+        std::vector<Cluster> m_Cluster;   /**< the binary cluster tree; the root is the first cluster */
+        std::vector<int> m_Index;         /**< the permutation array of panel indexes, such that each cluster spans a contiguous range */
+        std::vector<Block> m_Block;       /**< the leaves of the block tree */
+
+        std::vector<int> m_WakeSlot;      /**< for each panel, its index in the array of wake columns, or -1 */
+        std::vector<int> m_WakePanel;     /**< the panels with wake contributions */
+        std::vector<double> m_WakeCoef;   /**< the dense block of wake contributions, nRows x (m_WakePanel.size()*nBasis) */
+
+        std::vector<int> m_PrecondCluster;           /**< the leaf clusters of the preconditioner's diagonal blocks */
+        std::vector<std::vector<double>> m_Precond;  /**< the inverted diagonal blocks */
+
+        static double s_Eta;           /**< the admissibility parameter: a block is low rank if min(diam) < eta*dist */
+        static int s_LeafSize;         /**< the max. number of panels in a leaf cluster */
+        static double s_ACATolerance;  /**< the relative precision of the cross approximation */
+};
+
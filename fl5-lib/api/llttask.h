@@ -30,6 +30,7 @@
 
 
 #include <enums_objects.h>
+#include <polarmesh.h>
 #include <task3d.h>
 #include <vector3d.h>
 #include <spandistribs.h>
@@ -112,6 +113,9 @@ class FL5LIB_EXPORT LLTTask : public Task3d
 
     private:
         double alphaInduced(int k) const;
+        void makeInfluenceCoefs();
+        double stationCl(int k, double Alpha, double ai) const;
+        void newtonStep(double Alpha, double maxa);
         double Beta(int m, int k) const;
         double Eta(int m) const;
         void computeWing(double QInf, double Alpha, std::string &ErrMessage);
@@ -135,6 +139,8 @@ class FL5LIB_EXPORT LLTTask : public Task3d
 
         std::vector<double> m_AoAList;   /**< The list of operating points to analyze */
 
+        PolarMesh m_PolarMesh;           /**< The index of the foil polars, made at the start of the task */
+
         bool m_bConverged;                          /**< true if the analysis has converged  */
         bool m_bWingOut;                            /**< true if the interpolation of viscous properties falls outside the polar mesh */
 
@@ -169,6 +175,11 @@ class FL5LIB_EXPORT LLTTask : public Task3d
         std::vector<double> m_XTrTop;                   /**< Upper transition location at the span stations */
         std::vector<double> m_XTrBot;                   /**< Lower transition location at the span stations */
 
+        std::vector<double> m_InfluenceCoef;            /**< the matrix of the induced angle coefficients, row-major, size (NStations-1)² */
+        std::vector<Foil*> m_StationFoil0;              /**< the left foil at the span stations */
+        std::vector<Foil*> m_StationFoil1;              /**< the right foil at the span stations */
+        std::vector<double> m_StationTau;               /**< the foil interpolation factor at the span stations */
+
         Vector3d m_CP;                               /**< The position of the center of pressure */
 
         SpanDistribs m_SpanDistribs;
@@ -0,0 +1,109 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <fl5lib_global.h>
+
+
+/**
+ * @brief The LUCache class keeps the LU factorizations of the dense influence matrices
+ * so that they can be reused by the operating points and the analyses which share
+ * the same panel geometry, wake geometry and solver settings.
+ *
+ * The entries are identified by a 64 bit key, cf. PanelAnalysis::matrixKey().
+ * Each entry is a copy of a dense matrix, so that the cache is disabled by default and must be activated
+ * with setEnabled(); it only pays off when the same geometry is analysed again, e.g. by the operating points
+ * of a T6 polar which differ only by the speed or the inertia, or by a polar which is recalculated.
+ * The cache is shared by all the analyses and is thread-safe.
+ * The least recently used entries are discarded first when the memory budget is exceeded.
+ * If a spill directory is set, the factorizations which are larger than the spill size
+ * are written to disk instead of being held in memory.
+ */
+class FL5LIB_EXPORT LUCache
+{
+    public:
+        /** FNV-1a hash accumulator used to build the keys */
+        class Key
+        {
+            public:
+                void add(void const *data, size_t nBytes);
+                template<typename T>
+                void add(T const &value) {add(&value, sizeof(T));}
+                uint64_t value() const {return m_Hash;}
+
+            private:
+                uint64_t m_Hash = 14695981039346656037ULL;
+        };
+
+    private:
+        struct Entry
+        {
+            uint64_t m_Key=0;
+            std::vector<double> m_aijd;
+            std::vector<float>  m_aijf;
+            std::vector<int>    m_ipiv;
+            std::string m_FileName;   /**< the name of the spill file, or empty if the entry is held in memory */
+        };
+
+    public:
+        static bool fetch(uint64_t key, std::vector<double> &aijd, std::vector<float> &aijf, std::vector<int> &ipiv);
+        static void store(uint64_t key, std::vector<double> const &aijd, std::vector<float> const &aijf, std::vector<int> const &ipiv);
+        static void clear();
+
+        static void setEnabled(bool bEnabled) {s_bEnabled=bEnabled;}
+        static bool isEnabled() {return s_bEnabled;}
+        static void setMaxEntries(int n) {s_MaxEntries=n;}
+        static void setMaxMemory(double MB) {s_MaxMemory=MB;}
+        static double maxMemory() {return s_MaxMemory;}
+        static void setSpillDirectory(std::string const &dir) {s_SpillDir=dir;}
+        static std::string const &spillDirectory() {return s_SpillDir;}
+        static void setSpillSize(double MB) {s_SpillSize=MB;}
+        static double spillSize() {return s_SpillSize;}
+
+    private:
+        static double memorySize(Entry const &entry);
+        static bool writeSpillFile(Entry &entry, std::vector<double> const &aijd, std::vector<float> const &aijf);
+        static bool readSpillFile(Entry const &entry, std::vector<double> &aijd, std::vector<float> &aijf);
+        static void discard(std::list<Entry>::iterator it);
+        static void trim();
+
+    private:
+        static std::list<Entry> s_Entry;  /**< the cached factorizations, most recently used first */
+        static std::mutex s_Mutex;
+
+        static bool s_bEnabled;           /**< false by default; each entry is a copy of the matrix */
+        static int s_MaxEntries;          /**< the maximum number of factorizations, in memory or on disk */
+        static double s_MaxMemory;        /**< the memory budget of the entries held in memory, in MB */
+        static std::string s_SpillDir;    /**< the directory of the spill files, or empty to keep all the entries in memory */
+        static double s_SpillSize;        /**< the size in MB above which the factorizations are spilled to disk */
+};
+
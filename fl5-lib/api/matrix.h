@@ -27,6 +27,7 @@
 
 
 #include <complex>
+#include <functional>
 #include <vector>
 
 #include <fl5lib_global.h>
@@ -181,4 +182,13 @@ namespace matrix
 
 
     FL5LIB_EXPORT void setIdentityMatrix(double *M, int n);
+
+
+    /** The matrix-vector product y=A.x used by the matrix-free iterative solvers. */
+    typedef std::function<void(double const *x, double *y)> linearOperator;
+
+    FL5LIB_EXPORT bool GMRES(int n, linearOperator const &A, linearOperator const &M, double const *b, double *x,
+                             int restart, int maxiter, double tolerance, int &iter, double &residual);
+    FL5LIB_EXPORT bool BiCGStab(int n, linearOperator const &A, linearOperator const &M, double const *b, double *x,
+                                int maxiter, double tolerance, int &iter, double &residual);
 }
@@ -0,0 +1,91 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+/**
+  * @file this file implements the NURBSEvaluator class.
+  */
+
+#pragma once
+
+#include <vector>
+
+#include <vector3d.h>
+
+
+class NURBSSurface;
+
+/**
+ * @class FL5LIB_EXPORT NURBSEvaluator
+ * A precomputed evaluator of a NURBSSurface.
+ *
+ * The control net is stored with the rotations of the frames already applied, together with
+ * the knots and the edge weights. Each evaluation only visits the (degree+1)x(degree+1) control points
+ * of the knot spans which contain (u,v), and the basis functions are computed once per direction.
+ *
+ * The evaluator is a snapshot of the surface and must be rebuilt if the frames, the degrees or the knots
+ * are modified. The evaluation methods are const and may be called concurrently.
+ *
+ * The results match those of NURBSSurface::getPoint() and NURBSSurface::getNormal().
+*/
+class FL5LIB_EXPORT NURBSEvaluator
+{
+    public:
+        NURBSEvaluator(NURBSSurface const &nurbs);
+
+        void getPoint(double u, double v, Vector3d &Pt) const;
+        void getNormal(double u, double v, Vector3d &N) const;
+        void getDerivatives(double u, double v, Vector3d &Pt, Vector3d &Su, Vector3d &Sv) const;
+
+        void getPoints(std::vector<double> const &u, std::vector<double> const &v, std::vector<Vector3d> &points) const;
+        void getGrid(std::vector<double> const &u, std::vector<double> const &v, std::vector<Vector3d> &points) const;
+
+        bool intersect(Vector3d const &A, Vector3d const &B, double &u, double &v, Vector3d &I) const;
+
+        int nu() const {return m_nu;}
+        int nv() const {return m_nv;}
+
+    private:
+        void pointFromBasis(int iu0, int nu, double const *Nu, int jv0, int nv, double const *Nv, Vector3d &Pt) const;
+
+        Vector3d const &ctrlPoint(int iu, int jv)       const {return m_Net[iu*m_nv+jv];}
+        Vector3d const &normalCtrlPoint(int iu, int jv) const {return m_NormalNet.size() ? m_NormalNet[iu*m_nv+jv] : m_Net[iu*m_nv+jv];}
+
+    private:
+        NURBSSurface const *m_pNurbs;    /**< the source surface, only used if the degrees are too high for the span-local evaluation */
+        bool m_bSpanLocal;               /**< true if the degrees can be handled by the span-local evaluation */
+
+        int m_nu;                        /**< the number of frames */
+        int m_nv;                        /**< the number of control points in each frame */
+        int m_uDegree;                   /**< the degree in the u direction */
+        int m_vDegree;                   /**< the degree in the v direction */
+
+        std::vector<double> m_uKnot;     /**< the knots in the u direction */
+        std::vector<double> m_vKnot;     /**< the knots in the v direction */
+        std::vector<double> m_uWeight;   /**< the edge weights of the frames */
+        std::vector<double> m_vWeight;   /**< the edge weights of the frame points */
+
+        std::vector<Vector3d> m_Net;       /**< the rotated control points, frame by frame */
+        std::vector<Vector3d> m_NormalNet; /**< the control points as rotated for the normals; empty if identical to m_Net */
+};
+
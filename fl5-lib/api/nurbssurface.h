@@ -98,6 +98,8 @@ class FL5LIB_EXPORT NURBSSurface
         double getvIntersect(double u, Vector3d r) const;
         void   getPoint(double u, double v, Vector3d &Pt) const;
         void   getNormal(double u, double v, Vector3d &N) const;
+        void   getPoint_ref(double u, double v, Vector3d &Pt) const;
+        void   getNormal_ref(double u, double v, Vector3d &N) const;
 
         bool intersectNURBS(const Vector3d &Aa, const Vector3d &Bb, double &u, double &v, Vector3d &I) const;
         bool intersect_ref(const Vector3d &A, const Vector3d &B, double &u, double &v, Vector3d &I) const;
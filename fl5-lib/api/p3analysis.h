@@ -26,6 +26,8 @@
 
 
 
+#include <p3kernelview.h>
+#include <p3treesolver.h>
 #include <panel3.h>
 #include <panelanalysis.h>
 #include <trimesh.h>
@@ -40,6 +42,7 @@ class FL5LIB_EXPORT P3Analysis : public PanelAnalysis
     friend class  Task3d;
     friend class  PlaneTask;
     friend class  BoatTask;
+    friend class  P3TreeSolver;
 
     public:
         P3Analysis();
@@ -51,6 +54,7 @@ class FL5LIB_EXPORT P3Analysis : public PanelAnalysis
         virtual void makeMatrixBlock(int iBlock) = 0;
 
         bool initializeAnalysis(const Polar3d *pPolar3d, int nRHS) override;
+        bool bDenseMatrix() const override {return PanelAnalysis::bDenseMatrix() && s_MatrixSolver!=xfl::BARNESHUT;}
 
         void setTriMesh(TriMesh const &trimesh);
 
@@ -81,22 +85,25 @@ class FL5LIB_EXPORT P3Analysis : public PanelAnalysis
         void restorePanels() override;
         bool computeTrimmedConditions(double mass, Vector3d const &CoG, double &alphaeq, double &u0, bool bFuseMi) override;
         int makeWakePanels(Vector3d const &WindDirection, bool bVortonWake) override;
-        void scaleResultsToSpeed(double ratio) override;
+        void scaleResultsToSpeed(double ratio, double *Mu, double *Sigma) const override;
         void makeMu(int qrhs) override;
         virtual void getDoubletInfluence(Vector3d const &C, Panel3 const &p3, Vector3d *V, double *phi, double coreradius, bool bUseRFF) const;
 
-        void combineLocalVelocities(double alpha, double beta, std::vector<Vector3d> &VLocal) const override;
+        void combineLocalVelocities(double alpha, double beta,
+                                    std::vector<Vector3d> const &uVLocal, std::vector<Vector3d> const &vVLocal, std::vector<Vector3d> const &wVLocal,
+                                    std::vector<Vector3d> &VLocal) const override;
 
 
-        void forces(const double *Mu3, const double *Sigma3, double alpha, double beta, const Vector3d &CoG, bool bFuseMi, std::vector<Vector3d> const &VInf, Vector3d &Force, Vector3d &Moment) override;
-        void inducedForce(int nPanel3, double QInf, double alpha, double beta, int pos3, Vector3d &ForceBodyAxes, SpanDistribs &distribFF) const override;
-        void trefftzDrag(int nPanel3, double QInf, double alpha, double beta, int pos3, Vector3d &Drag, SpanDistribs &distribFF) const override;
+        void trefftzDownwash(double const *Mu3, std::vector<Vector3d> &Wg) const override;
+        void forcesFromDownwash(double const *Mu3, double const *Sigma3, double alpha, double beta, Vector3d const &CoG, bool bFuseMi,
+                                std::vector<Vector3d> const &VInf, std::vector<Vector3d> const &WDownwash, Vector3d &Force, Vector3d &Moment) override;
+        void inducedForce(int nPanel3, double QInf, double alpha, double beta, int pos3, double const *Mu, Vector3d &ForceBodyAxes, SpanDistribs &distribFF) const override;
+        void trefftzDrag(int nPanel3, double QInf, double alpha, double beta, int pos3, double const *Mu, double const *Sigma, Vector3d &Drag, SpanDistribs &distribFF) const override;
 
         double getPotential(Vector3d const &C, const double *mu, const double *sigma) const;
 
-        void getVelocityVector(Vector3d const &C, double const *Mu, double const *Sigma, Vector3d &VT, double coreradius, bool bWakeOnly, bool bMultiThread) const override;
-
-        void velocityVectorBlock(int iBlock, Vector3d const &C, Vector3d *VT) const;
+        void velocityVectorRange(Vector3d const &C, int iStart, int iEnd, double const *Mu, double const *Sigma, double coreradius, bool bWakeOnly,
+                                 Vector3d &VT, double *phi) const override;
         void getFarFieldVelocity(const Vector3d &C, const std::vector<Panel3> &panel3, const double *Mu, Vector3d &VT, double coreradius) const;
         void getDebugPotential(Vector3d const &C, bool bSelf, const double *Mu, const double *Sigma, double &phi, bool bSource=true, bool bDoublet=true, bool bWake=true) const;
 
@@ -125,6 +132,27 @@ class FL5LIB_EXPORT P3Analysis : public PanelAnalysis
 
 
 
+    protected:
+        bool LUfactorize() override;
+        void backSubUnitRHS(double *uRHS, double *vRHS, double*wRHS, double *pRHS, double *qRHS, double*rRHS) override;
+        bool backSubRHS(std::vector<double> &RHS) override;
+        bool backSubRHSBatch(double *RHS, int nRHS) override;
+        void panelNeighbours(int p, std::vector<int> &neighbours) const override;
+        double panelRadius(int p) const override;
+        void wakeColumnPanels(std::vector<int> &panels) const override;
+        void hashPanels(LUCache::Key &key) const override;
+        void panelVertices(std::vector<Vector3d> &vertices) const override;
+        void makeKernelView();
+        void surfaceVelocity(Vector3d const &C, int iStart, int iEnd, double const *Mu, double const *Sigma, double coreradius,
+                             Vector3d &VT) const;
+
+        /** Adds a wake coefficient to the influence matrix, whatever the solver's storage */
+        inline void addWakeCoef(int row, int col, int N, double value)
+        {
+            if(s_MatrixSolver==xfl::BARNESHUT) m_TreeSolver.addWakeCoef(row, col, value);
+            else                               PanelAnalysis::addWakeCoef(row, col, N, value);
+        }
+
     protected:
         TriMesh const *m_pRefTriMesh;
         std::vector<Panel3> m_Panel3;               /**< the panel array for the currently loaded plane */
@@ -135,6 +163,11 @@ class FL5LIB_EXPORT P3Analysis : public PanelAnalysis
         std::vector<double> m_uRHSVertex, m_vRHSVertex, m_wRHSVertex; /** The unit doublet densities at the triangle's nodes. */
         std::vector<double> m_pRHSVertex, m_qRHSVertex, m_rRHSVertex; /** The unit doublet densities at the triangle's nodes. */
 
+        P3TreeSolver m_TreeSolver;  /**< the matrix-free solver used in place of the dense matrix if s_MatrixSolver==BARNESHUT */
+
+        P3KernelView m_KernelView;        /**< the structure-of-arrays copy of m_Panel3 used by the vectorized influence loops */
+        P3KernelView m_MirrorKernelView;  /**< the view of the panels' symmetric images, used by the linear method with ground or free surface effect */
+
 };
 
 
@@ -0,0 +1,109 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <vector>
+
+#include <fl5lib_global.h>
+#include <vector3d.h>
+
+class Panel3;
+
+
+/**
+ * @brief The P3KernelView class is a structure-of-arrays copy of the geometric data of an array of triangular panels,
+ * used to evaluate the influence of many source panels at once.
+ *
+ * The panels are processed in packets of LANES consecutive panels; the loops on the packet's lanes
+ * operate on contiguous arrays and are free of branches, so that they are vectorized by the compiler
+ * for the instruction set enabled at build time.
+ * Only the closed-form expressions are evaluated in the packets:
+ *   - the uniform doublet velocity, both near and far field;
+ *   - the far field approximations of the linear doublet and of the uniform source.
+ * The panels in the near field of the linear and source kernels are returned to the caller,
+ * which evaluates their influence with the exact Panel3 integrals.
+ *
+ * The view is a snapshot of the panels' positions and must be rebuilt each time the panels are moved.
+ */
+class FL5LIB_EXPORT P3KernelView
+{
+    public:
+        static constexpr int LANES = 8;  /**< the number of panels processed in each packet */
+
+        /** The data of a receiving panel required to integrate the influence of the source panels over its surface */
+        struct Receiver
+        {
+            std::vector<Vector3d> m_Pt;  /**< the quadrature points, in global coordinates */
+            std::vector<double> m_bw;    /**< for each quadrature point, the three basis functions x weight x area */
+            Vector3d m_CoG;
+            Vector3d m_Normal;
+            double m_Radius=0;           /**< the max. distance of the quadrature points to the CoG */
+        };
+
+    public:
+        P3KernelView();
+
+        void make(std::vector<Panel3> const &panel3);
+        void clear();
+        int size() const {return m_nPanels;}
+
+        static void makeReceiver(Panel3 const &p3, Receiver &receiver);
+
+        void doubletUniVelocity(Vector3d const &C, Vector3d const *CG, double gcoef, int iStart, int iEnd, double const *Mu, double coreradius,
+                                Vector3d &V, std::vector<int> &nearpanels) const;
+        void doubletLinVelocity(Vector3d const &C, Vector3d const *CG, double gcoef, int iStart, int iEnd, double const *Mu,
+                                Vector3d &V, std::vector<int> &nearpanels) const;
+        void sourceVelocity(Vector3d const &C, Vector3d const *CG, double gcoef, int iStart, int iEnd, double const *Sigma,
+                            Vector3d &V, std::vector<int> &nearpanels) const;
+
+        void doubletUniRow(Vector3d const &C, Vector3d const *CG, double gcoef, Vector3d const &normal, bool bVelocity,
+                           double *coef, char *bFar) const;
+        void doubletLinRow(Receiver const &receiver, P3KernelView const *pMirror, double gcoef, bool bVelocity,
+                           double *coef, char *bFar) const;
+
+    private:
+        void farMask(Vector3d const &C, int k0, int iEnd, double margin, double *far) const;
+        void uniVelocityPacket(Vector3d const &C, int k0, double coreradius, double *vx, double *vy, double *vz) const;
+        void linVelocityPacket(Vector3d const &C, int k0, double const mu[3][LANES], double *vx, double *vy, double *vz) const;
+        void linRowPacket(Receiver const &receiver, int k0, bool bVelocity, double sum[9][LANES]) const;
+
+    private:
+        int m_nPanels;
+        int m_nPadded;   /**< the size of the arrays, rounded up to a multiple of LANES */
+
+        std::vector<double> m_cx, m_cy, m_cz;        /**< the panels' CoG */
+        std::vector<double> m_lx, m_ly, m_lz;        /**< the local frame's x-axis */
+        std::vector<double> m_mx, m_my, m_mz;        /**< the local frame's y-axis */
+        std::vector<double> m_nx, m_ny, m_nz;        /**< the normals */
+        std::vector<double> m_Area;
+        std::vector<double> m_MaxSize;
+        std::vector<double> m_bx[3], m_by[3];        /**< the integrals of x.b_i(x,y) and y.b_i(x,y) */
+        std::vector<double> m_bxSum, m_bySum;        /**< the sums of the three integrals */
+        std::vector<double> m_sx[3], m_sy[3], m_sz[3];  /**< the vertices */
+        std::vector<double> m_bEdge[3];              /**< 1 if the edge from vertex i to vertex i+1 is not degenerate, 0 otherwise */
+        std::vector<double> m_bValid;                /**< 0 for padding or null triangles, which are never in the far field */
+};
+
@@ -37,6 +37,8 @@ class FL5LIB_EXPORT P3LinAnalysis : public P3Analysis
         bool isTriUniMethod() const override {return false;}
         bool isTriLinMethod() const override {return true;}
 
+        bool influenceBlock(int i3, int k3, double *coef) const override;
+
         void makeSourceInfluenceMatrix();
         void sourceToRHS(const std::vector<double> &sigma, std::vector<double> &RHS);
 
@@ -45,7 +47,7 @@ class FL5LIB_EXPORT P3LinAnalysis : public P3Analysis
         void makeLocalVelocities(std::vector<double> const &uRHS, std::vector<double> const &vRHS, const std::vector<double> &wRHS,
                                  std::vector<Vector3d> &uVLocal, std::vector<Vector3d> &vVLocal, std::vector<Vector3d> &wVLocal,
                                  Vector3d const &WindDirection) const override;
-        void computeOnBodyCp(std::vector<Vector3d> const &VInf, const std::vector<Vector3d> &VGLOBAL, std::vector<double> &Cp) const override;
+        void computeOnBodyCp(std::vector<Vector3d> const &VInf, const std::vector<Vector3d> &VGLOBAL, double *Cp) const override;
         void makeNodeDoubletSurfaceVelocity(int iNode, const std::vector<double> &uRHS, const std::vector<double> &vRHS, const std::vector<double> &wRHS, Vector3d &uNode, Vector3d &vNode, Vector3d &wNode) const;
         void makeRHSBlock(int iBlock, double *RHS, std::vector<Vector3d> const &VField, Vector3d const*normals) const override;
         void makeWakeMatrixBlock(int iBlock) override;
@@ -55,7 +57,7 @@ class FL5LIB_EXPORT P3LinAnalysis : public P3Analysis
 
         void makeUnitRHSBlock(int iBlock) override;
 
-        void makeUnitDoubletStrengths(double alpha, double beta) override;
+        void makeUnitDoubletStrengths(double alpha, double beta, double *Mu) const override;
 
         void makeVortons(double dl, double const *mu3Vertex, int pos3, int nPanel3, int nStations, int nVtn0,
                          std::vector<Vorton> &vortons, std::vector<Vortex> &vortexneg) const override;
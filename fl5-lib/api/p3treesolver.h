@@ -0,0 +1,122 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#pragma once
+
+#include <vector>
+
+#include <fl5lib_global.h>
+#include <vector3d.h>
+
+class P3Analysis;
+
+
+/**
+ * @brief The P3TreeSolver class is a matrix-free alternative to the dense influence matrix
+ * of the triangular panel methods, intended for meshes too large to be factorized.
+ *
+ * The panel interactions are split using a Barnes-Hut octree built on the panels' centroids:
+ *   - the near-field interactions are calculated with the exact Panel3 integrals and stored by panel blocks;
+ *   - the far-field interactions are approximated by the doublet moments aggregated in the tree's nodes;
+ *   - the wake's contribution to the trailing edge panels is stored as a dense block of columns.
+ * Memory and matrix-vector products scale as N.log(N).
+ * The linear system is solved using restarted GMRES with a block-Jacobi preconditioner
+ * built from each panel's self-influence block.
+ */
+class FL5LIB_EXPORT P3TreeSolver
+{
+    private:
+        struct TreeNode
+        {
+            Vector3d m_Center;     /**< the area-weighted centroid of the node's panels */
+            double m_Radius=0;     /**< the radius of the sphere centered on m_Center which encloses all the node's panels */
+            int m_iStart=0;        /**< the index of the node's first panel in the permutation array */
+            int m_iEnd=0;          /**< the index past the node's last panel in the permutation array */
+            int m_iChild[8]{-1,-1,-1,-1,-1,-1,-1,-1};
+            bool isLeaf() const {return m_iChild[0]<0;}
+        };
+
+    public:
+        P3TreeSolver();
+
+        void clear();
+        bool isBuilt() const {return m_nRows>0;}
+        int size() const {return m_nRows;}
+
+        bool build(P3Analysis const *pP3A, int nBasis, int nBlocks, bool bMultiThread);
+        void addWakeCoef(int row, int col, double value);
+        bool makePreconditioner();
+
+        void matVec(double const *x, double *y) const;
+        void preconditioner(double const *x, double *y) const;
+        bool solve(double *RHS) const;
+
+        double memorySize() const;
+
+        static void setTheta(double theta) {s_Theta=theta;}
+        static double theta() {return s_Theta;}
+        static void setLeafSize(int n) {s_LeafSize=n;}
+        static int leafSize() {return s_LeafSize;}
+        static void setTolerance(double tol) {s_Tolerance=tol;}
+        static double tolerance() {return s_Tolerance;}
+        static void setMaxIterations(int n) {s_MaxIter=n;}
+        static int maxIterations() {return s_MaxIter;}
+        static void setRestart(int n) {s_Restart=n;}
+        static int restart() {return s_Restart;}
+
+    private:
+        int makeNode(int iStart, int iEnd, int depth);
+        void makeInteractionBlock(int iBlock);
+        void matVecBlock(int iBlock, double const *x, Vector3d const *moment, double *y) const;
+        double farField(int i3, bool bVelocity, Vector3d const *moment) const;
+
+    private:
+        P3Analysis const *m_pP3A;
+
+        int m_nBasis;          /**< the number of unknowns per panel: 3 for the linear method, 1 for the uniform method */
+        int m_nRows;           /**< the size of the linear system */
+        int m_nBlocks;
+        bool m_bMultiThread;
+        mutable bool m_bError;
+
+        std::vector<TreeNode> m_Node;      /**< the octree's nodes; children are always stored after their parent */
+        std::vector<int> m_Index;          /**< the permutation array of panel indexes, such that each node spans a contiguous range */
+        std::vector<double> m_PanelSize;   /**< the radius of the sphere centered on each panel's CoG which encloses the panel */
+
+        std::vector<std::vector<int>>    m_NearPanel; /**< for each target panel, the indexes of the source panels in the near field */
+        std::vector<std::vector<double>> m_NearCoef;  /**< for each target panel, the exact influence blocks of the near field panels, row-major */
+        std::vector<std::vector<int>>    m_FarNode;   /**< for each target panel, the indexes of the tree nodes in the far field */
+
+        std::vector<int> m_WakeSlot;       /**< for each panel, its index in the array of wake columns, or -1 */
+        std::vector<int> m_WakePanel;      /**< the panels with wake contributions */
+        std::vector<double> m_WakeCoef;    /**< the dense block of wake contributions, nRows x (m_WakePanel.size()*nBasis) */
+
+        std::vector<double> m_Precond;     /**< the inverted diagonal blocks */
+
+        static double s_Theta;      /**< the Barnes-Hut opening criterion: a node is in the far field if its size/distance < theta */
+        static int s_LeafSize;      /**< the max. number of panels in a leaf node */
+        static double s_Tolerance;  /**< the GMRES convergence criterion on the relative residual */
+        static int s_MaxIter;       /**< the max. number of GMRES iterations */
+        static int s_Restart;       /**< the dimension of the Krylov subspace */
+};
@@ -35,6 +35,8 @@ class FL5LIB_EXPORT P3UniAnalysis : public P3Analysis
         bool isTriUniMethod() const override {return true;}
         bool isTriLinMethod() const override {return false;}
 
+        bool influenceBlock(int i3, int k3, double *coef) const override;
+
     protected:
         void makeMatrixBlock(int iBlock) override;
 
@@ -43,13 +45,13 @@ class FL5LIB_EXPORT P3UniAnalysis : public P3Analysis
         void makeLocalVelocities(std::vector<double> const &uRHS, std::vector<double> const &vRHS, const std::vector<double> &wRHS,
                                  std::vector<Vector3d> &uLocal, std::vector<Vector3d> &vLocal, std::vector<Vector3d> &wLocal,
                                  Vector3d const &WindDirection) const override;
-        void computeOnBodyCp(std::vector<Vector3d> const &VInf, const std::vector<Vector3d> &VLocal, std::vector<double> &Cp) const override;
+        void computeOnBodyCp(std::vector<Vector3d> const &VInf, const std::vector<Vector3d> &VLocal, double *Cp) const override;
 
         void makeWakeMatrixBlock(int iBlock) override;
 
         void makeUnitRHSBlock(int iBlock) override;
 
-        void makeUnitDoubletStrengths(double alpha, double beta) override;
+        void makeUnitDoubletStrengths(double alpha, double beta, double *Mu) const override;
         void makeVertexDoubletDensities(std::vector<double> const &muSrc, std::vector<double> &muNode) const override;
 
         void makeVortons(double dl, double const *mu3Vertex, int pos3, int nPanel3, int nStations, int nVtn0,
@@ -75,6 +75,10 @@ class FL5LIB_EXPORT P4Analysis : public PanelAnalysis
 
         void makeInfluenceMatrix() override;
         void makeMatrixBlock(int iBlock);
+        bool influenceBlock(int i4, int k4, double *coef) const override;
+        double panelRadius(int p) const override;
+        void hashPanels(LUCache::Key &key) const override;
+        void panelVertices(std::vector<Vector3d> &vertices) const override;
 
         void makeUnitRHSBlock(int iBlock) override;
         void makeRHSBlock(int iBlock, double *RHS, std::vector<Vector3d> const &VField, const Vector3d *normals) const override;
@@ -88,13 +92,15 @@ class FL5LIB_EXPORT P4Analysis : public PanelAnalysis
         void getFarFieldVelocity(Vector3d const &C, const std::vector<Panel4> &panel4, const double *Mu, Vector3d &VT, double coreradius) const;
 
         double getPotential(Vector3d const &C, const double *mu, const double *sigma) const;
-        void getVelocityVector(Vector3d const &C,double const *Mu, double const *Sigma, Vector3d &VT, double coreradius,
-                               bool bWakeOnly, bool bMultiThread) const override;
+        void velocityVectorRange(Vector3d const &C, int iStart, int iEnd, double const *Mu, double const *Sigma, double coreradius, bool bWakeOnly,
+                                 Vector3d &VT, double *phi) const override;
 
         void VLMGetVortexInfluence(const Panel4 &pPanel, Vector3d const &C, double *phi, Vector3d *V, bool bIncludingBound, double fardist) const;
 
 
-        void forces(double const *Mu, double const *Sigma, double alpha, double beta, Vector3d const&CoG, bool bFuseMi, const std::vector<Vector3d> &VInf, Vector3d &Force, Vector3d &Moment) override;
+        void trefftzDownwash(double const *Mu, std::vector<Vector3d> &Wg) const override;
+        void forcesFromDownwash(double const *Mu, double const *Sigma, double alpha, double beta, Vector3d const &CoG, bool bFuseMi,
+                                std::vector<Vector3d> const &VInf, std::vector<Vector3d> const &WDownwash, Vector3d &Force, Vector3d &Moment) override;
 
         void makeMu(int qrhs) override;
 
@@ -109,8 +115,6 @@ class FL5LIB_EXPORT P4Analysis : public PanelAnalysis
 
         void releasePanelArrays();
 
-        void velocityVectorBlock(int iBlock, Vector3d const &C,
-                                             Vector3d *VT) const;
         void getDoubletDerivative(int p, const double *Mu, double &Cp, Vector3d &VTotl, const Vector3d &VInf) const;
 
         Vector3d trailingWakePoint(const Panel4 *pWakePanel) const;
@@ -118,8 +122,8 @@ class FL5LIB_EXPORT P4Analysis : public PanelAnalysis
         const Panel4 *trailingWakePanel(Panel4 const *pWakePanel) const;
         int nextTopTrailingPanelIndex(Panel4 const &p4) const;
 
-        void inducedForce(int nPanel3, double QInf, double alpha, double beta, int pos, Vector3d &ForceBodyAxes, SpanDistribs &SpanResFF) const override;
-        void trefftzDrag(int nPanels, double QInf, double alpha, double beta, int pos, Vector3d &FFForce, SpanDistribs &SpanResFF) const override;
+        void inducedForce(int nPanel3, double QInf, double alpha, double beta, int pos, double const *Mu, Vector3d &ForceBodyAxes, SpanDistribs &SpanResFF) const override;
+        void trefftzDrag(int nPanels, double QInf, double alpha, double beta, int pos, double const *Mu, double const *Sigma, Vector3d &FFForce, SpanDistribs &SpanResFF) const override;
 
         Panel *panel(int p) override {if(p>=0 && p<nPanels()) return m_Panel4.data()+p; else return nullptr;}
         Panel const *panelAt(int p) const override {if(p>=0 && p<nPanels()) return m_Panel4.data()+p; else return nullptr;}
@@ -129,16 +133,18 @@ class FL5LIB_EXPORT P4Analysis : public PanelAnalysis
 
 
         void computeOnBodyCp(std::vector<Vector3d> const &VInf,
-                             std::vector<Vector3d> const &VLocal, std::vector<double>&Cp) const override;
+                             std::vector<Vector3d> const &VLocal, double *Cp) const override;
 
         double computeCm(const Vector3d &CoG, double Alpha, bool bFuseMi);
         bool computeTrimmedConditions(double mass, const Vector3d &CoG, double &alphaeq, double &u0, bool bFuseMi) override;
         bool getZeroMomentAngle(const Vector3d &CoG, double &alphaeq, bool bFuseMi);
 
         int allocateRHS4(int nRHS);
-        void scaleResultsToSpeed(double ratio) override;
-        void makeUnitDoubletStrengths(double alpha, double beta) override;
-        void combineLocalVelocities(double alpha, double beta, std::vector<Vector3d> &VLocal) const override;
+        void scaleResultsToSpeed(double ratio, double *Mu, double *Sigma) const override;
+        void makeUnitDoubletStrengths(double alpha, double beta, double *Mu) const override;
+        void combineLocalVelocities(double alpha, double beta,
+                                    std::vector<Vector3d> const &uVLocal, std::vector<Vector3d> const &vVLocal, std::vector<Vector3d> const &wVLocal,
+                                    std::vector<Vector3d> &VLocal) const override;
         void makeLocalVelocities(std::vector<double> const &uRHS, std::vector<double> const &vRHS, std::vector<double> const &wRHS,
                                  std::vector<Vector3d> &uVLocal, std::vector<Vector3d> &vVLocal, std::vector<Vector3d> &wVLocal,
                                  Vector3d const &WindDirection) const override;
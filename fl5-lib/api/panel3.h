@@ -39,6 +39,7 @@
 class FL5LIB_EXPORT Panel3 : public Panel
 {
     friend class  TriMesh;
+    friend class  P3KernelView;
 
     public:
         Panel3();
@@ -29,7 +29,13 @@
 
 #include <vorton.h>
 #include <vortex.h>
+#include <vortontree.h>
 #include <aeroforces.h>
+#include <enums_objects.h>
+#include <hmatrix.h>
+#include <lucache.h>
+#include <tiledmatrix.h>
+#include <threadpool.h>
 #include <spandistribs.h>
 #include <utils.h>
 
@@ -62,41 +68,52 @@ class FL5LIB_EXPORT PanelAnalysis
         virtual bool initializeAnalysis(Polar3d const *pPolar3d, int nRHS);
         virtual int  matSize() const = 0;
         virtual int  makeWakePanels(Vector3d const &WindDirection, bool bVortonWake) = 0;
-        virtual void scaleResultsToSpeed(double ratio) = 0;
+        virtual void scaleResultsToSpeed(double ratio, double *Mu, double *Sigma) const = 0;
         virtual void savePanels() = 0;
         virtual void restorePanels() = 0;
         virtual void makeInfluenceMatrix() = 0;
         virtual void makeUnitRHSBlock(int iBlock) = 0;
         virtual void makeRHSBlock(int iBlock, double *RHS, std::vector<Vector3d> const &VField, Vector3d const*normals) const = 0;
-        virtual void makeUnitDoubletStrengths(double alpha, double beta) = 0;
+        virtual void makeUnitDoubletStrengths(double alpha, double beta, double *Mu) const = 0;
         virtual void makeWakeMatrixBlock(int iBlock) = 0;
+        virtual bool influenceBlock(int i, int k, double *coef) const = 0;
 
         virtual void makeMu(int qrhs) = 0;
         virtual void makeLocalVelocities(std::vector<double> const &uRHS, std::vector<double> const &vRHS, std::vector<double> const &wRHS,
                                          std::vector<Vector3d> &uVLocal, std::vector<Vector3d> &vVLocal, std::vector<Vector3d> &wVLocal,
                                          Vector3d const &WindDirection) const = 0;
-        virtual void combineLocalVelocities(double alpha, double beta, std::vector<Vector3d> &VLocal) const = 0;
-        virtual void computeOnBodyCp(std::vector<Vector3d> const &VInf, std::vector<Vector3d> const &VLocal, std::vector<double>&Cp) const = 0;
+        virtual void combineLocalVelocities(double alpha, double beta,
+                                            std::vector<Vector3d> const &uVLocal, std::vector<Vector3d> const &vVLocal, std::vector<Vector3d> const &wVLocal,
+                                            std::vector<Vector3d> &VLocal) const = 0;
+        virtual void computeOnBodyCp(std::vector<Vector3d> const &VInf, std::vector<Vector3d> const &VLocal, double *Cp) const = 0;
         virtual bool computeTrimmedConditions(double mass, Vector3d const &CoG, double &alphaeq, double &u0, bool bFuseMi) = 0;
-        virtual void forces(double const *Mu, double const *Sigma, double alpha, double beta, Vector3d const &CoG, bool bFuseMi, std::vector<Vector3d> const &VInf, Vector3d &Force, Vector3d &Moment) = 0;
-        virtual void inducedForce(int nPanel3, double QInf, double alpha, double beta, int pos, Vector3d &ForceBodyAxes, SpanDistribs &SpanResFF) const = 0;
-        virtual void trefftzDrag(int nPanel3, double QInf, double alpha, double beta, int pos, Vector3d &Drag, SpanDistribs &SpanResFF) const = 0;
+        void forces(double const *Mu, double const *Sigma, double alpha, double beta, Vector3d const &CoG, bool bFuseMi, std::vector<Vector3d> const &VInf, Vector3d &Force, Vector3d &Moment);
+        /** Returns the far-field perturbation velocities of the trailing strips; these are linear in Mu, except for the constant contribution of the vortons */
+        virtual void trefftzDownwash(double const *Mu, std::vector<Vector3d> &Wg) const = 0;
+        virtual void forcesFromDownwash(double const *Mu, double const *Sigma, double alpha, double beta, Vector3d const &CoG, bool bFuseMi,
+                                        std::vector<Vector3d> const &VInf, std::vector<Vector3d> const &WDownwash, Vector3d &Force, Vector3d &Moment) = 0;
+        virtual void inducedForce(int nPanel3, double QInf, double alpha, double beta, int pos, double const *Mu, Vector3d &ForceBodyAxes, SpanDistribs &SpanResFF) const = 0;
+        virtual void trefftzDrag(int nPanel3, double QInf, double alpha, double beta, int pos, double const *Mu, double const *Sigma, Vector3d &Drag, SpanDistribs &SpanResFF) const = 0;
         virtual int  nPanels() const = 0;
         virtual void makeVertexDoubletDensities(std::vector<double> const &muPanel, std::vector<double> &muNode) const {(void)muPanel; (void)muNode;} //dummy virtual method to enable a call to P3analysis subclass...
 
         virtual void makeVortons(double dl, double const *mu3Vertex, int pos3, int nPanel3, int nStations, int nVtn0,
                                  std::vector<Vorton> &vortons, std::vector<Vortex> &vortexneg) const = 0;
-        virtual void makeRHSVWVelocities(std::vector<Vector3d>& VPW, bool bVLM=false);
-        virtual void makeRHSVWVelocitiesBlock(int iFirst, int iLast, bool bVLM, Vector3d *Vpanel);
+        void makeRHSVWVelocities(std::vector<Vector3d>& VPW, bool bVLM=false) const;
         virtual void makeNegatingVortices(std::vector<Vortex> &negvortices) = 0;
 
-        virtual void getVelocityVector(Vector3d const &C, double const *Mu, double const *Sigma, Vector3d &VT, double coreradius, bool bWakeOnly, bool bMultiThread) const = 0;
+        void getVelocityVector(Vector3d const &C, double const *Mu, double const *Sigma, Vector3d &VT, double coreradius, bool bWakeOnly, bool bMultiThread) const;
+        void getVelocityVectors(int nPts, Vector3d const *C, double const *Mu, double const *Sigma, Vector3d *V, double coreradius, bool bWakeOnly, bool bMultiThread,
+                                double *Phi=nullptr, double *G=nullptr) const;
+        /** Adds the velocity, and the potential if phi is not null, induced at point C by the panels in the range [iStart, iEnd[ and by their wake columns */
+        virtual void velocityVectorRange(Vector3d const &C, int iStart, int iEnd, double const *Mu, double const *Sigma, double coreradius, bool bWakeOnly,
+                                         Vector3d &VT, double *phi) const = 0;
 
         void makeUnitRHSVectors();
         void makeWakeContribution();
 
-        void makeSourceStrengths(Vector3d const &WindDirection);
-        void makeSourceStrengths(std::vector<Vector3d> const &WindDirection);
+        void makeSourceStrengths(Vector3d const &WindDirection, double *Sigma) const;
+        void makeSourceStrengths(std::vector<Vector3d> const &WindDirection, double *Sigma) const;
 
         void vortonDrag(double alpha, double beta, double QInf, int n0, int nStations, Vector3d &Drag, SpanDistribs &SpanResFF) const;
 
@@ -104,22 +121,34 @@ class FL5LIB_EXPORT PanelAnalysis
 
         void combineUnitRHS(std::vector<double> &RHS, const Vector3d &VInf, const Vector3d &Omega);
         void makeRHS(const std::vector<Vector3d> &VField, std::vector<double> &RHS, const Vector3d *normals);
+        virtual bool backSubRHSBatch(double *RHS, int nRHS);
 
         void addWakeContribution();
+
+        uint64_t matrixKey() const;
+        bool fetchFactorization(uint64_t key);
+        void storeFactorization(uint64_t key) const;
+
+        void markMovedPanels(Vector3d const &bodyangles);
         void computeStabilityDerivatives(  double alphaeq, double u0, Vector3d const &CoG, bool bFuseMi, StabDerivatives &SD, Vector3d &Force0, Vector3d &Moment0);
         void computeTranslationDerivatives(double alphaeq, double u0, Vector3d const &CoG, bool bFuseMi, StabDerivatives &SD, Vector3d &Force0, Vector3d &Moment0);
         void computeAngularDerivatives(    double alphaeq, double u0, Vector3d const &CoG, bool bFuseMi, StabDerivatives &SD);
+        void makeUnitStabilityFields();
+        void perturbedForces(Vector3d const &VInf, Vector3d const &Omega, double alpha, Vector3d const &CoG, bool bFuseMi,
+                             std::vector<Vector3d> const &VField, Vector3d &Force, Vector3d &Moment);
 
         void traceLog(const QString &str) const;
         void traceStdLog(const std::string &str) const;
+        void setLogFunction(std::function<void(std::string const &)> const &logfunc) {m_LogFunction=logfunc;}
         inline double sourceStrength(const Vector3d &normal, Vector3d const &Velocity) const {return -1.0/4.0/PI * Velocity.dot(normal);}
         void releasePanelArrays();
 
         Polar3d const *polar3d() const {return m_pPolar3d;}
 
         int nVortonRows() const {return int(m_Vorton.size());}
-        void clearVortons() {m_Vorton.clear();}
+        void clearVortons() {m_Vorton.clear(); m_VortonTree.clear();}
         void getVortonVelocity(Vector3d const &C, double vtncorelength, Vector3d &VelVtn, bool bMultiThread=false) const;
+        void getVortonVelocities(int nPts, Vector3d const *C, Vector3d *V, double *G, bool bMultiThread) const;
         void getVortonRowVelocity(int iRow, Vector3d const &C, double vtncorelength, Vector3d *VelVtn) const;
         void getVortonVelocityGradient(Vector3d const &C, double *G) const;
 
@@ -127,27 +156,95 @@ class FL5LIB_EXPORT PanelAnalysis
         virtual void testResults(double alpha, double beta, double QInf) const = 0;
 
         static void setMultiThread(bool bMulti) {s_bMultiThread=bMulti;}
-        static void setMaxThreadCount(int maxthreads) {s_MaxThreads=maxthreads;}
+        static bool isMultiThreaded() {return s_bMultiThread;}
+        static void setMaxThreadCount(int maxthreads) {s_MaxThreads=maxthreads; ThreadPool::setThreadCount(maxthreads);}
+        static int maxThreadCount() {return s_MaxThreads;}
         static void setDoublePrecision(bool bDouble) {s_bDoublePrecision=bDouble;}
         static bool bDoublePrecision() {return s_bDoublePrecision;}
+        static void setMixedPrecision(bool bMixed) {s_bMixedPrecision=bMixed;}
+        static bool bMixedPrecision() {return s_bMixedPrecision;}
+        static bool bRefineSolution() {return !s_bDoublePrecision && s_bMixedPrecision && s_MatrixSolver==xfl::DENSELU;}
+        static void setMaxRefinements(int n) {s_MaxRefinements=n;}
+        static int maxRefinements() {return s_MaxRefinements;}
+        static void setMatrixSolver(xfl::enumMatrixSolver solver) {s_MatrixSolver=solver;}
+        static xfl::enumMatrixSolver matrixSolver() {return s_MatrixSolver;}
+        static bool bIterativeSolver() {return s_MatrixSolver==xfl::GMRES || s_MatrixSolver==xfl::BICGSTAB || s_MatrixSolver==xfl::HMATRIX;}
+        /** Returns true if the analysis builds the dense influence matrix with the current solver; the analyses without a tree solver use the dense matrix in place of BARNESHUT */
+        virtual bool bDenseMatrix() const {return s_MatrixSolver!=xfl::HMATRIX && s_MatrixSolver!=xfl::OUTOFCORE;}
+        static void setIterativeTolerance(double tol) {s_IterTolerance=tol;}
+        static double iterativeTolerance() {return s_IterTolerance;}
+        static void setIterativeMaxIter(int n) {s_IterMaxIter=n;}
+        static int iterativeMaxIter() {return s_IterMaxIter;}
+        static void setIncrementalMatrix(bool bIncremental) {s_bIncrementalMatrix=bIncremental;}
+        static bool bIncrementalMatrix() {return s_bIncrementalMatrix;}
 
         static void clearDebugPts() {s_DebugPts.clear(); s_DebugVecs.clear();}
 
 
     protected:
-        bool LUfactorize();
+        virtual bool LUfactorize();
         virtual void backSubUnitRHS(double *uRHS, double *vRHS, double*wRHS, double *pRHS, double *qRHS, double*rRHS);
-        bool backSubRHS(std::vector<double> &RHS);
+        virtual bool backSubRHS(std::vector<double> &RHS);
+
+        virtual void panelNeighbours(int p, std::vector<int> &neighbours) const;
+        virtual double panelRadius(int p) const;
+        virtual void wakeColumnPanels(std::vector<int> &panels) const;
+        /** Adds the geometry of the panels and of the wake panels, and the method-specific settings, to the factorization key */
+        virtual void hashPanels(LUCache::Key &key) const = 0;
+        /** Fills the array with the vertices of the panels, in panel order, with the same number of vertices for each panel */
+        virtual void panelVertices(std::vector<Vector3d> &vertices) const = 0;
+        bool refillMovedPanels();
+        void storeBodyMatrix();
+        bool makeHMatrix();
+        bool makeTiledMatrix();
+        void runBlocks(std::function<void(int)> const &blockfunc) const;
+        bool makeBlockPreconditioner();
+        void applyBlockPreconditioner(double const *x, double *y) const;
+        void denseMatVec(double const *x, double *y) const;
+        bool iterativeSolve(double *RHS, std::vector<double> &warmstart) const;
+        bool backSubSingle(double *RHS, int nRHS) const;
+        bool refineSolution(double *RHS, int nRHS) const;
+        bool streamedMatVec(double const *X, int nRHS, double *AX, double *anorm) const;
+        void addRecordedWakeCoefs();
+
+        /** Adds a wake coefficient to the influence matrix, whatever the matrix storage */
+        inline void addWakeCoef(int row, int col, int N, double value)
+        {
+            if(s_MatrixSolver==xfl::HMATRIX)        m_HMatrix.addWakeCoef(row, col, value);
+            else if(s_MatrixSolver==xfl::OUTOFCORE) m_TiledMatrix.addWakeCoef(row, col, value);
+            else if(bRefineSolution())              m_WakeCoef[uint(row)].push_back({col, value});
+            else if(s_bDoublePrecision)             m_aijd[uint(row*N+col)] += value;
+            else                                    m_aijf[uint(row*N+col)] += float(value);
+        }
 
     protected:
 
         mutable std::string m_ErrorLog;
+        std::function<void(std::string const &)> m_LogFunction;  /**< if set, receives the log messages, e.g. to forward them to the task's log */
 
         Polar3d const *m_pPolar3d;
 
         std::vector<double> m_aijd;  /**< the matrix of panel influences - double precision; std::vector is limited to 2 GB and is unusable*/
         std::vector<float>  m_aijf;  /**< the matrix of panel influences - single precision; std::vector is limited to 2 GB and is unusable*/
         std::vector<int>    m_ipiv;  /** the array of pivot indices for the LAPACK LU solver */
+        HMatrix m_HMatrix;           /**< the hierarchical matrix used in place of the dense matrix if s_MatrixSolver==HMATRIX */
+        TiledMatrix m_TiledMatrix;   /**< the out-of-core matrix used in place of the dense matrix if s_MatrixSolver==OUTOFCORE */
+        std::vector<std::vector<std::pair<int, double>>> m_WakeCoef; /**< the wake coefficients of each row in double precision, recorded for the residuals of the mixed precision solver */
+
+        // incremental updates of the influence matrix in the control polar loops, cf. markMovedPanels()
+        std::vector<double>   m_BodyAijd;         /**< the panel influence matrix of the last fill, without the wake contribution - double precision */
+        std::vector<float>    m_BodyAijf;         /**< the panel influence matrix of the last fill, without the wake contribution - single precision */
+        std::vector<Vector3d> m_BodyVertices;     /**< the panel vertices of the last fill, before the rotation of the whole mesh */
+        Vector3d              m_BodyAngles;       /**< the rotation angles of the whole mesh at the last fill */
+        std::vector<Vector3d> m_PendingVertices;  /**< the panel vertices of the current control value, before the rotation of the whole mesh */
+        Vector3d              m_PendingAngles;    /**< the rotation angles of the whole mesh for the current control value */
+        std::vector<int>      m_MovedPanels;      /**< the panels which have moved since the last fill */
+        bool m_bBodyMatrix;                       /**< true if the body matrix and vertices of the last fill are available */
+        bool m_bPendingVertices;                  /**< true if the current geometry has been recorded by markMovedPanels() and not yet used */
+
+        std::vector<std::vector<int>>    m_PrecondRows;  /**< the rows of each block of the iterative solver's preconditioner */
+        std::vector<std::vector<double>> m_PrecondInv;   /**< the inverted diagonal blocks of the iterative solver's preconditioner, row-major */
+        std::vector<double> m_WarmStart[7];              /**< the previous solutions used as initial guesses by the iterative solver: u, v, w, p, q, r and general RHS */
 
 
         // unit RHS for the 6 motion d.o.f
@@ -162,6 +259,16 @@ class FL5LIB_EXPORT PanelAnalysis
         std::vector<Vector3d> m_vVLocal;              /**< the array of unit velocity vectors for beta=PI/2, in local coordinates */
         std::vector<Vector3d> m_wVLocal;              /**< the array of unit velocity vectors for aoa=PI/2, in local coordinates */
 
+        // workspaces of the stability derivatives, sized once and reused at each operating point
+        std::vector<Vector3d> m_StabUnitVLocal[6];    /**< the surface velocities of the u, v, w, p, q, r unit solutions */
+        std::vector<Vector3d> m_StabUnitDownwash[6];  /**< the far-field downwash of the u, v, w, p, q, r unit solutions */
+        std::vector<double>   m_StabRHS;              /**< the combined solution of a perturbed state */
+        std::vector<double>   m_StabMu;               /**< the doublet densities of a perturbed state, in the layout expected by the force calculation */
+        std::vector<double>   m_StabSigma;            /**< the source strengths of a perturbed state */
+        std::vector<Vector3d> m_StabVLocal;           /**< the surface velocities of a perturbed state */
+        std::vector<Vector3d> m_StabDownwash;         /**< the far-field downwash of a perturbed state */
+        std::vector<Vector3d> m_StabVField[2];        /**< the freestream velocities of the + and - perturbed states */
+
         std::vector<double> m_Cp;                /**< The array of pressure coefficients on the panels. 1 value/panel in the case of the quad methods, 3 values/panel in the case of the triangular methods */
         std::vector<double> m_Mu;                /**< The array of doublet strengths, or vortex circulations, associated to the panels. 1 value/panel in the case of the quad methods, 3 values/panel in the case of the triangular methods */
         std::vector<double> m_Sigma;             /**< The array of resulting source strengths of the analysis. 1 value/panel for all methods. */
@@ -181,18 +288,20 @@ class FL5LIB_EXPORT PanelAnalysis
 
 
         std::vector<std::vector<Vorton>> m_Vorton; /** The array of vorton rows. Vortons are organized in rows. Each row is located in a crossflow plane. The number of vortons is variable for each row, due to vortex stretching and vorton redistribution. */
+        VortonTree m_VortonTree;            /** The octree of the vortons, rebuilt by setVortons() each time the vortons are created or advected */
         std::vector<Vortex> m_VortexNeg;    /** The array of negating vortices at the trailing edge of the trailing wake panel of each wake column. cf. Willis 2005 fig. 3*/
 
 
         static bool s_bDoublePrecision;
+        static bool s_bMixedPrecision;      /**< if true and in single precision, the solutions of the dense LU solver are refined to double precision accuracy */
+        static int s_MaxRefinements;
+        static xfl::enumMatrixSolver s_MatrixSolver;
+        static double s_IterTolerance;
+        static int s_IterMaxIter;
+        static bool s_bIncrementalMatrix;   /**< if true, the control polar loops update only the coefficients of the moved panels; false by default since a copy of the matrix is kept */
         static bool s_bMultiThread;
         static int s_MaxThreads;
 
-        mutable double const *tmp_Mu;
-        mutable double const *tmp_Sigma;
-        mutable double tmp_coreradius;
-        mutable bool tmp_bWakeOnly;
-
     public:
         static std::vector<Vector3d> s_DebugPts;
         static std::vector<Vector3d> s_DebugVecs;
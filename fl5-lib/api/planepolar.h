@@ -228,6 +228,7 @@ class FL5LIB_EXPORT PlanePolar : public Polar3d
         Vector3d CoGCtrl(double ctrl) const;
 
         AeroForces const &aeroForce(int index) const {return m_AF.at(index);}
+        double maxBending(int index) const {return m_MaxBending.at(index);}
 
         static std::vector<std::string> const &variableNames() {return s_VariableNames;}
         static void setVariableNames();
@@ -29,6 +29,7 @@
 #include <task3d.h>
 #include <t8opp.h>
 #include <aeroforces.h>
+#include <polarmesh.h>
 #include <spandistribs.h>
 #include <stabderivatives.h>
 #include <vorton.h>
@@ -47,6 +48,30 @@ class Polar;
 class XFoilTask;
 
 
+/**
+ * @brief The PlaneOppContext struct holds the state of an operating point from the
+ * calculation of the singularity strengths to the creation of the PlaneOpp.
+ * The T123458 loop uses one context per operating point so that the operating points
+ * can be calculated concurrently once the unit solutions are known.
+ * The arrays of densities and pressure coefficients are not owned by the context.
+ */
+struct PlaneOppContext
+{
+    double *m_Mu=nullptr;                       /**< the doublet densities of the operating point */
+    double *m_Sigma=nullptr;                    /**< the source densities of the operating point */
+    double *m_Cp=nullptr;                       /**< the pressure coefficients of the operating point */
+
+    AeroForces m_AF;                            /**< the overall aero forces acting on the plane */
+    std::vector<AeroForces> m_PartAF;           /**< the aero forces acting on each part */
+    std::vector<SpanDistribs> m_SpanDistFF;     /**< the span distributions of the wings */
+    std::vector<Vector3d> m_WingForce;          /**< the far field forces acting on the wings, in body axes (N/q) */
+    std::vector<std::vector<double>> m_FlapMoment; /**< the flap hinge moments of each wing */
+
+    std::string m_Log;                          /**< the log of the operating point, output when the operating point is stored */
+    bool m_bError=false;                        /**< true if the calculation of the operating point has failed */
+};
+
+
 class FL5LIB_EXPORT PlaneTask : public Task3d
 {
     public:
@@ -74,6 +99,7 @@ class FL5LIB_EXPORT PlaneTask : public Task3d
         void getVelocityVector(Vector3d const &C, double coreradius, bool bMultiThread, Vector3d &velocity) const;
 
         void setComputeDerivatives(bool b) {m_bDerivatives=b;}
+        void setMeshConnected(bool b) {m_bMeshConnected=b;}
 
         void run() override;
 
@@ -95,23 +121,26 @@ class FL5LIB_EXPORT PlaneTask : public Task3d
         void allocatePlaneResultArrays();
         void outputStateMatrices(PlaneOpp const *pPOpp);
         bool checkWPolarData(const Plane *pPlane, PlanePolar *pWPolar);
-        double computeBalanceSpeeds(double Alpha, double mass, bool &bWarning, const std::string &prefix, std::string &log);
-        double computeGlideSpeed(double Alpha, double mass, std::string &log);
-        void computeControlDerivatives(double t7ctrl, double alphaeq, double u0, StabDerivatives &SD);
+        double computeBalanceSpeeds(PlaneOppContext const &ctx, double Alpha, double Beta, double mass, bool &bWarning, const std::string &prefix, std::string &log) const;
+        double computeGlideSpeed(PlaneOppContext &ctx, double Alpha, double Beta, double mass, std::string &log) const;
+        void computeControlDerivatives(double t7ctrl, double alphaeq, double u0, double const *sigma, StabDerivatives &SD);
+        void setControlDeflection(int iCtrl, double deltactrl);
         void outputNDStabDerivatives(double u0, const StabDerivatives &SD);
-        PlaneOpp *computePlane(double ctrl, double Alpha, double Beta, double phi, double QInf, double mass, const Vector3d &CoG, bool bInGeomAxes);
+        PlaneOpp *computePlane(PlaneOppContext &ctx, double ctrl, double Alpha, double Beta, double phi, double QInf, double mass, const Vector3d &CoG, bool bInGeomAxes) const;
+        PlaneOpp *computeT123458Opp(T8Opp const &t8opp, PlaneOppContext &ctx, double mass, const Vector3d &CoG,
+                                    std::vector<Vector3d> const &uVLocal, std::vector<Vector3d> const &vVLocal, std::vector<Vector3d> const &wVLocal) const;
         void computeInviscidAero(const std::vector<Panel3> &panel3, const double *Cp3Vtx, const PlanePolar *pWPolar, double Alpha, AeroForces &AF) const;
-        void computeInducedForces(double alpha, double beta, double QInf);
-        void computeInducedDrag(double alpha, double beta, double QInf);
+        void computeInducedForces(PlaneOppContext &ctx, double alpha, double beta, double QInf) const;
+        void computeInducedDrag(PlaneOppContext &ctx, double alpha, double beta, double QInf) const;
         bool computeViscousDrag(WingXfl *pWing, double alpha, double beta, double QInf, const PlanePolar *pWPolar, Vector3d const &cog, int iStation0, SpanDistribs &SpanResFF, std::string &logmsg) const;
-        bool computeViscousDragOTF(WingXfl *pWing, double alpha, double beta, double QInf, const PlanePolar *pWPolar, Vector3d const &cog, const AngleControl &TEFlapAngles, SpanDistribs &SpanResFF, std::string &logmsg);
-        bool computeSurfaceDragOTF(Surface const &surf, int iStartStation, double theta, SpanDistribs &spandist);
+        bool computeViscousDragOTF(WingXfl *pWing, double alpha, double beta, double QInf, const PlanePolar *pWPolar, Vector3d const &cog, const AngleControl &TEFlapAngles, SpanDistribs &SpanResFF, std::string &logmsg) const;
+        bool computeSurfaceDragOTF(Surface const &surf, int iStartStation, double theta, SpanDistribs &spandist, std::string &report) const;
         bool computeSectionDragOTF(XFoilTask *pTask) const;
 
-        PlaneOpp *createPlaneOpp(double ctrl, double alpha, double beta, double phi, double QInf, double mass, const Vector3d &CoG, const double *Cp, const double *Gamma, const double *Sigma, bool bCpOnly=false) const;
+        PlaneOpp *createPlaneOpp(PlaneOppContext const &ctx, double ctrl, double alpha, double beta, double phi, double QInf, double mass, const Vector3d &CoG, const double *Cp, const double *Gamma, const double *Sigma, bool bCpOnly=false) const;
         void addTwistedVelField(double Qinf, double alpha, std::vector<Vector3d> &VField) const;
 
-        void scaleResultsToSpeed(double vOld, double vNew);
+        void scaleResultsToSpeed(PlaneOppContext &ctx, double vOld, double vNew) const;
 
         void setControlPositions(PlaneXfl const*pPlaneXfl, PlanePolar const*pWPolar, std::vector<Panel4> &panel4, double deltactrl, int iAVLCtrl, std::string &outstring);
         void setControlPositions(PlaneXfl const *pPlaneXfl, PlanePolar const *pWPolar, std::vector<Panel3> &panel3, const std::vector<Node> &refnodes, double deltactrl, int iAVLCtrl, std::string &outstring);
@@ -122,9 +151,10 @@ class FL5LIB_EXPORT PlaneTask : public Task3d
 
         bool setLinearSolution();
 
-        bool computeStability(PlaneOpp *pPOpp, bool bOutput);
+        bool computeStability(PlaneOpp *pPOpp, PlaneOppContext const &ctx, bool bOutput);
 
         void storePOpp(PlaneOpp *pPOpp);
+        void flushOppContext(PlaneOppContext &ctx);
 
     private:
 
@@ -133,6 +163,7 @@ class FL5LIB_EXPORT PlaneTask : public Task3d
         std::vector<PlaneOpp*> m_PlaneOppList;
 
         bool m_bDerivatives;       /**< if true, computes the eigenthings when running a T123458 polar */
+        bool m_bMeshConnected;     /**< if true, the reference and active triangular meshes of the plane already hold their connections, which are not recomputed */
 
         double m_Ctrl;             /**< the oppoint currently calculated */
         double m_Alpha;            /**< the aoa currently calculated */
@@ -143,15 +174,12 @@ class FL5LIB_EXPORT PlaneTask : public Task3d
         std::vector<double> m_AngleList, m_T6CtrlList, m_T7CtrlList;   /**< The list of operating points to analyze for each polar type*/
         std::vector<T8Opp> m_T8Opps;
 
-        std::vector<SpanDistribs> m_SpanDistFF; /**< the array of span distributions of the wings */
-        std::vector<Vector3d> m_WingForce;   /**< The array of calculated resulting forces acting on the wings in wind axis (N/q) */
-
         Vector3d m_Force0;  /** The calculated equilibrium force  @todo check body or wind axis*/
         Vector3d m_Moment0; /** The calculated equilibrium moment @todo check body or wind axis */
 
-        // temp variables used to create the operating point
-        AeroForces m_AF;               /** the overall aero forces acting on the plane */
-        std::vector<AeroForces> m_PartAF;  /** the array of Aero forces acting on each part, for each operating point */
+        PlaneOppContext m_Opp;          /**< the state of the operating point calculated by the T6 and T7 loops; also the template of the contexts of the T123458 loop */
+
+        PolarMesh m_PolarMesh;          /**< the index of the foil polars used to interpolate the viscous properties, made at the start of the task */
 
         std::vector<double> m_gamma;    /**< the virtual twist angle for each span section; cf. Computationally Efficient Transonic and Viscous Potential Flow Aero-Structural Method for Rapid Multidisciplinary Design Optimization of Aeroelastic Wing Shaping Control, by Eric Ting and Daniel Chaparro,  Advanced Modeling and Simulation (AMS) Seminar Series, Advanced Advanced Air Air Vehicles Transport Program Technology Project NASA Ames Research Center, June 28, 2017 */
 
@@ -244,6 +244,9 @@ class FL5LIB_EXPORT PlaneXfl : public Plane
         void setThickBuild(bool b) {m_bThickBuild=b;}
         bool isThickBuild() const {return m_bThickBuild;}
 
+        static void setParallelMeshing(bool bParallel) {s_bParallelMeshing=bParallel;}
+        static bool bParallelMeshing() {return s_bParallelMeshing;}
+
 
     private:
 
@@ -259,6 +262,8 @@ class FL5LIB_EXPORT PlaneXfl : public Plane
         QuadMesh m_RefQuadMesh; /** The reference quad mesh, with non-rotated panels */
         QuadMesh m_QuadMesh;    /** The active quad mesh, with panels rotated with surface angles */
 
+        static bool s_bParallelMeshing; /**< if true, the surfaces and the wings are meshed concurrently */
+
 
     public:
         mutable std::vector<OptVariable> m_OptVariables;
@@ -0,0 +1,101 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#pragma once
+
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <fl5lib_global.h>
+#include <polar.h>
+
+class Foil;
+
+
+/**
+ * @brief The PolarMesh class is a read-only index of the fixed speed polars of a set of foils,
+ * used to interpolate the viscous properties of the wing sections in the 3d analyses.
+ *
+ * The index is a snapshot of the polars' data made once at the start of a task:
+ *   - the polars of each foil are sorted by crescending Reynolds number;
+ *   - the limits, the zero-lift angle and the monotonous Cl branch around Cl=0 of each polar are precomputed;
+ *   - the lookups are binary searches instead of the linear scans of the Objects2d methods.
+ * The interpolation rules and the out-of-range flags are those of the Objects2d::getPlrPointFrom... methods.
+ * The query methods are const and do not access the global arrays,
+ * so that they can be called concurrently from the worker threads.
+ * The mesh must be rebuilt if the polars are modified.
+ */
+class FL5LIB_EXPORT PolarMesh
+{
+    private:
+        struct PolarTable
+        {
+            double m_Re=0;
+            double m_AlphaMin=0, m_AlphaMax=0;
+            double m_ClMin=0, m_ClMax=0;
+            int m_iCl0=0;          /**< the index of the point closest to Cl=0 */
+            int m_iClLow=0;        /**< the first index of the branch of increasing Cl values which contains m_iCl0 */
+            int m_iClHigh=0;       /**< the last index of the branch of increasing Cl values which contains m_iCl0 */
+            std::vector<std::vector<double>> m_Var; /**< the polar's arrays, indexed by Polar::enumPolarVariable */
+
+            std::vector<double> const &alpha() const {return m_Var.at(Polar::ALPHA);}
+            std::vector<double> const &cl()    const {return m_Var.at(Polar::CL);}
+
+            double interpolateFromAlpha(double alpha, Polar::enumPolarVariable PlrVar, bool &bOutAlpha) const;
+            double interpolateFromCl(double Cl, Polar::enumPolarVariable PlrVar, bool &bOutCl) const;
+        };
+
+        struct FoilTables
+        {
+            bool m_bHasPolars=false;              /**< true if the foil has at least one fixed speed polar, empty or not */
+            std::vector<PolarTable> m_Polar;      /**< the non-empty fixed speed polars, sorted by crescending Re */
+            std::vector<std::pair<double, double>> m_ZeroLift; /**< the Re and the zero-lift angle of the polars of any type, sorted by crescending Re */
+        };
+
+    public:
+        PolarMesh();
+
+        void clear();
+        bool isEmpty() const {return m_Foil.empty();}
+
+        void makeMesh(std::vector<Foil*> const &foils, std::vector<Polar*> const &polars);
+
+        double getPlrPointFromCl(Foil const*pFoil, double Re, double Cl, Polar::enumPolarVariable PlrVar, bool &bOutRe, bool &bOutCl) const;
+        double getPlrPointFromAlpha(Foil const*pFoil, double Re, double Alpha, Polar::enumPolarVariable PlrVar, bool &bOutRe, bool &bOutAlpha) const;
+        double getPlrPointFromAlpha(Polar::enumPolarVariable var, Foil const*pFoil0, Foil const*pFoil1, double Re, double Alpha, double Tau, bool &bOutRe, bool &bOutCl) const;
+
+        double getZeroLiftAngle(Foil const *pFoil0, Foil const*pFoil1, double Re, double Tau) const;
+        double getCm0(Foil const *pFoil0, Foil const *pFoil1, double Re, double Tau, bool &bOutRe, bool &bError) const;
+
+    private:
+        FoilTables const *foilTables(Foil const *pFoil) const;
+        double zeroLiftAngle(Foil const *pFoil, double Re) const;
+
+        static void makeTable(Polar const *pPolar, PolarTable &table);
+
+    private:
+        std::unordered_map<Foil const*, FoilTables> m_Foil;
+};
+
@@ -0,0 +1,83 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <unordered_map>
+#include <vector>
+
+#include <fl5lib_global.h>
+#include <vector3d.h>
+
+
+/**
+ * @brief The SpatialHash class is a uniform hash grid which indexes integer ids by position.
+ * It is used to accelerate the search for coincident nodes and for adjacent panels in the meshes.
+ *
+ * The cell size is set to the merge distance, so that all the positions which are
+ * within this distance of a point along each axis are stored in the 27 cells surrounding it.
+ * The search returns a superset of the matching ids; the caller is responsible for the
+ * exact comparison, so that the results are the same as with a brute force search.
+ */
+class FL5LIB_EXPORT SpatialHash
+{
+    public:
+        SpatialHash(double cellsize);
+
+        void clear() {m_Cell.clear();}
+        bool isEmpty() const {return m_Cell.empty();}
+
+        void insert(Vector3d const &pt, int id);
+        void remove(Vector3d const &pt, int id);
+
+        void candidates(Vector3d const &pt, std::vector<int> &ids, bool bSorted=true) const;
+        void appendCandidates(Vector3d const &pt, std::vector<int> &ids) const;
+
+        static void sortIds(std::vector<int> &ids);
+
+    private:
+        struct CellKey
+        {
+            int64_t i=0, j=0, k=0;
+            bool operator==(CellKey const &key) const {return i==key.i && j==key.j && k==key.k;}
+        };
+
+        struct CellKeyHash
+        {
+            size_t operator()(CellKey const &key) const
+            {
+                uint64_t h = uint64_t(key.i)*0x9E3779B97F4A7C15ULL;
+                h ^= uint64_t(key.j)*0xC2B2AE3D27D4EB4FULL + (h<<6) + (h>>2);
+                h ^= uint64_t(key.k)*0x165667B19E3779F9ULL + (h<<6) + (h>>2);
+                return size_t(h);
+            }
+        };
+
+        CellKey cellKey(Vector3d const &pt) const;
+
+    private:
+        double m_CellSize;
+        std::unordered_map<CellKey, std::vector<int>, CellKeyHash> m_Cell;
+};
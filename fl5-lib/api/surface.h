@@ -115,6 +115,7 @@ class FL5LIB_EXPORT Surface
         void addFlapPanel4(Panel4 const &p4);
         void addPanel3Index(int idx);
         void addPanel4Index(int idx);
+        void offsetPanel3Indexes(int offset);
         void copy(Surface const &pSurface);
         void createXPoints();
         inline void getC4(int kStrip, Vector3d &ptC4, double &tau) const;
@@ -253,7 +254,9 @@ class FL5LIB_EXPORT Surface
         void makePanelNodes(std::vector<Node> &nodes, bool bMakeLeftNodes, bool bMidSurface) const;
 
         void makeTriPanels(std::vector<Panel3> &panel3list, std::vector<Node> &nodes, int ip3start, bool bThickSurfaces, int nTipStrips, int &leftnodeidx, int &rightnodeindex);
-        int makeQuadPanels(std::vector<Panel4> &panel4list, int &nWakeColumn, bool bThickSurface, int nTipStrips);
+        int makeQuadPanels(std::vector<Panel4> &panel4list, int n4start, int &nWakeColumn, bool bThickSurface, int nTipStrips);
+        int quadPanelCount(bool bThickSurface, int nTipStrips) const;
+        int wakeColumnCount(bool bThickSurface) const {return bThickSurface ? m_NYPanels : 0;}
 
         int isNode(Vector3d const &Pt, std::vector<Panel4> const & panel4list) const;
         std::vector<int> const &panel3list() const {return m_Panel3List;}
@@ -81,7 +81,6 @@ class FL5LIB_EXPORT Task3d
         int nRHS() const {return m_nRHS;}
 
         void advectVortons(double alpha, double beta, double QInf, int qrhs);
-        void advectVortonRow(std::vector<Vorton> *thisrow);
 
 
         void stopVPWIterations() {m_bStopVPWIterations = true;}
@@ -135,13 +134,6 @@ class FL5LIB_EXPORT Task3d
 
         xfl::enumAnalysisStatus m_AnalysisStatus;
 
-        // temp variables used in the parallelization of vorton row advects
-        double const *tmp_Mu;
-        double const *tmp_Sigma;
-        double tmp_dt;
-        double tmp_vortonwakelength;
-        Vector3d tmp_VInf;
-
         bool m_bKeepOpps;
         bool m_bStdOut;
 
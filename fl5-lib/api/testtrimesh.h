@@ -0,0 +1,46 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+
+
+#pragma once
+
+#include <string>
+
+#include <trimesh.h>
+
+/**
+ * Reference implementations of the node merging and of the panel connections of the TriMesh class.
+ * They are the original search loops over all the nodes and panels, in O(n²), and are kept
+ * to check the results of the spatial hash implementation.
+ */
+
+FL5LIB_EXPORT int  makeNodeArrayFromPanelsRef(TriMesh &mesh, int firstnodeindex);
+FL5LIB_EXPORT void makeConnectionsFromNodePositionRef(TriMesh &mesh, bool bConnectTE);
+FL5LIB_EXPORT void makeConnectionsFromNodePosition2Ref(TriMesh &mesh, int i0, int np0, double MERGEDISTANCE);
+FL5LIB_EXPORT void connectNodesRef(TriMesh &mesh);
+
+FL5LIB_EXPORT bool isSameTriMesh(TriMesh const &mesh0, TriMesh const &mesh1, std::string &log);
+FL5LIB_EXPORT bool testTriMeshConnections(TriMesh const &mesh, std::string &log);
@@ -0,0 +1,141 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <fl5lib_global.h>
+
+
+/**
+ * @brief The ThreadPool class is the library-wide pool of worker threads used by the parallel loops of the analyses.
+ *
+ * The workers are created once and are kept alive between the loops.
+ * A loop is split in chunks which are distributed over the workers' queues;
+ * a worker which has emptied its own queue steals chunks from the back of the other queues,
+ * so that the load is balanced when the cost of the iterations is uneven.
+ * The calling thread takes part in the execution of its own loop, so that loops may be nested
+ * inside the chunks of another loop without deadlock.
+ *
+ * The thread count is set by PanelAnalysis::setMaxThreadCount; the pool is resized
+ * at the start of the next loop when no other loop is running.
+ */
+class FL5LIB_EXPORT ThreadPool
+{
+    public:
+        /** The function executed for each chunk [iStart, iEnd[ of the loop */
+        typedef std::function<void(int iStart, int iEnd)> rangeFunction;
+        /** The function which is polled before each chunk; the remaining chunks are skipped if it returns true */
+        typedef std::function<bool()> cancelFunction;
+
+    private:
+        struct Job
+        {
+            rangeFunction const *m_pFunc=nullptr;
+            cancelFunction const *m_pCancel=nullptr;
+            std::atomic<int> m_nRemaining{0};
+            std::atomic<bool> m_bCancelled{false};
+            std::mutex m_Mutex;
+            std::condition_variable m_Done;
+        };
+
+        struct Task
+        {
+            Job *m_pJob=nullptr;
+            int m_iStart=0;
+            int m_iEnd=0;
+        };
+
+        struct Queue
+        {
+            std::mutex m_Mutex;
+            std::deque<Task> m_Task;
+        };
+
+    public:
+        ~ThreadPool();
+
+        static void setThreadCount(int nThreads);
+        static int threadCount() {return s_nThreads;}
+
+        static bool parallelFor(int iStart, int iEnd, rangeFunction const &func, bool bMultiThread=true, int grain=0,
+                                cancelFunction const &cancelled=nullptr);
+
+        /**
+         * Returns the sum of the values returned by the function for each chunk of the range.
+         * The partial sums are added in the order of the chunks, so that the result does not depend
+         * on the scheduling of the threads.
+         */
+        template<typename T>
+        static T parallelReduce(int iStart, int iEnd, T const &zero, std::function<T(int, int)> const &func, bool bMultiThread=true, int grain=0)
+        {
+            if(iEnd<=iStart) return zero;
+            grain = chunkSize(iStart, iEnd, grain);
+            int nChunks = (iEnd-iStart+grain-1)/grain;
+            std::vector<T> partial(nChunks, zero);
+            parallelFor(iStart, iEnd, [&](int i0, int i1) {partial[(i0-iStart)/grain] = func(i0, i1);}, bMultiThread, grain);
+            T sum = zero;
+            for(T const &p : partial) sum += p;
+            return sum;
+        }
+
+        static int chunkSize(int iStart, int iEnd, int grain);
+
+    private:
+        ThreadPool();
+        static ThreadPool &instance();
+
+        bool run(int iStart, int iEnd, rangeFunction const &func, int grain, cancelFunction const &cancelled);
+        void resize();
+        void stopWorkers();
+        void workerLoop(int iWorker);
+        bool popTask(int iWorker, Task &task);
+        bool stealTask(int iWorker, Task &task);
+        bool stealJobTask(Job const *pJob, Task &task);
+        void execute(Task const &task);
+
+    private:
+        std::vector<std::unique_ptr<Queue>> m_Queue;  /**< one queue per worker */
+        std::vector<std::thread> m_Worker;
+
+        std::mutex m_WaitMutex;
+        std::condition_variable m_WakeUp;
+        std::atomic<int> m_nPending;     /**< the number of chunks waiting in the queues */
+        bool m_bStop;
+
+        std::mutex m_ConfigMutex;
+        int m_nActiveJobs;               /**< the number of loops running, the pool is resized only if none */
+        std::atomic<unsigned int> m_iNextQueue;
+
+        static int s_nThreads;           /**< the requested thread count, including the calling thread */
+};
+
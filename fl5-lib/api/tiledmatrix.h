@@ -0,0 +1,106 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#pragma once
+
+#include <fstream>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include <fl5lib_global.h>
+
+
+/**
+ * @brief The TiledMatrix class is an out-of-core storage and LU solver of the dense influence matrix,
+ * for the meshes whose matrix does not fit in memory.
+ *
+ * The matrix is stored in a scratch file as tiles of consecutive rows. Since the rows of the influence
+ * matrix are the columns of its transpose, which is the matrix factorized by LAPACK in PanelAnalysis,
+ * each tile is a column panel of the transposed matrix in column-major order.
+ *
+ * The factorization is left-looking: each tile is loaded once, updated with the factors of the previous tiles
+ * which are streamed from the file, factorized with partial pivoting, and written back.
+ * The row interchanges are not applied to the factors of the previous tiles; they are replayed
+ * in the same order during the back-substitution.
+ * The tile size is set so that three tiles fit in the memory budget: the tile being factorized,
+ * the tile being used for the update, and the next tile which is read in the background.
+ *
+ * The wake's contribution is stored separately as a sparse list of coefficients per row,
+ * and is added to the tiles when they are loaded for the factorization.
+ */
+class FL5LIB_EXPORT TiledMatrix
+{
+    public:
+        /** The function which returns the nBasis x nBasis block of influences of panel k on panel i, row-major; returns false in case of error */
+        typedef std::function<bool(int i, int k, double *block)> blockGenerator;
+        typedef std::function<void(std::string const &)> logFunction;
+        typedef std::function<bool()> cancelFunction;
+
+    public:
+        TiledMatrix();
+        ~TiledMatrix();
+
+        void clear();
+        bool isBuilt() const {return m_nRows>0;}
+        int size() const {return m_nRows;}
+        int nTiles() const {return int(m_TileStart.size())-1;}
+
+        bool build(int nPanels, int nBasis, blockGenerator const &generator, bool bMultiThread,
+                   logFunction const &log, cancelFunction const &cancelled);
+        void addWakeCoef(int row, int col, double value);
+        bool factorize(logFunction const &log, cancelFunction const &cancelled);
+        bool solve(double *RHS, int nRHS);
+
+        static void setMaxMemory(double MB) {s_MaxMemory=MB;}
+        static double maxMemory() {return s_MaxMemory;}
+        static void setDirectory(std::string const &dir) {s_Directory=dir;}
+        static std::string const &directory() {return s_Directory;}
+
+    private:
+        int tileRows(int iTile) const {return m_TileStart.at(iTile+1)-m_TileStart.at(iTile);}
+        bool readTile(int iTile, double *tile);
+        bool writeTile(int iTile, double const *tile);
+        std::string throughput() const;
+
+    private:
+        int m_nRows;                          /**< the size of the matrix */
+        std::vector<int> m_TileStart;         /**< the index of the first row of each tile, and the size of the matrix as the last element */
+        std::vector<int> m_ipiv;              /**< the pivot indices of the factorization, 1-based global row indices as in LAPACK */
+        std::vector<std::vector<std::pair<int,double>>> m_WakeCoef;  /**< the wake's coefficients, as (column, value) pairs for each row */
+
+        std::string m_FileName;
+        std::fstream m_File;
+        std::mutex m_FileMutex;
+
+        double m_ReadBytes, m_ReadTime;       /**< the amount of data read from the file and the time spent, for the log */
+        double m_WriteBytes, m_WriteTime;
+
+        static double s_MaxMemory;            /**< the memory budget of the tiles in MB */
+        static std::string s_Directory;       /**< the directory of the scratch file; the system's temporary directory if empty */
+};
+
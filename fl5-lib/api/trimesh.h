@@ -33,6 +33,7 @@
 #include <triangulation.h>
 
 class Node;
+class SpatialHash;
 
 class FL5LIB_EXPORT TriMesh : public XflMesh
 {
@@ -80,6 +81,7 @@ class FL5LIB_EXPORT TriMesh : public XflMesh
         void makeConnectionsFromNodePosition2(int i0, int n3_0, double MERGEDISTANCE);
 
         void copyConnections(TriMesh const &mesh3);
+        bool hasSameTopology(TriMesh const &mesh3) const;
 
         void checkElementSize(double minsize, std::vector<int> &elements, std::vector<double> &size);
 
@@ -141,7 +143,17 @@ class FL5LIB_EXPORT TriMesh : public XflMesh
         static void setCancelled(bool bCancel) {s_bCancel=bCancel;}
 
     private:
-        void connectPanelBlock(int iBlock, bool bConnectTE);
+        void connectPanelBlock(int iBlock, bool bConnectTE, SpatialHash const &panelhash);
+
+        void makePanelHash(int i0, int n3, SpatialHash &panelhash) const;
+        void adjacentPanelCandidates(SpatialHash const &panelhash, Panel3 const &p3, std::vector<int> &candidates) const;
+        void connectNode(int in, std::vector<int> const &nodepanels);
+
+        static void makeNodePanelList(std::vector<Panel3> const &panel3, int nNodes, std::vector<std::vector<int>> &nodepanels);
+        static void reindexPanelVertices(std::vector<Panel3> &panel3, std::vector<std::vector<int>> &nodepanels, int iNode, Node const &nd,
+                                         std::vector<int> &modpanels, std::vector<bool> &bModified);
+        template<class T>
+        static void removeElements(std::vector<T> &elements, std::vector<int> const &sortedindexes);
 
         void savePanels(QDataStream &ar);
         void loadPanels(QDataStream &ar);
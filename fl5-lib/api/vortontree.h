@@ -0,0 +1,94 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#pragma once
+
+#include <vector>
+
+#include <fl5lib_global.h>
+#include <vector3d.h>
+#include <vorton.h>
+
+
+/**
+ * @brief The VortonTree class evaluates the velocities and the velocity gradients induced by a set of vortons
+ * using a Barnes-Hut octree.
+ *
+ * The tree is built on the positions of the active vortons, and each node stores the sum of the vorticities
+ * and their first and second moments about the node's center:
+ *   - the nodes which are far from the evaluation point are represented by their monopole, dipole and quadrupole terms;
+ *   - the vortons of the nodes in the near field are evaluated exactly, with the mollified kernel.
+ * The evaluation of the velocity at one point scales as log(N) instead of N.
+ * The tree must be rebuilt each time the vortons are moved or created, i.e. once per advection step.
+ */
+class FL5LIB_EXPORT VortonTree
+{
+    private:
+        struct TreeNode
+        {
+            Vector3d m_Center;     /**< the vorticity-weighted centroid of the node's vortons */
+            double m_Radius=0;     /**< the radius of the sphere centered on m_Center which encloses all the node's vortons */
+            Vector3d m_Omega;      /**< the sum of the vortons' vorticities */
+            double m_Moment[9]{0,0,0,0,0,0,0,0,0}; /**< the first moment M_ij = sum (P-C)_i.omega_j, row-major */
+            double m_Quadrupole[27]{};             /**< the second moment Q_ijk = sum (P-C)_i.(P-C)_j.omega_k, row-major */
+            int m_iStart=0;        /**< the index of the node's first vorton in the permuted array */
+            int m_iEnd=0;          /**< the index past the node's last vorton in the permuted array */
+            int m_iChild[8]{-1,-1,-1,-1,-1,-1,-1,-1};
+            bool isLeaf() const {return m_iChild[0]<0;}
+        };
+
+    public:
+        VortonTree();
+
+        void clear();
+        bool isBuilt() const {return !m_Node.empty();}
+        int nVortons() const {return int(m_Vorton.size());}
+
+        void build(std::vector<std::vector<Vorton>> const &vortons);
+
+        void velocity(Vector3d const &C, double coresize, Vector3d &V) const;
+        void velocityGradient(Vector3d const &C, double coresize, double *G) const;
+
+        static void setEnabled(bool bEnabled) {s_bEnabled=bEnabled;}
+        static bool isEnabled() {return s_bEnabled;}
+        static void setTheta(double theta) {s_Theta=theta;}
+        static double theta() {return s_Theta;}
+        static void setLeafSize(int n) {s_LeafSize=n;}
+        static int leafSize() {return s_LeafSize;}
+        static void setMinVortons(int n) {s_MinVortons=n;}
+        static int minVortons() {return s_MinVortons;}
+
+    private:
+        int makeNode(int iStart, int iEnd, int depth);
+        bool isFarField(TreeNode const &node, Vector3d const &C, double coresize) const;
+
+    private:
+        std::vector<TreeNode> m_Node;      /**< the octree's nodes; children are always stored after their parent */
+        std::vector<Vorton> m_Vorton;      /**< the active vortons, permuted so that each node spans a contiguous range */
+
+        static bool s_bEnabled;
+        static double s_Theta;      /**< the Barnes-Hut opening criterion: a node is in the far field if its radius/distance < theta */
+        static int s_LeafSize;      /**< the max. number of vortons in a leaf node */
+        static int s_MinVortons;    /**< the number of vortons below which the tree is not built and the velocities are evaluated directly */
+};
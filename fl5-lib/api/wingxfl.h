@@ -111,15 +111,17 @@ class FL5LIB_EXPORT WingXfl : public Part
         int  quadTotal(bool bThinSurface) const;
 
         void panel4ComputeStrips(const std::vector<Panel4> &panel4list,
-                                 const PlanePolar *pWPolar, const Vector3d &CoG, double alpha, double beta, double QInf, const double *Cp, const double *Gamma, SpanDistribs &SpanResSum);
-        void panel3ComputeStrips(const std::vector<Panel3> &panel3list,  PlanePolar const *pWPolar, const Vector3d &CoG, double alpha, double beta, double QInf, const double *Cp3Vtx, SpanDistribs &SpanResSum);
+                                 const PlanePolar *pWPolar, const Vector3d &CoG, double alpha, double beta, double QInf, const double *Cp, const double *Gamma,
+                                 SpanDistribs &SpanResSum, std::vector<double> &FlapMoment) const;
+        void panel3ComputeStrips(const std::vector<Panel3> &panel3list,  PlanePolar const *pWPolar, const Vector3d &CoG, double alpha, double beta, double QInf, const double *Cp3Vtx,
+                                 SpanDistribs &SpanResSum, std::vector<double> &FlapMoment) const;
 
         void panel4ComputeInviscidForces(std::vector<Panel4> const &panel4list, const PlanePolar *pWPolar, const Vector3d &cog, double alpha, double beta, double QInf, double *Cp4, const double *Gamma, AeroForces &AF) const;
         void panel3ComputeInviscidForces(std::vector<Panel3> const &panel3list, const PlanePolar *pWPolar, const Vector3d &cog, double alpha, double beta, const double *Cp3Vtx, AeroForces &AF) const;
         void computeViscousForces(const PlanePolar *pWPolar, double alpha, double beta, SpanDistribs &SpanResFF, AeroForces &AF) const;
 
-        void panelComputeBending(const std::vector<Panel4> &panel4list, bool bThinSurface, SpanDistribs &SpanResFF);
-        void panelComputeBending(const std::vector<Panel3> &panel3list, bool bThinSurface, SpanDistribs &SpanResFF);
+        void panelComputeBending(const std::vector<Panel4> &panel4list, bool bThinSurface, SpanDistribs &SpanResFF) const;
+        void panelComputeBending(const std::vector<Panel3> &panel3list, bool bThinSurface, SpanDistribs &SpanResFF) const;
 
         bool isWingPanel4(int nPanel) const;
 
@@ -133,6 +135,7 @@ class FL5LIB_EXPORT WingXfl : public Part
         bool intersectWing(const Vector3d &O, const Vector3d &U, Vector3d &I, int &idxSurf, double &dist, bool bDirOnly) const;
 
         int makeTriPanels(int ip3start, int indStart, bool bThickSurfaces);
+        void offsetTriPanels(int ip3start, int indStart);
 
         void scaleSweep(double NewSweep);
         void scaleTwist(double NewTwist);
@@ -285,8 +288,6 @@ class FL5LIB_EXPORT WingXfl : public Part
 
         void getProperties(std::string &properties, const std::string &prefx) const;
 
-        double flapMomentAt(int iFlap) const {return m_FlapMoment.at(iFlap);}
-
         void makeTriangulation(const Fuse *pFuse, int CHORDPANELS);
 
         int nTipStrips() const {return m_nTipStrips;}
@@ -328,7 +329,6 @@ class FL5LIB_EXPORT WingXfl : public Part
         int m_nTipStrips;                /**< the number of horizontal panel strips in the left and right tip patches; introduced in v7.01 beta 09 */
 
         int m_nFlaps;                    /**< the number of T.E. flaps, numbered from left wing to right wing; for a main wing this number is even*/
-        std::vector<double> m_FlapMoment;      /**< the flap moments resulting from the panel of VLM analysis */
 
         std::vector<double> m_StripArea;
         std::vector<double> m_StripPos;
@@ -0,0 +1,102 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <fl5lib_global.h>
+
+class Foil;
+class Polar;
+
+
+/**
+ * @brief The XFoilCache class keeps the results of the XFoil on-the-fly calculations
+ * of the wing sections in the viscous 3d analyses.
+ *
+ * The results are identified by a hash of the foil's geometry, including the flap deflection,
+ * and of the polar's Mach number, NCrit and forced transition locations.
+ * A cached result is used if it matches the requested Re within a relative tolerance,
+ * and if the requested Cl is within the Cl tolerance of a cached point,
+ * in which case the results are interpolated linearly in Cl.
+ * The results are not interpolated in Re: the cached values at the nearby Re are used as they are,
+ * so that the results may differ from a direct XFoil calculation by the change of Cd over the Re tolerance,
+ * 1% by default. The cache is therefore disabled by default and must be activated with setEnabled().
+ * The cache is shared by all the analyses and is thread-safe.
+ * If a store file is set, the cache is loaded from and saved to this file,
+ * which is usually located next to the project file.
+ */
+class FL5LIB_EXPORT XFoilCache
+{
+    private:
+        struct Point
+        {
+            double m_Re=0, m_Cl=0;
+            double m_Cd=0, m_XTrTop=0, m_XTrBot=0;
+        };
+
+    public:
+        static int fetch(Foil const &foil, Polar &polar, Polar &otfpolar, std::vector<int> &index);
+        static void store(Foil const &foil, Polar const &otfpolar, std::vector<int> const &index, Polar &polar);
+        static void clear();
+        static int nPoints();
+
+        static bool load(std::string const &pathname);
+        static bool save(std::string const &pathname);
+        static void setStoreFile(std::string const &pathname);
+        static std::string const &storeFile() {return s_StoreFile;}
+
+        static void setEnabled(bool bEnabled) {s_bEnabled=bEnabled;}
+        static bool isEnabled() {return s_bEnabled;}
+        static void setStoreEnabled(bool bStore) {s_bStore=bStore;}
+        static bool bStore() {return s_bStore;}
+        static void setReTolerance(double tol) {s_ReTolerance=tol;}
+        static double ReTolerance() {return s_ReTolerance;}
+        static void setClTolerance(double tol) {s_ClTolerance=tol;}
+        static double ClTolerance() {return s_ClTolerance;}
+        static void setMaxPoints(int n) {s_MaxPoints=n;}
+        static int maxPoints() {return s_MaxPoints;}
+
+    private:
+        static uint64_t sectionKey(Foil const &foil, Polar const &polar);
+        static bool interpolate(std::vector<Point> const &section, double Re, double Cl, Point &result);
+
+    private:
+        static std::unordered_map<uint64_t, std::vector<Point>> s_Section;  /**< the cached points of each foil section and analysis settings */
+        static int s_nPoints;
+        static std::mutex s_Mutex;
+
+        static bool s_bEnabled;           /**< false by default; the cached results are approximate */
+        static bool s_bStore;             /**< true if the cache should be saved to the store file */
+        static std::string s_StoreFile;   /**< the file in which the cache is saved, or empty if the cache is held in memory only */
+        static double s_ReTolerance;      /**< the max. relative difference of Re between a cached point and a requested point */
+        static double s_ClTolerance;      /**< the max. difference of Cl between the cached points and a requested point */
+        static int s_MaxPoints;           /**< the cache is reset when this number of points is exceeded */
+};
+
@@ -27,6 +27,8 @@
 
 
 #include <condition_variable>
+#include <list>
+#include <memory>
 #include <mutex>
 #include <queue>
 
@@ -108,6 +110,9 @@ class FL5LIB_EXPORT XFoilTask
         void traceLog(const QString &str);
         void traceStdLog(const std::string &str);
 
+        void cancelTask() {m_XFoilInstance.setInstanceCancel(true);}
+        bool bCancelled() const {return s_bCancel || m_XFoilInstance.isInstanceCancelled();}
+
         static void setCancelled(bool b);
 
         static int maxIterations() {return s_IterLim;}
@@ -116,6 +121,10 @@ class FL5LIB_EXPORT XFoilTask
         static double CdError() {return s_CdError;}
         static double setCdError(double cderr) {return s_CdError=cderr;}
 
+        void setBatchMode(bool bBatch) {m_bBatchMode=bBatch;}
+        bool bBatchMode() const {return m_bBatchMode;}
+        static void clearBatchData();
+
     private:
         int loop();
         bool alphaSequence(bool bAlpha);
@@ -125,6 +134,10 @@ class FL5LIB_EXPORT XFoilTask
 
         bool processClRange(Polar *pPolar, const AnalysisRange &range);
 
+        bool initBatchInviscid();
+        bool warmStartBL(double Re, double value, bool bAlpha);
+        void storeBLState();
+
 
     private:
         bool m_bErrors;
@@ -141,6 +154,8 @@ class FL5LIB_EXPORT XFoilTask
         bool m_bAlpha;             /**< true if performing an analysis based on aoa, false if based on Cl */
 
         bool m_bKeepOpps;
+        bool m_bBatchMode;         /**< true if the inviscid factorization is shared with the other tasks of a batch analysis, and if the BL is warm started */
+        std::list<XFoilBLState> m_BLState;  /**< in batch mode, the BL states of this task's converged operating points, most recent first */
 
         std::string m_Log;
 
@@ -154,6 +169,13 @@ class FL5LIB_EXPORT XFoilTask
         static bool s_bAutoInitBL;        /**< true if the BL initialization is left to the code's decision */
         static double s_CdError;          /**< discard points with |Cd| less than this value: these operating points are likely erroneous (spurious?) */
 
+        // data shared by the tasks in batch mode
+        static std::mutex s_BatchMutex;
+        static std::condition_variable s_BatchCV;
+        static std::list<std::pair<uint64_t, std::shared_ptr<XFoilInviscid const>>> s_Inviscid; /**< the factorizations of each panel geometry, most recent first; nullptr while in progress */
+        static int s_MaxInviscid;
+        static int s_MaxBLStates;         /**< the max. number of BL states kept by each task */
+
 
     public:
         // thread related variables to share the message queue with the calling thread
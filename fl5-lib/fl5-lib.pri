@@ -55,9 +55,11 @@ HEADERS += \
     api/gqtriangle.h \
     api/hanning.h \
     api/hermiteinterpolation.h \
+    api/hmatrix.h \
     api/inertia.h \
     api/linestyle.h \
     api/llttask.h \
+    api/lucache.h \
     api/mathelem.h \
     api/matrix.h \
     api/mctriangle.h \
@@ -65,6 +67,7 @@ HEADERS += \
     api/naca4spline.h \
     api/node.h \
     api/node2d.h \
+    api/nurbsevaluator.h \
     api/nurbssurface.h \
     api/objects2d.h \
     api/objects2d_globals.h \
@@ -77,7 +80,9 @@ HEADERS += \
     api/oppoint.h \
     api/optstructures.h \
     api/p3analysis.h \
+    api/p3kernelview.h \
     api/p3linanalysis.h \
+    api/p3treesolver.h \
     api/p3unianalysis.h \
     api/p4analysis.h \
     api/panel.h \
@@ -96,6 +101,7 @@ HEADERS += \
     api/pointspline.h \
     api/polar.h \
     api/polar3d.h \
+    api/polarmesh.h \
     api/pslg2d.h \
     api/qrleastsquares.h \
     api/quad2d.h \
@@ -116,6 +122,7 @@ HEADERS += \
     api/segment3d.h \
     api/sgsmooth.h \
     api/spandistribs.h \
+    api/spatialhash.h \
     api/spline.h \
     api/splinefoil.h \
     api/stabderivatives.h \
@@ -124,6 +131,9 @@ HEADERS += \
     api/t8opp.h \
     api/task3d.h \
     api/testpanels.h \
+    api/testtrimesh.h \
+    api/threadpool.h \
+    api/tiledmatrix.h \
     api/trace.h \
     api/triangle2d.h \
     api/triangle3d.h \
@@ -135,12 +145,14 @@ HEADERS += \
     api/vector3d.h \
     api/vortex.h \
     api/vorton.h \
+    api/vortontree.h \
     api/wingopp.h \
     api/wingsailsection.h \
     api/wingsection.h \
     api/wingxfl.h \
     api/xflmesh.h \
     api/xflobject.h \
+    api/xfoilcache.h \
     api/xfoiltask.h \
     api/xml_globals.h \
     api/xmlpolarreader.h \
@@ -172,13 +184,17 @@ SOURCES += \
     $$PWD/xml/xplane/xmlplanepolarwriter.cpp \
     analysis3d/boattask.cpp \
     analysis3d/llttask.cpp \
+    analysis3d/lucache.cpp \
     analysis3d/p3analysis.cpp \
+    analysis3d/p3kernelview.cpp \
     analysis3d/p3linanalysis.cpp \
+    analysis3d/p3treesolver.cpp \
     analysis3d/p3unianalysis.cpp \
     analysis3d/p4analysis.cpp \
     analysis3d/panelanalysis.cpp \
     analysis3d/planetask.cpp \
     analysis3d/task3d.cpp \
+    analysis3d/vortontree.cpp \
     api/api.cpp \
     geom/geom2d/node2d.cpp \
     geom/geom2d/pslg2d.cpp \
@@ -194,6 +210,7 @@ SOURCES += \
     geom/geom3d/bspline3d.cpp \
     geom/geom3d/frame.cpp \
     geom/geom3d/node.cpp \
+    geom/geom3d/nurbsevaluator.cpp \
     geom/geom3d/nurbssurface.cpp \
     geom/geom3d/quad3d.cpp \
     geom/geom3d/quaternion.cpp \
@@ -206,12 +223,15 @@ SOURCES += \
     math/gaussquadrature.cpp \
     math/hanning.cpp \
     math/hermiteinterpolation.cpp \
+    math/hmatrix.cpp \
     math/mathelem.cpp \
     math/matrix.cpp \
     math/qrleastsquares.cpp \
     math/rungekutta.cpp \
     math/sgsmooth.cpp \
+    math/tiledmatrix.cpp \
     objects2d/analysis2d/stream2d.cpp \
+    objects2d/analysis2d/xfoilcache.cpp \
     objects2d/analysis2d/xfoiltask.cpp \
     objects2d/foilobjects/bldata.cpp \
     objects2d/foilobjects/blxfoil.cpp \
@@ -219,6 +239,7 @@ SOURCES += \
     objects2d/foilobjects/oppoint.cpp \
     objects2d/foilobjects/panel2d.cpp \
     objects2d/foilobjects/polar.cpp \
+    objects2d/foilobjects/polarmesh.cpp \
     objects2d/foilobjects/splinefoil.cpp \
     objects2d/globals/objects2d_globals.cpp \
     objects2d/objects2d.cpp \
@@ -266,6 +287,8 @@ SOURCES += \
     occ/occmeshparams.cpp \
     panels/mesh/mesh_globals.cpp\
     panels/mesh/quadmesh.cpp \
+    panels/mesh/spatialhash.cpp \
+    panels/mesh/testtrimesh.cpp \
     panels/mesh/trimesh.cpp \
     panels/mesh/xflmesh.cpp \
     panels/panels/gqtriangle.cpp \
@@ -280,6 +303,7 @@ SOURCES += \
     utils/apilog.cpp \
     utils/fileio.cpp \
     utils/fl5color.cpp \
+    utils/threadpool.cpp \
     utils/trace.cpp \
     utils/units.cpp \
     utils/utils.cpp \
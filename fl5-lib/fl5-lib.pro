@@ -33,6 +33,9 @@ linux-g++ {
 
     DEFINES += LINUX_OS
 
+    # allows the compiler to vectorize the branch-free panel loops, cf. P3KernelView
+    QMAKE_CXXFLAGS += -fno-math-errno -fno-trapping-math
+
     isEmpty(PREFIX){
         PREFIX = /usr/local
     }
@@ -131,6 +134,8 @@ macx {
     DEFINES += MAC_OS
     DEFINES += GL_SILENCE_DEPRECATION   #Shame
 
+    QMAKE_CXXFLAGS += -fno-math-errno -fno-trapping-math
+
 
     QMAKE_MAC_SDK = macosx
     QMAKE_APPLE_DEVICE_ARCHS = x86_64 arm64
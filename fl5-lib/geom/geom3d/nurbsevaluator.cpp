@@ -0,0 +1,429 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#include <nurbsevaluator.h>
+
+#include <constants.h>
+#include <geom_global.h>
+#include <nurbssurface.h>
+#include <triangle3d.h>
+
+
+/**
+ * Builds the evaluator from the current state of the surface.
+ * Assumes that the knots of the surface have been set previously.
+ */
+NURBSEvaluator::NURBSEvaluator(NURBSSurface const &nurbs)
+{
+    m_pNurbs = &nurbs;
+
+    m_nu = nurbs.frameCount();
+    m_nv = nurbs.framePointCount();
+    m_uDegree = nurbs.uDegree();
+    m_vDegree = nurbs.vDegree();
+    m_bSpanLocal = m_uDegree<=NURBSMAXDEGREE && m_vDegree<=NURBSMAXDEGREE;
+
+    m_uKnot = nurbs.uKnot();
+    m_vKnot = nurbs.vKnot();
+
+    m_uWeight.resize(m_nu);
+    for(int iu=0; iu<m_nu; iu++) m_uWeight[iu] = nurbs.weight(nurbs.uEdgeWeight(), iu, m_nu);
+    m_vWeight.resize(m_nv);
+    for(int jv=0; jv<m_nv; jv++) m_vWeight[jv] = nurbs.weight(nurbs.vEdgeWeight(), jv, m_nv);
+
+    // getPoint() and getNormal() use different thresholds to rotate the frames;
+    // the second net is only stored if a frame angle lies in between
+    bool bNormalNet = false;
+    for(int iu=0; iu<m_nu; iu++)
+    {
+        double angle = fabs(nurbs.frameAt(iu).angle());
+        if(angle>ANGLEPRECISION && angle<=0.01) bNormalNet = true;
+    }
+
+    m_Net.resize(m_nu*m_nv);
+    if(bNormalNet) m_NormalNet.resize(m_nu*m_nv);
+    for(int iu=0; iu<m_nu; iu++)
+    {
+        Frame const &uframe = nurbs.frameAt(iu);
+        for(int jv=0; jv<m_nv; jv++)
+        {
+            Vector3d rpt = uframe.ctrlPointAt(jv);
+            if(bNormalNet)
+            {
+                m_NormalNet[iu*m_nv+jv] = rpt;
+                if(fabs(uframe.angle())>0.01) //degrees
+                    m_NormalNet[iu*m_nv+jv].rotateY(uframe.position(), uframe.angle());
+            }
+            if(fabs(uframe.angle())>ANGLEPRECISION) //degrees
+                rpt.rotateY(uframe.position(), uframe.angle());
+            m_Net[iu*m_nv+jv] = rpt;
+        }
+    }
+}
+
+
+/**
+ * Sums the weighted contributions of the control points given the non-zero basis functions in each direction.
+ */
+void NURBSEvaluator::pointFromBasis(int iu0, int nu, double const *Nu, int jv0, int nv, double const *Nv, Vector3d &Pt) const
+{
+    Vector3d V, Vv;
+    double totalweight = 0.0;
+    for(int k=0; k<nu; k++)
+    {
+        int iu = iu0+k;
+        Vv.set(0.0,0.0,0.0);
+        double wx = 0.0;
+        for(int l=0; l<nv; l++)
+        {
+            int jv = jv0+l;
+            double cs = Nv[l] * m_vWeight[jv];
+            Vector3d const &rpt = ctrlPoint(iu, jv);
+
+            Vv.x += rpt.x * cs;
+            Vv.y += rpt.y * cs;
+            Vv.z += rpt.z * cs;
+
+            wx += cs;
+        }
+        double bs = Nu[k] * m_uWeight[iu];
+
+        V.x += Vv.x * bs;
+        V.y += Vv.y * bs;
+        V.z += Vv.z * bs;
+
+        totalweight += wx * bs;
+    }
+
+    Pt.x = V.x / totalweight;
+    Pt.y = V.y / totalweight;
+    Pt.z = V.z / totalweight;
+}
+
+
+/**
+ * Returns the point corresponding to the pair of parameters (u,v).
+ * @see NURBSSurface::getPoint()
+ */
+void NURBSEvaluator::getPoint(double u, double v, Vector3d &Pt) const
+{
+    if(!m_bSpanLocal)
+    {
+        m_pNurbs->getPoint_ref(u, v, Pt);
+        return;
+    }
+
+    if(u<0.0)  u=0.0;
+    if(v<0.0)  v=0.0;
+    if(u>=1.0) u=0.99999999999;
+    if(v>=1.0) v=0.99999999999;
+
+    double Nu[NURBSMAXDEGREE+1], Nv[NURBSMAXDEGREE+1];
+    int iu0=0, nu=0, jv0=0, nv=0;
+    geom::spanBasis(m_nu, m_uDegree, u, m_uKnot.data(), iu0, nu, Nu);
+    geom::spanBasis(m_nv, m_vDegree, v, m_vKnot.data(), jv0, nv, Nv);
+
+    pointFromBasis(iu0, nu, Nu, jv0, nv, Nv, Pt);
+}
+
+
+/**
+ * Returns the point and the two partial derivatives of the rational surface at the pair of parameters (u,v).
+ * The parameters are clamped as in getPoint().
+ * @param Pt the point on the surface
+ * @param Su the derivative with respect to u
+ * @param Sv the derivative with respect to v
+ */
+void NURBSEvaluator::getDerivatives(double u, double v, Vector3d &Pt, Vector3d &Su, Vector3d &Sv) const
+{
+    if(!m_bSpanLocal)
+    {
+        // finite differences on the reference evaluation
+        double const du = 1.e-7;
+        Vector3d P0, P1;
+        m_pNurbs->getPoint_ref(u, v, Pt);
+        m_pNurbs->getPoint_ref(u-du, v, P0);
+        m_pNurbs->getPoint_ref(u+du, v, P1);
+        Su = (P1-P0)/(2.0*du);
+        m_pNurbs->getPoint_ref(u, v-du, P0);
+        m_pNurbs->getPoint_ref(u, v+du, P1);
+        Sv = (P1-P0)/(2.0*du);
+        return;
+    }
+
+    if(u<0.0)  u=0.0;
+    if(v<0.0)  v=0.0;
+    if(u>=1.0) u=0.99999999999;
+    if(v>=1.0) v=0.99999999999;
+
+    double Nu[NURBSMAXDEGREE+1], dNu[NURBSMAXDEGREE+1], Nv[NURBSMAXDEGREE+1], dNv[NURBSMAXDEGREE+1];
+    int iu0=0, nu=0, jv0=0, nv=0;
+    geom::spanBasis(m_nu, m_uDegree, u, m_uKnot.data(), iu0, nu, Nu, dNu);
+    geom::spanBasis(m_nv, m_vDegree, v, m_vKnot.data(), jv0, nv, Nv, dNv);
+
+    // homogeneous sums A=sum(w.N.P) and W=sum(w.N), and their derivatives
+    Vector3d A, Au, Av;
+    double W=0, Wu=0, Wv=0;
+    for(int k=0; k<nu; k++)
+    {
+        int iu = iu0+k;
+        Vector3d Vv, dVv;
+        double wx=0, dwx=0;
+        for(int l=0; l<nv; l++)
+        {
+            int jv = jv0+l;
+            double cs  = Nv[l]  * m_vWeight[jv];
+            double dcs = dNv[l] * m_vWeight[jv];
+            Vector3d const &rpt = ctrlPoint(iu, jv);
+
+            Vv.x  += rpt.x * cs;
+            Vv.y  += rpt.y * cs;
+            Vv.z  += rpt.z * cs;
+            dVv.x += rpt.x * dcs;
+            dVv.y += rpt.y * dcs;
+            dVv.z += rpt.z * dcs;
+            wx  += cs;
+            dwx += dcs;
+        }
+        double bs  = Nu[k]  * m_uWeight[iu];
+        double dbs = dNu[k] * m_uWeight[iu];
+
+        A  += Vv  * bs;
+        Au += Vv  * dbs;
+        Av += dVv * bs;
+        W  += wx  * bs;
+        Wu += wx  * dbs;
+        Wv += dwx * bs;
+    }
+
+    Pt = A/W;
+    Su = (Au - Pt*Wu)/W;
+    Sv = (Av - Pt*Wv)/W;
+}
+
+
+/**
+ * Returns the unit normal to the surface at the pair of parameters (u,v).
+ * @see NURBSSurface::getNormal()
+ */
+void NURBSEvaluator::getNormal(double u, double v, Vector3d &N) const
+{
+    if(!m_bSpanLocal)
+    {
+        m_pNurbs->getNormal_ref(u, v, N);
+        return;
+    }
+
+    u=std::max(u, 1e-4);
+    v=std::max(v, 1e-4);
+    u=std::min(u, 1.0-1.e-4);
+    v=std::min(v, 1.0-1.e-4);
+
+    double Nu[NURBSMAXDEGREE+1], dNu[NURBSMAXDEGREE+1], Nv[NURBSMAXDEGREE+1], dNv[NURBSMAXDEGREE+1];
+    int iu0=0, nu=0, jv0=0, nv=0;
+    geom::spanBasis(m_nu, m_uDegree, u, m_uKnot.data(), iu0, nu, Nu, dNu);
+    geom::spanBasis(m_nv, m_vDegree, v, m_vKnot.data(), jv0, nv, Nv, dNv);
+
+    Vector3d Su, Sv, Vv, dVv;
+    for(int k=0; k<nu; k++)
+    {
+        Vv.reset();
+        dVv.reset();
+        for(int l=0; l<nv; l++)
+        {
+            Vector3d const &rpt = normalCtrlPoint(iu0+k, jv0+l);
+
+            Vv.x  += rpt.x * Nv[l];
+            Vv.y  += rpt.y * Nv[l];
+            Vv.z  += rpt.z * Nv[l];
+            dVv.x += rpt.x * dNv[l];
+            dVv.y += rpt.y * dNv[l];
+            dVv.z += rpt.z * dNv[l];
+        }
+
+        Su.x += Vv.x * dNu[k];
+        Su.y += Vv.y * dNu[k];
+        Su.z += Vv.z * dNu[k];
+        Sv.x += dVv.x * Nu[k];
+        Sv.y += dVv.y * Nu[k];
+        Sv.z += dVv.z * Nu[k];
+    }
+
+    N = (Su * Sv).normalized();
+}
+
+
+/**
+ * Evaluates the points for the pairs of parameters (u[i], v[i]).
+ * @param points on output, the array of u.size() points
+ */
+void NURBSEvaluator::getPoints(std::vector<double> const &u, std::vector<double> const &v, std::vector<Vector3d> &points) const
+{
+    assert(u.size()==v.size());
+    points.resize(u.size());
+    for(uint i=0; i<u.size(); i++)
+        getPoint(u.at(i), v.at(i), points[i]);
+}
+
+
+/**
+ * Evaluates the points at the nodes of the grid defined by the arrays of parameters u and v.
+ * The basis functions are computed once for each value of u and of v.
+ * @param points on output, the array of u.size() x v.size() points; the point (u[i], v[j]) is at index i*v.size()+j
+ */
+void NURBSEvaluator::getGrid(std::vector<double> const &u, std::vector<double> const &v, std::vector<Vector3d> &points) const
+{
+    int nU = int(u.size());
+    int nV = int(v.size());
+    points.resize(nU*nV);
+
+    if(!m_bSpanLocal)
+    {
+        for(int i=0; i<nU; i++)
+            for(int j=0; j<nV; j++)
+                m_pNurbs->getPoint_ref(u.at(i), v.at(j), points[i*nV+j]);
+        return;
+    }
+
+    int const order = m_vDegree+1;
+    std::vector<int> jv0(nV), nvcount(nV);
+    std::vector<double> Nv(nV*order);
+    for(int j=0; j<nV; j++)
+    {
+        double vj = v.at(j);
+        if(vj<0.0)  vj=0.0;
+        if(vj>=1.0) vj=0.99999999999;
+        geom::spanBasis(m_nv, m_vDegree, vj, m_vKnot.data(), jv0[j], nvcount[j], Nv.data()+j*order);
+    }
+
+    double Nu[NURBSMAXDEGREE+1];
+    int iu0=0, nu=0;
+    for(int i=0; i<nU; i++)
+    {
+        double ui = u.at(i);
+        if(ui<0.0)  ui=0.0;
+        if(ui>=1.0) ui=0.99999999999;
+        geom::spanBasis(m_nu, m_uDegree, ui, m_uKnot.data(), iu0, nu, Nu);
+
+        for(int j=0; j<nV; j++)
+            pointFromBasis(iu0, nu, Nu, jv0[j], nvcount[j], Nv.data()+j*order, points[i*nV+j]);
+    }
+}
+
+
+#define NDIV 5 // fastest
+#define NVTX (NDIV+1)
+/**
+ * Finds the intersection of the ray [A,B] with the NURBS by successive intersections with triangles.
+ * Same algorithm as NURBSSurface::intersect(); the vertices of each subdivision level are evaluated as a grid.
+ * @return true if an intersection point could be determined
+ */
+bool NURBSEvaluator::intersect(Vector3d const&A, Vector3d const&B, double &u, double &v, Vector3d &I) const
+{
+    double umin=0, umax=1.0;
+    double vmin=0, vmax=1.0;
+    double umin1=0, umax1=1.0;
+    double vmin1=0, vmax1=1.0;
+    double pcrit = 1.e-2;
+
+    int iter =0;
+    int itermax=30;
+
+    Triangle3d t3d;
+    std::vector<double> ugrid(NVTX), vgrid(NVTX);
+    std::vector<Vector3d> Vtx;
+    do
+    {
+        for(int i=0; i<NVTX; i++)
+        {
+            double di = double(i)/double(NVTX-1);
+            ugrid[i] = (1.0-di)*umin+di*umax;
+            vgrid[i] = (1.0-di)*vmin+di*vmax;
+        }
+        getGrid(ugrid, vgrid, Vtx);
+
+        bool bIntersect = false;
+        for(int k=0; k<NDIV*NDIV; k++)
+        {
+            int i = int(double(k)/double(NDIV));
+            int j = k-i*NDIV;
+
+            t3d.setTriangle(Vtx[i*NVTX+j], Vtx[i*NVTX+j+1], Vtx[(i+1)*NVTX+j+1]);
+
+            if(t3d.intersectSegmentInside(A, B, I, true))
+            {
+                double di  = double(i)/double(NVTX-1);
+                double dj  = double(j)/double(NVTX-1);
+                double di1 = double(i+1)/double(NVTX-1);
+                double dj1 = double(j+1)/double(NVTX-1);
+                umin1 = (1.0-di) *umin + di *umax;
+                umax1 = (1.0-di1)*umin + di1*umax;
+                vmin1 = (1.0-dj) *vmin + dj *vmax;
+                vmax1 = (1.0-dj1)*vmin + dj1*vmax;
+
+                umin=umin1;      umax=umax1;
+                vmin=vmin1;      vmax=vmax1;
+                bIntersect = true;
+                break;
+            }
+            else
+            {
+                t3d.setTriangle(Vtx[i*NVTX+j], Vtx[(i+1)*NVTX+j+1], Vtx[(i+1)*NVTX+j]);
+
+                if(t3d.intersectSegmentInside(A, B, I, true))
+                {
+                    double di  = double(i)  /double(NVTX-1);
+                    double dj  = double(j)  /double(NVTX-1);
+                    double di1 = double(i+1)/double(NVTX-1);
+                    double dj1 = double(j+1)/double(NVTX-1);
+                    umin1 = (1.0-di) *umin + di *umax;
+                    umax1 = (1.0-di1)*umin + di1*umax;
+                    vmin1 = (1.0-dj) *vmin + dj *vmax;
+                    vmax1 = (1.0-dj1)*vmin + dj1*vmax;
+
+                    // extend the next triangles to avoid any boundary precision issue
+                    umin=umin1*0.99;      umax=umax1*1.01;
+                    vmin=vmin1*0.99;      vmax=vmax1*1.01;
+
+                    bIntersect = true;
+                    break;
+                }
+            }
+        }
+
+        if(!bIntersect)
+            return false;
+
+        iter++;
+        if(iter>=itermax)
+            return false;
+    }
+    while (fabs(umax-umin)>pcrit && fabs(vmax-vmin)>pcrit);
+
+    u = (umin+umax)/2.0;
+    v = (vmin+vmax)/2.0;
+
+    return true;
+}
@@ -29,6 +29,7 @@
 #include <frame.h>
 #include <geom_global.h>
 #include <node.h>
+#include <nurbsevaluator.h>
 #include <quad3d.h>
 #include <triangle3d.h>
 
@@ -229,12 +230,127 @@ double NURBSSurface::getvIntersect(double u, Vector3d r) const
  * Returns the point corresponding to the pair of parameters (u,v)
  * Assumes that the knots have been set previously
  *
- * Scans the u-direction first, then v-direction
+ * Only the control points of the knot spans which contain u and v contribute to the sum.
+ * Use a NURBSEvaluator to evaluate many points of an unchanged surface.
  * @param u the specified u-parameter
  * @param v the specified v-parameter
  * @param Pt a reference to the point defined by the pair (u,v)
 */
 void NURBSSurface::getPoint(double u, double v, Vector3d &Pt) const
+{
+    if(m_iuDegree>NURBSMAXDEGREE || m_ivDegree>NURBSMAXDEGREE)
+    {
+        getPoint_ref(u, v, Pt);
+        return;
+    }
+
+    if(u<0.0)  u=0.0;
+    if(v<0.0)  v=0.0;
+    if(u>=1.0) u=0.99999999999;
+    if(v>=1.0) v=0.99999999999;
+
+    double Nu[NURBSMAXDEGREE+1], Nv[NURBSMAXDEGREE+1];
+    int iu0=0, nu=0, jv0=0, nv=0;
+    geom::spanBasis(frameCount(),      m_iuDegree, u, m_uKnot.data(), iu0, nu, Nu);
+    geom::spanBasis(framePointCount(), m_ivDegree, v, m_vKnot.data(), jv0, nv, Nv);
+
+    Vector3d V, Vv, rpt;
+    double totalweight = 0.0;
+    for(int k=0; k<nu; k++)
+    {
+        int iu = iu0+k;
+        Frame const &uframe = m_Frame.at(iu);
+        Vv.set(0.0,0.0,0.0);
+        double wx = 0.0;
+        for(int l=0; l<nv; l++)
+        {
+            int jv = jv0+l;
+            double cs = Nv[l] * weight(m_EdgeWeightv, jv, framePointCount());
+
+            rpt = uframe.ctrlPointAt(jv);
+            if(fabs(uframe.angle())>ANGLEPRECISION) //degrees
+                rpt.rotateY(uframe.position(), uframe.angle());
+
+            Vv.x += rpt.x * cs;
+            Vv.y += rpt.y * cs;
+            Vv.z += rpt.z * cs;
+
+            wx += cs;
+        }
+        double bs = Nu[k] * weight(m_EdgeWeightu, iu, frameCount());
+
+        V.x += Vv.x * bs;
+        V.y += Vv.y * bs;
+        V.z += Vv.z * bs;
+
+        totalweight += wx * bs;
+    }
+
+    Pt.x = V.x / totalweight;
+    Pt.y = V.y / totalweight;
+    Pt.z = V.z / totalweight;
+}
+
+
+/**
+ * Returns the unit normal to the surface at the pair of parameters (u,v).
+ * The derivatives are those of the non-rational surface, i.e. the edge weights are ignored.
+ * Only the control points of the knot spans which contain u and v contribute to the sums.
+ */
+void NURBSSurface::getNormal(double u, double v, Vector3d &N) const
+{
+    if(m_iuDegree>NURBSMAXDEGREE || m_ivDegree>NURBSMAXDEGREE)
+    {
+        getNormal_ref(u, v, N);
+        return;
+    }
+
+    u=std::max(u, 1e-4);
+    v=std::max(v, 1e-4);
+    u=std::min(u, 1.0-1.e-4);
+    v=std::min(v, 1.0-1.e-4);
+
+    double Nu[NURBSMAXDEGREE+1], dNu[NURBSMAXDEGREE+1], Nv[NURBSMAXDEGREE+1], dNv[NURBSMAXDEGREE+1];
+    int iu0=0, nu=0, jv0=0, nv=0;
+    geom::spanBasis(frameCount(),      m_iuDegree, u, m_uKnot.data(), iu0, nu, Nu, dNu);
+    geom::spanBasis(framePointCount(), m_ivDegree, v, m_vKnot.data(), jv0, nv, Nv, dNv);
+
+    Vector3d Su, Sv, Vv, dVv, rpt;
+    for(int k=0; k<nu; k++)
+    {
+        Frame const &uframe = m_Frame.at(iu0+k);
+        Vv.reset();
+        dVv.reset();
+        for(int l=0; l<nv; l++)
+        {
+            rpt = uframe.ctrlPointAt(jv0+l);
+            if(fabs(uframe.angle())>0.01) //degrees
+                rpt.rotateY(uframe.position(), uframe.angle());
+
+            Vv.x  += rpt.x * Nv[l];
+            Vv.y  += rpt.y * Nv[l];
+            Vv.z  += rpt.z * Nv[l];
+            dVv.x += rpt.x * dNv[l];
+            dVv.y += rpt.y * dNv[l];
+            dVv.z += rpt.z * dNv[l];
+        }
+
+        Su.x += Vv.x * dNu[k];
+        Su.y += Vv.y * dNu[k];
+        Su.z += Vv.z * dNu[k];
+        Sv.x += dVv.x * Nu[k];
+        Sv.y += dVv.y * Nu[k];
+        Sv.z += dVv.z * Nu[k];
+    }
+
+    N = (Su * Sv).normalized();
+}
+
+
+/**
+ * The reference implementation of getPoint(), which sums the contributions of all the control points.
+ */
+void NURBSSurface::getPoint_ref(double u, double v, Vector3d &Pt) const
 {
     Vector3d V, Vv, rpt;
     double wx=0, totalweight=0, cs=0, bs=0;
@@ -282,7 +398,10 @@ void NURBSSurface::getPoint(double u, double v, Vector3d &Pt) const
 }
 
 
-void NURBSSurface::getNormal(double u, double v, Vector3d &N) const
+/**
+ * The reference implementation of getNormal(), which sums the contributions of all the control points.
+ */
+void NURBSSurface::getNormal_ref(double u, double v, Vector3d &N) const
 {
     Vector3d Su, Sv, Vv, rpt;
     double cs=0, bs=0;
@@ -940,111 +1059,14 @@ bool NURBSSurface::intersect_ref(Vector3d const&A, Vector3d const&B, double &u,
 }
 
 
-#define NDIV 5 // fastest
-#define NVTX (NDIV+1)
 /**
  * @brief NURBSSurface::intersect
  * find the intesection of the ray [A,B] with the NURBS by successive intersections with triangles
+ * The control net is evaluated once in a NURBSEvaluator; use the evaluator directly to intersect many rays.
  * @return
  */
 bool NURBSSurface::intersect(Vector3d const&A, Vector3d const&B, double &u, double &v, Vector3d &I) const
 {
-//    auto t0 = std::chrono::high_resolution_clock::now();
-
-    double umin=0, umax=1.0;
-    double vmin=0, vmax=1.0;
-    double umin1=0, umax1=1.0;
-    double vmin1=0, vmax1=1.0;
-    Vector3d N;
-    double pcrit = 1.e-2;
-
-    int iter =0;
-    int itermax=30;
-
-
-    Triangle3d t3d;
-    Vector3d Vtx[NVTX*NVTX];
-    do
-    {
-        for(int i=0; i<NVTX; i++)
-        {
-            double di = double(i)/double(NVTX-1);
-            for(int j=0; j<NVTX; j++)
-            {
-                double dj = double(j)/double(NVTX-1);
-                getPoint((1.0-di)*umin+di*umax, (1.0-dj)*vmin+dj*vmax, Vtx[NVTX*i+j]);
-            }
-        }
-
-        bool bIntersect = false;
-        for(int k=0; k<NDIV*NDIV; k++)
-        {
-            int i = int(double(k)/double(NDIV));
-            int j = k-i*NDIV;
-
-            t3d.setTriangle(Vtx[i*NVTX+j], Vtx[i*NVTX+j+1], Vtx[(i+1)*NVTX+j+1]);
-
-            if(t3d.intersectSegmentInside(A, B, I, true))
-            {
-                double di  = double(i)/double(NVTX-1);
-                double dj  = double(j)/double(NVTX-1);
-                double di1 = double(i+1)/double(NVTX-1);
-                double dj1 = double(j+1)/double(NVTX-1);
-                umin1 = (1.0-di) *umin + di *umax;
-                umax1 = (1.0-di1)*umin + di1*umax;
-                vmin1 = (1.0-dj) *vmin + dj *vmax;
-                vmax1 = (1.0-dj1)*vmin + dj1*vmax;
-
-                umin=umin1;      umax=umax1;
-                vmin=vmin1;      vmax=vmax1;
-                bIntersect = true;
-                break;
-            }
-            else
-            {
-                t3d.setTriangle(Vtx[i*NVTX+j], Vtx[(i+1)*NVTX+j+1], Vtx[(i+1)*NVTX+j]);
-
-                if(t3d.intersectSegmentInside(A, B, I, true))
-                {
-                    double di  = double(i)  /double(NVTX-1);
-                    double dj  = double(j)  /double(NVTX-1);
-                    double di1 = double(i+1)/double(NVTX-1);
-                    double dj1 = double(j+1)/double(NVTX-1);
-                    umin1 = (1.0-di) *umin + di *umax;
-                    umax1 = (1.0-di1)*umin + di1*umax;
-                    vmin1 = (1.0-dj) *vmin + dj *vmax;
-                    vmax1 = (1.0-dj1)*vmin + dj1*vmax;
-
-//                  extend the next triangles to avoid any boundary precision issue
-                    umin=umin1*0.99;      umax=umax1*1.01; // extend the next triangles to avoid any boundary precision issue
-                    vmin=vmin1*0.99;      vmax=vmax1*1.01;
-
-                    bIntersect = true;
-                    break;
-                }
-            }
-        }
-
-        if(!bIntersect)
-            return false;
-
-        iter++;
-        if(iter>=itermax)
-            return false;
-    }
-    while (fabs(umax-umin)>pcrit && fabs(vmax-vmin)>pcrit);
-
-    u = (umin+umax)/2.0;
-    v = (vmin+vmax)/2.0;
-/*
-    auto t1 = std::chrono::high_resolution_clock::now();
-    int duration = std::chrono::duration_cast<std::chrono::microseconds>(t1 - t0).count();
-    qDebug("Intersection(%d):  u=%9g  v=%9g  %gms", iter, u, v, double(duration)/1000.0);
-*/
-    return true;
+    NURBSEvaluator evaluator(*this);
+    return evaluator.intersect(A, B, u, v, I);
 }
-
-
-
-
-
@@ -31,6 +31,7 @@
 #include <geom_global.h>
 
 #include <constants.h>
+#include <nurbsevaluator.h>
 #include <nurbssurface.h>
 #include <quaternion.h>
 #include <segment2d.h>
@@ -773,28 +774,131 @@ double geom::basisDerivative(int i, int deg, double t, double const *knots)
 }
 
 
+/**
+ * Returns the index i of the knot span such that knots[i]<=t<knots[i+1].
+ * The search is restricted to the spans [deg, nCtrl-1] of a clamped knot vector.
+ * @param nCtrl the number of control points
+ * @param deg the degree of the basis functions
+ */
+int geom::findKnotSpan(int nCtrl, int deg, double t, double const *knots)
+{
+    if(t>=knots[nCtrl]) return nCtrl-1;
+    if(t<=knots[deg])   return deg;
+
+    int low  = deg;
+    int high = nCtrl;
+    int mid  = (low+high)/2;
+    while(t<knots[mid] || t>=knots[mid+1])
+    {
+        if(t<knots[mid]) high = mid;
+        else             low  = mid;
+        mid = (low+high)/2;
+    }
+    return mid;
+}
+
+
+/**
+ * Computes in one pass the deg+1 basis functions which are non-zero in the knot span,
+ * and optionally their first derivatives.
+ * Uses the triangular scheme of Piegl & Tiller, The NURBS Book, algorithms A2.2 and A2.3.
+ * On output, N[r] is the value of the basis function of index span-deg+r.
+ * @param span the index of the knot span which contains t, as returned by findKnotSpan()
+ * @param N the array of deg+1 basis function values
+ * @param dN if not null, the array of deg+1 basis function derivatives
+ */
+void geom::basisFunctions(int span, int deg, double t, double const *knots, double *N, double *dN)
+{
+    double left[NURBSMAXDEGREE+1], right[NURBSMAXDEGREE+1];
+    assert(deg<=NURBSMAXDEGREE);
+
+    N[0] = 1.0;
+    if(dN) dN[0] = 0.0;
+
+    for(int j=1; j<=deg; j++)
+    {
+        if(dN && j==deg)
+        {
+            // N holds the functions of degree deg-1 with indexes span-deg+1 to span
+            for(int r=0; r<=deg; r++)
+            {
+                int i = span-deg+r;
+                dN[r] = 0.0;
+                if(r>0   && fabs(knots[i+deg]-knots[i])>KNOTPRECISION)
+                    dN[r] += double(deg)/(knots[i+deg]-knots[i])     * N[r-1];
+                if(r<deg && fabs(knots[i+deg+1]-knots[i+1])>KNOTPRECISION)
+                    dN[r] -= double(deg)/(knots[i+deg+1]-knots[i+1]) * N[r];
+            }
+        }
+
+        left[j]  = t-knots[span+1-j];
+        right[j] = knots[span+j]-t;
+        double saved = 0.0;
+        for(int r=0; r<j; r++)
+        {
+            double temp = N[r]/(right[r+1]+left[j-r]);
+            N[r] = saved + right[r+1]*temp;
+            saved = left[j-r]*temp;
+        }
+        N[j] = saved;
+    }
+}
+
+
+/**
+ * Returns the basis functions which are non-zero at parameter t.
+ * If the number of control points is greater than the degree, these are the deg+1 functions of the knot span.
+ * Otherwise the knot vector is degenerate and all the functions are evaluated from their recursive definition.
+ * The arrays N and dN must hold at least deg+1 values.
+ * @param first on output, the index of the first non-zero function
+ * @param count on output, the number of values in N and dN
+ */
+void geom::spanBasis(int nCtrl, int deg, double t, double const *knots, int &first, int &count, double *N, double *dN)
+{
+    if(nCtrl>deg)
+    {
+        int span = findKnotSpan(nCtrl, deg, t, knots);
+        first = span-deg;
+        count = deg+1;
+        basisFunctions(span, deg, t, knots, N, dN);
+    }
+    else
+    {
+        first = 0;
+        count = nCtrl;
+        for(int i=0; i<nCtrl; i++)
+        {
+            N[i] = basis(i, deg, t, knots);
+            if(dN) dN[i] = basisDerivative(i, deg, t, knots);
+        }
+    }
+}
+
+
 void geom::makeNurbsTriangulation(NURBSSurface const &nurbs, int nx, int nh, std::vector<Triangle3d> &triangles)
 {
     Vector3d S00, S01, S10, S11;
 
+    // evaluate the grid of nodes at once
+    std::vector<double> ugrid(nx+1), vgrid(nh+1);
+    for(int k=0; k<=nx; k++) ugrid[k] = double(k)/double(nx);
+    for(int l=0; l<=nh; l++) vgrid[l] = double(l)/double(nh);
+    std::vector<Vector3d> grid;
+    NURBSEvaluator(nurbs).getGrid(ugrid, vgrid, grid);
+
     // make the left side
     triangles.resize(nx*nh*2);
 
     int it=0;
     for (int k=0; k<nx; k++)
     {
-        double uk  = double(k)   /double(nx);
-        double uk1 = double(k+1) /double(nx);
-
-        double vl=0.0;
-        nurbs.getPoint(uk,  vl, S00);
-        nurbs.getPoint(uk1, vl, S10);
+        S00 = grid[k*(nh+1)];
+        S10 = grid[(k+1)*(nh+1)];
 
         for (int l=0; l<nh; l++)
         {
-            double vl1 = double(l+1) / double(nh);
-            nurbs.getPoint(uk,  vl1, S01);
-            nurbs.getPoint(uk1, vl1, S11);
+            S01 = grid[k*(nh+1)+l+1];
+            S11 = grid[(k+1)*(nh+1)+l+1];
 
             if(!S00.isSame(S01) && !S01.isSame(S11) && !S11.isSame(S00))
                 triangles[it++] = {S00, S01, S11};
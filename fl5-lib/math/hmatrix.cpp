@@ -0,0 +1,640 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#define _MATH_DEFINES_DEFINED
+
+#include <algorithm>
+#include <cstring>
+
+#include <hmatrix.h>
+
+#include <matrix.h>
+#include <threadpool.h>
+
+
+double HMatrix::s_Eta(1.0);
+int HMatrix::s_LeafSize(32);
+double HMatrix::s_ACATolerance(1.e-6);
+
+
+HMatrix::HMatrix()
+{
+    m_nBasis = 1;
+    m_nRows = 0;
+    m_nThreads = 1;
+    m_bError = false;
+}
+
+
+void HMatrix::clear()
+{
+    m_nRows = 0;
+    m_Cluster.clear();
+    m_Index.clear();
+    m_Block.clear();
+    m_WakeSlot.clear();
+    m_WakePanel.clear();
+    m_WakeCoef.clear();
+    m_PrecondCluster.clear();
+    m_Precond.clear();
+}
+
+
+/**
+ * Builds the cluster tree, the block partition and the blocks' coefficients.
+ * @param pts the panels' centroids
+ * @param radius the radius of the sphere centered on each centroid which encloses the panel
+ * @param nBasis the number of unknowns per panel
+ * @param generator the function which calculates the exact influence of a panel on another
+ * @param wakepanels the panels which may receive a wake contribution in their columns
+ * @param nThreads the number of threads used to build the blocks and to perform the matrix-vector products
+ * @return true if the matrix could be built, false in case of numerical or memory allocation error
+ */
+bool HMatrix::build(std::vector<Vector3d> const &pts, std::vector<double> const &radius, int nBasis,
+                    blockGenerator const &generator, std::vector<int> const &wakepanels, int nThreads)
+{
+    clear();
+    m_nBasis = std::max(1, nBasis);
+    m_nThreads = std::max(1, nThreads);
+    m_bError = false;
+
+    int nPanels = int(pts.size());
+    if(nPanels==0 || int(radius.size())!=nPanels) return false;
+
+    try
+    {
+        m_Index.resize(nPanels);
+        for(int i=0; i<nPanels; i++) m_Index[i] = i;
+        makeCluster(pts, radius, 0, nPanels, 0);
+        makeBlocks(0, 0);
+
+        m_WakeSlot.assign(nPanels, -1);
+        for(int k : wakepanels)
+        {
+            if(k>=0 && k<nPanels && m_WakeSlot[k]<0)
+            {
+                m_WakeSlot[k] = int(m_WakePanel.size());
+                m_WakePanel.push_back(k);
+            }
+        }
+        m_WakeCoef.assign(size_t(nPanels*m_nBasis)*m_WakePanel.size()*m_nBasis, 0.0);
+    }
+    catch(std::bad_alloc &)
+    {
+        clear();
+        return false;
+    }
+
+    // the cost of the blocks is uneven, leave the balancing to the thread pool
+    ThreadPool::parallelFor(0, int(m_Block.size()), [&](int iBlock0, int iBlock1) {fillBlocks(iBlock0, iBlock1, generator);},
+                            m_nThreads>1, 1);
+
+    if(m_bError)
+    {
+        clear();
+        return false;
+    }
+
+    m_nRows = nPanels*m_nBasis;
+    return true;
+}
+
+
+/**
+ * Recursively builds the cluster spanning the permutation array's range [iStart, iEnd[,
+ * by bisection of the panels along the largest dimension of the bounding box.
+ * @return the index of the new cluster
+ */
+int HMatrix::makeCluster(std::vector<Vector3d> const &pts, std::vector<double> const &radius, int iStart, int iEnd, int depth)
+{
+    Cluster cluster;
+    cluster.m_iStart = iStart;
+    cluster.m_iEnd   = iEnd;
+    cluster.m_Min.set( 1.e10,  1.e10,  1.e10);
+    cluster.m_Max.set(-1.e10, -1.e10, -1.e10);
+    for(int i=iStart; i<iEnd; i++)
+    {
+        Vector3d const &pt = pts.at(m_Index.at(i));
+        double r = radius.at(m_Index.at(i));
+        cluster.m_Min.x = std::min(cluster.m_Min.x, pt.x-r);   cluster.m_Max.x = std::max(cluster.m_Max.x, pt.x+r);
+        cluster.m_Min.y = std::min(cluster.m_Min.y, pt.y-r);   cluster.m_Max.y = std::max(cluster.m_Max.y, pt.y+r);
+        cluster.m_Min.z = std::min(cluster.m_Min.z, pt.z-r);   cluster.m_Max.z = std::max(cluster.m_Max.z, pt.z+r);
+    }
+
+    int iCluster = int(m_Cluster.size());
+    m_Cluster.push_back(cluster);
+
+    if(iEnd-iStart<=s_LeafSize || depth>=64) return iCluster;
+
+    Vector3d extent = cluster.m_Max-cluster.m_Min;
+    int dir = 0;
+    if(extent.y>extent.x && extent.y>=extent.z) dir = 1;
+    else if(extent.z>extent.x && extent.z>extent.y) dir = 2;
+
+    int iMid = (iStart+iEnd)/2;
+    std::nth_element(m_Index.begin()+iStart, m_Index.begin()+iMid, m_Index.begin()+iEnd,
+                     [&pts, dir](int a, int b) {return pts.at(a).dir(dir)<pts.at(b).dir(dir);});
+
+    // the cluster array may be reallocated, so do not keep a reference to the parent cluster
+    int iChild0 = makeCluster(pts, radius, iStart, iMid, depth+1);
+    int iChild1 = makeCluster(pts, radius, iMid,   iEnd, depth+1);
+    m_Cluster[iCluster].m_iChild[0] = iChild0;
+    m_Cluster[iCluster].m_iChild[1] = iChild1;
+
+    return iCluster;
+}
+
+
+bool HMatrix::isAdmissible(Cluster const &rc, Cluster const &cc) const
+{
+    double dx = std::max(0.0, std::max(rc.m_Min.x-cc.m_Max.x, cc.m_Min.x-rc.m_Max.x));
+    double dy = std::max(0.0, std::max(rc.m_Min.y-cc.m_Max.y, cc.m_Min.y-rc.m_Max.y));
+    double dz = std::max(0.0, std::max(rc.m_Min.z-cc.m_Max.z, cc.m_Min.z-rc.m_Max.z));
+    double dist = sqrt(dx*dx+dy*dy+dz*dz);
+    if(dist<=0.0) return false;
+    return std::min(rc.diameter(), cc.diameter()) <= s_Eta*dist;
+}
+
+
+/** Recursively partitions the block of row cluster iRow and column cluster iCol */
+void HMatrix::makeBlocks(int iRow, int iCol)
+{
+    Cluster const rc = m_Cluster.at(iRow);
+    Cluster const cc = m_Cluster.at(iCol);
+
+    if(isAdmissible(rc, cc))
+    {
+        Block block;
+        block.m_iRowCluster = iRow;
+        block.m_iColCluster = iCol;
+        block.m_bLowRank = true;
+        m_Block.push_back(block);
+    }
+    else if(rc.isLeaf() && cc.isLeaf())
+    {
+        Block block;
+        block.m_iRowCluster = iRow;
+        block.m_iColCluster = iCol;
+        block.m_bLowRank = false;
+        m_Block.push_back(block);
+    }
+    else if(rc.isLeaf())
+    {
+        for(int ic=0; ic<2; ic++) makeBlocks(iRow, cc.m_iChild[ic]);
+    }
+    else if(cc.isLeaf())
+    {
+        for(int ir=0; ir<2; ir++) makeBlocks(rc.m_iChild[ir], iCol);
+    }
+    else
+    {
+        for(int ir=0; ir<2; ir++)
+            for(int ic=0; ic<2; ic++) makeBlocks(rc.m_iChild[ir], cc.m_iChild[ic]);
+    }
+}
+
+
+void HMatrix::fillBlocks(int iBlock0, int iBlock1, blockGenerator const &generator)
+{
+    for(int ib=iBlock0; ib<iBlock1; ib++)
+    {
+        if(m_bError) return;
+        Block &block = m_Block[ib];
+        bool bOK = block.m_bLowRank ? fillLowRankBlock(block, generator) : fillDenseBlock(block, generator);
+        if(!bOK)
+        {
+            m_bError = true;
+            return;
+        }
+    }
+}
+
+
+bool HMatrix::fillDenseBlock(Block &block, blockGenerator const &generator) const
+{
+    Cluster const &rc = m_Cluster.at(block.m_iRowCluster);
+    Cluster const &cc = m_Cluster.at(block.m_iColCluster);
+    int nb  = m_nBasis;
+    int nb2 = nb*nb;
+    int n = cc.nPanels()*nb;
+
+    block.m_bLowRank = false;
+    block.m_Rank = 0;
+    block.m_V.clear();
+    block.m_U.resize(size_t(rc.nPanels()*nb)*size_t(n));
+
+    std::vector<double> coef(nb2);
+    for(int ip=0; ip<rc.nPanels(); ip++)
+    {
+        int i = m_Index.at(rc.m_iStart+ip);
+        for(int kp=0; kp<cc.nPanels(); kp++)
+        {
+            int k = m_Index.at(cc.m_iStart+kp);
+            if(!generator(i, k, coef.data())) return false;
+            for(int ib=0; ib<nb; ib++)
+                for(int kb=0; kb<nb; kb++)
+                    block.m_U[size_t(ip*nb+ib)*n + kp*nb+kb] = coef[ib*nb+kb];
+        }
+    }
+    return true;
+}
+
+
+bool HMatrix::blockRow(Block const &block, int r, blockGenerator const &generator, double *row) const
+{
+    Cluster const &rc = m_Cluster.at(block.m_iRowCluster);
+    Cluster const &cc = m_Cluster.at(block.m_iColCluster);
+    int nb = m_nBasis;
+    int i  = m_Index.at(rc.m_iStart + r/nb);
+    int ib = r%nb;
+    double coef[9];
+    for(int kp=0; kp<cc.nPanels(); kp++)
+    {
+        if(!generator(i, m_Index.at(cc.m_iStart+kp), coef)) return false;
+        for(int kb=0; kb<nb; kb++) row[kp*nb+kb] = coef[ib*nb+kb];
+    }
+    return true;
+}
+
+
+bool HMatrix::blockColumn(Block const &block, int c, blockGenerator const &generator, double *col) const
+{
+    Cluster const &rc = m_Cluster.at(block.m_iRowCluster);
+    Cluster const &cc = m_Cluster.at(block.m_iColCluster);
+    int nb = m_nBasis;
+    int k  = m_Index.at(cc.m_iStart + c/nb);
+    int kb = c%nb;
+    double coef[9];
+    for(int ip=0; ip<rc.nPanels(); ip++)
+    {
+        if(!generator(m_Index.at(rc.m_iStart+ip), k, coef)) return false;
+        for(int ib=0; ib<nb; ib++) col[ip*nb+ib] = coef[ib*nb+kb];
+    }
+    return true;
+}
+
+
+/**
+ * Builds the low rank approximation of an admissible block using adaptive cross approximation with partial pivoting.
+ * Cf. M. Bebendorf, Approximation of boundary element matrices, Numer. Math. 86 (2000).
+ * Falls back to dense storage if the rank required to reach the tolerance makes the approximation unprofitable.
+ */
+bool HMatrix::fillLowRankBlock(Block &block, blockGenerator const &generator) const
+{
+    Cluster const &rc = m_Cluster.at(block.m_iRowCluster);
+    Cluster const &cc = m_Cluster.at(block.m_iColCluster);
+    int m = rc.nPanels()*m_nBasis;
+    int n = cc.nPanels()*m_nBasis;
+    int maxRank = std::max(1, (m*n)/(m+n));
+
+    std::vector<double> &U = block.m_U;
+    std::vector<double> &V = block.m_V;
+    U.clear();
+    V.clear();
+
+    std::vector<double> row(n), col(m);
+    std::vector<bool> bUsedRow(m, false);
+    double norm2 = 0.0;
+    int iPivot = 0;
+    int rank = 0;
+    int nZeroRows = 0;
+    bool bConverged = false;
+
+    while(rank<maxRank)
+    {
+        if(!blockRow(block, iPivot, generator, row.data())) return false;
+        for(int l=0; l<rank; l++)
+        {
+            double u = U[size_t(l)*m+iPivot];
+            double const *vl = V.data()+size_t(l)*n;
+            for(int j=0; j<n; j++) row[j] -= u*vl[j];
+        }
+        bUsedRow[iPivot] = true;
+
+        int jPivot = 0;
+        for(int j=1; j<n; j++)
+            if(fabs(row[j])>fabs(row[jPivot])) jPivot = j;
+
+        if(fabs(row[jPivot])<1.e-20)
+        {
+            // the residual row is null; try the next unused row, and stop if too many rows are null
+            nZeroRows++;
+            iPivot = -1;
+            for(int i=0; i<m; i++)
+                if(!bUsedRow[i]) {iPivot = i; break;}
+            if(iPivot<0 || nZeroRows>=8)
+            {
+                bConverged = true;
+                break;
+            }
+            continue;
+        }
+        nZeroRows = 0;
+
+        double pivot = row[jPivot];
+        for(int j=0; j<n; j++) row[j] /= pivot;
+
+        if(!blockColumn(block, jPivot, generator, col.data())) return false;
+        for(int l=0; l<rank; l++)
+        {
+            double v = V[size_t(l)*n+jPivot];
+            double const *ul = U.data()+size_t(l)*m;
+            for(int i=0; i<m; i++) col[i] -= ul[i]*v;
+        }
+
+        // update the Frobenius norm of the approximation
+        double unorm2=0.0, vnorm2=0.0;
+        for(int i=0; i<m; i++) unorm2 += col[i]*col[i];
+        for(int j=0; j<n; j++) vnorm2 += row[j]*row[j];
+        double cross = 0.0;
+        for(int l=0; l<rank; l++)
+        {
+            double const *ul = U.data()+size_t(l)*m;
+            double const *vl = V.data()+size_t(l)*n;
+            double uu=0.0, vv=0.0;
+            for(int i=0; i<m; i++) uu += col[i]*ul[i];
+            for(int j=0; j<n; j++) vv += row[j]*vl[j];
+            cross += uu*vv;
+        }
+        norm2 += unorm2*vnorm2 + 2.0*cross;
+
+        U.insert(U.end(), col.begin(), col.end());
+        V.insert(V.end(), row.begin(), row.end());
+        rank++;
+
+        if(sqrt(unorm2*vnorm2) <= s_ACATolerance*sqrt(fabs(norm2)))
+        {
+            bConverged = true;
+            break;
+        }
+
+        // the next pivot row is the largest term of the new column
+        iPivot = -1;
+        double umax = -1.0;
+        for(int i=0; i<m; i++)
+        {
+            if(!bUsedRow[i] && fabs(col[i])>umax)
+            {
+                umax = fabs(col[i]);
+                iPivot = i;
+            }
+        }
+        if(iPivot<0)
+        {
+            bConverged = true;
+            break;
+        }
+    }
+
+    if(!bConverged) return fillDenseBlock(block, generator);
+
+    block.m_bLowRank = true;
+    block.m_Rank = rank;
+    U.shrink_to_fit();
+    V.shrink_to_fit();
+    return true;
+}
+
+
+/**
+ * Adds a wake coefficient to the matrix. Only the columns of the trailing edge panels can receive wake contributions.
+ * Each row is processed by a single thread, so that no synchronization is required.
+ */
+void HMatrix::addWakeCoef(int row, int col, double value)
+{
+    int k = col/m_nBasis;
+    int slot = m_WakeSlot.at(k);
+    if(slot<0) return;
+    size_t nWakeCols = m_WakePanel.size()*m_nBasis;
+    m_WakeCoef[size_t(row)*nWakeCols + slot*m_nBasis + col%m_nBasis] += value;
+}
+
+
+/**
+ * Builds the block-Jacobi preconditioner by inverting the dense diagonal blocks of the leaf clusters,
+ * including the wake's contribution.
+ */
+bool HMatrix::makePreconditioner()
+{
+    if(!isBuilt()) return false;
+
+    int nb = m_nBasis;
+    size_t nWakeCols = m_WakePanel.size()*nb;
+
+    m_PrecondCluster.clear();
+    m_Precond.clear();
+
+    for(Block const &block : m_Block)
+    {
+        if(block.m_bLowRank || block.m_iRowCluster!=block.m_iColCluster) continue;
+
+        Cluster const &c = m_Cluster.at(block.m_iRowCluster);
+        int n = c.nPanels()*nb;
+        std::vector<double> D = block.m_U;
+
+        for(int ip=0; ip<c.nPanels(); ip++)
+        {
+            for(int ib=0; ib<nb; ib++)
+            {
+                size_t row = size_t(m_Index.at(c.m_iStart+ip)*nb+ib);
+                for(int kp=0; kp<c.nPanels(); kp++)
+                {
+                    int slot = m_WakeSlot.at(m_Index.at(c.m_iStart+kp));
+                    if(slot<0) continue;
+                    for(int kb=0; kb<nb; kb++)
+                        D[size_t(ip*nb+ib)*n + kp*nb+kb] += m_WakeCoef.at(row*nWakeCols + slot*nb+kb);
+                }
+            }
+        }
+
+        if(!matrix::invertMatrix(D, n)) matrix::setIdentityMatrix(D.data(), n);
+
+        m_PrecondCluster.push_back(block.m_iRowCluster);
+        m_Precond.push_back(D);
+    }
+    return true;
+}
+
+
+void HMatrix::preconditioner(double const *x, double *y) const
+{
+    int nb = m_nBasis;
+    std::vector<double> xl, yl;
+    for(uint ic=0; ic<m_PrecondCluster.size(); ic++)
+    {
+        Cluster const &c = m_Cluster.at(m_PrecondCluster.at(ic));
+        std::vector<double> const &D = m_Precond.at(ic);
+        int n = c.nPanels()*nb;
+        xl.resize(n);
+        for(int ip=0; ip<c.nPanels(); ip++)
+            for(int ib=0; ib<nb; ib++) xl[ip*nb+ib] = x[m_Index.at(c.m_iStart+ip)*nb+ib];
+
+        for(int ip=0; ip<c.nPanels(); ip++)
+        {
+            for(int ib=0; ib<nb; ib++)
+            {
+                double const *Di = D.data() + size_t(ip*nb+ib)*n;
+                double sum = 0.0;
+                for(int j=0; j<n; j++) sum += Di[j]*xl[j];
+                y[m_Index.at(c.m_iStart+ip)*nb+ib] = sum;
+            }
+        }
+    }
+}
+
+
+/** Performs the product y=A.x */
+void HMatrix::matVec(double const *x, double *y) const
+{
+    if(m_nThreads>1)
+    {
+        std::vector<double> ythread(size_t(m_nThreads)*m_nRows, 0.0);
+        ThreadPool::parallelFor(0, m_nThreads, [&](int it0, int it1)
+                                {
+                                    for(int it=it0; it<it1; it++) matVecThread(it, m_nThreads, x, ythread.data()+size_t(it)*m_nRows);
+                                }, true, 1);
+
+        memcpy(y, ythread.data(), m_nRows*sizeof(double));
+        for(int it=1; it<m_nThreads; it++)
+        {
+            double const *yt = ythread.data()+size_t(it)*m_nRows;
+            for(int i=0; i<m_nRows; i++) y[i] += yt[i];
+        }
+    }
+    else
+    {
+        memset(y, 0, m_nRows*sizeof(double));
+        matVecThread(0, 1, x, y);
+    }
+}
+
+
+void HMatrix::matVecThread(int iThread, int nThreads, double const *x, double *y) const
+{
+    int nb = m_nBasis;
+    std::vector<double> xl, yl, t;
+
+    for(uint ib=iThread; ib<m_Block.size(); ib+=nThreads)
+    {
+        Block const &block = m_Block.at(ib);
+        Cluster const &rc = m_Cluster.at(block.m_iRowCluster);
+        Cluster const &cc = m_Cluster.at(block.m_iColCluster);
+        int m = rc.nPanels()*nb;
+        int n = cc.nPanels()*nb;
+
+        xl.resize(n);
+        for(int kp=0; kp<cc.nPanels(); kp++)
+            for(int kb=0; kb<nb; kb++) xl[kp*nb+kb] = x[m_Index.at(cc.m_iStart+kp)*nb+kb];
+
+        yl.assign(m, 0.0);
+        if(block.m_bLowRank)
+        {
+            t.resize(block.m_Rank);
+            for(int l=0; l<block.m_Rank; l++)
+            {
+                double const *vl = block.m_V.data()+size_t(l)*n;
+                double sum = 0.0;
+                for(int j=0; j<n; j++) sum += vl[j]*xl[j];
+                t[l] = sum;
+            }
+            for(int l=0; l<block.m_Rank; l++)
+            {
+                double const *ul = block.m_U.data()+size_t(l)*m;
+                for(int i=0; i<m; i++) yl[i] += ul[i]*t[l];
+            }
+        }
+        else
+        {
+            for(int i=0; i<m; i++)
+            {
+                double const *Ai = block.m_U.data()+size_t(i)*n;
+                double sum = 0.0;
+                for(int j=0; j<n; j++) sum += Ai[j]*xl[j];
+                yl[i] = sum;
+            }
+        }
+
+        for(int ip=0; ip<rc.nPanels(); ip++)
+            for(int kb=0; kb<nb; kb++) y[m_Index.at(rc.m_iStart+ip)*nb+kb] += yl[ip*nb+kb];
+    }
+
+    // wake columns, distributed by rows
+    int nWakePanels = int(m_WakePanel.size());
+    if(nWakePanels==0) return;
+    size_t nWakeCols = m_WakePanel.size()*nb;
+    int blockSize = m_nRows/nThreads+1;
+    int iStart = iThread*blockSize;
+    int iMax = std::min(iStart+blockSize, m_nRows);
+    for(int i=iStart; i<iMax; i++)
+    {
+        double const *w = m_WakeCoef.data() + size_t(i)*nWakeCols;
+        double sum = 0.0;
+        for(int iw=0; iw<nWakePanels; iw++)
+        {
+            double const *xk = x + m_WakePanel.at(iw)*nb;
+            for(int kb=0; kb<nb; kb++) sum += w[iw*nb+kb] * xk[kb];
+        }
+        y[i] += sum;
+    }
+}
+
+
+/** Returns the memory used by the matrix, in Mb */
+double HMatrix::memorySize() const
+{
+    size_t n = m_WakeCoef.size();
+    for(Block const &block : m_Block) n += block.m_U.size() + block.m_V.size();
+    return double(n*sizeof(double))/1024.0/1024.0;
+}
+
+
+int HMatrix::nLowRankBlocks() const
+{
+    int n = 0;
+    for(Block const &block : m_Block) if(block.m_bLowRank) n++;
+    return n;
+}
+
+
+int HMatrix::nDenseBlocks() const
+{
+    return int(m_Block.size())-nLowRankBlocks();
+}
+
+
+double HMatrix::averageRank() const
+{
+    int n = 0;
+    double rank = 0.0;
+    for(Block const &block : m_Block)
+    {
+        if(block.m_bLowRank)
+        {
+            rank += block.m_Rank;
+            n++;
+        }
+    }
+    return n>0 ? rank/double(n) : 0.0;
+}
+
@@ -22,6 +22,7 @@
 
 *****************************************************************************/
 
+#include <algorithm>
 #include <complex>
 #include <cstring>
 #include <QString>
@@ -1842,5 +1843,245 @@ void matrix::matVecMult(double const *A, double const *V, double *res, int nRows
 }
 
 
+/**
+ * @brief Solves the linear system A.x=b using the restarted GMRES method with right preconditioning.
+ * Cf. Y. Saad, Iterative Methods for Sparse Linear Systems, 2nd ed., algorithm 9.5.
+ * The matrix is never accessed directly, only through the matrix-vector products.
+ * @param n the size of the system
+ * @param A the operator which performs the product y=A.x
+ * @param M the operator which applies the preconditioner y=M^-1.x
+ * @param b the right hand side vector
+ * @param x in input, the initial guess; in output, the solution
+ * @param restart the dimension of the Krylov subspace after which the method is restarted
+ * @param maxiter the maximum number of iterations
+ * @param tolerance the convergence criterion on the relative residual |b-A.x|/|b|
+ * @param iter in output, the number of iterations performed
+ * @param residual in output, the relative residual at the last iteration
+ * @return true if the method has converged, false otherwise
+ */
+bool matrix::GMRES(int n, linearOperator const &A, linearOperator const &M, double const *b, double *x,
+                   int restart, int maxiter, double tolerance, int &iter, double &residual)
+{
+    iter = 0;
+    residual = 0.0;
+    if(n<=0) return true;
+
+    restart = std::max(1, std::min(restart, n));
+
+    double bnorm = 0.0;
+    for(int i=0; i<n; i++) bnorm += b[i]*b[i];
+    bnorm = sqrt(bnorm);
+    if(bnorm<PRECISION)
+    {
+        memset(x, 0, n*sizeof(double));
+        return true;
+    }
+
+    std::vector<double> V((restart+1)*n);   // the Krylov basis, one vector per row
+    std::vector<double> H((restart+1)*restart, 0.0); // the Hessenberg matrix
+    std::vector<double> cs(restart), sn(restart); // the Givens rotations
+    std::vector<double> g(restart+1), y(restart);
+    std::vector<double> w(n), z(n);
+
+    while(iter<maxiter)
+    {
+        // r0 = b - A.x0
+        A(x, w.data());
+        double beta = 0.0;
+        for(int i=0; i<n; i++)
+        {
+            w[i] = b[i]-w[i];
+            beta += w[i]*w[i];
+        }
+        beta = sqrt(beta);
+        residual = beta/bnorm;
+        if(residual<tolerance) return true;
+
+        for(int i=0; i<n; i++) V[i] = w[i]/beta;
+        std::fill(g.begin(), g.end(), 0.0);
+        g[0] = beta;
+
+        int nk = 0; // the number of Krylov vectors built in this cycle
+        bool bBreakDown = false;
+        while(nk<restart && iter<maxiter)
+        {
+            int j = nk;
+            iter++;
+
+            // w = A.M^-1.vj
+            M(V.data()+j*n, z.data());
+            A(z.data(), w.data());
+
+            // modified Gram-Schmidt orthogonalization
+            for(int k=0; k<=j; k++)
+            {
+                double const *vk = V.data()+k*n;
+                double h = 0.0;
+                for(int i=0; i<n; i++) h += w[i]*vk[i];
+                for(int i=0; i<n; i++) w[i] -= h*vk[i];
+                H[k*restart+j] = h;
+            }
+            double hnorm = 0.0;
+            for(int i=0; i<n; i++) hnorm += w[i]*w[i];
+            hnorm = sqrt(hnorm);
+            H[(j+1)*restart+j] = hnorm;
+
+            if(hnorm>PRECISION)
+            {
+                double *vj1 = V.data()+(j+1)*n;
+                for(int i=0; i<n; i++) vj1[i] = w[i]/hnorm;
+            }
+            else bBreakDown = true; // lucky breakdown, the solution is in the current subspace
+
+            // apply the previous rotations to the new column
+            for(int k=0; k<j; k++)
+            {
+                double t             =  cs[k]*H[k*restart+j] + sn[k]*H[(k+1)*restart+j];
+                H[(k+1)*restart+j]   = -sn[k]*H[k*restart+j] + cs[k]*H[(k+1)*restart+j];
+                H[k*restart+j]       = t;
+            }
+
+            // make the new rotation to cancel the subdiagonal term
+            double a  = H[j*restart+j];
+            double bb = H[(j+1)*restart+j];
+            double d = sqrt(a*a+bb*bb);
+            if(d<PRECISION) {cs[j]=1.0; sn[j]=0.0;}
+            else            {cs[j]=a/d; sn[j]=bb/d;}
+            H[j*restart+j]     = cs[j]*a + sn[j]*bb;
+            H[(j+1)*restart+j] = 0.0;
+            g[j+1] = -sn[j]*g[j];
+            g[j]   =  cs[j]*g[j];
+
+            nk++;
+
+            residual = fabs(g[j+1])/bnorm;
+            if(residual<tolerance || bBreakDown) break;
+        }
+
+        // solve the upper triangular system H.y=g
+        for(int k=nk-1; k>=0; k--)
+        {
+            y[k] = g[k];
+            for(int l=k+1; l<nk; l++) y[k] -= H[k*restart+l]*y[l];
+            if(fabs(H[k*restart+k])>PRECISION) y[k] /= H[k*restart+k];
+            else                               y[k] = 0.0;
+        }
+
+        // x = x + M^-1.V.y
+        std::fill(w.begin(), w.end(), 0.0);
+        for(int k=0; k<nk; k++)
+        {
+            double const *vk = V.data()+k*n;
+            for(int i=0; i<n; i++) w[i] += y[k]*vk[i];
+        }
+        M(w.data(), z.data());
+        for(int i=0; i<n; i++) x[i] += z[i];
 
+        if(residual<tolerance || bBreakDown) return residual<tolerance;
+    }
+
+    return residual<tolerance;
+}
+
+
+
+/**
+ * @brief Solves the linear system A.x=b using the preconditioned BiCGStab method.
+ * Cf. H.A. van der Vorst, Bi-CGSTAB: a fast and smoothly converging variant of Bi-CG, SIAM J. Sci. Stat. Comput. 13 (1992).
+ * Requires two matrix-vector products per iteration but no storage of the Krylov basis.
+ * @param n the size of the system
+ * @param A the operator which performs the product y=A.x
+ * @param M the operator which applies the preconditioner y=M^-1.x
+ * @param b the right hand side vector
+ * @param x in input, the initial guess; in output, the solution
+ * @param maxiter the maximum number of iterations
+ * @param tolerance the convergence criterion on the relative residual |b-A.x|/|b|
+ * @param iter in output, the number of iterations performed
+ * @param residual in output, the relative residual at the last iteration
+ * @return true if the method has converged, false otherwise
+ */
+bool matrix::BiCGStab(int n, linearOperator const &A, linearOperator const &M, double const *b, double *x,
+                      int maxiter, double tolerance, int &iter, double &residual)
+{
+    iter = 0;
+    residual = 0.0;
+    if(n<=0) return true;
+
+    auto dot = [n](double const *u, double const *v)
+    {
+        double s = 0.0;
+        for(int i=0; i<n; i++) s += u[i]*v[i];
+        return s;
+    };
+
+    double bnorm = sqrt(dot(b,b));
+    if(bnorm<PRECISION)
+    {
+        memset(x, 0, n*sizeof(double));
+        return true;
+    }
+
+    std::vector<double> r(n), r0(n), p(n, 0.0), v(n, 0.0), s(n), t(n), y(n), z(n);
+
+    A(x, t.data());
+    for(int i=0; i<n; i++) r[i] = b[i]-t[i];
+    r0 = r;
+    residual = sqrt(dot(r.data(), r.data()))/bnorm;
+    if(residual<tolerance) return true;
+
+    double rho=1.0, alpha=1.0, omega=1.0;
 
+    while(iter<maxiter)
+    {
+        iter++;
+        double rho1 = dot(r0.data(), r.data());
+        if(fabs(rho1)<PRECISION*PRECISION)
+        {
+            // breakdown; restart with the current residual as the shadow vector
+            A(x, t.data());
+            for(int i=0; i<n; i++) r[i] = b[i]-t[i];
+            r0 = r;
+            std::fill(p.begin(), p.end(), 0.0);
+            std::fill(v.begin(), v.end(), 0.0);
+            rho = alpha = omega = 1.0;
+            rho1 = dot(r0.data(), r.data());
+            if(fabs(rho1)<PRECISION*PRECISION) return false;
+        }
+
+        double beta = (rho1/rho) * (alpha/omega);
+        for(int i=0; i<n; i++) p[i] = r[i] + beta*(p[i]-omega*v[i]);
+        rho = rho1;
+
+        M(p.data(), y.data());
+        A(y.data(), v.data());
+        double r0v = dot(r0.data(), v.data());
+        if(fabs(r0v)<PRECISION*PRECISION) return false;
+        alpha = rho/r0v;
+
+        for(int i=0; i<n; i++) s[i] = r[i]-alpha*v[i];
+        double snorm = sqrt(dot(s.data(), s.data()));
+        if(snorm/bnorm<tolerance)
+        {
+            for(int i=0; i<n; i++) x[i] += alpha*y[i];
+            residual = snorm/bnorm;
+            return true;
+        }
+
+        M(s.data(), z.data());
+        A(z.data(), t.data());
+        double tt = dot(t.data(), t.data());
+        omega = tt>0.0 ? dot(t.data(), s.data())/tt : 0.0;
+
+        for(int i=0; i<n; i++)
+        {
+            x[i] += alpha*y[i] + omega*z[i];
+            r[i]  = s[i] - omega*t[i];
+        }
+
+        residual = sqrt(dot(r.data(), r.data()))/bnorm;
+        if(residual<tolerance) return true;
+        if(fabs(omega)<PRECISION*PRECISION) return false;
+    }
+
+    return residual<tolerance;
+}
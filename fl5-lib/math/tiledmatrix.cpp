@@ -0,0 +1,416 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+#define _MATH_DEFINES_DEFINED
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <future>
+
+#include <QDir>
+
+#if defined ACCELERATE
+  #include <Accelerate/Accelerate.h>
+  #define lapack_int int
+#elif defined INTEL_MKL
+    #include <mkl.h>
+#elif defined OPENBLAS
+    #include <openblas/lapacke.h>
+    #include <openblas/cblas.h>
+#endif
+
+#include <tiledmatrix.h>
+
+#include <threadpool.h>
+
+
+double TiledMatrix::s_MaxMemory(4096.0);
+std::string TiledMatrix::s_Directory;
+
+
+TiledMatrix::TiledMatrix()
+{
+    m_nRows = 0;
+    m_ReadBytes = m_ReadTime = 0.0;
+    m_WriteBytes = m_WriteTime = 0.0;
+}
+
+
+TiledMatrix::~TiledMatrix()
+{
+    clear();
+}
+
+
+/** Releases the arrays and deletes the scratch file */
+void TiledMatrix::clear()
+{
+    m_nRows = 0;
+    m_TileStart.clear();
+    m_ipiv.clear();
+    m_WakeCoef.clear();
+
+    if(m_File.is_open()) m_File.close();
+    if(m_FileName.length()) std::remove(m_FileName.c_str());
+    m_FileName.clear();
+}
+
+
+/**
+ * Creates the scratch file and writes the influence coefficients tile by tile.
+ * @param nPanels the number of panels
+ * @param nBasis the number of unknowns per panel
+ * @param generator the function which calculates the influence of a panel on another
+ * @param bMultiThread if true, the rows of each tile are calculated by the threads of the pool
+ * @param log the function which receives the progress messages
+ * @param cancelled the function which is polled to interrupt the assembly
+ * @return false in case of numerical or I/O error, or if the assembly has been cancelled
+ */
+bool TiledMatrix::build(int nPanels, int nBasis, blockGenerator const &generator, bool bMultiThread,
+                        logFunction const &log, cancelFunction const &cancelled)
+{
+    clear();
+    nBasis = std::max(1, nBasis);
+    if(nPanels<=0) return false;
+
+    int N = nPanels*nBasis;
+
+    // three tiles in memory during the factorization
+    double tilebytes = s_MaxMemory*1024.0*1024.0/3.0;
+    int nTilePanels = int(tilebytes/(double(N)*double(nBasis)*sizeof(double)));
+    nTilePanels = std::max(1, std::min(nTilePanels, nPanels));
+
+    for(int p=0; p<nPanels; p+=nTilePanels) m_TileStart.push_back(p*nBasis);
+    m_TileStart.push_back(N);
+
+    std::string dir = s_Directory.length() ? s_Directory : QDir::tempPath().toStdString();
+    char name[128];
+    snprintf(name, sizeof(name), "/flow5_matrix_%p_%lld.bin", static_cast<void*>(this),
+             static_cast<long long>(std::chrono::system_clock::now().time_since_epoch().count()));
+    m_FileName = dir + name;
+    m_File.open(m_FileName, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+    if(!m_File.is_open())
+    {
+        log("      Could not create the scratch file " + m_FileName + "\n");
+        m_FileName.clear();
+        return false;
+    }
+
+    m_nRows = N;
+    m_ipiv.assign(N, 0);
+    m_WakeCoef.assign(N, {});
+    m_ReadBytes = m_ReadTime = 0.0;
+    m_WriteBytes = m_WriteTime = 0.0;
+
+    char buf[256];
+    snprintf(buf, sizeof(buf), "      Out-of-core matrix: %d tiles of %d rows, %.1f GB in %s\n",
+             nTiles(), tileRows(0), double(N)*double(N)*sizeof(double)/1024.0/1024.0/1024.0, m_FileName.c_str());
+    log(buf);
+
+    std::vector<double> tile;
+    try
+    {
+        tile.resize(size_t(tileRows(0))*size_t(N));
+    }
+    catch(std::bad_alloc &)
+    {
+        log("      Error allocating the memory for the matrix tiles\n");
+        return false;
+    }
+
+    for(int it=0; it<nTiles(); it++)
+    {
+        int r0 = m_TileStart.at(it);
+        int p0 = r0/nBasis;
+        int p1 = m_TileStart.at(it+1)/nBasis;
+        std::atomic<bool> bError{false};
+
+        bool bDone = ThreadPool::parallelFor(p0, p1, [&](int i0, int i1)
+        {
+            std::vector<double> coef(nBasis*nBasis);
+            for(int i=i0; i<i1; i++)
+            {
+                for(int k=0; k<nPanels; k++)
+                {
+                    if(!generator(i, k, coef.data()))
+                    {
+                        bError = true;
+                        return;
+                    }
+                    for(int ib=0; ib<nBasis; ib++)
+                        for(int kb=0; kb<nBasis; kb++)
+                            tile[size_t(i*nBasis+ib-r0)*size_t(N) + size_t(k*nBasis+kb)] = coef[ib*nBasis+kb];
+                }
+            }
+        }, bMultiThread, 0, cancelled);
+
+        if(!bDone || bError) return false;
+        if(!writeTile(it, tile.data()))
+        {
+            log("      Error writing the matrix tiles\n");
+            return false;
+        }
+    }
+
+    log("      Out-of-core matrix assembled: " + throughput() + "\n");
+    return true;
+}
+
+
+/** Adds a wake coefficient; the rows are assumed to be processed by a single thread at a time. */
+void TiledMatrix::addWakeCoef(int row, int col, double value)
+{
+    if(row<0 || row>=m_nRows) return;
+    m_WakeCoef[row].push_back({col, value});
+}
+
+
+/**
+ * Performs the left-looking LU factorization of the transposed matrix, tile by tile.
+ * @return false if the matrix is singular, in case of I/O error, or if the factorization has been cancelled
+ */
+bool TiledMatrix::factorize(logFunction const &log, cancelFunction const &cancelled)
+{
+    int N = m_nRows;
+    if(N<=0) return false;
+
+    int maxrows = 0;
+    for(int it=0; it<nTiles(); it++) maxrows = std::max(maxrows, tileRows(it));
+
+    std::vector<double> Aj, Ak[2];
+    try
+    {
+        Aj.resize(size_t(maxrows)*size_t(N));
+        Ak[0].resize(size_t(maxrows)*size_t(N));
+        Ak[1].resize(size_t(maxrows)*size_t(N));
+    }
+    catch(std::bad_alloc &)
+    {
+        log("      Error allocating the memory for the matrix tiles\n");
+        return false;
+    }
+
+    auto start = std::chrono::steady_clock::now();
+
+    for(int j=0; j<nTiles(); j++)
+    {
+        if(cancelled && cancelled()) return false;
+
+        int j0  = m_TileStart.at(j);
+        int nbj = tileRows(j);
+        if(!readTile(j, Aj.data())) return false;
+
+        for(int r=j0; r<j0+nbj; r++)
+        {
+            for(std::pair<int,double> const &wc : m_WakeCoef.at(r))
+                Aj[size_t(r-j0)*size_t(N) + size_t(wc.first)] += wc.second;
+        }
+
+        // update the tile with the factors of the previous tiles, reading the next one in the background
+        std::future<bool> next;
+        if(j>0) next = std::async(std::launch::async, [this, &Ak]{return readTile(0, Ak[0].data());});
+        for(int k=0; k<j; k++)
+        {
+            if(!next.get()) return false;
+            double const *pk = Ak[k%2].data();
+            if(k+1<j) next = std::async(std::launch::async, [this, &Ak, k]{return readTile(k+1, Ak[(k+1)%2].data());});
+
+            int k0  = m_TileStart.at(k);
+            int nbk = tileRows(k);
+
+            for(int i=k0; i<k0+nbk; i++)
+            {
+                int ip = m_ipiv.at(i)-1;
+                if(ip==i) continue;
+                for(int c=0; c<nbj; c++) std::swap(Aj[size_t(c)*size_t(N)+size_t(i)], Aj[size_t(c)*size_t(N)+size_t(ip)]);
+            }
+
+            cblas_dtrsm(CblasColMajor, CblasLeft, CblasLower, CblasNoTrans, CblasUnit, nbk, nbj, 1.0, pk+k0, N, Aj.data()+k0, N);
+            int m = N-k0-nbk;
+            if(m>0)
+                cblas_dgemm(CblasColMajor, CblasNoTrans, CblasNoTrans, m, nbj, nbk, -1.0, pk+k0+nbk, N, Aj.data()+k0, N, 1.0, Aj.data()+k0+nbk, N);
+
+            if(cancelled && cancelled())
+            {
+                if(next.valid()) next.wait();
+                return false;
+            }
+        }
+
+        lapack_int m = N-j0;
+        lapack_int n = nbj;
+        lapack_int lda = N;
+        lapack_int info = -1;
+        std::vector<lapack_int> piv(nbj);
+        dgetrf_(&m, &n, Aj.data()+j0, &lda, piv.data(), &info);
+        if(info!=0)
+        {
+            log("      Singular matrix\n");
+            return false;
+        }
+        for(int i=0; i<nbj; i++) m_ipiv[j0+i] = int(piv.at(i))+j0;
+
+        if(!writeTile(j, Aj.data()))
+        {
+            log("      Error writing the matrix tiles\n");
+            return false;
+        }
+
+        double elapsed = std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+        char buf[256];
+        snprintf(buf, sizeof(buf), "      Tile %d/%d factorized at %.1f s - ", j+1, nTiles(), elapsed);
+        log(buf + throughput() + "\n");
+    }
+
+    // the wake coefficients are now part of the factors
+    for(std::vector<std::pair<int,double>> &wc : m_WakeCoef) wc.clear();
+
+    return true;
+}
+
+
+/**
+ * Solves the system for a batch of right hand sides, using the factors stored in the scratch file.
+ * The factorization is that of the transpose, so that the solution is x = P.L^-T.U^-T.b
+ * @param RHS the nRHS vectors of size size(), stored contiguously; overwritten with the solutions.
+ */
+bool TiledMatrix::solve(double *RHS, int nRHS)
+{
+    int N = m_nRows;
+    if(N<=0 || nRHS<=0) return N>0;
+
+    int maxrows = 0;
+    for(int it=0; it<nTiles(); it++) maxrows = std::max(maxrows, tileRows(it));
+    std::vector<double> tile[2];
+    try
+    {
+        tile[0].resize(size_t(maxrows)*size_t(N));
+        tile[1].resize(size_t(maxrows)*size_t(N));
+    }
+    catch(std::bad_alloc &)
+    {
+        return false;
+    }
+
+    // forward substitution with U^T, tiles in increasing order
+    std::future<bool> next = std::async(std::launch::async, [this, &tile]{return readTile(0, tile[0].data());});
+    for(int j=0; j<nTiles(); j++)
+    {
+        if(!next.get()) return false;
+        double const *pj = tile[j%2].data();
+        if(j+1<nTiles()) next = std::async(std::launch::async, [this, &tile, j]{return readTile(j+1, tile[(j+1)%2].data());});
+
+        int j0  = m_TileStart.at(j);
+        int nbj = tileRows(j);
+        if(j0>0)
+            cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, nbj, nRHS, j0, -1.0, pj, N, RHS, N, 1.0, RHS+j0, N);
+        cblas_dtrsm(CblasColMajor, CblasLeft, CblasUpper, CblasTrans, CblasNonUnit, nbj, nRHS, 1.0, pj+j0, N, RHS+j0, N);
+    }
+
+    // backward substitution with L^T and row interchanges, tiles in decreasing order
+    int last = nTiles()-1;
+    next = std::async(std::launch::async, [this, &tile, last]{return readTile(last, tile[last%2].data());});
+    for(int k=last; k>=0; k--)
+    {
+        if(!next.get()) return false;
+        double const *pk = tile[k%2].data();
+        if(k>0) next = std::async(std::launch::async, [this, &tile, k]{return readTile(k-1, tile[(k-1)%2].data());});
+
+        int k0  = m_TileStart.at(k);
+        int nbk = tileRows(k);
+        int m = N-k0-nbk;
+        if(m>0)
+            cblas_dgemm(CblasColMajor, CblasTrans, CblasNoTrans, nbk, nRHS, m, -1.0, pk+k0+nbk, N, RHS+k0+nbk, N, 1.0, RHS+k0, N);
+        cblas_dtrsm(CblasColMajor, CblasLeft, CblasLower, CblasTrans, CblasUnit, nbk, nRHS, 1.0, pk+k0, N, RHS+k0, N);
+
+        for(int i=k0+nbk-1; i>=k0; i--)
+        {
+            int ip = m_ipiv.at(i)-1;
+            if(ip==i) continue;
+            for(int r=0; r<nRHS; r++) std::swap(RHS[size_t(r)*size_t(N)+size_t(i)], RHS[size_t(r)*size_t(N)+size_t(ip)]);
+        }
+    }
+
+    return true;
+}
+
+
+bool TiledMatrix::readTile(int iTile, double *tile)
+{
+    std::lock_guard<std::mutex> lock(m_FileMutex);
+    auto start = std::chrono::steady_clock::now();
+
+    std::streamoff offset = std::streamoff(m_TileStart.at(iTile)) * std::streamoff(m_nRows) * std::streamoff(sizeof(double));
+    std::streamsize nbytes = std::streamsize(tileRows(iTile)) * std::streamsize(m_nRows) * std::streamsize(sizeof(double));
+    m_File.seekg(offset);
+    m_File.read(reinterpret_cast<char*>(tile), nbytes);
+    if(m_File.fail())
+    {
+        m_File.clear();
+        return false;
+    }
+
+    m_ReadBytes += double(nbytes);
+    m_ReadTime  += std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+    return true;
+}
+
+
+bool TiledMatrix::writeTile(int iTile, double const *tile)
+{
+    std::lock_guard<std::mutex> lock(m_FileMutex);
+    auto start = std::chrono::steady_clock::now();
+
+    std::streamoff offset = std::streamoff(m_TileStart.at(iTile)) * std::streamoff(m_nRows) * std::streamoff(sizeof(double));
+    std::streamsize nbytes = std::streamsize(tileRows(iTile)) * std::streamsize(m_nRows) * std::streamsize(sizeof(double));
+    m_File.seekp(offset);
+    m_File.write(reinterpret_cast<char const*>(tile), nbytes);
+    m_File.flush();
+    if(m_File.fail())
+    {
+        m_File.clear();
+        return false;
+    }
+
+    m_WriteBytes += double(nbytes);
+    m_WriteTime  += std::chrono::duration<double>(std::chrono::steady_clock::now()-start).count();
+    return true;
+}
+
+
+/** Returns a string with the amounts of data transferred and the throughputs, for the log */
+std::string TiledMatrix::throughput() const
+{
+    double GB = 1024.0*1024.0*1024.0;
+    double MB = 1024.0*1024.0;
+    char buf[256];
+    snprintf(buf, sizeof(buf), "read %.2f GB at %.0f MB/s, written %.2f GB at %.0f MB/s",
+             m_ReadBytes/GB,  m_ReadTime>0.0  ? m_ReadBytes/MB/m_ReadTime   : 0.0,
+             m_WriteBytes/GB, m_WriteTime>0.0 ? m_WriteBytes/MB/m_WriteTime : 0.0);
+    return std::string(buf);
+}
+
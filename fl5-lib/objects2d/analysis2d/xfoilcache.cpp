@@ -0,0 +1,314 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#include <cmath>
+#include <cstring>
+#include <fstream>
+
+#include <xfoilcache.h>
+#include <foil.h>
+#include <lucache.h>
+#include <polar.h>
+
+
+std::unordered_map<uint64_t, std::vector<XFoilCache::Point>> XFoilCache::s_Section;
+int XFoilCache::s_nPoints(0);
+std::mutex XFoilCache::s_Mutex;
+
+bool XFoilCache::s_bEnabled(false);
+bool XFoilCache::s_bStore(false);
+std::string XFoilCache::s_StoreFile;
+double XFoilCache::s_ReTolerance(0.01);
+double XFoilCache::s_ClTolerance(0.02);
+int XFoilCache::s_MaxPoints(1000000);
+
+
+/** The signature of the store files */
+static char const STOREHEADER[8] = {'f','l','5','x','f','o','t','f'};
+static uint64_t const STOREVERSION = 500001;
+
+
+/**
+ * Builds the key of the foil section: the geometry, including the flap deflection, and the analysis settings.
+ */
+uint64_t XFoilCache::sectionKey(Foil const &foil, Polar const &polar)
+{
+    LUCache::Key key;
+    int n = foil.nNodes();
+    key.add(n);
+    for(int i=0; i<n; i++)
+    {
+        key.add(foil.x(i));
+        key.add(foil.y(i));
+    }
+    key.add(polar.Mach());
+    key.add(polar.NCrit());
+    key.add(polar.XTripTop());
+    key.add(polar.XTripBot());
+    return key.value();
+}
+
+
+/**
+ * Interpolates the results at the requested Re and Cl from the two closest cached points
+ * on each side of the requested Cl.
+ * @return true if the requested point is within the tolerances of the cached points.
+ */
+bool XFoilCache::interpolate(std::vector<Point> const &section, double Re, double Cl, Point &result)
+{
+    Point const *pLow  = nullptr;
+    Point const *pHigh = nullptr;
+    for(Point const &pt : section)
+    {
+        if(fabs(pt.m_Re-Re)>s_ReTolerance*fabs(Re)) continue;
+        double dCl = pt.m_Cl-Cl;
+        if(fabs(dCl)>s_ClTolerance) continue;
+
+        if(dCl<=0.0 && (!pLow  || pt.m_Cl>pLow->m_Cl))  pLow  = &pt;
+        if(dCl>=0.0 && (!pHigh || pt.m_Cl<pHigh->m_Cl)) pHigh = &pt;
+    }
+
+    if(!pLow || !pHigh) return false;
+
+    double t = 0.0;
+    if(pHigh->m_Cl-pLow->m_Cl>1.e-9) t = (Cl-pLow->m_Cl)/(pHigh->m_Cl-pLow->m_Cl);
+
+    result.m_Re     = Re;
+    result.m_Cl     = Cl;
+    result.m_Cd     = pLow->m_Cd     * (1.0-t) + pHigh->m_Cd     * t;
+    result.m_XTrTop = pLow->m_XTrTop * (1.0-t) + pHigh->m_XTrTop * t;
+    result.m_XTrBot = pLow->m_XTrBot * (1.0-t) + pHigh->m_XTrBot * t;
+    return true;
+}
+
+
+/**
+ * Fills the points of the polar which can be interpolated from the cache,
+ * and copies the other points in the polar to be calculated by XFoil.
+ * The Cd, the transition locations and the convergence flag of the cached points are set
+ * in the same fields as XFoilTask::processClList().
+ * @param foil the foil with the flap deflection already applied
+ * @param polar the list of Cl and Re values
+ * @param otfpolar the polar of the points which need to be calculated
+ * @param index the index in the polar of each point of the otfpolar
+ * @return the number of points found in the cache
+ */
+int XFoilCache::fetch(Foil const &foil, Polar &polar, Polar &otfpolar, std::vector<int> &index)
+{
+    index.clear();
+    int nHits = 0;
+
+    std::vector<Point> const *pSection = nullptr;
+
+    std::lock_guard<std::mutex> lock(s_Mutex);
+
+    if(s_bEnabled)
+    {
+        auto it = s_Section.find(sectionKey(foil, polar));
+        if(it!=s_Section.end()) pSection = &it->second;
+    }
+
+    for(int k=0; k<polar.dataSize(); k++)
+    {
+        Point pt;
+        if(pSection && interpolate(*pSection, polar.m_Re.at(k), polar.m_Cl.at(k), pt))
+        {
+            // repurposing control variable to contain convergence result
+            polar.m_Control[k] = 1.0;
+            polar.m_Cd[k]      = pt.m_Cd;
+            polar.m_XTrTop[k]  = pt.m_XTrTop;
+            polar.m_XTrBot[k]  = pt.m_XTrBot;
+            nHits++;
+        }
+        else
+            index.push_back(k);
+    }
+
+    otfpolar.copySpecification(polar);
+    otfpolar.resizeData(int(index.size()));
+    for(uint i=0; i<index.size(); i++)
+    {
+        otfpolar.m_Cl[i] = polar.m_Cl.at(index.at(i));
+        otfpolar.m_Re[i] = polar.m_Re.at(index.at(i));
+    }
+
+    return nHits;
+}
+
+
+/**
+ * Copies the results of the otfpolar in the polar, and adds the converged points to the cache.
+ * @param foil the foil with the flap deflection already applied
+ * @param otfpolar the polar calculated by XFoil
+ * @param index the index in the polar of each point of the otfpolar
+ * @param polar the polar in which the results are copied
+ */
+void XFoilCache::store(Foil const &foil, Polar const &otfpolar, std::vector<int> const &index, Polar &polar)
+{
+    for(uint i=0; i<index.size(); i++)
+    {
+        int k = index.at(i);
+        polar.m_Control[k] = otfpolar.m_Control.at(i);
+        polar.m_Cd[k]      = otfpolar.m_Cd.at(i);
+        polar.m_XTrTop[k]  = otfpolar.m_XTrTop.at(i);
+        polar.m_XTrBot[k]  = otfpolar.m_XTrBot.at(i);
+    }
+
+    if(!s_bEnabled) return;
+
+    std::lock_guard<std::mutex> lock(s_Mutex);
+
+    if(s_nPoints+int(index.size())>s_MaxPoints)
+    {
+        s_Section.clear();
+        s_nPoints = 0;
+    }
+
+    std::vector<Point> &section = s_Section[sectionKey(foil, otfpolar)];
+    for(int i=0; i<otfpolar.dataSize(); i++)
+    {
+        if(otfpolar.m_Control.at(i)<=0.0) continue; // unconverged
+
+        Point pt;
+        pt.m_Re     = otfpolar.m_Re.at(i);
+        pt.m_Cl     = otfpolar.m_Cl.at(i);
+        pt.m_Cd     = otfpolar.m_Cd.at(i);
+        pt.m_XTrTop = otfpolar.m_XTrTop.at(i);
+        pt.m_XTrBot = otfpolar.m_XTrBot.at(i);
+        section.push_back(pt);
+        s_nPoints++;
+    }
+}
+
+
+void XFoilCache::clear()
+{
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    s_Section.clear();
+    s_nPoints = 0;
+}
+
+
+int XFoilCache::nPoints()
+{
+    std::lock_guard<std::mutex> lock(s_Mutex);
+    return s_nPoints;
+}
+
+
+/**
+ * Saves the current cache to the store file if requested,
+ * then replaces it with the content of the new store file, if any.
+ */
+void XFoilCache::setStoreFile(std::string const &pathname)
+{
+    if(pathname==s_StoreFile) return;
+
+    if(s_bStore && s_StoreFile.length()) save(s_StoreFile);
+
+    clear();
+    s_StoreFile = pathname;
+
+    if(s_bStore && s_StoreFile.length()) load(s_StoreFile);
+}
+
+
+/**
+ * Adds the points of the file to the cache.
+ * @return true if the file was read successfully.
+ */
+bool XFoilCache::load(std::string const &pathname)
+{
+    std::ifstream in(pathname, std::ios::binary);
+    if(!in.is_open()) return false;
+
+    char header[8];
+    uint64_t version=0, nSections=0;
+    in.read(header, sizeof(header));
+    in.read(reinterpret_cast<char*>(&version), sizeof(uint64_t));
+    in.read(reinterpret_cast<char*>(&nSections), sizeof(uint64_t));
+    if(in.fail() || memcmp(header, STOREHEADER, sizeof(header))!=0 || version!=STOREVERSION) return false;
+
+    std::lock_guard<std::mutex> lock(s_Mutex);
+
+    for(uint64_t is=0; is<nSections; is++)
+    {
+        uint64_t key=0, nPts=0;
+        in.read(reinterpret_cast<char*>(&key),  sizeof(uint64_t));
+        in.read(reinterpret_cast<char*>(&nPts), sizeof(uint64_t));
+        if(in.fail() || s_nPoints+nPts>uint64_t(s_MaxPoints)) return false;
+
+        std::vector<Point> &section = s_Section[key];
+        for(uint64_t ip=0; ip<nPts; ip++)
+        {
+            Point pt;
+            in.read(reinterpret_cast<char*>(&pt.m_Re),     sizeof(double));
+            in.read(reinterpret_cast<char*>(&pt.m_Cl),     sizeof(double));
+            in.read(reinterpret_cast<char*>(&pt.m_Cd),     sizeof(double));
+            in.read(reinterpret_cast<char*>(&pt.m_XTrTop), sizeof(double));
+            in.read(reinterpret_cast<char*>(&pt.m_XTrBot), sizeof(double));
+            if(in.fail()) return false;
+            section.push_back(pt);
+            s_nPoints++;
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Writes the cache to the file.
+ * @return true if the file was written successfully.
+ */
+bool XFoilCache::save(std::string const &pathname)
+{
+    std::ofstream out(pathname, std::ios::binary | std::ios::trunc);
+    if(!out.is_open()) return false;
+
+    std::lock_guard<std::mutex> lock(s_Mutex);
+
+    uint64_t nSections = s_Section.size();
+    out.write(STOREHEADER, sizeof(STOREHEADER));
+    out.write(reinterpret_cast<char const*>(&STOREVERSION), sizeof(uint64_t));
+    out.write(reinterpret_cast<char const*>(&nSections), sizeof(uint64_t));
+
+    for(auto const &it : s_Section)
+    {
+        uint64_t key  = it.first;
+        uint64_t nPts = it.second.size();
+        out.write(reinterpret_cast<char const*>(&key),  sizeof(uint64_t));
+        out.write(reinterpret_cast<char const*>(&nPts), sizeof(uint64_t));
+        for(Point const &pt : it.second)
+        {
+            out.write(reinterpret_cast<char const*>(&pt.m_Re),     sizeof(double));
+            out.write(reinterpret_cast<char const*>(&pt.m_Cl),     sizeof(double));
+            out.write(reinterpret_cast<char const*>(&pt.m_Cd),     sizeof(double));
+            out.write(reinterpret_cast<char const*>(&pt.m_XTrTop), sizeof(double));
+            out.write(reinterpret_cast<char const*>(&pt.m_XTrBot), sizeof(double));
+        }
+    }
+    out.close();
+    return !out.fail();
+}
+
@@ -28,6 +28,9 @@
 //#define _DISABLE_CONSTEXPR_MUTEX_CONSTRUCTOR
 
 
+#include <algorithm>
+#include <cmath>
+
 #include <QString>
 
 
@@ -44,6 +47,12 @@ double XFoilTask::s_CdError = 1.0e-3;
 
 int XFoilTask::s_IterLim=100;
 
+std::mutex XFoilTask::s_BatchMutex;
+std::condition_variable XFoilTask::s_BatchCV;
+std::list<std::pair<uint64_t, std::shared_ptr<XFoilInviscid const>>> XFoilTask::s_Inviscid;
+int XFoilTask::s_MaxInviscid = 16;
+int XFoilTask::s_MaxBLStates = 100;
+
 
 XFoilTask::XFoilTask()
 {
@@ -54,6 +63,7 @@ XFoilTask::XFoilTask()
     m_bAlpha   = true;
 
     m_bErrors = false;
+    m_bBatchMode = false;
 }
 
 
@@ -64,6 +74,134 @@ void XFoilTask::setCancelled(bool b)
 }
 
 
+/** Releases the factorizations and the BL states shared by the tasks of a batch analysis */
+void XFoilTask::clearBatchData()
+{
+    std::lock_guard<std::mutex> lock(s_BatchMutex);
+    s_Inviscid.clear();
+}
+
+
+/**
+ * In batch mode, restores the inviscid factorization of the current panel geometry if another task
+ * has already built it, or builds and shares it otherwise.
+ * The tasks which request a factorization in progress wait for it rather than building it again.
+ */
+bool XFoilTask::initBatchInviscid()
+{
+    uint64_t key = m_XFoilInstance.geometryKey();
+
+    std::unique_lock<std::mutex> lock(s_BatchMutex);
+    while(true)
+    {
+        auto it = std::find_if(s_Inviscid.begin(), s_Inviscid.end(), [key](auto const &entry){return entry.first==key;});
+        if(it==s_Inviscid.end()) break;
+        if(it->second)
+        {
+            std::shared_ptr<XFoilInviscid const> pSystem = it->second;
+            lock.unlock();
+            if(m_XFoilInstance.restoreInviscidSystem(*pSystem))
+            {
+                traceLog("   Using the shared inviscid factorization\n");
+                return true;
+            }
+            return m_XFoilInstance.makeInviscidSystem(); // hash collision
+        }
+        s_BatchCV.wait(lock); // in progress in another task
+    }
+
+    // reserve the entry and build the factorization out of the lock
+    s_Inviscid.push_front({key, nullptr});
+    lock.unlock();
+
+    std::shared_ptr<XFoilInviscid> pSystem;
+    if(m_XFoilInstance.makeInviscidSystem())
+    {
+        pSystem = std::make_shared<XFoilInviscid>();
+        m_XFoilInstance.saveInviscidSystem(*pSystem);
+    }
+
+    lock.lock();
+    auto it = std::find_if(s_Inviscid.begin(), s_Inviscid.end(), [key](auto const &entry){return entry.first==key;});
+    if(it!=s_Inviscid.end())
+    {
+        if(pSystem) it->second = pSystem;
+        else        s_Inviscid.erase(it); // let the next task try
+    }
+    // discard the oldest factorizations which are not in progress
+    int nEntries = int(s_Inviscid.size());
+    for(auto jt=std::prev(s_Inviscid.end()); nEntries>s_MaxInviscid && jt!=s_Inviscid.begin(); )
+    {
+        auto kt = jt--;
+        if(kt->second)
+        {
+            s_Inviscid.erase(kt);
+            nEntries--;
+        }
+    }
+    lock.unlock();
+    s_BatchCV.notify_all();
+
+    return pSystem!=nullptr;
+}
+
+
+/**
+ * In batch mode, seeds the boundary layer with the state of the converged operating point
+ * closest to the requested Re and aoa or Cl on the same panel geometry.
+ * Only the points previously calculated by this task are used, so that the results
+ * do not depend on the order in which the concurrent tasks complete their points.
+ * A 10% difference of Re is given the same weight as a 1° difference of aoa or a 0.1 difference of Cl.
+ * @return true if a state close enough was found.
+ */
+bool XFoilTask::warmStartBL(double Re, double value, bool bAlpha)
+{
+    uint64_t key = m_XFoilInstance.geometryKey();
+
+    XFoilBLState const *pBest = nullptr;
+    double dmin = 3.0;
+    for(XFoilBLState const &state : m_BLState)
+    {
+        if(state.m_Key!=key || state.m_Re<=0.0 || Re<=0.0) continue;
+        double d = fabs(std::log(Re/state.m_Re))/std::log(1.1);
+        if(bAlpha) d += fabs(value-state.m_Alpha);
+        else       d += fabs(value-state.m_Cl)*10.0;
+        if(d<dmin)
+        {
+            dmin = d;
+            pBest = &state;
+        }
+    }
+    if(!pBest) return false;
+
+    if(!m_XFoilInstance.restoreBLState(*pBest)) return false;
+    traceLog(QString::asprintf("   Starting the BL from the solution at Re=%g  %s=%g\n",
+                               pBest->m_Re, bAlpha ? "aoa" : "Cl", bAlpha ? pBest->m_Alpha : pBest->m_Cl));
+    return true;
+}
+
+
+/** In batch mode, keeps the BL state of the last converged operating point for the warm starts of this task */
+void XFoilTask::storeBLState()
+{
+    XFoilBLState newstate;
+    m_XFoilInstance.saveBLState(newstate);
+
+    // replace the state of the same operating point, if any
+    for(auto it=m_BLState.begin(); it!=m_BLState.end(); ++it)
+    {
+        XFoilBLState const &state = *it;
+        if(state.m_Key==newstate.m_Key && fabs(state.m_Re-newstate.m_Re)<1.e-3*newstate.m_Re && fabs(state.m_Alpha-newstate.m_Alpha)<AOAPRECISION)
+        {
+            m_BLState.erase(it);
+            break;
+        }
+    }
+    m_BLState.push_front(std::move(newstate));
+    while(int(m_BLState.size())>s_MaxBLStates) m_BLState.pop_back();
+}
+
+
 void XFoilTask::setAlphaRange(double vMin, double vMax, double vDelta)
 {
     m_bAlpha = true;
@@ -107,7 +245,7 @@ void XFoilTask::traceStdLog(std::string const &str)
 
 void XFoilTask::run()
 {
-    if(s_bCancel || !m_pPolar || !m_pFoil)
+    if(bCancelled() || !m_pPolar || !m_pFoil)
     {
         m_AnalysisStatus = xfl::FINISHED;
     }
@@ -138,7 +276,9 @@ bool XFoilTask::initialize(FoilAnalysis *pFoilAnalysis, bool bKeepOpps)
 
 bool XFoilTask::initialize(Foil &foil, Polar *pPolar, bool bKeepOpps)
 {
-    s_bCancel = false;
+    // only reset this task's flag; the global flags are reset by the caller
+    // so that a task started in a pool does not undo a cancellation request
+    m_XFoilInstance.setInstanceCancel(false);
 
     m_bKeepOpps = bKeepOpps;
 
@@ -147,8 +287,7 @@ bool XFoilTask::initialize(Foil &foil, Polar *pPolar, bool bKeepOpps)
     m_pPolar = pPolar;
 
     m_AnalysisStatus = xfl::PENDING;
-
-    XFoil::s_bCancel = false;
+    m_BLState.clear();
 
     std::vector<double> x(m_pFoil->nNodes()), y(m_pFoil->nNodes()), nx(m_pFoil->nNodes()), ny(m_pFoil->nNodes());
     for(int i=0; i<m_pFoil->nNodes(); i++)
@@ -276,7 +415,7 @@ bool XFoilTask::processClRange(Polar *pPolar, AnalysisRange const &range)
 
     do
     {
-        if(s_bCancel) break;
+        if(bCancelled()) break;
 
         m_XFoilInstance.lalfa = false;
         m_XFoilInstance.alfa = 0.0;
@@ -349,7 +488,7 @@ bool XFoilTask::processClList()
 
     for(uint icl=0; icl<m_pPolar->m_Cl.size(); icl++)
     {
-        if(s_bCancel) break;
+        if(bCancelled()) break;
 
         double Cl = m_pPolar->m_Cl.at(icl);
 
@@ -439,10 +578,11 @@ bool XFoilTask::alphaSequence(bool bAlpha)
                                           m_pPolar->ReType(), m_pPolar->MaType(), bViscous))
         return false;
 
+    if(m_bBatchMode) initBatchInviscid();
 
     for (uint iSeries=0; iSeries<m_AnalysisRange.size(); iSeries++)
     {
-        if(s_bCancel) break;
+        if(bCancelled()) break;
         AnalysisRange const &range = m_AnalysisRange.at(iSeries);
         if(range.isActive())
         {
@@ -467,7 +607,11 @@ bool XFoilTask::alphaSequence(bool bAlpha)
 
         do
         {
-            if(s_bCancel) break;
+            if(bCancelled()) break;
+
+            // at the start of the range or after an unconverged point
+            if(m_bBatchMode && !m_XFoilInstance.isBLInitialized())
+                warmStartBL(m_pPolar->Reynolds(), bAlpha ? alphadeg : Cl, bAlpha);
 
             if(bAlpha)
             {
@@ -520,6 +664,8 @@ bool XFoilTask::alphaSequence(bool bAlpha)
                 }
                 else
                 {
+                    if(m_bBatchMode) storeBLState();
+
                     OpPoint *pOpPoint = new OpPoint;
                     pOpPoint->setFoilName(m_pFoil->name());
                     pOpPoint->setPolarName(m_pPolar->name());
@@ -544,7 +690,7 @@ bool XFoilTask::alphaSequence(bool bAlpha)
                 m_bErrors = true;
             }
 
-            if(XFoil::s_bFullReport)
+            if(m_XFoilInstance.bInstanceFullReport())
             {
                 traceStdLog(m_XFoilInstance.report());
             }
@@ -615,7 +761,7 @@ bool XFoilTask::thetaSequence()
 
     for (uint iSeries=0; iSeries<m_AnalysisRange.size(); iSeries++)
     {
-        if(s_bCancel) break;
+        if(bCancelled()) break;
         AnalysisRange const &range = m_AnalysisRange.at(iSeries);
         if(range.isActive())
         {
@@ -642,7 +788,7 @@ bool XFoilTask::thetaSequence()
 
         for(int iter=0; iter<nTheta; iter++)
         {
-            if(s_bCancel) break;
+            if(bCancelled()) break;
 
             m_XFoilInstance.alfa = alphadeg * PI/180.0;
             m_XFoilInstance.lalfa = true;
@@ -721,7 +867,7 @@ bool XFoilTask::thetaSequence()
                 m_bErrors = true;
             }
 
-            if(XFoil::s_bFullReport)
+            if(m_XFoilInstance.bInstanceFullReport())
             {
                 traceStdLog(m_XFoilInstance.report());
             }
@@ -769,7 +915,7 @@ bool XFoilTask::ReSequence()
 
     for (uint iSeries=0; iSeries<m_AnalysisRange.size(); iSeries++)
     {
-        if(s_bCancel) break;
+        if(bCancelled()) break;
         AnalysisRange const &range = m_AnalysisRange.at(iSeries);
         if(range.isActive())
         {
@@ -842,7 +988,7 @@ bool XFoilTask::ReSequence()
             else delete pOpPoint;
 
 
-            if(XFoil::s_bFullReport)
+            if(m_XFoilInstance.bInstanceFullReport())
             {
                 traceStdLog(m_XFoilInstance.report());
             }
@@ -874,7 +1020,7 @@ int XFoilTask::loop()
         return -1;
     }
 
-    while(iterations<s_IterLim && !m_XFoilInstance.lvconv && !s_bCancel)
+    while(iterations<s_IterLim && !m_XFoilInstance.lvconv && !bCancelled())
     {
         if(m_XFoilInstance.ViscousIter())
         {
@@ -883,7 +1029,7 @@ int XFoilTask::loop()
         else iterations = s_IterLim;
     }
 
-    if(s_bCancel)  return -1;// to exit loop
+    if(bCancelled())  return -1;// to exit loop
 
     if(!m_XFoilInstance.ViscalEnd())
     {
@@ -0,0 +1,482 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include <polarmesh.h>
+#include <foil.h>
+#include <objects2d.h>
+
+
+PolarMesh::PolarMesh()
+{
+}
+
+
+void PolarMesh::clear()
+{
+    m_Foil.clear();
+}
+
+
+/**
+ * Makes the index of the polars of the input foils.
+ * The arrays of the polars are copied, so that the mesh does not depend on the lifetime of the Polar objects.
+ */
+void PolarMesh::makeMesh(std::vector<Foil*> const &foils, std::vector<Polar*> const &polars)
+{
+    m_Foil.clear();
+
+    for(Foil const *pFoil : foils)
+    {
+        if(!pFoil) continue;
+        FoilTables &ft = m_Foil[pFoil];
+
+        for(Polar const *pPolar : polars)
+        {
+            if(pPolar->foilName().compare(pFoil->name())!=0) continue;
+
+            ft.m_ZeroLift.push_back({pPolar->Reynolds(), pPolar->getZeroLiftAngle()});
+
+            if(!pPolar->isFixedSpeedPolar()) continue;
+            ft.m_bHasPolars = true;
+            if(!pPolar->hasData()) continue;
+
+            ft.m_Polar.push_back(PolarTable());
+            makeTable(pPolar, ft.m_Polar.back());
+        }
+
+        // the polars are already sorted by Re in the array, except if they were computed with different BL methods
+        std::stable_sort(ft.m_Polar.begin(), ft.m_Polar.end(),
+                         [](PolarTable const &p0, PolarTable const &p1) {return p0.m_Re<p1.m_Re;});
+        std::stable_sort(ft.m_ZeroLift.begin(), ft.m_ZeroLift.end(),
+                         [](std::pair<double, double> const &p0, std::pair<double, double> const &p1) {return p0.first<p1.first;});
+    }
+}
+
+
+void PolarMesh::makeTable(Polar const *pPolar, PolarTable &table)
+{
+    table.m_Re = pPolar->Reynolds();
+
+    table.m_Var.resize(Polar::XTSBOT+1);
+    for(int iv=0; iv<=Polar::XTSBOT; iv++)
+        table.m_Var[iv] = pPolar->getPlrVariable(Polar::enumPolarVariable(iv));
+
+    pPolar->getAlphaLimits(table.m_AlphaMin, table.m_AlphaMax);
+    pPolar->getClLimits(table.m_ClMin, table.m_ClMax);
+
+    std::vector<double> const &cl = table.cl();
+    if(cl.empty()) return;
+
+    // start from the point closest to Cl=0 because of weird shaped polars
+    int pt = 0;
+    double dist = fabs(cl.front());
+    for(int i=1; i<int(cl.size()); i++)
+    {
+        if(fabs(cl.at(i))<dist)
+        {
+            dist = fabs(cl.at(i));
+            pt = i;
+        }
+    }
+    table.m_iCl0 = pt;
+
+    int lo = pt;
+    while(lo>0 && cl.at(lo-1)<cl.at(lo)) lo--;
+    int hi = pt;
+    while(hi<int(cl.size())-1 && cl.at(hi+1)>cl.at(hi)) hi++;
+    table.m_iClLow  = lo;
+    table.m_iClHigh = hi;
+}
+
+
+/** Same as Polar::interpolateFromAlpha, using a binary search on the sorted aoa array */
+double PolarMesh::PolarTable::interpolateFromAlpha(double alpha, Polar::enumPolarVariable PlrVar, bool &bOutAlpha) const
+{
+    std::vector<double> const &pX = m_Var.at(PlrVar);
+    std::vector<double> const &a = this->alpha();
+
+    if(alpha<m_AlphaMin)
+    {
+        bOutAlpha = true;
+        return pX.front();
+    }
+
+    if(alpha>m_AlphaMax)
+    {
+        bOutAlpha = true;
+        return pX.back();
+    }
+
+    int i = int(std::upper_bound(a.begin(), a.end(), alpha)-a.begin()) - 1;
+    if(i<0)
+    {
+        bOutAlpha = true;
+        return 0.0;
+    }
+    if(i>=int(a.size())-1)
+    {
+        // alpha is the last point of the polar
+        return pX.back();
+    }
+
+    //interpolate
+    if(a.at(i+1)-a.at(i)<0.00001)//do not divide by zero
+        return pX.at(i);
+
+    double u = (alpha - a.at(i)) /(a.at(i+1)-a.at(i));
+    return pX.at(i) + u * (pX.at(i+1)-pX.at(i));
+}
+
+
+/**
+ * Same as Polar::interpolateFromCl.
+ * The branch of increasing Cl values around Cl=0 is searched by bisection;
+ * the walk along the rest of the polar is only made for the post-stall values.
+ */
+double PolarMesh::PolarTable::interpolateFromCl(double Cl, Polar::enumPolarVariable PlrVar, bool &bOutCl) const
+{
+    std::vector<double> const &pX = m_Var.at(PlrVar);
+    std::vector<double> const &c = cl();
+
+    if(Cl < m_ClMin)
+    {
+        bOutCl = true;
+        if(pX.size()) return pX.front();
+        else          return 0.0;
+    }
+    else if(Cl > m_ClMax)
+    {
+        bOutCl= true;
+        if(pX.size()) return pX.back();
+        else          return 0.0;
+    }
+
+    int pt = m_iCl0;
+    if(Cl<c.at(pt))
+    {
+        int i0 = m_iClLow;
+        if(Cl>c.at(m_iClLow))
+        {
+            i0 = int(std::lower_bound(c.begin()+m_iClLow, c.begin()+pt+1, Cl)-c.begin());
+        }
+
+        for (int i=i0; i>0; i--)
+        {
+            if(Cl<= c.at(i) && Cl > c.at(i-1))
+            {
+                //interpolate
+                if(fabs(c.at(i)-c.at(i-1)) < 0.00001)
+                    return pX.at(i); //do not divide by zero
+
+                double u = (Cl - c.at(i-1)) /(c.at(i)-c.at(i-1));
+                return pX.at(i-1) + u * (pX.at(i)-pX.at(i-1));
+            }
+        }
+    }
+    else
+    {
+        int i0 = m_iClHigh;
+        if(Cl<c.at(m_iClHigh))
+        {
+            i0 = int(std::upper_bound(c.begin()+pt, c.begin()+m_iClHigh+1, Cl)-c.begin()) - 1;
+        }
+
+        for (int i=i0; i<int(c.size())-1; i++)
+        {
+            if(c.at(i) <=Cl && Cl < c.at(i+1))
+            {
+                //interpolate
+                if(fabs(c.at(i+1)-c.at(i)) < 0.00001)
+                    return pX.at(i); //do not divide by zero
+
+                double u = (Cl - c.at(i)) / (c.at(i+1)-c.at(i));
+                return pX.at(i) + u * (pX.at(i+1)-pX.at(i));
+            }
+        }
+    }
+
+    bOutCl = true;
+    return 0.0;
+}
+
+
+PolarMesh::FoilTables const *PolarMesh::foilTables(Foil const *pFoil) const
+{
+    auto it = m_Foil.find(pFoil);
+    if(it==m_Foil.end()) return nullptr;
+    return &it->second;
+}
+
+
+/**
+ * Same as Objects2d::getPlrPointFromCl.
+ * Falls back on the Objects2d method if the foil is not in the mesh.
+ */
+double PolarMesh::getPlrPointFromCl(Foil const*pFoil, double Re, double Cl, Polar::enumPolarVariable PlrVar, bool &bOutRe, bool &bOutCl) const
+{
+    if(!pFoil)
+    {
+        bOutRe = true;
+        bOutCl = true;
+        return 0.000;
+    }
+
+    FoilTables const *pTables = foilTables(pFoil);
+    if(!pTables) return Objects2d::getPlrPointFromCl(pFoil, Re, Cl, PlrVar, bOutRe, bOutCl);
+
+    std::vector<PolarTable> const &polars = pTables->m_Polar;
+
+    if(polars.size()==0)
+    {
+        // can't interpolate anything
+        bOutRe = true;
+        return 0;
+    }
+    else if(polars.size()==1 || Re<polars.front().m_Re)
+    {
+        //interpolate Cl on this polar
+        bOutRe = true;
+        return polars.front().interpolateFromCl(Cl, PlrVar, bOutCl);
+    }
+
+    // find the two polars with Reynolds number surrounding the specified Re
+    // and which include the Cl value
+    int ip = int(std::upper_bound(polars.begin(), polars.end(), Re,
+                                  [](double re, PolarTable const &p) {return re<p.m_Re;}) - polars.begin());
+
+    PolarTable const *pPolar1 = nullptr;
+    PolarTable const *pPolar2 = nullptr;
+    for(int i=ip-1; i>=0; i--)
+    {
+        if(polars.at(i).m_ClMin <= Cl && Cl <= polars.at(i).m_ClMax)
+        {
+            pPolar1 = &polars.at(i);
+            break;
+        }
+    }
+    for(int i=ip; i<int(polars.size()); i++)
+    {
+        if(polars.at(i).m_ClMin <= Cl && Cl <= polars.at(i).m_ClMax)
+        {
+            pPolar2 = &polars.at(i);
+            break;
+        }
+    }
+
+    if(!pPolar1)
+    {
+        bOutRe = true;
+        bOutCl = true;
+        return 0.000;
+    }
+
+    if (!pPolar2)
+    {
+        //then Re is greater than that of any polar
+        // so use the last polar and interpolate Cls on this polar
+        bOutRe = true;
+        return pPolar1->interpolateFromCl(Cl, PlrVar, bOutCl);
+    }
+
+    // Re is between that of polars 1 and 2
+    // so interpolate Cls for each
+    double Var1 = pPolar1->interpolateFromCl(Cl, PlrVar, bOutCl);
+    double Var2 = pPolar2->interpolateFromCl(Cl, PlrVar, bOutCl);
+
+    double v = (Re - pPolar1->m_Re) / (pPolar2->m_Re - pPolar1->m_Re);
+    return Var1 + v * (Var2-Var1);
+}
+
+
+/**
+ * Same as Objects2d::getPlrPointFromAlpha.
+ * Falls back on the Objects2d method if the foil is not in the mesh.
+ */
+double PolarMesh::getPlrPointFromAlpha(Foil const*pFoil, double Re, double Alpha, Polar::enumPolarVariable PlrVar, bool &bOutRe, bool &bOutAlpha) const
+{
+    bOutRe = false;
+
+    if(!pFoil)
+    {
+        bOutRe = true;
+        bOutAlpha = true;
+        return 0.000;
+    }
+
+    FoilTables const *pTables = foilTables(pFoil);
+    if(!pTables) return Objects2d::getPlrPointFromAlpha(pFoil, Re, Alpha, PlrVar, bOutRe, bOutAlpha);
+
+    if(!pTables->m_bHasPolars)
+    {
+        bOutRe=true;
+        return 0.0;
+    }
+
+    std::vector<PolarTable> const &polars = pTables->m_Polar;
+    if(polars.empty())
+    {
+        bOutRe = true;
+        bOutAlpha = true;
+        return 0.000;
+    }
+
+    //if Re is less than that of the first polar, use this one
+    if(Re<polars.front().m_Re)
+    {
+        bOutRe = true;
+        return polars.front().interpolateFromAlpha(Alpha, PlrVar, bOutAlpha);
+    }
+
+    // find the two polars surrounding the Re number
+    int ip = int(std::upper_bound(polars.begin(), polars.end(), Re,
+                                  [](double re, PolarTable const &p) {return re<p.m_Re;}) - polars.begin());
+
+    PolarTable const &polar1 = polars.at(ip-1);
+
+    if(ip>=int(polars.size()))
+    {
+        //then Re is greater than that of any polar
+        // so use last polar and interpolate alphas on this polar
+        bOutRe = true;
+        return polar1.interpolateFromAlpha(Alpha, PlrVar, bOutAlpha);
+    }
+
+    // Re is between that of polars 1 and 2
+    // so interpolate alphas for each
+    PolarTable const &polar2 = polars.at(ip);
+    double Var1 = polar1.interpolateFromAlpha(Alpha, PlrVar, bOutAlpha);
+    double Var2 = polar2.interpolateFromAlpha(Alpha, PlrVar, bOutAlpha);
+
+    double v = (Re - polar1.m_Re) / (polar2.m_Re - polar1.m_Re);
+    return Var1 + v * (Var2-Var1);
+}
+
+
+/** Same as Objects2d::getPlrPointFromAlpha */
+double PolarMesh::getPlrPointFromAlpha(Polar::enumPolarVariable var, Foil const*pFoil0, Foil const*pFoil1,
+                                       double Re, double Alpha, double Tau, bool &bOutRe, bool &bOutCl) const
+{
+    if(!pFoil0 || !pFoil1)
+    {
+        bOutRe = true;
+        bOutCl = true;
+        return 0.0;
+    }
+
+    bool IsOutRe = false;
+    bool IsOutCl  = false;
+    bOutRe = false;
+    bOutCl = false;
+
+    double var0 = getPlrPointFromAlpha(pFoil0, Re, Alpha, var, IsOutRe, IsOutCl);
+    if(IsOutRe) bOutRe = true;
+    if(IsOutCl) bOutCl = true;
+    double var1 = getPlrPointFromAlpha(pFoil1, Re, Alpha, var, IsOutRe, IsOutCl);
+    if(IsOutRe) bOutRe = true;
+    if(IsOutCl) bOutCl = true;
+
+    if (Tau<0.0) Tau = 0.0;
+    if (Tau>1.0) Tau = 1.0;
+    return ((1-Tau) * var0 + Tau * var1);
+}
+
+
+double PolarMesh::zeroLiftAngle(Foil const *pFoil, double Re) const
+{
+    if(!pFoil) return 0.0;
+
+    FoilTables const *pTables = foilTables(pFoil);
+    if(!pTables) return Objects2d::getZeroLiftAngle(pFoil, nullptr, Re, 0.0);
+
+    std::vector<std::pair<double, double>> const &zl = pTables->m_ZeroLift;
+
+    // the last polar with a lower Re and the first polar with a higher Re
+    int i1 = int(std::lower_bound(zl.begin(), zl.end(), Re,
+                                  [](std::pair<double, double> const &p, double re) {return p.first<re;}) - zl.begin()) - 1;
+    int i2 = int(std::upper_bound(zl.begin(), zl.end(), Re,
+                                  [](double re, std::pair<double, double> const &p) {return re<p.first;}) - zl.begin());
+
+    bool bPolar1 = i1>=0;
+    bool bPolar2 = i2<int(zl.size());
+
+    if(bPolar1 && bPolar2)
+    {
+        double a01 = zl.at(i1).second;
+        double a02 = zl.at(i2).second;
+        return a01 + (a02-a01) * (Re-zl.at(i1).first)/(zl.at(i2).first-zl.at(i1).first);
+    }
+    else if(bPolar1) return zl.at(i1).second;
+    else if(bPolar2) return zl.at(i2).second;
+    return 0.0;
+}
+
+
+/** Same as Objects2d::getZeroLiftAngle */
+double PolarMesh::getZeroLiftAngle(Foil const *pFoil0, Foil const*pFoil1, double Re, double Tau) const
+{
+    return (1-Tau) * zeroLiftAngle(pFoil0, Re) + Tau * zeroLiftAngle(pFoil1, Re);
+}
+
+
+/** Same as Objects2d::getCm0 */
+double PolarMesh::getCm0(Foil const *pFoil0, Foil const *pFoil1, double Re, double Tau, bool &bOutRe, bool &bError) const
+{
+    //Find 0-lift angle for local foil
+    double Alpha(0);
+    double Cl0(0), Cl1(0);
+
+    bOutRe = false;
+    bError = false;
+    bool IsOutRe = false;
+    bool IsError = false;
+
+    for (int i=-10; i<10; i++)
+    {
+        Alpha = double(i);
+        Cl1 = getPlrPointFromAlpha(Polar::CL, pFoil0, pFoil1, Re, Alpha, Tau, IsOutRe, IsError);
+        if(Cl1>0.0)
+        {
+            if(IsOutRe) bOutRe = true;
+            if(IsError) bError = true;
+            break;
+        }
+        Cl0 = Cl1;
+    }
+    if(Cl0>0.0)
+    {
+        return 0.0;
+    }
+    double Cm0 = getPlrPointFromAlpha(Polar::CM, pFoil0, pFoil1, Re, Alpha-1.0, Tau, IsOutRe, IsError);
+    if(IsOutRe) bOutRe = true;
+    if(IsError) bError = true;
+    double Cm1 = getPlrPointFromAlpha(Polar::CM, pFoil0, pFoil1, Re, Alpha, Tau, IsOutRe, IsError);
+    if(IsOutRe) bOutRe = true;
+    if(IsError) bError = true;
+
+    return Cm0 + (Cm1-Cm0)*(0.0-Cl0)/(Cl1-Cl0);
+}
+
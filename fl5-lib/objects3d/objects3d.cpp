@@ -28,6 +28,8 @@
 #include <QCoreApplication>
 #include <QtConcurrent/QtConcurrent>
 
+#include <mutex>
+
 
 
 #include <fusexfl.h>
@@ -49,6 +51,9 @@ std::vector<Plane*>        Objects3d::s_oaPlane;
 std::vector<PlanePolar*>   Objects3d::s_oaPlanePolar;
 std::vector<PlaneOpp*>     Objects3d::s_oaPlaneOpp;
 
+// the plane tasks of a batch may insert their operating points concurrently
+static std::mutex s_PlaneOppMutex;
+
 
 int Objects3d::newUniquePartIndex()
 {
@@ -114,6 +119,8 @@ Plane *Objects3d::addPlane(Plane *pPlane)
 
 void Objects3d::insertPlaneOpp(PlaneOpp *pPOpp)
 {
+    std::lock_guard<std::mutex> lock(s_PlaneOppMutex);
+
     PlaneOpp *pOldPOpp = nullptr;
     bool bIsInserted = false;
 
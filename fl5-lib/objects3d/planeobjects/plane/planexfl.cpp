@@ -43,7 +43,10 @@
 #include <units.h>
 #include <utils.h>
 #include <constants.h>
+#include <spatialhash.h>
+#include <threadpool.h>
 
+bool PlaneXfl::s_bParallelMeshing(true);
 
 
 PlaneXfl::PlaneXfl(bool bDefaultPlane) : Plane()
@@ -363,12 +366,20 @@ void PlaneXfl::createWingSideNodes()
         pTranslatedFuse->translate(fusePos(0));
     }
 
+    std::vector<Surface*> surfaces;
     for(int iw=0; iw<nWings(); iw++)
     {
         WingXfl *pWing = wing(iw);
         for (int j=0; j<pWing->nSurfaces(); j++)
-            pWing->surface(j).makeSideNodes(pTranslatedFuse);
+            surfaces.push_back(&pWing->surface(j));
     }
+
+    ThreadPool::parallelFor(0, int(surfaces.size()), [&surfaces, pTranslatedFuse](int is0, int is1)
+                            {
+                                for(int is=is0; is<is1; is++) surfaces[is]->makeSideNodes(pTranslatedFuse);
+                            },
+                            s_bParallelMeshing, 1);
+
     if(pTranslatedFuse) delete pTranslatedFuse;
 }
 
@@ -1319,21 +1330,59 @@ void PlaneXfl::makePlane(bool bThickSurfaces, bool bIgnoreFusePanels, bool bMake
 }
 
 
+/**
+ * Builds the reference quad mesh.
+ * The index of the first panel and of the first wake column of each surface are known in advance,
+ * so that the surfaces are meshed concurrently and their panels are appended in surface order;
+ * the mesh is the same whatever the number of threads.
+ */
 void PlaneXfl::makeQuadMesh(bool bThickSurfaces, bool bIgnoreFusePanels)
 {
-    int m_nWakeColumn = 0;
     m_RefQuadMesh.clearMesh();
-    int Nel = 0;
 
+    std::vector<Surface*> surfaces;
+    std::vector<int> nTipStrips, n4start, iWakeColumn;
+    int n4=0, nWakeColumn=0;
     for(int iw=0; iw<nWings(); iw++)
     {
-        wing(iw)->m_nPanel4 = 0;
-        wing(iw)->setFirstPanel4Index(m_RefQuadMesh.nPanels());
-        for(int jSurf=0; jSurf<wing(iw)->nSurfaces(); jSurf++)
+        WingXfl *pWing = wing(iw);
+        pWing->m_nPanel4 = 0;
+        pWing->setFirstPanel4Index(n4);
+        for(int jSurf=0; jSurf<pWing->nSurfaces(); jSurf++)
         {
-            Surface &surf = wing(iw)->m_Surface[jSurf];
-            Nel = surf.makeQuadPanels(m_RefQuadMesh.panels(), m_nWakeColumn, bThickSurfaces, wingAt(iw)->nTipStrips());
-            wing(iw)->m_nPanel4 += Nel;
+            Surface &surf = pWing->m_Surface[jSurf];
+            surfaces.push_back(&surf);
+            nTipStrips.push_back(pWing->nTipStrips());
+            n4start.push_back(n4);
+            iWakeColumn.push_back(nWakeColumn);
+            n4          += surf.quadPanelCount(bThickSurfaces, pWing->nTipStrips());
+            nWakeColumn += surf.wakeColumnCount(bThickSurfaces);
+        }
+    }
+
+    std::vector<std::vector<Panel4>> surfpanels(surfaces.size());
+    ThreadPool::parallelFor(0, int(surfaces.size()), [&](int is0, int is1)
+                            {
+                                for(int is=is0; is<is1; is++)
+                                {
+                                    int iwc = iWakeColumn.at(is);
+                                    surfaces[is]->makeQuadPanels(surfpanels[is], n4start.at(is), iwc, bThickSurfaces, nTipStrips.at(is));
+                                    assert(int(surfpanels.at(is).size())==surfaces.at(is)->quadPanelCount(bThickSurfaces, nTipStrips.at(is)));
+                                }
+                            },
+                            s_bParallelMeshing, 1);
+
+    std::vector<Panel4> &panel4list = m_RefQuadMesh.panels();
+    panel4list.reserve(n4);
+    int is = 0;
+    for(int iw=0; iw<nWings(); iw++)
+    {
+        WingXfl *pWing = wing(iw);
+        for(int jSurf=0; jSurf<pWing->nSurfaces(); jSurf++)
+        {
+            pWing->m_nPanel4 += int(surfpanels.at(is).size());
+            panel4list.insert(panel4list.end(), surfpanels.at(is).begin(), surfpanels.at(is).end());
+            is++;
         }
     }
 
@@ -1383,31 +1432,47 @@ void PlaneXfl::makeQuadMesh(bool bThickSurfaces, bool bIgnoreFusePanels)
         }
     }
 
-    //Connect quad panels of adjacent surfaces
-    for(int iw=0; iw<nWings(); iw++)
-    {
-        WingXfl *pWing = wing(iw);
-        for(int jSurf=0; jSurf<pWing->nSurfaces()-1; jSurf++)
-        {
-            if(!pWing->surfaceAt(jSurf).isTipRight() && !pWing->surfaceAt(jSurf).isClosedRightSide())
-            {
-                joinSurfaces(pWing->surfaceAt(jSurf), pWing->surfaceAt(jSurf+1));
-            }
-        }
-    }
+    //Connect quad panels of adjacent surfaces; the wings have no panels in common
+    ThreadPool::parallelFor(0, nWings(), [this](int iw0, int iw1)
+                            {
+                                for(int iw=iw0; iw<iw1; iw++)
+                                {
+                                    WingXfl *pWing = wing(iw);
+                                    for(int jSurf=0; jSurf<pWing->nSurfaces()-1; jSurf++)
+                                    {
+                                        if(!pWing->surfaceAt(jSurf).isTipRight() && !pWing->surfaceAt(jSurf).isClosedRightSide())
+                                        {
+                                            joinSurfaces(pWing->surfaceAt(jSurf), pWing->surfaceAt(jSurf+1));
+                                        }
+                                    }
+                                }
+                            },
+                            s_bParallelMeshing, 1);
 
     m_QuadMesh = m_RefQuadMesh;
 }
 
 
+/**
+ * Builds the reference triangular mesh.
+ * The number of panels of a wing is only known once its null triangles have been discarded,
+ * so the wings are meshed concurrently with local indexes, then offset and appended in wing order;
+ * the mesh is the same whatever the number of threads.
+ */
 void PlaneXfl::makeTriMesh(bool bThickSurfaces)
 {
     m_RefTriMesh.clearMesh();
 
+    ThreadPool::parallelFor(0, nWings(), [this, bThickSurfaces](int iw0, int iw1)
+                            {
+                                for(int iw=iw0; iw<iw1; iw++) m_Wing[iw].makeTriPanels(0, 0, bThickSurfaces);
+                            },
+                            s_bParallelMeshing, 1);
+
     for(int iw=0; iw<nWings(); iw++)
     {
         WingXfl &wing = m_Wing[iw];
-        wing.makeTriPanels(m_RefTriMesh.nPanels(), m_RefTriMesh.nNodes(), bThickSurfaces);
+        wing.offsetTriPanels(m_RefTriMesh.nPanels(), m_RefTriMesh.nNodes());
         m_RefTriMesh.appendMesh(wing.triMesh());
         if(wing.isFin()) m_RefTriMesh.lastPanel().m_iPD = -1; // because there is no right tip patch
     }
@@ -1779,6 +1844,16 @@ void PlaneXfl::joinSurfaces(Surface const &LeftSurf, Surface const &RightSurf)
 {
     std::vector<Panel4> &panels = m_RefQuadMesh.panels();
 
+    // hash the right surface's panels on the leading point of their left side,
+    // so that only the nearby panels are tested rather than all the right surface's panels
+    SpatialHash righthash(LENGTHPRECISION);
+    for(uint ir=0; ir<RightSurf.panel4List().size(); ir++)
+    {
+        Panel4 const &pr = panels.at(RightSurf.panel4List().at(ir));
+        righthash.insert(pr.isBotPanel() ? pr.LB() : pr.LA(), int(ir));
+    }
+
+    std::vector<int> candidates;
     for(uint il=0; il<LeftSurf.panel4List().size(); il++)
     {
         int idx0 = LeftSurf.panel4List().at(il);
@@ -1786,7 +1861,9 @@ void PlaneXfl::joinSurfaces(Surface const &LeftSurf, Surface const &RightSurf)
 
         if(pl.isFlapPanel()) continue; // do not connect flaps to adjacent surface
 
-        for(uint ir=0; ir<RightSurf.panel4List().size(); ir++)
+        // candidates in increasing order, as in the list of the right surface's panels
+        righthash.candidates(pl.isBotPanel() ? pl.LA() : pl.LB(), candidates);
+        for(int ir : candidates)
         {
             int idx1 = RightSurf.panel4List().at(ir);
             Panel4 &pr = panels[idx1];
@@ -44,6 +44,7 @@
 #include <vector3d.h>
 
 #include <bspline3d.h>
+#include <threadpool.h>
 
 
 std::vector<Vector3d> Surface::s_DebugPts;
@@ -848,30 +849,15 @@ void Surface::makeSideNodes(Fuse const*pTranslatedFuse, bool bDebug)
     auto t0 = std::chrono::high_resolution_clock::now();
     bool bMultihread = true;
 
-    if(bMultihread)
-    {
-        std::vector<std::thread> threads;
-        for (int l=0; l<=m_NXPanels; l++)
-        {
-
-//            futureSync.addFuture(QtConcurrent::run(&Surface::makeSideNodeTask, this, l, pTranslatedFuse, m_xPointA.at(l), m_xPointB.at(l)));
-            threads.push_back(std::thread(&Surface::makeSideNodeTask, this, l, pTranslatedFuse, m_xPointA.at(l), m_xPointB.at(l)));
+    // when the surfaces are themselves processed concurrently, the chunks of this nested loop are queued
+    // to all the workers of the pool, and the calling thread helps with them until they are done
+    ThreadPool::parallelFor(0, m_NXPanels+1, [this, pTranslatedFuse](int l0, int l1)
+                            {
+                                for (int l=l0; l<l1; l++)
+                                    makeSideNodeTask(l, pTranslatedFuse, m_xPointA.at(l), m_xPointB.at(l));
+                            },
+                            bMultihread, 1);
 
-        }
-
-        for (int l=0; l<=m_NXPanels; l++)
-        {
-            threads[l].join();
-        }
-//        std::cout << "makeSideNodes joined all " << m_NXPanels << "threads" <<std::endl;
-    }
-    else
-    {
-        for (int l=0; l<=m_NXPanels; l++)
-        {
-            makeSideNodeTask(l, pTranslatedFuse, m_xPointA.at(l), m_xPointB.at(l));
-        }
-    }
     if(bDebug)
     {
         auto t1 = std::chrono::high_resolution_clock::now();
@@ -1699,10 +1685,35 @@ void Surface::makeTriPanels(std::vector<Panel3> &panel3list, std::vector<Node> &
 }
 
 
-int Surface::makeQuadPanels(std::vector<Panel4> &panel4list, int &nWakeColumn, bool bThickSurfaces, int nTipStrips)
+/**
+ * Returns the number of quad panels which makeQuadPanels() builds on this Surface,
+ * so that the index of the first panel of each surface is known before the panels are made.
+ */
+int Surface::quadPanelCount(bool bThickSurfaces, int nTipStrips) const
+{
+    nTipStrips = std::max(1, nTipStrips);
+    int n4 = m_NXPanels * m_NYPanels;
+    if(bThickSurfaces)
+    {
+        n4 *= 2;
+        if(m_bClosedLeftSide)  n4 += nTipStrips * m_NXPanels;
+        if(m_bClosedRightSide) n4 += nTipStrips * m_NXPanels;
+    }
+    return n4;
+}
+
+
+/**
+ * Appends the quad panels of this Surface to the array.
+ * @param panel4list the array to which the panels are appended
+ * @param n4start the index in the mesh of the first element of the array
+ * @param nWakeColumn the index of the next wake column; incremented for each strip of a thick surface
+ * @return the number of panels made on this Surface
+ */
+int Surface::makeQuadPanels(std::vector<Panel4> &panel4list, int n4start, int &nWakeColumn, bool bThickSurfaces, int nTipStrips)
 {
     int k=0;
-    int n4_0 = int(panel4list.size());
+    int n4_0 = n4start+int(panel4list.size());
 
     int n4 = 0;
     xfl::enumSurfacePosition side = xfl::NOSURFACE;
@@ -1741,10 +1752,10 @@ int Surface::makeQuadPanels(std::vector<Panel4> &panel4list, int &nWakeColumn, b
                 Panel4 &p4T = panel4list.back();
                 p4T.setSurfacePosition(xfl::SIDESURFACE);
                 p4T.setSurfaceIndex(m_Index);
-                p4T.setIndex(int(panel4list.size())-1);
+                p4T.setIndex(n4start+int(panel4list.size())-1);
                 p4T.m_bIsLeftWingPanel  = true;
-                if(l>0)             p4T.m_iPD = int(panel4list.size())-2;
-                if(l<m_NXPanels-1)  p4T.m_iPU = int(panel4list.size());
+                if(l>0)             p4T.m_iPD = n4start+int(panel4list.size())-2;
+                if(l<m_NXPanels-1)  p4T.m_iPU = n4start+int(panel4list.size());
 
                 if(is==0)           p4T.m_iPL = n4_0 + nsp+l;
                 else                p4T.m_iPL = p4T.index() - m_NXPanels;
@@ -1765,7 +1776,7 @@ int Surface::makeQuadPanels(std::vector<Panel4> &panel4list, int &nWakeColumn, b
         }
     }
 
-    int nb0 = int(panel4list.size()); // the index of the first bottom surface panel
+    int nb0 = n4start+int(panel4list.size()); // the index of the first bottom surface panel
 
     for (k=0; k<NYPanels(); k++)
     {
@@ -1922,7 +1933,7 @@ int Surface::makeQuadPanels(std::vector<Panel4> &panel4list, int &nWakeColumn, b
         std::vector<Node> nodes;
         makeTipNodes(nodes, false, nTipStrips);
         int in = 0;
-        int nsp = int(panel4list.size())-1; // the index of the last top surface panel
+        int nsp = n4start+int(panel4list.size())-1; // the index of the last top surface panel
         for(int is=0; is<nTipStrips; is++)
         {
             in = is * nStripNodes;
@@ -1940,11 +1951,11 @@ int Surface::makeQuadPanels(std::vector<Panel4> &panel4list, int &nWakeColumn, b
                 Panel4 &p4T = panel4list.back();
                 p4T.setSurfacePosition(xfl::SIDESURFACE);
                 p4T.setSurfaceIndex(m_Index);
-                p4T.setIndex(int(panel4list.size())-1);
+                p4T.setIndex(n4start+int(panel4list.size())-1);
                 p4T.m_bIsLeftWingPanel  = true;
 
-                if(l>0)            p4T.m_iPD = int(panel4list.size())-2;
-                if(l<m_NXPanels-1) p4T.m_iPU = int(panel4list.size());
+                if(l>0)            p4T.m_iPD = n4start+int(panel4list.size())-2;
+                if(l<m_NXPanels-1) p4T.m_iPU = n4start+int(panel4list.size());
 
                 if(is==0)           p4T.m_iPR = nsp - 2*m_NXPanels + l + 1;
                 else                p4T.m_iPR = p4T.index() - m_NXPanels;
@@ -1971,13 +1982,13 @@ int Surface::makeQuadPanels(std::vector<Panel4> &panel4list, int &nWakeColumn, b
         // connect first strip
         for(int l=0; l<2*m_NXPanels; l++)
         {
-            Panel4 &p4 = panel4list[nb0+l];
+            Panel4 &p4 = panel4list[nb0+l-n4start];
             if(p4.isBotPanel())
             {
                 for(int i4=0; i4<m_NXPanels; i4++)
                 {
                     int index = n4_0+i4;
-                    Panel4 &p4tip = panel4list[index];
+                    Panel4 &p4tip = panel4list[index-n4start];
                     if(p4.LB().isSame(p4tip.LA(), 1.e-4) && p4.TB().isSame(p4tip.TA(), 1.0e-4))
                     {
                         p4.m_iPR = p4tip.index();
@@ -1990,7 +2001,7 @@ int Surface::makeQuadPanels(std::vector<Panel4> &panel4list, int &nWakeColumn, b
                 for(int i4=0; i4<m_NXPanels; i4++)
                 {
                     int index = n4_0+(nTipStrips-1)*m_NXPanels+i4;
-                    Panel4 &p4tip = panel4list[index];
+                    Panel4 &p4tip = panel4list[index-n4start];
                     if(p4.LA().isSame(p4tip.LB(), 1.e-4) && p4.TA().isSame(p4tip.TB(), 1.0e-4))
                     {
                         p4.m_iPL = p4tip.index();
@@ -2007,13 +2018,13 @@ int Surface::makeQuadPanels(std::vector<Panel4> &panel4list, int &nWakeColumn, b
         // connect last strip
         for(int l=0; l<2*m_NXPanels; l++)
         {
-            Panel4 &p4 = panel4list[nb0+l];
+            Panel4 &p4 = panel4list[nb0+l-n4start];
             if(p4.isBotPanel())
             {
                 for(int i4=0; i4<m_NXPanels; i4++)
                 {
                     int index = ntip0+i4;
-                    Panel4 &p4tip = panel4list[index];
+                    Panel4 &p4tip = panel4list[index-n4start];
                     if(p4.LA().isSame(p4tip.LB(), 1.e-4) && p4.TA().isSame(p4tip.TB(), 1.0e-4))
                     {
                         p4.m_iPL = p4tip.index();
@@ -2026,7 +2037,7 @@ int Surface::makeQuadPanels(std::vector<Panel4> &panel4list, int &nWakeColumn, b
                 for(int i4=0; i4<m_NXPanels; i4++)
                 {
                     int index = ntip0+(nTipStrips-1)*m_NXPanels+i4;
-                    Panel4 &p4tip = panel4list[index];
+                    Panel4 &p4tip = panel4list[index-n4start];
                     if(p4.LB().isSame(p4tip.LA(), 1.e-4) && p4.TB().isSame(p4tip.TA(), 1.0e-4))
                     {
                         p4.m_iPR = p4tip.index();
@@ -2267,13 +2278,23 @@ bool Surface::hasPanel4(int idx4) const
 
 void Surface::addPanel3Index(int idx)
 {
-    if(!hasPanel3(idx)) m_Panel3List.push_back(idx);
+    // the mesh builders add the indexes in increasing order, so that an index larger than the last one is new
+    if(m_Panel3List.empty() || idx>m_Panel3List.back() || !hasPanel3(idx)) m_Panel3List.push_back(idx);
 }
 
 
 void Surface::addPanel4Index(int idx)
 {
-    if(!hasPanel4(idx)) m_Panel4List.push_back(idx);
+    // the mesh builders add the indexes in increasing order, so that an index larger than the last one is new
+    if(m_Panel4List.empty() || idx>m_Panel4List.back() || !hasPanel4(idx)) m_Panel4List.push_back(idx);
+}
+
+
+/** Shifts the indexes of the triangular panels and flap panels of this Surface */
+void Surface::offsetPanel3Indexes(int offset)
+{
+    for(int &idx : m_Panel3List) idx += offset;
+    for(int &idx : m_FlapPanel3) idx += offset;
 }
 
 
@@ -2291,7 +2312,8 @@ bool Surface::hasFlapPanel3(Panel3 const &p3) const
 
 void Surface::addFlapPanel3Index(int idx)
 {
-    if(!hasFlapPanel3(idx)) m_FlapPanel3.push_back(idx);
+    // the mesh builders add the indexes in increasing order, so that an index larger than the last one is new
+    if(m_FlapPanel3.empty() || idx>m_FlapPanel3.back() || !hasFlapPanel3(idx)) m_FlapPanel3.push_back(idx);
 }
 
 
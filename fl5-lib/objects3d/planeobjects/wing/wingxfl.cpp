@@ -195,6 +195,8 @@ int WingXfl::makeTriPanels(int ip3start, int indStart, bool bThickSurfaces)
     m_StripStartNodes.clear();
 
     m_TriMesh.clearMesh();
+    // two triangles at most per quad; avoids the reallocations of the large panel objects
+    m_TriMesh.panels().reserve(2*quadTotal(!bThickSurfaces));
 
     setFirstPanel3Index(ip3start);
     setFirstNodeIndex(indStart);
@@ -216,12 +218,37 @@ int WingXfl::makeTriPanels(int ip3start, int indStart, bool bThickSurfaces)
     }
 
     m_nPanel3 = nWingPanels;
-    m_nNodes = m_TriMesh.nNodes()-m_FirstNodeIndex;
+    m_nNodes = m_TriMesh.nNodes();
 
     return nWingPanels;
 }
 
 
+/**
+ * Sets the position of the wing's mesh in the plane's mesh, after it has been built with makeTriPanels(0, 0, ...).
+ * The panel indexes are shifted by ip3start; the node indexes of the wing's mesh remain local,
+ * and are shifted when the mesh is appended to the plane's mesh.
+ */
+void WingXfl::offsetTriPanels(int ip3start, int indStart)
+{
+    setFirstPanel3Index(ip3start);
+    setFirstNodeIndex(indStart);
+
+    if(ip3start==0) return;
+
+    for(Panel3 &p3 : m_TriMesh.panels())
+    {
+        p3.setIndex(p3.index()+ip3start);
+        // the opposite index is only set for the trailing panels of thick surfaces
+        if(p3.isTrailing() && (p3.isBotPanel() || p3.isTopPanel()))
+            p3.setOppositeIndex(p3.oppositeIndex()+ip3start);
+    }
+
+    for(int jSurf=0; jSurf<nSurfaces(); jSurf++)
+        m_Surface[jSurf].offsetPanel3Indexes(ip3start);
+}
+
+
 #define NXSTATIONS 20
 #define NYSTATIONS 40
 
@@ -1232,7 +1259,7 @@ double WingXfl::ZPosition(double y) const
  * Assumes the array of force vectors has been calculated previously
  * @param bThinSurface true if the calculation has been performed on thin VLM surfaces, false in the case of a 3D-panelanalysis
  */
-void WingXfl::panelComputeBending(std::vector<Panel4> const &panel4list, bool bThinSurface, SpanDistribs &SpanResFF)
+void WingXfl::panelComputeBending(std::vector<Panel4> const &panel4list, bool bThinSurface, SpanDistribs &SpanResFF) const
 {
     std::vector<double> ypos, zpos;
     Vector3d Dist(0.0,0.0,0.0);
@@ -1303,7 +1330,7 @@ void WingXfl::panelComputeBending(std::vector<Panel4> const &panel4list, bool bT
  * Assumes the array of force vectors has been calculated previously
  * @param bThinSurface true if the calculation has been performed on thin surfaces
  */
-void WingXfl::panelComputeBending(const std::vector<Panel3> &panel3list, bool bThinSurface, SpanDistribs &SpanResFF)
+void WingXfl::panelComputeBending(const std::vector<Panel3> &panel3list, bool bThinSurface, SpanDistribs &SpanResFF) const
 {
     std::vector<double> ypos, zpos;
     Vector3d Dist(0.0,0.0,0.0);
@@ -1616,7 +1643,7 @@ void WingXfl::panel3ComputeInviscidForces(const std::vector<Panel3> &panel3list,
 
 void WingXfl::panel4ComputeStrips(std::vector<Panel4> const &panel4list, PlanePolar const *pWPolar, Vector3d const &CoG,
                                   double alpha, double beta, double QInf, double const *Cp4, double const *Gamma,
-                                  SpanDistribs &SpanResSum)
+                                  SpanDistribs &SpanResSum, std::vector<double> &FlapMoment) const
 {
     int p(0), iStrip(0), nFlap(0), coef(1);
     double CPStrip(0.0), NForce(0.0);
@@ -1642,13 +1669,13 @@ void WingXfl::panel4ComputeStrips(std::vector<Panel4> const &panel4list, PlanePo
     }
 
     iStrip = p = nFlap = 0;
-    m_FlapMoment.clear();
+    FlapMoment.clear();
 
     // Calculate the coefficients on each strip
     for (int j=0; j<nSurfaces(); j++)
     {
         Surface const &surf = m_Surface.at(j);
-        if(surf.hasTEFlap()) m_FlapMoment.push_back(0.0);
+        if(surf.hasTEFlap()) FlapMoment.push_back(0.0);
         SurfaceNormal = surf.normal();
 
         // skip the tip patch
@@ -1717,7 +1744,7 @@ void WingXfl::panel4ComputeStrips(std::vector<Panel4> const &panel4list, PlanePo
                         //then p is on the flap, so add its contribution
                         HingeLeverArm = ForcePt - surf.hingePoint();
                         HingeMoment = HingeLeverArm * PanelForce;                   // N.m/q
-                        m_FlapMoment[nFlap] += HingeMoment.dot(surf.m_HingeVector)* pWPolar->density() * QInf * QInf/2.0;  //N.m
+                        FlapMoment[nFlap] += HingeMoment.dot(surf.m_HingeVector)* pWPolar->density() * QInf * QInf/2.0;  //N.m
                     }
                 }
                 p++;
@@ -1752,7 +1779,7 @@ void WingXfl::panel4ComputeStrips(std::vector<Panel4> const &panel4list, PlanePo
 
 void WingXfl::panel3ComputeStrips(std::vector<Panel3> const &panel3list, PlanePolar const*pWPolar, Vector3d const &CoG,
                                   double alpha, double beta, double QInf, double const*Cp3Vtx,
-                                  SpanDistribs &SpanResSum)
+                                  SpanDistribs &SpanResSum, std::vector<double> &FlapMoment) const
 {
     int nFlap(0), idx(0);
     double CPStrip(0.0), NForce(0.0);
@@ -1775,7 +1802,7 @@ void WingXfl::panel3ComputeStrips(std::vector<Panel3> const &panel3list, PlanePo
 
     int iStrip = 0;
 
-    m_FlapMoment.clear();
+    FlapMoment.clear();
 
     // calculate the coefficients on each strip
     // Tip patches are ignored
@@ -1784,7 +1811,7 @@ void WingXfl::panel3ComputeStrips(std::vector<Panel3> const &panel3list, PlanePo
     {
         Surface const &surf = m_Surface.at(isurf);
         surfaceNormal = surf.normal();
-        if(surf.hasTEFlap()) m_FlapMoment.push_back(0.0);
+        if(surf.hasTEFlap()) FlapMoment.push_back(0.0);
         int ksurf = 0;
 
         int i3=0;
@@ -1837,7 +1864,7 @@ void WingXfl::panel3ComputeStrips(std::vector<Panel3> const &panel3list, PlanePo
                             //then p is on the flap, so add its contribution
                             HingeLeverArm = ForcePt - surf.hingePoint();
                             hingemoment = HingeLeverArm * PanelForce;                   //N.m/q
-                            m_FlapMoment[nFlap] += hingemoment.dot(surf.hingeVector())* pWPolar->density() * QInf * QInf/2.0;  //N.m
+                            FlapMoment[nFlap] += hingemoment.dot(surf.hingeVector())* pWPolar->density() * QInf * QInf/2.0;  //N.m
                         }
                     }
                     i3++;
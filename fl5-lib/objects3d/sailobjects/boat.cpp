@@ -809,10 +809,17 @@ std::string Boat::properties(bool bFull) const
 
 
 void Boat::rotateMesh(BoatPolar const*pBtPolar, double phi, double Ry, double ctrl, std::vector<Panel3> &panels) const
+{
+    rotateSails(pBtPolar, ctrl, panels);
+    rotateBody(pBtPolar, phi, Ry, panels);
+}
+
+
+/** Rotates the sails around their leading edges */
+void Boat::rotateSails(BoatPolar const*pBtPolar, double ctrl, std::vector<Panel3> &panels) const
 {
     if(!pBtPolar) return;
 
-    //rotate the sails around their leading edges
     for(int is=0; is<nSails(); is++)
     {
         Sail const*pSail = sailAt(is);
@@ -831,6 +838,13 @@ void Boat::rotateMesh(BoatPolar const*pBtPolar, double phi, double Ry, double ct
             }
         }
     }
+}
+
+
+/** Rotates the whole mesh by the angle around the Y axis and by the bank angle */
+void Boat::rotateBody(BoatPolar const*pBtPolar, double phi, double Ry, std::vector<Panel3> &panels) const
+{
+    if(!pBtPolar) return;
 
     //apply the rotation angle around the Y axis
     if(pBtPolar->isTriangleMethod())
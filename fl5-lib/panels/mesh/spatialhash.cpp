@@ -0,0 +1,105 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#include <algorithm>
+#include <cmath>
+
+#include <spatialhash.h>
+
+
+SpatialHash::SpatialHash(double cellsize)
+{
+    // a null cell size would make each point a cell of its own; only the exact matches would be found
+    m_CellSize = std::max(cellsize, 1.e-12);
+}
+
+
+SpatialHash::CellKey SpatialHash::cellKey(Vector3d const &pt) const
+{
+    CellKey key;
+    key.i = int64_t(std::floor(pt.x/m_CellSize));
+    key.j = int64_t(std::floor(pt.y/m_CellSize));
+    key.k = int64_t(std::floor(pt.z/m_CellSize));
+    return key;
+}
+
+
+void SpatialHash::insert(Vector3d const &pt, int id)
+{
+    m_Cell[cellKey(pt)].push_back(id);
+}
+
+
+void SpatialHash::remove(Vector3d const &pt, int id)
+{
+    auto it = m_Cell.find(cellKey(pt));
+    if(it==m_Cell.end()) return;
+
+    std::vector<int> &cell = it->second;
+    auto pos = std::find(cell.begin(), cell.end(), id);
+    if(pos!=cell.end()) cell.erase(pos);
+    if(cell.empty()) m_Cell.erase(it);
+}
+
+
+/**
+ * Fills the array with the ids stored in the cell containing the point and in the 26 surrounding cells.
+ * If bSorted is true, the ids are returned in increasing order without duplicates,
+ * so that the caller can process them in the same order as a linear scan.
+ */
+void SpatialHash::candidates(Vector3d const &pt, std::vector<int> &ids, bool bSorted) const
+{
+    ids.clear();
+    appendCandidates(pt, ids);
+    if(bSorted) sortIds(ids);
+}
+
+
+/** Appends the ids stored in the 27 cells surrounding the point, without sorting */
+void SpatialHash::appendCandidates(Vector3d const &pt, std::vector<int> &ids) const
+{
+    CellKey const key0 = cellKey(pt);
+    CellKey key;
+    for(int di=-1; di<=1; di++)
+    {
+        key.i = key0.i + di;
+        for(int dj=-1; dj<=1; dj++)
+        {
+            key.j = key0.j + dj;
+            for(int dk=-1; dk<=1; dk++)
+            {
+                key.k = key0.k + dk;
+                auto it = m_Cell.find(key);
+                if(it!=m_Cell.end()) ids.insert(ids.end(), it->second.begin(), it->second.end());
+            }
+        }
+    }
+}
+
+
+void SpatialHash::sortIds(std::vector<int> &ids)
+{
+    std::sort(ids.begin(), ids.end());
+    ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+}
@@ -0,0 +1,284 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois 
+    
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+
+
+#include <QString>
+
+#include <testtrimesh.h>
+#include <node.h>
+#include <panel3.h>
+
+
+/** The original node merging of TriMesh::makeNodeArrayFromPanels(), using XflMesh::isNode() */
+int makeNodeArrayFromPanelsRef(TriMesh &mesh, int firstnodeindex)
+{
+    mesh.clearNodes();
+    mesh.nodes().reserve(mesh.nPanels()*2);
+    for(int i3=0; i3<mesh.nPanels(); i3++)
+    {
+        Panel3 &p3 = mesh.panel(i3);
+
+        for(int iv=0; iv<3; iv++)
+        {
+            int iNode = mesh.isNode(p3.vertexAt(iv), XflMesh::nodeMergeDistance());
+
+            if(iNode>=0)
+            {
+                // if trailing edge node, do not merge with node of opposite surface
+                if(p3.isTrailingEdgeNode(iv) && p3.surfacePosition()!=mesh.nodeAt(iNode).surfacePosition())
+                {
+                    // continue with a new node instead
+                    iNode = -1;
+                }
+            }
+
+            if(iNode<0)
+            {
+                iNode = mesh.nodeCount();
+                mesh.addNode(p3.vertexAt(iv));
+                mesh.lastNode().setIndex(firstnodeindex + mesh.nodeCount()-1);
+                mesh.lastNode().setSurfacePosition(p3.surfacePosition());
+                p3.setVertex(iv, mesh.node(iNode));
+            }
+            else
+            {
+                p3.setVertex(iv, mesh.node(iNode));
+                p3.setFrame();
+            }
+            mesh.node(iNode).addTriangleIndex(i3);
+        }
+    }
+    return mesh.nodeCount();
+}
+
+
+/** The original connections of TriMesh::makeConnectionsFromNodePosition(), searching from the panel's index in both directions */
+void makeConnectionsFromNodePositionRef(TriMesh &mesh, bool bConnectTE)
+{
+    double const MAXDISTANCE = 1.e-4;
+
+    mesh.clearConnections();
+
+    for(int it0=0; it0<mesh.nPanels(); it0++)
+    {
+        Panel3 &p3 = mesh.panel(it0);
+
+        int it2m = it0;
+        int it2p = it0;
+
+        do
+        {
+            it2m--;
+            it2p++;
+            for(int it2 : {it2p, it2m})
+            {
+                if(it2<0 || it2>=mesh.nPanels()) continue;
+                Panel3 const & p2 = mesh.panelAt(it2);
+
+                // do not connect opposite trailing edge panels
+                if(p3.isTrailing() && !bConnectTE && p2.isOppositeSurface(p3.surfacePosition())) continue;
+
+                for(int ie=0; ie<3; ie++)
+                {
+                    int nEdge = p3.edgeIndex(p2.edge(ie), MAXDISTANCE);
+                    if(nEdge>=0)
+                    {
+                        p3.setNeighbour(it2, nEdge);
+                        break;
+                    }
+                }
+            }
+        }
+        while(p3.neighbourCount()<3 && (it2p<mesh.nPanels() || it2m>=0));
+    }
+}
+
+
+/** The original connections of TriMesh::makeConnectionsFromNodePosition2(), scanning all the panels of the range */
+void makeConnectionsFromNodePosition2Ref(TriMesh &mesh, int i0, int np0, double MERGEDISTANCE)
+{
+    if(i0+np0>mesh.nPanels()) return;
+
+    for(int it0=i0; it0<i0+np0; it0++)
+    {
+        Panel3 &p0 = mesh.panel(it0);
+        if(p0.neighbourCount()==3) continue;  // no further connections for this panel
+
+        for(int it1=i0; it1<i0+np0; it1++)
+        {
+            if(it0==it1) continue; // do not connect the panel to itself
+            Panel3 &p1 = mesh.panel(it1);
+
+            if(p1.neighbourCount()==3) continue;  // no further connections for this panel
+
+            if(p0.isFlapPanel() || p1.isFlapPanel())
+            {
+                if(p0.surfaceIndex() != p1.surfaceIndex()) continue; // avoid connecting flap side panels
+            }
+
+            if(p0.isTrailing() && p1.surfacePosition()!=p0.surfacePosition()) continue;
+
+            for(int ie=0; ie<3; ie++)
+            {
+                int nEdge0 = p0.edgeIndex(p1.edge(ie), MERGEDISTANCE);
+                if(nEdge0>=0)
+                {
+                    p0.setNeighbour(it1, nEdge0);
+                    int nEdge1 = p1.edgeIndex(p0.edge(nEdge0), MERGEDISTANCE);
+                    if(nEdge1>=0) p1.setNeighbour(it0, nEdge1);
+                    break;
+                }
+            }
+            if(p0.neighbourCount()==3) break;
+        }
+    }
+}
+
+
+/** The original TriMesh::connectNodes(), scanning all the panels for each node */
+void connectNodesRef(TriMesh &mesh)
+{
+    for(int in=0; in<mesh.nNodes(); in++)
+    {
+        Node& nd = mesh.node(in);
+        nd.clearNeighbourNodes();
+        for(int i3=0; i3<mesh.nPanels(); i3++)
+        {
+            Panel3 const &p3 = mesh.panelAt(i3);
+            if(p3.hasVertex(in))
+            {
+                if(p3.isTrailingEdgeNode(in))
+                {
+                    // connect only if triangle is on same side as node
+                    if(p3.surfacePosition()!=nd.surfacePosition())  continue;
+                }
+                nd.addTriangleIndex(p3.index());
+                nd.addNeighbourIndex(p3.nodeIndex(0));
+                nd.addNeighbourIndex(p3.nodeIndex(1));
+                nd.addNeighbourIndex(p3.nodeIndex(2));
+            }
+        }
+        if(nd.neighbourNodeCount()==0) nd.setSurfacePosition(xfl::NOSURFACE);
+    }
+}
+
+
+/** Compares the nodes, the vertex indexes and the connections of two meshes; logs the first difference */
+bool isSameTriMesh(TriMesh const &mesh0, TriMesh const &mesh1, std::string &log)
+{
+    if(mesh0.nNodes()!=mesh1.nNodes())
+    {
+        log += QString::asprintf("node count %d/%d\n", mesh0.nNodes(), mesh1.nNodes()).toStdString();
+        return false;
+    }
+    if(mesh0.nPanels()!=mesh1.nPanels())
+    {
+        log += QString::asprintf("panel count %d/%d\n", mesh0.nPanels(), mesh1.nPanels()).toStdString();
+        return false;
+    }
+
+    for(int in=0; in<mesh0.nNodes(); in++)
+    {
+        Node const &nd0 = mesh0.nodeAt(in);
+        Node const &nd1 = mesh1.nodeAt(in);
+        if(nd0.x!=nd1.x || nd0.y!=nd1.y || nd0.z!=nd1.z || nd0.index()!=nd1.index() || nd0.surfacePosition()!=nd1.surfacePosition())
+        {
+            log += QString::asprintf("node %d differs\n", in).toStdString();
+            return false;
+        }
+        if(nd0.nodeNeighbourIndexes()!=nd1.nodeNeighbourIndexes() || nd0.triangleIndexes()!=nd1.triangleIndexes())
+        {
+            log += QString::asprintf("neighbours of node %d differ\n", in).toStdString();
+            return false;
+        }
+    }
+
+    for(int i3=0; i3<mesh0.nPanels(); i3++)
+    {
+        Panel3 const &p0 = mesh0.panelAt(i3);
+        Panel3 const &p1 = mesh1.panelAt(i3);
+        for(int iv=0; iv<3; iv++)
+        {
+            if(p0.nodeIndex(iv)!=p1.nodeIndex(iv) || p0.neighbour(iv)!=p1.neighbour(iv))
+            {
+                log += QString::asprintf("panel %d differs\n", i3).toStdString();
+                return false;
+            }
+        }
+    }
+    return true;
+}
+
+
+/**
+ * Builds the node array and the connections of copies of the mesh with the TriMesh methods
+ * and with the reference implementations, and checks that the results are identical.
+ */
+bool testTriMeshConnections(TriMesh const &mesh, std::string &log)
+{
+    TriMesh mesh0(mesh), mesh1(mesh);
+    std::string strange;
+
+    mesh0.makeNodeArrayFromPanels(0, strange, "");
+    makeNodeArrayFromPanelsRef(mesh1, 0);
+    if(!isSameTriMesh(mesh0, mesh1, log))
+    {
+        log += "   node arrays differ\n";
+        return false;
+    }
+
+    for(bool bConnectTE : {false, true})
+    {
+        makeConnectionsFromNodePositionRef(mesh1, bConnectTE);
+        connectNodesRef(mesh1);
+        for(bool bMultiThread : {false, true})
+        {
+            mesh0.makeConnectionsFromNodePosition(bConnectTE, bMultiThread);
+            mesh0.connectNodes();
+            if(!isSameTriMesh(mesh0, mesh1, log))
+            {
+                log += QString::asprintf("   connections from node positions differ, TE connected=%d, multithreaded=%d\n", bConnectTE, bMultiThread).toStdString();
+                return false;
+            }
+        }
+    }
+
+    for(double mergedistance : {1.0e-4, XflMesh::nodeMergeDistance()})
+    {
+        mesh0.clearConnections();
+        mesh1.clearConnections();
+        mesh0.makeConnectionsFromNodePosition2(0, mesh0.nPanels(), mergedistance);
+        makeConnectionsFromNodePosition2Ref(mesh1, 0, mesh1.nPanels(), mergedistance);
+        mesh0.connectNodes();
+        connectNodesRef(mesh1);
+        if(!isSameTriMesh(mesh0, mesh1, log))
+        {
+            log += QString::asprintf("   connections from node positions with merge distance %g differ\n", mergedistance).toStdString();
+            return false;
+        }
+    }
+
+    return true;
+}
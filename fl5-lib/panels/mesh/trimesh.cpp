@@ -29,6 +29,8 @@
 #include <thread>
 
 
+#include <spatialhash.h>
+#include <threadpool.h>
 #include <trimesh.h>
 
 #include <units.h>
@@ -113,13 +115,24 @@ int TriMesh::makeNodeArrayFromPanels(int firstnodeindex, std::string &logmsg, st
 {
     clearNodes();
     m_Node.reserve(nPanels()*2);
+
+    // same result as XflMesh::isNode(), i.e. the last added node within the merge distance,
+    // but the search is restricted to the nodes in the neighbouring cells
+    SpatialHash nodehash(s_NodeMergeDistance);
+    std::vector<int> candidates;
+
     for(int i3=0; i3<nPanels(); i3++)
     {
         Panel3 &p3 = m_Panel3[i3];
 
         for(int iv=0; iv<3; iv++)
         {
-            int iNode = isNode(p3.vertexAt(iv), s_NodeMergeDistance);
+            int iNode = -1;
+            nodehash.candidates(p3.vertexAt(iv), candidates, false);
+            for(int idx : candidates)
+            {
+                if(idx>iNode && m_Node.at(idx).isSame(p3.vertexAt(iv), s_NodeMergeDistance)) iNode = idx;
+            }
 
             if(iNode>=0)
             {
@@ -135,6 +148,7 @@ int TriMesh::makeNodeArrayFromPanels(int firstnodeindex, std::string &logmsg, st
             {
                 iNode = nodeCount();
                 addNode(p3.vertexAt(iv));
+                nodehash.insert(lastNode(), iNode);
                 lastNode().setIndex(firstnodeindex + nodeCount()-1);
                 lastNode().setSurfacePosition(p3.surfacePosition());
                 p3.setVertex(iv, node(iNode));
@@ -442,6 +456,27 @@ void TriMesh::clearConnections()
 }
 
 
+/**
+ * Returns true if the mesh has the same panels and nodes as the input mesh, with the same node indexes,
+ * in which case the connections of one mesh are valid for the other.
+ * The positions of the nodes are not compared.
+ */
+bool TriMesh::hasSameTopology(TriMesh const &mesh3) const
+{
+    if(mesh3.panelCount()!=panelCount() || mesh3.nNodes()!=nNodes()) return false;
+    for(int i3=0; i3<panelCount(); i3++)
+    {
+        Panel3 const &p3 = m_Panel3.at(i3);
+        Panel3 const &refp3 = mesh3.panelAt(i3);
+        for(int iv=0; iv<3; iv++)
+        {
+            if(p3.nodeIndex(iv)!=refp3.nodeIndex(iv)) return false;
+        }
+    }
+    return true;
+}
+
+
 /** Duplicates the connections, typically from the ref trimesh to the active trimesh;
  * Faster than recalculating;
  * For display information only */
@@ -511,14 +546,20 @@ void TriMesh::makeConnectionsFromNodePosition2(int i0, int np0, double MERGEDIST
         return;
     }
 
+    SpatialHash panelhash(MERGEDISTANCE);
+    makePanelHash(i0, np0, panelhash);
+    std::vector<int> candidates;
+
     for(int it0=i0; it0<i0+np0; it0++)
     {
         Panel3 &p0 = panel(it0);
-        // search starting from the base panel's index
-        // since neighbours are likely to have a close index
         if(p0.neighbourCount()==3) continue;  // no further connections for this panel
 
-        for(int it1=i0; it1<i0+np0; it1++)
+        // only the panels with a vertex close to one of p0's vertices can share an edge with it;
+        // visit them in increasing index order, as in a full scan
+        adjacentPanelCandidates(panelhash, p0, candidates);
+
+        for(int it1 : candidates)
         {
             if(it0==it1) continue; // do not connect the panel to itself
             Panel3 &p1 = panel(it1);
@@ -582,7 +623,7 @@ void TriMesh::makeConnectionsFromNodePosition2(int i0, int np0, double MERGEDIST
 /**
  * Makes the connections between the triangles which share a common edge.
  * Untested in multithread mode.
- * Slow.
+ * The search for the adjacent triangles is restricted to those found in the panel hash grid.
  */
 void TriMesh::makeConnectionsFromNodePosition(bool bConnectTE, bool bMultiThread)
 {
@@ -601,12 +642,15 @@ void TriMesh::makeConnectionsFromNodePosition(bool bConnectTE, bool bMultiThread
     // If the panel is trailing, do not connect to the opposite surface to prevent incorrect Cp calculations
     clearConnections();
 
+    SpatialHash panelhash(1.e-4);
+    makePanelHash(0, nPanels(), panelhash);
+
     if(bMultiThread)
     {
         std::vector<std::thread> threads;
         for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
         {
-            threads.push_back(std::thread(&TriMesh::connectPanelBlock, this, iBlock, bConnectTE));
+            threads.push_back(std::thread(&TriMesh::connectPanelBlock, this, iBlock, bConnectTE, std::cref(panelhash)));
         }
 
         for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
@@ -620,7 +664,7 @@ void TriMesh::makeConnectionsFromNodePosition(bool bConnectTE, bool bMultiThread
     {
         for(int iBlock=0; iBlock<m_nBlocks; iBlock++)
         {
-            connectPanelBlock(iBlock, bConnectTE);
+            connectPanelBlock(iBlock, bConnectTE, panelhash);
         }
     }
 
@@ -628,7 +672,7 @@ void TriMesh::makeConnectionsFromNodePosition(bool bConnectTE, bool bMultiThread
 }
 
 
-void TriMesh::connectPanelBlock(int iBlock, bool bConnectTE)
+void TriMesh::connectPanelBlock(int iBlock, bool bConnectTE, SpatialHash const &panelhash)
 {
     double const MAXDISTANCE = 1.e-4;
     int blockSize = int(double(nPanels())/double(m_nBlocks)) +1;
@@ -636,94 +680,92 @@ void TriMesh::connectPanelBlock(int iBlock, bool bConnectTE)
     int maxRows = nPanels();
     int iMax = std::min(iStart+blockSize, maxRows);
 
+    std::vector<int> candidates;
+
     // set panel neighbours
     for(int it0=iStart; it0<iMax; it0++)
     {
         Panel3 &p3 = m_Panel3[it0];
-        // search starting from the base panel's index
-        // since neighbour indexes are likely to be close
-
-        int it2m = it0;
-        int it2p = it0;
 
-        do
+        // visit the panels which have a vertex close to one of p3's vertices
+        // in the order of a search window growing around the base panel's index,
+        // i.e. it0+1, it0-1, it0+2, it0-2...
+        adjacentPanelCandidates(panelhash, p3, candidates);
+        std::sort(candidates.begin(), candidates.end(), [it0](int a, int b)
         {
-            it2m--;
-            it2p++;
-//            if(p3.neighbourCount()==3) break;
-            if(it2p<nPanels())
-            {
-                Panel3 const & p2 = m_Panel3.at(it2p);
+            int da = std::abs(a-it0);
+            int db = std::abs(b-it0);
+            if(da!=db) return da<db;
+            return a>b;
+        });
+
+        int level = 0;
+        for(int it2 : candidates)
+        {
+            if(it2==it0) continue;
 
-                if(p3.isTrailing() && !bConnectTE)
-                {
-                    if(!p2.isOppositeSurface(p3.surfacePosition())) // do not connect opposite Trailing edge panels
-                    {
-                        for(int iEdge=0; iEdge<3; iEdge++)
-                        {
-                            int nEdge = p3.edgeIndex(p2.edge(iEdge), MAXDISTANCE);
-                            if(nEdge>=0)
-                            {
-                                p3.setNeighbour(it2p, nEdge);
-                                break;
-                            }
-                        }
-                    }
-                }
-                else
-                {
-                    for(int ie=0; ie<3; ie++)
-                    {
-                        int nEdge = p3.edgeIndex(p2.edge(ie), MAXDISTANCE);
-                        if(nEdge>=0)
-                        {
-                            p3.setNeighbour(it2p, nEdge);
-                            break;
-                        }
-                    }
-                }
+            // the window stops growing once the panel has all its neighbours
+            int d = std::abs(it2-it0);
+            if(d!=level)
+            {
+                if(level>0 && p3.neighbourCount()==3) break;
+                level = d;
             }
 
-            if(it2m>=0)
-            {
-                Panel3 const & p2 = m_Panel3.at(it2m);
+            Panel3 const & p2 = m_Panel3.at(it2);
 
-                if(p3.isTrailing() && !bConnectTE)
-                {
-                    if(!p2.isOppositeSurface(p3.surfacePosition())) // do not connect opposite Trailing edge panels
-                    {
-                        for(int iEdge=0; iEdge<3; iEdge++)
-                        {
-                            int nEdge = p3.edgeIndex(p2.edge(iEdge), MAXDISTANCE);
-                            if(nEdge>=0)
-                            {
-                                p3.setNeighbour(it2m, nEdge);
-                                break;
-                            }
-                        }
-                    }
-                }
-                else
+            // do not connect opposite Trailing edge panels
+            if(p3.isTrailing() && !bConnectTE && p2.isOppositeSurface(p3.surfacePosition())) continue;
+
+            for(int ie=0; ie<3; ie++)
+            {
+                int nEdge = p3.edgeIndex(p2.edge(ie), MAXDISTANCE);
+                if(nEdge>=0)
                 {
-                    for(int ie=0; ie<3; ie++)
-                    {
-                        int nEdge = p3.edgeIndex(p2.edge(ie), MAXDISTANCE);
-                        if(nEdge>=0)
-                        {
-                            p3.setNeighbour(it2m, nEdge);
-                            break;
-                        }
-                    }
+                    p3.setNeighbour(it2, nEdge);
+                    break;
                 }
             }
         }
-        while(p3.neighbourCount()<3 && (it2p<nPanels() || it2m>=0));
 
         if(s_bCancel) break;
     }
 }
 
 
+/** Indexes the panels i0 to i0+n3-1 by the positions of their edge vertices */
+void TriMesh::makePanelHash(int i0, int n3, SpatialHash &panelhash) const
+{
+    panelhash.clear();
+    for(int i3=i0; i3<i0+n3; i3++)
+    {
+        Panel3 const &p3 = m_Panel3.at(i3);
+        for(int ie=0; ie<3; ie++)
+        {
+            panelhash.insert(p3.edge(ie).vertexAt(0), i3);
+            panelhash.insert(p3.edge(ie).vertexAt(1), i3);
+        }
+    }
+}
+
+
+/**
+ * Fills the array with the sorted indexes of the hashed panels which have an edge vertex
+ * close to one of the edge vertices of p3. This is a superset of the panels which share an edge with p3.
+ * The array includes the index of p3 if it is hashed.
+ */
+void TriMesh::adjacentPanelCandidates(SpatialHash const &panelhash, Panel3 const &p3, std::vector<int> &candidates) const
+{
+    candidates.clear();
+    for(int ie=0; ie<3; ie++)
+    {
+        panelhash.appendCandidates(p3.edge(ie).vertexAt(0), candidates);
+        panelhash.appendCandidates(p3.edge(ie).vertexAt(1), candidates);
+    }
+    SpatialHash::sortIds(candidates);
+}
+
+
 /** connects the panels if they share two vertices with the same indexes */
 void TriMesh::makeConnectionsFromNodeIndexes(int i0, int n0, int i1, int n1)
 {
@@ -822,34 +864,46 @@ void TriMesh::makeConnectionsFromNodeIndexes(int i0, int n0, int i1, int n1)
 
 void TriMesh::connectNodes()
 {
-    for(int in=0; in<nNodes(); in++)
+    // list the panels of each node once rather than scanning all the panels for each node
+    std::vector<std::vector<int>> nodepanels;
+    makeNodePanelList(m_Panel3, nNodes(), nodepanels);
+
+    // each node is connected independently, in increasing panel order
+    ThreadPool::parallelFor(0, nNodes(), [this, &nodepanels](int in0, int in1)
+                            {
+                                for(int in=in0; in<in1; in++) connectNode(in, nodepanels.at(in));
+                            });
+}
+
+
+/** Makes the lists of neighbour nodes and triangles of node in from the list of the panels which have this node as a vertex */
+void TriMesh::connectNode(int in, std::vector<int> const &nodepanels)
+{
+    Node& nd = m_Node[in];
+    nd.clearNeighbourNodes();
+    for(uint k=0; k<nodepanels.size(); k++)
     {
-        Node& nd = m_Node[in];
-        nd.clearNeighbourNodes();
-        for(int i3=0; i3<nPanels(); i3++)
-        {
-            Panel3 const &p3 = panel(i3);
-            if(p3.hasVertex(in))
-            {
-                if(p3.isTrailingEdgeNode(in))
-                {
-                    // connect only if triangle is on same side as node
-                    if(p3.surfacePosition()!=nd.surfacePosition())  continue;
-                }
-                // add all the panel's vertices as neighbours.
-                nd.addTriangleIndex(p3.index());
-                nd.addNeighbourIndex(p3.nodeIndex(0));
-                nd.addNeighbourIndex(p3.nodeIndex(1));
-                nd.addNeighbourIndex(p3.nodeIndex(2));
-            }
-        }
-        if(nd.neighbourNodeCount()==0)
+        int i3 = nodepanels.at(k);
+        if(k>0 && nodepanels.at(k-1)==i3) continue; // degenerate panel with a repeated vertex
+
+        Panel3 const &p3 = panel(i3);
+        if(p3.isTrailingEdgeNode(in))
         {
-            // hanging node
-            // leave in the array so as to not mess up the indexes
-            // but set as NOSURFACE so that it is discarded in the analysis and the display
-            nd.setSurfacePosition(xfl::NOSURFACE);
+            // connect only if triangle is on same side as node
+            if(p3.surfacePosition()!=nd.surfacePosition())  continue;
         }
+        // add all the panel's vertices as neighbours.
+        nd.addTriangleIndex(p3.index());
+        nd.addNeighbourIndex(p3.nodeIndex(0));
+        nd.addNeighbourIndex(p3.nodeIndex(1));
+        nd.addNeighbourIndex(p3.nodeIndex(2));
+    }
+    if(nd.neighbourNodeCount()==0)
+    {
+        // hanging node
+        // leave in the array so as to not mess up the indexes
+        // but set as NOSURFACE so that it is discarded in the analysis and the display
+        nd.setSurfacePosition(xfl::NOSURFACE);
     }
 }
 
@@ -896,63 +950,64 @@ int TriMesh::cleanDoubleNodes(std::vector<Panel3> &panel3, std::vector<Node> &no
 
     std::vector<int> doublenodes;
     std::vector<int> modpanels;
-    for(uint in0=0; in0<nodes.size(); in0++)
+
+    // the search for duplicates is restricted to the nodes in the neighbouring cells,
+    // and the panels are found from their node indexes instead of being rescanned at each merge
+    SpatialHash nodehash(precision);
+    for(int in=0; in<int(nodes.size()); in++) nodehash.insert(nodes.at(in), in);
+
+    std::vector<std::vector<int>> nodepanels;
+    makeNodePanelList(panel3, int(nodes.size()), nodepanels);
+
+    std::vector<bool> bModified(panel3.size(), false);
+    std::vector<bool> bDouble(nodes.size(), false);
+    std::vector<int> candidates;
+
+    for(int in0=0; in0<int(nodes.size()); in0++)
     {
-        for(int in1=in0+1; in1<int(nodes.size()); in1++)
+        // nodes which are moved during this pass are moved to the position of in0,
+        // so the list of candidates remains valid
+        nodehash.candidates(nodes.at(in0), candidates);
+        for(int in1 : candidates)
         {
+            if(in1<=in0) continue;
             if(nodes.at(in1).isSame(nodes.at(in0), precision))
             {
                 // make a middle node
+                nodehash.remove(nodes.at(in1), in1);
                 nodes[in1].setPosition(nodes.at(in0));
+                nodehash.insert(nodes.at(in1), in1);
+
                 // re-index the triangles with node in1
-                for(int i3=0; i3<int(panel3.size()); i3++)
-                {
-                    Panel3 &p3 = panel3[i3];
-                    if(p3.nodeIndex(0)==in1)
-                    {
-                        p3.setVertex(0, nodes[in0]);
-                        if(std::find(modpanels.begin(), modpanels.end(), p3.index()) == modpanels.end())
-                            modpanels.push_back(i3);
-                    }
-                    if(p3.nodeIndex(1)==in1)
-                    {
-                        p3.setVertex(1, nodes[in0]);
-                        if(std::find(modpanels.begin(), modpanels.end(), p3.index()) == modpanels.end())
-                            modpanels.push_back(i3);
-                    }
-                    if(p3.nodeIndex(2)==in1)
-                    {
-                        p3.setVertex(2, nodes[in0]);
-                        if(std::find(modpanels.begin(), modpanels.end(), p3.index()) == modpanels.end())
-                            modpanels.push_back(i3);
-                    }
-                }
+                reindexPanelVertices(panel3, nodepanels, in1, nodes.at(in0), modpanels, bModified);
+
                 // add in1 to the list of nodes to remove
-                if((std::find(doublenodes.begin(), doublenodes.end(), in1) == doublenodes.end()))
+                if(!bDouble.at(in1))
+                {
+                    bDouble[in1] = true;
                     doublenodes.push_back(in1);
+                }
             }
         }
     }
 
     std::sort(doublenodes.begin(), doublenodes.end());
     // remove the duplicate nodes
-    for(int in=int(doublenodes.size())-1; in>=0; in--)
-    {
-        nodes.erase(nodes.begin() + doublenodes.at(in));
-    }
+    removeElements(nodes, doublenodes);
 
     log = prefix + QString::asprintf("Removed %d nodes\n", int(doublenodes.size()));
     log += prefix + QString::asprintf("New node count is %d \n", int(nodes.size()));
 
     if(modpanels.size())
     {
+        std::vector<int> nullpanels;
         for(int i3=int(modpanels.size())-1; i3>=0; i3--)
         {
             Panel3 &p3 = panel3[modpanels.at(i3)];
             p3.setFrame();
             if(p3.isNullTriangle())
             {
-                panel3.erase(panel3.begin()+modpanels.at(i3));
+                nullpanels.push_back(modpanels.at(i3));
                 log += prefix + QString::asprintf("removing null panel %d\n", p3.index());
             }
             else
@@ -960,6 +1015,10 @@ int TriMesh::cleanDoubleNodes(std::vector<Panel3> &panel3, std::vector<Node> &no
                 log += prefix + QString::asprintf("modifying panel %d\n", p3.index());
             }
         }
+        // the modified panels are not necessarily listed in increasing order,
+        // so remove the null panels once they have all been identified
+        SpatialHash::sortIds(nullpanels);
+        removeElements(panel3, nullpanels);
         log += prefix + QString::asprintf("New panel count is %d\n", int(panel3.size()));
     }
     log += "\n";
@@ -975,70 +1034,71 @@ int TriMesh::mergeFuseToWingNodes(double precision, std::string &logmsg, const s
     QString logg;
     std::vector<int> doublenodes;
     std::vector<int> modpanels;
+
+    // the wing nodes are not moved, so they are hashed once
+    SpatialHash winghash(precision);
+    for(int in=0; in<int(m_Node.size()); in++)
+    {
+        if(m_Node.at(in).isWingNode()) winghash.insert(m_Node.at(in), in);
+    }
+
+    std::vector<std::vector<int>> nodepanels;
+    makeNodePanelList(m_Panel3, nodeCount(), nodepanels);
+
+    std::vector<bool> bModified(m_Panel3.size(), false);
+    std::vector<int> candidates;
+
     for(int in0=0; in0<int(m_Node.size()); in0++)
     {
-        if(m_Node.at(in0).isFuseNode())
+        if(!m_Node.at(in0).isFuseNode()) continue;
+
+        // the fuse node is moved at each merge, so look for the next matching
+        // wing node in increasing index order around its current position
+        int last = -1;
+        while(true)
         {
-            for(uint in1=0; in1<m_Node.size(); in1++)
+            int in1 = -1;
+            winghash.candidates(m_Node.at(in0), candidates);
+            for(int idx : candidates)
             {
-                if(m_Node.at(in1).isWingNode())
+                if(idx>last && m_Node.at(idx).isSame(m_Node.at(in0), precision))
                 {
-                    if(m_Node.at(in1).isSame(m_Node.at(in0), precision))
-                    {
-                        // move the fuse node and merge it with the wing node
-                        m_Node[in0].setPosition(m_Node.at(in1));
-
-                        // re-index the triangles with node in0
-                        for(int i3=0; i3<nPanels(); i3++)
-                        {
-                            Panel3 &p3 = m_Panel3[i3];
-                            if(p3.nodeIndex(0)==in0)
-                            {
-                                p3.setVertex(0, m_Node[in1]);
-                                if(std::find(modpanels.begin(), modpanels.end(), p3.index()) == modpanels.end())
-                                    modpanels.push_back(i3);
-                            }
-                            if(p3.nodeIndex(1)==in0)
-                            {
-                                p3.setVertex(1, m_Node[in1]);
-                                if(std::find(modpanels.begin(), modpanels.end(), p3.index()) == modpanels.end())
-                                    modpanels.push_back(i3);
-                            }
-                            if(p3.nodeIndex(2)==in0)
-                            {
-                                p3.setVertex(2, m_Node[in1]);
-                                if(std::find(modpanels.begin(), modpanels.end(), p3.index()) == modpanels.end())
-                                    modpanels.push_back(i3);
-                            }
-                        }
-                        // add in0 to the list of nodes to remove
-                        if(std::find(doublenodes.begin(), doublenodes.end(), in0) == doublenodes.end())
-                            doublenodes.push_back(in0);
-                    }
+                    in1 = idx;
+                    break;
                 }
             }
+            if(in1<0) break;
+            last = in1;
+
+            // move the fuse node and merge it with the wing node
+            m_Node[in0].setPosition(m_Node.at(in1));
+
+            // re-index the triangles with node in0
+            reindexPanelVertices(m_Panel3, nodepanels, in0, m_Node.at(in1), modpanels, bModified);
+
+            // add in0 to the list of nodes to remove
+            if(doublenodes.empty() || doublenodes.back()!=in0)
+                doublenodes.push_back(in0);
         }
     }
 
     std::sort(doublenodes.begin(), doublenodes.end());
     // remove the duplicate nodes
-    for(int in=int(doublenodes.size())-1; in>=0; in--)
-    {
-        m_Node.erase(m_Node.begin() + doublenodes.at(in));
-    }
+    removeElements(m_Node, doublenodes);
 
     logg = prefix + QString::asprintf("Removed %d nodes\n", int(doublenodes.size()));
     logg += prefix + QString::asprintf("New node count is %d \n", int(m_Node.size()));
 
     if(modpanels.size())
     {
+        std::vector<int> nullpanels;
         for(int i3=int(modpanels.size())-1; i3>=0; i3--)
         {
             Panel3 &p3 = m_Panel3[modpanels.at(i3)];
             p3.setFrame();
             if(p3.isNullTriangle())
             {
-                m_Panel3.erase(m_Panel3.begin()+modpanels.at(i3));
+                nullpanels.push_back(modpanels.at(i3));
                 logg += prefix + QString::asprintf("removing null panel %d\n", p3.index());
             }
             else
@@ -1046,6 +1106,10 @@ int TriMesh::mergeFuseToWingNodes(double precision, std::string &logmsg, const s
                 logg += prefix + QString::asprintf("modifying panel %d\n", p3.index());
             }
         }
+        // the modified panels are not necessarily listed in increasing order,
+        // so remove the null panels once they have all been identified
+        SpatialHash::sortIds(nullpanels);
+        removeElements(m_Panel3, nullpanels);
         logg += prefix + QString::asprintf("New panel count is %d\n", nPanels());
     }
     logg += "\n";
@@ -1055,6 +1119,81 @@ int TriMesh::mergeFuseToWingNodes(double precision, std::string &logmsg, const s
 }
 
 
+/** Removes the elements at the sorted indexes in a single pass, rather than erasing them one by one */
+template<class T>
+void TriMesh::removeElements(std::vector<T> &elements, std::vector<int> const &sortedindexes)
+{
+    if(sortedindexes.empty()) return;
+
+    int nKept = sortedindexes.front();
+    uint id = 0;
+    for(int i=nKept; i<int(elements.size()); i++)
+    {
+        if(id<sortedindexes.size() && sortedindexes.at(id)==i)
+        {
+            id++;
+            continue;
+        }
+        elements[nKept++] = elements.at(i);
+    }
+    elements.resize(nKept);
+}
+
+
+/** Builds the list of the panels attached to each node index; out of range indexes are ignored */
+void TriMesh::makeNodePanelList(std::vector<Panel3> const &panel3, int nNodes, std::vector<std::vector<int>> &nodepanels)
+{
+    nodepanels.clear();
+    nodepanels.resize(nNodes);
+    for(int i3=0; i3<int(panel3.size()); i3++)
+    {
+        for(int iv=0; iv<3; iv++)
+        {
+            int idx = panel3.at(i3).nodeIndex(iv);
+            if(idx>=0 && idx<nNodes) nodepanels[idx].push_back(i3);
+        }
+    }
+}
+
+
+/**
+ * Replaces the vertices with index iNode by the node nd in the panels listed for iNode,
+ * and moves these panels to the list of the new node index.
+ * The modified panels are appended to modpanels in increasing index order.
+ */
+void TriMesh::reindexPanelVertices(std::vector<Panel3> &panel3, std::vector<std::vector<int>> &nodepanels, int iNode, Node const &nd,
+                                   std::vector<int> &modpanels, std::vector<bool> &bModified)
+{
+    std::vector<int> &plist = nodepanels[iNode];
+    SpatialHash::sortIds(plist);
+
+    for(int i3 : plist)
+    {
+        Panel3 &p3 = panel3[i3];
+        for(int iv=0; iv<3; iv++)
+        {
+            if(p3.nodeIndex(iv)==iNode)
+            {
+                p3.setVertex(iv, nd);
+                int idx = p3.index();
+                if(idx<0 || idx>=int(bModified.size()) || !bModified.at(idx))
+                {
+                    modpanels.push_back(i3);
+                    bModified[i3] = true;
+                }
+            }
+        }
+    }
+
+    if(nd.index()!=iNode)
+    {
+        if(nd.index()>=0 && nd.index()<int(nodepanels.size()))
+            nodepanels[nd.index()].insert(nodepanels[nd.index()].end(), plist.begin(), plist.end());
+        plist.clear();
+    }
+}
+
+
 void TriMesh::scale(double sx, double sy, double sz)
 {
     for(int in=0; in<nodeCount(); in++)
@@ -0,0 +1,264 @@
+/****************************************************************************
+
+    flow5 application
+    Copyright (C) 2025 André Deperrois
+
+    This file is part of flow5.
+
+    flow5 is free software: you can redistribute it and/or modify it
+    under the terms of the GNU General Public License as published by
+    the Free Software Foundation, either version 3 of the License,
+    or (at your option) any later version.
+
+    flow5 is distributed in the hope that it will be useful,
+    but WITHOUT ANY WARRANTY; without even the implied warranty
+    of MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.
+    See the GNU General Public License for more details.
+
+    You should have received a copy of the GNU General Public License
+    along with flow5.
+    If not, see <https://www.gnu.org/licenses/>.
+
+
+*****************************************************************************/
+
+#include <algorithm>
+
+#include <threadpool.h>
+
+
+int ThreadPool::s_nThreads(1);
+
+
+ThreadPool::ThreadPool()
+{
+    m_nPending = 0;
+    m_bStop = false;
+    m_nActiveJobs = 0;
+    m_iNextQueue = 0;
+}
+
+
+ThreadPool::~ThreadPool()
+{
+    stopWorkers();
+}
+
+
+ThreadPool &ThreadPool::instance()
+{
+    static ThreadPool pool;
+    return pool;
+}
+
+
+/** The number of threads, including the calling thread; takes effect at the start of the next loop. */
+void ThreadPool::setThreadCount(int nThreads)
+{
+    s_nThreads = std::max(1, nThreads);
+}
+
+
+/** Returns the number of iterations per chunk; the default makes a few chunks per thread to balance the load. */
+int ThreadPool::chunkSize(int iStart, int iEnd, int grain)
+{
+    if(grain>0) return grain;
+    int n = iEnd-iStart;
+    return std::max(1, n/(4*s_nThreads));
+}
+
+
+/**
+ * Executes func over the range [iStart, iEnd[, split in chunks of grain iterations.
+ * Returns when all the chunks have been processed.
+ * @param bMultiThread if false, the chunks are executed sequentially in the calling thread.
+ * @param grain the number of iterations per chunk, or 0 for the default
+ * @param cancelled if not null, is polled before each chunk
+ * @return false if the loop has been cancelled
+ */
+bool ThreadPool::parallelFor(int iStart, int iEnd, rangeFunction const &func, bool bMultiThread, int grain,
+                             cancelFunction const &cancelled)
+{
+    if(iEnd<=iStart) return true;
+    grain = chunkSize(iStart, iEnd, grain);
+
+    if(!bMultiThread || s_nThreads<=1 || iEnd-iStart<=grain)
+    {
+        for(int i0=iStart; i0<iEnd; i0+=grain)
+        {
+            if(cancelled && cancelled()) return false;
+            func(i0, std::min(i0+grain, iEnd));
+        }
+        return true;
+    }
+
+    return instance().run(iStart, iEnd, func, grain, cancelled);
+}
+
+
+bool ThreadPool::run(int iStart, int iEnd, rangeFunction const &func, int grain, cancelFunction const &cancelled)
+{
+    {
+        std::lock_guard<std::mutex> lock(m_ConfigMutex);
+        if(m_nActiveJobs==0 && int(m_Worker.size())!=s_nThreads-1) resize();
+        m_nActiveJobs++;
+    }
+
+    Job job;
+    job.m_pFunc = &func;
+    job.m_pCancel = cancelled ? &cancelled : nullptr;
+
+    int nChunks = (iEnd-iStart+grain-1)/grain;
+    job.m_nRemaining = nChunks;
+
+    int nQueues = int(m_Queue.size());
+    if(nQueues==0)
+    {
+        // no workers, run in the calling thread
+        for(int i0=iStart; i0<iEnd; i0+=grain)
+            execute({&job, i0, std::min(i0+grain, iEnd)});
+    }
+    else
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_WaitMutex);
+            m_nPending += nChunks;
+        }
+
+        // deal the chunks in contiguous slices, so that each worker starts with neighbouring iterations
+        int perqueue = (nChunks+nQueues-1)/nQueues;
+        int iq0 = int(m_iNextQueue++ % (unsigned int)nQueues);
+        for(int ic=0; ic<nChunks; ic++)
+        {
+            int i0 = iStart + ic*grain;
+            Queue &q = *m_Queue.at((iq0 + ic/perqueue) % nQueues);
+            std::lock_guard<std::mutex> lock(q.m_Mutex);
+            q.m_Task.push_back({&job, i0, std::min(i0+grain, iEnd)});
+        }
+        m_WakeUp.notify_all();
+
+        // help with the chunks of this loop, then wait for those running in the workers
+        Task task;
+        while(stealJobTask(&job, task)) execute(task);
+
+        std::unique_lock<std::mutex> lock(job.m_Mutex);
+        job.m_Done.wait(lock, [&job]{return job.m_nRemaining.load()==0;});
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(m_ConfigMutex);
+        m_nActiveJobs--;
+    }
+
+    return !job.m_bCancelled;
+}
+
+
+void ThreadPool::execute(Task const &task)
+{
+    Job *pJob = task.m_pJob;
+    if(!pJob->m_bCancelled)
+    {
+        if(pJob->m_pCancel && (*pJob->m_pCancel)()) pJob->m_bCancelled = true;
+        else (*pJob->m_pFunc)(task.m_iStart, task.m_iEnd);
+    }
+
+    // decrement under the lock, so that the job is not destroyed by the caller before the notification
+    std::lock_guard<std::mutex> lock(pJob->m_Mutex);
+    if(--pJob->m_nRemaining==0) pJob->m_Done.notify_all();
+}
+
+
+/** Must be called with the config mutex locked and no job running. */
+void ThreadPool::resize()
+{
+    stopWorkers();
+
+    int nWorkers = s_nThreads-1;
+    m_bStop = false;
+    m_Queue.clear();
+    for(int iw=0; iw<nWorkers; iw++) m_Queue.push_back(std::make_unique<Queue>());
+    for(int iw=0; iw<nWorkers; iw++) m_Worker.push_back(std::thread(&ThreadPool::workerLoop, this, iw));
+}
+
+
+void ThreadPool::stopWorkers()
+{
+    {
+        std::lock_guard<std::mutex> lock(m_WaitMutex);
+        m_bStop = true;
+    }
+    m_WakeUp.notify_all();
+    for(std::thread &t : m_Worker) t.join();
+    m_Worker.clear();
+}
+
+
+void ThreadPool::workerLoop(int iWorker)
+{
+    Task task;
+    while(true)
+    {
+        if(popTask(iWorker, task) || stealTask(iWorker, task))
+        {
+            execute(task);
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(m_WaitMutex);
+        m_WakeUp.wait(lock, [this]{return m_bStop || m_nPending.load()>0;});
+        if(m_bStop && m_nPending.load()<=0) return;
+    }
+}
+
+
+/** Pops a chunk from the front of the worker's own queue */
+bool ThreadPool::popTask(int iWorker, Task &task)
+{
+    Queue &q = *m_Queue.at(iWorker);
+    std::lock_guard<std::mutex> lock(q.m_Mutex);
+    if(q.m_Task.empty()) return false;
+    task = q.m_Task.front();
+    q.m_Task.pop_front();
+    m_nPending--;
+    return true;
+}
+
+
+/** Steals a chunk from the back of another worker's queue */
+bool ThreadPool::stealTask(int iWorker, Task &task)
+{
+    int nQueues = int(m_Queue.size());
+    for(int k=1; k<nQueues; k++)
+    {
+        Queue &q = *m_Queue.at((iWorker+k)%nQueues);
+        std::lock_guard<std::mutex> lock(q.m_Mutex);
+        if(q.m_Task.empty()) continue;
+        task = q.m_Task.back();
+        q.m_Task.pop_back();
+        m_nPending--;
+        return true;
+    }
+    return false;
+}
+
+
+/** Used by the calling thread to take the chunks of its own loop */
+bool ThreadPool::stealJobTask(Job const *pJob, Task &task)
+{
+    for(std::unique_ptr<Queue> &pq : m_Queue)
+    {
+        std::lock_guard<std::mutex> lock(pq->m_Mutex);
+        for(auto it=pq->m_Task.rbegin(); it!=pq->m_Task.rend(); ++it)
+        {
+            if(it->m_pJob==pJob)
+            {
+                task = *it;
+                pq->m_Task.erase(std::next(it).base());
+                m_nPending--;
+                return true;
+            }
+        }
+    }
+    return false;
+}